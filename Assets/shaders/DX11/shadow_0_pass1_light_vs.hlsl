@@ -6,6 +6,15 @@ cbuffer CB0 : register( b0 )
 	float4x4 cb0ProjectionMatrix;
 };
 
+cbuffer CBShadow : register( b7 )
+{
+	float4x4 cbsLightSpaceMatrix;
+	float4 cbsShadowProperties;
+	float4x4 cbsCascadeLightSpaceMatrices[4];
+	float4 cbsCascadeSplitDepths;
+	float4 cbsCascadeProperties;
+};
+
 struct VSInputData
 {
 	float3 vPosition : POSITION;
@@ -23,8 +32,7 @@ VSOutputData main( VSInputData pVSInput )
 {
 	float4 vertexPos = float4( pVSInput.vPosition, 1.0f );
 	vertexPos = mul( vertexPos, cb0ModelMatrix );
-	vertexPos = mul( vertexPos, cb0ViewMatrix );
-	vertexPos = mul( vertexPos, cb0ProjectionMatrix );
+	vertexPos = mul( vertexPos, cbsLightSpaceMatrix );
 
 	VSOutputData vsOutput;
 	vsOutput.fragPosition = vertexPos;
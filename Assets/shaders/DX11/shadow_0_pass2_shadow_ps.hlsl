@@ -2,7 +2,7 @@
 Texture2D txTexture0 : register( t0 );
 SamplerState smSampler0 : register( s0 );
 
-Texture2D txTextureShadow : register( t7 );
+Texture2DArray txTextureShadow : register( t7 );
 SamplerState smSamplerShadow : register( s7 );
 
 cbuffer CB0 : register( b0 )
@@ -16,6 +16,9 @@ cbuffer CBShadow : register( b7 )
 {
 	float4x4 cbsLightSpaceMatrix;
 	float4 cbsShadowProperties;
+	float4x4 cbsCascadeLightSpaceMatrices[4];
+	float4 cbsCascadeSplitDepths;
+	float4 cbsCascadeProperties;
 };
 
 struct VSOutputData
@@ -23,19 +26,40 @@ struct VSOutputData
 	float4 fragPosition : SV_POSITION;
 	float4 fragColor : COLOR;
 	float2 texCoord : TEXCOORD0;
-	float4 lightSpacePosition : LSPOS;
+	float4 worldPosition : WSPOS;
+	float viewDepth : VSDEPTH;
 };
 
-float calculateShadowfactor( float4 pLightSpacePos )
+int selectCascade( float pViewDepth )
 {
-	float3 projCoords = pLightSpacePos.xyz / pLightSpacePos.w;
+	int cascadesNum = int( cbsCascadeProperties.x );
+	for( int cascadeIndex = 0; cascadeIndex < cascadesNum; ++cascadeIndex )
+	{
+		if( pViewDepth <= cbsCascadeSplitDepths[cascadeIndex] )
+		{
+			return cascadeIndex;
+		}
+	}
+	return -1;
+}
+
+float calculateShadowfactor( float4 pWorldPos, float pViewDepth )
+{
+	int cascadeIndex = selectCascade( pViewDepth );
+	if( cascadeIndex < 0 )
+	{
+		return 1.0f;
+	}
+
+	float4 lightSpacePos = mul( float4( pWorldPos.xyz, 1.0f ), cbsCascadeLightSpaceMatrices[cascadeIndex] );
+	float3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
 
 	float2 uvCoords;
 	uvCoords.x = 0.5 * projCoords.x + 0.5;
 	uvCoords.y = -0.5 * projCoords.y + 0.5;
 
 	float zValue = projCoords.z;
-	float depth = txTextureShadow.Sample( smSamplerShadow, uvCoords ).r;
+	float depth = txTextureShadow.Sample( smSamplerShadow, float3( uvCoords, float( cascadeIndex ) ) ).r;
 
 	const float depthBias = 0.00015;
 
@@ -62,7 +86,7 @@ float4 main( VSOutputData pPSInput ) : SV_TARGET
 	}
 
 	float4 fixedLightColor = float4( 1.0f, 1.0f, 1.0f, 1.0f );
-	float shadowFactor = calculateShadowfactor( pPSInput.lightSpacePosition );
+	float shadowFactor = calculateShadowfactor( pPSInput.worldPosition, pPSInput.viewDepth );
 
 	return float4( shadowFactor * textureColor0 * fixedLightColor );
 }
@@ -10,6 +10,9 @@ cbuffer CBShadow : register( b7 )
 {
 	float4x4 cbsLightSpaceMatrix;
 	float4 cbsShadowProperties;
+	float4x4 cbsCascadeLightSpaceMatrices[4];
+	float4 cbsCascadeSplitDepths;
+	float4 cbsCascadeProperties;
 };
 
 struct VSInputData
@@ -25,20 +28,22 @@ struct VSOutputData
 	float4 fragPosition : SV_POSITION;
 	float4 fragColor : COLOR;
 	float2 texCoord : TEXCOORD0;
-	float4 lightSpacePosition : LSPOS;
+	float4 worldPosition : WSPOS;
+	float viewDepth : VSDEPTH;
 };
 
 VSOutputData main( VSInputData pVSInput )
 {
 	float4 vertexPos = float4( pVSInput.vPosition, 1.0f );
 	float4 worldPosition = mul( float4( vertexPos.xyz, 1.0f ), cb0ModelMatrix );
-	float4 lightSpacePosition = mul( worldPosition, cbsLightSpaceMatrix );
+	float4 viewPosition = mul( worldPosition, cb0ViewMatrix );
 
 	VSOutputData vsOutput;
-	vsOutput.fragPosition = mul( mul( worldPosition, cb0ViewMatrix ), cb0ProjectionMatrix );
+	vsOutput.fragPosition = mul( viewPosition, cb0ProjectionMatrix );
 	vsOutput.fragColor = pVSInput.vColor;
 	vsOutput.texCoord = pVSInput.vTexCoord0;
-	vsOutput.lightSpacePosition = lightSpacePosition;
+	vsOutput.worldPosition = worldPosition;
+	vsOutput.viewDepth = abs( viewPosition.z );
 
 	return vsOutput;
 }
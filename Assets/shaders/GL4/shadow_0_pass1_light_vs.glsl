@@ -14,6 +14,9 @@ layout( std140, binding = 7 ) uniform CBShadow
 {
 	layout(row_major) mat4 cbsLightSpaceMatrix;
 	vec4 cbsShadowProperties;
+	layout(row_major) mat4 cbsCascadeLightSpaceMatrices[4];
+	vec4 cbsCascadeSplitDepths;
+	vec4 cbsCascadeProperties;
 };
 
 out gl_PerVertex
@@ -25,5 +28,5 @@ out gl_PerVertex
 
 void main()
 {
-	gl_Position = cb0ProjectionMatrix * cb0ViewMatrix * cb0ModelMatrix * vec4( vPosition , 1.0 );
+	gl_Position = cbsLightSpaceMatrix * cb0ModelMatrix * vec4( vPosition , 1.0 );
 }
@@ -3,12 +3,13 @@
 
 in vec4 psColor;
 in vec2 psTexCoord0;
-in vec4 psLightSpacePosition;
+in vec4 psWorldPosition;
+in float psViewDepth;
 
 layout( location = 0 ) out vec4 outPixelColor;
 
 layout( binding = 0 ) uniform sampler2D uSampler0;
-layout( binding = 7 ) uniform sampler2D uSamplerShadow;
+layout( binding = 7 ) uniform sampler2DArray uSamplerShadow;
 
 layout( std140, binding = 0 ) uniform CB0
 {
@@ -21,11 +22,35 @@ layout( std140, binding = 7 ) uniform CBShadow
 {
 	layout( row_major ) mat4 cbsLightSpaceMatrix;
 	vec4 cbsShadowProperties;
+	layout( row_major ) mat4 cbsCascadeLightSpaceMatrices[4];
+	vec4 cbsCascadeSplitDepths;
+	vec4 cbsCascadeProperties;
 };
 
-float calculateShadowfactor( vec4 pLightSpacePos )
+int selectCascade( float pViewDepth )
 {
-	vec3 projCoords = pLightSpacePos.xyz / pLightSpacePos.w;
+	int cascadesNum = int( cbsCascadeProperties.x );
+	for( int cascadeIndex = 0; cascadeIndex < cascadesNum; ++cascadeIndex )
+	{
+		if( pViewDepth <= cbsCascadeSplitDepths[cascadeIndex] )
+		{
+			return cascadeIndex;
+		}
+	}
+	return -1;
+}
+
+float calculateShadowfactor( vec4 pWorldPos, float pViewDepth )
+{
+	int cascadeIndex = selectCascade( pViewDepth );
+	if( cascadeIndex < 0 )
+	{
+		return 1.0f;
+	}
+
+	vec4 lightSpacePos = cbsCascadeLightSpaceMatrices[cascadeIndex] * vec4( pWorldPos.xyz, 1.0f );
+	vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
+	float layerIndex = float( cascadeIndex );
 
 	vec2 uvCoords;
 	uvCoords.x = 0.5 * projCoords.x + 0.5;
@@ -48,14 +73,14 @@ float calculateShadowfactor( vec4 pLightSpacePos )
         	    vec2 sampleCoords;
         	    sampleCoords.x = uvCoords.x + xIndex * xOffset;
         	    sampleCoords.y = uvCoords.y + yIndex * yOffset;
-    	        depth += texture( uSamplerShadow, sampleCoords ).x;
+    	        depth += texture( uSamplerShadow, vec3( sampleCoords, layerIndex ) ).x;
         	}
     	}
     	depth = depth / 9.0f;
 	}
 	else
 	{
-	    depth = texture( uSamplerShadow, uvCoords ).x;
+	    depth = texture( uSamplerShadow, vec3( uvCoords, layerIndex ) ).x;
 	}
 
 	const float depthBias = 0.00015;
@@ -83,7 +108,7 @@ void main()
 	}
 
 	vec4 fixedLightColor = vec4( 1.0f );
-	float shadowFactor = calculateShadowfactor( psLightSpacePosition );
+	float shadowFactor = calculateShadowfactor( psWorldPosition, psViewDepth );
 
 	outPixelColor = vec4( shadowFactor * textureColor0 * fixedLightColor );
 }
@@ -17,6 +17,9 @@ layout( std140, binding = 7 ) uniform CBShadow
 {
 	layout(row_major) mat4 cbsLightSpaceMatrix;
 	vec4 cbsShadowProperties;
+	layout(row_major) mat4 cbsCascadeLightSpaceMatrices[4];
+	vec4 cbsCascadeSplitDepths;
+	vec4 cbsCascadeProperties;
 };
 
 out gl_PerVertex
@@ -28,16 +31,18 @@ out gl_PerVertex
 
 out vec4 psColor;
 out vec2 psTexCoord0;
-out vec4 psLightSpacePosition;
+out vec4 psWorldPosition;
+out float psViewDepth;
 
 void main()
 {
     vec4 worldPosition = cb0ModelMatrix * vec4( vPosition, 1.0 );
-	vec4 lightSpacePosition = cbsLightSpaceMatrix * vec4( worldPosition.xyz, 1.0f );
+	vec4 viewPosition = cb0ViewMatrix * worldPosition;
 
 	psColor = vColor;
 	psTexCoord0 = vTexCoord0;
-	psLightSpacePosition = lightSpacePosition;
+	psWorldPosition = worldPosition;
+	psViewDepth = abs( viewPosition.z );
 
-	gl_Position = cb0ProjectionMatrix * cb0ViewMatrix  * worldPosition;
+	gl_Position = cb0ProjectionMatrix * viewPosition;
 }
\ No newline at end of file
@@ -57,6 +57,58 @@ namespace cppx
 		return static_cast<uint16>( PCL_POPCNT64( pValue ) );
 	}
 
+	/// @brief Returns the index of the least significant bit set in the specified value. Value must not be zero.
+	inline uint32 bit_scan_lsb( uint32 pValue )
+	{
+		cppx_debug_assert( pValue != 0 );
+	#if( PCL_COMPILER & PCL_COMPILER_MSVC )
+		unsigned long bitIndex = 0;
+		_BitScanForward( &bitIndex, pValue );
+		return static_cast<uint32>( bitIndex );
+	#else
+		return static_cast<uint32>( __builtin_ctz( pValue ) );
+	#endif
+	}
+
+	/// @brief Returns the index of the least significant bit set in the specified value. Value must not be zero.
+	inline uint32 bit_scan_lsb( uint64 pValue )
+	{
+		cppx_debug_assert( pValue != 0 );
+	#if( PCL_COMPILER & PCL_COMPILER_MSVC )
+		unsigned long bitIndex = 0;
+		_BitScanForward64( &bitIndex, pValue );
+		return static_cast<uint32>( bitIndex );
+	#else
+		return static_cast<uint32>( __builtin_ctzll( pValue ) );
+	#endif
+	}
+
+	/// @brief Returns the index of the most significant bit set in the specified value. Value must not be zero.
+	inline uint32 bit_scan_msb( uint32 pValue )
+	{
+		cppx_debug_assert( pValue != 0 );
+	#if( PCL_COMPILER & PCL_COMPILER_MSVC )
+		unsigned long bitIndex = 0;
+		_BitScanReverse( &bitIndex, pValue );
+		return static_cast<uint32>( bitIndex );
+	#else
+		return static_cast<uint32>( 31 - __builtin_clz( pValue ) );
+	#endif
+	}
+
+	/// @brief Returns the index of the most significant bit set in the specified value. Value must not be zero.
+	inline uint32 bit_scan_msb( uint64 pValue )
+	{
+		cppx_debug_assert( pValue != 0 );
+	#if( PCL_COMPILER & PCL_COMPILER_MSVC )
+		unsigned long bitIndex = 0;
+		_BitScanReverse64( &bitIndex, pValue );
+		return static_cast<uint32>( bitIndex );
+	#else
+		return static_cast<uint32>( 63 - __builtin_clzll( pValue ) );
+	#endif
+	}
+
 	template <typename TPValue>
 	inline constexpr TPValue make_lsfb_bitmask( size_t pBitCount )
 	{
@@ -229,6 +229,12 @@ namespace cppx
 			return *this;
 		}
 
+		/// Size of the allocated storage. resize() within the capacity does not reallocate.
+		CPPX_ATTR_NO_DISCARD size_t capacity() const noexcept
+		{
+			return _internalBuffer.size();
+		}
+
 		void set_size( size_t pNewSize )
 		{
 			pNewSize = get_min_of( pNewSize, _internalBuffer.size() );
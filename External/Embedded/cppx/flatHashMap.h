@@ -0,0 +1,894 @@
+
+#ifndef __CPPX_FLAT_HASH_MAP_H__
+#define __CPPX_FLAT_HASH_MAP_H__
+
+#include "bitUtils.h"
+#include "hash.h"
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+
+namespace cppx
+{
+
+	namespace impl
+	{
+
+		/// Type of a single control byte. Each slot in the table has its own control byte, which is either one of the
+		/// special values below (empty/deleted) or, if the slot is occupied, 7 low bits of the hash of its key ("H2").
+		using fhm_ctrl_t = int8;
+
+		/// Control byte of an empty slot. The only value with bit 7 set and bit 0 cleared.
+		inline constexpr fhm_ctrl_t fhm_ctrl_empty = static_cast<fhm_ctrl_t>( -128 );
+
+		/// Control byte of a slot which contained an element that has been erased (a "tombstone").
+		inline constexpr fhm_ctrl_t fhm_ctrl_deleted = static_cast<fhm_ctrl_t>( -2 );
+
+		/// Number of slots (control bytes) probed at once. One group is matched with a single SSE2 compare.
+		inline constexpr size_t fhm_group_width = 16;
+
+		/// Max load factor of the table, expressed as (num / den) to avoid floating-point math. 7/8 keeps the
+		/// average probe length close to one group while wasting only 12.5% of the slots.
+		inline constexpr size_t fhm_max_load_num = 7;
+		inline constexpr size_t fhm_max_load_den = 8;
+
+		CPPX_ATTR_NO_DISCARD inline bool fhm_ctrl_is_full( fhm_ctrl_t pCtrl ) noexcept
+		{
+			return pCtrl >= 0;
+		}
+
+		/// Spreads the hash value over all bits. Required, because std::hash for integers is an identity on most
+		/// of the platforms, while the table uses both the lowest bits (H2) and the higher ones (H1) of the hash.
+		CPPX_ATTR_NO_DISCARD inline size_t fhm_mix_hash( size_t pHash ) noexcept
+		{
+		#if( PCL_TARGET_64 )
+			const uint64 mixed = static_cast<uint64>( pHash ) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>( mixed ^ ( mixed >> 32 ) );
+		#else
+			const uint32 mixed = static_cast<uint32>( pHash ) * 0x9E3779B9u;
+			return static_cast<size_t>( mixed ^ ( mixed >> 16 ) );
+		#endif
+		}
+
+		/// A view of fhm_group_width control bytes, which matches all of them against a value at once.
+		/// All match functions return a bitmask in which bit N is set if the control byte N matched.
+		struct fhm_ctrl_group
+		{
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			__m128i ctrl;
+
+			explicit fhm_ctrl_group( const fhm_ctrl_t * pCtrl ) noexcept
+			: ctrl( _mm_loadu_si128( reinterpret_cast<const __m128i *>( pCtrl ) ) )
+			{}
+
+			CPPX_ATTR_NO_DISCARD uint32 match( fhm_ctrl_t pH2 ) const noexcept
+			{
+				const auto cmpResult = _mm_cmpeq_epi8( _mm_set1_epi8( pH2 ), ctrl );
+				return static_cast<uint32>( _mm_movemask_epi8( cmpResult ) );
+			}
+
+			CPPX_ATTR_NO_DISCARD uint32 match_empty() const noexcept
+			{
+				return match( fhm_ctrl_empty );
+			}
+
+			CPPX_ATTR_NO_DISCARD uint32 match_empty_or_deleted() const noexcept
+			{
+				// Both special values have the sign bit set, full slots never do.
+				return static_cast<uint32>( _mm_movemask_epi8( ctrl ) );
+			}
+		#else
+			const fhm_ctrl_t * ctrl;
+
+			explicit fhm_ctrl_group( const fhm_ctrl_t * pCtrl ) noexcept
+			: ctrl( pCtrl )
+			{}
+
+			CPPX_ATTR_NO_DISCARD uint32 match( fhm_ctrl_t pH2 ) const noexcept
+			{
+				uint32 result = 0;
+				for( size_t ctrlIndex = 0; ctrlIndex < fhm_group_width; ++ctrlIndex )
+				{
+					result |= ( ctrl[ctrlIndex] == pH2 ) ? ( 1u << ctrlIndex ) : 0u;
+				}
+				return result;
+			}
+
+			CPPX_ATTR_NO_DISCARD uint32 match_empty() const noexcept
+			{
+				return match( fhm_ctrl_empty );
+			}
+
+			CPPX_ATTR_NO_DISCARD uint32 match_empty_or_deleted() const noexcept
+			{
+				uint32 result = 0;
+				for( size_t ctrlIndex = 0; ctrlIndex < fhm_group_width; ++ctrlIndex )
+				{
+					result |= ( ctrl[ctrlIndex] < 0 ) ? ( 1u << ctrlIndex ) : 0u;
+				}
+				return result;
+			}
+		#endif
+		};
+
+		template <typename TPHasher, typename TPKeyEqual, typename = void>
+		struct fhm_is_transparent : public std::false_type
+		{};
+
+		template <typename TPHasher, typename TPKeyEqual>
+		struct fhm_is_transparent<TPHasher, TPKeyEqual, std::void_t<typename TPHasher::is_transparent, typename TPKeyEqual::is_transparent>>
+		: public std::true_type
+		{};
+
+	}
+
+	/// @brief Open-addressing hash map with SIMD-probed control bytes (the "swiss table" layout).
+	///
+	/// Elements are stored directly in a single array of slots (no per-element allocations), and every slot has
+	/// an associated 1-byte control value with 7 bits of the hash of its key. A lookup hashes the key once, then
+	/// compares 16 control bytes at a time and touches the slots only for the (rare) control byte matches.
+	/// Slots are grouped into aligned groups of 16 and groups are probed with a triangular sequence.
+	///
+	/// Differences compared to std::unordered_map:
+	/// - element addresses and iterators are NOT stable - any insertion may invalidate them,
+	/// - erase() does not rehash, it leaves tombstones which are removed by the next rehash,
+	/// - if both hasher and key_equal define "is_transparent", lookup functions accept any key-comparable type
+	///   (e.g. std::string_view for std::string keys), see flat_hash_str_hash and flat_hash_str_equal.
+	template < typename TPKey,
+	           typename TPValue,
+	           typename TPHasher = std::hash<TPKey>,
+	           typename TPKeyEqual = std::equal_to<TPKey>,
+	           typename TPAllocator = std::allocator<std::pair<TPKey, TPValue>> >
+	class flat_hash_map
+	{
+	public:
+		using self_type = flat_hash_map<TPKey, TPValue, TPHasher, TPKeyEqual, TPAllocator>;
+		using key_type = TPKey;
+		using mapped_type = TPValue;
+		using value_type = std::pair<TPKey, TPValue>;
+		using hasher = TPHasher;
+		using key_equal = TPKeyEqual;
+		using allocator_type = TPAllocator;
+
+		static constexpr bool is_transparent = impl::fhm_is_transparent<TPHasher, TPKeyEqual>::value;
+
+		/// Type used for lookup functions. If both hasher and key_equal are transparent, any type is accepted.
+		template <typename TPRef>
+		using lookup_key_type = typename std::conditional<is_transparent, TPRef, key_type>::type;
+
+		template <bool tpConst>
+		class iterator_base
+		{
+			friend class flat_hash_map;
+
+			template <bool>
+			friend class iterator_base;
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = typename self_type::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = typename std::conditional<tpConst, const value_type *, value_type *>::type;
+			using reference = typename std::conditional<tpConst, const value_type &, value_type &>::type;
+
+			iterator_base() = default;
+
+			template <bool tpOtherConst, typename = typename std::enable_if<tpConst && !tpOtherConst>::type>
+			iterator_base( const iterator_base<tpOtherConst> & pOther )
+			: _ctrl( pOther._ctrl )
+			, _slot( pOther._slot )
+			, _ctrlEnd( pOther._ctrlEnd )
+			{}
+
+			reference operator*() const noexcept
+			{
+				return *_slot;
+			}
+
+			pointer operator->() const noexcept
+			{
+				return _slot;
+			}
+
+			iterator_base & operator++() noexcept
+			{
+				++_ctrl;
+				++_slot;
+				_skip_empty_slots();
+				return *this;
+			}
+
+			iterator_base operator++( int ) noexcept
+			{
+				auto tmp = *this;
+				++( *this );
+				return tmp;
+			}
+
+			bool operator==( const iterator_base & pRhs ) const noexcept
+			{
+				return _ctrl == pRhs._ctrl;
+			}
+
+			bool operator!=( const iterator_base & pRhs ) const noexcept
+			{
+				return _ctrl != pRhs._ctrl;
+			}
+
+		private:
+			iterator_base( const impl::fhm_ctrl_t * pCtrl, pointer pSlot, const impl::fhm_ctrl_t * pCtrlEnd ) noexcept
+			: _ctrl( pCtrl )
+			, _slot( pSlot )
+			, _ctrlEnd( pCtrlEnd )
+			{}
+
+			void _skip_empty_slots() noexcept
+			{
+				while( ( _ctrl != _ctrlEnd ) && !impl::fhm_ctrl_is_full( *_ctrl ) )
+				{
+					++_ctrl;
+					++_slot;
+				}
+			}
+
+		private:
+			const impl::fhm_ctrl_t * _ctrl = nullptr;
+			pointer _slot = nullptr;
+			const impl::fhm_ctrl_t * _ctrlEnd = nullptr;
+		};
+
+		using iterator = iterator_base<false>;
+		using const_iterator = iterator_base<true>;
+
+	public:
+		flat_hash_map() = default;
+
+		explicit flat_hash_map( size_t pCapacity, const TPAllocator & pAllocator = TPAllocator() )
+		: _allocator( pAllocator )
+		{
+			reserve( pCapacity );
+		}
+
+		flat_hash_map( std::initializer_list<value_type> pElements )
+		{
+			reserve( pElements.size() );
+			for( const auto & element : pElements )
+			{
+				insert( element );
+			}
+		}
+
+		flat_hash_map( const flat_hash_map & pSource )
+		: _hasher( pSource._hasher )
+		, _keyEqual( pSource._keyEqual )
+		, _allocator( std::allocator_traits<TPAllocator>::select_on_container_copy_construction( pSource._allocator ) )
+		{
+			reserve( pSource.size() );
+			for( const auto & element : pSource )
+			{
+				_insert_unique_unchecked( element );
+			}
+		}
+
+		flat_hash_map( flat_hash_map && pSource ) noexcept
+		: _hasher( std::move( pSource._hasher ) )
+		, _keyEqual( std::move( pSource._keyEqual ) )
+		, _allocator( std::move( pSource._allocator ) )
+		, _ctrl( std::exchange( pSource._ctrl, nullptr ) )
+		, _slots( std::exchange( pSource._slots, nullptr ) )
+		, _capacity( std::exchange( pSource._capacity, 0 ) )
+		, _size( std::exchange( pSource._size, 0 ) )
+		, _growthLeft( std::exchange( pSource._growthLeft, 0 ) )
+		{}
+
+		~flat_hash_map()
+		{
+			_release_storage();
+		}
+
+		flat_hash_map & operator=( const flat_hash_map & pRhs )
+		{
+			if( this != &pRhs )
+			{
+				flat_hash_map tmp( pRhs );
+				swap( tmp );
+			}
+			return *this;
+		}
+
+		flat_hash_map & operator=( flat_hash_map && pRhs ) noexcept
+		{
+			if( this != &pRhs )
+			{
+				flat_hash_map tmp( std::move( pRhs ) );
+				swap( tmp );
+			}
+			return *this;
+		}
+
+		TPValue & operator[]( const key_type & pKey )
+		{
+			return try_emplace( pKey ).first->second;
+		}
+
+		TPValue & operator[]( key_type && pKey )
+		{
+			return try_emplace( std::move( pKey ) ).first->second;
+		}
+
+		/// @brief Returns a reference to the value mapped to the specified key. Throws std::out_of_range if the key is not present.
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD TPValue & at( const TPRef & pKey )
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			if( slotIndex == cve::invalid_position )
+			{
+				throw std::out_of_range( "flat_hash_map::at(): key not found" );
+			}
+			return _slots[slotIndex].second;
+		}
+
+		/// @brief Returns a reference to the value mapped to the specified key. Throws std::out_of_range if the key is not present.
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const TPValue & at( const TPRef & pKey ) const
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			if( slotIndex == cve::invalid_position )
+			{
+				throw std::out_of_range( "flat_hash_map::at(): key not found" );
+			}
+			return _slots[slotIndex].second;
+		}
+
+		CPPX_ATTR_NO_DISCARD iterator begin() noexcept
+		{
+			iterator beginIter{ _ctrl, _slots, _ctrl + _capacity };
+			beginIter._skip_empty_slots();
+			return beginIter;
+		}
+
+		CPPX_ATTR_NO_DISCARD const_iterator begin() const noexcept
+		{
+			const_iterator beginIter{ _ctrl, _slots, _ctrl + _capacity };
+			beginIter._skip_empty_slots();
+			return beginIter;
+		}
+
+		CPPX_ATTR_NO_DISCARD iterator end() noexcept
+		{
+			return iterator{ _ctrl + _capacity, _slots + _capacity, _ctrl + _capacity };
+		}
+
+		CPPX_ATTR_NO_DISCARD const_iterator end() const noexcept
+		{
+			return const_iterator{ _ctrl + _capacity, _slots + _capacity, _ctrl + _capacity };
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD iterator find( const TPRef & pKey )
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			return ( slotIndex != cve::invalid_position ) ? _iterator_at( slotIndex ) : end();
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const_iterator find( const TPRef & pKey ) const
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			return ( slotIndex != cve::invalid_position ) ? _iterator_at( slotIndex ) : end();
+		}
+
+		/// @brief Returns a pointer to the value mapped to the specified key or nullptr if the key is not present.
+		/// Cheaper than find() when the iterator is not needed (no iterator has to be constructed).
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD TPValue * find_value( const TPRef & pKey ) noexcept
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			return ( slotIndex != cve::invalid_position ) ? &( _slots[slotIndex].second ) : nullptr;
+		}
+
+		/// @brief Returns a pointer to the value mapped to the specified key or nullptr if the key is not present.
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const TPValue * find_value( const TPRef & pKey ) const noexcept
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			return ( slotIndex != cve::invalid_position ) ? &( _slots[slotIndex].second ) : nullptr;
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD bool contains( const TPRef & pKey ) const noexcept
+		{
+			return _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) ) != cve::invalid_position;
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD size_t count( const TPRef & pKey ) const noexcept
+		{
+			return contains( pKey ) ? 1u : 0u;
+		}
+
+		/// @brief Inserts a new element constructed from the specified args, if there is no element with the given key.
+		/// @return A pair with an iterator to the element with the specified key and a flag indicating if insertion took place.
+		template <typename TPKeyRef, typename... TPArgs>
+		std::pair<iterator, bool> try_emplace( TPKeyRef && pKey, TPArgs && ...pArgs )
+		{
+			const auto keyHash = _hash_key( pKey );
+
+			const auto existingSlotIndex = _find_slot_with_hash( pKey, keyHash );
+			if( existingSlotIndex != cve::invalid_position )
+			{
+				return { _iterator_at( existingSlotIndex ), false };
+			}
+
+			const auto newSlotIndex = _prepare_insert_slot( keyHash );
+			_construct_slot(
+				newSlotIndex,
+				std::piecewise_construct,
+				std::forward_as_tuple( std::forward<TPKeyRef>( pKey ) ),
+				std::forward_as_tuple( std::forward<TPArgs>( pArgs )... ) );
+
+			return { _iterator_at( newSlotIndex ), true };
+		}
+
+		template <typename... TPArgs>
+		std::pair<iterator, bool> emplace( const key_type & pKey, TPArgs && ...pArgs )
+		{
+			return try_emplace( pKey, std::forward<TPArgs>( pArgs )... );
+		}
+
+		template <typename... TPArgs>
+		std::pair<iterator, bool> emplace( key_type && pKey, TPArgs && ...pArgs )
+		{
+			return try_emplace( std::move( pKey ), std::forward<TPArgs>( pArgs )... );
+		}
+
+		std::pair<iterator, bool> insert( const value_type & pElement )
+		{
+			return try_emplace( pElement.first, pElement.second );
+		}
+
+		std::pair<iterator, bool> insert( value_type && pElement )
+		{
+			return try_emplace( std::move( pElement.first ), std::move( pElement.second ) );
+		}
+
+		/// @brief Inserts a new element or, if the key already exists, assigns the specified value to it.
+		template <typename TPKeyRef, typename TPValueRef>
+		std::pair<iterator, bool> insert_or_assign( TPKeyRef && pKey, TPValueRef && pValue )
+		{
+			auto insertResult = try_emplace( std::forward<TPKeyRef>( pKey ), std::forward<TPValueRef>( pValue ) );
+			if( !insertResult.second )
+			{
+				insertResult.first->second = std::forward<TPValueRef>( pValue );
+			}
+			return insertResult;
+		}
+
+		/// @brief Removes the element pointed to by the iterator. Unlike std::unordered_map::erase(), this
+		/// function returns nothing - advance the iterator before erasing if the iteration should continue.
+		void erase( const_iterator pIter )
+		{
+			const auto slotIndex = static_cast<size_t>( pIter._ctrl - _ctrl );
+			cppx_debug_assert( ( slotIndex < _capacity ) && impl::fhm_ctrl_is_full( _ctrl[slotIndex] ) );
+			_erase_slot( slotIndex );
+		}
+
+		void erase( iterator pIter )
+		{
+			erase( const_iterator{ pIter } );
+		}
+
+		/// @brief Removes the element with the specified key, if present.
+		/// @return Number of elements removed (0 or 1).
+		template <typename TPRef>
+		size_t erase( const TPRef & pKey )
+		{
+			const auto slotIndex = _find_slot( static_cast<const lookup_key_type<TPRef> &>( pKey ) );
+			if( slotIndex != cve::invalid_position )
+			{
+				_erase_slot( slotIndex );
+				return 1;
+			}
+			return 0;
+		}
+
+		/// @brief Removes all elements, but keeps the allocated storage.
+		void clear() noexcept
+		{
+			if( _size > 0 )
+			{
+				for( size_t slotIndex = 0; slotIndex < _capacity; ++slotIndex )
+				{
+					if( impl::fhm_ctrl_is_full( _ctrl[slotIndex] ) )
+					{
+						_destroy_slot( slotIndex );
+					}
+				}
+			}
+
+			if( _capacity > 0 )
+			{
+				std::fill( _ctrl, _ctrl + _capacity, impl::fhm_ctrl_empty );
+			}
+
+			_size = 0;
+			_growthLeft = _max_size_for_capacity( _capacity );
+		}
+
+		/// @brief Ensures the map can hold the specified number of elements without rehashing.
+		void reserve( size_t pSize )
+		{
+			if( pSize > _size + _growthLeft )
+			{
+				_rehash( _capacity_for_size( pSize ) );
+			}
+		}
+
+		/// @brief Rebuilds the table with capacity suitable for at least the specified number of elements. Can
+		/// be used to shrink the table or to remove the tombstones left after a lot of erase() operations.
+		void rehash( size_t pSize )
+		{
+			_rehash( _capacity_for_size( std::max( pSize, _size ) ) );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t size() const noexcept
+		{
+			return _size;
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t capacity() const noexcept
+		{
+			return _capacity;
+		}
+
+		CPPX_ATTR_NO_DISCARD bool empty() const noexcept
+		{
+			return _size == 0;
+		}
+
+		CPPX_ATTR_NO_DISCARD float load_factor() const noexcept
+		{
+			return ( _capacity > 0 ) ? ( static_cast<float>( _size ) / static_cast<float>( _capacity ) ) : 0.0f;
+		}
+
+		void swap( self_type & pOther ) noexcept
+		{
+			std::swap( _hasher, pOther._hasher );
+			std::swap( _keyEqual, pOther._keyEqual );
+			std::swap( _allocator, pOther._allocator );
+			std::swap( _ctrl, pOther._ctrl );
+			std::swap( _slots, pOther._slots );
+			std::swap( _capacity, pOther._capacity );
+			std::swap( _size, pOther._size );
+			std::swap( _growthLeft, pOther._growthLeft );
+		}
+
+	private:
+		using slot_allocator_type = typename std::allocator_traits<TPAllocator>::template rebind_alloc<value_type>;
+		using ctrl_allocator_type = typename std::allocator_traits<TPAllocator>::template rebind_alloc<impl::fhm_ctrl_t>;
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD size_t _hash_key( const TPRef & pKey ) const noexcept
+		{
+			return impl::fhm_mix_hash( static_cast<size_t>( _hasher( pKey ) ) );
+		}
+
+		CPPX_ATTR_NO_DISCARD static size_t _hash_h1( size_t pHash ) noexcept
+		{
+			return pHash >> 7;
+		}
+
+		CPPX_ATTR_NO_DISCARD static impl::fhm_ctrl_t _hash_h2( size_t pHash ) noexcept
+		{
+			return static_cast<impl::fhm_ctrl_t>( pHash & 0x7F );
+		}
+
+		CPPX_ATTR_NO_DISCARD static size_t _max_size_for_capacity( size_t pCapacity ) noexcept
+		{
+			return pCapacity / impl::fhm_max_load_den * impl::fhm_max_load_num;
+		}
+
+		CPPX_ATTR_NO_DISCARD static size_t _capacity_for_size( size_t pSize ) noexcept
+		{
+			// Capacity is always a power of 2 and a multiple of the group width.
+			size_t capacity = impl::fhm_group_width;
+			while( _max_size_for_capacity( capacity ) < pSize )
+			{
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		CPPX_ATTR_NO_DISCARD iterator _iterator_at( size_t pSlotIndex ) noexcept
+		{
+			return iterator{ _ctrl + pSlotIndex, _slots + pSlotIndex, _ctrl + _capacity };
+		}
+
+		CPPX_ATTR_NO_DISCARD const_iterator _iterator_at( size_t pSlotIndex ) const noexcept
+		{
+			return const_iterator{ _ctrl + pSlotIndex, _slots + pSlotIndex, _ctrl + _capacity };
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD size_t _find_slot( const TPRef & pKey ) const noexcept
+		{
+			return ( _size > 0 ) ? _find_slot_with_hash( pKey, _hash_key( pKey ) ) : cve::invalid_position;
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD size_t _find_slot_with_hash( const TPRef & pKey, size_t pHash ) const noexcept
+		{
+			if( _capacity == 0 )
+			{
+				return cve::invalid_position;
+			}
+
+			const auto h2 = _hash_h2( pHash );
+			const auto groupMask = ( _capacity / impl::fhm_group_width ) - 1;
+
+			auto groupIndex = _hash_h1( pHash ) & groupMask;
+
+			for( size_t probeIndex = 1; probeIndex <= groupMask + 1; ++probeIndex )
+			{
+				const auto groupBase = groupIndex * impl::fhm_group_width;
+				const impl::fhm_ctrl_group ctrlGroup{ _ctrl + groupBase };
+
+				for( auto matchMask = ctrlGroup.match( h2 ); matchMask != 0; matchMask &= ( matchMask - 1 ) )
+				{
+					const auto slotIndex = groupBase + bit_scan_lsb( matchMask );
+					if( _keyEqual( _slots[slotIndex].first, pKey ) )
+					{
+						return slotIndex;
+					}
+				}
+
+				// A group with an empty slot terminates the probe sequence: the key would have been put there.
+				if( ctrlGroup.match_empty() != 0 )
+				{
+					break;
+				}
+
+				// Triangular probing - visits every group exactly once when the number of groups is a power of 2.
+				groupIndex = ( groupIndex + probeIndex ) & groupMask;
+			}
+
+			return cve::invalid_position;
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t _find_first_non_full( size_t pHash ) const noexcept
+		{
+			const auto groupMask = ( _capacity / impl::fhm_group_width ) - 1;
+
+			auto groupIndex = _hash_h1( pHash ) & groupMask;
+
+			for( size_t probeIndex = 1; ; ++probeIndex )
+			{
+				const auto groupBase = groupIndex * impl::fhm_group_width;
+				const impl::fhm_ctrl_group ctrlGroup{ _ctrl + groupBase };
+
+				if( const auto freeMask = ctrlGroup.match_empty_or_deleted() )
+				{
+					return groupBase + bit_scan_lsb( freeMask );
+				}
+
+				groupIndex = ( groupIndex + probeIndex ) & groupMask;
+			}
+		}
+
+		size_t _prepare_insert_slot( size_t pHash )
+		{
+			auto slotIndex = ( _capacity > 0 ) ? _find_first_non_full( pHash ) : cve::invalid_position;
+
+			// Reusing a tombstone does not consume the growth budget, so check it before the rehash.
+			if( ( _growthLeft == 0 ) && ( ( slotIndex == cve::invalid_position ) || ( _ctrl[slotIndex] != impl::fhm_ctrl_deleted ) ) )
+			{
+				// If there is a lot of tombstones, rehash in place (same capacity) to get rid of them.
+				// Otherwise, the table is full and needs to grow.
+				const auto newCapacity = ( _size * 2 < _max_size_for_capacity( _capacity ) ) ? _capacity : _capacity_for_size( _size + 1 );
+				_rehash( std::max( newCapacity, impl::fhm_group_width ) );
+				slotIndex = _find_first_non_full( pHash );
+			}
+
+			if( _ctrl[slotIndex] == impl::fhm_ctrl_empty )
+			{
+				--_growthLeft;
+			}
+
+			_ctrl[slotIndex] = _hash_h2( pHash );
+			++_size;
+
+			return slotIndex;
+		}
+
+		template <typename... TPArgs>
+		void _construct_slot( size_t pSlotIndex, TPArgs && ...pArgs )
+		{
+			slot_allocator_type slotAllocator{ _allocator };
+			std::allocator_traits<slot_allocator_type>::construct( slotAllocator, _slots + pSlotIndex, std::forward<TPArgs>( pArgs )... );
+		}
+
+		void _destroy_slot( size_t pSlotIndex ) noexcept
+		{
+			slot_allocator_type slotAllocator{ _allocator };
+			std::allocator_traits<slot_allocator_type>::destroy( slotAllocator, _slots + pSlotIndex );
+		}
+
+		void _erase_slot( size_t pSlotIndex ) noexcept
+		{
+			_destroy_slot( pSlotIndex );
+			--_size;
+
+			// If the group still has an empty slot, it has never been full, so no probe sequence could have
+			// passed through it. Such slot can safely become empty again. Otherwise, leave a tombstone.
+			const auto groupBase = pSlotIndex - ( pSlotIndex % impl::fhm_group_width );
+			const impl::fhm_ctrl_group ctrlGroup{ _ctrl + groupBase };
+
+			if( ctrlGroup.match_empty() != 0 )
+			{
+				_ctrl[pSlotIndex] = impl::fhm_ctrl_empty;
+				++_growthLeft;
+			}
+			else
+			{
+				_ctrl[pSlotIndex] = impl::fhm_ctrl_deleted;
+			}
+		}
+
+		template <typename TPElement>
+		void _insert_unique_unchecked( TPElement && pElement )
+		{
+			const auto keyHash = _hash_key( pElement.first );
+			const auto slotIndex = _prepare_insert_slot( keyHash );
+			_construct_slot( slotIndex, std::forward<TPElement>( pElement ) );
+		}
+
+		void _rehash( size_t pNewCapacity )
+		{
+			cppx_debug_assert( ( pNewCapacity % impl::fhm_group_width ) == 0 );
+			cppx_debug_assert( _max_size_for_capacity( pNewCapacity ) >= _size );
+
+			auto * oldCtrl = _ctrl;
+			auto * oldSlots = _slots;
+			const auto oldCapacity = _capacity;
+
+			ctrl_allocator_type ctrlAllocator{ _allocator };
+			slot_allocator_type slotAllocator{ _allocator };
+
+			_ctrl = std::allocator_traits<ctrl_allocator_type>::allocate( ctrlAllocator, pNewCapacity );
+			_slots = std::allocator_traits<slot_allocator_type>::allocate( slotAllocator, pNewCapacity );
+			_capacity = pNewCapacity;
+			_size = 0;
+			_growthLeft = _max_size_for_capacity( pNewCapacity );
+
+			std::fill( _ctrl, _ctrl + pNewCapacity, impl::fhm_ctrl_empty );
+
+			for( size_t slotIndex = 0; slotIndex < oldCapacity; ++slotIndex )
+			{
+				if( impl::fhm_ctrl_is_full( oldCtrl[slotIndex] ) )
+				{
+					_insert_unique_unchecked( std::move( oldSlots[slotIndex] ) );
+					std::allocator_traits<slot_allocator_type>::destroy( slotAllocator, oldSlots + slotIndex );
+				}
+			}
+
+			if( oldCapacity > 0 )
+			{
+				std::allocator_traits<ctrl_allocator_type>::deallocate( ctrlAllocator, oldCtrl, oldCapacity );
+				std::allocator_traits<slot_allocator_type>::deallocate( slotAllocator, oldSlots, oldCapacity );
+			}
+		}
+
+		void _release_storage() noexcept
+		{
+			if( _capacity > 0 )
+			{
+				clear();
+
+				ctrl_allocator_type ctrlAllocator{ _allocator };
+				slot_allocator_type slotAllocator{ _allocator };
+
+				std::allocator_traits<ctrl_allocator_type>::deallocate( ctrlAllocator, _ctrl, _capacity );
+				std::allocator_traits<slot_allocator_type>::deallocate( slotAllocator, _slots, _capacity );
+
+				_ctrl = nullptr;
+				_slots = nullptr;
+				_capacity = 0;
+				_growthLeft = 0;
+			}
+		}
+
+	private:
+		hasher _hasher;
+		key_equal _keyEqual;
+		allocator_type _allocator;
+		impl::fhm_ctrl_t * _ctrl = nullptr;
+		value_type * _slots = nullptr;
+		size_t _capacity = 0;
+		size_t _size = 0;
+		size_t _growthLeft = 0;
+	};
+
+	template <typename TPKey, typename TPValue, typename TPHasher, typename TPKeyEqual, typename TPAllocator>
+	inline void swap( flat_hash_map<TPKey, TPValue, TPHasher, TPKeyEqual, TPAllocator> & pFirst, flat_hash_map<TPKey, TPValue, TPHasher, TPKeyEqual, TPAllocator> & pSecond )
+	{
+		pFirst.swap( pSecond );
+	}
+
+	/// @brief Transparent string hasher for flat_hash_map. All supported string types produce the same hash for the
+	/// same content, so a map with std::string or immutable_string keys can be queried with views or C-strings
+	/// without creating a temporary key object.
+	struct flat_hash_str_hash
+	{
+		using is_transparent = void;
+
+		CPPX_ATTR_NO_DISCARD size_t operator()( const std::string_view & pString ) const noexcept
+		{
+			return static_cast<size_t>( hash_compute<hash_algo::fnv1a64>( static_cast<const void *>( pString.data() ), pString.length() ).value );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t operator()( const std::string & pString ) const noexcept
+		{
+			return ( *this )( std::string_view{ pString } );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t operator()( const string_view & pString ) const noexcept
+		{
+			return ( *this )( std::string_view{ pString.data(), pString.length() } );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t operator()( const immutable_string & pString ) const noexcept
+		{
+			return ( *this )( std::string_view{ pString.data(), pString.length() } );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t operator()( const char * pString ) const noexcept
+		{
+			return ( *this )( std::string_view{ pString } );
+		}
+	};
+
+	/// @brief Transparent string equality predicate for flat_hash_map. See flat_hash_str_hash.
+	struct flat_hash_str_equal
+	{
+		using is_transparent = void;
+
+		template <typename TPLhs, typename TPRhs>
+		CPPX_ATTR_NO_DISCARD bool operator()( const TPLhs & pLhs, const TPRhs & pRhs ) const noexcept
+		{
+			return _as_view( pLhs ) == _as_view( pRhs );
+		}
+
+	private:
+		static std::string_view _as_view( const std::string_view & pString ) noexcept
+		{
+			return pString;
+		}
+
+		static std::string_view _as_view( const std::string & pString ) noexcept
+		{
+			return { pString.data(), pString.length() };
+		}
+
+		static std::string_view _as_view( const string_view & pString ) noexcept
+		{
+			return { pString.data(), pString.length() };
+		}
+
+		static std::string_view _as_view( const immutable_string & pString ) noexcept
+		{
+			return { pString.data(), pString.length() };
+		}
+
+		static std::string_view _as_view( const char * pString ) noexcept
+		{
+			return { pString };
+		}
+	};
+
+	/// @brief flat_hash_map with string keys and support for heterogeneous lookup.
+	template <typename TPKey, typename TPValue>
+	using flat_hash_str_map = flat_hash_map<TPKey, TPValue, flat_hash_str_hash, flat_hash_str_equal>;
+
+}
+
+#endif // __CPPX_FLAT_HASH_MAP_H__
@@ -3,29 +3,55 @@
 #define __CPPX_FLAT_MAP_H__
 
 #include "sortedArray.h"
+#include <tuple>
 
 namespace cppx
 {
 
+	/// @brief An associative container with std::map-like interface, which stores its elements in a contiguous,
+	/// sorted array (cppx::sorted_array). Lookup is a binary search over a continuous memory block, which makes it
+	/// much more cache-friendly than the node-based std::map. Insertion and removal are O(N) in the worst case, so
+	/// flat_map is intended for tables that are mostly read, or filled once and then queried (caches, registries).
+	/// @tparam TPKey Type of the key.
+	/// @tparam TPValue Type of the mapped value.
+	/// @tparam TPComparator Key comparator. Transparent comparators (like cmp_less_transparent) enable heterogeneous lookup.
+	/// @tparam TPAllocator Allocator used by the underlying storage.
 	template < typename TPKey,
 	           typename TPValue,
-	           typename TPComparator = cmp_less_auto<TPValue>,
-	           typename TPAllocator = std::allocator<TPValue> >
+	           typename TPComparator = cmp_less_transparent,
+	           typename TPAllocator = std::allocator<std::pair<TPKey, TPValue>> >
 	class flat_map
 	{
 	public:
-		using self_type = flat_map<TPValue, TPComparator, TPAllocator>;
+		using self_type = flat_map<TPKey, TPValue, TPComparator, TPAllocator>;
 		using key_type = TPKey;
-		using value_type = TPValue;
-		using compare_type = TPComparator;
+		using mapped_type = TPValue;
+		using value_type = std::pair<TPKey, TPValue>;
+		using key_compare = TPComparator;
 
-		struct element
+		/// Adapter for the key comparator, which allows comparing elements stored in the
+		/// array with each other as well as with keys (or any key-comparable values).
+		struct element_compare
 		{
-			TPKey key;
-			TPValue value;
+			bool operator()( const value_type & pLhs, const value_type & pRhs ) const
+			{
+				return key_compare{}( pLhs.first, pRhs.first );
+			}
+
+			template <typename TPRef>
+			bool operator()( const value_type & pLhs, const TPRef & pRhs ) const
+			{
+				return key_compare{}( pLhs.first, pRhs );
+			}
+
+			template <typename TPRef>
+			bool operator()( const TPRef & pLhs, const value_type & pRhs ) const
+			{
+				return key_compare{}( pLhs, pRhs.first );
+			}
 		};
 
-		using underlying_container_type = sorted_array<element, TPComparator, TPAllocator>;
+		using underlying_container_type = sorted_array<value_type, element_compare, TPAllocator>;
 
 		using iterator = typename underlying_container_type::iterator;
 		using const_iterator = typename underlying_container_type::const_iterator;
@@ -49,20 +75,291 @@ namespace cppx
 		: _underlyingContainer( pCapacity, pAllocator )
 		{}
 
-		TPValue & operator[]( size_t pIndex )
+		flat_map( std::initializer_list<value_type> pElements )
+		{
+			_underlyingContainer.reserve( pElements.size() );
+			for( const auto & element : pElements )
+			{
+				insert( element );
+			}
+		}
+
+		/// @brief Returns a reference to the value mapped to the specified key. If the key is not present, a new
+		/// value-initialized element is inserted first. Works exactly like std::map::operator[].
+		TPValue & operator[]( const key_type & pKey )
+		{
+			return try_emplace( pKey ).first->second;
+		}
+
+		TPValue & operator[]( key_type && pKey )
+		{
+			return try_emplace( std::move( pKey ) ).first->second;
+		}
+
+		/// @brief Returns a reference to the value mapped to the specified key. Throws std::out_of_range if the key is not present.
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD TPValue & at( const TPRef & pKey )
+		{
+			const auto elementIter = find( pKey );
+			if( elementIter == end() )
+			{
+				throw std::out_of_range( "flat_map::at(): key not found" );
+			}
+			return elementIter->second;
+		}
+
+		/// @brief Returns a reference to the value mapped to the specified key. Throws std::out_of_range if the key is not present.
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const TPValue & at( const TPRef & pKey ) const
+		{
+			const auto elementIter = find( pKey );
+			if( elementIter == end() )
+			{
+				throw std::out_of_range( "flat_map::at(): key not found" );
+			}
+			return elementIter->second;
+		}
+
+		/// @brief Returns the element at the specified position in the sorted order.
+		CPPX_ATTR_NO_DISCARD value_type & element_at( size_t pIndex )
 		{
 			return _underlyingContainer[pIndex];
 		}
 
-		CPPX_ATTR_NO_DISCARD const TPValue & operator[]( size_t pIndex ) const
+		/// @brief Returns the element at the specified position in the sorted order.
+		CPPX_ATTR_NO_DISCARD const value_type & element_at( size_t pIndex ) const
 		{
 			return _underlyingContainer[pIndex];
 		}
 
+		CPPX_ATTR_NO_DISCARD value_type * data() noexcept
+		{
+			return _underlyingContainer.data();
+		}
+
+		CPPX_ATTR_NO_DISCARD const value_type * data() const noexcept
+		{
+			return _underlyingContainer.data();
+		}
+
+		CPPX_ATTR_NO_DISCARD iterator begin()
+		{
+			return _underlyingContainer.begin();
+		}
+
+		CPPX_ATTR_NO_DISCARD const_iterator begin() const
+		{
+			return _underlyingContainer.begin();
+		}
+
+		CPPX_ATTR_NO_DISCARD iterator end()
+		{
+			return _underlyingContainer.end();
+		}
+
+		CPPX_ATTR_NO_DISCARD const_iterator end() const
+		{
+			return _underlyingContainer.end();
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD iterator lower_bound( const TPRef & pKey )
+		{
+			return _underlyingContainer.lower_bound( pKey, element_compare{} );
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const_iterator lower_bound( const TPRef & pKey ) const
+		{
+			return _underlyingContainer.lower_bound( pKey, element_compare{} );
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD iterator upper_bound( const TPRef & pKey )
+		{
+			return _underlyingContainer.upper_bound( pKey, element_compare{} );
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const_iterator upper_bound( const TPRef & pKey ) const
+		{
+			return _underlyingContainer.upper_bound( pKey, element_compare{} );
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD iterator find( const TPRef & pKey )
+		{
+			const auto elementIter = lower_bound( pKey );
+			return _is_key_at( elementIter, pKey ) ? elementIter : end();
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD const_iterator find( const TPRef & pKey ) const
+		{
+			const auto elementIter = lower_bound( pKey );
+			return _is_key_at( elementIter, pKey ) ? elementIter : end();
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD bool contains( const TPRef & pKey ) const
+		{
+			return _is_key_at( lower_bound( pKey ), pKey );
+		}
+
+		template <typename TPRef>
+		CPPX_ATTR_NO_DISCARD size_t count( const TPRef & pKey ) const
+		{
+			return contains( pKey ) ? 1u : 0u;
+		}
+
+		/// @brief Inserts a new element constructed from the specified args, if there is no element with the given key.
+		/// @return A pair with an iterator to the element with the specified key and a flag indicating if insertion took place.
+		template <typename TPKeyRef, typename... TPArgs>
+		std::pair<iterator, bool> try_emplace( TPKeyRef && pKey, TPArgs && ...pArgs )
+		{
+			auto insertIter = lower_bound( pKey );
+			if( _is_key_at( insertIter, pKey ) )
+			{
+				return { insertIter, false };
+			}
+
+			insertIter = _underlyingContainer.emplace_at(
+				insertIter,
+				std::piecewise_construct,
+				std::forward_as_tuple( std::forward<TPKeyRef>( pKey ) ),
+				std::forward_as_tuple( std::forward<TPArgs>( pArgs )... ) );
+
+			return { insertIter, true };
+		}
+
+		template <typename... TPArgs>
+		std::pair<iterator, bool> emplace( const key_type & pKey, TPArgs && ...pArgs )
+		{
+			return try_emplace( pKey, std::forward<TPArgs>( pArgs )... );
+		}
+
+		template <typename... TPArgs>
+		std::pair<iterator, bool> emplace( key_type && pKey, TPArgs && ...pArgs )
+		{
+			return try_emplace( std::move( pKey ), std::forward<TPArgs>( pArgs )... );
+		}
+
+		std::pair<iterator, bool> insert( const value_type & pElement )
+		{
+			return try_emplace( pElement.first, pElement.second );
+		}
+
+		std::pair<iterator, bool> insert( value_type && pElement )
+		{
+			return try_emplace( std::move( pElement.first ), std::move( pElement.second ) );
+		}
+
+		/// @brief Inserts a new element or, if the key already exists, assigns the specified value to it.
+		template <typename TPKeyRef, typename TPValueRef>
+		std::pair<iterator, bool> insert_or_assign( TPKeyRef && pKey, TPValueRef && pValue )
+		{
+			auto insertResult = try_emplace( std::forward<TPKeyRef>( pKey ), std::forward<TPValueRef>( pValue ) );
+			if( !insertResult.second )
+			{
+				insertResult.first->second = std::forward<TPValueRef>( pValue );
+			}
+			return insertResult;
+		}
+
+		iterator erase( iterator pIter )
+		{
+			return _underlyingContainer.erase( pIter );
+		}
+
+		iterator erase( const_iterator pIter )
+		{
+			return _underlyingContainer.erase( pIter );
+		}
+
+		iterator erase( const_iterator pStart, const_iterator pEnd )
+		{
+			return _underlyingContainer.erase( pStart, pEnd );
+		}
+
+		/// @brief Removes the element with the specified key, if present.
+		/// @return Number of elements removed (0 or 1).
+		template <typename TPRef>
+		size_t erase( const TPRef & pKey )
+		{
+			const auto elementIter = find( pKey );
+			if( elementIter != end() )
+			{
+				_underlyingContainer.erase( elementIter );
+				return 1;
+			}
+			return 0;
+		}
+
+		/// @brief Replaces the content of the map with the specified array. Elements are sorted once and duplicated
+		/// keys are removed (the first occurrence is kept). Much faster than inserting elements one by one.
+		void set_data( typename underlying_container_type::UnderlyingContainerType pElements )
+		{
+			std::stable_sort( pElements.begin(), pElements.end(), element_compare{} );
+
+			auto uniqueEnd = std::unique( pElements.begin(), pElements.end(),
+				[]( const value_type & pLhs, const value_type & pRhs ) -> bool {
+					return !key_compare{}( pLhs.first, pRhs.first ) && !key_compare{}( pRhs.first, pLhs.first );
+				});
+
+			pElements.erase( uniqueEnd, pElements.end() );
+
+			_underlyingContainer.setData( std::move( pElements ) );
+		}
+
+		void clear()
+		{
+			_underlyingContainer.clear();
+		}
+
+		void reserve( size_t pCapacity )
+		{
+			_underlyingContainer.reserve( pCapacity );
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t size() const
+		{
+			return _underlyingContainer.size();
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t capacity() const
+		{
+			return _underlyingContainer.capacity();
+		}
+
+		CPPX_ATTR_NO_DISCARD bool empty() const
+		{
+			return _underlyingContainer.empty();
+		}
+
+		void swap( self_type & pOther )
+		{
+			_underlyingContainer.swap( pOther._underlyingContainer );
+		}
+
+	private:
+		template <typename TPIterator, typename TPRef>
+		bool _is_key_at( TPIterator pIter, const TPRef & pKey ) const
+		{
+			// lower_bound() returns the first element which is not less than the key,
+			// so it is a match if the key is not less than the element as well.
+			return ( pIter != _underlyingContainer.end() ) && !key_compare{}( pKey, pIter->first );
+		}
+
 	private:
 		underlying_container_type _underlyingContainer;
 	};
 
+	template <typename TPKey, typename TPValue, typename TPComparator, typename TPAllocator>
+	inline void swap( flat_map<TPKey, TPValue, TPComparator, TPAllocator> & pFirst, flat_map<TPKey, TPValue, TPComparator, TPAllocator> & pSecond )
+	{
+		pFirst.swap( pSecond );
+	}
+
 }
 
 #endif // __CPPX_FLAT_MAP_H__
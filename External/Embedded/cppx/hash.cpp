@@ -2,6 +2,7 @@
 #include "hash.h"
 #include "typeLimits.h"
 #include <zlib/zlib.h>
+#include <cstring>
 
 namespace cppx
 {
@@ -34,16 +35,124 @@ namespace cppx
 		uint32 result = pHash;
 		if( pInputSize > 0 )
 		{
+			// Note: SSE4.2 CRC32 instruction implements CRC-32C (different polynomial), hence it cannot be used here.
+			// See hash_algo::crc32c for the hardware-accelerated variant.
 			const byte * inputBytes = reinterpret_cast<const byte *>( pInput );
-		#if( EBS_EIS_SUPPORT_LEVEL & ECL_EIS_FEATURE_SSE42 )
-			for( ; pInputSize >= 4; inputBytes += 4, pInputSize -= 4 )
+			auto tmpres = crc32( pHash, inputBytes, static_cast<uInt>( pInputSize ) );
+			result = static_cast<uint32>( tmpres );
+		}
+		return result;
+	}
+
+
+	namespace
+	{
+
+		constexpr uint32 sCRC32CPolynomial = 0x82F63B78; // Reversed 0x1EDC6F41
+
+		/// Lookup tables for the slice-by-8 software implementation of CRC-32C.
+		struct CRC32CTables
+		{
+			uint32 data[8][256];
+
+			constexpr CRC32CTables()
+			: data{}
 			{
-				auto tmpres = _mm_crc32_u32( result, *( reinterpret_cast<const uint32 *>( inputBytes ) ) );
-				result = static_cast<uint32>( tmpres );
+				for( uint32 byteValue = 0; byteValue < 256; ++byteValue )
+				{
+					uint32 crc = byteValue;
+					for( uint32 bitIndex = 0; bitIndex < 8; ++bitIndex )
+					{
+						crc = ( crc >> 1 ) ^ ( ( crc & 1u ) ? sCRC32CPolynomial : 0u );
+					}
+					data[0][byteValue] = crc;
+				}
+				for( uint32 byteValue = 0; byteValue < 256; ++byteValue )
+				{
+					for( uint32 sliceIndex = 1; sliceIndex < 8; ++sliceIndex )
+					{
+						const auto previous = data[sliceIndex - 1][byteValue];
+						data[sliceIndex][byteValue] = ( previous >> 8 ) ^ data[0][previous & 0xFF];
+					}
+				}
 			}
+		};
+
+		inline uint64 readUnaligned64( const byte * pInput )
+		{
+			uint64 result;
+			std::memcpy( &result, pInput, sizeof( uint64 ) );
+			return result;
+		}
+
+		inline uint32 readUnaligned32( const byte * pInput )
+		{
+			uint32 result;
+			std::memcpy( &result, pInput, sizeof( uint32 ) );
+			return result;
+		}
+
+	#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE42 )
+		uint32 crc32cUpdateRaw( uint32 pCRC, const byte * pInput, size_t pInputSize )
+		{
+		#if( PCL_TARGET_64 )
+			uint64 crc64 = pCRC;
+			for( ; pInputSize >= 8; pInput += 8, pInputSize -= 8 )
+			{
+				crc64 = _mm_crc32_u64( crc64, readUnaligned64( pInput ) );
+			}
+			pCRC = static_cast<uint32>( crc64 );
 		#endif
-			auto tmpres = crc32( pHash, inputBytes, static_cast<uInt>( pInputSize ) );
-			result = static_cast<uint32>( tmpres );
+			for( ; pInputSize >= 4; pInput += 4, pInputSize -= 4 )
+			{
+				pCRC = _mm_crc32_u32( pCRC, readUnaligned32( pInput ) );
+			}
+			for( ; pInputSize > 0; ++pInput, --pInputSize )
+			{
+				pCRC = _mm_crc32_u8( pCRC, *pInput );
+			}
+			return pCRC;
+		}
+	#else
+		constexpr CRC32CTables sCRC32CTables{};
+
+		uint32 crc32cUpdateRaw( uint32 pCRC, const byte * pInput, size_t pInputSize )
+		{
+			const auto & tables = sCRC32CTables.data;
+
+		#if( PCL_ENDIANNESS_NATIVE == PCL_ENDIANNESS_LE )
+			for( ; pInputSize >= 8; pInput += 8, pInputSize -= 8 )
+			{
+				const auto lowWord = readUnaligned32( pInput ) ^ pCRC;
+				const auto highWord = readUnaligned32( pInput + 4 );
+				pCRC = tables[7][lowWord & 0xFF] ^ tables[6][( lowWord >> 8 ) & 0xFF] ^
+				       tables[5][( lowWord >> 16 ) & 0xFF] ^ tables[4][lowWord >> 24] ^
+				       tables[3][highWord & 0xFF] ^ tables[2][( highWord >> 8 ) & 0xFF] ^
+				       tables[1][( highWord >> 16 ) & 0xFF] ^ tables[0][highWord >> 24];
+			}
+		#endif
+			for( ; pInputSize > 0; ++pInput, --pInputSize )
+			{
+				pCRC = ( pCRC >> 8 ) ^ tables[0][( pCRC ^ *pInput ) & 0xFF];
+			}
+			return pCRC;
+		}
+	#endif
+
+	}
+
+	uint32 hash_traits<hash_algo::crc32c>::compute( const void * pInput, size_t pInputSize )
+	{
+		return update( init_value, pInput, pInputSize );
+	}
+
+	uint32 hash_traits<hash_algo::crc32c>::update( uint32 pHash, const void * pInput, size_t pInputSize )
+	{
+		uint32 result = pHash;
+		if( pInputSize > 0 )
+		{
+			const byte * inputBytes = reinterpret_cast<const byte *>( pInput );
+			result = ~crc32cUpdateRaw( ~pHash, inputBytes, pInputSize );
 		}
 		return result;
 	}
@@ -135,4 +244,112 @@ namespace cppx
 		return result;
 	}
 
+
+	namespace
+	{
+
+		constexpr uint64 sWyhashSecret[4] =
+		{
+			0x2D358DCCAA6C78A5, 0x8BB84B93962EACC9, 0x4B33A62ED433D4A3, 0x4D5A2DA51DE1AA47
+		};
+
+		/// Full 64x64->128 bit multiplication. Stores the low part of the result in pA and the high part in pB.
+		inline void wyMum( uint64 & pA, uint64 & pB )
+		{
+		#if defined( __SIZEOF_INT128__ )
+			const auto result = static_cast<unsigned __int128>( pA ) * pB;
+			pA = static_cast<uint64>( result );
+			pB = static_cast<uint64>( result >> 64 );
+		#elif( ( PCL_COMPILER & PCL_COMPILER_MSVC ) && defined( _M_X64 ) )
+			pA = _umul128( pA, pB, &pB );
+		#else
+			const uint64 aHigh = pA >> 32, aLow = static_cast<uint32>( pA );
+			const uint64 bHigh = pB >> 32, bLow = static_cast<uint32>( pB );
+			const uint64 rHH = aHigh * bHigh, rHL = aHigh * bLow, rLH = aLow * bHigh, rLL = aLow * bLow;
+			const uint64 t = rLL + ( rHL << 32 );
+			uint64 low = t + ( rLH << 32 );
+			uint64 high = rHH + ( rHL >> 32 ) + ( rLH >> 32 ) + ( t < rLL ) + ( low < t );
+			pA = low;
+			pB = high;
+		#endif
+		}
+
+		inline uint64 wyMix( uint64 pA, uint64 pB )
+		{
+			wyMum( pA, pB );
+			return pA ^ pB;
+		}
+
+		inline uint64 wyRead3( const byte * pInput, size_t pInputSize )
+		{
+			return ( static_cast<uint64>( pInput[0] ) << 16 ) | ( static_cast<uint64>( pInput[pInputSize >> 1] ) << 8 ) | pInput[pInputSize - 1];
+		}
+
+	}
+
+	uint64 hash_traits<hash_algo::wyhash64>::compute( const void * pInput, size_t pInputSize )
+	{
+		return update( init_value, pInput, pInputSize );
+	}
+
+	uint64 hash_traits<hash_algo::wyhash64>::update( uint64 pHash, const void * pInput, size_t pInputSize )
+	{
+		const byte * inputBytes = reinterpret_cast<const byte *>( pInput );
+
+		uint64 seed = pHash ^ wyMix( pHash ^ sWyhashSecret[0], sWyhashSecret[1] );
+		uint64 a = 0;
+		uint64 b = 0;
+
+		if( pInputSize <= 16 )
+		{
+			if( pInputSize >= 4 )
+			{
+				const auto offset = ( pInputSize >> 3 ) << 2;
+				a = ( static_cast<uint64>( readUnaligned32( inputBytes ) ) << 32 ) | readUnaligned32( inputBytes + offset );
+				b = ( static_cast<uint64>( readUnaligned32( inputBytes + pInputSize - 4 ) ) << 32 ) | readUnaligned32( inputBytes + pInputSize - 4 - offset );
+			}
+			else if( pInputSize > 0 )
+			{
+				a = wyRead3( inputBytes, pInputSize );
+			}
+		}
+		else
+		{
+			size_t remainingSize = pInputSize;
+			if( remainingSize >= 48 )
+			{
+				// Three independent lanes keep the multipliers busy (no dependency between consecutive multiplications).
+				uint64 seed1 = seed;
+				uint64 seed2 = seed;
+				do
+				{
+					seed = wyMix( readUnaligned64( inputBytes ) ^ sWyhashSecret[1], readUnaligned64( inputBytes + 8 ) ^ seed );
+					seed1 = wyMix( readUnaligned64( inputBytes + 16 ) ^ sWyhashSecret[2], readUnaligned64( inputBytes + 24 ) ^ seed1 );
+					seed2 = wyMix( readUnaligned64( inputBytes + 32 ) ^ sWyhashSecret[3], readUnaligned64( inputBytes + 40 ) ^ seed2 );
+					inputBytes += 48;
+					remainingSize -= 48;
+				}
+				while( remainingSize >= 48 );
+
+				seed ^= seed1 ^ seed2;
+			}
+
+			while( remainingSize > 16 )
+			{
+				seed = wyMix( readUnaligned64( inputBytes ) ^ sWyhashSecret[1], readUnaligned64( inputBytes + 8 ) ^ seed );
+				inputBytes += 16;
+				remainingSize -= 16;
+			}
+
+			a = readUnaligned64( inputBytes + remainingSize - 16 );
+			b = readUnaligned64( inputBytes + remainingSize - 8 );
+		}
+
+		a ^= sWyhashSecret[1];
+		b ^= seed;
+		wyMum( a, b );
+
+		return wyMix( a ^ sWyhashSecret[0] ^ pInputSize, b ^ sWyhashSecret[1] );
+	}
+
 }
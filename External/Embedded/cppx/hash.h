@@ -14,10 +14,12 @@ namespace cppx
 	{
 		adler32,
 		crc32,
+		crc32c,
 		djb2,
 		fnv1a32,
 		fnv1a64,
-		sdbm
+		sdbm,
+		wyhash64
 	};
 
 	struct hash_input
@@ -290,6 +292,17 @@ namespace cppx
 		static uint32 update( uint32 pHash, const void * pInput, size_t pInputSize );
 	};
 
+	/// CRC-32C (Castagnoli polynomial). Uses the SSE4.2 CRC32 instruction if available, slice-by-8 tables otherwise.
+	/// The hash value is the final (inverted) CRC, so update() over consecutive blocks gives the same result as
+	/// compute() over the whole input.
+	template <>
+	struct hash_traits<hash_algo::crc32c> : public hash_common_traits<uint32>
+	{
+		static constexpr uint32 init_value = 0u;
+		static uint32 compute( const void * pInput, size_t pInputSize );
+		static uint32 update( uint32 pHash, const void * pInput, size_t pInputSize );
+	};
+
 	template <>
 	struct hash_traits<hash_algo::djb2> : public hash_common_traits<uint32>
 	{
@@ -322,6 +335,18 @@ namespace cppx
 		static uint32 update( uint32 pHash, const void * pInput, size_t pInputSize );
 	};
 
+	/// wyhash (final version 4.2): a fast, high quality 64-bit hash, processing 48 bytes per iteration in three
+	/// independent lanes. Several times faster than the byte-wise hashes for anything longer than a few bytes.
+	/// update() uses the previous hash as a seed, so it is suitable for combining hashes of multiple values, but
+	/// (unlike FNV or CRC) the result is not equal to the hash of the concatenated input.
+	template <>
+	struct hash_traits<hash_algo::wyhash64> : public hash_common_traits<uint64>
+	{
+		static constexpr uint64 init_value = 0u;
+		static uint64 compute( const void * pInput, size_t pInputSize );
+		static uint64 update( uint64 pHash, const void * pInput, size_t pInputSize );
+	};
+
 	template <typename TPValue, hash_algo tpHashAlgo = hash_algo::sdbm>
 	struct hash_std_proxy
 	{
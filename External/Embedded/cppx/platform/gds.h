@@ -4,6 +4,7 @@
 
 #include "platform.h"
 #include <cmath>
+#include <cstring>
 
 namespace cppx
 {
@@ -136,31 +137,30 @@ namespace cppx
 		template <>
 		struct IntegralTypeSerializeProxy<2>
 		{
+			// Serialized data is not aligned, so values are copied with memcpy() (a single load/store on platforms
+			// which allow unaligned access). The same applies to the 4- and 8-byte versions below.
+
 			template <typename TVal>
 			static inline void serializeIntegral( byte_order pByteOrder, byte * pOutputBuffer, const TVal pValue )
 			{
-				if( pByteOrder == byte_order::platform_native )
-				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = pValue;
-				}
-				else
+				auto value = static_cast<uint16>( pValue );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = static_cast<TVal>( PCL_BSWAP16( static_cast<uint16>( pValue ) ) );
+					value = static_cast<uint16>( PCL_BSWAP16( value ) );
 				}
+				std::memcpy( pOutputBuffer, &value, sizeof( value ) );
 			}
 
-			/// @brief Specialization of IntegralTypeSerializeProxy for 4-byte integral types.
 			template <typename TVal>
 			static inline TVal deserializeIntegral( byte_order pByteOrder, const byte * pInputData )
 			{
-				if( pByteOrder == byte_order::platform_native )
+				uint16 value;
+				std::memcpy( &value, pInputData, sizeof( value ) );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					return *( reinterpret_cast<const TVal *>( pInputData ) );
-				}
-				else
-				{
-					return static_cast<TVal>( PCL_BSWAP16( *( reinterpret_cast<const uint16 *>( pInputData ) ) ) );
+					value = static_cast<uint16>( PCL_BSWAP16( value ) );
 				}
+				return static_cast<TVal>( value );
 			}
 		};
 
@@ -171,27 +171,24 @@ namespace cppx
 			template <typename TVal>
 			static inline void serializeIntegral( byte_order pByteOrder, byte * pOutputBuffer, const TVal pValue )
 			{
-				if( pByteOrder == byte_order::platform_native )
-				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = pValue;
-				}
-				else
+				auto value = static_cast<uint32>( pValue );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = static_cast<TVal>( PCL_BSWAP32( static_cast<uint32>( pValue ) ) );
+					value = static_cast<uint32>( PCL_BSWAP32( value ) );
 				}
+				std::memcpy( pOutputBuffer, &value, sizeof( value ) );
 			}
 
 			template <typename TVal>
 			static inline TVal deserializeIntegral( byte_order pByteOrder, const byte * pInputData )
 			{
-				if( pByteOrder == byte_order::platform_native )
+				uint32 value;
+				std::memcpy( &value, pInputData, sizeof( value ) );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					return *( reinterpret_cast<const TVal *>( pInputData ) );
-				}
-				else
-				{
-					return static_cast<TVal>( PCL_BSWAP32( *( reinterpret_cast<const uint32 *>( pInputData ) ) ) );
+					value = static_cast<uint32>( PCL_BSWAP32( value ) );
 				}
+				return static_cast<TVal>( value );
 			}
 		};
 
@@ -202,27 +199,24 @@ namespace cppx
 			template <typename TVal>
 			static inline void serializeIntegral( byte_order pByteOrder, byte * pOutputBuffer, const TVal pValue )
 			{
-				if( pByteOrder == byte_order::platform_native )
-				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = pValue;
-				}
-				else
+				auto value = static_cast<uint64>( pValue );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					*( reinterpret_cast<TVal *>( pOutputBuffer ) ) = static_cast<TVal>( PCL_BSWAP64( static_cast<uint64>( pValue ) ) );
+					value = static_cast<uint64>( PCL_BSWAP64( value ) );
 				}
+				std::memcpy( pOutputBuffer, &value, sizeof( value ) );
 			}
 
 			template <typename TVal>
 			static inline TVal deserializeIntegral( byte_order pByteOrder, const byte * pInputData )
 			{
-				if( pByteOrder == byte_order::platform_native )
+				uint64 value;
+				std::memcpy( &value, pInputData, sizeof( value ) );
+				if( pByteOrder != byte_order::platform_native )
 				{
-					return *( reinterpret_cast<const TVal *>( pInputData ) );
-				}
-				else
-				{
-					return static_cast<TVal>( PCL_BSWAP64( *( reinterpret_cast<const uint64 *>( pInputData ) ) ) );
+					value = static_cast<uint64>( PCL_BSWAP64( value ) );
 				}
+				return static_cast<TVal>( value );
 			}
 		};
 
@@ -242,7 +236,7 @@ namespace cppx
 		inline void serializePrimitive<float>( byte_order pByteOrder, byte * pOutputBuffer, const float pValue )
 		{
 			int exponent; auto base = frexpf( pValue, &exponent ) * CX_SERIALIZE_FLT32_DECIMAL_PRECISION;
-			serializePrimitive<uint32>( pByteOrder, pOutputBuffer, static_cast<uint32>( base ) );
+			serializePrimitive<int32>( pByteOrder, pOutputBuffer, static_cast<int32>( base ) );
 			serializePrimitive<uint32>( pByteOrder, pOutputBuffer + sizeof( uint32 ), static_cast<uint32>( exponent ) );
 		}
 
@@ -250,7 +244,7 @@ namespace cppx
 		inline void serializePrimitive<double>( byte_order pByteOrder, byte * pOutputBuffer, const double pValue )
 		{
 			int exponent; auto base = frexp( pValue, &exponent ) * CX_SERIALIZE_FLT64_DECIMAL_PRECISION;
-			serializePrimitive<uint32>( pByteOrder, pOutputBuffer, static_cast<uint32>( base ) );
+			serializePrimitive<int32>( pByteOrder, pOutputBuffer, static_cast<int32>( base ) );
 			serializePrimitive<uint32>( pByteOrder, pOutputBuffer + sizeof( uint32 ), static_cast<uint32>( exponent ) );
 		}
 
@@ -258,8 +252,8 @@ namespace cppx
 		inline void serializePrimitive<long double>( byte_order pByteOrder, byte * pOutputBuffer, const long double pValue )
 		{
 			int exponent; auto base = frexpl( pValue, &exponent ) * CX_SERIALIZE_FLT80_DECIMAL_PRECISION;
-			serializePrimitive<uint64>( pByteOrder, pOutputBuffer, static_cast<uint64>( base ) );
-			serializePrimitive<uint32>( pByteOrder, pOutputBuffer + sizeof( uint32 ), static_cast<uint32>( exponent ) );
+			serializePrimitive<int64>( pByteOrder, pOutputBuffer, static_cast<int64>( base ) );
+			serializePrimitive<uint32>( pByteOrder, pOutputBuffer + sizeof( int64 ), static_cast<uint32>( exponent ) );
 		}
 
 		template <typename TVal, std::enable_if_t<IsCharType<TVal>::sValue || IsArithmetic<TVal>::sValue, int> = 0>
@@ -277,24 +271,24 @@ namespace cppx
 		template <>
 		inline float deserializePrimitive<float>( byte_order pByteOrder, const byte * pInputData )
 		{
-			auto intBase = deserializePrimitive<uint32>( pByteOrder, pInputData );
-			auto exponent = deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) );
+			auto intBase = deserializePrimitive<int32>( pByteOrder, pInputData );
+			auto exponent = static_cast<int32>( deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) ) );
 			return ldexpf( static_cast<float>( intBase ) / CX_SERIALIZE_FLT32_DECIMAL_PRECISION, exponent );
 		}
 
 		template <>
 		inline double deserializePrimitive<double>( byte_order pByteOrder, const byte * pInputData )
 		{
-			auto intBase = deserializePrimitive<uint32>( pByteOrder, pInputData );
-			auto exponent = deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) );
+			auto intBase = deserializePrimitive<int32>( pByteOrder, pInputData );
+			auto exponent = static_cast<int32>( deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) ) );
 			return ldexp( static_cast<double>( intBase ) / CX_SERIALIZE_FLT64_DECIMAL_PRECISION, exponent );
 		}
 
 		template <>
 		inline long double deserializePrimitive<long double>( byte_order pByteOrder, const byte * pInputData )
 		{
-			auto intBase = deserializePrimitive<uint64>( pByteOrder, pInputData );
-			auto exponent = deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) );
+			auto intBase = deserializePrimitive<int64>( pByteOrder, pInputData );
+			auto exponent = static_cast<int32>( deserializePrimitive<uint32>( pByteOrder, pInputData + sizeof( intBase ) ) );
 			return ldexpl( static_cast<long double>( intBase ) / CX_SERIALIZE_FLT80_DECIMAL_PRECISION, exponent );
 		}
 
@@ -325,6 +319,8 @@ namespace cppx
 
 			void set( TInternal pValue ) const
 			{
+				// Update the internal value as well, it is written back to the reference on destruction.
+				internalValue = pValue;
 				value.get() = static_cast<TRef>( pValue );
 			}
 		};
@@ -510,6 +510,8 @@
 #    define PCL_EIS_SUPPORT_COMPILER_LEVEL PCL_EIS_LEVEL_AVX2
 #  elif defined( __AVX__ )
 #    define PCL_EIS_SUPPORT_COMPILER_LEVEL PCL_EIS_LEVEL_AVX
+#  elif defined( __SSE4_2__ )
+#    define PCL_EIS_SUPPORT_COMPILER_LEVEL PCL_EIS_LEVEL_SSE42
 #  elif defined( __SSE4_1__ )
 #    define PCL_EIS_SUPPORT_COMPILER_LEVEL PCL_EIS_LEVEL_SSE41
 #  elif defined( __SSE3__ )
@@ -22,9 +22,9 @@
 #elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_AVX )
 #  include <immintrin.h>
 #elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE42 )
-#  include <smmintrin.h>
-#elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE41 )
 #  include <nmmintrin.h>
+#elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE41 )
+#  include <smmintrin.h>
 #elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE4A )
 #  include <ammintrin.h>
 #elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE3 )
@@ -132,6 +132,40 @@ namespace cppx
 			return _underlyingContainer.insert( insertIterator, pValue );
 		}
 
+		template < typename TRef, typename TRefCompare = compare_type >
+		CPPX_ATTR_NO_DISCARD iterator lower_bound( const TRef & pValue, TRefCompare pRefCompare = TRefCompare{} )
+		{
+			return std::lower_bound( _underlyingContainer.begin(), _underlyingContainer.end(), pValue, pRefCompare );
+		}
+
+		template < typename TRef, typename TRefCompare = compare_type >
+		CPPX_ATTR_NO_DISCARD const_iterator lower_bound( const TRef & pValue, TRefCompare pRefCompare = TRefCompare{} ) const
+		{
+			return std::lower_bound( _underlyingContainer.begin(), _underlyingContainer.end(), pValue, pRefCompare );
+		}
+
+		template < typename TRef, typename TRefCompare = compare_type >
+		CPPX_ATTR_NO_DISCARD iterator upper_bound( const TRef & pValue, TRefCompare pRefCompare = TRefCompare{} )
+		{
+			return std::upper_bound( _underlyingContainer.begin(), _underlyingContainer.end(), pValue, pRefCompare );
+		}
+
+		template < typename TRef, typename TRefCompare = compare_type >
+		CPPX_ATTR_NO_DISCARD const_iterator upper_bound( const TRef & pValue, TRefCompare pRefCompare = TRefCompare{} ) const
+		{
+			return std::upper_bound( _underlyingContainer.begin(), _underlyingContainer.end(), pValue, pRefCompare );
+		}
+
+		/// @brief Constructs a new element directly at the specified position, without searching for it.
+		/// The position must be a valid insert position for the new element (e.g. a result of lower_bound()
+		/// called with the same key), otherwise the ordering of the array is broken. Used by wrappers (like
+		/// flat_map), which need to check the existence of an element before inserting it.
+		template <typename... TPArgs>
+		iterator emplace_at( const_iterator pPosition, TPArgs && ...pArgs )
+		{
+			return _underlyingContainer.emplace( pPosition, std::forward<TPArgs>( pArgs )... );
+		}
+
 		CPPX_ATTR_NO_DISCARD iterator find( const TPValue & pValue )
 		{
 			auto elementPos = _find_lower( pValue, compare_type{} );
@@ -213,12 +247,12 @@ namespace cppx
 			return 0u;
 		}
 
-		iterator erase( iterator pIter )
+		iterator erase( const_iterator pIter )
 		{
 			return _underlyingContainer.erase( pIter );
 		}
 
-		iterator erase( iterator pStart, iterator pEnd )
+		iterator erase( const_iterator pStart, const_iterator pEnd )
 		{
 			return _underlyingContainer.erase( pStart, pEnd );
 		}
@@ -262,7 +296,7 @@ namespace cppx
 				compare_type{} );
 		}
 
-		void setData( std::vector<TPValue> pValueArray )
+		void setData( UnderlyingContainerType pValueArray )
 		{
 			_underlyingContainer = std::move( pValueArray );
 
@@ -287,6 +321,11 @@ namespace cppx
 			return _underlyingContainer.size();
 		}
 
+		CPPX_ATTR_NO_DISCARD size_t capacity() const
+		{
+			return _underlyingContainer.capacity();
+		}
+
 		CPPX_ATTR_NO_DISCARD bool empty() const
 		{
 			return _underlyingContainer.empty();
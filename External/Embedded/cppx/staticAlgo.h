@@ -65,6 +65,19 @@ namespace cppx
 		}
 	};
 
+	/// @brief Fully transparent variant of cmp_less: both arguments are deduced, so it can compare any two types for
+	/// which operator< is defined. Required by containers which support heterogeneous lookup (e.g. cppx::flat_map).
+	struct cmp_less_transparent
+	{
+		using is_transparent = void;
+
+		template <typename TP1, typename TP2>
+		constexpr bool operator()( const TP1 & pLhs, const TP2 & pRhs ) const
+		{
+			return pLhs < pRhs;
+		}
+	};
+
 	template <typename TP1, typename TP2 = TP1>
 	struct cmp_less_equal
 	{
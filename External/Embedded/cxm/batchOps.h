@@ -0,0 +1,219 @@
+
+#ifndef __CXM_BATCH_OPS_H__
+#define __CXM_BATCH_OPS_H__
+
+#include "bounds.h"
+
+namespace cxm
+{
+
+	/// @brief Structure-of-arrays view of 3-component vectors: each component is stored in a separate array.
+	/// Batch kernels process multiple elements per instruction, so this layout avoids any shuffling.
+	/// Use a const-qualified value type (e.g. vector3_soa<const float>) for input data.
+	template <typename TPValue>
+	struct vector3_soa
+	{
+		TPValue * x;
+		TPValue * y;
+		TPValue * z;
+
+		CPPX_ATTR_NO_DISCARD vector3_soa offset( size_t pOffset ) const noexcept
+		{
+			return { x + pOffset, y + pOffset, z + pOffset };
+		}
+	};
+
+	/// @brief Structure-of-arrays view of bounding spheres.
+	template <typename TPValue>
+	struct sphere_soa
+	{
+		vector3_soa<TPValue> center;
+		TPValue * radius;
+
+		CPPX_ATTR_NO_DISCARD sphere_soa offset( size_t pOffset ) const noexcept
+		{
+			return { center.offset( pOffset ), radius + pOffset };
+		}
+	};
+
+	/// @brief Structure-of-arrays view of AABBs. Center/extents form is used, as it is the natural
+	/// representation for both transformation and frustum tests (no conversion is needed in the kernels).
+	template <typename TPValue>
+	struct aabb_soa
+	{
+		vector3_soa<TPValue> center;
+		vector3_soa<TPValue> extents;
+
+		CPPX_ATTR_NO_DISCARD aabb_soa offset( size_t pOffset ) const noexcept
+		{
+			return { center.offset( pOffset ), extents.offset( pOffset ) };
+		}
+	};
+
+	/// @brief Returns the number of 32-bit words required to store a visibility mask for the specified number of objects.
+	CPPX_ATTR_NO_DISCARD constexpr size_t visibility_mask_words_num( size_t pObjectsNum ) noexcept
+	{
+		return ( pObjectsNum + 31 ) / 32;
+	}
+
+	/// @brief Transforms pCount points (implicit w = 1) by an affine matrix. Input and output may be the same arrays.
+	template <typename TPValue>
+	inline void transform_points_soa( const matrix4x4<TPValue> & pMatrix, vector3_soa<const TPValue> pInput, vector3_soa<TPValue> pOutput, size_t pCount )
+	{
+		for( size_t pointIndex = 0; pointIndex < pCount; ++pointIndex )
+		{
+			const TPValue srcX = pInput.x[pointIndex];
+			const TPValue srcY = pInput.y[pointIndex];
+			const TPValue srcZ = pInput.z[pointIndex];
+			pOutput.x[pointIndex] = pMatrix[0][0] * srcX + pMatrix[0][1] * srcY + pMatrix[0][2] * srcZ + pMatrix[0][3];
+			pOutput.y[pointIndex] = pMatrix[1][0] * srcX + pMatrix[1][1] * srcY + pMatrix[1][2] * srcZ + pMatrix[1][3];
+			pOutput.z[pointIndex] = pMatrix[2][0] * srcX + pMatrix[2][1] * srcY + pMatrix[2][2] * srcZ + pMatrix[2][3];
+		}
+	}
+
+	/// @brief Transforms pCount AABBs by an affine matrix, producing bounding boxes of the transformed boxes
+	/// (e.g. local -> world space bounds). Input and output may be the same arrays.
+	template <typename TPValue>
+	inline void transform_aabbs_soa( const matrix4x4<TPValue> & pMatrix, aabb_soa<const TPValue> pInput, aabb_soa<TPValue> pOutput, size_t pCount )
+	{
+		for( size_t boxIndex = 0; boxIndex < pCount; ++boxIndex )
+		{
+			const TPValue cX = pInput.center.x[boxIndex];
+			const TPValue cY = pInput.center.y[boxIndex];
+			const TPValue cZ = pInput.center.z[boxIndex];
+			const TPValue eX = pInput.extents.x[boxIndex];
+			const TPValue eY = pInput.extents.y[boxIndex];
+			const TPValue eZ = pInput.extents.z[boxIndex];
+
+			pOutput.center.x[boxIndex] = pMatrix[0][0] * cX + pMatrix[0][1] * cY + pMatrix[0][2] * cZ + pMatrix[0][3];
+			pOutput.center.y[boxIndex] = pMatrix[1][0] * cX + pMatrix[1][1] * cY + pMatrix[1][2] * cZ + pMatrix[1][3];
+			pOutput.center.z[boxIndex] = pMatrix[2][0] * cX + pMatrix[2][1] * cY + pMatrix[2][2] * cZ + pMatrix[2][3];
+
+			pOutput.extents.x[boxIndex] = std::abs( pMatrix[0][0] ) * eX + std::abs( pMatrix[0][1] ) * eY + std::abs( pMatrix[0][2] ) * eZ;
+			pOutput.extents.y[boxIndex] = std::abs( pMatrix[1][0] ) * eX + std::abs( pMatrix[1][1] ) * eY + std::abs( pMatrix[1][2] ) * eZ;
+			pOutput.extents.z[boxIndex] = std::abs( pMatrix[2][0] ) * eX + std::abs( pMatrix[2][1] ) * eY + std::abs( pMatrix[2][2] ) * eZ;
+		}
+	}
+
+	/// @brief Computes the bounding box of pCount points. pCount must be greater than zero.
+	template <typename TPValue>
+	inline aabb<TPValue> compute_bounds_soa( vector3_soa<const TPValue> pPoints, size_t pCount )
+	{
+		aabb<TPValue> result{
+			{ pPoints.x[0], pPoints.y[0], pPoints.z[0] },
+			{ pPoints.x[0], pPoints.y[0], pPoints.z[0] } };
+
+		for( size_t pointIndex = 1; pointIndex < pCount; ++pointIndex )
+		{
+			result.min_corner.x = std::min( result.min_corner.x, pPoints.x[pointIndex] );
+			result.min_corner.y = std::min( result.min_corner.y, pPoints.y[pointIndex] );
+			result.min_corner.z = std::min( result.min_corner.z, pPoints.z[pointIndex] );
+			result.max_corner.x = std::max( result.max_corner.x, pPoints.x[pointIndex] );
+			result.max_corner.y = std::max( result.max_corner.y, pPoints.y[pointIndex] );
+			result.max_corner.z = std::max( result.max_corner.z, pPoints.z[pointIndex] );
+		}
+
+		return result;
+	}
+
+	/// @brief Computes the bounding box of pCount AABBs (e.g. bounds of the whole scene or a cluster).
+	/// pCount must be greater than zero.
+	template <typename TPValue>
+	inline aabb<TPValue> compute_bounds_soa( aabb_soa<const TPValue> pBoxes, size_t pCount )
+	{
+		aabb<TPValue> result{
+			{ pBoxes.center.x[0] - pBoxes.extents.x[0], pBoxes.center.y[0] - pBoxes.extents.y[0], pBoxes.center.z[0] - pBoxes.extents.z[0] },
+			{ pBoxes.center.x[0] + pBoxes.extents.x[0], pBoxes.center.y[0] + pBoxes.extents.y[0], pBoxes.center.z[0] + pBoxes.extents.z[0] } };
+
+		for( size_t boxIndex = 1; boxIndex < pCount; ++boxIndex )
+		{
+			result.min_corner.x = std::min( result.min_corner.x, pBoxes.center.x[boxIndex] - pBoxes.extents.x[boxIndex] );
+			result.min_corner.y = std::min( result.min_corner.y, pBoxes.center.y[boxIndex] - pBoxes.extents.y[boxIndex] );
+			result.min_corner.z = std::min( result.min_corner.z, pBoxes.center.z[boxIndex] - pBoxes.extents.z[boxIndex] );
+			result.max_corner.x = std::max( result.max_corner.x, pBoxes.center.x[boxIndex] + pBoxes.extents.x[boxIndex] );
+			result.max_corner.y = std::max( result.max_corner.y, pBoxes.center.y[boxIndex] + pBoxes.extents.y[boxIndex] );
+			result.max_corner.z = std::max( result.max_corner.z, pBoxes.center.z[boxIndex] + pBoxes.extents.z[boxIndex] );
+		}
+
+		return result;
+	}
+
+	namespace impl
+	{
+
+		/// Sets visibility bits for spheres in range [pBegin, pEnd). Bits are only set (OR-ed), never cleared.
+		template <typename TPValue>
+		inline void frustum_cull_spheres_range( const frustum<TPValue> & pFrustum, sphere_soa<const TPValue> pSpheres, size_t pBegin, size_t pEnd, uint32 * pVisibilityMask )
+		{
+			for( size_t sphereIndex = pBegin; sphereIndex < pEnd; ++sphereIndex )
+			{
+				const sphere<TPValue> currentSphere{
+					{ pSpheres.center.x[sphereIndex], pSpheres.center.y[sphereIndex], pSpheres.center.z[sphereIndex] },
+					pSpheres.radius[sphereIndex] };
+
+				if( intersects( pFrustum, currentSphere ) )
+				{
+					pVisibilityMask[sphereIndex / 32] |= ( 1u << ( sphereIndex % 32 ) );
+				}
+			}
+		}
+
+		/// Sets visibility bits for boxes in range [pBegin, pEnd). Bits are only set (OR-ed), never cleared.
+		template <typename TPValue>
+		inline void frustum_cull_aabbs_range( const frustum<TPValue> & pFrustum, aabb_soa<const TPValue> pBoxes, size_t pBegin, size_t pEnd, uint32 * pVisibilityMask )
+		{
+			for( size_t boxIndex = pBegin; boxIndex < pEnd; ++boxIndex )
+			{
+				const vector3<TPValue> boxCenter{ pBoxes.center.x[boxIndex], pBoxes.center.y[boxIndex], pBoxes.center.z[boxIndex] };
+				const vector3<TPValue> boxExtents{ pBoxes.extents.x[boxIndex], pBoxes.extents.y[boxIndex], pBoxes.extents.z[boxIndex] };
+
+				bool isVisible = true;
+				for( const auto & frustumPlane : pFrustum.planes )
+				{
+					const auto projectedRadius =
+						boxExtents.x * std::abs( frustumPlane.normal.x ) +
+						boxExtents.y * std::abs( frustumPlane.normal.y ) +
+						boxExtents.z * std::abs( frustumPlane.normal.z );
+
+					if( frustumPlane.signed_distance( boxCenter ) + projectedRadius < 0 )
+					{
+						isVisible = false;
+						break;
+					}
+				}
+
+				if( isVisible )
+				{
+					pVisibilityMask[boxIndex / 32] |= ( 1u << ( boxIndex % 32 ) );
+				}
+			}
+		}
+
+	}
+
+	/// @brief Tests pCount spheres against the frustum. Bit N of the output mask (word N / 32, bit N % 32) is set
+	/// if the N-th sphere is at least partially visible. pVisibilityMask must have visibility_mask_words_num( pCount )
+	/// words; unused bits of the last word are cleared.
+	template <typename TPValue>
+	inline void frustum_cull_spheres_soa( const frustum<TPValue> & pFrustum, sphere_soa<const TPValue> pSpheres, size_t pCount, uint32 * pVisibilityMask )
+	{
+		std::fill( pVisibilityMask, pVisibilityMask + visibility_mask_words_num( pCount ), 0u );
+		impl::frustum_cull_spheres_range( pFrustum, pSpheres, 0, pCount, pVisibilityMask );
+	}
+
+	/// @brief Tests pCount AABBs against the frustum. Output mask has the same format as in frustum_cull_spheres_soa().
+	/// The test is conservative: boxes near the frustum corners may be reported as visible even if they are not.
+	template <typename TPValue>
+	inline void frustum_cull_aabbs_soa( const frustum<TPValue> & pFrustum, aabb_soa<const TPValue> pBoxes, size_t pCount, uint32 * pVisibilityMask )
+	{
+		std::fill( pVisibilityMask, pVisibilityMask + visibility_mask_words_num( pCount ), 0u );
+		impl::frustum_cull_aabbs_range( pFrustum, pBoxes, 0, pCount, pVisibilityMask );
+	}
+
+} // namespace cxm
+
+#if( CXM_SIMD_ENABLE )
+#  include "batchOpsSIMD.inl"
+#endif
+
+#endif // __CXM_BATCH_OPS_H__
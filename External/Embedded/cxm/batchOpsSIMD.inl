@@ -0,0 +1,461 @@
+
+#if !defined( __CXM_BATCH_OPS_H__ )
+#  error ""
+#endif
+
+namespace cxm
+{
+
+#if( CXM_SIMD_USE_VX128F )
+
+	// Vector types are not used as template arguments: their alignment attributes would be ignored (and GCC warns).
+
+	/// Broadcast coefficients of the first three rows of an affine matrix (the fourth row is not used by batch kernels).
+	struct batch_affine_matrix_128f
+	{
+		__m128 m[3][4];
+	};
+
+	/// Broadcast coefficients of a frustum plane, with the absolute values of the normal precomputed for AABB tests.
+	struct batch_plane_128f
+	{
+		__m128 nx, ny, nz, d;
+		__m128 absNx, absNy, absNz;
+	};
+
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_abs_128f( __m128 pValue )
+	{
+		return _mm_andnot_ps( _mm_set1_ps( -0.0f ), pValue );
+	}
+
+	/// Computes ( pX * pCX + pY * pCY ) + pZ * pCZ + pCW, in the same order as the scalar kernels.
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_dot3_add_128f( __m128 pX, __m128 pY, __m128 pZ, __m128 pCX, __m128 pCY, __m128 pCZ, __m128 pCW )
+	{
+		const __m128 dotXY = _mm_add_ps( _mm_mul_ps( pX, pCX ), _mm_mul_ps( pY, pCY ) );
+		return _mm_add_ps( _mm_add_ps( dotXY, _mm_mul_ps( pZ, pCZ ) ), pCW );
+	}
+
+	/// Reduces a min/max accumulator to a single value.
+	PCL_ATTR_ALWAYS_INLINE float _mm_reduce_min_128f( __m128 pValue )
+	{
+		const __m128 min01 = _mm_min_ps( pValue, _mm_shuffle_ps( pValue, pValue, _MM_SHUFFLE_R( 2, 3, 0, 1 ) ) );
+		return _mm_cvtss_f32( _mm_min_ps( min01, _mm_shuffle_ps( min01, min01, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ) ) );
+	}
+
+	PCL_ATTR_ALWAYS_INLINE float _mm_reduce_max_128f( __m128 pValue )
+	{
+		const __m128 max01 = _mm_max_ps( pValue, _mm_shuffle_ps( pValue, pValue, _MM_SHUFFLE_R( 2, 3, 0, 1 ) ) );
+		return _mm_cvtss_f32( _mm_max_ps( max01, _mm_shuffle_ps( max01, max01, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ) ) );
+	}
+
+	inline void _mm_load_batch_affine_matrix_128f( const matrix4x4<float> & pMatrix, batch_affine_matrix_128f & pResult )
+	{
+		for( uint32 rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			for( uint32 columnIndex = 0; columnIndex < 4; ++columnIndex )
+			{
+				pResult.m[rowIndex][columnIndex] = _mm_set1_ps( pMatrix[rowIndex][columnIndex] );
+			}
+		}
+	}
+
+	inline void _mm_load_batch_frustum_128f( const frustum<float> & pFrustum, batch_plane_128f * pResult )
+	{
+		for( uint32 planeIndex = 0; planeIndex < frustum<float>::planes_num; ++planeIndex )
+		{
+			const auto & frustumPlane = pFrustum.planes[planeIndex];
+			pResult[planeIndex].nx = _mm_set1_ps( frustumPlane.normal.x );
+			pResult[planeIndex].ny = _mm_set1_ps( frustumPlane.normal.y );
+			pResult[planeIndex].nz = _mm_set1_ps( frustumPlane.normal.z );
+			pResult[planeIndex].d = _mm_set1_ps( frustumPlane.distance );
+			pResult[planeIndex].absNx = _mm_set1_ps( std::abs( frustumPlane.normal.x ) );
+			pResult[planeIndex].absNy = _mm_set1_ps( std::abs( frustumPlane.normal.y ) );
+			pResult[planeIndex].absNz = _mm_set1_ps( std::abs( frustumPlane.normal.z ) );
+		}
+	}
+
+#if( CXM_SIMD_USE_VX256F )
+
+	/// 256-bit version of batch_affine_matrix_128f.
+	struct batch_affine_matrix_256f
+	{
+		__m256 m[3][4];
+	};
+
+	/// 256-bit version of batch_plane_128f.
+	struct batch_plane_256f
+	{
+		__m256 nx, ny, nz, d;
+		__m256 absNx, absNy, absNz;
+	};
+
+	PCL_ATTR_ALWAYS_INLINE __m256 _mm_abs_256f( __m256 pValue )
+	{
+		return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), pValue );
+	}
+
+	PCL_ATTR_ALWAYS_INLINE __m256 _mm_dot3_add_256f( __m256 pX, __m256 pY, __m256 pZ, __m256 pCX, __m256 pCY, __m256 pCZ, __m256 pCW )
+	{
+		const __m256 dotXY = _mm256_add_ps( _mm256_mul_ps( pX, pCX ), _mm256_mul_ps( pY, pCY ) );
+		return _mm256_add_ps( _mm256_add_ps( dotXY, _mm256_mul_ps( pZ, pCZ ) ), pCW );
+	}
+
+	inline void _mm_load_batch_affine_matrix_256f( const matrix4x4<float> & pMatrix, batch_affine_matrix_256f & pResult )
+	{
+		for( uint32 rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			for( uint32 columnIndex = 0; columnIndex < 4; ++columnIndex )
+			{
+				pResult.m[rowIndex][columnIndex] = _mm256_set1_ps( pMatrix[rowIndex][columnIndex] );
+			}
+		}
+	}
+
+	inline void _mm_load_batch_frustum_256f( const frustum<float> & pFrustum, batch_plane_256f * pResult )
+	{
+		for( uint32 planeIndex = 0; planeIndex < frustum<float>::planes_num; ++planeIndex )
+		{
+			const auto & frustumPlane = pFrustum.planes[planeIndex];
+			pResult[planeIndex].nx = _mm256_set1_ps( frustumPlane.normal.x );
+			pResult[planeIndex].ny = _mm256_set1_ps( frustumPlane.normal.y );
+			pResult[planeIndex].nz = _mm256_set1_ps( frustumPlane.normal.z );
+			pResult[planeIndex].d = _mm256_set1_ps( frustumPlane.distance );
+			pResult[planeIndex].absNx = _mm256_set1_ps( std::abs( frustumPlane.normal.x ) );
+			pResult[planeIndex].absNy = _mm256_set1_ps( std::abs( frustumPlane.normal.y ) );
+			pResult[planeIndex].absNz = _mm256_set1_ps( std::abs( frustumPlane.normal.z ) );
+		}
+	}
+
+#endif // CXM_SIMD_USE_VX256F
+
+	// All kernels below follow the same pattern: an 8-wide AVX loop (if available), then a 4-wide SSE loop
+	// (which handles the bulk of the work if AVX is not enabled, or at most one iteration of the remainder
+	// otherwise) and a scalar tail. Unaligned loads/stores are used everywhere, as SoA arrays usually come
+	// from regular containers. Since each vector loop processes a multiple of 4 elements, a group of results
+	// never crosses a 32-bit word of the visibility mask.
+
+	inline void transform_points_soa( const matrix4x4<float> & pMatrix, vector3_soa<const float> pInput, vector3_soa<float> pOutput, size_t pCount )
+	{
+		size_t pointIndex = 0;
+
+	#if( CXM_SIMD_USE_VX256F )
+		batch_affine_matrix_256f matrix256;
+		_mm_load_batch_affine_matrix_256f( pMatrix, matrix256 );
+
+		for( ; pointIndex + 8 <= pCount; pointIndex += 8 )
+		{
+			const __m256 srcX = _mm256_loadu_ps( pInput.x + pointIndex );
+			const __m256 srcY = _mm256_loadu_ps( pInput.y + pointIndex );
+			const __m256 srcZ = _mm256_loadu_ps( pInput.z + pointIndex );
+
+			const auto & m = matrix256.m;
+			_mm256_storeu_ps( pOutput.x + pointIndex, _mm_dot3_add_256f( srcX, srcY, srcZ, m[0][0], m[0][1], m[0][2], m[0][3] ) );
+			_mm256_storeu_ps( pOutput.y + pointIndex, _mm_dot3_add_256f( srcX, srcY, srcZ, m[1][0], m[1][1], m[1][2], m[1][3] ) );
+			_mm256_storeu_ps( pOutput.z + pointIndex, _mm_dot3_add_256f( srcX, srcY, srcZ, m[2][0], m[2][1], m[2][2], m[2][3] ) );
+		}
+	#endif
+
+		batch_affine_matrix_128f matrix128;
+		_mm_load_batch_affine_matrix_128f( pMatrix, matrix128 );
+
+		for( ; pointIndex + 4 <= pCount; pointIndex += 4 )
+		{
+			const __m128 srcX = _mm_loadu_ps( pInput.x + pointIndex );
+			const __m128 srcY = _mm_loadu_ps( pInput.y + pointIndex );
+			const __m128 srcZ = _mm_loadu_ps( pInput.z + pointIndex );
+
+			const auto & m = matrix128.m;
+			_mm_storeu_ps( pOutput.x + pointIndex, _mm_dot3_add_128f( srcX, srcY, srcZ, m[0][0], m[0][1], m[0][2], m[0][3] ) );
+			_mm_storeu_ps( pOutput.y + pointIndex, _mm_dot3_add_128f( srcX, srcY, srcZ, m[1][0], m[1][1], m[1][2], m[1][3] ) );
+			_mm_storeu_ps( pOutput.z + pointIndex, _mm_dot3_add_128f( srcX, srcY, srcZ, m[2][0], m[2][1], m[2][2], m[2][3] ) );
+		}
+
+		transform_points_soa<float>( pMatrix, pInput.offset( pointIndex ), pOutput.offset( pointIndex ), pCount - pointIndex );
+	}
+
+	inline void transform_aabbs_soa( const matrix4x4<float> & pMatrix, aabb_soa<const float> pInput, aabb_soa<float> pOutput, size_t pCount )
+	{
+		size_t boxIndex = 0;
+
+	#if( CXM_SIMD_USE_VX256F )
+		batch_affine_matrix_256f matrix256;
+		batch_affine_matrix_256f absMatrix256;
+		_mm_load_batch_affine_matrix_256f( pMatrix, matrix256 );
+		for( uint32 rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			for( uint32 columnIndex = 0; columnIndex < 4; ++columnIndex )
+			{
+				absMatrix256.m[rowIndex][columnIndex] = _mm_abs_256f( matrix256.m[rowIndex][columnIndex] );
+			}
+		}
+
+		for( ; boxIndex + 8 <= pCount; boxIndex += 8 )
+		{
+			const __m256 cX = _mm256_loadu_ps( pInput.center.x + boxIndex );
+			const __m256 cY = _mm256_loadu_ps( pInput.center.y + boxIndex );
+			const __m256 cZ = _mm256_loadu_ps( pInput.center.z + boxIndex );
+			const __m256 eX = _mm256_loadu_ps( pInput.extents.x + boxIndex );
+			const __m256 eY = _mm256_loadu_ps( pInput.extents.y + boxIndex );
+			const __m256 eZ = _mm256_loadu_ps( pInput.extents.z + boxIndex );
+
+			const auto & m = matrix256.m;
+			const auto & a = absMatrix256.m;
+			const __m256 zero = _mm256_setzero_ps();
+			_mm256_storeu_ps( pOutput.center.x + boxIndex, _mm_dot3_add_256f( cX, cY, cZ, m[0][0], m[0][1], m[0][2], m[0][3] ) );
+			_mm256_storeu_ps( pOutput.center.y + boxIndex, _mm_dot3_add_256f( cX, cY, cZ, m[1][0], m[1][1], m[1][2], m[1][3] ) );
+			_mm256_storeu_ps( pOutput.center.z + boxIndex, _mm_dot3_add_256f( cX, cY, cZ, m[2][0], m[2][1], m[2][2], m[2][3] ) );
+			_mm256_storeu_ps( pOutput.extents.x + boxIndex, _mm_dot3_add_256f( eX, eY, eZ, a[0][0], a[0][1], a[0][2], zero ) );
+			_mm256_storeu_ps( pOutput.extents.y + boxIndex, _mm_dot3_add_256f( eX, eY, eZ, a[1][0], a[1][1], a[1][2], zero ) );
+			_mm256_storeu_ps( pOutput.extents.z + boxIndex, _mm_dot3_add_256f( eX, eY, eZ, a[2][0], a[2][1], a[2][2], zero ) );
+		}
+	#endif
+
+		batch_affine_matrix_128f matrix128;
+		batch_affine_matrix_128f absMatrix128;
+		_mm_load_batch_affine_matrix_128f( pMatrix, matrix128 );
+		for( uint32 rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			for( uint32 columnIndex = 0; columnIndex < 4; ++columnIndex )
+			{
+				absMatrix128.m[rowIndex][columnIndex] = _mm_abs_128f( matrix128.m[rowIndex][columnIndex] );
+			}
+		}
+
+		for( ; boxIndex + 4 <= pCount; boxIndex += 4 )
+		{
+			const __m128 cX = _mm_loadu_ps( pInput.center.x + boxIndex );
+			const __m128 cY = _mm_loadu_ps( pInput.center.y + boxIndex );
+			const __m128 cZ = _mm_loadu_ps( pInput.center.z + boxIndex );
+			const __m128 eX = _mm_loadu_ps( pInput.extents.x + boxIndex );
+			const __m128 eY = _mm_loadu_ps( pInput.extents.y + boxIndex );
+			const __m128 eZ = _mm_loadu_ps( pInput.extents.z + boxIndex );
+
+			const auto & m = matrix128.m;
+			const auto & a = absMatrix128.m;
+			const __m128 zero = _mm_setzero_ps();
+			_mm_storeu_ps( pOutput.center.x + boxIndex, _mm_dot3_add_128f( cX, cY, cZ, m[0][0], m[0][1], m[0][2], m[0][3] ) );
+			_mm_storeu_ps( pOutput.center.y + boxIndex, _mm_dot3_add_128f( cX, cY, cZ, m[1][0], m[1][1], m[1][2], m[1][3] ) );
+			_mm_storeu_ps( pOutput.center.z + boxIndex, _mm_dot3_add_128f( cX, cY, cZ, m[2][0], m[2][1], m[2][2], m[2][3] ) );
+			_mm_storeu_ps( pOutput.extents.x + boxIndex, _mm_dot3_add_128f( eX, eY, eZ, a[0][0], a[0][1], a[0][2], zero ) );
+			_mm_storeu_ps( pOutput.extents.y + boxIndex, _mm_dot3_add_128f( eX, eY, eZ, a[1][0], a[1][1], a[1][2], zero ) );
+			_mm_storeu_ps( pOutput.extents.z + boxIndex, _mm_dot3_add_128f( eX, eY, eZ, a[2][0], a[2][1], a[2][2], zero ) );
+		}
+
+		transform_aabbs_soa<float>( pMatrix, pInput.offset( boxIndex ), pOutput.offset( boxIndex ), pCount - boxIndex );
+	}
+
+	inline aabb<float> compute_bounds_soa( vector3_soa<const float> pPoints, size_t pCount )
+	{
+		if( pCount < 4 )
+		{
+			return compute_bounds_soa<float>( pPoints, pCount );
+		}
+
+		// Accumulators are initialized with the first group, so no special values (like +/-inf) are needed.
+		__m128 minX = _mm_loadu_ps( pPoints.x );
+		__m128 minY = _mm_loadu_ps( pPoints.y );
+		__m128 minZ = _mm_loadu_ps( pPoints.z );
+		__m128 maxX = minX;
+		__m128 maxY = minY;
+		__m128 maxZ = minZ;
+
+		size_t pointIndex = 4;
+		for( ; pointIndex + 4 <= pCount; pointIndex += 4 )
+		{
+			const __m128 srcX = _mm_loadu_ps( pPoints.x + pointIndex );
+			const __m128 srcY = _mm_loadu_ps( pPoints.y + pointIndex );
+			const __m128 srcZ = _mm_loadu_ps( pPoints.z + pointIndex );
+			minX = _mm_min_ps( minX, srcX );
+			minY = _mm_min_ps( minY, srcY );
+			minZ = _mm_min_ps( minZ, srcZ );
+			maxX = _mm_max_ps( maxX, srcX );
+			maxY = _mm_max_ps( maxY, srcY );
+			maxZ = _mm_max_ps( maxZ, srcZ );
+		}
+
+		aabb<float> result{
+			{ _mm_reduce_min_128f( minX ), _mm_reduce_min_128f( minY ), _mm_reduce_min_128f( minZ ) },
+			{ _mm_reduce_max_128f( maxX ), _mm_reduce_max_128f( maxY ), _mm_reduce_max_128f( maxZ ) } };
+
+		for( ; pointIndex < pCount; ++pointIndex )
+		{
+			result.min_corner.x = std::min( result.min_corner.x, pPoints.x[pointIndex] );
+			result.min_corner.y = std::min( result.min_corner.y, pPoints.y[pointIndex] );
+			result.min_corner.z = std::min( result.min_corner.z, pPoints.z[pointIndex] );
+			result.max_corner.x = std::max( result.max_corner.x, pPoints.x[pointIndex] );
+			result.max_corner.y = std::max( result.max_corner.y, pPoints.y[pointIndex] );
+			result.max_corner.z = std::max( result.max_corner.z, pPoints.z[pointIndex] );
+		}
+
+		return result;
+	}
+
+	inline aabb<float> compute_bounds_soa( aabb_soa<const float> pBoxes, size_t pCount )
+	{
+		if( pCount < 4 )
+		{
+			return compute_bounds_soa<float>( pBoxes, pCount );
+		}
+
+		__m128 minX = _mm_sub_ps( _mm_loadu_ps( pBoxes.center.x ), _mm_loadu_ps( pBoxes.extents.x ) );
+		__m128 minY = _mm_sub_ps( _mm_loadu_ps( pBoxes.center.y ), _mm_loadu_ps( pBoxes.extents.y ) );
+		__m128 minZ = _mm_sub_ps( _mm_loadu_ps( pBoxes.center.z ), _mm_loadu_ps( pBoxes.extents.z ) );
+		__m128 maxX = _mm_add_ps( _mm_loadu_ps( pBoxes.center.x ), _mm_loadu_ps( pBoxes.extents.x ) );
+		__m128 maxY = _mm_add_ps( _mm_loadu_ps( pBoxes.center.y ), _mm_loadu_ps( pBoxes.extents.y ) );
+		__m128 maxZ = _mm_add_ps( _mm_loadu_ps( pBoxes.center.z ), _mm_loadu_ps( pBoxes.extents.z ) );
+
+		size_t boxIndex = 4;
+		for( ; boxIndex + 4 <= pCount; boxIndex += 4 )
+		{
+			const __m128 cX = _mm_loadu_ps( pBoxes.center.x + boxIndex );
+			const __m128 cY = _mm_loadu_ps( pBoxes.center.y + boxIndex );
+			const __m128 cZ = _mm_loadu_ps( pBoxes.center.z + boxIndex );
+			const __m128 eX = _mm_loadu_ps( pBoxes.extents.x + boxIndex );
+			const __m128 eY = _mm_loadu_ps( pBoxes.extents.y + boxIndex );
+			const __m128 eZ = _mm_loadu_ps( pBoxes.extents.z + boxIndex );
+			minX = _mm_min_ps( minX, _mm_sub_ps( cX, eX ) );
+			minY = _mm_min_ps( minY, _mm_sub_ps( cY, eY ) );
+			minZ = _mm_min_ps( minZ, _mm_sub_ps( cZ, eZ ) );
+			maxX = _mm_max_ps( maxX, _mm_add_ps( cX, eX ) );
+			maxY = _mm_max_ps( maxY, _mm_add_ps( cY, eY ) );
+			maxZ = _mm_max_ps( maxZ, _mm_add_ps( cZ, eZ ) );
+		}
+
+		aabb<float> result{
+			{ _mm_reduce_min_128f( minX ), _mm_reduce_min_128f( minY ), _mm_reduce_min_128f( minZ ) },
+			{ _mm_reduce_max_128f( maxX ), _mm_reduce_max_128f( maxY ), _mm_reduce_max_128f( maxZ ) } };
+
+		if( boxIndex < pCount )
+		{
+			const auto tailBounds = compute_bounds_soa<float>( pBoxes.offset( boxIndex ), pCount - boxIndex );
+			result.min_corner.x = std::min( result.min_corner.x, tailBounds.min_corner.x );
+			result.min_corner.y = std::min( result.min_corner.y, tailBounds.min_corner.y );
+			result.min_corner.z = std::min( result.min_corner.z, tailBounds.min_corner.z );
+			result.max_corner.x = std::max( result.max_corner.x, tailBounds.max_corner.x );
+			result.max_corner.y = std::max( result.max_corner.y, tailBounds.max_corner.y );
+			result.max_corner.z = std::max( result.max_corner.z, tailBounds.max_corner.z );
+		}
+
+		return result;
+	}
+
+	inline void frustum_cull_spheres_soa( const frustum<float> & pFrustum, sphere_soa<const float> pSpheres, size_t pCount, uint32 * pVisibilityMask )
+	{
+		std::fill( pVisibilityMask, pVisibilityMask + visibility_mask_words_num( pCount ), 0u );
+
+		size_t sphereIndex = 0;
+
+	#if( CXM_SIMD_USE_VX256F )
+		batch_plane_256f planes256[frustum<float>::planes_num];
+		_mm_load_batch_frustum_256f( pFrustum, planes256 );
+
+		for( ; sphereIndex + 8 <= pCount; sphereIndex += 8 )
+		{
+			const __m256 cX = _mm256_loadu_ps( pSpheres.center.x + sphereIndex );
+			const __m256 cY = _mm256_loadu_ps( pSpheres.center.y + sphereIndex );
+			const __m256 cZ = _mm256_loadu_ps( pSpheres.center.z + sphereIndex );
+			const __m256 radius = _mm256_loadu_ps( pSpheres.radius + sphereIndex );
+
+			// All planes are always tested: with 8 objects per iteration, an early exit would rarely trigger
+			// and the branch would cost more than the remaining arithmetic.
+			__m256 visible = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+			for( const auto & batchPlane : planes256 )
+			{
+				const __m256 distance = _mm256_add_ps( _mm_dot3_add_256f( cX, cY, cZ, batchPlane.nx, batchPlane.ny, batchPlane.nz, batchPlane.d ), radius );
+				// !( distance < 0 ), to match the scalar version for NaNs.
+				visible = _mm256_and_ps( visible, _mm256_cmp_ps( distance, _mm256_setzero_ps(), _CMP_NLT_UQ ) );
+			}
+
+			const auto visibilityBits = static_cast<uint32>( _mm256_movemask_ps( visible ) );
+			pVisibilityMask[sphereIndex / 32] |= ( visibilityBits << ( sphereIndex % 32 ) );
+		}
+	#endif
+
+		batch_plane_128f planes128[frustum<float>::planes_num];
+		_mm_load_batch_frustum_128f( pFrustum, planes128 );
+
+		for( ; sphereIndex + 4 <= pCount; sphereIndex += 4 )
+		{
+			const __m128 cX = _mm_loadu_ps( pSpheres.center.x + sphereIndex );
+			const __m128 cY = _mm_loadu_ps( pSpheres.center.y + sphereIndex );
+			const __m128 cZ = _mm_loadu_ps( pSpheres.center.z + sphereIndex );
+			const __m128 radius = _mm_loadu_ps( pSpheres.radius + sphereIndex );
+
+			__m128 visible = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			for( const auto & batchPlane : planes128 )
+			{
+				const __m128 distance = _mm_add_ps( _mm_dot3_add_128f( cX, cY, cZ, batchPlane.nx, batchPlane.ny, batchPlane.nz, batchPlane.d ), radius );
+				visible = _mm_and_ps( visible, _mm_cmpnlt_ps( distance, _mm_setzero_ps() ) );
+			}
+
+			const auto visibilityBits = static_cast<uint32>( _mm_movemask_ps( visible ) );
+			pVisibilityMask[sphereIndex / 32] |= ( visibilityBits << ( sphereIndex % 32 ) );
+		}
+
+		impl::frustum_cull_spheres_range<float>( pFrustum, pSpheres, sphereIndex, pCount, pVisibilityMask );
+	}
+
+	inline void frustum_cull_aabbs_soa( const frustum<float> & pFrustum, aabb_soa<const float> pBoxes, size_t pCount, uint32 * pVisibilityMask )
+	{
+		std::fill( pVisibilityMask, pVisibilityMask + visibility_mask_words_num( pCount ), 0u );
+
+		size_t boxIndex = 0;
+
+	#if( CXM_SIMD_USE_VX256F )
+		batch_plane_256f planes256[frustum<float>::planes_num];
+		_mm_load_batch_frustum_256f( pFrustum, planes256 );
+
+		for( ; boxIndex + 8 <= pCount; boxIndex += 8 )
+		{
+			const __m256 cX = _mm256_loadu_ps( pBoxes.center.x + boxIndex );
+			const __m256 cY = _mm256_loadu_ps( pBoxes.center.y + boxIndex );
+			const __m256 cZ = _mm256_loadu_ps( pBoxes.center.z + boxIndex );
+			const __m256 eX = _mm256_loadu_ps( pBoxes.extents.x + boxIndex );
+			const __m256 eY = _mm256_loadu_ps( pBoxes.extents.y + boxIndex );
+			const __m256 eZ = _mm256_loadu_ps( pBoxes.extents.z + boxIndex );
+			const __m256 zero = _mm256_setzero_ps();
+
+			__m256 visible = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+			for( const auto & batchPlane : planes256 )
+			{
+				const __m256 projectedRadius = _mm_dot3_add_256f( eX, eY, eZ, batchPlane.absNx, batchPlane.absNy, batchPlane.absNz, zero );
+				const __m256 distance = _mm256_add_ps( _mm_dot3_add_256f( cX, cY, cZ, batchPlane.nx, batchPlane.ny, batchPlane.nz, batchPlane.d ), projectedRadius );
+				visible = _mm256_and_ps( visible, _mm256_cmp_ps( distance, zero, _CMP_NLT_UQ ) );
+			}
+
+			const auto visibilityBits = static_cast<uint32>( _mm256_movemask_ps( visible ) );
+			pVisibilityMask[boxIndex / 32] |= ( visibilityBits << ( boxIndex % 32 ) );
+		}
+	#endif
+
+		batch_plane_128f planes128[frustum<float>::planes_num];
+		_mm_load_batch_frustum_128f( pFrustum, planes128 );
+
+		for( ; boxIndex + 4 <= pCount; boxIndex += 4 )
+		{
+			const __m128 cX = _mm_loadu_ps( pBoxes.center.x + boxIndex );
+			const __m128 cY = _mm_loadu_ps( pBoxes.center.y + boxIndex );
+			const __m128 cZ = _mm_loadu_ps( pBoxes.center.z + boxIndex );
+			const __m128 eX = _mm_loadu_ps( pBoxes.extents.x + boxIndex );
+			const __m128 eY = _mm_loadu_ps( pBoxes.extents.y + boxIndex );
+			const __m128 eZ = _mm_loadu_ps( pBoxes.extents.z + boxIndex );
+			const __m128 zero = _mm_setzero_ps();
+
+			__m128 visible = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			for( const auto & batchPlane : planes128 )
+			{
+				const __m128 projectedRadius = _mm_dot3_add_128f( eX, eY, eZ, batchPlane.absNx, batchPlane.absNy, batchPlane.absNz, zero );
+				const __m128 distance = _mm_add_ps( _mm_dot3_add_128f( cX, cY, cZ, batchPlane.nx, batchPlane.ny, batchPlane.nz, batchPlane.d ), projectedRadius );
+				visible = _mm_and_ps( visible, _mm_cmpnlt_ps( distance, zero ) );
+			}
+
+			const auto visibilityBits = static_cast<uint32>( _mm_movemask_ps( visible ) );
+			pVisibilityMask[boxIndex / 32] |= ( visibilityBits << ( boxIndex % 32 ) );
+		}
+
+		impl::frustum_cull_aabbs_range<float>( pFrustum, pBoxes, boxIndex, pCount, pVisibilityMask );
+	}
+
+#endif // CXM_SIMD_USE_VX128F
+
+} // namespace cxm
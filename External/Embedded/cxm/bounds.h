@@ -0,0 +1,166 @@
+
+#ifndef __CXM_BOUNDS_H__
+#define __CXM_BOUNDS_H__
+
+#include "matrixOps.h"
+
+namespace cxm
+{
+
+	/// @brief Axis-aligned bounding box, represented as min/max corners.
+	template <typename TPValue>
+	struct aabb
+	{
+		vector3<TPValue> min_corner;
+		vector3<TPValue> max_corner;
+
+		CPPX_ATTR_NO_DISCARD vector3<TPValue> center() const noexcept
+		{
+			return ( min_corner + max_corner ) * static_cast<TPValue>( 0.5 );
+		}
+
+		CPPX_ATTR_NO_DISCARD vector3<TPValue> extents() const noexcept
+		{
+			return ( max_corner - min_corner ) * static_cast<TPValue>( 0.5 );
+		}
+	};
+
+	/// @brief Bounding sphere.
+	template <typename TPValue>
+	struct sphere
+	{
+		vector3<TPValue> center;
+		TPValue radius;
+	};
+
+	/// @brief A plane described by the equation: dot( normal, p ) + distance = 0. The normal points to the positive
+	/// half-space, which, for frustum planes, is the inside of the frustum.
+	template <typename TPValue>
+	struct plane
+	{
+		vector3<TPValue> normal;
+		TPValue distance;
+
+		CPPX_ATTR_NO_DISCARD TPValue signed_distance( const vector3<TPValue> & pPoint ) const noexcept
+		{
+			return dot( normal, pPoint ) + distance;
+		}
+	};
+
+	/// @brief Six planes of a view frustum, with normals pointing inside.
+	template <typename TPValue>
+	struct frustum
+	{
+		enum : uint32
+		{
+			plane_left,
+			plane_right,
+			plane_bottom,
+			plane_top,
+			plane_near,
+			plane_far,
+			planes_num
+		};
+
+		plane<TPValue> planes[planes_num];
+	};
+
+	using aabbf = aabb<float>;
+	using spheref = sphere<float>;
+	using planef = plane<float>;
+	using frustumf = frustum<float>;
+
+	/// @brief Extracts normalized frustum planes from a (view-)projection matrix, using the column-vector
+	/// convention (clip = M * v). If pZeroToOneDepth is true, clip-space depth is expected to be in [0,w]
+	/// (D3D, Vulkan, Metal), otherwise in [-w,w] (OpenGL).
+	template <typename TPValue>
+	inline frustum<TPValue> frustum_from_matrix( const matrix4x4<TPValue> & pMatrix, bool pZeroToOneDepth = false )
+	{
+		const auto & row0 = pMatrix.row0;
+		const auto & row1 = pMatrix.row1;
+		const auto & row2 = pMatrix.row2;
+		const auto & row3 = pMatrix.row3;
+
+		const vector4<TPValue> planeEquations[frustum<TPValue>::planes_num] =
+		{
+			row3 + row0,
+			row3 - row0,
+			row3 + row1,
+			row3 - row1,
+			pZeroToOneDepth ? row2 : ( row3 + row2 ),
+			row3 - row2
+		};
+
+		frustum<TPValue> result;
+		for( uint32 planeIndex = 0; planeIndex < frustum<TPValue>::planes_num; ++planeIndex )
+		{
+			const auto & equation = planeEquations[planeIndex];
+			const auto normal = vector3<TPValue>{ equation.x, equation.y, equation.z };
+			const auto oneOverLength = static_cast<TPValue>( 1 ) / length( normal );
+			result.planes[planeIndex].normal = normal * oneOverLength;
+			result.planes[planeIndex].distance = equation.w * oneOverLength;
+		}
+
+		return result;
+	}
+
+	/// @brief Returns true if the sphere is at least partially inside the frustum.
+	template <typename TPValue>
+	inline bool intersects( const frustum<TPValue> & pFrustum, const sphere<TPValue> & pSphere )
+	{
+		for( const auto & frustumPlane : pFrustum.planes )
+		{
+			if( frustumPlane.signed_distance( pSphere.center ) + pSphere.radius < 0 )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// @brief Returns true if the box is at least partially inside the frustum (conservative: boxes near
+	/// the frustum corners may be reported as visible even if they are not).
+	template <typename TPValue>
+	inline bool intersects( const frustum<TPValue> & pFrustum, const aabb<TPValue> & pBox )
+	{
+		const auto boxCenter = pBox.center();
+		const auto boxExtents = pBox.extents();
+
+		for( const auto & frustumPlane : pFrustum.planes )
+		{
+			// Projected "radius" of the box onto the plane normal.
+			const auto projectedRadius =
+				boxExtents.x * std::abs( frustumPlane.normal.x ) +
+				boxExtents.y * std::abs( frustumPlane.normal.y ) +
+				boxExtents.z * std::abs( frustumPlane.normal.z );
+
+			if( frustumPlane.signed_distance( boxCenter ) + projectedRadius < 0 )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// @brief Computes the bounding box of an AABB transformed by an affine matrix.
+	template <typename TPValue>
+	inline aabb<TPValue> transform_aabb( const matrix4x4<TPValue> & pMatrix, const aabb<TPValue> & pBox )
+	{
+		const auto boxCenter = pBox.center();
+		const auto boxExtents = pBox.extents();
+
+		vector3<TPValue> newCenter;
+		vector3<TPValue> newExtents;
+		for( uint32 rowIndex = 0; rowIndex < 3; ++rowIndex )
+		{
+			const auto & matrixRow = pMatrix[rowIndex];
+			newCenter[rowIndex] = matrixRow.x * boxCenter.x + matrixRow.y * boxCenter.y + matrixRow.z * boxCenter.z + matrixRow.w;
+			newExtents[rowIndex] = std::abs( matrixRow.x ) * boxExtents.x + std::abs( matrixRow.y ) * boxExtents.y + std::abs( matrixRow.z ) * boxExtents.z;
+		}
+
+		return aabb<TPValue>{ newCenter - newExtents, newCenter + newExtents };
+	}
+
+} // namespace cxm
+
+#endif // __CXM_BOUNDS_H__
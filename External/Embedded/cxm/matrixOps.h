@@ -220,6 +220,44 @@ namespace cxm
 		return result;
 	}
 
+	/// @brief Transforms an array of vectors: pOutput[i] = pMatrix * pInput[i]. Input and output may be the same array.
+	template <typename TPValue>
+	inline void transform_array( const matrix4x4<TPValue> & pMatrix, const vector4<TPValue> * pInput, vector4<TPValue> * pOutput, size_t pCount )
+	{
+		for( size_t vectorIndex = 0; vectorIndex < pCount; ++vectorIndex )
+		{
+			const auto inputVector = pInput[vectorIndex];
+			mul( pMatrix, inputVector, pOutput[vectorIndex] );
+		}
+	}
+
+	/// @brief Transforms an array of points (implicit w = 1). No perspective division is performed, so the matrix is
+	/// expected to be an affine transformation. Input and output may be the same array.
+	template <typename TPValue>
+	inline void transform_points( const matrix4x4<TPValue> & pMatrix, const vector3<TPValue> * pInput, vector3<TPValue> * pOutput, size_t pCount )
+	{
+		for( size_t pointIndex = 0; pointIndex < pCount; ++pointIndex )
+		{
+			const auto inputPoint = pInput[pointIndex];
+			pOutput[pointIndex].x = pMatrix[0][0] * inputPoint.x + pMatrix[0][1] * inputPoint.y + pMatrix[0][2] * inputPoint.z + pMatrix[0][3];
+			pOutput[pointIndex].y = pMatrix[1][0] * inputPoint.x + pMatrix[1][1] * inputPoint.y + pMatrix[1][2] * inputPoint.z + pMatrix[1][3];
+			pOutput[pointIndex].z = pMatrix[2][0] * inputPoint.x + pMatrix[2][1] * inputPoint.y + pMatrix[2][2] * inputPoint.z + pMatrix[2][3];
+		}
+	}
+
+	/// @brief Transforms an array of directions (implicit w = 0, translation is ignored). Input and output may be the same array.
+	template <typename TPValue>
+	inline void transform_directions( const matrix4x4<TPValue> & pMatrix, const vector3<TPValue> * pInput, vector3<TPValue> * pOutput, size_t pCount )
+	{
+		for( size_t vectorIndex = 0; vectorIndex < pCount; ++vectorIndex )
+		{
+			const auto inputVector = pInput[vectorIndex];
+			pOutput[vectorIndex].x = pMatrix[0][0] * inputVector.x + pMatrix[0][1] * inputVector.y + pMatrix[0][2] * inputVector.z;
+			pOutput[vectorIndex].y = pMatrix[1][0] * inputVector.x + pMatrix[1][1] * inputVector.y + pMatrix[1][2] * inputVector.z;
+			pOutput[vectorIndex].z = pMatrix[2][0] * inputVector.x + pMatrix[2][1] * inputVector.y + pMatrix[2][2] * inputVector.z;
+		}
+	}
+
 } // namespace cxm
 
 #if( CXM_SIMD_ENABLE )
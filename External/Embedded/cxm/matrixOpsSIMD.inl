@@ -10,10 +10,14 @@ namespace cxm
 
 	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_mat4_vec4_128f( __m128 pM0, __m128 pM1, __m128 pM2, __m128 pM3, __m128 pV0 )
 	{
-		const __m128 mul0 = _mm_mul_ps( pM0, pV0 );
-		const __m128 mul1 = _mm_mul_ps( pM1, pV0 );
-		const __m128 mul2 = _mm_mul_ps( pM2, pV0 );
-		const __m128 mul3 = _mm_mul_ps( pM3, pV0 );
+		__m128 mul0 = _mm_mul_ps( pM0, pV0 );
+		__m128 mul1 = _mm_mul_ps( pM1, pV0 );
+		__m128 mul2 = _mm_mul_ps( pM2, pV0 );
+		__m128 mul3 = _mm_mul_ps( pM3, pV0 );
+
+		// mulN holds the products for the N-th dot product. After transposing, each
+		// component of the result is a sum of the same lane of all four registers.
+		_MM_TRANSPOSE4_PS( mul0, mul1, mul2, mul3 );
 
 		const __m128 taccum01 = _mm_add_ps( mul0, mul1 );
 		const __m128 taccum23 = _mm_add_ps( mul2, mul3 );
@@ -22,6 +26,76 @@ namespace cxm
 		return result;
 	}
 
+	/// Computes M * V with M given as columns. Used for batches, where M is transposed only once.
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_mat4c_vec4_128f( __m128 pC0, __m128 pC1, __m128 pC2, __m128 pC3, __m128 pV0 )
+	{
+		const __m128 mul0 = _mm_mul_ps( pC0, _mm_shuffle_ps( pV0, pV0, _MM_SHUFFLE_R( 0, 0, 0, 0 ) ) );
+		const __m128 mul1 = _mm_mul_ps( pC1, _mm_shuffle_ps( pV0, pV0, _MM_SHUFFLE_R( 1, 1, 1, 1 ) ) );
+		const __m128 mul2 = _mm_mul_ps( pC2, _mm_shuffle_ps( pV0, pV0, _MM_SHUFFLE_R( 2, 2, 2, 2 ) ) );
+		const __m128 mul3 = _mm_mul_ps( pC3, _mm_shuffle_ps( pV0, pV0, _MM_SHUFFLE_R( 3, 3, 3, 3 ) ) );
+
+		const __m128 taccum01 = _mm_add_ps( mul0, mul1 );
+		const __m128 taccum23 = _mm_add_ps( mul2, mul3 );
+		const __m128 result = _mm_add_ps( taccum01, taccum23 );
+
+		return result;
+	}
+
+	/// Computes a single row of A * B: R = A[i][0] * B0 + A[i][1] * B1 + A[i][2] * B2 + A[i][3] * B3.
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_row_mat4_128f( __m128 pRow, __m128 pB0, __m128 pB1, __m128 pB2, __m128 pB3 )
+	{
+		const __m128 mul0 = _mm_mul_ps( _mm_shuffle_ps( pRow, pRow, _MM_SHUFFLE_R( 0, 0, 0, 0 ) ), pB0 );
+		const __m128 mul1 = _mm_mul_ps( _mm_shuffle_ps( pRow, pRow, _MM_SHUFFLE_R( 1, 1, 1, 1 ) ), pB1 );
+		const __m128 mul2 = _mm_mul_ps( _mm_shuffle_ps( pRow, pRow, _MM_SHUFFLE_R( 2, 2, 2, 2 ) ), pB2 );
+		const __m128 mul3 = _mm_mul_ps( _mm_shuffle_ps( pRow, pRow, _MM_SHUFFLE_R( 3, 3, 3, 3 ) ), pB3 );
+
+		return _mm_add_ps( _mm_add_ps( mul0, mul1 ), _mm_add_ps( mul2, mul3 ) );
+	}
+
+#if( CXM_SIMD_USE_VX256F )
+	/// AVX version of _mm_mul_row_mat4_128f, which computes two rows at once. B rows are expected
+	/// to be duplicated in both 128-bit lanes (shuffles do not cross lanes).
+	PCL_ATTR_ALWAYS_INLINE __m256 _mm_mul_row2_mat4_256f( __m256 pRows, __m256 pB0, __m256 pB1, __m256 pB2, __m256 pB3 )
+	{
+		const __m256 mul0 = _mm256_mul_ps( _mm256_shuffle_ps( pRows, pRows, _MM_SHUFFLE_R( 0, 0, 0, 0 ) ), pB0 );
+		const __m256 mul1 = _mm256_mul_ps( _mm256_shuffle_ps( pRows, pRows, _MM_SHUFFLE_R( 1, 1, 1, 1 ) ), pB1 );
+		const __m256 mul2 = _mm256_mul_ps( _mm256_shuffle_ps( pRows, pRows, _MM_SHUFFLE_R( 2, 2, 2, 2 ) ), pB2 );
+		const __m256 mul3 = _mm256_mul_ps( _mm256_shuffle_ps( pRows, pRows, _MM_SHUFFLE_R( 3, 3, 3, 3 ) ), pB3 );
+
+		return _mm256_add_ps( _mm256_add_ps( mul0, mul1 ), _mm256_add_ps( mul2, mul3 ) );
+	}
+#endif
+
+	inline void mul( const matrix4x4<float> & pFirst, const matrix4x4<float> & pSecond, matrix4x4<float> & pResult )
+	{
+		// All inputs are loaded before anything is written, so pResult may alias any of the operands.
+	#if( CXM_SIMD_USE_VX256F )
+		const __m256 second0 = _mm256_broadcast_ps( &( pSecond.mm0 ) );
+		const __m256 second1 = _mm256_broadcast_ps( &( pSecond.mm1 ) );
+		const __m256 second2 = _mm256_broadcast_ps( &( pSecond.mm2 ) );
+		const __m256 second3 = _mm256_broadcast_ps( &( pSecond.mm3 ) );
+		const __m256 first01 = _mm256_loadu_ps( pFirst.data() );
+		const __m256 first23 = _mm256_loadu_ps( pFirst.data() + 8 );
+
+		_mm256_storeu_ps( pResult.data(), _mm_mul_row2_mat4_256f( first01, second0, second1, second2, second3 ) );
+		_mm256_storeu_ps( pResult.data() + 8, _mm_mul_row2_mat4_256f( first23, second0, second1, second2, second3 ) );
+	#else
+		const __m128 second0 = pSecond.mm0;
+		const __m128 second1 = pSecond.mm1;
+		const __m128 second2 = pSecond.mm2;
+		const __m128 second3 = pSecond.mm3;
+		const __m128 result0 = _mm_mul_row_mat4_128f( pFirst.mm0, second0, second1, second2, second3 );
+		const __m128 result1 = _mm_mul_row_mat4_128f( pFirst.mm1, second0, second1, second2, second3 );
+		const __m128 result2 = _mm_mul_row_mat4_128f( pFirst.mm2, second0, second1, second2, second3 );
+		const __m128 result3 = _mm_mul_row_mat4_128f( pFirst.mm3, second0, second1, second2, second3 );
+
+		pResult.mm0 = result0;
+		pResult.mm1 = result1;
+		pResult.mm2 = result2;
+		pResult.mm3 = result3;
+	#endif
+	}
+
 	inline vector4<float> mul( const matrix4x4<float> & pMatrix, const vector4<float> & pVector )
 	{
 		vector4<float> result;
@@ -34,6 +108,83 @@ namespace cxm
 		pResult.mmv = _mm_mul_mat4_vec4_128f( pMatrix.mm0, pMatrix.mm1, pMatrix.mm2, pMatrix.mm3, pVector.mmv );
 	}
 
+	inline void transform_array( const matrix4x4<float> & pMatrix, const vector4<float> * pInput, vector4<float> * pOutput, size_t pCount )
+	{
+		__m128 c0 = pMatrix.mm0;
+		__m128 c1 = pMatrix.mm1;
+		__m128 c2 = pMatrix.mm2;
+		__m128 c3 = pMatrix.mm3;
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+
+		size_t vectorIndex = 0;
+
+	#if( CXM_SIMD_USE_VX256F )
+		const __m256 c0x2 = _mm256_insertf128_ps( _mm256_castps128_ps256( c0 ), c0, 1 );
+		const __m256 c1x2 = _mm256_insertf128_ps( _mm256_castps128_ps256( c1 ), c1, 1 );
+		const __m256 c2x2 = _mm256_insertf128_ps( _mm256_castps128_ps256( c2 ), c2, 1 );
+		const __m256 c3x2 = _mm256_insertf128_ps( _mm256_castps128_ps256( c3 ), c3, 1 );
+
+		for( ; vectorIndex + 2 <= pCount; vectorIndex += 2 )
+		{
+			// Two vectors per iteration, one in each 128-bit lane.
+			const __m256 vectors = _mm256_loadu_ps( pInput[vectorIndex].data() );
+			const __m256 mul0 = _mm256_mul_ps( c0x2, _mm256_shuffle_ps( vectors, vectors, _MM_SHUFFLE_R( 0, 0, 0, 0 ) ) );
+			const __m256 mul1 = _mm256_mul_ps( c1x2, _mm256_shuffle_ps( vectors, vectors, _MM_SHUFFLE_R( 1, 1, 1, 1 ) ) );
+			const __m256 mul2 = _mm256_mul_ps( c2x2, _mm256_shuffle_ps( vectors, vectors, _MM_SHUFFLE_R( 2, 2, 2, 2 ) ) );
+			const __m256 mul3 = _mm256_mul_ps( c3x2, _mm256_shuffle_ps( vectors, vectors, _MM_SHUFFLE_R( 3, 3, 3, 3 ) ) );
+			_mm256_storeu_ps( pOutput[vectorIndex].data(), _mm256_add_ps( _mm256_add_ps( mul0, mul1 ), _mm256_add_ps( mul2, mul3 ) ) );
+		}
+	#endif
+
+		for( ; vectorIndex < pCount; ++vectorIndex )
+		{
+			pOutput[vectorIndex].mmv = _mm_mul_mat4c_vec4_128f( c0, c1, c2, c3, pInput[vectorIndex].mmv );
+		}
+	}
+
+	inline void transform_points( const matrix4x4<float> & pMatrix, const vector3<float> * pInput, vector3<float> * pOutput, size_t pCount )
+	{
+		__m128 c0 = pMatrix.mm0;
+		__m128 c1 = pMatrix.mm1;
+		__m128 c2 = pMatrix.mm2;
+		__m128 c3 = pMatrix.mm3;
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+
+		for( size_t pointIndex = 0; pointIndex < pCount; ++pointIndex )
+		{
+			const auto & inputPoint = pInput[pointIndex];
+			const __m128 mul0 = _mm_mul_ps( c0, _mm_set1_ps( inputPoint.x ) );
+			const __m128 mul1 = _mm_mul_ps( c1, _mm_set1_ps( inputPoint.y ) );
+			const __m128 mul2 = _mm_mul_ps( c2, _mm_set1_ps( inputPoint.z ) );
+			const __m128 result = _mm_add_ps( _mm_add_ps( mul0, mul1 ), _mm_add_ps( mul2, c3 ) );
+
+			// vector3<float> is not padded, so only xyz can be written.
+			_mm_storel_pi( reinterpret_cast<__m64 *>( &( pOutput[pointIndex].x ) ), result );
+			_mm_store_ss( &( pOutput[pointIndex].z ), _mm_movehl_ps( result, result ) );
+		}
+	}
+
+	inline void transform_directions( const matrix4x4<float> & pMatrix, const vector3<float> * pInput, vector3<float> * pOutput, size_t pCount )
+	{
+		__m128 c0 = pMatrix.mm0;
+		__m128 c1 = pMatrix.mm1;
+		__m128 c2 = pMatrix.mm2;
+		__m128 c3 = pMatrix.mm3;
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+
+		for( size_t vectorIndex = 0; vectorIndex < pCount; ++vectorIndex )
+		{
+			const auto & inputVector = pInput[vectorIndex];
+			const __m128 mul0 = _mm_mul_ps( c0, _mm_set1_ps( inputVector.x ) );
+			const __m128 mul1 = _mm_mul_ps( c1, _mm_set1_ps( inputVector.y ) );
+			const __m128 mul2 = _mm_mul_ps( c2, _mm_set1_ps( inputVector.z ) );
+			const __m128 result = _mm_add_ps( _mm_add_ps( mul0, mul1 ), mul2 );
+
+			_mm_storel_pi( reinterpret_cast<__m64 *>( &( pOutput[vectorIndex].x ) ), result );
+			_mm_store_ss( &( pOutput[vectorIndex].z ), _mm_movehl_ps( result, result ) );
+		}
+	}
+
 #endif // CXM_SIMD_USE_VX128F
 
 } // namespace cxm
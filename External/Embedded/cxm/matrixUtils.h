@@ -122,15 +122,16 @@ namespace cxm
 				- pMatrix[1][0] * (pMatrix[0][1] * pMatrix[2][2] - pMatrix[2][1] * pMatrix[0][2])
 				+ pMatrix[2][0] * (pMatrix[0][1] * pMatrix[1][2] - pMatrix[1][1] * pMatrix[0][2]));
 
+		// Inverse is the transposed matrix of cofactors (adjugate) divided by the determinant.
 		return {
 			+ (pMatrix[1][1] * pMatrix[2][2] - pMatrix[2][1] * pMatrix[1][2]) * oneOverDet,
-			- (pMatrix[1][0] * pMatrix[2][2] - pMatrix[2][0] * pMatrix[1][2]) * oneOverDet,
-			+ (pMatrix[1][0] * pMatrix[2][1] - pMatrix[2][0] * pMatrix[1][1]) * oneOverDet,
 			- (pMatrix[0][1] * pMatrix[2][2] - pMatrix[2][1] * pMatrix[0][2]) * oneOverDet,
-			+ (pMatrix[0][0] * pMatrix[2][2] - pMatrix[2][0] * pMatrix[0][2]) * oneOverDet,
-			- (pMatrix[0][0] * pMatrix[2][1] - pMatrix[2][0] * pMatrix[0][1]) * oneOverDet,
 			+ (pMatrix[0][1] * pMatrix[1][2] - pMatrix[1][1] * pMatrix[0][2]) * oneOverDet,
+			- (pMatrix[1][0] * pMatrix[2][2] - pMatrix[2][0] * pMatrix[1][2]) * oneOverDet,
+			+ (pMatrix[0][0] * pMatrix[2][2] - pMatrix[2][0] * pMatrix[0][2]) * oneOverDet,
 			- (pMatrix[0][0] * pMatrix[1][2] - pMatrix[1][0] * pMatrix[0][2]) * oneOverDet,
+			+ (pMatrix[1][0] * pMatrix[2][1] - pMatrix[2][0] * pMatrix[1][1]) * oneOverDet,
+			- (pMatrix[0][0] * pMatrix[2][1] - pMatrix[2][0] * pMatrix[0][1]) * oneOverDet,
 			+ (pMatrix[0][0] * pMatrix[1][1] - pMatrix[1][0] * pMatrix[0][1]) * oneOverDet
 		};
 	}
@@ -206,7 +207,35 @@ namespace cxm
 			+ ( pMatrix[0][2] * tmpInv[0][2] )
 			+ ( pMatrix[0][3] * tmpInv[0][3] );
 
-		return tmpInv / det;
+		const TPValue oneOverDet = static_cast<TPValue>( 1 ) / det;
+		tmpInv.row0 *= oneOverDet;
+		tmpInv.row1 *= oneOverDet;
+		tmpInv.row2 *= oneOverDet;
+		tmpInv.row3 *= oneOverDet;
+
+		return tmpInv;
+	}
+
+	template <typename TPValue>
+	inline matrix4x4<TPValue> inverse( const matrix4x4<TPValue> & pMatrix )
+	{
+		return transpose( inverse_transpose( pMatrix ) );
+	}
+
+	/// @brief Computes the inverse of an affine transformation matrix, i.e. a matrix with the last row equal to [0,0,0,1]
+	/// (linear part in the upper 3x3 block, translation in the last column). Much cheaper than the general inverse.
+	template <typename TPValue>
+	inline matrix4x4<TPValue> inverse_affine( const matrix4x4<TPValue> & pMatrix )
+	{
+		const auto linearInv = inverse( matrix_trim3( pMatrix ) );
+		const vector3<TPValue> translation{ pMatrix[0][3], pMatrix[1][3], pMatrix[2][3] };
+
+		return matrix4x4<TPValue> {
+			linearInv[0][0], linearInv[0][1], linearInv[0][2], -dot( linearInv.row0, translation ),
+			linearInv[1][0], linearInv[1][1], linearInv[1][2], -dot( linearInv.row1, translation ),
+			linearInv[2][0], linearInv[2][1], linearInv[2][2], -dot( linearInv.row2, translation ),
+			0,               0,               0,               1
+		};
 	}
 
 	template <typename TPValue>
@@ -54,6 +54,151 @@ namespace cxm
 		_mm_transpose_mat4_128f( pMatrix.mm0, pMatrix.mm1, pMatrix.mm2, pMatrix.mm3, pMatrix.simd_ptr() );
 	}
 
+	/// 2x2 matrix product A * B, with both matrices stored row-major in a single register.
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_mat2_128f( __m128 pA, __m128 pB )
+	{
+		return _mm_add_ps(
+			_mm_mul_ps( pA, _mm_shuffle_ps( pB, pB, _MM_SHUFFLE_R( 0, 3, 0, 3 ) ) ),
+			_mm_mul_ps( _mm_shuffle_ps( pA, pA, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ), _mm_shuffle_ps( pB, pB, _MM_SHUFFLE_R( 2, 1, 2, 1 ) ) ) );
+	}
+
+	/// 2x2 matrix product adj(A) * B.
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_adj_mat2_128f( __m128 pA, __m128 pB )
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( _mm_shuffle_ps( pA, pA, _MM_SHUFFLE_R( 3, 3, 0, 0 ) ), pB ),
+			_mm_mul_ps( _mm_shuffle_ps( pA, pA, _MM_SHUFFLE_R( 1, 1, 2, 2 ) ), _mm_shuffle_ps( pB, pB, _MM_SHUFFLE_R( 2, 3, 0, 1 ) ) ) );
+	}
+
+	/// 2x2 matrix product A * adj(B).
+	PCL_ATTR_ALWAYS_INLINE __m128 _mm_mul_mat2_adj_128f( __m128 pA, __m128 pB )
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( pA, _mm_shuffle_ps( pB, pB, _MM_SHUFFLE_R( 3, 0, 3, 0 ) ) ),
+			_mm_mul_ps( _mm_shuffle_ps( pA, pA, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ), _mm_shuffle_ps( pB, pB, _MM_SHUFFLE_R( 2, 1, 2, 1 ) ) ) );
+	}
+
+	/// General 4x4 inverse, computed blockwise: M is split into four 2x2 matrices [A B; C D], which fit
+	/// in a single register each. The inverse is then expressed using 2x2 adjugates and determinants.
+	PCL_ATTR_ALWAYS_INLINE void _mm_inverse_mat4_128f( __m128 pM0, __m128 pM1, __m128 pM2, __m128 pM3, __m128 pResult[4] )
+	{
+		const __m128 blockA = _mm_movelh_ps( pM0, pM1 ); // [ M00, M01, M10, M11 ]
+		const __m128 blockB = _mm_movehl_ps( pM1, pM0 ); // [ M02, M03, M12, M13 ]
+		const __m128 blockC = _mm_movelh_ps( pM2, pM3 ); // [ M20, M21, M30, M31 ]
+		const __m128 blockD = _mm_movehl_ps( pM3, pM2 ); // [ M22, M23, M32, M33 ]
+
+		// Determinants of all four blocks: [ |A|, |B|, |C|, |D| ]
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps( _mm_shuffle_ps( pM0, pM2, _MM_SHUFFLE_R( 0, 2, 0, 2 ) ), _mm_shuffle_ps( pM1, pM3, _MM_SHUFFLE_R( 1, 3, 1, 3 ) ) ),
+			_mm_mul_ps( _mm_shuffle_ps( pM0, pM2, _MM_SHUFFLE_R( 1, 3, 1, 3 ) ), _mm_shuffle_ps( pM1, pM3, _MM_SHUFFLE_R( 0, 2, 0, 2 ) ) ) );
+
+		const __m128 detA = _mm_shuffle_ps( detSub, detSub, _MM_SHUFFLE_R( 0, 0, 0, 0 ) );
+		const __m128 detB = _mm_shuffle_ps( detSub, detSub, _MM_SHUFFLE_R( 1, 1, 1, 1 ) );
+		const __m128 detC = _mm_shuffle_ps( detSub, detSub, _MM_SHUFFLE_R( 2, 2, 2, 2 ) );
+		const __m128 detD = _mm_shuffle_ps( detSub, detSub, _MM_SHUFFLE_R( 3, 3, 3, 3 ) );
+
+		const __m128 adjDxC = _mm_mul_adj_mat2_128f( blockD, blockC );
+		const __m128 adjAxB = _mm_mul_adj_mat2_128f( blockA, blockB );
+
+		// inv(M) = 1/|M| * [ X Y; Z W ], adjugates of the blocks are computed below.
+		__m128 adjX = _mm_sub_ps( _mm_mul_ps( detD, blockA ), _mm_mul_mat2_128f( blockB, adjDxC ) );
+		__m128 adjW = _mm_sub_ps( _mm_mul_ps( detA, blockD ), _mm_mul_mat2_128f( blockC, adjAxB ) );
+		__m128 adjY = _mm_sub_ps( _mm_mul_ps( detB, blockC ), _mm_mul_mat2_adj_128f( blockD, adjAxB ) );
+		__m128 adjZ = _mm_sub_ps( _mm_mul_ps( detC, blockB ), _mm_mul_mat2_adj_128f( blockA, adjDxC ) );
+
+		// |M| = |A|*|D| + |B|*|C| - tr( adj(A)*B * adj(D)*C )
+		__m128 trace = _mm_mul_ps( adjAxB, _mm_shuffle_ps( adjDxC, adjDxC, _MM_SHUFFLE_R( 0, 2, 1, 3 ) ) );
+		trace = _mm_add_ps( trace, _mm_shuffle_ps( trace, trace, _MM_SHUFFLE_R( 2, 3, 0, 1 ) ) );
+		trace = _mm_add_ps( trace, _mm_shuffle_ps( trace, trace, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ) );
+
+		const __m128 detM = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) ), trace );
+		const __m128 invDetM = _mm_div_ps( _mm_setr_ps( 1.0f, -1.0f, -1.0f, 1.0f ), detM );
+
+		adjX = _mm_mul_ps( adjX, invDetM );
+		adjY = _mm_mul_ps( adjY, invDetM );
+		adjZ = _mm_mul_ps( adjZ, invDetM );
+		adjW = _mm_mul_ps( adjW, invDetM );
+
+		// Final adjugate shuffle is combined with the shuffle back into rows.
+		pResult[0] = _mm_shuffle_ps( adjX, adjY, _MM_SHUFFLE_R( 3, 1, 3, 1 ) );
+		pResult[1] = _mm_shuffle_ps( adjX, adjY, _MM_SHUFFLE_R( 2, 0, 2, 0 ) );
+		pResult[2] = _mm_shuffle_ps( adjZ, adjW, _MM_SHUFFLE_R( 3, 1, 3, 1 ) );
+		pResult[3] = _mm_shuffle_ps( adjZ, adjW, _MM_SHUFFLE_R( 2, 0, 2, 0 ) );
+	}
+
+	/// Inverse of an affine matrix (last row equal to [0,0,0,1]). The inverse of the linear part is computed
+	/// from the cross products of its columns, the translation is then transformed by it and negated.
+	PCL_ATTR_ALWAYS_INLINE void _mm_inverse_affine_mat4_128f( __m128 pM0, __m128 pM1, __m128 pM2, __m128 pM3, __m128 pResult[4] )
+	{
+		__m128 columns[4];
+		_mm_transpose_mat4_128f( pM0, pM1, pM2, pM3, columns );
+
+		// With the last row being [0,0,0,1], the columns 0-2 have w=0, so the cross products below have w=0 as well.
+		const auto crossProduct = []( __m128 pU, __m128 pV ) -> __m128 {
+			const __m128 uYZX = _mm_shuffle_ps( pU, pU, _MM_SHUFFLE_R( 1, 2, 0, 3 ) );
+			const __m128 vYZX = _mm_shuffle_ps( pV, pV, _MM_SHUFFLE_R( 1, 2, 0, 3 ) );
+			const __m128 result = _mm_sub_ps( _mm_mul_ps( pU, vYZX ), _mm_mul_ps( uYZX, pV ) );
+			return _mm_shuffle_ps( result, result, _MM_SHUFFLE_R( 1, 2, 0, 3 ) );
+		};
+
+		// Rows of the inverse of a matrix with columns [u v w] are: v x w, w x u, u x v (divided by the determinant).
+		__m128 invRow0 = crossProduct( columns[1], columns[2] );
+		__m128 invRow1 = crossProduct( columns[2], columns[0] );
+		__m128 invRow2 = crossProduct( columns[0], columns[1] );
+
+		__m128 det = _mm_mul_ps( columns[0], invRow0 );
+		det = _mm_add_ps( det, _mm_shuffle_ps( det, det, _MM_SHUFFLE_R( 2, 3, 0, 1 ) ) );
+		det = _mm_add_ps( det, _mm_shuffle_ps( det, det, _MM_SHUFFLE_R( 1, 0, 3, 2 ) ) );
+
+		const __m128 invDet = _mm_div_ps( _mm_set1_ps( 1.0f ), det );
+		invRow0 = _mm_mul_ps( invRow0, invDet );
+		invRow1 = _mm_mul_ps( invRow1, invDet );
+		invRow2 = _mm_mul_ps( invRow2, invDet );
+
+		// New translation: -( invRowN dot T ). T is the last column, its w component (1) is multiplied by
+		// the w of the inverse rows, which is 0, so it does not affect the result.
+		__m128 dot0 = _mm_mul_ps( invRow0, columns[3] );
+		__m128 dot1 = _mm_mul_ps( invRow1, columns[3] );
+		__m128 dot2 = _mm_mul_ps( invRow2, columns[3] );
+		__m128 dot3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS( dot0, dot1, dot2, dot3 );
+		const __m128 negTranslation = _mm_sub_ps( _mm_setzero_ps(), _mm_add_ps( _mm_add_ps( dot0, dot1 ), dot2 ) );
+
+		// Replace w of each row with the translation: [ x, y, z, 0 ] -> [ z, z, t, t ] -> [ x, y, z, t ].
+		const __m128 zt0 = _mm_shuffle_ps( invRow0, negTranslation, _MM_SHUFFLE_R( 2, 2, 0, 0 ) );
+		const __m128 zt1 = _mm_shuffle_ps( invRow1, negTranslation, _MM_SHUFFLE_R( 2, 2, 1, 1 ) );
+		const __m128 zt2 = _mm_shuffle_ps( invRow2, negTranslation, _MM_SHUFFLE_R( 2, 2, 2, 2 ) );
+
+		pResult[0] = _mm_shuffle_ps( invRow0, zt0, _MM_SHUFFLE_R( 0, 1, 0, 2 ) );
+		pResult[1] = _mm_shuffle_ps( invRow1, zt1, _MM_SHUFFLE_R( 0, 1, 0, 2 ) );
+		pResult[2] = _mm_shuffle_ps( invRow2, zt2, _MM_SHUFFLE_R( 0, 1, 0, 2 ) );
+		pResult[3] = _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f );
+	}
+
+	inline matrix4x4<float> inverse( const matrix4x4<float> & pMatrix )
+	{
+		matrix4x4<float> result;
+		_mm_inverse_mat4_128f( pMatrix.mm0, pMatrix.mm1, pMatrix.mm2, pMatrix.mm3, result.simd_ptr() );
+		return result;
+	}
+
+	inline matrix4x4<float> inverse_transpose( const matrix4x4<float> & pMatrix )
+	{
+		__m128 inverseRows[4];
+		_mm_inverse_mat4_128f( pMatrix.mm0, pMatrix.mm1, pMatrix.mm2, pMatrix.mm3, inverseRows );
+
+		matrix4x4<float> result;
+		_mm_transpose_mat4_128f( inverseRows[0], inverseRows[1], inverseRows[2], inverseRows[3], result.simd_ptr() );
+		return result;
+	}
+
+	inline matrix4x4<float> inverse_affine( const matrix4x4<float> & pMatrix )
+	{
+		matrix4x4<float> result;
+		_mm_inverse_affine_mat4_128f( pMatrix.mm0, pMatrix.mm1, pMatrix.mm2, pMatrix.mm3, result.simd_ptr() );
+		return result;
+	}
+
 #endif // CXM_SIMD_USE_VX128F
 
 } // namespace cxm
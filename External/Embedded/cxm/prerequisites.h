@@ -17,6 +17,11 @@
 #  else
 #    define CXM_SIMD_USE_VX128I 0
 #  endif
+#  if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_AVX ) // AVX -> float[8] (__m256)
+#    define CXM_SIMD_USE_VX256F 1
+#  else
+#    define CXM_SIMD_USE_VX256F 0
+#  endif
 #  if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_AVX ) // AVX -> double[4] (__m256d)
 #    define CXM_SIMD_USE_VX256D 1
 #  else
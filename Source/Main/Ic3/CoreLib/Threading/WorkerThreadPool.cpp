@@ -0,0 +1,138 @@
+
+#include "WorkerThreadPool.h"
+
+namespace Ic3
+{
+
+	// Set while the current thread executes ranges of a job of any WorkerThreadPool - both for workers and for
+	// the thread which has submitted the job. Nested ParallelFor() calls are executed serially: the submitter holds
+	// the submit lock of its pool and a worker would wait for a job which needs that worker to complete.
+	static thread_local bool sCurrentThreadInPoolJob = false;
+
+	WorkerThreadPool::WorkerThreadPool( uint32 pWorkerThreadsNum )
+	{
+		_workerThreadArray.reserve( pWorkerThreadsNum );
+		for( uint32 workerIndex = 0; workerIndex < pWorkerThreadsNum; ++workerIndex )
+		{
+			_workerThreadArray.emplace_back( &WorkerThreadPool::WorkerThreadProc, this );
+		}
+	}
+
+	WorkerThreadPool::~WorkerThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> stateLock( _stateLock );
+			_stopRequested = true;
+		}
+
+		_workerWakeCondition.notify_all();
+
+		for( auto & workerThread : _workerThreadArray )
+		{
+			workerThread.join();
+		}
+	}
+
+	uint32 WorkerThreadPool::GetDefaultWorkerThreadsNum()
+	{
+		const auto hardwareThreadsNum = std::thread::hardware_concurrency();
+		return ( hardwareThreadsNum > 1 ) ? ( hardwareThreadsNum - 1 ) : 0;
+	}
+
+	void WorkerThreadPool::ExecuteParallelRanges( size_t pItemsNum, size_t pGrainSize, RangeFunction pFunction, void * pContext )
+	{
+		if( pItemsNum == 0 )
+		{
+			return;
+		}
+
+		pGrainSize = std::max<size_t>( pGrainSize, 1 );
+
+		if( _workerThreadArray.empty() || ( pItemsNum <= pGrainSize ) || sCurrentThreadInPoolJob )
+		{
+			for( size_t beginIndex = 0; beginIndex < pItemsNum; beginIndex += pGrainSize )
+			{
+				pFunction( pContext, beginIndex, std::min( beginIndex + pGrainSize, pItemsNum ) );
+			}
+			return;
+		}
+
+		std::lock_guard<std::mutex> jobSubmitLock( _jobSubmitLock );
+
+		{
+			std::lock_guard<std::mutex> stateLock( _stateLock );
+			_currentJob.function = pFunction;
+			_currentJob.context = pContext;
+			_currentJob.itemsNum = pItemsNum;
+			_currentJob.grainSize = pGrainSize;
+			_currentJob.nextItemIndex.store( 0, std::memory_order_relaxed );
+			_currentJobOpen = true;
+			++_currentJobGeneration;
+		}
+
+		_workerWakeCondition.notify_all();
+
+		const auto prevInPoolJob = sCurrentThreadInPoolJob;
+		sCurrentThreadInPoolJob = true;
+		ProcessCurrentJobRanges();
+		sCurrentThreadInPoolJob = prevInPoolJob;
+
+		// Close the job, so workers which have not woken up yet do not join it, then wait for the ones
+		// still processing their last ranges. After that, the job state can be safely reused.
+		std::unique_lock<std::mutex> stateLock( _stateLock );
+		_currentJobOpen = false;
+		_jobDoneCondition.wait( stateLock, [this]() -> bool { return _currentJobActiveWorkersNum == 0; } );
+	}
+
+	void WorkerThreadPool::ProcessCurrentJobRanges()
+	{
+		const auto itemsNum = _currentJob.itemsNum;
+		const auto grainSize = _currentJob.grainSize;
+
+		while( true )
+		{
+			const auto beginIndex = _currentJob.nextItemIndex.fetch_add( grainSize, std::memory_order_relaxed );
+			if( beginIndex >= itemsNum )
+			{
+				break;
+			}
+
+			_currentJob.function( _currentJob.context, beginIndex, std::min( beginIndex + grainSize, itemsNum ) );
+		}
+	}
+
+	void WorkerThreadPool::WorkerThreadProc()
+	{
+		// Workers execute nothing but job ranges.
+		sCurrentThreadInPoolJob = true;
+
+		uint64 lastJobGeneration = 0;
+
+		std::unique_lock<std::mutex> stateLock( _stateLock );
+
+		while( true )
+		{
+			_workerWakeCondition.wait( stateLock, [this, &lastJobGeneration]() -> bool {
+				return _stopRequested || ( _currentJobOpen && ( _currentJobGeneration != lastJobGeneration ) );
+			} );
+
+			if( _stopRequested )
+			{
+				break;
+			}
+
+			lastJobGeneration = _currentJobGeneration;
+			++_currentJobActiveWorkersNum;
+
+			stateLock.unlock();
+			ProcessCurrentJobRanges();
+			stateLock.lock();
+
+			if( --_currentJobActiveWorkersNum == 0 )
+			{
+				_jobDoneCondition.notify_one();
+			}
+		}
+	}
+
+} // namespace Ic3
@@ -0,0 +1,88 @@
+
+#pragma once
+
+#ifndef __IC3_CORELIB_WORKER_THREAD_POOL_H__
+#define __IC3_CORELIB_WORKER_THREAD_POOL_H__
+
+#include "../Prerequisites.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Ic3
+{
+
+	/// @brief A fixed set of worker threads used to split data-parallel loops.
+	/// ParallelFor() blocks until all items have been processed, with the calling thread processing ranges as well,
+	/// so a pool with zero workers is valid (everything is executed serially). Calls from multiple threads are
+	/// serialized. A ParallelFor() issued from within an executed range (nested parallelism, on a worker or on the
+	/// calling thread) is executed serially.
+	/// The executed function must not throw.
+	class IC3_CORELIB_CLASS WorkerThreadPool
+	{
+	public:
+		explicit WorkerThreadPool( uint32 pWorkerThreadsNum = GetDefaultWorkerThreadsNum() );
+		~WorkerThreadPool();
+
+		WorkerThreadPool( const WorkerThreadPool & ) = delete;
+		WorkerThreadPool & operator=( const WorkerThreadPool & ) = delete;
+
+		CPPX_ATTR_NO_DISCARD uint32 GetWorkerThreadsNum() const noexcept
+		{
+			return static_cast<uint32>( _workerThreadArray.size() );
+		}
+
+		/// @brief Calls pFunction( beginIndex, endIndex ) for consecutive, non-overlapping ranges covering [0, pItemsNum).
+		/// Every range (except, possibly, the last one) has exactly pGrainSize items, so callers can align ranges with
+		/// their data layout (e.g. use a multiple of 32 to make each range own whole words of a bit mask).
+		template <typename TPFunction>
+		void ParallelFor( size_t pItemsNum, size_t pGrainSize, TPFunction && pFunction )
+		{
+			using FunctionType = std::remove_reference_t<TPFunction>;
+			ExecuteParallelRanges(
+				pItemsNum,
+				pGrainSize,
+				[]( void * pContext, size_t pBeginIndex, size_t pEndIndex ) -> void {
+					( *static_cast<FunctionType *>( pContext ) )( pBeginIndex, pEndIndex );
+				},
+				const_cast<void *>( static_cast<const void *>( &pFunction ) ) );
+		}
+
+		/// @brief Returns the number of workers which, together with the calling thread, use all hardware threads.
+		CPPX_ATTR_NO_DISCARD static uint32 GetDefaultWorkerThreadsNum();
+
+	private:
+		using RangeFunction = void ( * )( void *, size_t, size_t );
+
+		void ExecuteParallelRanges( size_t pItemsNum, size_t pGrainSize, RangeFunction pFunction, void * pContext );
+
+		void ProcessCurrentJobRanges();
+
+		void WorkerThreadProc();
+
+	private:
+		struct JobState
+		{
+			RangeFunction function = nullptr;
+			void * context = nullptr;
+			size_t itemsNum = 0;
+			size_t grainSize = 1;
+			std::atomic<size_t> nextItemIndex{ 0 };
+		};
+
+		std::vector<std::thread> _workerThreadArray;
+		std::mutex _jobSubmitLock;
+		std::mutex _stateLock;
+		std::condition_variable _workerWakeCondition;
+		std::condition_variable _jobDoneCondition;
+		JobState _currentJob;
+		uint64 _currentJobGeneration = 0;
+		uint32 _currentJobActiveWorkersNum = 0;
+		bool _currentJobOpen = false;
+		bool _stopRequested = false;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_CORELIB_WORKER_THREAD_POOL_H__
@@ -3,10 +3,42 @@
 #define __IC3_CORELIB_GDS_COMMON_H__
 
 #include "../Exception.h"
+#include <cppx/platform/gds.h>
 
 namespace Ic3
 {
 
+	using cppx::gds_size_t;
+	using cppx::gds_type_id_t;
+
+	/// @brief Primitive (de)serialization layer used by GDSCore.
+	///
+	/// Provides the functions from cppx::gds. Types defined outside CoreLib can add their own evalByteSize(),
+	/// serialize() and deserialize() overloads to this namespace (declared before GDSCore.h is included).
+	namespace GDS
+	{
+
+		using cppx::gds::ArithmeticTypeSerializedSize;
+		using cppx::gds::CX_GDS_VALUE_META_DATA_CONTROL_KEY;
+		using cppx::gds::InstanceMetaData;
+		using cppx::gds::IsArithmetic;
+		using cppx::gds::IsCharType;
+		using cppx::gds::IsTriviallySerializable;
+		using cppx::gds::IsWideChar;
+		using cppx::gds::SizeTypeRef;
+		using cppx::gds::TypeCastInfo;
+		using cppx::gds::TypeCastTag;
+		using cppx::gds::ValueRef;
+		using cppx::gds::asSizeType;
+		using cppx::gds::deserialize;
+		using cppx::gds::emptySizeType;
+		using cppx::gds::evalByteSize;
+		using cppx::gds::getInstanceMetaDataSize;
+		using cppx::gds::readInstanceMetaData;
+		using cppx::gds::serialize;
+
+	}
+
 	/// @brief Base type for GDS-enabled user types. It makes IsGdsSerializable<> to return 'true' for such type.
 	///
 	/// If a class/struct derives from GdsSerializable, it is assumed to provide the following public functions:
@@ -28,7 +60,7 @@ namespace Ic3
 	enum : exception_category_value_t
 	{
 		E_EXCEPTION_CATEGORY_FRAMEWORK_CORE_GDS =
-			CXU::DeclareExceptionCategory( EExceptionBaseType::FRAMEWORK_CORE, Ic3ExcCategoryIID( 0x7C ) ),
+			CXU::DeclareExceptionCategory( EExceptionBaseType::FrameworkCore, Ic3ExcCategoryIID( 0x7C ) ),
 	};
 
 	class CoreGdsException : public FrameworkCoreException
@@ -5,22 +5,20 @@
 #include "GDSCommon.h"
 #include "../Exception.h"
 
-#include <Ic3/Platform/GDS.h>
+#include <cppx/bitmask.h>
+#include <cppx/bitmaskAtomic.h>
 #include <cppx/byteArray.h>
+#include <cppx/memoryBuffer.h>
+#include <cppx/sortedArray.h>
 
 #include <array>
+#include <cstring>
 #include <functional>
 #include <vector>
 
 namespace Ic3
 {
 
-	template <typename TPIntegral>
-	class atomic_bitmask;
-
-	template <typename TPValue, typename TPComparator, typename TPAllocator>
-	class SortedArray;
-
 	namespace GDSCore
 	{
 		
@@ -34,66 +32,66 @@ namespace Ic3
 		/**************************************** Core API - evalByteSize() ****************************************/
 		/***********************************************************************************************************/
 
-		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int>>
+		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t evalByteSize( const TPValue & pValue );
 
-		template <typename TPValue>
+		template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t evalByteSize( const TPValue & pValue );
 
 		template <typename TRef, typename TInternal>
 		gds_size_t evalByteSize( const GDS::ValueRef<TRef, TInternal> & pValueRef );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int> = 0>
 		gds_size_t evalByteSize( const TPValue & pValue, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t evalByteSize( const TPValue & pValue, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t evalByteSize( const GDS::TypeCastInfo<TPValue, TInternal> & pCastInfo );
 
 		/***********************************************************************************************************/
 		/***************************************** Core API - serialize() ******************************************/
 		/***********************************************************************************************************/
 
-		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int>>
+		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t serialize( byte * pOutputBuffer, const TPValue & pValue );
 
-		template <typename TPValue>
+		template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t serialize( byte * pOutputBuffer, const TPValue & pValue );
 
 		template <typename TRef, typename TInternal>
 		gds_size_t serialize( byte * pOutputBuffer, const GDS::ValueRef<TRef, TInternal> & pValueRef );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int> = 0>
 		gds_size_t serialize( byte * pOutputBuffer, const TPValue & pValue, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t serialize( byte * pOutputBuffer, const TPValue & pValue, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t serialize( byte * pOutputBuffer, const GDS::TypeCastInfo<TPValue, TInternal> & pCastInfo );
 
 		/***********************************************************************************************************/
 		/**************************************** Core API - deserialize() *****************************************/
 		/***********************************************************************************************************/
 
-		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int>>
+		template <typename TPValue, std::enable_if_t<IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t deserialize( const byte * pInputData, TPValue & pValue );
 
-		template <typename TPValue>
+		template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int> = 0>
 		gds_size_t deserialize( const byte * pInputData, TPValue & pValue );
 
 		template <typename TRef, typename TInternal>
 		gds_size_t deserialize( const byte * pInputData, const GDS::ValueRef<TRef, TInternal> & pValueRef );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<std::is_void<TInternal>::value, int> = 0>
 		gds_size_t deserialize( const byte * pInputData, TPValue & pRef, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t deserialize( const byte * pInputData, TPValue & pRef, const GDS::TypeCastTag<TInternal> & );
 
-		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int>>
+		template <typename TPValue, typename TInternal, std::enable_if_t<!std::is_void<TInternal>::value, int> = 0>
 		gds_size_t deserialize( const byte * pInputData, const GDS::TypeCastInfo<TPValue, TInternal> & pCastInfo );
 
 		/***********************************************************************************************************/
@@ -139,31 +137,31 @@ namespace Ic3
 		/***********************************************************************************************************/
 
 		template <typename TPValue>
-		gds_size_t serializeAuto( const read_write_memory_view & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAuto( const cppx::read_write_memory_view & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue, size_t tpSize>
 		gds_size_t serializeAuto( std::array<byte, tpSize> & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
-		gds_size_t serializeAutoWithMetaData( const read_write_memory_view & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAutoWithMetaData( const cppx::read_write_memory_view & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue, size_t tpSize>
 		gds_size_t serializeAutoWithMetaData( std::array<byte, tpSize> & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
-		gds_size_t serializeAuto( Dynamicbyte_array & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAuto( cppx::dynamic_byte_array & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
-		gds_size_t serializeAuto( dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAuto( cppx::dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
 		gds_size_t serializeAuto( std::vector<byte> & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
-		gds_size_t serializeAutoWithMetaData( Dynamicbyte_array & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAutoWithMetaData( cppx::dynamic_byte_array & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
-		gds_size_t serializeAutoWithMetaData( dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue );
+		gds_size_t serializeAutoWithMetaData( cppx::dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue );
 
 		template <typename TPValue>
 		gds_size_t serializeAutoWithMetaData( std::vector<byte> & pOutputBuffer, const TPValue & pValue );
@@ -202,6 +200,7 @@ namespace Ic3
 		gds_size_t serializeExternal( const TPValue & pValue, const DataWriteCallback & pWriteCallback, TBuffer & pGdsCache );
 
 		/// @brief Serializes the specified object and writes the byte representation using the specified callback.
+		/// The data is written in chunks, using a bounded intermediate buffer (see serializeStream()).
 		/// @param pValue The object to be serialized
 		/// @param pWriteCallback The write callback for data writing. Cannot be empty.
 		template <typename TPValue>
@@ -222,26 +221,173 @@ namespace Ic3
 		/// @param pReadCallback The read callback for data reading. Cannot be empty.
 		/// @param pGdsCache Custom cache that will be used as a read buffer.
 		template <typename TPValue>
-		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, const read_write_memory_view & pGdsCache );
+		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, const cppx::read_write_memory_view & pGdsCache );
 
 		template <typename TPValue, size_t tpSize>
 		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, std::array<byte, tpSize> & pGdsCache );
 
 		template <typename TPValue>
-		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, Dynamicbyte_array & pGdsCache );
+		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, cppx::dynamic_byte_array & pGdsCache );
 
 		template <typename TPValue>
-		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, dynamic_memory_buffer & pGdsCache );
+		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, cppx::dynamic_memory_buffer & pGdsCache );
 
 		template <typename TPValue>
 		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, std::vector<byte> & pGdsCache );
 
 		/// @brief Deserializes object of the specified type and stores it in pValue. Binary data is read using the specified read callback.
+		/// The data is read in chunks, using a bounded intermediate buffer (see deserializeStream()).
 		/// @param pValue The object to store the deserialized state.
 		/// @param pReadCallback The read callback for data reading. Cannot be empty.
 		template <typename TPValue>
 		gds_size_t deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback );
 
+		/***********************************************************************************************************/
+		/********************************************* Contiguous Ranges *******************************************/
+		/***********************************************************************************************************/
+
+		// Most of the serialized data (SCF indices, cache files) are containers of simple values: vectors of numbers,
+		// arrays of POD structs, strings. Processing them element-by-element costs a separate evalByteSize() traversal
+		// and a (de)serialization call per element. The traits below describe (at compile-time) how the serialized
+		// representation of a type relates to its in-memory one, so contiguous ranges can be processed in one step.
+
+		/// @brief Size of the serialized container/string length, written before the elements.
+		inline constexpr gds_size_t kGdsSizeTypeByteSize =
+			GDS::ArithmeticTypeSerializedSize<typename GDS::SizeTypeRef<>::InternalType>::sValue;
+
+		namespace internal
+		{
+
+			template <typename TPValue>
+			inline constexpr gds_size_t queryGdsStaticByteSize()
+			{
+				if constexpr( IsGdsSerializable<TPValue>::sValue )
+				{
+					// User types define their own format, which can be anything.
+					return 0;
+				}
+				else if constexpr( std::is_enum<TPValue>::value )
+				{
+					return GDS::ArithmeticTypeSerializedSize<typename std::underlying_type<TPValue>::type>::sValue;
+				}
+				else if constexpr( GDS::IsArithmetic<TPValue>::sValue || GDS::IsCharType<TPValue>::sValue || GDS::IsWideChar<TPValue>::sValue )
+				{
+					return GDS::ArithmeticTypeSerializedSize<TPValue>::sValue;
+				}
+				else if constexpr( GDS::IsTriviallySerializable<TPValue>::sValue )
+				{
+					return sizeof( TPValue );
+				}
+				else
+				{
+					return 0;
+				}
+			}
+
+			template <typename TPValue>
+			inline constexpr bool queryGdsBitwiseSerializable()
+			{
+				constexpr bool cxNativeBigEndian = ( cppx::byte_order::platform_native == cppx::byte_order::big_endian );
+
+				if constexpr( IsGdsSerializable<TPValue>::sValue )
+				{
+					return false;
+				}
+				else if constexpr( std::is_enum<TPValue>::value )
+				{
+					return queryGdsBitwiseSerializable<typename std::underlying_type<TPValue>::type>();
+				}
+				else if constexpr( std::is_floating_point<TPValue>::value )
+				{
+					// Floating-point values are stored as a portable (mantissa, exponent) pair.
+					return false;
+				}
+				else if constexpr( GDS::IsArithmetic<TPValue>::sValue || GDS::IsCharType<TPValue>::sValue || GDS::IsWideChar<TPValue>::sValue )
+				{
+					// Integers are stored as big-endian. wchar_t is always stored using 4 bytes.
+					return ( sizeof( TPValue ) == GDS::ArithmeticTypeSerializedSize<TPValue>::sValue ) && ( ( sizeof( TPValue ) == 1 ) || cxNativeBigEndian );
+				}
+				else
+				{
+					// Trivially serializable types are always copied byte-wise, regardless of the platform.
+					return GDS::IsTriviallySerializable<TPValue>::sValue;
+				}
+			}
+
+			template <typename TPContainer, typename = void>
+			struct HasReserve
+			{
+				static inline constexpr bool sValue = false;
+			};
+
+			template <typename TPContainer>
+			struct HasReserve<TPContainer, std::void_t<decltype( std::declval<TPContainer &>().reserve( size_t{} ) )>>
+			{
+				static inline constexpr bool sValue = true;
+			};
+
+		}
+
+		/// @brief Trait with a static gds_size_t 'sValue' holding the size of the serialized representation of a type
+		/// if it is the same for all its values (arithmetic types, enums, trivially serializable structs) or 0 otherwise.
+		/// Byte size of containers of such types is computed without visiting their elements.
+		template <typename TPValue>
+		struct GdsStaticByteSize
+		{
+			static inline constexpr gds_size_t sValue = internal::queryGdsStaticByteSize<TPValue>();
+		};
+
+		template <typename TPValue, size_t tpSize>
+		struct GdsStaticByteSize<std::array<TPValue, tpSize>>
+		{
+			static inline constexpr gds_size_t sValue =
+				( GdsStaticByteSize<TPValue>::sValue > 0 ) ? ( kGdsSizeTypeByteSize + GdsStaticByteSize<TPValue>::sValue * tpSize ) : 0;
+		};
+
+		template <typename T1, typename T2>
+		struct GdsStaticByteSize<std::pair<T1, T2>>
+		{
+			static inline constexpr gds_size_t sValue =
+				( ( GdsStaticByteSize<T1>::sValue > 0 ) && ( GdsStaticByteSize<T2>::sValue > 0 ) ) ? ( GdsStaticByteSize<T1>::sValue + GdsStaticByteSize<T2>::sValue ) : 0;
+		};
+
+		template <typename TPIntegral>
+		struct GdsStaticByteSize<cppx::bitmask<TPIntegral>>
+		{
+			static inline constexpr gds_size_t sValue = GdsStaticByteSize<TPIntegral>::sValue;
+		};
+
+		/// @brief Trait with a static bool 'sValue' indicating whether the serialized representation of a type is exactly
+		/// its in-memory representation, i.e. a contiguous range of its values can be (de)serialized with a single memcpy.
+		/// This is the case for trivially serializable structs and single-byte integers. Multi-byte integers qualify only
+		/// on big-endian platforms, floats never do. A trivially serializable type with a custom GDS::serialize() overload
+		/// must specialize this trait (and GdsStaticByteSize) to opt out.
+		template <typename TPValue>
+		struct IsGdsBitwiseSerializable
+		{
+			static inline constexpr bool sValue = internal::queryGdsBitwiseSerializable<TPValue>();
+		};
+
+		// std::array is a trivial type, but GDS serializes it as a container (prefixed with its size).
+		template <typename TPValue, size_t tpSize>
+		struct IsGdsBitwiseSerializable<std::array<TPValue, tpSize>>
+		{
+			static inline constexpr bool sValue = false;
+		};
+
+		/// @brief Evaluates the byte size of pCount consecutive values. Constant-time for types with a static byte size.
+		template <typename TPValue>
+		gds_size_t evalByteSizeRange( const TPValue * pValues, size_t pCount );
+
+		/// @brief Serializes pCount consecutive values (without their count). Ranges of bitwise-serializable values
+		/// are written with a single memcpy, values with a static byte size are written with a fixed stride.
+		template <typename TPValue>
+		gds_size_t serializeRange( byte * pOutputBuffer, const TPValue * pValues, size_t pCount );
+
+		/// @brief Deserializes pCount consecutive values, written with serializeRange().
+		template <typename TPValue>
+		gds_size_t deserializeRange( const byte * pInputData, TPValue * pValues, size_t pCount );
+
 		/***********************************************************************************************************/
 		/******************************************* Container/Map Helpers *****************************************/
 		/***********************************************************************************************************/
@@ -336,13 +482,13 @@ namespace Ic3
 		/***********************************************************************************************************/
 
 		template <typename TPIntegral>
-		gds_size_t evalByteSize( const AtomicBitmask<TPIntegral> & pBitmask );
+		gds_size_t evalByteSize( const cppx::atomic_bitmask<TPIntegral> & pBitmask );
 
 		template <typename TPIntegral>
-		gds_size_t serialize( byte * pOutputBuffer, const AtomicBitmask<TPIntegral> & pBitmask );
+		gds_size_t serialize( byte * pOutputBuffer, const cppx::atomic_bitmask<TPIntegral> & pBitmask );
 
 		template <typename TPIntegral>
-		gds_size_t deserialize( const byte * pInputData, AtomicBitmask<TPIntegral> & pBitmask );
+		gds_size_t deserialize( const byte * pInputData, cppx::atomic_bitmask<TPIntegral> & pBitmask );
 
 		/***********************************************************************************************************/
 		/************************************************** Bitmask ************************************************/
@@ -362,13 +508,13 @@ namespace Ic3
 		/***********************************************************************************************************/
 
 		template <typename TPValue, typename TPComparator, typename TPAllocator>
-		gds_size_t evalByteSize( const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray );
+		gds_size_t evalByteSize( const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray );
 
 		template <typename TPValue, typename TPComparator, typename TPAllocator>
-		gds_size_t serialize( byte * pOutputBuffer, const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray );
+		gds_size_t serialize( byte * pOutputBuffer, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray );
 
 		template <typename TPValue, typename TPComparator, typename TPAllocator>
-		gds_size_t deserialize( const byte * pInputData, const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray );
+		gds_size_t deserialize( const byte * pInputData, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray );
 
 		/***********************************************************************************************************/
 		/******************************************** std::basic_string ********************************************/
@@ -463,7 +609,7 @@ namespace Ic3
 		return pValue.evalByteSize();
 	}
 
-	template <typename TPValue>
+	template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int>>
 	inline gds_size_t GDSCore::evalByteSize( const TPValue & pValue )
 	{
 		return GDS::evalByteSize( pValue );
@@ -503,7 +649,7 @@ namespace Ic3
 		return pValue.serialize( pOutputBuffer );
 	}
 
-	template <typename TPValue>
+	template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int>>
 	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const TPValue & pValue )
 	{
 		return GDS::serialize( pOutputBuffer, pValue );
@@ -543,7 +689,7 @@ namespace Ic3
 		return pValue.deserialize( pInputData );
 	}
 
-	template <typename TPValue>
+	template <typename TPValue, std::enable_if_t<!IsGdsSerializable<TPValue>::sValue, int>>
 	inline gds_size_t GDSCore::deserialize( const byte * pInputData, TPValue & pValue )
 	{
 		return GDS::deserialize( pInputData, pValue );
@@ -683,7 +829,7 @@ namespace Ic3
 	/***********************************************************************************************************/
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAuto( const read_write_memory_view & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAuto( const cppx::read_write_memory_view & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoFixed( pOutputBuffer, pValue );
 	}
@@ -695,7 +841,7 @@ namespace Ic3
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAutoWithMetaData( const read_write_memory_view & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAutoWithMetaData( const cppx::read_write_memory_view & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoWithMetaDataFixed( pOutputBuffer, pValue );
 	}
@@ -707,13 +853,13 @@ namespace Ic3
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAuto( Dynamicbyte_array & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAuto( cppx::dynamic_byte_array & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoResizable( pOutputBuffer, pValue );
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAuto( dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAuto( cppx::dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoResizable( pOutputBuffer, pValue );
 	}
@@ -725,13 +871,13 @@ namespace Ic3
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAutoWithMetaData( Dynamicbyte_array & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAutoWithMetaData( cppx::dynamic_byte_array & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoWithMetaDataResizable( pOutputBuffer, pValue );
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeAutoWithMetaData( dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue )
+	inline gds_size_t GDSCore::serializeAutoWithMetaData( cppx::dynamic_memory_buffer & pOutputBuffer, const TPValue & pValue )
 	{
 		return internal::serializeAutoWithMetaDataResizable( pOutputBuffer, pValue );
 	}
@@ -780,15 +926,11 @@ namespace Ic3
 		return writeSize;
 	}
 
-	template <typename TPValue>
-	inline gds_size_t GDSCore::serializeExternal( const TPValue & pValue, const DataWriteCallback & pWriteCallback )
-	{
-		Dynamicbyte_array localGdsCache{};
-		return serializeExternal( pValue, pWriteCallback, localGdsCache );
-	}
+	// serializeExternal() and deserializeExternal() without a user-specified cache are defined in GDSStream.h.
+	// Those do not need the whole serialized object in memory, so they use the streaming API internally.
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, const read_write_memory_view & pGdsCache )
+	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, const cppx::read_write_memory_view & pGdsCache )
 	{
 		return internal::deserializeExternalFixed( pValue, pReadCallback, pGdsCache );
 	}
@@ -800,13 +942,13 @@ namespace Ic3
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, Dynamicbyte_array & pGdsCache )
+	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, cppx::dynamic_byte_array & pGdsCache )
 	{
 		return internal::deserializeExternalResizable( pValue, pReadCallback, pGdsCache );
 	}
 
 	template <typename TPValue>
-	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, dynamic_memory_buffer & pGdsCache )
+	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback, cppx::dynamic_memory_buffer & pGdsCache )
 	{
 		return internal::deserializeExternalResizable( pValue, pReadCallback, pGdsCache );
 	}
@@ -817,11 +959,96 @@ namespace Ic3
 		return internal::deserializeExternalResizable( pValue, pReadCallback, pGdsCache );
 	}
 
+	/***********************************************************************************************************/
+	/********************************************* Contiguous Ranges *******************************************/
+	/***********************************************************************************************************/
+
 	template <typename TPValue>
-	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback )
+	inline gds_size_t GDSCore::evalByteSizeRange( const TPValue * pValues, size_t pCount )
 	{
-		Dynamicbyte_array localGdsCache{};
-		return deserializeExternal( pValue, pReadCallback, localGdsCache );
+		if constexpr( GdsStaticByteSize<TPValue>::sValue > 0 )
+		{
+			// All values have the same size, no need to visit them.
+			return GdsStaticByteSize<TPValue>::sValue * pCount;
+		}
+		else
+		{
+			gds_size_t byteSize = 0;
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				byteSize += GDSCore::evalByteSize( pValues[valueIndex] );
+			}
+			return byteSize;
+		}
+	}
+
+	template <typename TPValue>
+	inline gds_size_t GDSCore::serializeRange( byte * pOutputBuffer, const TPValue * pValues, size_t pCount )
+	{
+		if constexpr( IsGdsBitwiseSerializable<TPValue>::sValue )
+		{
+			static_assert( GdsStaticByteSize<TPValue>::sValue == sizeof( TPValue ) );
+
+			// Serialized representation is the same as the in-memory one: copy the whole range at once.
+			const auto rangeByteSize = sizeof( TPValue ) * pCount;
+			if( rangeByteSize > 0 )
+			{
+				std::memcpy( pOutputBuffer, pValues, rangeByteSize );
+			}
+			return rangeByteSize;
+		}
+		else if constexpr( GdsStaticByteSize<TPValue>::sValue > 0 )
+		{
+			// Fixed stride: the output offset of each value is known upfront, so there is no dependency between
+			// iterations and the compiler can unroll/vectorize the loop (e.g. byte-swapping of integers).
+			constexpr auto valueByteSize = GdsStaticByteSize<TPValue>::sValue;
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				GDSCore::serialize( pOutputBuffer + valueIndex * valueByteSize, pValues[valueIndex] );
+			}
+			return valueByteSize * pCount;
+		}
+		else
+		{
+			gds_size_t byteSize = 0;
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				byteSize += GDSCore::serialize( pOutputBuffer + byteSize, pValues[valueIndex] );
+			}
+			return byteSize;
+		}
+	}
+
+	template <typename TPValue>
+	inline gds_size_t GDSCore::deserializeRange( const byte * pInputData, TPValue * pValues, size_t pCount )
+	{
+		if constexpr( IsGdsBitwiseSerializable<TPValue>::sValue )
+		{
+			const auto rangeByteSize = sizeof( TPValue ) * pCount;
+			if( rangeByteSize > 0 )
+			{
+				std::memcpy( pValues, pInputData, rangeByteSize );
+			}
+			return rangeByteSize;
+		}
+		else if constexpr( GdsStaticByteSize<TPValue>::sValue > 0 )
+		{
+			constexpr auto valueByteSize = GdsStaticByteSize<TPValue>::sValue;
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				GDSCore::deserialize( pInputData + valueIndex * valueByteSize, pValues[valueIndex] );
+			}
+			return valueByteSize * pCount;
+		}
+		else
+		{
+			gds_size_t byteSize = 0;
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				byteSize += GDSCore::deserialize( pInputData + byteSize, pValues[valueIndex] );
+			}
+			return byteSize;
+		}
 	}
 
 	/***********************************************************************************************************/
@@ -831,6 +1058,8 @@ namespace Ic3
 	template <template <typename...> typename TC, typename... TCArgs>
 	inline gds_size_t GDSCore::evalByteSizeContainer( const TC<TCArgs...> & pContainer )
 	{
+		using ValueType = typename TC<TCArgs...>::value_type;
+
 		// Compute the size for the specified container.
 		// The space required is the serialized size + binary representation of all elements in the container.
 		gds_size_t byteSize = 0;
@@ -838,11 +1067,19 @@ namespace Ic3
 		// The first member is the number of elements in a container. We are not interested in its value, though.
 		byteSize += GDS::evalByteSize( GDS::emptySizeType() );
 
-		// Enumerate over the container's elements.
-		for( const auto & entry : pContainer )
+		if constexpr( GdsStaticByteSize<ValueType>::sValue > 0 )
 		{
-			// Evaluate the size of each element and add it to the result.
-			byteSize += GDSCore::evalByteSize( entry );
+			// All elements have the same size, so the container's size is enough.
+			byteSize += GdsStaticByteSize<ValueType>::sValue * pContainer.size();
+		}
+		else
+		{
+			// Enumerate over the container's elements.
+			for( const auto & entry : pContainer )
+			{
+				// Evaluate the size of each element and add it to the result.
+				byteSize += GDSCore::evalByteSize( entry );
+			}
 		}
 
 		return byteSize;
@@ -896,17 +1133,28 @@ namespace Ic3
 	template <template <typename...> typename TC, typename... TCArgs>
 	inline gds_size_t GDSCore::evalMapByteSize( const TC<TCArgs...> & pMap )
 	{
+		using KeyType = typename TC<TCArgs...>::key_type;
+		using MappedType = typename TC<TCArgs...>::mapped_type;
+
 		gds_size_t byteSize = 0;
 
 		// The first member is the number of elements in a container. We are not interested in its value, though.
 		byteSize += GDS::evalByteSize( GDS::emptySizeType() );
 
-		// Enumerate over the container's elements.
-		for( const auto & mapEntry : pMap )
+		if constexpr( ( GdsStaticByteSize<KeyType>::sValue > 0 ) && ( GdsStaticByteSize<MappedType>::sValue > 0 ) )
+		{
+			// Both keys and values have static sizes, so the map's size is enough.
+			byteSize += ( GdsStaticByteSize<KeyType>::sValue + GdsStaticByteSize<MappedType>::sValue ) * pMap.size();
+		}
+		else
 		{
-			// Evaluate the size of each element. Propagate cast tag to support container-wise value casting.
-			byteSize += GDSCore::evalByteSize( mapEntry.first );
-			byteSize += GDSCore::evalByteSize( mapEntry.second );
+			// Enumerate over the container's elements.
+			for( const auto & mapEntry : pMap )
+			{
+				// Evaluate the size of each element. Propagate cast tag to support container-wise value casting.
+				byteSize += GDSCore::evalByteSize( mapEntry.first );
+				byteSize += GDSCore::evalByteSize( mapEntry.second );
+			}
 		}
 
 		return byteSize;
@@ -937,6 +1185,12 @@ namespace Ic3
 
 		gds_size_t byteSize = GDS::deserialize( pInputData, GDS::asSizeType( mapSize ) );
 
+		if constexpr( internal::HasReserve<TM<TK, TV, TCArgs...>>::sValue )
+		{
+			// Hash maps: allocate all buckets upfront instead of rehashing multiple times during insertion.
+			pMap.reserve( pMap.size() + mapSize );
+		}
+
 		for( size_t entryIndex = 0; entryIndex < mapSize; ++entryIndex )
 		{
 			TK tempKey{};
@@ -945,7 +1199,9 @@ namespace Ic3
 			TV tempValue{};
 			byteSize += GDSCore::deserialize( pInputData + byteSize, tempValue );
 
-			pMap.emplace( std::move( tempKey ), std::move( tempValue ) );
+			// Ordered maps are serialized in the key order, so inserting at the end makes each insertion amortized
+			// constant instead of a full tree lookup. For unordered maps, the hint is simply ignored.
+			pMap.emplace_hint( pMap.end(), std::move( tempKey ), std::move( tempValue ) );
 		}
 
 		return byteSize;
@@ -959,10 +1215,7 @@ namespace Ic3
 	inline gds_size_t GDSCore::evalByteSize( const cppx::array_view<TPValue> & pArrayView )
 	{
 		gds_size_t byteSize = GDS::evalByteSize( GDS::emptySizeType() );
-		for( const auto & entry : pArrayView )
-		{
-			byteSize += GDSCore::evalByteSize( entry );
-		}
+		byteSize += evalByteSizeRange( pArrayView.data(), pArrayView.size() );
 		return byteSize;
 	}
 
@@ -970,10 +1223,7 @@ namespace Ic3
 	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const cppx::array_view<TPValue> & pArrayView )
 	{
 		gds_size_t byteSize = GDS::serialize( pOutputBuffer, GDS::asSizeType( pArrayView.size() ) );
-		for( const auto & value : pArrayView )
-		{
-			byteSize += GDSCore::serialize(  pOutputBuffer + byteSize, value );
-		}
+		byteSize += serializeRange( pOutputBuffer + byteSize, pArrayView.data(), pArrayView.size() );
 		return byteSize;
 	}
 
@@ -982,10 +1232,7 @@ namespace Ic3
 	{
 		size_t arraySize = 0;
 		gds_size_t byteSize = GDS::deserialize( pInputData, GDS::asSizeType( arraySize ) );
-		for( auto & value : pArrayView )
-		{
-			byteSize += GDSCore::deserialize( pInputData + byteSize, value );
-		}
+		byteSize += deserializeRange( pInputData + byteSize, pArrayView.data(), pArrayView.size() );
 		return byteSize;
 	}
 
@@ -994,21 +1241,24 @@ namespace Ic3
 	/***********************************************************************************************************/
 
 	template <typename TPIntegral>
-	inline gds_size_t GDSCore::evalByteSize( const AtomicBitmask<TPIntegral> & pBitmask )
+	inline gds_size_t GDSCore::evalByteSize( const cppx::atomic_bitmask<TPIntegral> & pBitmask )
 	{
-		return GDS::evalByteSize( static_cast<TPIntegral>( pBitmask ) );
+		return GDS::evalByteSize( pBitmask.get() );
 	}
 
 	template <typename TPIntegral>
-	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const AtomicBitmask<TPIntegral> & pBitmask )
+	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const cppx::atomic_bitmask<TPIntegral> & pBitmask )
 	{
-		return GDS::serialize( pOutputBuffer, static_cast<TPIntegral>( pBitmask ) );
+		return GDS::serialize( pOutputBuffer, pBitmask.get() );
 	}
 
 	template <typename TPIntegral>
-	inline gds_size_t GDSCore::deserialize( const byte * pInputData, AtomicBitmask<TPIntegral> & pBitmask )
+	inline gds_size_t GDSCore::deserialize( const byte * pInputData, cppx::atomic_bitmask<TPIntegral> & pBitmask )
 	{
-		return deserialize( pInputData, static_cast<TPIntegral>( pBitmask ) );
+		typename cppx::atomic_bitmask<TPIntegral>::ValueType bitmaskValue = 0;
+		const auto byteSize = GDS::deserialize( pInputData, bitmaskValue );
+		pBitmask = bitmaskValue;
+		return byteSize;
 	}
 
 	/***********************************************************************************************************/
@@ -1018,19 +1268,22 @@ namespace Ic3
 	template <typename TPIntegral>
 	inline gds_size_t GDSCore::evalByteSize( const cppx::bitmask<TPIntegral> & pBitmask )
 	{
-		return evalByteSize( static_cast<TPIntegral>( pBitmask ) );
+		return GDS::evalByteSize( pBitmask.get() );
 	}
 
 	template <typename TPIntegral>
 	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const cppx::bitmask<TPIntegral> & pBitmask )
 	{
-		return serialize( pOutputBuffer, static_cast<TPIntegral>( pBitmask ) );
+		return GDS::serialize( pOutputBuffer, pBitmask.get() );
 	}
 
 	template <typename TPIntegral>
 	inline gds_size_t GDSCore::deserialize( const byte * pInputData, cppx::bitmask<TPIntegral> & pBitmask )
 	{
-		return deserialize( pInputData, static_cast<TPIntegral>( pBitmask ) );
+		typename cppx::bitmask<TPIntegral>::value_type bitmaskValue = 0;
+		const auto byteSize = GDS::deserialize( pInputData, bitmaskValue );
+		pBitmask = bitmaskValue;
+		return byteSize;
 	}
 
 	/***********************************************************************************************************/
@@ -1038,19 +1291,19 @@ namespace Ic3
 	/***********************************************************************************************************/
 
 	template <typename TPValue, typename TPComparator, typename TPAllocator>
-	inline gds_size_t GDSCore::evalByteSize( const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray )
+	inline gds_size_t GDSCore::evalByteSize( const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray )
 	{
 		return evalByteSizeContainer( pSortedArray );
 	}
 
 	template <typename TPValue, typename TPComparator, typename TPAllocator>
-	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray )
+	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray )
 	{
 		return serializeContainer( pOutputBuffer, pSortedArray );
 	}
 
 	template <typename TPValue, typename TPComparator, typename TPAllocator>
-	inline gds_size_t GDSCore::deserialize( const byte * pInputData, const SortedArray<TPValue, TPComparator, TPAllocator> & pSortedArray )
+	inline gds_size_t GDSCore::deserialize( const byte * pInputData, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray )
 	{
 		return deserializeContainer( pInputData, pSortedArray,
 			[]( auto & SA, auto, auto E ) -> void { SA.insert( std::forward<decltype( E )>( E ) ); } );
@@ -1069,7 +1322,7 @@ namespace Ic3
 		byteSize += GDS::evalByteSize( GDS::emptySizeType() );
 
 		// Then we have the characters (potentially cast).
-		byteSize += pString.length() * evalByteSize( TCh{} );
+		byteSize += evalByteSizeRange( pString.data(), pString.length() );
 
 		return byteSize;
 	}
@@ -1081,10 +1334,8 @@ namespace Ic3
 
 		gds_size_t byteSize = GDS::serialize( pOutputBuffer, GDS::asSizeType( strLength ) );
 
-		for( size_t charIndex = 0; charIndex < strLength; ++charIndex )
-		{
-			byteSize += serialize( pOutputBuffer + byteSize, pString[charIndex] );
-		}
+		// Narrow strings are copied at once, wide ones are written with a fixed stride.
+		byteSize += serializeRange( pOutputBuffer + byteSize, pString.data(), strLength );
 
 		return byteSize;
 	}
@@ -1097,10 +1348,7 @@ namespace Ic3
 
 		pString.resize( strLength );
 
-		for( size_t charIndex = 0; charIndex < strLength; ++charIndex )
-		{
-			byteSize += deserialize( pInputData + byteSize, pString[charIndex] );
-		}
+		byteSize += deserializeRange( pInputData + byteSize, pString.data(), strLength );
 
 		return byteSize;
 	}
@@ -1123,7 +1371,7 @@ namespace Ic3
 	{
 		gds_size_t byteSize = 0;
 		byteSize += serialize( pOutputBuffer, pPair.first );
-		byteSize += serialize( pOutputBuffer, pPair.second );
+		byteSize += serialize( pOutputBuffer + byteSize, pPair.second );
 		return byteSize;
 	}
 
@@ -1132,7 +1380,7 @@ namespace Ic3
 	{
 		gds_size_t byteSize = 0;
 		byteSize += deserialize( pInputData, pPair.first );
-		byteSize += deserialize( pInputData, pPair.second );
+		byteSize += deserialize( pInputData + byteSize, pPair.second );
 		return byteSize;
 	}
 
@@ -1140,48 +1388,98 @@ namespace Ic3
 	/************************************************ std::array ***********************************************/
 	/***********************************************************************************************************/
 
+	// std::array is a non-type template, so it cannot go through the generic container helpers.
+	// It is contiguous, though, so the range functions are used directly (with the same output format).
+
 	template <typename TPValue, size_t tpSize>
 	inline gds_size_t GDSCore::evalByteSize( const std::array<TPValue, tpSize> & pArray )
 	{
-		return evalByteSizeContainer( pArray );
+		gds_size_t byteSize = GDS::evalByteSize( GDS::emptySizeType() );
+		byteSize += evalByteSizeRange( pArray.data(), tpSize );
+		return byteSize;
 	}
 
 	template <typename TPValue, size_t tpSize>
 	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const std::array<TPValue, tpSize> & pArray )
 	{
-		return serializeContainer( pOutputBuffer, pArray );
+		gds_size_t byteSize = GDS::serialize( pOutputBuffer, GDS::asSizeType( tpSize ) );
+		byteSize += serializeRange( pOutputBuffer + byteSize, pArray.data(), tpSize );
+		return byteSize;
 	}
 
 	template <typename TPValue, size_t tpSize>
 	inline gds_size_t GDSCore::deserialize( const byte * pInputData, std::array<TPValue, tpSize> & pArray )
 	{
-		// std::array doesn't have any push/insert methods, so that's the one case where index becomes useful.
-		// We simply assign the incoming elements under their indexes passed by the helper method. Simple.
-		return deserializeContainer( pInputData, pArray,
-			[]( auto & A, auto I, auto && E ) -> void { A[I] = std::forward<decltype( E )>( E ); } );
+		size_t arraySize = 0;
+		gds_size_t byteSize = GDS::deserialize( pInputData, GDS::asSizeType( arraySize ) );
+
+		if( arraySize > tpSize )
+		{
+			// Corrupted data or a different type: reading the elements would write past the end of the array.
+			Ic3ThrowDesc( E_EXC_CORE_GDS, "Serialized array size exceeds the size of the target std::array." );
+		}
+
+		byteSize += deserializeRange( pInputData + byteSize, pArray.data(), arraySize );
+		return byteSize;
 	}
 
 	/***********************************************************************************************************/
 	/*********************************************** std::vector ***********************************************/
 	/***********************************************************************************************************/
 
+	// std::vector<bool> is not contiguous (no data()), so it is the only one handled by the generic helpers.
+
 	template <typename TPValue, typename TPAllocator>
 	inline gds_size_t GDSCore::evalByteSize( const std::vector<TPValue, TPAllocator> & pVector )
 	{
-		return evalByteSizeContainer( pVector );
+		if constexpr( std::is_same<TPValue, bool>::value )
+		{
+			return evalByteSizeContainer( pVector );
+		}
+		else
+		{
+			gds_size_t byteSize = GDS::evalByteSize( GDS::emptySizeType() );
+			byteSize += evalByteSizeRange( pVector.data(), pVector.size() );
+			return byteSize;
+		}
 	}
 
 	template <typename TPValue, typename TPAllocator>
 	inline gds_size_t GDSCore::serialize( byte * pOutputBuffer, const std::vector<TPValue, TPAllocator> & pVector )
 	{
-		return serializeContainer( pOutputBuffer, pVector );
+		if constexpr( std::is_same<TPValue, bool>::value )
+		{
+			return serializeContainer( pOutputBuffer, pVector );
+		}
+		else
+		{
+			gds_size_t byteSize = GDS::serialize( pOutputBuffer, GDS::asSizeType( pVector.size() ) );
+			byteSize += serializeRange( pOutputBuffer + byteSize, pVector.data(), pVector.size() );
+			return byteSize;
+		}
 	}
 
 	template <typename TPValue, typename TPAllocator>
 	inline gds_size_t GDSCore::deserialize( const byte * pInputData, std::vector<TPValue, TPAllocator> & pVector )
 	{
-		return deserializeContainer( pInputData, pVector,
-			[]( auto & V, auto, auto && E ) -> void { V.push_back( std::forward<decltype( E )>( E ) ); } );
+		if constexpr( std::is_same<TPValue, bool>::value )
+		{
+			return deserializeContainer( pInputData, pVector,
+				[]( auto & V, auto, auto && E ) -> void { V.push_back( std::forward<decltype( E )>( E ) ); } );
+		}
+		else
+		{
+			size_t vectorSize = 0;
+			gds_size_t byteSize = GDS::deserialize( pInputData, GDS::asSizeType( vectorSize ) );
+
+			// Deserialized elements are appended to the existing ones (just like with the insert callback).
+			// The vector is resized once and the elements are deserialized in-place.
+			const auto baseIndex = pVector.size();
+			pVector.resize( baseIndex + vectorSize );
+
+			byteSize += deserializeRange( pInputData + byteSize, pVector.data() + baseIndex, vectorSize );
+			return byteSize;
+		}
 	}
 
 	//
@@ -1369,4 +1667,6 @@ namespace Ic3
 
 } // namespace Ic3
 
+#include "GDSStream.h"
+
 #endif // __IC3_CORELIB_GDS_CORE_H__
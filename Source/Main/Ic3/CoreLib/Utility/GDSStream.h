@@ -0,0 +1,846 @@
+
+#ifndef __IC3_CORELIB_GDS_STREAM_H__
+#define __IC3_CORELIB_GDS_STREAM_H__
+
+#include "GDSCore.h"
+
+namespace Ic3
+{
+
+	namespace GDSCore
+	{
+
+		// Streaming serialization/deserialization support.
+		//
+		// serializeExternal()/deserializeExternal() with a user-specified cache serialize the whole object into
+		// a temporary buffer (or read the whole serialized block into one) before writing (or decoding) it. For large
+		// objects this doubles the memory usage. The stream API below goes through a fixed-size intermediate buffer
+		// instead: the data is written to the sink each time the buffer fills up and read from the source only as
+		// it is decoded. Large contiguous ranges of bitwise-serializable values bypass the buffer entirely.
+		//
+		// Output format is exactly the same as with serializeExternal() (MetaData block followed by the object data),
+		// so the data written with one API can be read with the other.
+		//
+		// Limitation: a value is split into pieces only if it has a writeStream() overload below (strings, vectors,
+		// arrays, pairs, sorted arrays, array views and their nested combinations) or a static byte size. Any other
+		// value - most notably a user type serialized through GdsSerializable, which writes itself into a single
+		// contiguous block - is serialized as a whole: into the intermediate buffer if it fits or into a temporary
+		// buffer of its full serialized size otherwise. Peak memory usage for such a value is its serialized size.
+		//
+		// Sinks and sources are template parameters (no std::function indirection). A sink is any callable:
+		//   uint64 ( const void * pData, uint64 pDataSize ) -> returns the number of bytes written,
+		// a source is any callable:
+		//   uint64 ( void * pTargetBuffer, uint64 pReadSize ) -> returns the number of bytes read.
+		// IOStreamSink/IOStreamSource adapt any object with Write()/Read() methods (e.g. System::File or pipes).
+
+		/// @brief Default size of the intermediate buffer used by StreamWriter and StreamReader.
+		inline constexpr size_t kGdsStreamDefaultBufferSize = 64 * 1024;
+
+		/// @brief Minimum size of the intermediate buffer. Must be large enough to hold the MetaData block
+		/// and any value with a static byte size which is not bitwise-serializable (at most few words).
+		inline constexpr size_t kGdsStreamMinBufferSize = 256;
+
+		/// @brief Sink adapter for output stream objects providing Write( pData, pDataSize ).
+		template <typename TPOutputStream>
+		struct IOStreamSink
+		{
+			TPOutputStream * outputStream;
+
+			uint64 operator()( const void * pData, uint64 pDataSize ) const
+			{
+				return outputStream->Write( pData, pDataSize );
+			}
+		};
+
+		/// @brief Source adapter for input stream objects providing Read( pTargetBuffer, pTargetBufferSize ).
+		template <typename TPInputStream>
+		struct IOStreamSource
+		{
+			TPInputStream * inputStream;
+
+			uint64 operator()( void * pTargetBuffer, uint64 pReadSize ) const
+			{
+				return inputStream->Read( pTargetBuffer, pReadSize );
+			}
+		};
+
+		/// @brief Buffered writer, which forwards serialized data to a sink in chunks of a bounded size.
+		template <typename TPSink>
+		class StreamWriter
+		{
+		public:
+			explicit StreamWriter( TPSink pSink, size_t pBufferSize = kGdsStreamDefaultBufferSize )
+			: _sink( std::move( pSink ) )
+			, _buffer( std::max( pBufferSize, kGdsStreamMinBufferSize ) )
+			{}
+
+			/// @brief Returns the total number of bytes accepted by the writer so far (including buffered ones).
+			CPPX_ATTR_NO_DISCARD gds_size_t GetWrittenBytesNum() const noexcept
+			{
+				return _writtenBytesNum;
+			}
+
+			/// @brief Returns the size of the intermediate buffer.
+			CPPX_ATTR_NO_DISCARD size_t GetBufferCapacity() const noexcept
+			{
+				return _buffer.size();
+			}
+
+			/// @brief Returns true if all data passed to the sink so far has been written successfully.
+			CPPX_ATTR_NO_DISCARD bool IsGood() const noexcept
+			{
+				return !_sinkFailed;
+			}
+
+			/// @brief Reserves pSize bytes in the buffer (flushing it first, if needed) and returns a pointer to them.
+			/// The caller is expected to write all of the reserved bytes. Returns nullptr if pSize exceeds the capacity.
+			byte * Reserve( gds_size_t pSize );
+
+			/// @brief Writes raw bytes. Blocks larger than the buffer are passed directly to the sink.
+			void WriteBytes( const void * pData, gds_size_t pDataSize );
+
+			/// @brief Serializes a single value as a whole. If its size exceeds the buffer capacity, a temporary buffer
+			/// of the full serialized size is used (see the limitation described at the top of this file).
+			template <typename TPValue>
+			void WriteValue( const TPValue & pValue );
+
+			/// @brief Writes all buffered data to the sink. Must be called after the last write.
+			bool Flush();
+
+		private:
+			bool _WriteToSink( const void * pData, gds_size_t pDataSize );
+
+		private:
+			TPSink _sink;
+			std::vector<byte> _buffer;
+			size_t _bufferOffset = 0;
+			gds_size_t _writtenBytesNum = 0;
+			bool _sinkFailed = false;
+		};
+
+		/// @brief Buffered reader, which fetches serialized data from a source in chunks of a bounded size.
+		/// The reader never requests more data from the source than the current data limit, so the source
+		/// is left positioned exactly after the data which has been consumed.
+		template <typename TPSource>
+		class StreamReader
+		{
+		public:
+			explicit StreamReader( TPSource pSource, gds_size_t pDataLimit, size_t pBufferSize = kGdsStreamDefaultBufferSize )
+			: _source( std::move( pSource ) )
+			, _buffer( std::max( pBufferSize, kGdsStreamMinBufferSize ) )
+			, _sourceBytesLeft( pDataLimit )
+			{}
+
+			/// @brief Returns the total number of bytes consumed from the reader so far.
+			CPPX_ATTR_NO_DISCARD gds_size_t GetReadBytesNum() const noexcept
+			{
+				return _readBytesNum;
+			}
+
+			/// @brief Returns the size of the intermediate buffer.
+			CPPX_ATTR_NO_DISCARD size_t GetBufferCapacity() const noexcept
+			{
+				return _buffer.size();
+			}
+
+			/// @brief Returns true if all data requested from the source so far has been read successfully.
+			CPPX_ATTR_NO_DISCARD bool IsGood() const noexcept
+			{
+				return !_sourceFailed;
+			}
+
+			/// @brief Extends the number of bytes which can be fetched from the source by pDataSize.
+			void ExtendDataLimit( gds_size_t pDataSize ) noexcept
+			{
+				_sourceBytesLeft += pDataSize;
+			}
+
+			/// @brief Consumes pSize bytes and returns a pointer to them. The pointer stays valid until the next
+			/// call to any of the read functions. Returns nullptr if pSize exceeds the buffer capacity or the data limit.
+			const byte * Acquire( gds_size_t pSize );
+
+			/// @brief Reads raw bytes. Blocks larger than the buffer are read directly from the source.
+			bool ReadBytes( void * pTarget, gds_size_t pSize );
+
+			/// @brief Deserializes a single value with a static byte size.
+			template <typename TPValue>
+			bool ReadValue( TPValue & pValue );
+
+			/// @brief Deserializes a size value (container or string length), written with GDS::asSizeType().
+			bool ReadSizeValue( size_t & pSizeValue );
+
+			/// @brief Discards pSize bytes.
+			bool Skip( gds_size_t pSize );
+
+		private:
+			bool _FillBuffer( gds_size_t pRequiredSize );
+
+			bool _ReadFromSource( void * pTarget, gds_size_t pSize );
+
+		private:
+			TPSource _source;
+			std::vector<byte> _buffer;
+			size_t _bufferOffset = 0;
+			size_t _bufferDataEnd = 0;
+			gds_size_t _sourceBytesLeft = 0;
+			gds_size_t _readBytesNum = 0;
+			bool _sourceFailed = false;
+		};
+
+		/// @brief Trait with a static bool 'sValue' indicating whether values of a type can be decoded from a stream
+		/// piece by piece. This is true for values with a static byte size and (nested) vectors, strings, arrays and
+		/// pairs of such. Other types (e.g. user types with custom serialization) do not provide their size before
+		/// being deserialized, so they require the whole serialized block to be available in memory.
+		template <typename TPValue>
+		struct IsGdsStreamDecodable
+		{
+			static inline constexpr bool sValue = GdsStaticByteSize<TPValue>::sValue > 0;
+		};
+
+		template <typename TPValue, typename TPAllocator>
+		struct IsGdsStreamDecodable<std::vector<TPValue, TPAllocator>>
+		{
+			static inline constexpr bool sValue = IsGdsStreamDecodable<TPValue>::sValue && !std::is_same<TPValue, bool>::value;
+		};
+
+		template <typename TCh, typename TTr, typename TPAllocator>
+		struct IsGdsStreamDecodable<std::basic_string<TCh, TTr, TPAllocator>>
+		{
+			static inline constexpr bool sValue = IsGdsStreamDecodable<TCh>::sValue;
+		};
+
+		template <typename TPValue, size_t tpSize>
+		struct IsGdsStreamDecodable<std::array<TPValue, tpSize>>
+		{
+			static inline constexpr bool sValue = IsGdsStreamDecodable<TPValue>::sValue;
+		};
+
+		template <typename T1, typename T2>
+		struct IsGdsStreamDecodable<std::pair<T1, T2>>
+		{
+			static inline constexpr bool sValue = IsGdsStreamDecodable<T1>::sValue && IsGdsStreamDecodable<T2>::sValue;
+		};
+
+		/***********************************************************************************************************/
+		/****************************************** Stream API - Values ********************************************/
+		/***********************************************************************************************************/
+
+		template <typename TPSink, typename TPValue>
+		void writeStream( StreamWriter<TPSink> & pWriter, const TPValue & pValue );
+
+		template <typename TPSink, typename TPValue>
+		void writeStreamRange( StreamWriter<TPSink> & pWriter, const TPValue * pValues, size_t pCount );
+
+		template <typename TPSink, typename TPValue>
+		void writeStream( StreamWriter<TPSink> & pWriter, const cppx::array_view<TPValue> & pArrayView );
+
+		template <typename TPSink, typename TCh, typename TTr, typename TPAllocator>
+		void writeStream( StreamWriter<TPSink> & pWriter, const std::basic_string<TCh, TTr, TPAllocator> & pString );
+
+		template <typename TPSink, typename T1, typename T2>
+		void writeStream( StreamWriter<TPSink> & pWriter, const std::pair<T1, T2> & pPair );
+
+		template <typename TPSink, typename TPValue, size_t tpSize>
+		void writeStream( StreamWriter<TPSink> & pWriter, const std::array<TPValue, tpSize> & pArray );
+
+		template <typename TPSink, typename TPValue, typename TPComparator, typename TPAllocator>
+		void writeStream( StreamWriter<TPSink> & pWriter, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray );
+
+		template <typename TPSink, typename TPValue, typename TPAllocator>
+		void writeStream( StreamWriter<TPSink> & pWriter, const std::vector<TPValue, TPAllocator> & pVector );
+
+		template <typename TPSource, typename TPValue>
+		bool readStream( StreamReader<TPSource> & pReader, TPValue & pValue );
+
+		template <typename TPSource, typename TPValue>
+		bool readStreamRange( StreamReader<TPSource> & pReader, TPValue * pValues, size_t pCount );
+
+		template <typename TPSource, typename TCh, typename TTr, typename TPAllocator>
+		bool readStream( StreamReader<TPSource> & pReader, std::basic_string<TCh, TTr, TPAllocator> & pString );
+
+		template <typename TPSource, typename T1, typename T2>
+		bool readStream( StreamReader<TPSource> & pReader, std::pair<T1, T2> & pPair );
+
+		template <typename TPSource, typename TPValue, size_t tpSize>
+		bool readStream( StreamReader<TPSource> & pReader, std::array<TPValue, tpSize> & pArray );
+
+		template <typename TPSource, typename TPValue, typename TPAllocator>
+		bool readStream( StreamReader<TPSource> & pReader, std::vector<TPValue, TPAllocator> & pVector );
+
+		/***********************************************************************************************************/
+		/****************************************** Stream API - External ******************************************/
+		/***********************************************************************************************************/
+
+		/// @brief Serializes the specified object (with MetaData) and writes it to the sink using a bounded buffer.
+		/// Returns the number of bytes written or 0 if the object is empty or the sink failed.
+		template <typename TPValue, typename TPSink>
+		gds_size_t serializeStream( const TPValue & pValue, TPSink pSink, size_t pBufferSize = kGdsStreamDefaultBufferSize );
+
+		/// @brief Reads an object written with serializeStream() or serializeExternal() from the source. Stream-decodable
+		/// types are decoded as the data arrives, other ones are decoded after reading the whole serialized block.
+		/// Returns the number of bytes read or 0 if the data is not valid.
+		template <typename TPValue, typename TPSource>
+		gds_size_t deserializeStream( TPValue & pValue, TPSource pSource, size_t pBufferSize = kGdsStreamDefaultBufferSize );
+
+	} // namespace GDSCore
+
+	/***********************************************************************************************************/
+	/********************************************** StreamWriter ***********************************************/
+	/***********************************************************************************************************/
+
+	template <typename TPSink>
+	inline byte * GDSCore::StreamWriter<TPSink>::Reserve( gds_size_t pSize )
+	{
+		if( pSize > _buffer.size() )
+		{
+			return nullptr;
+		}
+
+		if( pSize > ( _buffer.size() - _bufferOffset ) )
+		{
+			Flush();
+		}
+
+		auto * reservedPtr = _buffer.data() + _bufferOffset;
+		_bufferOffset += cppx::numeric_cast<size_t>( pSize );
+		_writtenBytesNum += pSize;
+
+		return reservedPtr;
+	}
+
+	template <typename TPSink>
+	inline void GDSCore::StreamWriter<TPSink>::WriteBytes( const void * pData, gds_size_t pDataSize )
+	{
+		if( pDataSize <= ( _buffer.size() - _bufferOffset ) )
+		{
+			std::memcpy( _buffer.data() + _bufferOffset, pData, cppx::numeric_cast<size_t>( pDataSize ) );
+			_bufferOffset += cppx::numeric_cast<size_t>( pDataSize );
+		}
+		else
+		{
+			Flush();
+
+			if( pDataSize >= _buffer.size() )
+			{
+				// Large blocks are written directly, copying them through the buffer would only add overhead.
+				_WriteToSink( pData, pDataSize );
+			}
+			else
+			{
+				std::memcpy( _buffer.data(), pData, cppx::numeric_cast<size_t>( pDataSize ) );
+				_bufferOffset = cppx::numeric_cast<size_t>( pDataSize );
+			}
+		}
+
+		_writtenBytesNum += pDataSize;
+	}
+
+	template <typename TPSink>
+	template <typename TPValue>
+	inline void GDSCore::StreamWriter<TPSink>::WriteValue( const TPValue & pValue )
+	{
+		const auto valueByteSize = GDSCore::evalByteSize( pValue );
+
+		if( auto * valueDataPtr = Reserve( valueByteSize ) )
+		{
+			GDSCore::serialize( valueDataPtr, pValue );
+		}
+		else
+		{
+			// A value which cannot be split and does not fit into the buffer (a user type with a large, custom-serialized
+			// content). Its serialize() needs a contiguous output, so there is no way around a temporary buffer here.
+			std::vector<byte> valueData( cppx::numeric_cast<size_t>( valueByteSize ) );
+			GDSCore::serialize( valueData.data(), pValue );
+			WriteBytes( valueData.data(), valueByteSize );
+		}
+	}
+
+	template <typename TPSink>
+	inline bool GDSCore::StreamWriter<TPSink>::Flush()
+	{
+		if( _bufferOffset > 0 )
+		{
+			_WriteToSink( _buffer.data(), _bufferOffset );
+			_bufferOffset = 0;
+		}
+		return !_sinkFailed;
+	}
+
+	template <typename TPSink>
+	inline bool GDSCore::StreamWriter<TPSink>::_WriteToSink( const void * pData, gds_size_t pDataSize )
+	{
+		// Once the sink fails, the output is incomplete anyway. Do not write anything past that point.
+		if( !_sinkFailed )
+		{
+			const auto writtenSize = _sink( pData, pDataSize );
+			_sinkFailed = ( writtenSize != pDataSize );
+		}
+		return !_sinkFailed;
+	}
+
+	/***********************************************************************************************************/
+	/********************************************** StreamReader ***********************************************/
+	/***********************************************************************************************************/
+
+	template <typename TPSource>
+	inline const byte * GDSCore::StreamReader<TPSource>::Acquire( gds_size_t pSize )
+	{
+		if( !_FillBuffer( pSize ) )
+		{
+			return nullptr;
+		}
+
+		const auto * dataPtr = _buffer.data() + _bufferOffset;
+		_bufferOffset += cppx::numeric_cast<size_t>( pSize );
+		_readBytesNum += pSize;
+
+		return dataPtr;
+	}
+
+	template <typename TPSource>
+	inline bool GDSCore::StreamReader<TPSource>::ReadBytes( void * pTarget, gds_size_t pSize )
+	{
+		auto * targetBytePtr = reinterpret_cast<byte *>( pTarget );
+
+		// Whatever is already in the buffer goes first.
+		const auto bufferedSize = cppx::get_min_of<gds_size_t>( pSize, _bufferDataEnd - _bufferOffset );
+		if( bufferedSize > 0 )
+		{
+			std::memcpy( targetBytePtr, _buffer.data() + _bufferOffset, cppx::numeric_cast<size_t>( bufferedSize ) );
+			_bufferOffset += cppx::numeric_cast<size_t>( bufferedSize );
+			_readBytesNum += bufferedSize;
+		}
+
+		const auto remainingSize = pSize - bufferedSize;
+		if( remainingSize == 0 )
+		{
+			return true;
+		}
+
+		if( remainingSize >= _buffer.size() )
+		{
+			// Large blocks are read directly into the target memory.
+			if( !_ReadFromSource( targetBytePtr + bufferedSize, remainingSize ) )
+			{
+				return false;
+			}
+			_readBytesNum += remainingSize;
+			return true;
+		}
+
+		const auto * remainingDataPtr = Acquire( remainingSize );
+		if( !remainingDataPtr )
+		{
+			return false;
+		}
+
+		std::memcpy( targetBytePtr + bufferedSize, remainingDataPtr, cppx::numeric_cast<size_t>( remainingSize ) );
+		return true;
+	}
+
+	template <typename TPSource>
+	template <typename TPValue>
+	inline bool GDSCore::StreamReader<TPSource>::ReadValue( TPValue & pValue )
+	{
+		constexpr auto valueByteSize = GdsStaticByteSize<TPValue>::sValue;
+		static_assert( valueByteSize > 0, "Only values with a static byte size can be read without their whole data block." );
+
+		if( const auto * valueDataPtr = Acquire( valueByteSize ) )
+		{
+			GDSCore::deserialize( valueDataPtr, pValue );
+			return true;
+		}
+		else if( valueByteSize > _buffer.size() )
+		{
+			std::vector<byte> valueData( cppx::numeric_cast<size_t>( valueByteSize ) );
+			if( ReadBytes( valueData.data(), valueByteSize ) )
+			{
+				GDSCore::deserialize( valueData.data(), pValue );
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	template <typename TPSource>
+	inline bool GDSCore::StreamReader<TPSource>::ReadSizeValue( size_t & pSizeValue )
+	{
+		if( const auto * sizeDataPtr = Acquire( kGdsSizeTypeByteSize ) )
+		{
+			GDS::deserialize( sizeDataPtr, GDS::asSizeType( pSizeValue ) );
+			return true;
+		}
+		return false;
+	}
+
+	template <typename TPSource>
+	inline bool GDSCore::StreamReader<TPSource>::Skip( gds_size_t pSize )
+	{
+		while( pSize > 0 )
+		{
+			const auto chunkSize = cppx::get_min_of<gds_size_t>( pSize, _buffer.size() );
+			if( !Acquire( chunkSize ) )
+			{
+				return false;
+			}
+			pSize -= chunkSize;
+		}
+		return true;
+	}
+
+	template <typename TPSource>
+	inline bool GDSCore::StreamReader<TPSource>::_FillBuffer( gds_size_t pRequiredSize )
+	{
+		const auto bufferedSize = _bufferDataEnd - _bufferOffset;
+		if( pRequiredSize <= bufferedSize )
+		{
+			return true;
+		}
+
+		if( ( pRequiredSize > _buffer.size() ) || ( ( pRequiredSize - bufferedSize ) > _sourceBytesLeft ) )
+		{
+			return false;
+		}
+
+		// Move the remaining data to the beginning to make space for new data.
+		if( ( _bufferOffset > 0 ) && ( bufferedSize > 0 ) )
+		{
+			std::memmove( _buffer.data(), _buffer.data() + _bufferOffset, bufferedSize );
+		}
+		_bufferOffset = 0;
+		_bufferDataEnd = bufferedSize;
+
+		// Read as much as possible, but not past the data limit.
+		const auto readSize = cppx::get_min_of<gds_size_t>( _buffer.size() - _bufferDataEnd, _sourceBytesLeft );
+		if( !_ReadFromSource( _buffer.data() + _bufferDataEnd, readSize ) )
+		{
+			return false;
+		}
+		_bufferDataEnd += cppx::numeric_cast<size_t>( readSize );
+
+		return true;
+	}
+
+	template <typename TPSource>
+	inline bool GDSCore::StreamReader<TPSource>::_ReadFromSource( void * pTarget, gds_size_t pSize )
+	{
+		if( _sourceFailed || ( pSize > _sourceBytesLeft ) )
+		{
+			return false;
+		}
+
+		const auto readSize = _source( pTarget, pSize );
+		_sourceFailed = ( readSize != pSize );
+		_sourceBytesLeft -= pSize;
+
+		return !_sourceFailed;
+	}
+
+	/***********************************************************************************************************/
+	/****************************************** Stream API - Values ********************************************/
+	/***********************************************************************************************************/
+
+	template <typename TPSink, typename TPValue>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const TPValue & pValue )
+	{
+		pWriter.WriteValue( pValue );
+	}
+
+	template <typename TPSink, typename TPValue>
+	inline void GDSCore::writeStreamRange( StreamWriter<TPSink> & pWriter, const TPValue * pValues, size_t pCount )
+	{
+		if constexpr( IsGdsBitwiseSerializable<TPValue>::sValue )
+		{
+			pWriter.WriteBytes( pValues, sizeof( TPValue ) * pCount );
+		}
+		else if constexpr( ( GdsStaticByteSize<TPValue>::sValue > 0 ) && ( GdsStaticByteSize<TPValue>::sValue <= kGdsStreamMinBufferSize ) )
+		{
+			// Serialize as many values as fit into the buffer at once.
+			constexpr auto valueByteSize = GdsStaticByteSize<TPValue>::sValue;
+			const auto batchSize = cppx::numeric_cast<size_t>( pWriter.GetBufferCapacity() / valueByteSize );
+
+			for( size_t valueIndex = 0; valueIndex < pCount; )
+			{
+				const auto currentBatchSize = cppx::get_min_of( batchSize, pCount - valueIndex );
+				serializeRange( pWriter.Reserve( currentBatchSize * valueByteSize ), pValues + valueIndex, currentBatchSize );
+				valueIndex += currentBatchSize;
+			}
+		}
+		else
+		{
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				writeStream( pWriter, pValues[valueIndex] );
+			}
+		}
+	}
+
+	template <typename TPSink, typename TPValue>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const cppx::array_view<TPValue> & pArrayView )
+	{
+		GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( pArrayView.size() ) );
+		writeStreamRange( pWriter, pArrayView.data(), pArrayView.size() );
+	}
+
+	template <typename TPSink, typename TCh, typename TTr, typename TPAllocator>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const std::basic_string<TCh, TTr, TPAllocator> & pString )
+	{
+		GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( pString.length() ) );
+		writeStreamRange( pWriter, pString.data(), pString.length() );
+	}
+
+	template <typename TPSink, typename T1, typename T2>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const std::pair<T1, T2> & pPair )
+	{
+		writeStream( pWriter, pPair.first );
+		writeStream( pWriter, pPair.second );
+	}
+
+	template <typename TPSink, typename TPValue, size_t tpSize>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const std::array<TPValue, tpSize> & pArray )
+	{
+		GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( tpSize ) );
+		writeStreamRange( pWriter, pArray.data(), tpSize );
+	}
+
+	template <typename TPSink, typename TPValue, typename TPComparator, typename TPAllocator>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const cppx::sorted_array<TPValue, TPComparator, TPAllocator> & pSortedArray )
+	{
+		GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( pSortedArray.size() ) );
+		writeStreamRange( pWriter, pSortedArray.data(), pSortedArray.size() );
+	}
+
+	template <typename TPSink, typename TPValue, typename TPAllocator>
+	inline void GDSCore::writeStream( StreamWriter<TPSink> & pWriter, const std::vector<TPValue, TPAllocator> & pVector )
+	{
+		if constexpr( std::is_same<TPValue, bool>::value )
+		{
+			// Not contiguous, elements (one byte each) are written one by one.
+			GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( pVector.size() ) );
+			for( const bool boolValue : pVector )
+			{
+				GDS::serialize( pWriter.Reserve( GdsStaticByteSize<bool>::sValue ), boolValue );
+			}
+		}
+		else
+		{
+			GDS::serialize( pWriter.Reserve( kGdsSizeTypeByteSize ), GDS::asSizeType( pVector.size() ) );
+			writeStreamRange( pWriter, pVector.data(), pVector.size() );
+		}
+	}
+
+	template <typename TPSource, typename TPValue>
+	inline bool GDSCore::readStream( StreamReader<TPSource> & pReader, TPValue & pValue )
+	{
+		return pReader.ReadValue( pValue );
+	}
+
+	template <typename TPSource, typename TPValue>
+	inline bool GDSCore::readStreamRange( StreamReader<TPSource> & pReader, TPValue * pValues, size_t pCount )
+	{
+		if constexpr( IsGdsBitwiseSerializable<TPValue>::sValue )
+		{
+			return pReader.ReadBytes( pValues, sizeof( TPValue ) * pCount );
+		}
+		else if constexpr( ( GdsStaticByteSize<TPValue>::sValue > 0 ) && ( GdsStaticByteSize<TPValue>::sValue <= kGdsStreamMinBufferSize ) )
+		{
+			constexpr auto valueByteSize = GdsStaticByteSize<TPValue>::sValue;
+			const auto batchSize = cppx::numeric_cast<size_t>( pReader.GetBufferCapacity() / valueByteSize );
+
+			for( size_t valueIndex = 0; valueIndex < pCount; )
+			{
+				const auto currentBatchSize = cppx::get_min_of( batchSize, pCount - valueIndex );
+				const auto * batchDataPtr = pReader.Acquire( currentBatchSize * valueByteSize );
+				if( !batchDataPtr )
+				{
+					return false;
+				}
+				deserializeRange( batchDataPtr, pValues + valueIndex, currentBatchSize );
+				valueIndex += currentBatchSize;
+			}
+			return true;
+		}
+		else
+		{
+			for( size_t valueIndex = 0; valueIndex < pCount; ++valueIndex )
+			{
+				if( !readStream( pReader, pValues[valueIndex] ) )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	template <typename TPSource, typename TCh, typename TTr, typename TPAllocator>
+	inline bool GDSCore::readStream( StreamReader<TPSource> & pReader, std::basic_string<TCh, TTr, TPAllocator> & pString )
+	{
+		size_t strLength = 0;
+		if( !pReader.ReadSizeValue( strLength ) )
+		{
+			return false;
+		}
+
+		pString.resize( strLength );
+		return readStreamRange( pReader, pString.data(), strLength );
+	}
+
+	template <typename TPSource, typename T1, typename T2>
+	inline bool GDSCore::readStream( StreamReader<TPSource> & pReader, std::pair<T1, T2> & pPair )
+	{
+		return readStream( pReader, pPair.first ) && readStream( pReader, pPair.second );
+	}
+
+	template <typename TPSource, typename TPValue, size_t tpSize>
+	inline bool GDSCore::readStream( StreamReader<TPSource> & pReader, std::array<TPValue, tpSize> & pArray )
+	{
+		size_t arraySize = 0;
+		if( !pReader.ReadSizeValue( arraySize ) || ( arraySize > tpSize ) )
+		{
+			return false;
+		}
+
+		return readStreamRange( pReader, pArray.data(), arraySize );
+	}
+
+	template <typename TPSource, typename TPValue, typename TPAllocator>
+	inline bool GDSCore::readStream( StreamReader<TPSource> & pReader, std::vector<TPValue, TPAllocator> & pVector )
+	{
+		size_t vectorSize = 0;
+		if( !pReader.ReadSizeValue( vectorSize ) )
+		{
+			return false;
+		}
+
+		// Same as deserialize(): the elements are appended to the existing ones.
+		const auto baseIndex = pVector.size();
+		pVector.resize( baseIndex + vectorSize );
+
+		return readStreamRange( pReader, pVector.data() + baseIndex, vectorSize );
+	}
+
+	/***********************************************************************************************************/
+	/****************************************** Stream API - External ******************************************/
+	/***********************************************************************************************************/
+
+	template <typename TPValue, typename TPSink>
+	inline gds_size_t GDSCore::serializeStream( const TPValue & pValue, TPSink pSink, size_t pBufferSize )
+	{
+		// The MetaData block goes first and it needs the size of the object. After the range fast path,
+		// evalByteSize() is cheap for most of the large objects (containers of values with a static size).
+		const auto valueByteSize = evalByteSize( pValue );
+
+		if( valueByteSize == 0 )
+		{
+			// Same as serializeExternal(): empty objects are not written at all.
+			return 0;
+		}
+
+		const auto metaDataSize = GDS::getInstanceMetaDataSize();
+
+		GDS::InstanceMetaData metaData;
+		metaData.controlKey = GDS::CX_GDS_VALUE_META_DATA_CONTROL_KEY;
+		metaData.objectDataSize = valueByteSize;
+		metaData.outputBlockSize = metaDataSize + valueByteSize;
+
+		StreamWriter<TPSink> streamWriter{ std::move( pSink ), pBufferSize };
+
+		GDS::serialize( streamWriter.Reserve( metaDataSize ), metaData );
+		writeStream( streamWriter, pValue );
+
+		Ic3DebugAssert( streamWriter.GetWrittenBytesNum() == metaData.outputBlockSize );
+
+		if( !streamWriter.Flush() )
+		{
+			return 0;
+		}
+
+		return metaData.outputBlockSize;
+	}
+
+	template <typename TPValue, typename TPSource>
+	inline gds_size_t GDSCore::deserializeStream( TPValue & pValue, TPSource pSource, size_t pBufferSize )
+	{
+		const auto metaDataSize = GDS::getInstanceMetaDataSize();
+
+		// Initially, the reader is allowed to fetch only the MetaData block. The object data limit is set
+		// after reading it, so the source is never read past the end of this object.
+		StreamReader<TPSource> streamReader{ std::move( pSource ), metaDataSize, pBufferSize };
+
+		const auto * metaDataPtr = streamReader.Acquire( metaDataSize );
+		if( !metaDataPtr )
+		{
+			return 0;
+		}
+
+		const auto metaData = GDS::readInstanceMetaData( metaDataPtr );
+		if( !metaData )
+		{
+			return 0;
+		}
+
+		streamReader.ExtendDataLimit( metaData.objectDataSize );
+
+		if constexpr( IsGdsStreamDecodable<TPValue>::sValue )
+		{
+			if( !readStream( streamReader, pValue ) )
+			{
+				return 0;
+			}
+
+			// The object data size does not match the MetaData. Skip whatever is left, so the source
+			// is positioned at the next object, but report an error - the data is most likely corrupted.
+			if( streamReader.GetReadBytesNum() != metaData.outputBlockSize )
+			{
+				streamReader.Skip( metaData.outputBlockSize - streamReader.GetReadBytesNum() );
+				return 0;
+			}
+		}
+		else
+		{
+			// The type does not provide its size before being deserialized, so the whole object data
+			// must be available in memory. This is the same thing deserializeExternal() does.
+			std::vector<byte> objectData( cppx::numeric_cast<size_t>( metaData.objectDataSize ) );
+			if( !streamReader.ReadBytes( objectData.data(), metaData.objectDataSize ) )
+			{
+				return 0;
+			}
+
+			deserialize( objectData.data(), pValue );
+		}
+
+		return metaData.outputBlockSize;
+	}
+
+	template <typename TPValue>
+	inline gds_size_t GDSCore::serializeExternal( const TPValue & pValue, const DataWriteCallback & pWriteCallback )
+	{
+		if( !pWriteCallback )
+		{
+			// This cannot be an empty function.
+			Ic3ThrowDesc( eExcCodeDebugPlaceholder, "Empty write callback." );
+		}
+
+		return serializeStream( pValue, [&pWriteCallback]( const void * pData, uint64 pDataSize ) -> uint64 {
+			return pWriteCallback( pData, pDataSize );
+		} );
+	}
+
+	template <typename TPValue>
+	inline gds_size_t GDSCore::deserializeExternal( TPValue & pValue, const DataReadCallback & pReadCallback )
+	{
+		if( !pReadCallback )
+		{
+			Ic3ThrowDesc( eExcCodeDebugPlaceholder, "Empty read callback." );
+		}
+
+		return deserializeStream( pValue, [&pReadCallback]( void * pTargetBuffer, uint64 pReadSize ) -> uint64 {
+			return pReadCallback( pTargetBuffer, pReadSize );
+		} );
+	}
+
+} // namespace Ic3
+
+#endif // __IC3_CORELIB_GDS_STREAM_H__
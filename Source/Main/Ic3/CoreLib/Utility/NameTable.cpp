@@ -0,0 +1,191 @@
+
+#include "NameTable.h"
+#include "../Exception.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace Ic3
+{
+
+	NameTable::NameTable()
+	: _nameCount( 0 )
+	, _textBlockPtr( nullptr )
+	, _textBlockSpaceLeft( 0 )
+	{
+		for( auto & entryPage : _entryPages )
+		{
+			entryPage.store( nullptr, std::memory_order_relaxed );
+		}
+
+		// Reserve ID 0 for the empty name, so that a default-initialized ID is always valid.
+		std::unique_lock<std::shared_mutex> writeLock{ _lock };
+		_InsertUnlocked( LookupKey{ std::string_view{ "" }, _ComputeHash( std::string_view{} ) } );
+	}
+
+	NameTable::~NameTable()
+	{
+		for( auto & entryPage : _entryPages )
+		{
+			delete[] entryPage.load( std::memory_order_relaxed );
+		}
+	}
+
+	NameID NameTable::Intern( std::string_view pText )
+	{
+		if( pText.empty() )
+		{
+			return kNameIDEmpty;
+		}
+
+		const LookupKey lookupKey{ pText, _ComputeHash( pText ) };
+
+		{
+			std::shared_lock<std::shared_mutex> readLock{ _lock };
+			const auto nameID = _FindUnlocked( lookupKey );
+			if( nameID != kNameIDInvalid )
+			{
+				return nameID;
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> writeLock{ _lock };
+
+		// Another thread might have inserted the same name between releasing the shared lock and acquiring this one.
+		const auto nameID = _FindUnlocked( lookupKey );
+		if( nameID != kNameIDInvalid )
+		{
+			return nameID;
+		}
+
+		return _InsertUnlocked( lookupKey );
+	}
+
+	NameID NameTable::Find( std::string_view pText ) const
+	{
+		if( pText.empty() )
+		{
+			return kNameIDEmpty;
+		}
+
+		const LookupKey lookupKey{ pText, _ComputeHash( pText ) };
+
+		std::shared_lock<std::shared_mutex> readLock{ _lock };
+		return _FindUnlocked( lookupKey );
+	}
+
+	std::string_view NameTable::GetText( NameID pNameID ) const noexcept
+	{
+		const auto * nameEntry = _GetEntry( pNameID );
+		return nameEntry ? std::string_view{ nameEntry->text, nameEntry->length } : std::string_view{};
+	}
+
+	const char * NameTable::GetCStr( NameID pNameID ) const noexcept
+	{
+		const auto * nameEntry = _GetEntry( pNameID );
+		return nameEntry ? nameEntry->text : "";
+	}
+
+	NameHash NameTable::GetHash( NameID pNameID ) const noexcept
+	{
+		const auto * nameEntry = _GetEntry( pNameID );
+		return nameEntry ? NameHash{ nameEntry->hash } : NameHash{};
+	}
+
+	uint32 NameTable::GetNameCount() const noexcept
+	{
+		return _nameCount.load( std::memory_order_acquire );
+	}
+
+	NameTable & NameTable::GetGlobal()
+	{
+		static NameTable sGlobalNameTable{};
+		return sGlobalNameTable;
+	}
+
+	uint32 NameTable::_ComputeHash( std::string_view pText ) noexcept
+	{
+		return cppx::hash_compute<cppx::hash_algo::fnv1a32>( cppx::hash_input{ pText } ).value;
+	}
+
+	const NameTable::NameEntry * NameTable::_GetEntry( NameID pNameID ) const noexcept
+	{
+		if( pNameID >= _nameCount.load( std::memory_order_acquire ) )
+		{
+			Ic3DebugAssert( pNameID == kNameIDInvalid );
+			return nullptr;
+		}
+
+		// Pages are published before the name count is incremented, so the page is always there at this point.
+		const auto * entryPage = _entryPages[pNameID >> kEntryPageSizeLog2].load( std::memory_order_acquire );
+		return &( entryPage[pNameID & ( kEntryPageSize - 1 )] );
+	}
+
+	NameID NameTable::_FindUnlocked( const LookupKey & pKey ) const
+	{
+		const auto * nameIDPtr = _lookupMap.find_value( pKey );
+		return nameIDPtr ? *nameIDPtr : kNameIDInvalid;
+	}
+
+	NameID NameTable::_InsertUnlocked( const LookupKey & pKey )
+	{
+		const auto nameID = _nameCount.load( std::memory_order_relaxed );
+		const auto pageIndex = nameID >> kEntryPageSizeLog2;
+
+		if( pageIndex >= kEntryPagesMaxNum )
+		{
+			Ic3ThrowDesc( eExcCodeDebugPlaceholder, "Name table capacity has been exceeded." );
+		}
+
+		auto * entryPage = _entryPages[pageIndex].load( std::memory_order_relaxed );
+		if( !entryPage )
+		{
+			entryPage = new NameEntry[kEntryPageSize];
+			_entryPages[pageIndex].store( entryPage, std::memory_order_release );
+		}
+
+		auto & nameEntry = entryPage[nameID & ( kEntryPageSize - 1 )];
+		nameEntry.text = _StoreText( pKey.text );
+		nameEntry.length = cppx::numeric_cast<uint32>( pKey.text.length() );
+		nameEntry.hash = pKey.hash;
+
+		// The key must reference the stored copy of the text, not the (temporary) input.
+		_lookupMap.emplace( LookupKey{ std::string_view{ nameEntry.text, nameEntry.length }, pKey.hash }, nameID );
+
+		_nameCount.store( nameID + 1, std::memory_order_release );
+
+		return nameID;
+	}
+
+	const char * NameTable::_StoreText( std::string_view pText )
+	{
+		const auto requiredSize = pText.length() + 1;
+
+		if( requiredSize > _textBlockSpaceLeft )
+		{
+			// Names longer than a regular block get a dedicated one. Remaining space in the current block is kept.
+			const auto blockSize = std::max( requiredSize, kTextBlockSize );
+			auto & textBlock = _textBlocks.emplace_back( new char[blockSize] );
+
+			if( blockSize > kTextBlockSize )
+			{
+				std::memcpy( textBlock.get(), pText.data(), pText.length() );
+				textBlock[pText.length()] = 0;
+				return textBlock.get();
+			}
+
+			_textBlockPtr = textBlock.get();
+			_textBlockSpaceLeft = blockSize;
+		}
+
+		auto * textPtr = _textBlockPtr;
+		std::memcpy( textPtr, pText.data(), pText.length() );
+		textPtr[pText.length()] = 0;
+
+		_textBlockPtr += requiredSize;
+		_textBlockSpaceLeft -= requiredSize;
+
+		return textPtr;
+	}
+
+} // namespace Ic3
@@ -0,0 +1,245 @@
+
+#ifndef __IC3_CORELIB_NAME_TABLE_H__
+#define __IC3_CORELIB_NAME_TABLE_H__
+
+#include "../Prerequisites.h"
+#include <cppx/flatHashMap.h>
+#include <cppx/hash.h>
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+
+namespace Ic3
+{
+
+	/// @brief Compact identifier of a string interned in a NameTable. Zero is reserved for an empty name.
+	using NameID = uint32;
+
+	/// @brief Hash type used for interned names. Computed once, when a name is interned.
+	using NameHash = cppx::hash_object<cppx::hash_algo::fnv1a32>;
+
+	///
+	inline constexpr NameID kNameIDEmpty = 0u;
+
+	///
+	inline constexpr NameID kNameIDInvalid = cppx::meta::limits<NameID>::max_value;
+
+	/// @brief A thread-safe table of interned strings. Every unique string is stored exactly once (in a stable
+	/// memory block, null-terminated) and gets a 32-bit ID, which can be compared and hashed in O(1). Text and
+	/// hash of an interned name can be retrieved without locking, as entries are never moved or removed.
+	/// Interning requires a lookup in a hash map guarded by a shared mutex: concurrent lookups of names which
+	/// are already present in the table only take a shared lock, exclusive lock is taken only for insertion.
+	class IC3_CORELIB_CLASS NameTable
+	{
+	public:
+		NameTable();
+		~NameTable();
+
+		NameTable( const NameTable & ) = delete;
+		NameTable & operator=( const NameTable & ) = delete;
+
+		/// @brief Returns the ID of the specified string, adding it to the table if it is not present yet.
+		/// Empty strings are always mapped to kNameIDEmpty.
+		NameID Intern( std::string_view pText );
+
+		/// @brief Returns the ID of the specified string or kNameIDInvalid if the string has not been interned.
+		CPPX_ATTR_NO_DISCARD NameID Find( std::string_view pText ) const;
+
+		/// @brief Returns the text of an interned name. The returned view is valid for the lifetime of the table.
+		CPPX_ATTR_NO_DISCARD std::string_view GetText( NameID pNameID ) const noexcept;
+
+		/// @brief Returns the text of an interned name as a null-terminated string.
+		CPPX_ATTR_NO_DISCARD const char * GetCStr( NameID pNameID ) const noexcept;
+
+		/// @brief Returns the precomputed FNV-1a hash of an interned name.
+		CPPX_ATTR_NO_DISCARD NameHash GetHash( NameID pNameID ) const noexcept;
+
+		/// @brief Returns the number of names stored in the table (including the reserved empty name).
+		CPPX_ATTR_NO_DISCARD uint32 GetNameCount() const noexcept;
+
+		/// @brief Returns the global table, used by InternedName.
+		CPPX_ATTR_NO_DISCARD static NameTable & GetGlobal();
+
+	private:
+		struct NameEntry
+		{
+			const char * text;
+			uint32 length;
+			uint32 hash;
+		};
+
+		struct LookupKey
+		{
+			std::string_view text;
+			uint32 hash;
+		};
+
+		struct LookupKeyHash
+		{
+			size_t operator()( const LookupKey & pKey ) const noexcept
+			{
+				// flat_hash_map mixes the hash itself, so the FNV value can be used directly.
+				return pKey.hash;
+			}
+		};
+
+		struct LookupKeyEqual
+		{
+			bool operator()( const LookupKey & pLhs, const LookupKey & pRhs ) const noexcept
+			{
+				return ( pLhs.hash == pRhs.hash ) && ( pLhs.text == pRhs.text );
+			}
+		};
+
+		using LookupMap = cppx::flat_hash_map<LookupKey, NameID, LookupKeyHash, LookupKeyEqual>;
+
+		static constexpr uint32 kEntryPageSizeLog2 = 12;
+		static constexpr uint32 kEntryPageSize = 1u << kEntryPageSizeLog2;
+		static constexpr uint32 kEntryPagesMaxNum = 1024;
+		static constexpr size_t kTextBlockSize = 64 * 1024;
+
+		static uint32 _ComputeHash( std::string_view pText ) noexcept;
+
+		const NameEntry * _GetEntry( NameID pNameID ) const noexcept;
+
+		NameID _FindUnlocked( const LookupKey & pKey ) const;
+
+		NameID _InsertUnlocked( const LookupKey & pKey );
+
+		const char * _StoreText( std::string_view pText );
+
+	private:
+		mutable std::shared_mutex _lock;
+		LookupMap _lookupMap;
+		std::atomic<uint32> _nameCount;
+		std::atomic<NameEntry *> _entryPages[kEntryPagesMaxNum];
+		std::vector<std::unique_ptr<char[]>> _textBlocks;
+		char * _textBlockPtr;
+		size_t _textBlockSpaceLeft;
+	};
+
+	/// @brief A lightweight handle to a string interned in the global NameTable. Only stores the 32-bit ID, so
+	/// copy, comparison and hashing are trivial. Implicitly constructible from all common string types, which
+	/// makes it a drop-in replacement for string keys in engine maps (names are interned on construction).
+	class InternedName
+	{
+	public:
+		constexpr InternedName() noexcept = default;
+
+		InternedName( const char * pText )
+		: _nameID( pText ? NameTable::GetGlobal().Intern( pText ) : kNameIDEmpty )
+		{}
+
+		InternedName( std::string_view pText )
+		: _nameID( NameTable::GetGlobal().Intern( pText ) )
+		{}
+
+		InternedName( const std::string & pText )
+		: _nameID( NameTable::GetGlobal().Intern( pText ) )
+		{}
+
+		InternedName( const cppx::string_view & pText )
+		: _nameID( NameTable::GetGlobal().Intern( std::string_view{ pText.data(), pText.length() } ) )
+		{}
+
+		InternedName( const cppx::immutable_string & pText )
+		: _nameID( NameTable::GetGlobal().Intern( std::string_view{ pText.data(), pText.length() } ) )
+		{}
+
+		/// @brief Creates a handle from an ID returned by the global NameTable.
+		CPPX_ATTR_NO_DISCARD static constexpr InternedName FromID( NameID pNameID ) noexcept
+		{
+			InternedName name;
+			name._nameID = pNameID;
+			return name;
+		}
+
+		CPPX_ATTR_NO_DISCARD explicit operator bool() const noexcept
+		{
+			return !empty();
+		}
+
+		CPPX_ATTR_NO_DISCARD NameID GetID() const noexcept
+		{
+			return _nameID;
+		}
+
+		CPPX_ATTR_NO_DISCARD NameHash GetHash() const noexcept
+		{
+			return NameTable::GetGlobal().GetHash( _nameID );
+		}
+
+		CPPX_ATTR_NO_DISCARD std::string_view str_view() const noexcept
+		{
+			return NameTable::GetGlobal().GetText( _nameID );
+		}
+
+		CPPX_ATTR_NO_DISCARD std::string str() const
+		{
+			return std::string{ str_view() };
+		}
+
+		CPPX_ATTR_NO_DISCARD const char * c_str() const noexcept
+		{
+			return NameTable::GetGlobal().GetCStr( _nameID );
+		}
+
+		CPPX_ATTR_NO_DISCARD const char * data() const noexcept
+		{
+			return c_str();
+		}
+
+		CPPX_ATTR_NO_DISCARD size_t length() const noexcept
+		{
+			return str_view().length();
+		}
+
+		CPPX_ATTR_NO_DISCARD bool empty() const noexcept
+		{
+			return _nameID == kNameIDEmpty;
+		}
+
+		void clear() noexcept
+		{
+			_nameID = kNameIDEmpty;
+		}
+
+	private:
+		NameID _nameID = kNameIDEmpty;
+	};
+
+	CPPX_ATTR_NO_DISCARD inline bool operator==( const InternedName & pLhs, const InternedName & pRhs ) noexcept
+	{
+		return pLhs.GetID() == pRhs.GetID();
+	}
+
+	CPPX_ATTR_NO_DISCARD inline bool operator!=( const InternedName & pLhs, const InternedName & pRhs ) noexcept
+	{
+		return pLhs.GetID() != pRhs.GetID();
+	}
+
+	/// @brief Orders names by their IDs (i.e. by the order of interning), not lexicographically.
+	CPPX_ATTR_NO_DISCARD inline bool operator<( const InternedName & pLhs, const InternedName & pRhs ) noexcept
+	{
+		return pLhs.GetID() < pRhs.GetID();
+	}
+
+} // namespace Ic3
+
+namespace std
+{
+
+	template <>
+	struct hash<Ic3::InternedName>
+	{
+		size_t operator()( const Ic3::InternedName & pName ) const noexcept
+		{
+			// IDs are unique and dense, the hash tables mix the bits on their own.
+			return static_cast<size_t>( pName.GetID() );
+		}
+	};
+
+}
+
+#endif // __IC3_CORELIB_NAME_TABLE_H__
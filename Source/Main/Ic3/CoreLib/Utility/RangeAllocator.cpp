@@ -0,0 +1,386 @@
+
+#include "RangeAllocator.h"
+#include <cppx/bitUtils.h>
+
+namespace Ic3
+{
+
+	RangeAllocator::RangeAllocator( uint32 pCapacity )
+	{
+		Reset( pCapacity );
+	}
+
+	RangeAllocator::~RangeAllocator() = default;
+
+	void RangeAllocator::Reset( uint32 pCapacity )
+	{
+		_nodeArray.clear();
+		_unusedNodeListHead = kNodeIndexInvalid;
+		_lastPhysicalNodeIndex = kNodeIndexInvalid;
+
+		for( auto & freeListHeads : _freeListHeadArray )
+		{
+			std::fill( std::begin( freeListHeads ), std::end( freeListHeads ), kNodeIndexInvalid );
+		}
+
+		std::fill( std::begin( _secondLevelBitmapArray ), std::end( _secondLevelBitmapArray ), 0u );
+		_firstLevelBitmap = 0;
+		_capacity = 0;
+		_allocatedSize = 0;
+		_allocationsNum = 0;
+		_freeRangesNum = 0;
+
+		Grow( pCapacity );
+	}
+
+	void RangeAllocator::Grow( uint32 pNewCapacity )
+	{
+		Ic3DebugAssert( pNewCapacity >= _capacity );
+
+		const auto capacityDelta = pNewCapacity - _capacity;
+		if( capacityDelta == 0 )
+		{
+			return;
+		}
+
+		if( ( _lastPhysicalNodeIndex != kNodeIndexInvalid ) && _nodeArray[_lastPhysicalNodeIndex].isFree )
+		{
+			RemoveFreeNode( _lastPhysicalNodeIndex );
+			_nodeArray[_lastPhysicalNodeIndex].size += capacityDelta;
+			InsertFreeNode( _lastPhysicalNodeIndex );
+		}
+		else
+		{
+			const auto nodeIndex = AcquireNode();
+			auto & node = _nodeArray[nodeIndex];
+			node.offset = _capacity;
+			node.size = capacityDelta;
+			node.prevPhysicalIndex = _lastPhysicalNodeIndex;
+			node.isFree = true;
+
+			if( _lastPhysicalNodeIndex != kNodeIndexInvalid )
+			{
+				_nodeArray[_lastPhysicalNodeIndex].nextPhysicalIndex = nodeIndex;
+			}
+
+			_lastPhysicalNodeIndex = nodeIndex;
+			InsertFreeNode( nodeIndex );
+		}
+
+		_capacity = pNewCapacity;
+	}
+
+	RangeAllocation RangeAllocator::Allocate( uint32 pSize )
+	{
+		if( pSize == 0 )
+		{
+			return {};
+		}
+
+		auto nodeIndex = kNodeIndexInvalid;
+
+		ListIndex searchListIndex;
+		if( GetListIndexForSearch( pSize, searchListIndex ) )
+		{
+			nodeIndex = FindFreeNode( searchListIndex );
+		}
+
+		if( nodeIndex == kNodeIndexInvalid )
+		{
+			// The search rounds the size up to the next size class, so a range from the class of the requested
+			// size itself may still fit. This matters when the space is nearly exhausted, so check that list too.
+			const auto insertListIndex = GetListIndexForInsert( pSize );
+			for( auto freeNodeIndex = _freeListHeadArray[insertListIndex.firstLevel][insertListIndex.secondLevel];
+			     freeNodeIndex != kNodeIndexInvalid;
+			     freeNodeIndex = _nodeArray[freeNodeIndex].nextFreeIndex )
+			{
+				if( _nodeArray[freeNodeIndex].size >= pSize )
+				{
+					nodeIndex = freeNodeIndex;
+					break;
+				}
+			}
+		}
+
+		if( nodeIndex == kNodeIndexInvalid )
+		{
+			return {};
+		}
+
+		RemoveFreeNode( nodeIndex );
+
+		if( _nodeArray[nodeIndex].size > pSize )
+		{
+			// AcquireNode() may reallocate the array, so no references are taken before it.
+			const auto remainderNodeIndex = AcquireNode();
+
+			auto & node = _nodeArray[nodeIndex];
+			auto & remainderNode = _nodeArray[remainderNodeIndex];
+			remainderNode.offset = node.offset + pSize;
+			remainderNode.size = node.size - pSize;
+			remainderNode.prevPhysicalIndex = nodeIndex;
+			remainderNode.nextPhysicalIndex = node.nextPhysicalIndex;
+			remainderNode.isFree = true;
+
+			if( node.nextPhysicalIndex != kNodeIndexInvalid )
+			{
+				_nodeArray[node.nextPhysicalIndex].prevPhysicalIndex = remainderNodeIndex;
+			}
+			else
+			{
+				_lastPhysicalNodeIndex = remainderNodeIndex;
+			}
+
+			node.nextPhysicalIndex = remainderNodeIndex;
+			node.size = pSize;
+
+			InsertFreeNode( remainderNodeIndex );
+		}
+
+		auto & node = _nodeArray[nodeIndex];
+		node.isFree = false;
+
+		_allocatedSize += node.size;
+		_allocationsNum += 1;
+
+		return RangeAllocation{ node.offset, node.size, nodeIndex };
+	}
+
+	void RangeAllocator::Free( range_allocation_id_t pAllocationID )
+	{
+		Ic3DebugAssert( ( pAllocationID < _nodeArray.size() ) && _nodeArray[pAllocationID].isUsed && !_nodeArray[pAllocationID].isFree );
+
+		auto nodeIndex = pAllocationID;
+
+		_allocatedSize -= _nodeArray[nodeIndex].size;
+		_allocationsNum -= 1;
+		_nodeArray[nodeIndex].isFree = true;
+
+		const auto prevNodeIndex = _nodeArray[nodeIndex].prevPhysicalIndex;
+		if( ( prevNodeIndex != kNodeIndexInvalid ) && _nodeArray[prevNodeIndex].isFree )
+		{
+			RemoveFreeNode( prevNodeIndex );
+
+			auto & prevNode = _nodeArray[prevNodeIndex];
+			const auto & node = _nodeArray[nodeIndex];
+			prevNode.size += node.size;
+			prevNode.nextPhysicalIndex = node.nextPhysicalIndex;
+
+			if( node.nextPhysicalIndex != kNodeIndexInvalid )
+			{
+				_nodeArray[node.nextPhysicalIndex].prevPhysicalIndex = prevNodeIndex;
+			}
+			else
+			{
+				_lastPhysicalNodeIndex = prevNodeIndex;
+			}
+
+			ReleaseNode( nodeIndex );
+			nodeIndex = prevNodeIndex;
+		}
+
+		const auto nextNodeIndex = _nodeArray[nodeIndex].nextPhysicalIndex;
+		if( ( nextNodeIndex != kNodeIndexInvalid ) && _nodeArray[nextNodeIndex].isFree )
+		{
+			RemoveFreeNode( nextNodeIndex );
+
+			auto & node = _nodeArray[nodeIndex];
+			const auto & nextNode = _nodeArray[nextNodeIndex];
+			node.size += nextNode.size;
+			node.nextPhysicalIndex = nextNode.nextPhysicalIndex;
+
+			if( nextNode.nextPhysicalIndex != kNodeIndexInvalid )
+			{
+				_nodeArray[nextNode.nextPhysicalIndex].prevPhysicalIndex = nodeIndex;
+			}
+			else
+			{
+				_lastPhysicalNodeIndex = nodeIndex;
+			}
+
+			ReleaseNode( nextNodeIndex );
+		}
+
+		InsertFreeNode( nodeIndex );
+	}
+
+	RangeAllocation RangeAllocator::GetAllocation( range_allocation_id_t pAllocationID ) const noexcept
+	{
+		if( ( pAllocationID >= _nodeArray.size() ) || !_nodeArray[pAllocationID].isUsed || _nodeArray[pAllocationID].isFree )
+		{
+			return {};
+		}
+
+		const auto & node = _nodeArray[pAllocationID];
+
+		return RangeAllocation{ node.offset, node.size, pAllocationID };
+	}
+
+	uint32 RangeAllocator::GetLargestFreeRangeSize() const noexcept
+	{
+		if( _firstLevelBitmap == 0 )
+		{
+			return 0;
+		}
+
+		// The largest range is in the highest non-empty list, but not necessarily at its head.
+		const auto firstLevel = cppx::bit_scan_msb( _firstLevelBitmap );
+		const auto secondLevel = cppx::bit_scan_msb( _secondLevelBitmapArray[firstLevel] );
+
+		uint32 largestSize = 0;
+		for( auto nodeIndex = _freeListHeadArray[firstLevel][secondLevel];
+		     nodeIndex != kNodeIndexInvalid;
+		     nodeIndex = _nodeArray[nodeIndex].nextFreeIndex )
+		{
+			largestSize = std::max( largestSize, _nodeArray[nodeIndex].size );
+		}
+
+		return largestSize;
+	}
+
+	RangeAllocator::ListIndex RangeAllocator::GetListIndexForInsert( uint32 pSize ) noexcept
+	{
+		Ic3DebugAssert( pSize > 0 );
+
+		if( pSize < kSecondLevelListsNum )
+		{
+			// Small sizes are all stored in the first class, one list per size.
+			return ListIndex{ 0, pSize };
+		}
+
+		const auto sizeMSB = cppx::bit_scan_msb( pSize );
+		const auto secondLevel = ( pSize >> ( sizeMSB - kSecondLevelBitsNum ) ) ^ kSecondLevelListsNum;
+
+		return ListIndex{ sizeMSB - kSecondLevelBitsNum + 1, secondLevel };
+	}
+
+	bool RangeAllocator::GetListIndexForSearch( uint32 pSize, ListIndex & pListIndex ) noexcept
+	{
+		auto searchSize = static_cast<uint64>( pSize );
+		if( pSize >= kSecondLevelListsNum )
+		{
+			// Round up to the next size class, so every range in the returned list is large enough.
+			searchSize += ( 1ull << ( cppx::bit_scan_msb( pSize ) - kSecondLevelBitsNum ) ) - 1;
+			if( searchSize > cppx::meta::limits<uint32>::max_value )
+			{
+				return false;
+			}
+		}
+
+		pListIndex = GetListIndexForInsert( static_cast<uint32>( searchSize ) );
+
+		return true;
+	}
+
+	uint32 RangeAllocator::FindFreeNode( ListIndex pListIndex ) const noexcept
+	{
+		auto firstLevel = pListIndex.firstLevel;
+		auto secondLevelBitmap = _secondLevelBitmapArray[firstLevel] & ( ~0u << pListIndex.secondLevel );
+
+		if( secondLevelBitmap == 0 )
+		{
+			const auto firstLevelBitmap = ( firstLevel + 1 < 32 ) ? ( _firstLevelBitmap & ( ~0u << ( firstLevel + 1 ) ) ) : 0u;
+			if( firstLevelBitmap == 0 )
+			{
+				return kNodeIndexInvalid;
+			}
+
+			firstLevel = cppx::bit_scan_lsb( firstLevelBitmap );
+			secondLevelBitmap = _secondLevelBitmapArray[firstLevel];
+		}
+
+		return _freeListHeadArray[firstLevel][cppx::bit_scan_lsb( secondLevelBitmap )];
+	}
+
+	void RangeAllocator::InsertFreeNode( uint32 pNodeIndex ) noexcept
+	{
+		auto & node = _nodeArray[pNodeIndex];
+		const auto listIndex = GetListIndexForInsert( node.size );
+		auto & listHead = _freeListHeadArray[listIndex.firstLevel][listIndex.secondLevel];
+
+		node.prevFreeIndex = kNodeIndexInvalid;
+		node.nextFreeIndex = listHead;
+
+		if( listHead != kNodeIndexInvalid )
+		{
+			_nodeArray[listHead].prevFreeIndex = pNodeIndex;
+		}
+
+		listHead = pNodeIndex;
+
+		_secondLevelBitmapArray[listIndex.firstLevel] |= ( 1u << listIndex.secondLevel );
+		_firstLevelBitmap |= ( 1u << listIndex.firstLevel );
+		_freeRangesNum += 1;
+	}
+
+	void RangeAllocator::RemoveFreeNode( uint32 pNodeIndex ) noexcept
+	{
+		const auto & node = _nodeArray[pNodeIndex];
+		const auto listIndex = GetListIndexForInsert( node.size );
+		auto & listHead = _freeListHeadArray[listIndex.firstLevel][listIndex.secondLevel];
+
+		if( node.prevFreeIndex != kNodeIndexInvalid )
+		{
+			_nodeArray[node.prevFreeIndex].nextFreeIndex = node.nextFreeIndex;
+		}
+		else
+		{
+			listHead = node.nextFreeIndex;
+		}
+
+		if( node.nextFreeIndex != kNodeIndexInvalid )
+		{
+			_nodeArray[node.nextFreeIndex].prevFreeIndex = node.prevFreeIndex;
+		}
+
+		if( listHead == kNodeIndexInvalid )
+		{
+			_secondLevelBitmapArray[listIndex.firstLevel] &= ~( 1u << listIndex.secondLevel );
+			if( _secondLevelBitmapArray[listIndex.firstLevel] == 0 )
+			{
+				_firstLevelBitmap &= ~( 1u << listIndex.firstLevel );
+			}
+		}
+
+		_freeRangesNum -= 1;
+	}
+
+	uint32 RangeAllocator::AcquireNode()
+	{
+		uint32 nodeIndex = 0;
+
+		if( _unusedNodeListHead != kNodeIndexInvalid )
+		{
+			nodeIndex = _unusedNodeListHead;
+			_unusedNodeListHead = _nodeArray[nodeIndex].nextFreeIndex;
+		}
+		else
+		{
+			nodeIndex = static_cast<uint32>( _nodeArray.size() );
+			_nodeArray.emplace_back();
+		}
+
+		auto & node = _nodeArray[nodeIndex];
+		node.offset = 0;
+		node.size = 0;
+		node.prevPhysicalIndex = kNodeIndexInvalid;
+		node.nextPhysicalIndex = kNodeIndexInvalid;
+		node.prevFreeIndex = kNodeIndexInvalid;
+		node.nextFreeIndex = kNodeIndexInvalid;
+		node.isFree = false;
+		node.isUsed = true;
+
+		return nodeIndex;
+	}
+
+	void RangeAllocator::ReleaseNode( uint32 pNodeIndex ) noexcept
+	{
+		auto & node = _nodeArray[pNodeIndex];
+		node.isUsed = false;
+		node.isFree = false;
+		node.nextFreeIndex = _unusedNodeListHead;
+
+		_unusedNodeListHead = pNodeIndex;
+	}
+
+}
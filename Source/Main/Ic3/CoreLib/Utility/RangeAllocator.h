@@ -0,0 +1,131 @@
+
+#ifndef __IC3_CORELIB_RANGE_ALLOCATOR_H__
+#define __IC3_CORELIB_RANGE_ALLOCATOR_H__
+
+#include "../Prerequisites.h"
+
+namespace Ic3
+{
+
+	using range_allocation_id_t = uint32;
+
+	inline constexpr range_allocation_id_t kRangeAllocationIDInvalid = cppx::meta::limits<range_allocation_id_t>::max_value;
+
+	struct RangeAllocation
+	{
+		uint32 offset = 0;
+		uint32 size = 0;
+		range_allocation_id_t allocationID = kRangeAllocationIDInvalid;
+
+		explicit operator bool() const noexcept
+		{
+			return allocationID != kRangeAllocationIDInvalid;
+		}
+	};
+
+	/// @brief Allocator of sub-ranges of a linear address space (e.g. elements of a large GPU buffer), based on TLSF.
+	/// Free ranges are kept in segregated lists indexed by size class (32 power-of-2 classes, each split into 16
+	/// linear sub-classes) with bitmaps of non-empty lists, so both allocation and release are O(1). Freed ranges
+	/// are merged with their free neighbours immediately. The allocator stores no data - offsets and sizes are
+	/// expressed in arbitrary units chosen by the user (bytes, vertices, indices) and no alignment is applied.
+	class IC3_CORELIB_CLASS RangeAllocator
+	{
+	public:
+		explicit RangeAllocator( uint32 pCapacity = 0 );
+		~RangeAllocator();
+
+		/// @brief Frees all ranges and sets a new capacity.
+		void Reset( uint32 pCapacity );
+
+		/// @brief Extends the address space. Existing ranges are not affected.
+		void Grow( uint32 pNewCapacity );
+
+		/// @brief Allocates a range of the specified size. Returns an empty allocation if there is no free range large enough.
+		CPPX_ATTR_NO_DISCARD RangeAllocation Allocate( uint32 pSize );
+
+		void Free( range_allocation_id_t pAllocationID );
+
+		CPPX_ATTR_NO_DISCARD RangeAllocation GetAllocation( range_allocation_id_t pAllocationID ) const noexcept;
+
+		/// @brief Returns the size of the largest free range, i.e. the largest allocation which can currently succeed.
+		CPPX_ATTR_NO_DISCARD uint32 GetLargestFreeRangeSize() const noexcept;
+
+		CPPX_ATTR_NO_DISCARD uint32 GetCapacity() const noexcept
+		{
+			return _capacity;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetAllocatedSize() const noexcept
+		{
+			return _allocatedSize;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetFreeSize() const noexcept
+		{
+			return _capacity - _allocatedSize;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetAllocationsNum() const noexcept
+		{
+			return _allocationsNum;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetFreeRangesNum() const noexcept
+		{
+			return _freeRangesNum;
+		}
+
+	private:
+		static constexpr uint32 kSecondLevelBitsNum = 4;
+		static constexpr uint32 kSecondLevelListsNum = 1u << kSecondLevelBitsNum;
+		static constexpr uint32 kFirstLevelListsNum = 32 - kSecondLevelBitsNum + 1;
+		static constexpr uint32 kNodeIndexInvalid = cppx::meta::limits<uint32>::max_value;
+
+		struct Node
+		{
+			uint32 offset;
+			uint32 size;
+			uint32 prevPhysicalIndex;
+			uint32 nextPhysicalIndex;
+			uint32 prevFreeIndex;
+			uint32 nextFreeIndex;
+			bool isFree;
+			bool isUsed;
+		};
+
+		struct ListIndex
+		{
+			uint32 firstLevel;
+			uint32 secondLevel;
+		};
+
+		static ListIndex GetListIndexForInsert( uint32 pSize ) noexcept;
+
+		static bool GetListIndexForSearch( uint32 pSize, ListIndex & pListIndex ) noexcept;
+
+		uint32 FindFreeNode( ListIndex pListIndex ) const noexcept;
+
+		void InsertFreeNode( uint32 pNodeIndex ) noexcept;
+
+		void RemoveFreeNode( uint32 pNodeIndex ) noexcept;
+
+		uint32 AcquireNode();
+
+		void ReleaseNode( uint32 pNodeIndex ) noexcept;
+
+	private:
+		std::vector<Node> _nodeArray;
+		uint32 _unusedNodeListHead = kNodeIndexInvalid;
+		uint32 _lastPhysicalNodeIndex = kNodeIndexInvalid;
+		uint32 _freeListHeadArray[kFirstLevelListsNum][kSecondLevelListsNum];
+		uint32 _secondLevelBitmapArray[kFirstLevelListsNum];
+		uint32 _firstLevelBitmap = 0;
+		uint32 _capacity = 0;
+		uint32 _allocatedSize = 0;
+		uint32 _allocationsNum = 0;
+		uint32 _freeRangesNum = 0;
+	};
+
+}
+
+#endif // __IC3_CORELIB_RANGE_ALLOCATOR_H__
@@ -1,76 +1,625 @@
-
 #include "RectAllocator.h"
 #include <cppx/utilities.h>
+#include <algorithm>
 
 namespace Ic3
 {
 
+	static constexpr size_t kRectPackerIndexInvalid = cppx::meta::limits<size_t>::max_value;
+
+	RectPacker::~RectPacker() = default;
+
+
+	MaxRectsRectPacker::MaxRectsRectPacker() = default;
+
+	MaxRectsRectPacker::~MaxRectsRectPacker() = default;
+
+	void MaxRectsRectPacker::Reset( const cxm::vec2u32 & pBinSize )
+	{
+		_freeRectArray.clear();
+		if( ( pBinSize.x > 0 ) && ( pBinSize.y > 0 ) )
+		{
+			_freeRectArray.push_back( PackedRect{ 0, 0, pBinSize.x, pBinSize.y } );
+		}
+	}
+
+	bool MaxRectsRectPacker::Insert( const cxm::vec2u32 & pSize, cxm::vec2u32 & pOutPosition )
+	{
+		const auto freeRectIndex = FindBestFreeRect( pSize );
+		if( freeRectIndex == kRectPackerIndexInvalid )
+		{
+			return false;
+		}
+
+		const PackedRect usedRect{ _freeRectArray[freeRectIndex].x, _freeRectArray[freeRectIndex].y, pSize.x, pSize.y };
+		SplitFreeRects( usedRect );
+
+		pOutPosition.x = usedRect.x;
+		pOutPosition.y = usedRect.y;
+
+		return true;
+	}
+
+	void MaxRectsRectPacker::Remove( const cxm::vec2u32 & pPosition, const cxm::vec2u32 & pSize )
+	{
+		if( ( pSize.x > 0 ) && ( pSize.y > 0 ) )
+		{
+			_freeRectArray.push_back( PackedRect{ pPosition.x, pPosition.y, pSize.x, pSize.y } );
+			MergeFreeRects();
+		}
+	}
+
+	bool MaxRectsRectPacker::CheckFreeSpace( const cxm::vec2u32 & pSize ) const
+	{
+		return std::any_of(
+				_freeRectArray.begin(),
+				_freeRectArray.end(),
+				[&pSize]( const PackedRect & pFreeRect ) -> bool {
+					return ( pFreeRect.width >= pSize.x ) && ( pFreeRect.height >= pSize.y );
+				} );
+	}
+
+	uint32 MaxRectsRectPacker::GetFreeRectsNum() const noexcept
+	{
+		return static_cast<uint32>( _freeRectArray.size() );
+	}
+
+	std::unique_ptr<RectPacker> MaxRectsRectPacker::CreateEmptyInstance() const
+	{
+		return std::make_unique<MaxRectsRectPacker>();
+	}
+
+	void MaxRectsRectPacker::Clear()
+	{
+		_freeRectArray.clear();
+	}
+
+	size_t MaxRectsRectPacker::FindBestFreeRect( const cxm::vec2u32 & pSize ) const noexcept
+	{
+		size_t bestRectIndex = kRectPackerIndexInvalid;
+		uint32 bestShortSideFit = cppx::meta::limits<uint32>::max_value;
+		uint32 bestLongSideFit = cppx::meta::limits<uint32>::max_value;
+
+		for( size_t freeRectIndex = 0; freeRectIndex < _freeRectArray.size(); ++freeRectIndex )
+		{
+			const auto & freeRect = _freeRectArray[freeRectIndex];
+			if( ( freeRect.width >= pSize.x ) && ( freeRect.height >= pSize.y ) )
+			{
+				const auto leftoverHorizontal = freeRect.width - pSize.x;
+				const auto leftoverVertical = freeRect.height - pSize.y;
+				const auto shortSideFit = cppx::get_min_of( leftoverHorizontal, leftoverVertical );
+				const auto longSideFit = cppx::get_max_of( leftoverHorizontal, leftoverVertical );
+
+				if( ( shortSideFit < bestShortSideFit ) || ( ( shortSideFit == bestShortSideFit ) && ( longSideFit < bestLongSideFit ) ) )
+				{
+					bestRectIndex = freeRectIndex;
+					bestShortSideFit = shortSideFit;
+					bestLongSideFit = longSideFit;
+				}
+			}
+		}
+
+		return bestRectIndex;
+	}
+
+	void MaxRectsRectPacker::SplitFreeRects( const PackedRect & pUsedRect )
+	{
+		_splitRectArray.clear();
+
+		size_t keptRectsNum = 0;
+		for( size_t freeRectIndex = 0; freeRectIndex < _freeRectArray.size(); ++freeRectIndex )
+		{
+			const auto freeRect = _freeRectArray[freeRectIndex];
+
+			const bool intersects =
+					( pUsedRect.x < freeRect.x + freeRect.width ) && ( freeRect.x < pUsedRect.x + pUsedRect.width ) &&
+					( pUsedRect.y < freeRect.y + freeRect.height ) && ( freeRect.y < pUsedRect.y + pUsedRect.height );
+
+			if( !intersects )
+			{
+				_freeRectArray[keptRectsNum++] = freeRect;
+				continue;
+			}
+
+			// Each side of the used rect inside the free rect produces a new (maximal) free rect.
+			if( pUsedRect.x > freeRect.x )
+			{
+				_splitRectArray.push_back( PackedRect{ freeRect.x, freeRect.y, pUsedRect.x - freeRect.x, freeRect.height } );
+			}
+			if( pUsedRect.x + pUsedRect.width < freeRect.x + freeRect.width )
+			{
+				const auto splitX = pUsedRect.x + pUsedRect.width;
+				_splitRectArray.push_back( PackedRect{ splitX, freeRect.y, freeRect.x + freeRect.width - splitX, freeRect.height } );
+			}
+			if( pUsedRect.y > freeRect.y )
+			{
+				_splitRectArray.push_back( PackedRect{ freeRect.x, freeRect.y, freeRect.width, pUsedRect.y - freeRect.y } );
+			}
+			if( pUsedRect.y + pUsedRect.height < freeRect.y + freeRect.height )
+			{
+				const auto splitY = pUsedRect.y + pUsedRect.height;
+				_splitRectArray.push_back( PackedRect{ freeRect.x, splitY, freeRect.width, freeRect.y + freeRect.height - splitY } );
+			}
+		}
+
+		_freeRectArray.resize( keptRectsNum );
+		_freeRectArray.insert( _freeRectArray.end(), _splitRectArray.begin(), _splitRectArray.end() );
+
+		PruneFreeRects( keptRectsNum );
+	}
+
+	void MaxRectsRectPacker::MergeFreeRects()
+	{
+		// The last rect has just been added. Merge it with rects adjacent along a whole edge, as long as this
+		// produces a larger rect (each merge removes one rect, so this terminates).
+		for( bool mergeDone = true; mergeDone; )
+		{
+			mergeDone = false;
+
+			auto & addedRect = _freeRectArray.back();
+			for( size_t freeRectIndex = 0; freeRectIndex + 1 < _freeRectArray.size(); ++freeRectIndex )
+			{
+				const auto & freeRect = _freeRectArray[freeRectIndex];
+
+				const bool sameColumn = ( freeRect.x == addedRect.x ) && ( freeRect.width == addedRect.width );
+				const bool sameRow = ( freeRect.y == addedRect.y ) && ( freeRect.height == addedRect.height );
+
+				if( sameColumn && ( ( freeRect.y + freeRect.height == addedRect.y ) || ( addedRect.y + addedRect.height == freeRect.y ) ) )
+				{
+					addedRect.y = cppx::get_min_of( addedRect.y, freeRect.y );
+					addedRect.height += freeRect.height;
+				}
+				else if( sameRow && ( ( freeRect.x + freeRect.width == addedRect.x ) || ( addedRect.x + addedRect.width == freeRect.x ) ) )
+				{
+					addedRect.x = cppx::get_min_of( addedRect.x, freeRect.x );
+					addedRect.width += freeRect.width;
+				}
+				else
+				{
+					continue;
+				}
+
+				_freeRectArray.erase( _freeRectArray.begin() + freeRectIndex );
+				mergeDone = true;
+				break;
+			}
+		}
+
+		PruneFreeRects( _freeRectArray.size() - 1 );
+	}
+
+	void MaxRectsRectPacker::PruneFreeRects( size_t pFirstNewIndex )
+	{
+		const auto isContained = []( const PackedRect & pInner, const PackedRect & pOuter ) -> bool {
+			return ( pInner.x >= pOuter.x ) && ( pInner.y >= pOuter.y ) &&
+			       ( pInner.x + pInner.width <= pOuter.x + pOuter.width ) &&
+			       ( pInner.y + pInner.height <= pOuter.y + pOuter.height );
+		};
+
+		// Rects existing before the update are not contained in each other, so only pairs including
+		// at least one new rect need to be checked. Removed rects are marked with zero width.
+		for( size_t newRectIndex = pFirstNewIndex; newRectIndex < _freeRectArray.size(); ++newRectIndex )
+		{
+			auto & newRect = _freeRectArray[newRectIndex];
+			if( newRect.width == 0 )
+			{
+				continue;
+			}
+
+			for( size_t otherRectIndex = 0; otherRectIndex < _freeRectArray.size(); ++otherRectIndex )
+			{
+				auto & otherRect = _freeRectArray[otherRectIndex];
+				if( ( otherRectIndex == newRectIndex ) || ( otherRect.width == 0 ) )
+				{
+					continue;
+				}
+
+				if( isContained( newRect, otherRect ) )
+				{
+					newRect.width = 0;
+					break;
+				}
+
+				if( isContained( otherRect, newRect ) )
+				{
+					otherRect.width = 0;
+				}
+			}
+		}
+
+		_freeRectArray.erase(
+				std::remove_if(
+						_freeRectArray.begin(),
+						_freeRectArray.end(),
+						[]( const PackedRect & pFreeRect ) -> bool {
+							return pFreeRect.width == 0;
+						} ),
+				_freeRectArray.end() );
+	}
+
+
+	SkylineRectPacker::SkylineRectPacker() = default;
+
+	SkylineRectPacker::~SkylineRectPacker() = default;
+
+	void SkylineRectPacker::Reset( const cxm::vec2u32 & pBinSize )
+	{
+		_binSize = pBinSize;
+		_skyline.clear();
+		_skyline.push_back( SkylineNode{ 0, 0, pBinSize.x } );
+		_wasteMap.Clear();
+	}
+
+	bool SkylineRectPacker::Insert( const cxm::vec2u32 & pSize, cxm::vec2u32 & pOutPosition )
+	{
+		// Freed rects and gaps left below the skyline are reused first, they are unreachable for the skyline itself.
+		if( _wasteMap.Insert( pSize, pOutPosition ) )
+		{
+			return true;
+		}
+
+		uint32 rectY = 0;
+		const auto nodeIndex = FindBestNode( pSize, rectY );
+		if( nodeIndex == kRectPackerIndexInvalid )
+		{
+			return false;
+		}
+
+		const auto rectX = _skyline[nodeIndex].x;
+
+		AddWasteBelowRect( nodeIndex, rectX, rectY, pSize.x );
+		AddSkylineLevel( nodeIndex, rectX, rectY, pSize );
+
+		pOutPosition.x = rectX;
+		pOutPosition.y = rectY;
+
+		return true;
+	}
+
+	void SkylineRectPacker::Remove( const cxm::vec2u32 & pPosition, const cxm::vec2u32 & pSize )
+	{
+		_wasteMap.Remove( pPosition, pSize );
+	}
+
+	bool SkylineRectPacker::CheckFreeSpace( const cxm::vec2u32 & pSize ) const
+	{
+		uint32 rectY = 0;
+		return _wasteMap.CheckFreeSpace( pSize ) || ( FindBestNode( pSize, rectY ) != kRectPackerIndexInvalid );
+	}
+
+	uint32 SkylineRectPacker::GetFreeRectsNum() const noexcept
+	{
+		return _wasteMap.GetFreeRectsNum();
+	}
+
+	std::unique_ptr<RectPacker> SkylineRectPacker::CreateEmptyInstance() const
+	{
+		return std::make_unique<SkylineRectPacker>();
+	}
+
+	size_t SkylineRectPacker::FindBestNode( const cxm::vec2u32 & pSize, uint32 & pOutY ) const noexcept
+	{
+		size_t bestNodeIndex = kRectPackerIndexInvalid;
+		uint32 bestTop = cppx::meta::limits<uint32>::max_value;
+		uint32 bestNodeWidth = cppx::meta::limits<uint32>::max_value;
+
+		for( size_t nodeIndex = 0; nodeIndex < _skyline.size(); ++nodeIndex )
+		{
+			uint32 rectY = 0;
+			if( FitRectAtNode( nodeIndex, pSize, rectY ) )
+			{
+				// Bottom-left: the lowest top edge wins, ties are resolved in favour of the narrower segment.
+				const auto rectTop = rectY + pSize.y;
+				if( ( rectTop < bestTop ) || ( ( rectTop == bestTop ) && ( _skyline[nodeIndex].width < bestNodeWidth ) ) )
+				{
+					bestNodeIndex = nodeIndex;
+					bestTop = rectTop;
+					bestNodeWidth = _skyline[nodeIndex].width;
+					pOutY = rectY;
+				}
+			}
+		}
+
+		return bestNodeIndex;
+	}
+
+	bool SkylineRectPacker::FitRectAtNode( size_t pNodeIndex, const cxm::vec2u32 & pSize, uint32 & pOutY ) const noexcept
+	{
+		if( _skyline[pNodeIndex].x + pSize.x > _binSize.x )
+		{
+			return false;
+		}
+
+		uint32 rectY = 0;
+		uint32 remainingWidth = pSize.x;
+
+		for( auto nodeIndex = pNodeIndex; remainingWidth > 0; ++nodeIndex )
+		{
+			rectY = cppx::get_max_of( rectY, _skyline[nodeIndex].y );
+			if( rectY + pSize.y > _binSize.y )
+			{
+				return false;
+			}
+
+			remainingWidth -= cppx::get_min_of( remainingWidth, _skyline[nodeIndex].width );
+		}
+
+		pOutY = rectY;
+
+		return true;
+	}
+
+	void SkylineRectPacker::AddWasteBelowRect( size_t pNodeIndex, uint32 pRectX, uint32 pRectY, uint32 pRectWidth )
+	{
+		const auto rectRight = pRectX + pRectWidth;
+
+		for( auto nodeIndex = pNodeIndex; ( nodeIndex < _skyline.size() ) && ( _skyline[nodeIndex].x < rectRight ); ++nodeIndex )
+		{
+			const auto & node = _skyline[nodeIndex];
+			if( node.y < pRectY )
+			{
+				const auto wasteRight = cppx::get_min_of( rectRight, node.x + node.width );
+				_wasteMap.Remove( cxm::vec2u32{ node.x, node.y }, cxm::vec2u32{ wasteRight - node.x, pRectY - node.y } );
+			}
+		}
+	}
+
+	void SkylineRectPacker::AddSkylineLevel( size_t pNodeIndex, uint32 pRectX, uint32 pRectY, const cxm::vec2u32 & pSize )
+	{
+		_skyline.insert( _skyline.begin() + pNodeIndex, SkylineNode{ pRectX, pRectY + pSize.y, pSize.x } );
+
+		// Cut the nodes covered by the new one.
+		for( auto nodeIndex = pNodeIndex + 1; nodeIndex < _skyline.size(); )
+		{
+			const auto & previousNode = _skyline[nodeIndex - 1];
+			auto & node = _skyline[nodeIndex];
+
+			const auto previousRight = previousNode.x + previousNode.width;
+			if( node.x >= previousRight )
+			{
+				break;
+			}
+
+			const auto overlap = previousRight - node.x;
+			if( node.width > overlap )
+			{
+				node.x += overlap;
+				node.width -= overlap;
+				break;
+			}
+
+			_skyline.erase( _skyline.begin() + nodeIndex );
+		}
+
+		// Merge neighbouring nodes of the same height.
+		for( size_t nodeIndex = 0; nodeIndex + 1 < _skyline.size(); )
+		{
+			if( _skyline[nodeIndex].y == _skyline[nodeIndex + 1].y )
+			{
+				_skyline[nodeIndex].width += _skyline[nodeIndex + 1].width;
+				_skyline.erase( _skyline.begin() + nodeIndex + 1 );
+			}
+			else
+			{
+				++nodeIndex;
+			}
+		}
+	}
+
+
+	static std::unique_ptr<RectPacker> CreateRectPacker( ERectPackingMethod pPackingMethod )
+	{
+		switch( pPackingMethod )
+		{
+			case ERectPackingMethod::SkylineBottomLeft:
+				return std::make_unique<SkylineRectPacker>();
+
+			case ERectPackingMethod::MaxRectsBestShortSideFit:
+				return std::make_unique<MaxRectsRectPacker>();
+
+			default:
+				break;
+		}
+
+		return nullptr;
+	}
+
 	RectAllocator::RectAllocator( const cxm::vec2u32 & pBoundingRectDimensions, const RectAllocatorConfig & pAllocatorConfig )
+	: RectAllocator( pBoundingRectDimensions, pAllocatorConfig, CreateRectPacker( pAllocatorConfig.packingMethod ) )
+	{}
+
+	RectAllocator::RectAllocator(
+			const cxm::vec2u32 & pBoundingRectDimensions,
+			const RectAllocatorConfig & pAllocatorConfig,
+			std::unique_ptr<RectPacker> pPacker )
 	: _boundingRectDimensions( pBoundingRectDimensions )
 	, _config( pAllocatorConfig )
 	, _allocPointerOffset( 0, 0 )
 	, _rectCounter( 0 )
-	{}
+	, _packer( std::move( pPacker ) )
+	{
+		if( _packer )
+		{
+			_packer->Reset( GetPackerBinSize() );
+		}
+	}
 
 	RectAllocator::~RectAllocator()
 	{}
 
 	bool RectAllocator::AddRect( const cxm::vec2u32 & pRect, cxm::vec2u32 * pOutPosition )
 	{
-		// Spacing also serves to ensure, that glyph images won't be located
-		// too close to the border itself. Hence, we add it twice at this point.
-		auto targetWidth = _config.horizontalLayout.hSpacing + pRect.x + _config.horizontalLayout.hSpacing;
-		auto targetHeight = _config.verticalLayout.vSpacing + pRect.y + _config.verticalLayout.vSpacing;
+		if( !pOutPosition )
+		{
+			return CheckFreeSpace( pRect );
+		}
 
-		// If the rect is larger than the layer itself (including padding), just ignore the request.
-		if( ( targetWidth > _boundingRectDimensions.x ) || ( pRect.y > _config.verticalLayout.baseLineHeight ) )
+		return AllocateRect( pRect, pOutPosition ) != kRectAllocationIDInvalid;
+	}
+
+	rect_allocation_id_t RectAllocator::AllocateRect( const cxm::vec2u32 & pRect, cxm::vec2u32 * pOutPosition )
+	{
+		RectEntry rectEntry;
+		rectEntry.size = pRect;
+		rectEntry.packedSize = GetPackedSize( pRect );
+		rectEntry.isActive = true;
+
+		if( _packer )
+		{
+			if( !_packer->Insert( rectEntry.packedSize, rectEntry.packedPosition ) )
+			{
+				RegisterFailedInsertion( rectEntry.packedSize );
+				return kRectAllocationIDInvalid;
+			}
+
+			// The bin of the packer starts after the spacing, so the spacing is also kept at the left/top border.
+			rectEntry.position.x = rectEntry.packedPosition.x + _config.horizontalLayout.hSpacing;
+			rectEntry.position.y = rectEntry.packedPosition.y + _config.verticalLayout.vSpacing;
+		}
+		else
+		{
+			if( !InsertRectShelf( pRect, rectEntry.position ) )
+			{
+				RegisterFailedInsertion( rectEntry.packedSize );
+				return kRectAllocationIDInvalid;
+			}
+		}
+
+		rect_allocation_id_t allocationID = 0;
+		if( !_freeRectIDList.empty() )
+		{
+			allocationID = _freeRectIDList.back();
+			_freeRectIDList.pop_back();
+			_rectArray[allocationID] = rectEntry;
+		}
+		else
+		{
+			allocationID = static_cast<rect_allocation_id_t>( _rectArray.size() );
+			_rectArray.push_back( rectEntry );
+		}
+
+		_allocatedArea += static_cast<uint64>( pRect.x ) * pRect.y;
+		_occupiedArea += static_cast<uint64>( rectEntry.packedSize.x ) * rectEntry.packedSize.y;
+
+		// Increment the number of sub-rectangles we allocated space for.
+		++_rectCounter;
+
+		if( pOutPosition )
+		{
+			*pOutPosition = rectEntry.position;
+		}
+
+		return allocationID;
+	}
+
+	bool RectAllocator::FreeRect( rect_allocation_id_t pAllocationID )
+	{
+		if( ( pAllocationID >= _rectArray.size() ) || !_rectArray[pAllocationID].isActive )
 		{
 			return false;
 		}
 
-		// Rect fits into the layer assuming the layer is empty.
-		// Check now if the remaining space can actually hold it.
-		uint32 horizontalSpaceLeft = _boundingRectDimensions.x - _allocPointerOffset.x;
+		auto & rectEntry = _rectArray[pAllocationID];
+		rectEntry.isActive = false;
+		_freeRectIDList.push_back( pAllocationID );
 
-		bool moveToNextLine = false;
+		_allocatedArea -= static_cast<uint64>( rectEntry.size.x ) * rectEntry.size.y;
+		_occupiedArea -= static_cast<uint64>( rectEntry.packedSize.x ) * rectEntry.packedSize.y;
+		--_rectCounter;
 
-		if( horizontalSpaceLeft < targetWidth )
+		if( _rectCounter == 0 )
 		{
-			// Current line may not have enough space, but we can still check the next one.
-			// Vertical offset always moves by _baseLineHeight + vertical spacing, so we need
-			// at least that much vertical space for the rect to be inserted.
-			uint32 allocOffsetYNextLine = _allocPointerOffset.y + _config.verticalLayout.vSpacing + _config.verticalLayout.baseLineHeight;
+			// Nothing is allocated, so the whole area can be reclaimed (this also removes any fragmentation).
+			Reset();
+		}
+		else if( _packer )
+		{
+			_packer->Remove( rectEntry.packedPosition, rectEntry.packedSize );
+		}
 
-			if( allocOffsetYNextLine + targetHeight > _boundingRectDimensions.y )
+		return true;
+	}
+
+	bool RectAllocator::Defragment( std::vector<RectRelocation> & pOutRelocations )
+	{
+		std::vector<rect_allocation_id_t> activeRectIDs;
+		activeRectIDs.reserve( _rectCounter );
+
+		for( rect_allocation_id_t rectIndex = 0; rectIndex < _rectArray.size(); ++rectIndex )
+		{
+			if( _rectArray[rectIndex].isActive )
 			{
-				return false;
+				activeRectIDs.push_back( rectIndex );
 			}
+		}
 
-			// Apparently we have enough vertical space to add another line of
-			// rectangles and insert our rect there. Move offsets accordingly.
-			moveToNextLine = true;
+		// Inserting rects from the largest ones is what gives offline packing its efficiency.
+		std::sort(
+				activeRectIDs.begin(),
+				activeRectIDs.end(),
+				[this]( rect_allocation_id_t pFirst, rect_allocation_id_t pSecond ) -> bool {
+					const auto & firstSize = _rectArray[pFirst].packedSize;
+					const auto & secondSize = _rectArray[pSecond].packedSize;
+					return ( firstSize.y > secondSize.y ) || ( ( firstSize.y == secondSize.y ) && ( firstSize.x > secondSize.x ) );
+				} );
+
+		std::vector<cxm::vec2u32> packedPositions( activeRectIDs.size() );
+		std::vector<cxm::vec2u32> positions( activeRectIDs.size() );
+
+		std::unique_ptr<RectPacker> newPacker;
+		const auto savedAllocPointerOffset = _allocPointerOffset;
+
+		if( _packer )
+		{
+			newPacker = _packer->CreateEmptyInstance();
+			newPacker->Reset( GetPackerBinSize() );
+		}
+		else
+		{
+			_allocPointerOffset = cxm::vec2u32{ 0, 0 };
 		}
 
-		if( pOutPosition )
+		for( size_t rectIndex = 0; rectIndex < activeRectIDs.size(); ++rectIndex )
 		{
-			if( moveToNextLine )
+			const auto & rectEntry = _rectArray[activeRectIDs[rectIndex]];
+
+			bool insertResult = false;
+			if( newPacker )
 			{
-				_allocPointerOffset.y += ( _config.verticalLayout.vSpacing + _config.verticalLayout.baseLineHeight );
-				_allocPointerOffset.x = 0;
+				insertResult = newPacker->Insert( rectEntry.packedSize, packedPositions[rectIndex] );
+				positions[rectIndex].x = packedPositions[rectIndex].x + _config.horizontalLayout.hSpacing;
+				positions[rectIndex].y = packedPositions[rectIndex].y + _config.verticalLayout.vSpacing;
+			}
+			else
+			{
+				insertResult = InsertRectShelf( rectEntry.size, positions[rectIndex] );
 			}
 
-			// Write the insert position. Of course the client is interested only in the geometry
-			// of the glyph itself, so the position must be already shifted by the padding values.
-			pOutPosition->x = _allocPointerOffset.x + _config.horizontalLayout.hSpacing;
-			pOutPosition->y = _allocPointerOffset.y + _config.verticalLayout.vSpacing;
+			if( !insertResult )
+			{
+				_allocPointerOffset = savedAllocPointerOffset;
+				return false;
+			}
+		}
 
-			// ...but the alloc offset is moved by the total width with both paddings included.
-			_allocPointerOffset.x += ( _config.horizontalLayout.hSpacing + pRect.x );
+		for( size_t rectIndex = 0; rectIndex < activeRectIDs.size(); ++rectIndex )
+		{
+			auto & rectEntry = _rectArray[activeRectIDs[rectIndex]];
+			if( ( rectEntry.position.x != positions[rectIndex].x ) || ( rectEntry.position.y != positions[rectIndex].y ) )
+			{
+				pOutRelocations.push_back( RectRelocation{ activeRectIDs[rectIndex], rectEntry.position, positions[rectIndex] } );
+				rectEntry.position = positions[rectIndex];
+			}
+			rectEntry.packedPosition = packedPositions[rectIndex];
+		}
 
-			// Increment the number of sub-rectangles we allocated space for.
-			++_rectCounter;
+		if( newPacker )
+		{
+			_packer = std::move( newPacker );
 		}
 
+		_fragmentedFailuresNum = 0;
+
 		return true;
 	}
 
@@ -97,10 +646,25 @@ namespace Ic3
 		_allocPointerOffset.x = 0;
 		_allocPointerOffset.y = 0;
 		_rectCounter = 0;
+		_rectArray.clear();
+		_freeRectIDList.clear();
+		_allocatedArea = 0;
+		_occupiedArea = 0;
+		_fragmentedFailuresNum = 0;
+
+		if( _packer )
+		{
+			_packer->Reset( GetPackerBinSize() );
+		}
 	}
 
 	bool RectAllocator::CheckFreeSpace( const cxm::vec2u32 & pRect ) const
 	{
+		if( _packer )
+		{
+			return _packer->CheckFreeSpace( GetPackedSize( pRect ) );
+		}
+
 		auto targetWidth = _config.horizontalLayout.hSpacing + pRect.x + _config.horizontalLayout.hSpacing;
 		auto targetHeight = _config.verticalLayout.vSpacing + pRect.y + _config.verticalLayout.vSpacing;
 
@@ -118,6 +682,10 @@ namespace Ic3
 				return false;
 			}
 		}
+		else if( _allocPointerOffset.y + targetHeight > _boundingRectDimensions.y )
+		{
+			return false;
+		}
 
 		return true;
 	}
@@ -127,4 +695,105 @@ namespace Ic3
 		return _rectCounter == 0;
 	}
 
+	cxm::vec2u32 RectAllocator::GetRectPosition( rect_allocation_id_t pAllocationID ) const noexcept
+	{
+		if( ( pAllocationID >= _rectArray.size() ) || !_rectArray[pAllocationID].isActive )
+		{
+			return cxm::vec2u32{ 0, 0 };
+		}
+
+		return _rectArray[pAllocationID].position;
+	}
+
+	RectAllocatorStats RectAllocator::GetStats() const noexcept
+	{
+		RectAllocatorStats allocatorStats;
+		allocatorStats.boundingArea = static_cast<uint64>( _boundingRectDimensions.x ) * _boundingRectDimensions.y;
+		allocatorStats.allocatedArea = _allocatedArea;
+		allocatorStats.allocationsNum = _rectCounter;
+		allocatorStats.freeRectsNum = _packer ? _packer->GetFreeRectsNum() : 0;
+		allocatorStats.fragmentedFailuresNum = _fragmentedFailuresNum;
+		return allocatorStats;
+	}
+
+	cxm::vec2u32 RectAllocator::GetPackedSize( const cxm::vec2u32 & pRect ) const noexcept
+	{
+		// Spacing is added on the right/bottom side of each rect. The left/top one comes from the rect next to it
+		// or (for rects at the border) from the offset of the packer bin - see GetPackerBinSize().
+		return cxm::vec2u32{ pRect.x + _config.horizontalLayout.hSpacing, pRect.y + _config.verticalLayout.vSpacing };
+	}
+
+	cxm::vec2u32 RectAllocator::GetPackerBinSize() const noexcept
+	{
+		const auto hSpacing = _config.horizontalLayout.hSpacing;
+		const auto vSpacing = _config.verticalLayout.vSpacing;
+
+		return cxm::vec2u32{
+			( _boundingRectDimensions.x > hSpacing ) ? ( _boundingRectDimensions.x - hSpacing ) : 0u,
+			( _boundingRectDimensions.y > vSpacing ) ? ( _boundingRectDimensions.y - vSpacing ) : 0u
+		};
+	}
+
+	bool RectAllocator::InsertRectShelf( const cxm::vec2u32 & pRect, cxm::vec2u32 & pOutPosition )
+	{
+		// Spacing also serves to ensure, that glyph images won't be located
+		// too close to the border itself. Hence, we add it twice at this point.
+		auto targetWidth = _config.horizontalLayout.hSpacing + pRect.x + _config.horizontalLayout.hSpacing;
+		auto targetHeight = _config.verticalLayout.vSpacing + pRect.y + _config.verticalLayout.vSpacing;
+
+		// If the rect is larger than the layer itself (including padding), just ignore the request.
+		if( ( targetWidth > _boundingRectDimensions.x ) || ( pRect.y > _config.verticalLayout.baseLineHeight ) )
+		{
+			return false;
+		}
+
+		// Rect fits into the layer assuming the layer is empty.
+		// Check now if the remaining space can actually hold it.
+		uint32 horizontalSpaceLeft = _boundingRectDimensions.x - _allocPointerOffset.x;
+
+		if( horizontalSpaceLeft < targetWidth )
+		{
+			// Current line may not have enough space, but we can still check the next one.
+			// Vertical offset always moves by _baseLineHeight + vertical spacing, so we need
+			// at least that much vertical space for the rect to be inserted.
+			uint32 allocOffsetYNextLine = _allocPointerOffset.y + _config.verticalLayout.vSpacing + _config.verticalLayout.baseLineHeight;
+
+			if( allocOffsetYNextLine + targetHeight > _boundingRectDimensions.y )
+			{
+				return false;
+			}
+
+			// Apparently we have enough vertical space to add another line of
+			// rectangles and insert our rect there. Move offsets accordingly.
+			_allocPointerOffset.y += ( _config.verticalLayout.vSpacing + _config.verticalLayout.baseLineHeight );
+			_allocPointerOffset.x = 0;
+		}
+		else if( _allocPointerOffset.y + targetHeight > _boundingRectDimensions.y )
+		{
+			// The line has been opened for a lower rect - this one would cross the bottom border.
+			return false;
+		}
+
+		// Write the insert position. Of course the client is interested only in the geometry
+		// of the glyph itself, so the position must be already shifted by the padding values.
+		pOutPosition.x = _allocPointerOffset.x + _config.horizontalLayout.hSpacing;
+		pOutPosition.y = _allocPointerOffset.y + _config.verticalLayout.vSpacing;
+
+		// ...but the alloc offset is moved by the total width with both paddings included.
+		_allocPointerOffset.x += ( _config.horizontalLayout.hSpacing + pRect.x );
+
+		return true;
+	}
+
+	void RectAllocator::RegisterFailedInsertion( const cxm::vec2u32 & pPackedSize )
+	{
+		const auto binSize = GetPackerBinSize();
+		const auto freeArea = static_cast<uint64>( binSize.x ) * binSize.y - cppx::get_min_of( _occupiedArea, static_cast<uint64>( binSize.x ) * binSize.y );
+
+		if( freeArea >= static_cast<uint64>( pPackedSize.x ) * pPackedSize.y )
+		{
+			++_fragmentedFailuresNum;
+		}
+	}
+
 }
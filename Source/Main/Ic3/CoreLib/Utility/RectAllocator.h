@@ -9,6 +9,25 @@
 namespace Ic3
 {
 
+	using rect_allocation_id_t = uint32;
+
+	inline constexpr rect_allocation_id_t kRectAllocationIDInvalid = cppx::meta::limits<rect_allocation_id_t>::max_value;
+
+	enum class ERectPackingMethod : uint32
+	{
+		/// Rects are placed in lines of fixed height (baseLineHeight). Fast, but wastes space when heights vary
+		/// and freed rects are reclaimed only when the allocator is reset (or all rects are freed).
+		Shelf,
+
+		/// Skyline, bottom-left: each rect is placed as low as possible on the skyline (the upper contour of the
+		/// occupied area). Freed rects and the space trapped below the skyline are reused via a waste map.
+		SkylineBottomLeft,
+
+		/// MaxRects with the best short side fit heuristic. Tracks all maximal free rectangles - best packing,
+		/// highest cost per insertion. Freed rects are merged back into the free set.
+		MaxRectsBestShortSideFit,
+	};
+
 	struct RectAllocatorConfig
 	{
 		struct HorizontalLayout
@@ -25,16 +44,166 @@ namespace Ic3
 
 		HorizontalLayout horizontalLayout;
 		VerticalLayout verticalLayout;
+		ERectPackingMethod packingMethod = ERectPackingMethod::Shelf;
+	};
+
+	struct RectAllocatorStats
+	{
+		/// Area of the bounding rect.
+		uint64 boundingArea = 0;
+
+		/// Total area of all active rects (without spacing).
+		uint64 allocatedArea = 0;
+
+		uint32 allocationsNum = 0;
+
+		/// Number of free rects tracked by the packer (free rects for MaxRects, waste map entries for Skyline).
+		uint32 freeRectsNum = 0;
+
+		/// Number of failed allocations since the last reset/defragmentation, for which the total free area
+		/// would have been enough. A non-zero value means the space is fragmented.
+		uint32 fragmentedFailuresNum = 0;
+	};
+
+	/// @brief Describes a rect moved by RectAllocator::Defragment(). The content of the rect (e.g. a glyph image)
+	/// has to be copied from the old position to the new one by the user.
+	struct RectRelocation
+	{
+		rect_allocation_id_t allocationID;
+		cxm::vec2u32 oldPosition;
+		cxm::vec2u32 newPosition;
+	};
+
+	/// @brief Interface of a packing algorithm used by the RectAllocator. Packers operate on the raw bin area
+	/// and raw rect sizes - spacing is already applied by the allocator. Can be implemented by the user to plug
+	/// a custom algorithm into the RectAllocator.
+	class IC3_CORELIB_CLASS RectPacker
+	{
+	public:
+		virtual ~RectPacker();
+
+		/// @brief Clears the packer, making the whole bin of the specified size available.
+		virtual void Reset( const cxm::vec2u32 & pBinSize ) = 0;
+
+		/// @brief Finds the place for the rect and marks it as used. Returns false if the rect does not fit.
+		virtual bool Insert( const cxm::vec2u32 & pSize, cxm::vec2u32 & pOutPosition ) = 0;
+
+		/// @brief Returns the previously inserted rect to the free space.
+		virtual void Remove( const cxm::vec2u32 & pPosition, const cxm::vec2u32 & pSize ) = 0;
+
+		/// @brief Returns true if Insert() with the specified size would succeed.
+		CPPX_ATTR_NO_DISCARD virtual bool CheckFreeSpace( const cxm::vec2u32 & pSize ) const = 0;
+
+		/// @brief Returns the number of free rects tracked by the packer (used as a fragmentation metric).
+		CPPX_ATTR_NO_DISCARD virtual uint32 GetFreeRectsNum() const noexcept = 0;
+
+		/// @brief Creates an empty packer of the same type (used for defragmentation).
+		CPPX_ATTR_NO_DISCARD virtual std::unique_ptr<RectPacker> CreateEmptyInstance() const = 0;
+	};
+
+	/// @brief MaxRects packer with the best short side fit heuristic (see ERectPackingMethod::MaxRectsBestShortSideFit).
+	class IC3_CORELIB_CLASS MaxRectsRectPacker : public RectPacker
+	{
+	public:
+		MaxRectsRectPacker();
+		virtual ~MaxRectsRectPacker();
+
+		virtual void Reset( const cxm::vec2u32 & pBinSize ) override;
+		virtual bool Insert( const cxm::vec2u32 & pSize, cxm::vec2u32 & pOutPosition ) override;
+		virtual void Remove( const cxm::vec2u32 & pPosition, const cxm::vec2u32 & pSize ) override;
+
+		CPPX_ATTR_NO_DISCARD virtual bool CheckFreeSpace( const cxm::vec2u32 & pSize ) const override;
+		CPPX_ATTR_NO_DISCARD virtual uint32 GetFreeRectsNum() const noexcept override;
+		CPPX_ATTR_NO_DISCARD virtual std::unique_ptr<RectPacker> CreateEmptyInstance() const override;
+
+		/// @brief Clears the free space completely. Free rects are then added only with Remove().
+		void Clear();
+
+	private:
+		struct PackedRect
+		{
+			uint32 x;
+			uint32 y;
+			uint32 width;
+			uint32 height;
+		};
+
+		CPPX_ATTR_NO_DISCARD size_t FindBestFreeRect( const cxm::vec2u32 & pSize ) const noexcept;
+
+		void SplitFreeRects( const PackedRect & pUsedRect );
+
+		void MergeFreeRects();
+
+		void PruneFreeRects( size_t pFirstNewIndex );
+
+	private:
+		std::vector<PackedRect> _freeRectArray;
+		std::vector<PackedRect> _splitRectArray;
 	};
 
+	/// @brief Skyline bottom-left packer with a waste map (see ERectPackingMethod::SkylineBottomLeft).
+	class IC3_CORELIB_CLASS SkylineRectPacker : public RectPacker
+	{
+	public:
+		SkylineRectPacker();
+		virtual ~SkylineRectPacker();
+
+		virtual void Reset( const cxm::vec2u32 & pBinSize ) override;
+		virtual bool Insert( const cxm::vec2u32 & pSize, cxm::vec2u32 & pOutPosition ) override;
+		virtual void Remove( const cxm::vec2u32 & pPosition, const cxm::vec2u32 & pSize ) override;
+
+		CPPX_ATTR_NO_DISCARD virtual bool CheckFreeSpace( const cxm::vec2u32 & pSize ) const override;
+		CPPX_ATTR_NO_DISCARD virtual uint32 GetFreeRectsNum() const noexcept override;
+		CPPX_ATTR_NO_DISCARD virtual std::unique_ptr<RectPacker> CreateEmptyInstance() const override;
+
+	private:
+		struct SkylineNode
+		{
+			uint32 x;
+			uint32 y;
+			uint32 width;
+		};
+
+		/// @brief Returns the index of the best node to place the rect at (and its y in pOutY) or -1 if the rect does not fit.
+		CPPX_ATTR_NO_DISCARD size_t FindBestNode( const cxm::vec2u32 & pSize, uint32 & pOutY ) const noexcept;
+
+		/// @brief Computes the y at which the rect placed at the specified node would rest. Returns false if it does not fit.
+		CPPX_ATTR_NO_DISCARD bool FitRectAtNode( size_t pNodeIndex, const cxm::vec2u32 & pSize, uint32 & pOutY ) const noexcept;
+
+		void AddWasteBelowRect( size_t pNodeIndex, uint32 pRectX, uint32 pRectY, uint32 pRectWidth );
+
+		void AddSkylineLevel( size_t pNodeIndex, uint32 pRectX, uint32 pRectY, const cxm::vec2u32 & pSize );
+
+	private:
+		cxm::vec2u32 _binSize;
+		std::vector<SkylineNode> _skyline;
+		MaxRectsRectPacker _wasteMap;
+	};
+
+	/// @brief Allocates rectangular sub-regions of a bounding rect (e.g. glyph or lightmap images in an atlas texture).
+	/// The packing algorithm is selected with RectAllocatorConfig::packingMethod or supplied as a custom RectPacker.
+	/// Spacing is applied between the rects and at the borders of the bounding rect. Rects allocated with
+	/// AllocateRect() can be freed and the allocator reports fragmentation (GetStats().fragmentedFailuresNum),
+	/// which can be fixed with Defragment().
 	class IC3_CORELIB_CLASS RectAllocator
 	{
 	public:
 		RectAllocator( const cxm::vec2u32 & pBoundingRectDimensions, const RectAllocatorConfig & pAllocatorConfig );
+		RectAllocator( const cxm::vec2u32 & pBoundingRectDimensions, const RectAllocatorConfig & pAllocatorConfig, std::unique_ptr<RectPacker> pPacker );
 		~RectAllocator();
 
 		bool AddRect( const cxm::vec2u32 & pRect, cxm::vec2u32 * pOutPosition );
 
+		/// @brief Allocates a rect of the specified size. Returns kRectAllocationIDInvalid if there is no space for it.
+		CPPX_ATTR_NO_DISCARD rect_allocation_id_t AllocateRect( const cxm::vec2u32 & pRect, cxm::vec2u32 * pOutPosition = nullptr );
+
+		/// @brief Frees the rect. For the shelf packing, the space is reclaimed only when all rects are freed.
+		bool FreeRect( rect_allocation_id_t pAllocationID );
+
+		/// @brief Re-packs all active rects from scratch (sorted by size, which gives a much tighter packing).
+		/// Returns false (and keeps the current layout) if they do not fit. Moved rects are added to pOutRelocations.
+		bool Defragment( std::vector<RectRelocation> & pOutRelocations );
+
 		void UpdateHorizontalLayout( RectAllocatorConfig::HorizontalLayout & pHorizontalLayout );
 		void UpdateVerticalLayout( RectAllocatorConfig::VerticalLayout & pVerticalLayout );
 
@@ -44,18 +213,47 @@ namespace Ic3
 
         CPPX_ATTR_NO_DISCARD bool IsEmpty() const;
 
+		CPPX_ATTR_NO_DISCARD cxm::vec2u32 GetRectPosition( rect_allocation_id_t pAllocationID ) const noexcept;
+
+		CPPX_ATTR_NO_DISCARD RectAllocatorStats GetStats() const noexcept;
+
         CPPX_ATTR_NO_DISCARD const RectAllocatorConfig & getConfig() const
 		{
 			return _config;
 		}
 
+	private:
+		struct RectEntry
+		{
+			cxm::vec2u32 position;
+			cxm::vec2u32 size;
+			/// Location of the rect in the packer, including spacing (which may change after the allocation).
+			cxm::vec2u32 packedPosition;
+			cxm::vec2u32 packedSize;
+			bool isActive;
+		};
+
+		CPPX_ATTR_NO_DISCARD cxm::vec2u32 GetPackedSize( const cxm::vec2u32 & pRect ) const noexcept;
+
+		CPPX_ATTR_NO_DISCARD cxm::vec2u32 GetPackerBinSize() const noexcept;
+
+		bool InsertRectShelf( const cxm::vec2u32 & pRect, cxm::vec2u32 & pOutPosition );
+
+		void RegisterFailedInsertion( const cxm::vec2u32 & pRect );
+
 	private:
 		const cxm::vec2u32 _boundingRectDimensions;
 		RectAllocatorConfig _config;
 		cxm::vec2u32       _allocPointerOffset;
 		uint32              _rectCounter;
+		std::unique_ptr<RectPacker> _packer;
+		std::vector<RectEntry> _rectArray;
+		std::vector<rect_allocation_id_t> _freeRectIDList;
+		uint64 _allocatedArea = 0;
+		uint64 _occupiedArea = 0;
+		uint32 _fragmentedFailuresNum = 0;
 	};
-	
+
 }
 
 #endif // __IC3_CORELIB_RECT_ALLOCATOR_H__
@@ -5,13 +5,15 @@
 #define __IC3_GRAPHICS_COMMON_GRAPHICS_CORE_DEFS_H__
 
 #include <Ic3/CoreLib/Utility/HFSIdentifier.h>
+#include <Ic3/CoreLib/Utility/NameTable.h>
 #include <cppx/immutableString.h>
 
 namespace Ic3::Graphics
 {
 
 	using GfxObjectID = uint64;
-	using GfxObjectName = cppx::immutable_string;
+	/// Names of graphics objects are interned, so they can be copied, compared and used as map keys at no cost.
+	using GfxObjectName = InternedName;
 
 	template <typename TP>
 	using TGfxHandle = TSharedHandle<TP>;
@@ -39,6 +41,12 @@ namespace Ic3::Graphics
 		return GenerateHfsIdentifier( pInput );
 	}
 
+	/// Overload for interned names: the ID must be generated from the text, not from the (table-specific) name ID.
+	inline GfxObjectID GenerateGfxObjectID( const GfxObjectName & pGfxObjectName )
+	{
+		return GenerateHfsIdentifier( pGfxObjectName.str_view() );
+	}
+
 	template <typename TPInput>
 	inline GfxObjectID MakeGfxObjectIDFromName( const cppx::string_view & pGfxObjectName )
 	{
@@ -51,6 +59,11 @@ namespace Ic3::Graphics
 		return GenerateHfsIdentifier( pGfxObjectName );
 	}
 
+	inline GfxObjectID MakeGfxObjectIDFromName( const GfxObjectName & pGfxObjectName )
+	{
+		return GenerateHfsIdentifier( pGfxObjectName.str_view() );
+	}
+
 	/**
 	 *
 	 */
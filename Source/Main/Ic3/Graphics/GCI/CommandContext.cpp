@@ -242,6 +242,15 @@ namespace Ic3::Graphics::GCI
 		return mCommandList->CmdSetShaderConstantBuffer( pParamRefID, pConstantBuffer );
 	}
 
+	bool CommandContextDirectGraphics::CmdSetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		Ic3DebugAssert( CheckCommandListSupport( eCommandObjectPropertyMaskContextFamilyDirectGraphics ) );
+		return mCommandList->CmdSetShaderConstantBufferRange( pParamRefID, pConstantBuffer, pBufferRegion );
+	}
+
 	bool CommandContextDirectGraphics::CmdSetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		Ic3DebugAssert( CheckCommandListSupport( eCommandObjectPropertyMaskContextFamilyDirectGraphics ) );
@@ -409,6 +418,15 @@ namespace Ic3::Graphics::GCI
 		return mCommandList->CmdSetShaderConstantBuffer( pParamRefID, pConstantBuffer );
 	}
 
+	bool CommandContextDeferredGraphics::CmdSetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		Ic3DebugAssert( CheckCommandListSupport( eCommandObjectPropertyMaskContextFamilyDeferredGraphics ) );
+		return mCommandList->CmdSetShaderConstantBufferRange( pParamRefID, pConstantBuffer, pBufferRegion );
+	}
+
 	bool CommandContextDeferredGraphics::CmdSetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		Ic3DebugAssert( CheckCommandListSupport( eCommandObjectPropertyMaskContextFamilyDeferredGraphics ) );
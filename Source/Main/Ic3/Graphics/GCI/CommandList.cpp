@@ -92,7 +92,14 @@ namespace Ic3::Graphics::GCI
 			return false;
 		}
 
-		return pBuffer.MapRegion( this, pRegion, pMapMode );
+		if( !pBuffer.MapRegion( this, pRegion, pMapMode ) )
+		{
+			return false;
+		}
+
+		pBuffer.OnMapped( pRegion );
+
+		return true;
 	}
 
 	bool CommandList::UnmapBuffer( GPUBuffer & pBuffer )
@@ -104,17 +111,22 @@ namespace Ic3::Graphics::GCI
 		}
 
 		pBuffer.Unmap( this );
+		pBuffer.OnUnmapped();
 
 		return true;
 	}
 
 	bool CommandList::FlushMappedBuffer( GPUBuffer & pBuffer )
 	{
-		GPUMemoryRegion flushRegion;
-		flushRegion.offset = 0;
-		flushRegion.size = pBuffer.mBufferProperties.byteSize;
+		if( !pBuffer.IsMapped() )
+		{
+			Ic3DebugInterrupt();
+			return false;
+		}
+
+		pBuffer.FlushMappedDirtyRegions( this, pBuffer.GetMappedMemory().mappedRegion );
 
-		return FlushMappedBufferRegion( pBuffer, flushRegion );
+		return true;
 	}
 
 	bool CommandList::FlushMappedBufferRegion( GPUBuffer & pBuffer, const GPUMemoryRegion & pRegion )
@@ -125,7 +137,7 @@ namespace Ic3::Graphics::GCI
 			return false;
 		}
 
-		pBuffer.FlushMappedRegion( this, pRegion );
+		pBuffer.FlushMappedRegionTracked( this, pRegion );
 
 		return true;
 	}
@@ -155,18 +167,32 @@ namespace Ic3::Graphics::GCI
 		subDataCopyDesc.sourceBufferRegion.size = pSourceBuffer.mBufferProperties.byteSize;
 		subDataCopyDesc.targetBufferOffset = 0;
 
+		if( pBuffer.mBufferProperties.byteSize != pSourceBuffer.mBufferProperties.byteSize )
+		{
+			Ic3DebugInterrupt();
+			return false;
+		}
+
 		return UpdateBufferSubDataCopy( pBuffer, pSourceBuffer, subDataCopyDesc );
 	}
 
 	bool CommandList::UpdateBufferSubDataCopy( GPUBuffer & pBuffer, GPUBuffer & pSourceBuffer, const GPUBufferSubDataCopyDesc & pCopyDesc )
 	{
-		if( pBuffer.IsMapped() || pSourceBuffer.IsMapped() )
+		// Persistently mapped memory stays mapped while the GPU accesses it (e.g. staging buffers), so only
+		// a regular mapping prevents the copy.
+		const auto isMappedNonPersistent = []( const GPUBuffer & pGPUBuffer ) -> bool {
+			return pGPUBuffer.IsMapped() && !pGPUBuffer.mResourceMemory.memoryFlags.is_set( eGPUMemoryHeapPropertyFlagPersistentMapBit );
+		};
+
+		if( isMappedNonPersistent( pBuffer ) || isMappedNonPersistent( pSourceBuffer ) )
 		{
 			Ic3DebugInterrupt();
 			return false;
 		}
 
-		if( pBuffer.mBufferProperties.byteSize != pSourceBuffer.mBufferProperties.byteSize )
+		const auto & sourceRegion = pCopyDesc.sourceBufferRegion;
+		if( ( sourceRegion.offset + sourceRegion.size > pSourceBuffer.mBufferProperties.byteSize ) ||
+		    ( pCopyDesc.targetBufferOffset + sourceRegion.size > pBuffer.mBufferProperties.byteSize ) )
 		{
 			Ic3DebugInterrupt();
 			return false;
@@ -315,6 +341,20 @@ namespace Ic3::Graphics::GCI
 		return _graphicsPipelineStateController->SetShaderConstantBuffer( pParamRefID, pConstantBuffer );
 	}
 
+	bool CommandList::CmdSetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		if( !IsRenderPassActive() )
+		{
+			Ic3DebugInterrupt();
+			return false;
+		}
+
+		return _graphicsPipelineStateController->SetShaderConstantBufferRange( pParamRefID, pConstantBuffer, pBufferRegion );
+	}
+
 	bool CommandList::CmdSetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		if( !IsRenderPassActive() )
@@ -81,6 +81,7 @@ namespace Ic3::Graphics::GCI
 		bool CmdSetViewport( const ViewportDesc & pViewportDesc );
 		bool CmdSetShaderConstant( shader_input_ref_id_t pParamRefID, const void * pData );
 		bool CmdSetShaderConstantBuffer( shader_input_ref_id_t pParamRefID, GPUBuffer & pConstantBuffer );
+		bool CmdSetShaderConstantBufferRange( shader_input_ref_id_t pParamRefID, GPUBuffer & pConstantBuffer, const GPUMemoryRegion & pBufferRegion );
 		bool CmdSetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture );
 		bool CmdSetShaderTextureSampler( shader_input_ref_id_t pParamRefID, Sampler & pSampler );
 
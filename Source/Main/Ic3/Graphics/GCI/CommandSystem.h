@@ -5,7 +5,7 @@
 #define __IC3_GRAPHICS_GCI_COMMAND_SYSTEM_H__
 
 #include "CommonCommandDefs.h"
-#include <unordered_map>
+#include <cppx/flatMap.h>
 
 namespace Ic3::Graphics::GCI
 {
@@ -37,7 +37,7 @@ namespace Ic3::Graphics::GCI
 		gpu_cmd_device_queue_id_t ResolveQueueID( gpu_cmd_device_queue_id_t pQueueID ) const;
 
 	private:
-		using DeviceQueueAliasMap = std::unordered_map<gpu_cmd_device_queue_id_t, gpu_cmd_device_queue_id_t>;
+		using DeviceQueueAliasMap = cppx::flat_map<gpu_cmd_device_queue_id_t, gpu_cmd_device_queue_id_t>;
 		DeviceQueueAliasMap _deviceQueueAliasMap;
 	};
 
@@ -65,6 +65,11 @@ namespace Ic3::Graphics::GCI
 		return _internalStateFlags.is_set( eGPUDeviceInternalStateFlagMultiThreadAccessBit );
 	}
 
+	void GPUDevice::SetMultiThreadAccessSupported( bool pSupported )
+	{
+		_internalStateFlags.set_or_unset( eGPUDeviceInternalStateFlagMultiThreadAccessBit, pSupported );
+	}
+
 	bool GPUDevice::IsResourceActiveRefsTrackingEnabled() const noexcept
 	{
 		return _internalStateFlags.is_set( eGPUDeviceInternalStateFlagEnableResourceActiveRefsTrackingBit );
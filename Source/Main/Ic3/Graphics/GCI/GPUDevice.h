@@ -71,6 +71,7 @@ namespace Ic3::Graphics::GCI
 
 		CPPX_ATTR_NO_DISCARD bool IsDebugDevice() const noexcept;
 
+		/// Returns true if resources (shaders, buffers, textures, etc.) can be created concurrently from multiple threads.
 		CPPX_ATTR_NO_DISCARD bool IsMultiThreadAccessSupported() const noexcept;
 
 		CPPX_ATTR_NO_DISCARD bool IsResourceActiveRefsTrackingEnabled() const noexcept;
@@ -261,6 +262,9 @@ namespace Ic3::Graphics::GCI
 	protected:
 		virtual bool OnGPUResourceActiveRefsZero( GPUResource & pGPUResource );
 
+		/// Called by drivers which allow concurrent resource creation (unless disabled with the driver config flags).
+		void SetMultiThreadAccessSupported( bool pSupported );
+
 	private:
 		/**
 		 * @brief API-level initialization of the command system. Called by the parent driver when a device is created.
@@ -0,0 +1,152 @@
+
+#include "GPUMemoryRangeSet.h"
+#include <algorithm>
+
+namespace Ic3::Graphics::GCI
+{
+
+	GPUMemoryRangeSet::GPUMemoryRangeSet( gpu_memory_size_t pMergeGap, uint32 pMaxRegionsNum )
+	: _mergeGap( pMergeGap )
+	, _maxRegionsNum( std::max<uint32>( pMaxRegionsNum, 1 ) )
+	{}
+
+	void GPUMemoryRangeSet::Add( const GPUMemoryRegion & pRegion )
+	{
+		if( pRegion.empty() )
+		{
+			return;
+		}
+
+		auto mergedBegin = pRegion.offset;
+		auto mergedEnd = pRegion.offset + pRegion.size;
+
+		// First region which ends not earlier than _mergeGap bytes before the new one. Regions are disjoint
+		// and sorted, so their end offsets are sorted as well.
+		auto regionIter = std::lower_bound(
+				_regionList.begin(),
+				_regionList.end(),
+				mergedBegin,
+				[this]( const GPUMemoryRegion & pExisting, gpu_memory_size_t pOffset ) -> bool {
+					return pExisting.offset + pExisting.size + _mergeGap < pOffset;
+				} );
+
+		auto mergeRangeEnd = regionIter;
+		while( ( mergeRangeEnd != _regionList.end() ) && ( mergeRangeEnd->offset <= mergedEnd + _mergeGap ) )
+		{
+			mergedBegin = std::min( mergedBegin, mergeRangeEnd->offset );
+			mergedEnd = std::max( mergedEnd, mergeRangeEnd->offset + mergeRangeEnd->size );
+			_totalSize -= mergeRangeEnd->size;
+			++mergeRangeEnd;
+		}
+
+		if( regionIter != mergeRangeEnd )
+		{
+			// Reuse the first merged entry instead of erasing and re-inserting it.
+			regionIter->offset = mergedBegin;
+			regionIter->size = mergedEnd - mergedBegin;
+			_regionList.erase( regionIter + 1, mergeRangeEnd );
+		}
+		else
+		{
+			_regionList.insert( regionIter, GPUMemoryRegion{ mergedBegin, mergedEnd - mergedBegin } );
+		}
+
+		_totalSize += mergedEnd - mergedBegin;
+
+		if( _regionList.size() > _maxRegionsNum )
+		{
+			MergeClosestNeighbours();
+		}
+	}
+
+	void GPUMemoryRangeSet::Remove( const GPUMemoryRegion & pRegion )
+	{
+		if( pRegion.empty() )
+		{
+			return;
+		}
+
+		const auto removedBegin = pRegion.offset;
+		const auto removedEnd = pRegion.offset + pRegion.size;
+
+		auto regionIter = std::lower_bound(
+				_regionList.begin(),
+				_regionList.end(),
+				removedBegin,
+				[]( const GPUMemoryRegion & pExisting, gpu_memory_size_t pOffset ) -> bool {
+					return pExisting.offset + pExisting.size <= pOffset;
+				} );
+
+		while( ( regionIter != _regionList.end() ) && ( regionIter->offset < removedEnd ) )
+		{
+			const auto regionBegin = regionIter->offset;
+			const auto regionEnd = regionIter->offset + regionIter->size;
+
+			if( ( regionBegin < removedBegin ) && ( regionEnd > removedEnd ) )
+			{
+				// Removed region is inside the existing one - split it into two.
+				regionIter->size = removedBegin - regionBegin;
+				_regionList.insert( regionIter + 1, GPUMemoryRegion{ removedEnd, regionEnd - removedEnd } );
+				_totalSize -= pRegion.size;
+
+				if( _regionList.size() > _maxRegionsNum )
+				{
+					MergeClosestNeighbours();
+				}
+
+				break;
+			}
+			else if( regionBegin < removedBegin )
+			{
+				_totalSize -= regionEnd - removedBegin;
+				regionIter->size = removedBegin - regionBegin;
+				++regionIter;
+			}
+			else if( regionEnd > removedEnd )
+			{
+				_totalSize -= removedEnd - regionBegin;
+				regionIter->offset = removedEnd;
+				regionIter->size = regionEnd - removedEnd;
+				break;
+			}
+			else
+			{
+				_totalSize -= regionIter->size;
+				regionIter = _regionList.erase( regionIter );
+			}
+		}
+	}
+
+	void GPUMemoryRangeSet::Clear()
+	{
+		_regionList.clear();
+		_totalSize = 0;
+	}
+
+	void GPUMemoryRangeSet::MergeClosestNeighbours()
+	{
+		Ic3DebugAssert( _regionList.size() > 1 );
+
+		size_t closestPairIndex = 0;
+		auto closestPairGap = cppx::meta::limits<gpu_memory_size_t>::max_value;
+
+		for( size_t regionIndex = 0; regionIndex + 1 < _regionList.size(); ++regionIndex )
+		{
+			const auto & currentRegion = _regionList[regionIndex];
+			const auto regionsGap = _regionList[regionIndex + 1].offset - ( currentRegion.offset + currentRegion.size );
+			if( regionsGap < closestPairGap )
+			{
+				closestPairIndex = regionIndex;
+				closestPairGap = regionsGap;
+			}
+		}
+
+		auto & mergedRegion = _regionList[closestPairIndex];
+		const auto & nextRegion = _regionList[closestPairIndex + 1];
+		mergedRegion.size = ( nextRegion.offset + nextRegion.size ) - mergedRegion.offset;
+		_totalSize += closestPairGap;
+
+		_regionList.erase( _regionList.begin() + closestPairIndex + 1 );
+	}
+
+} // namespace Ic3::Graphics::GCI
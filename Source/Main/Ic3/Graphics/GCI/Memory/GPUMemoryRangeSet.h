@@ -0,0 +1,59 @@
+
+#pragma once
+
+#ifndef __IC3_GRAPHICS_GCI_GPU_MEMORY_RANGE_SET_H__
+#define __IC3_GRAPHICS_GCI_GPU_MEMORY_RANGE_SET_H__
+
+#include "CommonGPUMemoryDefs.h"
+
+namespace Ic3::Graphics::GCI
+{
+
+	/// @brief A set of disjoint memory regions, sorted by their offsets. Regions which overlap, touch or are
+	/// separated by no more than the specified merge gap are coalesced when added. The number of regions is
+	/// bounded: if the limit is exceeded, two neighbouring regions with the smallest gap between them are merged.
+	/// Used to track parts of a mapped buffer written by the CPU, so they can be flushed without touching the rest.
+	class IC3_GRAPHICS_GCI_CLASS GPUMemoryRangeSet
+	{
+	public:
+		using RegionList = std::vector<GPUMemoryRegion>;
+
+	public:
+		explicit GPUMemoryRangeSet( gpu_memory_size_t pMergeGap = 0, uint32 pMaxRegionsNum = cppx::meta::limits<uint32>::max_value );
+
+		/// @brief Adds the region to the set, coalescing it with the existing ones if needed.
+		void Add( const GPUMemoryRegion & pRegion );
+
+		/// @brief Removes the region from the set. Regions which partially overlap it are clipped (or split).
+		void Remove( const GPUMemoryRegion & pRegion );
+
+		void Clear();
+
+		CPPX_ATTR_NO_DISCARD const RegionList & GetRegionList() const noexcept
+		{
+			return _regionList;
+		}
+
+		CPPX_ATTR_NO_DISCARD gpu_memory_size_t GetTotalSize() const noexcept
+		{
+			return _totalSize;
+		}
+
+		CPPX_ATTR_NO_DISCARD bool IsEmpty() const noexcept
+		{
+			return _regionList.empty();
+		}
+
+	private:
+		void MergeClosestNeighbours();
+
+	private:
+		RegionList _regionList;
+		gpu_memory_size_t _totalSize = 0;
+		gpu_memory_size_t _mergeGap;
+		uint32 _maxRegionsNum;
+	};
+
+} // namespace Ic3::Graphics::GCI
+
+#endif // __IC3_GRAPHICS_GCI_GPU_MEMORY_RANGE_SET_H__
@@ -10,6 +10,7 @@ namespace Ic3::Graphics::GCI
 			const GPUBufferProperties & pBufferProperties )
 	: GPUResource( pGPUDevice, EGPUResourceBaseType::Buffer, pResourceMemory )
 	, mBufferProperties( pBufferProperties )
+	, _mappedDirtyRegions( kGPUBufferDirtyRegionMergeGap, kGPUBufferDirtyRegionsMaxNum )
 	{}
 
 	GPUBuffer::~GPUBuffer() = default;
@@ -24,6 +25,33 @@ namespace Ic3::Graphics::GCI
 		return GPUMemoryRegion{ 0, mBufferProperties.byteSize };
 	}
 
+	void GPUBuffer::MarkMappedRegionDirty( const GPUMemoryRegion & pRegion )
+	{
+		const auto & mappedMemory = GetMappedMemory();
+		if( !mappedMemory )
+		{
+			Ic3DebugInterrupt();
+			return;
+		}
+
+		// Clip the region to the mapped one - nothing outside of it can be flushed.
+		const auto mappedRange = mappedMemory.mappedRegion.as_range();
+		const auto dirtyBegin = std::max( pRegion.offset, mappedRange.begin );
+		const auto dirtyEnd = std::min( pRegion.offset + pRegion.size, mappedRange.end );
+
+		if( dirtyBegin < dirtyEnd )
+		{
+			_mappedDirtyRegions.Add( GPUMemoryRegion{ dirtyBegin, dirtyEnd - dirtyBegin } );
+		}
+
+		_mappedDirtyRegionsTracked = true;
+	}
+
+	void GPUBuffer::ResetMappedMemoryStats()
+	{
+		_mappedMemoryStats = {};
+	}
+
 	bool GPUBuffer::ValidateMapRequest( const GPUMemoryRegion & pRegion, const EGPUMemoryMapMode & pMapMode )
 	{
 		if( IsMapped() )
@@ -45,6 +73,53 @@ namespace Ic3::Graphics::GCI
 		return true;
 	}
 
+	void GPUBuffer::FlushMappedDirtyRegions( void * pCommandObject, const GPUMemoryRegion & pDefaultRegion )
+	{
+		if( !_mappedDirtyRegionsTracked )
+		{
+			FlushMappedRegion( pCommandObject, pDefaultRegion );
+			_mappedMemoryStats.flushedBytes += pDefaultRegion.size;
+			_mappedMemoryStats.flushedRegionsNum += 1;
+			return;
+		}
+
+		for( const auto & dirtyRegion : _mappedDirtyRegions.GetRegionList() )
+		{
+			FlushMappedRegion( pCommandObject, dirtyRegion );
+		}
+
+		_mappedMemoryStats.flushedBytes += _mappedDirtyRegions.GetTotalSize();
+		_mappedMemoryStats.flushedRegionsNum += static_cast<uint32>( _mappedDirtyRegions.GetRegionList().size() );
+
+		_mappedDirtyRegions.Clear();
+	}
+
+	void GPUBuffer::FlushMappedRegionTracked( void * pCommandObject, const GPUMemoryRegion & pRegion )
+	{
+		FlushMappedRegion( pCommandObject, pRegion );
+		_mappedMemoryStats.flushedBytes += pRegion.size;
+		_mappedMemoryStats.flushedRegionsNum += 1;
+
+		if( _mappedDirtyRegionsTracked )
+		{
+			_mappedDirtyRegions.Remove( pRegion );
+		}
+	}
+
+	void GPUBuffer::OnMapped( const GPUMemoryRegion & pRegion )
+	{
+		_mappedDirtyRegions.Clear();
+		_mappedDirtyRegionsTracked = false;
+		_mappedMemoryStats.mappedBytes += pRegion.size;
+		_mappedMemoryStats.mapsNum += 1;
+	}
+
+	void GPUBuffer::OnUnmapped()
+	{
+		_mappedDirtyRegions.Clear();
+		_mappedDirtyRegionsTracked = false;
+	}
+
 	bool GPUBuffer::ValidateBufferCreateInfo( GPUBufferCreateInfo & pCreateInfo )
 	{
 		if( pCreateInfo.memoryBaseAlignment == 0 )
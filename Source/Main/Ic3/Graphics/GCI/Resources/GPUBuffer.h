@@ -6,15 +6,36 @@
 
 #include "GPUResource.h"
 #include "GPUBufferReference.h"
+#include "../Memory/GPUMemoryRangeSet.h"
 
 namespace Ic3::Graphics::GCI
 {
 
+	/// Dirty regions of a mapped buffer separated by less than this are flushed as a single region.
+	inline constexpr gpu_memory_size_t kGPUBufferDirtyRegionMergeGap = 256;
+
+	/// Maximum number of separate regions flushed for a mapped buffer. Above that, the closest ones are merged.
+	inline constexpr uint32 kGPUBufferDirtyRegionsMaxNum = 256;
+
 	struct GPUBufferProperties : public GPUResourceProperties
 	{
 		gpu_memory_size_t byteSize;
 	};
 
+	/// @brief Mapping statistics of a buffer, accumulated since its creation or the last reset.
+	struct GPUBufferMappedMemoryStats
+	{
+		/// Total size of all mapped regions.
+		gpu_memory_size_t mappedBytes = 0;
+
+		/// Total size of all regions flushed, both explicitly and on unmap.
+		gpu_memory_size_t flushedBytes = 0;
+
+		uint32 mapsNum = 0;
+
+		uint32 flushedRegionsNum = 0;
+	};
+
 	class IC3_GRAPHICS_GCI_CLASS GPUBuffer : public GPUResource
 	{
 		friend class CommandList;
@@ -35,6 +56,16 @@ namespace Ic3::Graphics::GCI
 
 		CPPX_ATTR_NO_DISCARD GPUMemoryRegion GetWholeBufferRegion() const;
 
+		CPPX_ATTR_NO_DISCARD const GPUBufferMappedMemoryStats & GetMappedMemoryStats() const noexcept;
+
+		/// @brief Marks the specified region of the mapped memory as written by the CPU. Offsets are relative to the
+		/// beginning of the buffer. If at least one region has been marked since the buffer was mapped, flushes done by
+		/// FlushMappedBuffer() and unmapping of non-coherent memory only cover the marked regions (coalesced). If none
+		/// has been marked, the whole mapped region is flushed, as before.
+		void MarkMappedRegionDirty( const GPUMemoryRegion & pRegion );
+
+		void ResetMappedMemoryStats();
+
 	protected:
 		virtual bool MapRegion( void * pCommandObject, const GPUMemoryRegion & pRegion, EGPUMemoryMapMode pMapMode ) = 0;
 
@@ -50,9 +81,31 @@ namespace Ic3::Graphics::GCI
 
 		virtual bool ValidateMapRequest( const GPUMemoryRegion & pRegion, const EGPUMemoryMapMode & pMapMode );
 
+		/// @brief Flushes regions marked as dirty and clears them. If dirty regions are not tracked for the current
+		/// mapping (MarkMappedRegionDirty() has not been called), pDefaultRegion is flushed instead.
+		void FlushMappedDirtyRegions( void * pCommandObject, const GPUMemoryRegion & pDefaultRegion );
+
+		/// @brief Flushes the specified region and excludes it from the set of dirty regions.
+		void FlushMappedRegionTracked( void * pCommandObject, const GPUMemoryRegion & pRegion );
+
 		static bool ValidateBufferCreateInfo( GPUBufferCreateInfo & pCreateInfo );
+
+	private:
+		void OnMapped( const GPUMemoryRegion & pRegion );
+
+		void OnUnmapped();
+
+	private:
+		GPUMemoryRangeSet _mappedDirtyRegions;
+		GPUBufferMappedMemoryStats _mappedMemoryStats;
+		bool _mappedDirtyRegionsTracked = false;
 	};
 
+	inline const GPUBufferMappedMemoryStats & GPUBuffer::GetMappedMemoryStats() const noexcept
+	{
+		return _mappedMemoryStats;
+	}
+
 } // namespace Ic3::Graphics::GCI
 
 #endif // __IC3_GRAPHICS_GCI_GPU_BUFFER_H__
@@ -7,7 +7,8 @@ namespace Ic3::Graphics::GCI
 
 	std::unique_ptr<ShaderBinary> ShaderBinary::Create( size_t pBinarySize )
 	{
-		const auto requiredBinaryStorageSize = pBinarySize - dataBufferFixedSize;
+		// Binaries smaller than the fixed buffer do not need any extra storage (the difference would wrap around).
+		const auto requiredBinaryStorageSize = ( pBinarySize > dataBufferFixedSize ) ? ( pBinarySize - dataBufferFixedSize ) : 0;
 		auto * shaderBinary = new( kAllocNewSizeExplicit, requiredBinaryStorageSize ) ShaderBinary();
 		shaderBinary->dataSizeInBytes = cppx::numeric_cast<uint32>( pBinarySize );
 		return std::unique_ptr<ShaderBinary>{ shaderBinary };
@@ -131,6 +131,14 @@ namespace Ic3::Graphics::GCI
 		return true;
 	}
 
+	bool GraphicsPipelineStateController::SetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		return true;
+	}
+
 	bool GraphicsPipelineStateController::SetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		return true;
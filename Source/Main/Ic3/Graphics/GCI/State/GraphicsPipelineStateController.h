@@ -138,6 +138,7 @@ namespace Ic3::Graphics::GCI
 
 		virtual bool SetShaderConstant( shader_input_ref_id_t pParamRefID, const void * pData );
 		virtual bool SetShaderConstantBuffer( shader_input_ref_id_t pParamRefID, GPUBuffer & pConstantBuffer );
+		virtual bool SetShaderConstantBufferRange( shader_input_ref_id_t pParamRefID, GPUBuffer & pConstantBuffer, const GPUMemoryRegion & pBufferRegion );
 		virtual bool SetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture );
 		virtual bool SetShaderTextureSampler( shader_input_ref_id_t pParamRefID, Sampler & pSampler );
 
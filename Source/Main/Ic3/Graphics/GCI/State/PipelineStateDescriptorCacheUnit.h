@@ -6,9 +6,9 @@
 
 #include "PipelineStateCommon.h"
 
+#include <cppx/flatHashMap.h>
 #include <cppx/hash.h>
 #include <cppx/immutableString.h>
-#include <unordered_map>
 
 namespace Ic3::Graphics::GCI
 {
@@ -108,8 +108,8 @@ namespace Ic3::Graphics::GCI
 			TGfxHandle<TPDescriptorType> cachedStateDescriptor;
 		};
 
-		using DescriptorIDToObjectMap = std::unordered_map<pipeline_state_descriptor_id_t, CachedDescriptorData>;
-		using ConfigHashToDescriptorIDMap = std::unordered_map<pipeline_config_hash_value_t, pipeline_state_descriptor_id_t>;
+		using DescriptorIDToObjectMap = cppx::flat_hash_map<pipeline_state_descriptor_id_t, CachedDescriptorData>;
+		using ConfigHashToDescriptorIDMap = cppx::flat_hash_map<pipeline_config_hash_value_t, pipeline_state_descriptor_id_t>;
 
 	private:
 		static bool _ValidateDescriptorID( pipeline_state_descriptor_id_t pDescriptorID ) noexcept
@@ -26,7 +26,10 @@ namespace Ic3::Graphics::GCI
 	, mD3D11DebugInterface( std::move( pD3D11Debug ) )
 	, _dx11PipelineStateDescriptorFactory( *this )
 	, _pipelineStateDescriptorManager( *this, _dx11PipelineStateDescriptorFactory )
-	{}
+	{
+		// ID3D11Device is free-threaded, unless created with D3D11_CREATE_DEVICE_SINGLETHREADED.
+		SetMultiThreadAccessSupported( !pDriver.GetConfigFlags().is_set( eGPUDriverConfigFlagDisableMultiThreadAccessBit ) );
+	}
 
 	DX11GPUDevice::~DX11GPUDevice() = default;
 
@@ -55,17 +55,36 @@ namespace Ic3::Graphics::GCI
 		if( !shaderSourceView )
 		{
 			shaderSourceView = cppx::bind_memory_view( pCreateInfo.shaderSource.data(), pCreateInfo.shaderSource.size() );
-			if( !shaderSourceView )
+			if( !shaderSourceView && !pCreateInfo.shaderBinary )
 			{
 				return nullptr;
 			}
 		}
 
+		// A precompiled binary (e.g. from a shader cache) is used if it has been compiled for the same target.
+		// Otherwise, the source is compiled.
+		const auto acquireShaderBinary = [&]( DXShaderTarget pShaderTarget ) -> std::unique_ptr<ShaderBinary> {
+			const auto * inputBinary = pCreateInfo.shaderBinary.get();
+			if( inputBinary && !inputBinary->IsEmpty() && ( inputBinary->driverSpecificFormatTag == static_cast<uint64>( pShaderTarget ) ) )
+			{
+				auto shaderBinary = ShaderBinary::Create( inputBinary->dataSizeInBytes );
+				shaderBinary->driverSpecificID = inputBinary->driverSpecificID;
+				shaderBinary->driverSpecificFormatTag = inputBinary->driverSpecificFormatTag;
+				cppx::mem_copy( shaderBinary->dataBuffer, shaderBinary->dataSizeInBytes, inputBinary->dataBuffer, inputBinary->dataSizeInBytes );
+				return shaderBinary;
+			}
+			if( !shaderSourceView )
+			{
+				return nullptr;
+			}
+			return RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, pShaderTarget, compileFlags );
+		};
+
 		DX11ShaderHandle dx11Shader;
 
 		if( pCreateInfo.shaderType == EShaderType::GSVertex )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_VS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_VS ) )
 			{
 				ComPtr<ID3D11VertexShader> d3d11VertexShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreateVertexShader(
@@ -83,7 +102,7 @@ namespace Ic3::Graphics::GCI
 		}
 		else if( pCreateInfo.shaderType == EShaderType::GSTessHull )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_HS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_HS ) )
 			{
 				ComPtr<ID3D11HullShader> d3d11HullShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreateHullShader(
@@ -101,7 +120,7 @@ namespace Ic3::Graphics::GCI
 		}
 		else if( pCreateInfo.shaderType == EShaderType::GSTessDomain )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_DS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_DS ) )
 			{
 				ComPtr<ID3D11DomainShader> d3d11DomainShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreateDomainShader(
@@ -119,7 +138,7 @@ namespace Ic3::Graphics::GCI
 		}
 		else if( pCreateInfo.shaderType == EShaderType::GSGeometry )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_GS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_GS ) )
 			{
 				ComPtr<ID3D11GeometryShader> d3d11GeometryShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreateGeometryShader(
@@ -137,7 +156,7 @@ namespace Ic3::Graphics::GCI
 		}
 		else if( pCreateInfo.shaderType == EShaderType::GSPixel )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_PS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_PS ) )
 			{
 				ComPtr<ID3D11PixelShader> d3d11PixelShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreatePixelShader(
@@ -155,7 +174,7 @@ namespace Ic3::Graphics::GCI
 		}
 		else if( pCreateInfo.shaderType == EShaderType::CSCompute )
 		{
-			if( auto shaderBinary = RCU::CompileShader( shaderSourceView.data(), shaderSourceView.size(), entryPoint, DXShaderTarget::SM_5_0_CS, compileFlags ) )
+			if( auto shaderBinary = acquireShaderBinary( DXShaderTarget::SM_5_0_CS ) )
 			{
 				ComPtr<ID3D11ComputeShader> d3d11ComputeShader;
 				auto hResult = pDX11GPUDevice.mD3D11Device1->CreateComputeShader(
@@ -280,6 +280,75 @@ namespace Ic3::Graphics::GCI
 		return !updatedStagesMask.empty();
 	}
 
+	bool DX11GraphicsPipelineStateController::SetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		bool baseResult = BaseStateControllerType::SetShaderConstantBufferRange( pParamRefID, pConstantBuffer, pBufferRegion );
+
+		auto updatedStagesMask = cppx::make_bitmask_tp<EShaderStageFlags>();
+
+		if( baseResult )
+		{
+			const auto & rootSignatureDescriptor = GetCurrentPSORootSignatureDescriptor<DX11RootSignatureDescriptor>();
+			Ic3DebugAssert( rootSignatureDescriptor.mRootSignature );
+
+			const auto & descriptorInfo = rootSignatureDescriptor.mRootSignature.GetDescriptorInfo( pParamRefID );
+			Ic3DebugAssert( descriptorInfo.dDescriptorType == EShaderInputDescriptorType::Resource );
+			Ic3DebugAssert( descriptorInfo.uResourceInfo.resourceType == EShaderInputResourceType::CBVConstantBuffer );
+
+			if( descriptorInfo.dShaderVisibilityMask != 0 )
+			{
+				auto * dx11Buffer = pConstantBuffer.QueryInterface<DX11GPUBuffer>();
+				auto * d3d11Buffer = dx11Buffer->mD3D11Buffer.Get();
+
+				// D3D11.1 addresses constant buffers in 16-byte constants. The offset must be a multiple
+				// of 256 bytes (16 constants) and so must the size, hence it is rounded up here.
+				Ic3DebugAssert( ( pBufferRegion.offset % 256 ) == 0 );
+				const auto firstConstant = static_cast<UINT>( pBufferRegion.offset / 16 );
+				const auto constantsNum = static_cast<UINT>( cppx::mem_get_aligned_value( pBufferRegion.size, 256 ) / 16 );
+
+				if( descriptorInfo.dShaderVisibilityMask.is_set( eShaderStageFlagGraphicsVertexBit ) )
+				{
+					mD3D11DeviceContext1->VSSetConstantBuffers1(
+							descriptorInfo.uResourceInfo.resourceBaseRegisterIndex, 1, &d3d11Buffer, &firstConstant, &constantsNum );
+					updatedStagesMask.set( eShaderStageFlagGraphicsVertexBit );
+				}
+
+				if( descriptorInfo.dShaderVisibilityMask.is_set( eShaderStageFlagGraphicsTessHullBit) )
+				{
+					mD3D11DeviceContext1->HSSetConstantBuffers1(
+							descriptorInfo.uResourceInfo.resourceBaseRegisterIndex, 1, &d3d11Buffer, &firstConstant, &constantsNum );
+					updatedStagesMask.set( eShaderStageFlagGraphicsTessHullBit );
+				}
+
+				if( descriptorInfo.dShaderVisibilityMask.is_set( eShaderStageFlagGraphicsTessDomainBit ) )
+				{
+					mD3D11DeviceContext1->DSSetConstantBuffers1(
+							descriptorInfo.uResourceInfo.resourceBaseRegisterIndex, 1, &d3d11Buffer, &firstConstant, &constantsNum );
+					updatedStagesMask.set( eShaderStageFlagGraphicsTessDomainBit );
+				}
+
+				if( descriptorInfo.dShaderVisibilityMask.is_set( eShaderStageFlagGraphicsGeometryBit ) )
+				{
+					mD3D11DeviceContext1->GSSetConstantBuffers1(
+							descriptorInfo.uResourceInfo.resourceBaseRegisterIndex, 1, &d3d11Buffer, &firstConstant, &constantsNum );
+					updatedStagesMask.set( eShaderStageFlagGraphicsGeometryBit );
+				}
+
+				if( descriptorInfo.dShaderVisibilityMask.is_set( eShaderStageFlagGraphicsPixelBit ) )
+				{
+					mD3D11DeviceContext1->PSSetConstantBuffers1(
+							descriptorInfo.uResourceInfo.resourceBaseRegisterIndex, 1, &d3d11Buffer, &firstConstant, &constantsNum );
+					updatedStagesMask.set( eShaderStageFlagGraphicsPixelBit );
+				}
+			}
+		}
+
+		return !updatedStagesMask.empty();
+	}
+
 	bool DX11GraphicsPipelineStateController::SetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		bool baseResult = BaseStateControllerType::SetShaderTextureImage( pParamRefID, pTexture );
@@ -133,7 +133,7 @@ namespace Ic3::Graphics::GCI
 		return true;
 	}
 
-	void GLGPUBuffer::Unmap( void * )
+	void GLGPUBuffer::Unmap( void * pCommandObject )
 	{
 		if( const auto & mappedMemory = GetMappedMemory() )
 		{
@@ -141,7 +141,8 @@ namespace Ic3::Graphics::GCI
 			{
 				if( !mResourceMemory.memoryFlags.is_set( eGPUMemoryHeapPropertyFlagCPUCoherentBit ) )
 				{
-					mGLBufferObject->FlushMappedRegion( mappedMemory.mappedRegion.offset, mappedMemory.mappedRegion.size );
+					// Only regions marked as dirty are flushed (or the whole mapped region, if they are not tracked).
+					FlushMappedDirtyRegions( pCommandObject, mappedMemory.mappedRegion );
 				}
 			}
 			else
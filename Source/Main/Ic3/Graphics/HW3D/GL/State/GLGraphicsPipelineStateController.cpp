@@ -269,6 +269,40 @@ namespace Ic3::Graphics::GCI
 		return baseResult;
 	}
 
+	bool GLGraphicsPipelineStateController::SetShaderConstantBufferRange(
+			shader_input_ref_id_t pParamRefID,
+			GPUBuffer & pConstantBuffer,
+			const GPUMemoryRegion & pBufferRegion )
+	{
+		bool baseResult = BaseStateControllerType::SetShaderConstantBufferRange( pParamRefID, pConstantBuffer, pBufferRegion );
+
+		if( baseResult )
+		{
+			const auto & rootSignatureDescriptor = GetCurrentPSORootSignatureDescriptor<RootSignatureDescriptorGeneric>();
+			Ic3DebugAssert( rootSignatureDescriptor.mRootSignature );
+
+			const auto & descriptorInfo = rootSignatureDescriptor.mRootSignature.GetDescriptorInfo( pParamRefID );
+			Ic3DebugAssert( descriptorInfo.dDescriptorType == EShaderInputDescriptorType::Resource );
+			Ic3DebugAssert( descriptorInfo.uResourceInfo.resourceType == EShaderInputResourceType::CBVConstantBuffer );
+
+			if( descriptorInfo.dShaderVisibilityMask != 0 )
+			{
+				auto * glcGPUBuffer = pConstantBuffer.QueryInterface<GLGPUBuffer>();
+
+				// The offset must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, this is up to the caller.
+				glBindBufferRange(
+						GL_UNIFORM_BUFFER,
+						descriptorInfo.uResourceInfo.resourceBaseRegisterIndex,
+						glcGPUBuffer->mGLBufferObject->mGLHandle,
+						static_cast<GLintptr>( pBufferRegion.offset ),
+						static_cast<GLsizeiptr>( pBufferRegion.size ) );
+				Ic3OpenGLHandleLastError();
+			}
+		}
+
+		return baseResult;
+	}
+
 	bool GLGraphicsPipelineStateController::SetShaderTextureImage( shader_input_ref_id_t pParamRefID, Texture & pTexture )
 	{
 		bool baseResult = BaseStateControllerType::SetShaderTextureImage( pParamRefID, pTexture );
@@ -1,14 +1,56 @@
 
-#include "constantBufferProxy.h"
+#include "ConstantBufferProxy.h"
+#include <Ic3/Graphics/GCI/CommandContext.h>
 #include <Ic3/Graphics/GCI/Resources/GPUBuffer.h>
 
 namespace Ic3
 {
 
-	ConstantBufferProxy::ConstantBufferProxy( GCI::GPUBufferHandle pBuffer )
-	: mGPUDevice( pBuffer->mGPUDevice )
+	ConstantBufferProxy::ConstantBufferProxy( ConstantBufferRingAllocator & pAllocator )
+	: mAllocator( pAllocator )
 	{}
 
 	ConstantBufferProxy::~ConstantBufferProxy() = default;
 
-}
+	void ConstantBufferProxy::initialize( uint32 pDataSize )
+	{
+		_dataRef.bufferSize = static_cast<uint32>( cppx::mem_get_aligned_value( pDataSize, kConstantBufferRingDefaultAlignment ) );
+		_dataRef.dataPtr = nullptr;
+		_dataRef.dataSize = pDataSize;
+		_dataRef.modified = 0;
+		_currentAllocation = {};
+		_localCache.clear();
+	}
+
+	bool ConstantBufferProxy::flushUpdates()
+	{
+		if( !_dataRef.modified )
+		{
+			return true;
+		}
+
+		if( !allocateSlice() )
+		{
+			return false;
+		}
+
+		cppx::mem_copy_unchecked( _dataRef.dataPtr, _dataRef.dataSize, _localCache.data(), _localCache.size() );
+		_dataRef.modified = 0;
+
+		return true;
+	}
+
+	bool ConstantBufferProxy::bind( GCI::CommandContextDirectGraphics & pCommandContext, GCI::shader_input_ref_id_t pParamRefID )
+	{
+		if( !_currentAllocation )
+		{
+			return false;
+		}
+
+		return pCommandContext.CmdSetShaderConstantBufferRange(
+				pParamRefID,
+				*_currentAllocation.buffer,
+				_currentAllocation.bufferRegion );
+	}
+
+} // namespace Ic3
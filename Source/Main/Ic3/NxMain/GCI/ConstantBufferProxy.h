@@ -4,8 +4,7 @@
 #ifndef __IC3_NXMAIN_CONSTANT_BUFFER_PROXY_H__
 #define __IC3_NXMAIN_CONSTANT_BUFFER_PROXY_H__
 
-#include "../Prerequisites.h"
-#include <Ic3/Graphics/GCI/Resources/GPUBufferCommon.h>
+#include "ConstantBufferRingAllocator.h"
 
 namespace Ic3
 {
@@ -18,44 +17,109 @@ namespace Ic3
 		uint32 modified = 0;
 	};
 
-	class ConstantBufferProxy
+	/// @brief Typed access to constant buffer data allocated from a ConstantBufferRingAllocator.
+	/// setData() allocates a new slice for every update and writes the data straight into it, so a single proxy
+	/// can be used to feed per-object data: each update gets its own region, which has to be bound (bind()) before
+	/// the next update. setSubData() modifies a local copy of the data, which is written into a new slice only when
+	/// flushUpdates() is called (this way partial updates never read back from the GPU-visible memory).
+	class IC3_NXMAIN_CLASS ConstantBufferProxy
 	{
 	public:
-		GCI::GPUDevice & mGPUDevice;
+		ConstantBufferRingAllocator & mAllocator;
 
 	public:
-		ConstantBufferProxy( GCI::GPUBufferHandle pBuffer );
+		ConstantBufferProxy( ConstantBufferRingAllocator & pAllocator );
 		~ConstantBufferProxy();
 
-		GCI::GPUBufferHandle buffer() const noexcept;
+		/// @brief Returns the buffer the current slice has been allocated from.
+		CPPX_ATTR_NO_DISCARD GCI::GPUBufferHandle buffer() const noexcept;
+
+		/// @brief Returns the region of the buffer which contains the most recently written data.
+		CPPX_ATTR_NO_DISCARD const GCI::GPUMemoryRegion & bufferRegion() const noexcept;
 
 		template <typename TData>
-		void setData( const TData & pData )
+		bool setData( const TData & pData )
 		{
-			Ic3DebugAssert( sizeof( TData ) == _dataRef.mDataSize );
-			mem_copy_unchecked( _dataRef.mDataPtr, _dataRef.mDataSize, &pData, sizeof( TData ) );
+			Ic3DebugAssert( sizeof( TData ) == _dataRef.dataSize );
+			if( !allocateSlice() )
+			{
+				return false;
+			}
+
+			cppx::mem_copy_unchecked( _dataRef.dataPtr, _dataRef.dataSize, &pData, sizeof( TData ) );
+
+			if( !_localCache.empty() )
+			{
+				cppx::mem_copy_unchecked( _localCache.data(), _localCache.size(), &pData, sizeof( TData ) );
+			}
+
+			return true;
 		}
 
-		template <typename TData, typename TMember >
+		template <typename TData, typename TMember>
 		void setSubData( TMember TData::* pMember, const TMember & pData )
 		{
-			const auto offset = member_offset( pMember );
+			const auto offset = cppx::member_offset( pMember );
 			const auto size = sizeof( TMember );
-			Ic3DebugAssert( ( offset < _dataRef.mDataSize ) && (size <= _dataRef.mDataSize - offset ) );
-			mem_copy_unchecked( _dataRef.mDataPtr + offset, size, &pData, size );
+			Ic3DebugAssert( ( offset < _dataRef.dataSize ) && ( size <= _dataRef.dataSize - offset ) );
+
+			if( _localCache.empty() )
+			{
+				_localCache.resize( _dataRef.dataSize, 0 );
+			}
+
+			cppx::mem_copy_unchecked( _localCache.data() + offset, size, &pData, size );
+			_dataRef.modified = 1;
 		}
 
+		/// @brief Allocates a slice for TData and returns a pointer to it. All members have to be written by the caller.
 		template <typename TData>
-		void initialize();
+		TData * mapData()
+		{
+			Ic3DebugAssert( sizeof( TData ) == _dataRef.dataSize );
+			return allocateSlice() ? static_cast<TData *>( _dataRef.dataPtr ) : nullptr;
+		}
+
+		template <typename TData>
+		void initialize()
+		{
+			initialize( sizeof( TData ) );
+		}
+
+		void initialize( uint32 pDataSize );
+
+		/// @brief Writes the data modified with setSubData() into a new slice. Returns false if the allocation failed.
+		bool flushUpdates();
 
-		void flushUpdates();
+		/// @brief Binds the current slice to the specified shader input.
+		bool bind( GCI::CommandContextDirectGraphics & pCommandContext, GCI::shader_input_ref_id_t pParamRefID );
 
 	private:
-		GCI::GPUBufferHandle _buffer;
+		bool allocateSlice();
+
+	private:
+		ConstantBufferAllocation _currentAllocation;
 		ConstantBufferDataRef _dataRef;
-		cppx::dynamic_memory_buffer _localCache;
+		std::vector<byte> _localCache;
 	};
 
+	inline GCI::GPUBufferHandle ConstantBufferProxy::buffer() const noexcept
+	{
+		return mAllocator.GetBuffer();
+	}
+
+	inline const GCI::GPUMemoryRegion & ConstantBufferProxy::bufferRegion() const noexcept
+	{
+		return _currentAllocation.bufferRegion;
+	}
+
+	inline bool ConstantBufferProxy::allocateSlice()
+	{
+		_currentAllocation = mAllocator.Allocate( _dataRef.dataSize );
+		_dataRef.dataPtr = _currentAllocation.dataPtr;
+		return _dataRef.dataPtr != nullptr;
+	}
+
 } // namespace Ic3
 
 #endif // __IC3_NXMAIN_CONSTANT_BUFFER_PROXY_H__
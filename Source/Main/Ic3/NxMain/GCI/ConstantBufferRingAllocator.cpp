@@ -0,0 +1,138 @@
+
+#include "ConstantBufferRingAllocator.h"
+#include <Ic3/Graphics/GCI/CommandContext.h>
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBuffer.h>
+
+namespace Ic3
+{
+
+	ConstantBufferRingAllocator::ConstantBufferRingAllocator( GCI::GPUDevice & pGPUDevice )
+	: mGPUDevice( pGPUDevice )
+	{}
+
+	ConstantBufferRingAllocator::~ConstantBufferRingAllocator() = default;
+
+	bool ConstantBufferRingAllocator::Initialize(
+			GCI::CommandContext & pCommandContext,
+			const ConstantBufferRingAllocatorCreateInfo & pCreateInfo )
+	{
+		Ic3DebugAssert( !_buffer );
+		Ic3DebugAssert( ( pCreateInfo.allocationAlignment & ( pCreateInfo.allocationAlignment - 1 ) ) == 0 );
+
+		if( ( pCreateInfo.frameSegmentSize == 0 ) || ( pCreateInfo.framesInFlightNum == 0 ) )
+		{
+			return false;
+		}
+
+		_allocationAlignment = pCreateInfo.allocationAlignment;
+		_frameSegmentSize = cppx::mem_get_aligned_value( pCreateInfo.frameSegmentSize, _allocationAlignment );
+
+		GCI::GPUBufferCreateInfo bufferCreateInfo;
+		bufferCreateInfo.bufferSize = _frameSegmentSize * pCreateInfo.framesInFlightNum;
+		bufferCreateInfo.memoryBaseAlignment = _allocationAlignment;
+		bufferCreateInfo.resourceFlags = GCI::eGPUResourceContentFlagDynamicBit | GCI::eGPUBufferBindFlagConstantBufferBit;
+		bufferCreateInfo.memoryFlags = GCI::eGPUResourceMemoryMaskConstantBuffer | GCI::eGPUMemoryHeapPropertyFlagPersistentMapBit;
+
+		_buffer = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+		if( !_buffer )
+		{
+			// Persistent mapping may be rejected by the driver. Regular dynamic buffer is updated via uploads.
+			bufferCreateInfo.memoryFlags = GCI::eGPUResourceMemoryMaskConstantBuffer;
+			_buffer = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+		}
+
+		if( !_buffer )
+		{
+			return false;
+		}
+
+		const auto & bufferMemoryFlags = _buffer->mResourceMemory.memoryFlags;
+		if( bufferMemoryFlags.is_set( GCI::eGPUMemoryHeapPropertyFlagPersistentMapBit ) )
+		{
+			if( pCommandContext.MapBuffer( *_buffer, GCI::EGPUMemoryMapMode::WriteDefault ) )
+			{
+				_mappedMemoryPtr = static_cast<byte *>( _buffer->GetMappedMemory().pointer );
+			}
+		}
+
+		if( !_mappedMemoryPtr )
+		{
+			_stagingMemory.resize( cppx::numeric_cast<size_t>( bufferCreateInfo.bufferSize ) );
+			_mappedMemoryPtr = _stagingMemory.data();
+		}
+
+		_coherentMemory = bufferMemoryFlags.is_set( GCI::eGPUMemoryHeapPropertyFlagCPUCoherentBit );
+		_segmentSyncArray.resize( pCreateInfo.framesInFlightNum );
+		_currentSegmentIndex = 0;
+		_currentSegmentOffset = 0;
+		_currentSegmentAllocatedSize = 0;
+		_peakSegmentAllocatedSize = 0;
+
+		return true;
+	}
+
+	void ConstantBufferRingAllocator::Release( GCI::CommandContext & pCommandContext )
+	{
+		for( auto & segmentSync : _segmentSyncArray )
+		{
+			mGPUDevice.WaitForCommandSync( segmentSync );
+		}
+
+		if( _buffer && _stagingMemory.empty() && _mappedMemoryPtr )
+		{
+			pCommandContext.UnmapBuffer( *_buffer );
+		}
+
+		_segmentSyncArray.clear();
+		_stagingMemory.clear();
+		_mappedMemoryPtr = nullptr;
+		_buffer.reset();
+	}
+
+	void ConstantBufferRingAllocator::BeginFrame()
+	{
+		_peakSegmentAllocatedSize = GetPeakFrameAllocatedSize();
+
+		const auto segmentsNum = static_cast<uint32>( _segmentSyncArray.size() );
+		_currentSegmentIndex = ( _currentSegmentIndex + 1 ) % segmentsNum;
+		_currentSegmentOffset = _currentSegmentIndex * _frameSegmentSize;
+		_currentSegmentAllocatedSize = 0;
+
+		// No-op if the segment has not been used yet or its sync has been already consumed.
+		mGPUDevice.WaitForCommandSync( _segmentSyncArray[_currentSegmentIndex] );
+	}
+
+	void ConstantBufferRingAllocator::FlushFrame( GCI::CommandContextDirectTransfer & pCommandContext )
+	{
+		if( _currentSegmentAllocatedSize == 0 )
+		{
+			return;
+		}
+
+		GCI::GPUMemoryRegion frameRegion;
+		frameRegion.offset = _currentSegmentOffset;
+		frameRegion.size = _currentSegmentAllocatedSize;
+
+		if( !_stagingMemory.empty() )
+		{
+			// The segment is not used by the GPU at this point (see BeginFrame()), so the upload does not stall.
+			GCI::GPUBufferSubDataUploadDesc uploadDesc;
+			uploadDesc.bufferRegion = frameRegion;
+			uploadDesc.inputDataDesc.pointer = _stagingMemory.data() + _currentSegmentOffset;
+			uploadDesc.inputDataDesc.size = _currentSegmentAllocatedSize;
+
+			pCommandContext.UpdateBufferSubDataUpload( *_buffer, uploadDesc );
+		}
+		else if( !_coherentMemory )
+		{
+			pCommandContext.FlushMappedBufferRegion( *_buffer, frameRegion );
+		}
+	}
+
+	void ConstantBufferRingAllocator::EndFrame( GCI::CommandSync pFrameSync )
+	{
+		_segmentSyncArray[_currentSegmentIndex] = std::move( pFrameSync );
+	}
+
+} // namespace Ic3
@@ -0,0 +1,149 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_CONSTANT_BUFFER_RING_ALLOCATOR_H__
+#define __IC3_NXMAIN_CONSTANT_BUFFER_RING_ALLOCATOR_H__
+
+#include "../Prerequisites.h"
+#include <Ic3/Graphics/GCI/CommonCommandDefs.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBufferCommon.h>
+
+namespace Ic3
+{
+
+	/// @brief Default alignment of constant buffer slices. 256 bytes is the D3D11.1 requirement for binding
+	/// with an offset and it is also the largest GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT among common GL drivers.
+	inline constexpr uint32 kConstantBufferRingDefaultAlignment = 256;
+
+	inline constexpr uint32 kConstantBufferRingDefaultFramesInFlightNum = 3;
+
+	inline constexpr GCI::gpu_memory_size_t kConstantBufferRingDefaultFrameSegmentSize = 16 * 1024 * 1024;
+
+	struct ConstantBufferRingAllocatorCreateInfo
+	{
+		/// Size of the memory available for a single frame. The buffer holds one such segment per frame in flight.
+		GCI::gpu_memory_size_t frameSegmentSize = kConstantBufferRingDefaultFrameSegmentSize;
+
+		/// Number of frames the CPU can record ahead of the GPU. Segments are reused in a round-robin manner.
+		uint32 framesInFlightNum = kConstantBufferRingDefaultFramesInFlightNum;
+
+		/// Alignment of every allocated slice. Must be a power of 2.
+		uint32 allocationAlignment = kConstantBufferRingDefaultAlignment;
+	};
+
+	/// @brief A slice of the ring buffer, valid until the end of the frame it has been allocated in.
+	struct ConstantBufferAllocation
+	{
+		GCI::GPUBuffer * buffer = nullptr;
+
+		/// Pointer to the CPU-visible memory of the slice (either mapped buffer memory or a staging copy).
+		void * dataPtr = nullptr;
+
+		/// Region of the buffer which should be bound (with CmdSetShaderConstantBufferRange()) to access the data.
+		GCI::GPUMemoryRegion bufferRegion;
+
+		explicit operator bool() const noexcept
+		{
+			return dataPtr != nullptr;
+		}
+	};
+
+	/// @brief Linear, per-frame allocator of constant buffer data, backed by a single, large GPUBuffer.
+	/// The buffer is split into framesInFlightNum segments. Every frame allocates aligned slices from its
+	/// segment (a simple bump of the offset, so it is cheap enough to be used for per-object data) and the
+	/// slices are bound by offset instead of having a separate buffer for each object. Before a segment is
+	/// reused, BeginFrame() waits for the sync object submitted with the frame which used it last time.
+	/// If the device supports persistent mapping, the buffer stays mapped for its whole lifetime and data
+	/// is written straight into the GPU-visible memory. Otherwise, slices point to a CPU-side copy of the
+	/// segment and the written range is uploaded in FlushFrame().
+	class IC3_NXMAIN_CLASS ConstantBufferRingAllocator
+	{
+	public:
+		GCI::GPUDevice & mGPUDevice;
+
+	public:
+		ConstantBufferRingAllocator( GCI::GPUDevice & pGPUDevice );
+		~ConstantBufferRingAllocator();
+
+		/// @brief Creates the buffer and maps it (if possible). Returns false if the buffer could not be created.
+		bool Initialize( GCI::CommandContext & pCommandContext, const ConstantBufferRingAllocatorCreateInfo & pCreateInfo );
+
+		/// @brief Waits for all pending frames and releases the buffer.
+		void Release( GCI::CommandContext & pCommandContext );
+
+		/// @brief Moves to the next segment. Blocks if the GPU is still using it (i.e. the CPU is framesInFlightNum ahead).
+		void BeginFrame();
+
+		/// @brief Makes the data written in the current frame visible to the GPU. Must be called before the submission.
+		void FlushFrame( GCI::CommandContextDirectTransfer & pCommandContext );
+
+		/// @brief Completes the current frame. pFrameSync should be the sync of the submission which used its data.
+		void EndFrame( GCI::CommandSync pFrameSync );
+
+		/// @brief Allocates a slice of the specified size. Returns an empty allocation if the segment is exhausted.
+		CPPX_ATTR_NO_DISCARD ConstantBufferAllocation Allocate( GCI::gpu_memory_size_t pDataSize ) noexcept
+		{
+			const auto allocationOffset = _currentSegmentOffset + _currentSegmentAllocatedSize;
+			const auto allocationSize = ( pDataSize + _allocationAlignment - 1 ) & ~static_cast<GCI::gpu_memory_size_t>( _allocationAlignment - 1 );
+
+			if( ( allocationSize > _frameSegmentSize - _currentSegmentAllocatedSize ) || !_mappedMemoryPtr )
+			{
+				return {};
+			}
+
+			_currentSegmentAllocatedSize += allocationSize;
+
+			ConstantBufferAllocation allocation;
+			allocation.buffer = _buffer.get();
+			allocation.dataPtr = _mappedMemoryPtr + allocationOffset;
+			allocation.bufferRegion.offset = allocationOffset;
+			allocation.bufferRegion.size = pDataSize;
+
+			return allocation;
+		}
+
+		template <typename TData>
+		CPPX_ATTR_NO_DISCARD ConstantBufferAllocation Allocate() noexcept
+		{
+			return Allocate( sizeof( TData ) );
+		}
+
+		CPPX_ATTR_NO_DISCARD GCI::GPUBufferHandle GetBuffer() const noexcept
+		{
+			return _buffer;
+		}
+
+		/// @brief Returns the number of bytes (including the alignment padding) allocated in the current frame.
+		CPPX_ATTR_NO_DISCARD GCI::gpu_memory_size_t GetCurrentFrameAllocatedSize() const noexcept
+		{
+			return _currentSegmentAllocatedSize;
+		}
+
+		/// @brief Returns the largest number of bytes allocated in a single frame since the initialization.
+		CPPX_ATTR_NO_DISCARD GCI::gpu_memory_size_t GetPeakFrameAllocatedSize() const noexcept
+		{
+			return std::max( _peakSegmentAllocatedSize, _currentSegmentAllocatedSize );
+		}
+
+		CPPX_ATTR_NO_DISCARD bool IsPersistentlyMapped() const noexcept
+		{
+			return _mappedMemoryPtr && _stagingMemory.empty();
+		}
+
+	private:
+		GCI::GPUBufferHandle _buffer;
+		byte * _mappedMemoryPtr = nullptr;
+		std::vector<byte> _stagingMemory;
+		std::vector<GCI::CommandSync> _segmentSyncArray;
+		GCI::gpu_memory_size_t _frameSegmentSize = 0;
+		GCI::gpu_memory_size_t _currentSegmentOffset = 0;
+		GCI::gpu_memory_size_t _currentSegmentAllocatedSize = 0;
+		GCI::gpu_memory_size_t _peakSegmentAllocatedSize = 0;
+		uint32 _currentSegmentIndex = 0;
+		uint32 _allocationAlignment = kConstantBufferRingDefaultAlignment;
+		bool _coherentMemory = false;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_CONSTANT_BUFFER_RING_ALLOCATOR_H__
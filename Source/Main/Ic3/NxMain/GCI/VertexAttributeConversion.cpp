@@ -0,0 +1,656 @@
+
+#include "VertexAttributeConversion.h"
+
+namespace Ic3
+{
+
+	namespace GCIUtils
+	{
+
+		/// Number of elements processed at once when source and/or target stream is interleaved.
+		/// Chunk buffers are placed on the stack, so this has to be reasonably small.
+		static constexpr uint32 kConversionChunkElementsNum = 256;
+
+		/// Max number of components handled by the conversion (Vec4).
+		static constexpr uint32 kConversionMaxComponentsNum = 4;
+
+		template <uint32 tpElementSize>
+		static void CopyStridedElements( byte * pTarget, uint32 pTargetStride, const byte * pSource, uint32 pSourceStride, uint32 pElementsNum )
+		{
+			for( uint32 elementIndex = 0; elementIndex < pElementsNum; ++elementIndex )
+			{
+				std::memcpy( pTarget + elementIndex * pTargetStride, pSource + elementIndex * pSourceStride, tpElementSize );
+			}
+		}
+
+		/// Gathers/scatters elements between packed and strided memory. The per-element copy is the main cost
+		/// of converting interleaved streams, so common element sizes use a fixed-size (inlined) memcpy.
+		static void CopyStridedElements( byte * pTarget, uint32 pTargetStride, const byte * pSource, uint32 pSourceStride, uint32 pElementSize, uint32 pElementsNum )
+		{
+			switch( pElementSize )
+			{
+				case 2  : CopyStridedElements<2>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				case 4  : CopyStridedElements<4>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				case 6  : CopyStridedElements<6>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				case 8  : CopyStridedElements<8>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				case 12 : CopyStridedElements<12>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				case 16 : CopyStridedElements<16>( pTarget, pTargetStride, pSource, pSourceStride, pElementsNum ); break;
+				default:
+				{
+					for( uint32 elementIndex = 0; elementIndex < pElementsNum; ++elementIndex )
+					{
+						std::memcpy( pTarget + elementIndex * pTargetStride, pSource + elementIndex * pSourceStride, pElementSize );
+					}
+					break;
+				}
+			}
+		}
+
+		template <typename TPInput, typename TPOutput>
+		static void ConvertValuesNumericCast( const void * pInput, void * pOutput, size_t pValuesNum )
+		{
+			const auto * inputValues = reinterpret_cast<const TPInput *>( pInput );
+			auto * outputValues = reinterpret_cast<TPOutput *>( pOutput );
+
+			for( size_t valueIndex = 0; valueIndex < pValuesNum; ++valueIndex )
+			{
+				outputValues[valueIndex] = cppx::numeric_cast<TPOutput>( inputValues[valueIndex] );
+			}
+		}
+
+		template <typename TPInput>
+		static bool ConvertValuesNumericCastTo( GCI::EBaseDataType pOutputType, const void * pInput, void * pOutput, size_t pValuesNum )
+		{
+			switch( pOutputType )
+			{
+				case GCI::EBaseDataType::Byte    : ConvertValuesNumericCast<TPInput, int8>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Ubyte   : ConvertValuesNumericCast<TPInput, uint8>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Int16   : ConvertValuesNumericCast<TPInput, int16>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Uint16  : ConvertValuesNumericCast<TPInput, uint16>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Int32   : ConvertValuesNumericCast<TPInput, int32>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Uint32  : ConvertValuesNumericCast<TPInput, uint32>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Float32 : ConvertValuesNumericCast<TPInput, float>( pInput, pOutput, pValuesNum ); return true;
+				case GCI::EBaseDataType::Double  : ConvertValuesNumericCast<TPInput, double>( pInput, pOutput, pValuesNum ); return true;
+				default: break;
+			}
+			return false;
+		}
+
+		static bool ConvertValuesNumericCast( GCI::EBaseDataType pInputType, GCI::EBaseDataType pOutputType, const void * pInput, void * pOutput, size_t pValuesNum )
+		{
+			switch( pInputType )
+			{
+				case GCI::EBaseDataType::Byte    : return ConvertValuesNumericCastTo<int8>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Ubyte   : return ConvertValuesNumericCastTo<uint8>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Int16   : return ConvertValuesNumericCastTo<int16>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Uint16  : return ConvertValuesNumericCastTo<uint16>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Int32   : return ConvertValuesNumericCastTo<int32>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Uint32  : return ConvertValuesNumericCastTo<uint32>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Float32 : return ConvertValuesNumericCastTo<float>( pOutputType, pInput, pOutput, pValuesNum );
+				case GCI::EBaseDataType::Double  : return ConvertValuesNumericCastTo<double>( pOutputType, pInput, pOutput, pValuesNum );
+				default: break;
+			}
+			return false;
+		}
+
+		// SIMD kernels below operate on tightly packed arrays of components. Every kernel handles the remainder
+		// with the scalar helpers from the header, which produce bit-identical results.
+
+	#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+
+		/// Rounds (using the current rounding mode, i.e. to nearest-even), clamps and converts to int32.
+		PCL_ATTR_ALWAYS_INLINE __m128i _mm_encode_normalized_128f( __m128 pValues, __m128 pMin, __m128 pScale )
+		{
+			const __m128 clampedValues = _mm_min_ps( _mm_max_ps( pValues, pMin ), _mm_set1_ps( 1.0f ) );
+			return _mm_cvtps_epi32( _mm_mul_ps( clampedValues, pScale ) );
+		}
+
+		/// SSE2 version of EncodeFloat16(). Result is in the low 16 bits of each 32-bit lane (sign-extended).
+		PCL_ATTR_ALWAYS_INLINE __m128i _mm_encode_float16_128f( __m128 pValues )
+		{
+			const __m128i signMask = _mm_set1_epi32( 0x80000000 );
+			const __m128i f16MaxBits = _mm_set1_epi32( ( 127 + 16 ) << 23 );
+			const __m128i minNormalBits = _mm_set1_epi32( 113 << 23 );
+			const __m128i subnormalMagicBits = _mm_set1_epi32( ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 );
+			const __m128i normalBias = _mm_set1_epi32( 0xFFF + ( ( 15 - 127 ) * ( 1 << 23 ) ) );
+
+			const __m128i valueBits = _mm_castps_si128( pValues );
+			const __m128i signBits = _mm_and_si128( valueBits, signMask );
+			const __m128i absBits = _mm_xor_si128( valueBits, signBits );
+
+			// Infinity/NaN/overflow.
+			const __m128i isNaN = _mm_cmpgt_epi32( absBits, _mm_set1_epi32( 255 << 23 ) );
+			const __m128i specialResult = _mm_or_si128( _mm_set1_epi32( 0x7C00 ), _mm_and_si128( isNaN, _mm_set1_epi32( 0x0200 ) ) );
+
+			// Subnormal/zero.
+			const __m128 subnormalSum = _mm_add_ps( _mm_castsi128_ps( absBits ), _mm_castsi128_ps( subnormalMagicBits ) );
+			const __m128i subnormalResult = _mm_sub_epi32( _mm_castps_si128( subnormalSum ), subnormalMagicBits );
+
+			// Regular values: rounding bias + the mantissa odd bit (round-to-nearest-even).
+			const __m128i mantissaOddBit = _mm_and_si128( _mm_srli_epi32( absBits, 13 ), _mm_set1_epi32( 1 ) );
+			const __m128i normalRounded = _mm_add_epi32( _mm_add_epi32( absBits, normalBias ), mantissaOddBit );
+			const __m128i normalResult = _mm_srli_epi32( normalRounded, 13 );
+
+			const __m128i isSubnormal = _mm_cmplt_epi32( absBits, minNormalBits );
+			const __m128i isRegular = _mm_cmplt_epi32( absBits, f16MaxBits );
+			const __m128i regularResult = _mm_or_si128( _mm_and_si128( isSubnormal, subnormalResult ), _mm_andnot_si128( isSubnormal, normalResult ) );
+			const __m128i result = _mm_or_si128( _mm_and_si128( isRegular, regularResult ), _mm_andnot_si128( isRegular, specialResult ) );
+
+			// Arithmetic shift, so that _mm_packs_epi32() keeps the low 16 bits unchanged.
+			return _mm_or_si128( result, _mm_srai_epi32( signBits, 16 ) );
+		}
+
+		/// Converts 4 vec3 (12 consecutive floats) into SoA form.
+		PCL_ATTR_ALWAYS_INLINE void _mm_deinterleave_vec3_128f( const float * pInput, __m128 & pX, __m128 & pY, __m128 & pZ )
+		{
+			// a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+			const __m128 a = _mm_loadu_ps( pInput );
+			const __m128 b = _mm_loadu_ps( pInput + 4 );
+			const __m128 c = _mm_loadu_ps( pInput + 8 );
+
+			const __m128 x23 = _mm_shuffle_ps( b, c, _MM_SHUFFLE_R( 2, 2, 1, 1 ) );
+			pX = _mm_shuffle_ps( a, x23, _MM_SHUFFLE_R( 0, 3, 0, 2 ) );
+
+			const __m128 y01 = _mm_shuffle_ps( a, b, _MM_SHUFFLE_R( 1, 1, 0, 0 ) );
+			const __m128 y23 = _mm_shuffle_ps( b, c, _MM_SHUFFLE_R( 3, 3, 2, 2 ) );
+			pY = _mm_shuffle_ps( y01, y23, _MM_SHUFFLE_R( 0, 2, 0, 2 ) );
+
+			const __m128 z01 = _mm_shuffle_ps( a, b, _MM_SHUFFLE_R( 2, 2, 1, 1 ) );
+			const __m128 z23 = _mm_shuffle_ps( c, c, _MM_SHUFFLE_R( 0, 0, 3, 3 ) );
+			pZ = _mm_shuffle_ps( z01, z23, _MM_SHUFFLE_R( 0, 2, 0, 2 ) );
+		}
+
+		PCL_ATTR_ALWAYS_INLINE __m128 _mm_abs_ps_128f( __m128 pValues )
+		{
+			return _mm_andnot_ps( _mm_set1_ps( -0.0f ), pValues );
+		}
+
+		/// Returns 1.0 for values >= 0 and -1.0 otherwise.
+		PCL_ATTR_ALWAYS_INLINE __m128 _mm_sign_not_zero_128f( __m128 pValues )
+		{
+			const __m128 isNonNegative = _mm_cmpge_ps( pValues, _mm_setzero_ps() );
+			return _mm_or_ps( _mm_and_ps( isNonNegative, _mm_set1_ps( 1.0f ) ), _mm_andnot_ps( isNonNegative, _mm_set1_ps( -1.0f ) ) );
+		}
+
+	#endif // PCL_EIS_FEATURE_SSE2
+
+		static void ConvertValuesFloat32ToFloat16( const float * pInput, uint16 * pOutput, size_t pValuesNum )
+		{
+			size_t valueIndex = 0;
+
+		#if defined( __F16C__ )
+			for( ; valueIndex + 8 <= pValuesNum; valueIndex += 8 )
+			{
+				const __m128i halves = _mm256_cvtps_ph( _mm256_loadu_ps( pInput + valueIndex ), _MM_FROUND_TO_NEAREST_INT );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + valueIndex ), halves );
+			}
+		#elif( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			for( ; valueIndex + 8 <= pValuesNum; valueIndex += 8 )
+			{
+				const __m128i halves0 = _mm_encode_float16_128f( _mm_loadu_ps( pInput + valueIndex ) );
+				const __m128i halves1 = _mm_encode_float16_128f( _mm_loadu_ps( pInput + valueIndex + 4 ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + valueIndex ), _mm_packs_epi32( halves0, halves1 ) );
+			}
+		#endif
+
+			for( ; valueIndex < pValuesNum; ++valueIndex )
+			{
+				pOutput[valueIndex] = EncodeFloat16( pInput[valueIndex] );
+			}
+		}
+
+		static void ConvertValuesFloat32ToNorm16( const float * pInput, uint16 * pOutput, size_t pValuesNum, bool pSigned )
+		{
+			const auto minValue = pSigned ? -1.0f : 0.0f;
+			const auto scale = pSigned ? 32767.0f : 65535.0f;
+
+			size_t valueIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			const __m128 minValue128 = _mm_set1_ps( minValue );
+			const __m128 scale128 = _mm_set1_ps( scale );
+
+			// There is no unsigned saturating 32->16 pack in SSE2: unsigned values are biased to the signed range.
+			const __m128i packBias = pSigned ? _mm_setzero_si128() : _mm_set1_epi32( 32768 );
+			const __m128i packBias16 = pSigned ? _mm_setzero_si128() : _mm_set1_epi16( -32768 );
+
+			for( ; valueIndex + 8 <= pValuesNum; valueIndex += 8 )
+			{
+				const __m128i encoded0 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex ), minValue128, scale128 );
+				const __m128i encoded1 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex + 4 ), minValue128, scale128 );
+				const __m128i packed = _mm_packs_epi32( _mm_sub_epi32( encoded0, packBias ), _mm_sub_epi32( encoded1, packBias ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + valueIndex ), _mm_xor_si128( packed, packBias16 ) );
+			}
+		#endif
+
+			for( ; valueIndex < pValuesNum; ++valueIndex )
+			{
+				pOutput[valueIndex] = static_cast<uint16>( EncodeNormalizedValue( pInput[valueIndex], minValue, scale ) );
+			}
+		}
+
+		static void ConvertValuesFloat32ToNorm8( const float * pInput, uint8 * pOutput, size_t pValuesNum, bool pSigned )
+		{
+			const auto minValue = pSigned ? -1.0f : 0.0f;
+			const auto scale = pSigned ? 127.0f : 255.0f;
+
+			size_t valueIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			const __m128 minValue128 = _mm_set1_ps( minValue );
+			const __m128 scale128 = _mm_set1_ps( scale );
+
+			for( ; valueIndex + 16 <= pValuesNum; valueIndex += 16 )
+			{
+				const __m128i encoded0 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex ), minValue128, scale128 );
+				const __m128i encoded1 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex + 4 ), minValue128, scale128 );
+				const __m128i encoded2 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex + 8 ), minValue128, scale128 );
+				const __m128i encoded3 = _mm_encode_normalized_128f( _mm_loadu_ps( pInput + valueIndex + 12 ), minValue128, scale128 );
+
+				// Values are already in the 8-bit range, so the saturating packs do not modify them.
+				const __m128i packed01 = _mm_packs_epi32( encoded0, encoded1 );
+				const __m128i packed23 = _mm_packs_epi32( encoded2, encoded3 );
+				const __m128i packed = pSigned ? _mm_packs_epi16( packed01, packed23 ) : _mm_packus_epi16( packed01, packed23 );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + valueIndex ), packed );
+			}
+		#endif
+
+			for( ; valueIndex < pValuesNum; ++valueIndex )
+			{
+				pOutput[valueIndex] = static_cast<uint8>( EncodeNormalizedValue( pInput[valueIndex], minValue, scale ) );
+			}
+		}
+
+		static void ConvertValuesFloat64ToFloat32( const double * pInput, float * pOutput, size_t pValuesNum )
+		{
+			size_t valueIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			for( ; valueIndex + 4 <= pValuesNum; valueIndex += 4 )
+			{
+				const __m128 values01 = _mm_cvtpd_ps( _mm_loadu_pd( pInput + valueIndex ) );
+				const __m128 values23 = _mm_cvtpd_ps( _mm_loadu_pd( pInput + valueIndex + 2 ) );
+				_mm_storeu_ps( pOutput + valueIndex, _mm_movelh_ps( values01, values23 ) );
+			}
+		#endif
+
+			for( ; valueIndex < pValuesNum; ++valueIndex )
+			{
+				pOutput[valueIndex] = static_cast<float>( pInput[valueIndex] );
+			}
+		}
+
+		static void EncodeUnitVectorsSNorm1010102( const float * pInput, uint32 pInputComponentsNum, uint32 * pOutput, size_t pVectorsNum )
+		{
+			size_t vectorIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			const __m128 minValue = _mm_set1_ps( -1.0f );
+			const __m128 scaleXYZ = _mm_set1_ps( 511.0f );
+			const __m128 scaleW = _mm_set1_ps( 1.0f );
+			const __m128i maskXYZ = _mm_set1_epi32( 0x3FF );
+
+			for( ; vectorIndex + 4 <= pVectorsNum; vectorIndex += 4 )
+			{
+				__m128 x, y, z, w;
+				if( pInputComponentsNum == 4 )
+				{
+					x = _mm_loadu_ps( pInput + vectorIndex * 4 );
+					y = _mm_loadu_ps( pInput + vectorIndex * 4 + 4 );
+					z = _mm_loadu_ps( pInput + vectorIndex * 4 + 8 );
+					w = _mm_loadu_ps( pInput + vectorIndex * 4 + 12 );
+					_MM_TRANSPOSE4_PS( x, y, z, w );
+				}
+				else
+				{
+					_mm_deinterleave_vec3_128f( pInput + vectorIndex * 3, x, y, z );
+					w = _mm_setzero_ps();
+				}
+
+				const __m128i encodedX = _mm_and_si128( _mm_encode_normalized_128f( x, minValue, scaleXYZ ), maskXYZ );
+				const __m128i encodedY = _mm_and_si128( _mm_encode_normalized_128f( y, minValue, scaleXYZ ), maskXYZ );
+				const __m128i encodedZ = _mm_and_si128( _mm_encode_normalized_128f( z, minValue, scaleXYZ ), maskXYZ );
+				const __m128i encodedW = _mm_encode_normalized_128f( w, minValue, scaleW );
+
+				const __m128i packedXY = _mm_or_si128( encodedX, _mm_slli_epi32( encodedY, 10 ) );
+				const __m128i packedZW = _mm_or_si128( _mm_slli_epi32( encodedZ, 20 ), _mm_slli_epi32( encodedW, 30 ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + vectorIndex ), _mm_or_si128( packedXY, packedZW ) );
+			}
+		#endif
+
+			for( ; vectorIndex < pVectorsNum; ++vectorIndex )
+			{
+				const auto * inputVector = pInput + vectorIndex * pInputComponentsNum;
+				const auto inputW = ( pInputComponentsNum == 4 ) ? inputVector[3] : 0.0f;
+				pOutput[vectorIndex] = EncodeUnitVectorSNorm1010102( inputVector[0], inputVector[1], inputVector[2], inputW );
+			}
+		}
+
+		static void EncodeUnitVectorsOctahedralSNorm16( const float * pInput, int16 * pOutput, size_t pVectorsNum )
+		{
+			size_t vectorIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			const __m128 minValue = _mm_set1_ps( -1.0f );
+			const __m128 scale = _mm_set1_ps( 32767.0f );
+			const __m128 one = _mm_set1_ps( 1.0f );
+			const __m128 zero = _mm_setzero_ps();
+
+			for( ; vectorIndex + 4 <= pVectorsNum; vectorIndex += 4 )
+			{
+				__m128 x, y, z;
+				_mm_deinterleave_vec3_128f( pInput + vectorIndex * 3, x, y, z );
+
+				const __m128 absSum = _mm_add_ps( _mm_add_ps( _mm_abs_ps_128f( x ), _mm_abs_ps_128f( y ) ), _mm_abs_ps_128f( z ) );
+				const __m128 oneOverAbsSum = _mm_and_ps( _mm_cmpgt_ps( absSum, zero ), _mm_div_ps( one, absSum ) );
+				const __m128 octX = _mm_mul_ps( x, oneOverAbsSum );
+				const __m128 octY = _mm_mul_ps( y, oneOverAbsSum );
+				const __m128 octZ = _mm_mul_ps( z, oneOverAbsSum );
+
+				const __m128 foldedU = _mm_mul_ps( _mm_sub_ps( one, _mm_abs_ps_128f( octY ) ), _mm_sign_not_zero_128f( octX ) );
+				const __m128 foldedV = _mm_mul_ps( _mm_sub_ps( one, _mm_abs_ps_128f( octX ) ), _mm_sign_not_zero_128f( octY ) );
+				const __m128 isLowerHemisphere = _mm_cmplt_ps( octZ, zero );
+				const __m128 u = _mm_or_ps( _mm_and_ps( isLowerHemisphere, foldedU ), _mm_andnot_ps( isLowerHemisphere, octX ) );
+				const __m128 v = _mm_or_ps( _mm_and_ps( isLowerHemisphere, foldedV ), _mm_andnot_ps( isLowerHemisphere, octY ) );
+
+				const __m128i encodedU = _mm_encode_normalized_128f( u, minValue, scale );
+				const __m128i encodedV = _mm_encode_normalized_128f( v, minValue, scale );
+
+				// Interleave before packing to get u0 v0 u1 v1 ...
+				const __m128i encodedUV01 = _mm_unpacklo_epi32( encodedU, encodedV );
+				const __m128i encodedUV23 = _mm_unpackhi_epi32( encodedU, encodedV );
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pOutput + vectorIndex * 2 ), _mm_packs_epi32( encodedUV01, encodedUV23 ) );
+			}
+		#endif
+
+			for( ; vectorIndex < pVectorsNum; ++vectorIndex )
+			{
+				const auto * inputVector = pInput + vectorIndex * 3;
+
+				float octU, octV;
+				EncodeUnitVectorOctahedral( inputVector[0], inputVector[1], inputVector[2], octU, octV );
+
+				pOutput[vectorIndex * 2] = static_cast<int16>( EncodeNormalizedValue( octU, -1.0f, 32767.0f ) );
+				pOutput[vectorIndex * 2 + 1] = static_cast<int16>( EncodeNormalizedValue( octV, -1.0f, 32767.0f ) );
+			}
+		}
+
+		/// Returns the number of source components consumed by a single element.
+		static uint32 GetConversionInputComponentsNum( const VertexAttributeConversionDesc & pConversionDesc )
+		{
+			switch( pConversionDesc.encoding )
+			{
+				case EVertexAttributeEncoding::UnitVectorToSNorm1010102:
+					return ( pConversionDesc.sourceComponentsNum >= 4 ) ? 4 : 3;
+
+				case EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16:
+					return 3;
+
+				default:
+					return std::min( pConversionDesc.sourceComponentsNum, pConversionDesc.targetComponentsNum );
+			}
+		}
+
+		/// Returns the size, in bytes, of a single converted element (which may be smaller than the target attribute).
+		static uint32 GetConversionOutputElementSize( const VertexAttributeConversionDesc & pConversionDesc )
+		{
+			switch( pConversionDesc.encoding )
+			{
+				case EVertexAttributeEncoding::UnitVectorToSNorm1010102:
+					return sizeof( uint32 );
+
+				case EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16:
+					return sizeof( int16 ) * 2;
+
+				default:
+					return GCI::CXU::GetBaseDataTypeByteSize( pConversionDesc.targetDataType ) * GetConversionInputComponentsNum( pConversionDesc );
+			}
+		}
+
+		/// Converts pElementsNum elements from a tightly packed input to a tightly packed output.
+		static bool ConvertPackedElements(
+				const VertexAttributeConversionDesc & pConversionDesc,
+				uint32 pComponentsNum,
+				const void * pInput,
+				void * pOutput,
+				size_t pElementsNum )
+		{
+			const auto valuesNum = pElementsNum * pComponentsNum;
+
+			switch( pConversionDesc.encoding )
+			{
+				case EVertexAttributeEncoding::Copy:
+				{
+					std::memcpy( pOutput, pInput, valuesNum * GCI::CXU::GetBaseDataTypeByteSize( pConversionDesc.sourceDataType ) );
+					return true;
+				}
+				case EVertexAttributeEncoding::NumericCast:
+				{
+					return ConvertValuesNumericCast( pConversionDesc.sourceDataType, pConversionDesc.targetDataType, pInput, pOutput, valuesNum );
+				}
+				case EVertexAttributeEncoding::Float32ToFloat16:
+				{
+					ConvertValuesFloat32ToFloat16( reinterpret_cast<const float *>( pInput ), reinterpret_cast<uint16 *>( pOutput ), valuesNum );
+					return true;
+				}
+				case EVertexAttributeEncoding::Float32ToSNorm8:
+				case EVertexAttributeEncoding::Float32ToUNorm8:
+				{
+					const auto isSigned = pConversionDesc.encoding == EVertexAttributeEncoding::Float32ToSNorm8;
+					ConvertValuesFloat32ToNorm8( reinterpret_cast<const float *>( pInput ), reinterpret_cast<uint8 *>( pOutput ), valuesNum, isSigned );
+					return true;
+				}
+				case EVertexAttributeEncoding::Float32ToSNorm16:
+				case EVertexAttributeEncoding::Float32ToUNorm16:
+				{
+					const auto isSigned = pConversionDesc.encoding == EVertexAttributeEncoding::Float32ToSNorm16;
+					ConvertValuesFloat32ToNorm16( reinterpret_cast<const float *>( pInput ), reinterpret_cast<uint16 *>( pOutput ), valuesNum, isSigned );
+					return true;
+				}
+				case EVertexAttributeEncoding::Float64ToFloat32:
+				{
+					ConvertValuesFloat64ToFloat32( reinterpret_cast<const double *>( pInput ), reinterpret_cast<float *>( pOutput ), valuesNum );
+					return true;
+				}
+				case EVertexAttributeEncoding::UnitVectorToSNorm1010102:
+				{
+					EncodeUnitVectorsSNorm1010102( reinterpret_cast<const float *>( pInput ), pComponentsNum, reinterpret_cast<uint32 *>( pOutput ), pElementsNum );
+					return true;
+				}
+				case EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16:
+				{
+					EncodeUnitVectorsOctahedralSNorm16( reinterpret_cast<const float *>( pInput ), reinterpret_cast<int16 *>( pOutput ), pElementsNum );
+					return true;
+				}
+				default:
+				{
+					break;
+				}
+			}
+
+			return false;
+		}
+
+		VertexAttributeConversionDesc ResolveVertexAttributeConversion(
+				GCI::EBaseDataType pSourceDataType,
+				uint32 pSourceComponentsNum,
+				const GenericVertexInputAttribute & pTargetAttribute )
+		{
+			VertexAttributeConversionDesc conversionDesc{};
+
+			if( !pTargetAttribute.IsActive() || ( pSourceComponentsNum == 0 ) || ( pSourceComponentsNum > kConversionMaxComponentsNum ) )
+			{
+				return conversionDesc;
+			}
+
+			const auto targetDataType = GCI::CXU::GetVertexAttribFormatBaseDataType( pTargetAttribute.dataFormat );
+			const auto targetComponentsNum = GCI::CXU::GetVertexAttribFormatComponentsNum( pTargetAttribute.dataFormat );
+			const auto targetNormalized = GCI::CXU::GetVertexAttribFormatFlags( pTargetAttribute.dataFormat ).is_set( GCI::eGPUDataFormatFlagNormalizedBit );
+
+			conversionDesc.sourceDataType = pSourceDataType;
+			conversionDesc.targetDataType = targetDataType;
+			conversionDesc.sourceComponentsNum = cppx::numeric_cast<uint8>( pSourceComponentsNum );
+			conversionDesc.targetComponentsNum = targetComponentsNum;
+
+			const auto isUnitVectorAttribute = pTargetAttribute.semanticFlags.is_set_any_of(
+					eVertexAttributeSemanticFlagNormalBit | eVertexAttributeSemanticFlagTangentBit | eVertexAttributeSemanticFlagBiTangentBit );
+
+			if( pSourceDataType == GCI::EBaseDataType::Float32 )
+			{
+				if( isUnitVectorAttribute && ( pSourceComponentsNum >= 3 ) )
+				{
+					if( pTargetAttribute.dataFormat == GCI::EVertexAttribFormat::Vec2I16N )
+					{
+						conversionDesc.encoding = EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16;
+						return conversionDesc;
+					}
+					if( pTargetAttribute.dataFormat == GCI::EVertexAttribFormat::U32 )
+					{
+						conversionDesc.encoding = EVertexAttributeEncoding::UnitVectorToSNorm1010102;
+						return conversionDesc;
+					}
+				}
+
+				if( targetNormalized )
+				{
+					switch( targetDataType )
+					{
+						case GCI::EBaseDataType::Byte   : conversionDesc.encoding = EVertexAttributeEncoding::Float32ToSNorm8; break;
+						case GCI::EBaseDataType::Ubyte  : conversionDesc.encoding = EVertexAttributeEncoding::Float32ToUNorm8; break;
+						case GCI::EBaseDataType::Int16  : conversionDesc.encoding = EVertexAttributeEncoding::Float32ToSNorm16; break;
+						case GCI::EBaseDataType::Uint16 : conversionDesc.encoding = EVertexAttributeEncoding::Float32ToUNorm16; break;
+						default: break;
+					}
+					return conversionDesc;
+				}
+
+				if( targetDataType == GCI::EBaseDataType::Float16 )
+				{
+					conversionDesc.encoding = EVertexAttributeEncoding::Float32ToFloat16;
+					return conversionDesc;
+				}
+			}
+
+			if( ( pSourceDataType == GCI::EBaseDataType::Double ) && ( targetDataType == GCI::EBaseDataType::Float32 ) )
+			{
+				conversionDesc.encoding = EVertexAttributeEncoding::Float64ToFloat32;
+			}
+			else if( pSourceDataType == targetDataType )
+			{
+				conversionDesc.encoding = EVertexAttributeEncoding::Copy;
+			}
+			else if( !targetNormalized && ( targetDataType != GCI::EBaseDataType::Float16 ) && ( pSourceDataType != GCI::EBaseDataType::Float16 ) )
+			{
+				conversionDesc.encoding = EVertexAttributeEncoding::NumericCast;
+			}
+
+			return conversionDesc;
+		}
+
+		bool ConvertVertexAttributeStream(
+				const VertexAttributeConversionDesc & pConversionDesc,
+				const VertexAttributeStreamRefReadOnly & pSource,
+				const VertexAttributeStreamRefReadWrite & pTarget,
+				uint32 pElementsNum )
+		{
+			if( !pConversionDesc || !pSource || !pTarget )
+			{
+				return false;
+			}
+
+			const auto sourceComponentSize = GCI::CXU::GetBaseDataTypeByteSize( pConversionDesc.sourceDataType );
+			const auto inputComponentsNum = GetConversionInputComponentsNum( pConversionDesc );
+			const auto inputElementSize = sourceComponentSize * inputComponentsNum;
+			const auto outputElementSize = GetConversionOutputElementSize( pConversionDesc );
+			const auto targetElementSize = GCI::CXU::GetBaseDataTypeByteSize( pConversionDesc.targetDataType ) * pConversionDesc.targetComponentsNum;
+
+			if( ( inputElementSize > pSource.strideInBytes ) || ( targetElementSize > pTarget.strideInBytes ) || ( outputElementSize > targetElementSize ) )
+			{
+				return false;
+			}
+
+			const auto isSourcePacked = ( pSource.strideInBytes == inputElementSize );
+			const auto isTargetPacked = ( pTarget.strideInBytes == outputElementSize );
+
+			if( isSourcePacked && isTargetPacked )
+			{
+				// Common case for de-interleaved streams: a single pass over the whole data.
+				return ConvertPackedElements( pConversionDesc, inputComponentsNum, pSource.basePtr, pTarget.basePtr, pElementsNum );
+			}
+
+			// Interleaved data: gather a chunk into a packed buffer, convert it and scatter results to the target.
+			// Buffers are 8-byte aligned, which is enough for all source types (including double).
+			uint64 inputChunkBuffer[kConversionChunkElementsNum * kConversionMaxComponentsNum];
+			uint64 outputChunkBuffer[kConversionChunkElementsNum * kConversionMaxComponentsNum];
+
+			for( uint32 chunkBaseIndex = 0; chunkBaseIndex < pElementsNum; chunkBaseIndex += kConversionChunkElementsNum )
+			{
+				const auto chunkElementsNum = std::min( pElementsNum - chunkBaseIndex, kConversionChunkElementsNum );
+
+				const auto * chunkInputPtr = pSource.basePtr + chunkBaseIndex * pSource.strideInBytes;
+				auto * chunkOutputPtr = pTarget.basePtr + chunkBaseIndex * pTarget.strideInBytes;
+
+				const void * packedInput = chunkInputPtr;
+				if( !isSourcePacked )
+				{
+					CopyStridedElements(
+							reinterpret_cast<byte *>( inputChunkBuffer ), inputElementSize,
+							chunkInputPtr, pSource.strideInBytes,
+							inputElementSize, chunkElementsNum );
+					packedInput = inputChunkBuffer;
+				}
+
+				void * packedOutput = isTargetPacked ? static_cast<void *>( chunkOutputPtr ) : static_cast<void *>( outputChunkBuffer );
+				if( !ConvertPackedElements( pConversionDesc, inputComponentsNum, packedInput, packedOutput, chunkElementsNum ) )
+				{
+					return false;
+				}
+
+				if( !isTargetPacked )
+				{
+					CopyStridedElements(
+							chunkOutputPtr, pTarget.strideInBytes,
+							reinterpret_cast<const byte *>( outputChunkBuffer ), outputElementSize,
+							outputElementSize, chunkElementsNum );
+
+					if( targetElementSize > outputElementSize )
+					{
+						for( uint32 elementIndex = 0; elementIndex < chunkElementsNum; ++elementIndex )
+						{
+							auto * targetElementPtr = chunkOutputPtr + elementIndex * pTarget.strideInBytes;
+							std::memset( targetElementPtr + outputElementSize, 0, targetElementSize - outputElementSize );
+						}
+					}
+				}
+			}
+
+			return true;
+		}
+
+		bool ConvertVertexAttributeStream(
+				const VertexFormatSignature & pVertexFormat,
+				native_uint pAttributeSlot,
+				GCI::EBaseDataType pSourceDataType,
+				uint32 pSourceComponentsNum,
+				const VertexAttributeStreamRefReadOnly & pSource,
+				void * pTargetStreamBasePtr,
+				uint32 pElementsNum )
+		{
+			const auto * targetAttribute = pVertexFormat.GetAttribute( pAttributeSlot );
+			if( !targetAttribute || !targetAttribute->IsActive() || !pTargetStreamBasePtr )
+			{
+				return false;
+			}
+
+			const auto conversionDesc = ResolveVertexAttributeConversion( pSourceDataType, pSourceComponentsNum, *targetAttribute );
+
+			VertexAttributeStreamRefReadWrite targetStreamRef{};
+			targetStreamRef.basePtr = reinterpret_cast<byte *>( pTargetStreamBasePtr ) + targetAttribute->vertexStreamRelativeOffset;
+			targetStreamRef.strideInBytes = pVertexFormat.GetElementStrideForAttribute( pAttributeSlot );
+
+			return ConvertVertexAttributeStream( conversionDesc, pSource, targetStreamRef, pElementsNum );
+		}
+
+	}
+
+} // namespace Ic3
@@ -0,0 +1,210 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_VERTEX_ATTRIBUTE_CONVERSION_H__
+#define __IC3_NXMAIN_VERTEX_ATTRIBUTE_CONVERSION_H__
+
+#include "VertexFormatSignature.h"
+#include <cmath>
+#include <cstring>
+
+namespace Ic3
+{
+
+	/// @brief Describes how source attribute data is transformed when written into a vertex stream.
+	enum class EVertexAttributeEncoding : uint16
+	{
+		Undefined,
+
+		/// Raw copy, source and target components have the same type.
+		Copy,
+
+		/// Per-component numeric cast, without normalization (e.g. uint32 -> uint16 indices). Scalar only.
+		NumericCast,
+
+		/// float32 -> float16 (IEEE half, round-to-nearest-even).
+		Float32ToFloat16,
+
+		/// float32 -> normalized integers (values are clamped to [-1,1] or [0,1], then rounded to nearest).
+		Float32ToSNorm8,
+		Float32ToUNorm8,
+		Float32ToSNorm16,
+		Float32ToUNorm16,
+
+		/// float64 -> float32.
+		Float64ToFloat32,
+
+		/// Unit vector (3 or 4 float32 components) -> a single uint32 with signed-normalized x, y, z in 10 bits
+		/// each (bits 0-9, 10-19, 20-29) and w (e.g. tangent handedness, 0 for 3-component input) in bits 30-31.
+		UnitVectorToSNorm1010102,
+
+		/// Unit vector (3 float32 components) -> octahedral encoding stored as 2 x snorm16.
+		UnitVectorToOctahedralSNorm16,
+	};
+
+	/// @brief A strided view of an attribute stream (a single attribute of consecutive vertices).
+	template <typename TPByte>
+	struct VertexAttributeStreamRef
+	{
+		TPByte * basePtr = nullptr;
+
+		uint32 strideInBytes = 0;
+
+		explicit operator bool() const noexcept
+		{
+			return basePtr && ( strideInBytes > 0 );
+		}
+	};
+
+	using VertexAttributeStreamRefReadOnly = VertexAttributeStreamRef<const byte>;
+	using VertexAttributeStreamRefReadWrite = VertexAttributeStreamRef<byte>;
+
+	struct VertexAttributeConversionDesc
+	{
+		EVertexAttributeEncoding encoding = EVertexAttributeEncoding::Undefined;
+		GCI::EBaseDataType sourceDataType = GCI::EBaseDataType::Undefined;
+		GCI::EBaseDataType targetDataType = GCI::EBaseDataType::Undefined;
+		uint8 sourceComponentsNum = 0;
+		uint8 targetComponentsNum = 0;
+
+		explicit operator bool() const noexcept
+		{
+			return encoding != EVertexAttributeEncoding::Undefined;
+		}
+	};
+
+	namespace GCIUtils
+	{
+
+		/// @brief Selects the conversion required to write source data of the specified type into the target attribute.
+		/// Packed encodings are selected for normals/tangents/bi-tangents based on the target format: Vec2I16N gives
+		/// the octahedral encoding and U32 gives the 10:10:10:2 one (GCI has no packed vertex formats, so the shader
+		/// is expected to unpack those). Returns an empty desc if the conversion is not supported.
+		IC3_NXMAIN_API_NO_DISCARD VertexAttributeConversionDesc ResolveVertexAttributeConversion(
+				GCI::EBaseDataType pSourceDataType,
+				uint32 pSourceComponentsNum,
+				const GenericVertexInputAttribute & pTargetAttribute );
+
+		/// @brief Converts pElementsNum consecutive elements of a strided source stream into a strided target stream.
+		/// Tightly packed streams are converted in a single pass, interleaved ones are processed in small chunks, so
+		/// the SIMD kernels always operate on contiguous data. If the target has more components than the source,
+		/// the remaining ones are zeroed. Returns false if the conversion is not supported.
+		IC3_NXMAIN_API bool ConvertVertexAttributeStream(
+				const VertexAttributeConversionDesc & pConversionDesc,
+				const VertexAttributeStreamRefReadOnly & pSource,
+				const VertexAttributeStreamRefReadWrite & pTarget,
+				uint32 pElementsNum );
+
+		/// @brief Converts source data of a single attribute into the vertex stream described by pVertexFormat.
+		/// pTargetStreamBasePtr points to the first vertex of the stream the attribute is fetched from; the attribute
+		/// offset and the stream stride are taken from the format.
+		IC3_NXMAIN_API bool ConvertVertexAttributeStream(
+				const VertexFormatSignature & pVertexFormat,
+				native_uint pAttributeSlot,
+				GCI::EBaseDataType pSourceDataType,
+				uint32 pSourceComponentsNum,
+				const VertexAttributeStreamRefReadOnly & pSource,
+				void * pTargetStreamBasePtr,
+				uint32 pElementsNum );
+
+		/// @brief Scalar float32 -> float16 conversion (round-to-nearest-even, NaNs are mapped to a quiet NaN).
+		CPPX_ATTR_NO_DISCARD inline uint16 EncodeFloat16( float pValue ) noexcept
+		{
+			uint32 valueBits;
+			std::memcpy( &valueBits, &pValue, sizeof( float ) );
+
+			const uint32 signBits = ( valueBits >> 16 ) & 0x8000u;
+			valueBits &= 0x7FFFFFFFu;
+
+			uint32 resultBits;
+			if( valueBits >= ( ( 127u + 16u ) << 23 ) )
+			{
+				// Overflow (-> infinity), infinity or NaN.
+				resultBits = ( valueBits > ( 255u << 23 ) ) ? 0x7E00u : 0x7C00u;
+			}
+			else if( valueBits < ( 113u << 23 ) )
+			{
+				// Result is a subnormal or zero: let the FPU do the rounding by adding a magic number.
+				constexpr uint32 cSubnormalMagicBits = ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23;
+				float subnormalMagic;
+				std::memcpy( &subnormalMagic, &cSubnormalMagicBits, sizeof( float ) );
+
+				float absValue;
+				std::memcpy( &absValue, &valueBits, sizeof( float ) );
+				absValue += subnormalMagic;
+
+				std::memcpy( &resultBits, &absValue, sizeof( float ) );
+				resultBits -= cSubnormalMagicBits;
+			}
+			else
+			{
+				const uint32 mantissaOddBit = ( valueBits >> 13 ) & 1u;
+				valueBits += ( ( 15u - 127u ) << 23 ) + 0xFFFu;
+				valueBits += mantissaOddBit;
+				resultBits = valueBits >> 13;
+			}
+
+			return static_cast<uint16>( resultBits | signBits );
+		}
+
+		/// @brief Clamps the value to [pMin, pMax]. NaNs are mapped to pMin (the same way the SIMD kernels do it).
+		CPPX_ATTR_NO_DISCARD inline float ClampNormalizedValue( float pValue, float pMin, float pMax ) noexcept
+		{
+			const auto clampedMin = ( pValue > pMin ) ? pValue : pMin;
+			return ( clampedMin < pMax ) ? clampedMin : pMax;
+		}
+
+		/// @brief Converts a float into a normalized integer with the specified scale (e.g. 32767 for snorm16).
+		CPPX_ATTR_NO_DISCARD inline int32 EncodeNormalizedValue( float pValue, float pMin, float pScale ) noexcept
+		{
+			return static_cast<int32>( std::nearbyint( ClampNormalizedValue( pValue, pMin, 1.0f ) * pScale ) );
+		}
+
+		CPPX_ATTR_NO_DISCARD inline uint32 EncodeUnitVectorSNorm1010102( float pX, float pY, float pZ, float pW ) noexcept
+		{
+			const auto encodedX = static_cast<uint32>( EncodeNormalizedValue( pX, -1.0f, 511.0f ) ) & 0x3FFu;
+			const auto encodedY = static_cast<uint32>( EncodeNormalizedValue( pY, -1.0f, 511.0f ) ) & 0x3FFu;
+			const auto encodedZ = static_cast<uint32>( EncodeNormalizedValue( pZ, -1.0f, 511.0f ) ) & 0x3FFu;
+			const auto encodedW = static_cast<uint32>( EncodeNormalizedValue( pW, -1.0f, 1.0f ) ) & 0x3u;
+			return encodedX | ( encodedY << 10 ) | ( encodedZ << 20 ) | ( encodedW << 30 );
+		}
+
+		/// @brief Octahedral encoding of a unit vector. The result is a point in [-1,1]^2.
+		inline void EncodeUnitVectorOctahedral( float pX, float pY, float pZ, float & pOutU, float & pOutV ) noexcept
+		{
+			const auto absSum = ( std::abs( pX ) + std::abs( pY ) ) + std::abs( pZ );
+			const auto oneOverAbsSum = ( absSum > 0.0f ) ? ( 1.0f / absSum ) : 0.0f;
+			const auto octX = pX * oneOverAbsSum;
+			const auto octY = pY * oneOverAbsSum;
+			const auto octZ = pZ * oneOverAbsSum;
+
+			if( octZ < 0.0f )
+			{
+				// Lower hemisphere is folded over the diagonals.
+				pOutU = ( 1.0f - std::abs( octY ) ) * ( ( octX >= 0.0f ) ? 1.0f : -1.0f );
+				pOutV = ( 1.0f - std::abs( octX ) ) * ( ( octY >= 0.0f ) ? 1.0f : -1.0f );
+			}
+			else
+			{
+				pOutU = octX;
+				pOutV = octY;
+			}
+		}
+
+		/// @brief Inverse of EncodeUnitVectorOctahedral(). Returns a normalized vector.
+		CPPX_ATTR_NO_DISCARD inline cxm::vec3f DecodeUnitVectorOctahedral( float pU, float pV ) noexcept
+		{
+			cxm::vec3f result{ pU, pV, 1.0f - std::abs( pU ) - std::abs( pV ) };
+			if( result.z < 0.0f )
+			{
+				result.x = ( 1.0f - std::abs( pV ) ) * ( ( pU >= 0.0f ) ? 1.0f : -1.0f );
+				result.y = ( 1.0f - std::abs( pU ) ) * ( ( pV >= 0.0f ) ? 1.0f : -1.0f );
+			}
+			return cxm::normalize( result );
+		}
+
+	}
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_VERTEX_ATTRIBUTE_CONVERSION_H__
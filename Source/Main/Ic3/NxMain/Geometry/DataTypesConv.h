@@ -5,11 +5,15 @@
 #define __IC3_NXMAIN_DATA_TYPES_CONV_H__
 
 #include "GeometryCommonDefs.h"
+#include "../GCI/VertexAttributeConversion.h"
 #include <cxm/vector.h>
 
 namespace Ic3
 {
 
+	// Note: functions below convert a single element per call. For whole attribute streams (mesh import),
+	// use GCIUtils::ConvertVertexAttributeStream(), which converts data in bulk using SIMD kernels.
+
 	using DataTypeConversionFunction = std::function<void( const void *, void *, uint32 )>;
 
 	template <typename TPInput, typename TPOutput>
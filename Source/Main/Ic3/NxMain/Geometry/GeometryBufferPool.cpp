@@ -0,0 +1,579 @@
+
+#include "GeometryBufferPool.h"
+#include <Ic3/Graphics/GCI/CommandContext.h>
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBuffer.h>
+#include <Ic3/Graphics/GCI/State/InputAssemblerCommon.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		struct RelocatedRange
+		{
+			uint32 sourceOffset;
+			uint32 targetOffset;
+			uint32 size;
+		};
+
+		// Issues copies of the ranges (in elements of the specified size) from one buffer to the other.
+		// Ranges adjacent in both buffers (which is the common case, as relocation packs them in order)
+		// are merged into a single copy.
+		uint32 CopyRelocatedRanges(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				GCI::GPUBuffer & pTargetBuffer,
+				GCI::GPUBuffer & pSourceBuffer,
+				std::vector<RelocatedRange> & pRanges,
+				uint32 pElementSize )
+		{
+			std::sort(
+					pRanges.begin(),
+					pRanges.end(),
+					[]( const RelocatedRange & pFirst, const RelocatedRange & pSecond ) -> bool {
+						return pFirst.sourceOffset < pSecond.sourceOffset;
+					} );
+
+			uint32 copiesNum = 0;
+
+			for( size_t rangeIndex = 0; rangeIndex < pRanges.size(); )
+			{
+				auto mergedRange = pRanges[rangeIndex++];
+				while( ( rangeIndex < pRanges.size() ) &&
+				       ( pRanges[rangeIndex].sourceOffset == mergedRange.sourceOffset + mergedRange.size ) &&
+				       ( pRanges[rangeIndex].targetOffset == mergedRange.targetOffset + mergedRange.size ) )
+				{
+					mergedRange.size += pRanges[rangeIndex++].size;
+				}
+
+				GCI::GPUBufferSubDataCopyDesc copyDesc;
+				copyDesc.sourceBufferRegion.offset = static_cast<GCI::gpu_memory_size_t>( mergedRange.sourceOffset ) * pElementSize;
+				copyDesc.sourceBufferRegion.size = static_cast<GCI::gpu_memory_size_t>( mergedRange.size ) * pElementSize;
+				copyDesc.targetBufferOffset = static_cast<GCI::gpu_memory_size_t>( mergedRange.targetOffset ) * pElementSize;
+
+				pCommandContext.UpdateBufferSubDataCopy( pTargetBuffer, pSourceBuffer, copyDesc );
+				++copiesNum;
+			}
+
+			return copiesNum;
+		}
+
+	}
+
+	GeometryBufferPool::GeometryBufferPool( GCI::GPUDevice & pGPUDevice, const VertexFormatSignature & pVertexFormat )
+	: mGPUDevice( pGPUDevice )
+	, mVertexFormat( pVertexFormat )
+	{
+		std::fill( std::begin( _vertexStrideArray ), std::end( _vertexStrideArray ), 0u );
+
+		for( const auto streamSlot : mVertexFormat.GetActiveStreamsSlots() )
+		{
+			const auto * vertexStream = mVertexFormat.GetStream( streamSlot );
+			if( vertexStream && ( vertexStream->streamDataRate == GCI::EIAVertexAttributeDataRate::PerVertex ) )
+			{
+				_vertexStrideArray[streamSlot] = vertexStream->dataStrideInBytes;
+			}
+		}
+
+		_indexSize = mVertexFormat.IsIndexedVertexFormat() ? mVertexFormat.GetIndexDataSize() : 0;
+	}
+
+	GeometryBufferPool::~GeometryBufferPool() = default;
+
+	bool GeometryBufferPool::Initialize( const GeometryBufferPoolCreateInfo & pCreateInfo )
+	{
+		Ic3DebugAssert( !_vertexSourceBinding );
+		Ic3DebugAssert( pCreateInfo.growthFactor > 1.0f );
+
+		const auto indexCapacity = ( _indexSize > 0 ) ? pCreateInfo.indexCapacity : 0;
+
+		StorageBuffers storageBuffers;
+		if( !CreateStorageBuffers( pCreateInfo.vertexCapacity, indexCapacity, storageBuffers ) )
+		{
+			return false;
+		}
+
+		auto vertexSourceBinding = CreateVertexSourceBinding( storageBuffers );
+		if( !vertexSourceBinding )
+		{
+			return false;
+		}
+
+		_storageBuffers = std::move( storageBuffers );
+		_vertexSourceBinding = std::move( vertexSourceBinding );
+		_vertexRangeAllocator.Reset( pCreateInfo.vertexCapacity );
+		_indexRangeAllocator.Reset( indexCapacity );
+		_growthFactor = pCreateInfo.growthFactor;
+		_storageVersion += 1;
+
+		return true;
+	}
+
+	void GeometryBufferPool::Release()
+	{
+		_storageBuffers = StorageBuffers{};
+		_vertexSourceBinding.reset();
+		_vertexRangeAllocator.Reset( 0 );
+		_indexRangeAllocator.Reset( 0 );
+		_allocationSlotArray.clear();
+		_freeSlotList.clear();
+	}
+
+	geometry_pool_allocation_id_t GeometryBufferPool::Allocate(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			uint32 pVerticesNum,
+			uint32 pIndicesNum )
+	{
+		Ic3DebugAssert( _vertexSourceBinding );
+
+		if( ( pVerticesNum == 0 ) || ( ( _indexSize == 0 ) && ( pIndicesNum > 0 ) ) )
+		{
+			return kGeometryPoolAllocationIDInvalid;
+		}
+
+		auto vertexRange = _vertexRangeAllocator.Allocate( pVerticesNum );
+		auto indexRange = ( pIndicesNum > 0 ) ? _indexRangeAllocator.Allocate( pIndicesNum ) : RangeAllocation{};
+
+		if( !vertexRange || ( ( pIndicesNum > 0 ) && !indexRange ) )
+		{
+			if( vertexRange )
+			{
+				_vertexRangeAllocator.Free( vertexRange.allocationID );
+			}
+			if( indexRange )
+			{
+				_indexRangeAllocator.Free( indexRange.allocationID );
+			}
+
+			// Grow only the buffers which are short of space. If there is enough space in total, but
+			// it is fragmented, relocation with the current capacity (i.e. compaction) is enough.
+			const auto computeRequiredCapacity = [this]( const RangeAllocator & pAllocator, uint32 pRequestedSize ) -> uint32 {
+				const auto capacity = pAllocator.GetCapacity();
+				if( pAllocator.GetFreeSize() >= pRequestedSize )
+				{
+					return capacity;
+				}
+				const auto requiredCapacity = static_cast<uint64>( pAllocator.GetAllocatedSize() ) + pRequestedSize;
+				const auto grownCapacity = static_cast<uint64>( std::ceil( static_cast<double>( capacity ) * _growthFactor ) );
+				return static_cast<uint32>( std::min<uint64>( std::max( requiredCapacity, grownCapacity ), cppx::meta::limits<uint32>::max_value ) );
+			};
+
+			const auto vertexCapacity = computeRequiredCapacity( _vertexRangeAllocator, pVerticesNum );
+			const auto indexCapacity = ( _indexSize > 0 ) ? computeRequiredCapacity( _indexRangeAllocator, pIndicesNum ) : 0;
+
+			if( !Relocate( pCommandContext, vertexCapacity, indexCapacity ) )
+			{
+				return kGeometryPoolAllocationIDInvalid;
+			}
+
+			// After relocation all free space is a single range at the end of each buffer.
+			vertexRange = _vertexRangeAllocator.Allocate( pVerticesNum );
+			indexRange = ( pIndicesNum > 0 ) ? _indexRangeAllocator.Allocate( pIndicesNum ) : RangeAllocation{};
+
+			if( !vertexRange || ( ( pIndicesNum > 0 ) && !indexRange ) )
+			{
+				return kGeometryPoolAllocationIDInvalid;
+			}
+		}
+
+		geometry_pool_allocation_id_t allocationID = 0;
+		if( !_freeSlotList.empty() )
+		{
+			allocationID = _freeSlotList.back();
+			_freeSlotList.pop_back();
+		}
+		else
+		{
+			allocationID = static_cast<geometry_pool_allocation_id_t>( _allocationSlotArray.size() );
+			_allocationSlotArray.emplace_back();
+		}
+
+		auto & allocationSlot = _allocationSlotArray[allocationID];
+		allocationSlot.vertexRangeID = vertexRange.allocationID;
+		allocationSlot.indexRangeID = indexRange.allocationID;
+		allocationSlot.allocationInfo.baseVertex = vertexRange.offset;
+		allocationSlot.allocationInfo.verticesNum = pVerticesNum;
+		allocationSlot.allocationInfo.firstIndex = indexRange.offset;
+		allocationSlot.allocationInfo.indicesNum = pIndicesNum;
+		allocationSlot.isActive = true;
+
+		return allocationID;
+	}
+
+	void GeometryBufferPool::Free( geometry_pool_allocation_id_t pAllocationID )
+	{
+		if( !IsAllocationValid( pAllocationID ) )
+		{
+			return;
+		}
+
+		auto & allocationSlot = _allocationSlotArray[pAllocationID];
+
+		_vertexRangeAllocator.Free( allocationSlot.vertexRangeID );
+		if( allocationSlot.indexRangeID != kRangeAllocationIDInvalid )
+		{
+			_indexRangeAllocator.Free( allocationSlot.indexRangeID );
+		}
+
+		allocationSlot.isActive = false;
+		_freeSlotList.push_back( pAllocationID );
+	}
+
+	bool GeometryBufferPool::Compact( GCI::CommandContextDirectTransfer & pCommandContext )
+	{
+		return Relocate( pCommandContext, _vertexRangeAllocator.GetCapacity(), _indexRangeAllocator.GetCapacity() );
+	}
+
+	bool GeometryBufferPool::Relocate(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			uint32 pVertexCapacity,
+			uint32 pIndexCapacity )
+	{
+		if( ( pVertexCapacity < _vertexRangeAllocator.GetAllocatedSize() ) || ( pIndexCapacity < _indexRangeAllocator.GetAllocatedSize() ) )
+		{
+			return false;
+		}
+
+		StorageBuffers storageBuffers;
+		if( !CreateStorageBuffers( pVertexCapacity, pIndexCapacity, storageBuffers ) )
+		{
+			return false;
+		}
+
+		auto vertexSourceBinding = CreateVertexSourceBinding( storageBuffers );
+		if( !vertexSourceBinding )
+		{
+			return false;
+		}
+
+		// Allocations are re-created in the order of their current location. Allocating sequentially from an
+		// empty allocator always takes the beginning of the single free range, so the result is packed.
+		std::vector<geometry_pool_allocation_id_t> vertexOrderedSlots;
+		std::vector<geometry_pool_allocation_id_t> indexOrderedSlots;
+		for( geometry_pool_allocation_id_t slotIndex = 0; slotIndex < _allocationSlotArray.size(); ++slotIndex )
+		{
+			const auto & allocationSlot = _allocationSlotArray[slotIndex];
+			if( allocationSlot.isActive )
+			{
+				vertexOrderedSlots.push_back( slotIndex );
+				if( allocationSlot.indexRangeID != kRangeAllocationIDInvalid )
+				{
+					indexOrderedSlots.push_back( slotIndex );
+				}
+			}
+		}
+
+		std::sort( vertexOrderedSlots.begin(), vertexOrderedSlots.end(), [this]( auto pFirst, auto pSecond ) -> bool {
+			return _allocationSlotArray[pFirst].allocationInfo.baseVertex < _allocationSlotArray[pSecond].allocationInfo.baseVertex;
+		} );
+
+		std::sort( indexOrderedSlots.begin(), indexOrderedSlots.end(), [this]( auto pFirst, auto pSecond ) -> bool {
+			return _allocationSlotArray[pFirst].allocationInfo.firstIndex < _allocationSlotArray[pSecond].allocationInfo.firstIndex;
+		} );
+
+		RangeAllocator vertexRangeAllocator( pVertexCapacity );
+		RangeAllocator indexRangeAllocator( pIndexCapacity );
+
+		std::vector<RelocatedRange> relocatedVertexRanges;
+		relocatedVertexRanges.reserve( vertexOrderedSlots.size() );
+
+		for( const auto slotIndex : vertexOrderedSlots )
+		{
+			auto & allocationSlot = _allocationSlotArray[slotIndex];
+			const auto vertexRange = vertexRangeAllocator.Allocate( allocationSlot.allocationInfo.verticesNum );
+			Ic3DebugAssert( vertexRange );
+
+			relocatedVertexRanges.push_back( { allocationSlot.allocationInfo.baseVertex, vertexRange.offset, vertexRange.size } );
+			allocationSlot.vertexRangeID = vertexRange.allocationID;
+			allocationSlot.allocationInfo.baseVertex = vertexRange.offset;
+		}
+
+		std::vector<RelocatedRange> relocatedIndexRanges;
+		relocatedIndexRanges.reserve( indexOrderedSlots.size() );
+
+		for( const auto slotIndex : indexOrderedSlots )
+		{
+			auto & allocationSlot = _allocationSlotArray[slotIndex];
+			const auto indexRange = indexRangeAllocator.Allocate( allocationSlot.allocationInfo.indicesNum );
+			Ic3DebugAssert( indexRange );
+
+			relocatedIndexRanges.push_back( { allocationSlot.allocationInfo.firstIndex, indexRange.offset, indexRange.size } );
+			allocationSlot.indexRangeID = indexRange.allocationID;
+			allocationSlot.allocationInfo.firstIndex = indexRange.offset;
+		}
+
+		for( uint32 streamSlot = 0; streamSlot < GCM::kIAMaxDataStreamVertexBuffersNum; ++streamSlot )
+		{
+			if( _vertexStrideArray[streamSlot] > 0 )
+			{
+				_relocationCopiesNum += CopyRelocatedRanges(
+						pCommandContext,
+						*storageBuffers.vertexBufferArray[streamSlot],
+						*_storageBuffers.vertexBufferArray[streamSlot],
+						relocatedVertexRanges,
+						_vertexStrideArray[streamSlot] );
+			}
+		}
+
+		if( _indexSize > 0 )
+		{
+			_relocationCopiesNum += CopyRelocatedRanges(
+					pCommandContext,
+					*storageBuffers.indexBuffer,
+					*_storageBuffers.indexBuffer,
+					relocatedIndexRanges,
+					_indexSize );
+		}
+
+		_storageBuffers = std::move( storageBuffers );
+		_vertexSourceBinding = std::move( vertexSourceBinding );
+		_vertexRangeAllocator = std::move( vertexRangeAllocator );
+		_indexRangeAllocator = std::move( indexRangeAllocator );
+		_storageVersion += 1;
+		_relocationsNum += 1;
+
+		return true;
+	}
+
+	bool GeometryBufferPool::UpdateVertexData(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			geometry_pool_allocation_id_t pAllocationID,
+			uint32 pStreamSlot,
+			const void * pData,
+			uint32 pVerticesNum,
+			uint32 pVertexOffset )
+	{
+		if( !IsAllocationValid( pAllocationID ) || ( pStreamSlot >= GCM::kIAMaxDataStreamVertexBuffersNum ) || ( _vertexStrideArray[pStreamSlot] == 0 ) )
+		{
+			return false;
+		}
+
+		const auto & allocationInfo = _allocationSlotArray[pAllocationID].allocationInfo;
+		if( pVertexOffset + pVerticesNum > allocationInfo.verticesNum )
+		{
+			return false;
+		}
+
+		const auto vertexStride = _vertexStrideArray[pStreamSlot];
+
+		GCI::GPUBufferSubDataUploadDesc uploadDesc;
+		uploadDesc.bufferRegion.offset = static_cast<GCI::gpu_memory_size_t>( allocationInfo.baseVertex + pVertexOffset ) * vertexStride;
+		uploadDesc.bufferRegion.size = static_cast<GCI::gpu_memory_size_t>( pVerticesNum ) * vertexStride;
+		uploadDesc.inputDataDesc.pointer = pData;
+		uploadDesc.inputDataDesc.size = uploadDesc.bufferRegion.size;
+
+		return pCommandContext.UpdateBufferSubDataUpload( *_storageBuffers.vertexBufferArray[pStreamSlot], uploadDesc );
+	}
+
+	bool GeometryBufferPool::UpdateIndexData(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			geometry_pool_allocation_id_t pAllocationID,
+			const void * pData,
+			uint32 pIndicesNum,
+			uint32 pIndexOffset )
+	{
+		if( !IsAllocationValid( pAllocationID ) || ( _indexSize == 0 ) )
+		{
+			return false;
+		}
+
+		const auto & allocationInfo = _allocationSlotArray[pAllocationID].allocationInfo;
+		if( pIndexOffset + pIndicesNum > allocationInfo.indicesNum )
+		{
+			return false;
+		}
+
+		GCI::GPUBufferSubDataUploadDesc uploadDesc;
+		uploadDesc.bufferRegion.offset = static_cast<GCI::gpu_memory_size_t>( allocationInfo.firstIndex + pIndexOffset ) * _indexSize;
+		uploadDesc.bufferRegion.size = static_cast<GCI::gpu_memory_size_t>( pIndicesNum ) * _indexSize;
+		uploadDesc.inputDataDesc.pointer = pData;
+		uploadDesc.inputDataDesc.size = uploadDesc.bufferRegion.size;
+
+		return pCommandContext.UpdateBufferSubDataUpload( *_storageBuffers.indexBuffer, uploadDesc );
+	}
+
+	GeometryPoolAllocationInfo GeometryBufferPool::GetAllocationInfo( geometry_pool_allocation_id_t pAllocationID ) const noexcept
+	{
+		return IsAllocationValid( pAllocationID ) ? _allocationSlotArray[pAllocationID].allocationInfo : GeometryPoolAllocationInfo{};
+	}
+
+	GCI::GPUMemoryRegion GeometryBufferPool::GetVertexDataRegion( geometry_pool_allocation_id_t pAllocationID, uint32 pStreamSlot ) const noexcept
+	{
+		if( !IsAllocationValid( pAllocationID ) || ( pStreamSlot >= GCM::kIAMaxDataStreamVertexBuffersNum ) )
+		{
+			return {};
+		}
+
+		const auto & allocationInfo = _allocationSlotArray[pAllocationID].allocationInfo;
+		const auto vertexStride = static_cast<GCI::gpu_memory_size_t>( _vertexStrideArray[pStreamSlot] );
+
+		return GCI::GPUMemoryRegion{ allocationInfo.baseVertex * vertexStride, allocationInfo.verticesNum * vertexStride };
+	}
+
+	GCI::GPUMemoryRegion GeometryBufferPool::GetIndexDataRegion( geometry_pool_allocation_id_t pAllocationID ) const noexcept
+	{
+		if( !IsAllocationValid( pAllocationID ) )
+		{
+			return {};
+		}
+
+		const auto & allocationInfo = _allocationSlotArray[pAllocationID].allocationInfo;
+		const auto indexSize = static_cast<GCI::gpu_memory_size_t>( _indexSize );
+
+		return GCI::GPUMemoryRegion{ allocationInfo.firstIndex * indexSize, allocationInfo.indicesNum * indexSize };
+	}
+
+	GCI::GPUBufferHandle GeometryBufferPool::GetVertexBuffer( uint32 pStreamSlot ) const noexcept
+	{
+		return ( pStreamSlot < GCM::kIAMaxDataStreamVertexBuffersNum ) ? _storageBuffers.vertexBufferArray[pStreamSlot] : nullptr;
+	}
+
+	GCI::GPUBufferHandle GeometryBufferPool::GetIndexBuffer() const noexcept
+	{
+		return _storageBuffers.indexBuffer;
+	}
+
+	GeometryBufferPoolStats GeometryBufferPool::GetStats() const noexcept
+	{
+		GeometryBufferPoolStats poolStats;
+		poolStats.vertexCapacity = _vertexRangeAllocator.GetCapacity();
+		poolStats.allocatedVerticesNum = _vertexRangeAllocator.GetAllocatedSize();
+		poolStats.freeVertexRangesNum = _vertexRangeAllocator.GetFreeRangesNum();
+		poolStats.indexCapacity = _indexRangeAllocator.GetCapacity();
+		poolStats.allocatedIndicesNum = _indexRangeAllocator.GetAllocatedSize();
+		poolStats.freeIndexRangesNum = _indexRangeAllocator.GetFreeRangesNum();
+		poolStats.allocationsNum = _vertexRangeAllocator.GetAllocationsNum();
+		poolStats.relocationsNum = _relocationsNum;
+		poolStats.relocationCopiesNum = _relocationCopiesNum;
+		return poolStats;
+	}
+
+	bool GeometryBufferPool::CreateStorageBuffers( uint32 pVertexCapacity, uint32 pIndexCapacity, StorageBuffers & pStorageBuffers ) const
+	{
+		GCI::GPUBufferCreateInfo bufferCreateInfo;
+		bufferCreateInfo.memoryFlags = GCI::eGPUResourceMemoryMaskVertexStreamBufferStatic;
+
+		for( uint32 streamSlot = 0; streamSlot < GCM::kIAMaxDataStreamVertexBuffersNum; ++streamSlot )
+		{
+			if( _vertexStrideArray[streamSlot] > 0 )
+			{
+				// Transfer bits are required, as the content is moved between buffers during relocation.
+				bufferCreateInfo.bufferSize = static_cast<GCI::gpu_memory_size_t>( pVertexCapacity ) * _vertexStrideArray[streamSlot];
+				bufferCreateInfo.resourceFlags =
+						GCI::eGPUResourceContentFlagStaticBit |
+						GCI::eGPUBufferBindFlagVertexBufferBit |
+						GCI::eGPUResourceUsageFlagTransferSourceBit |
+						GCI::eGPUResourceUsageFlagTransferTargetBit;
+
+				pStorageBuffers.vertexBufferArray[streamSlot] = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+				if( !pStorageBuffers.vertexBufferArray[streamSlot] )
+				{
+					return false;
+				}
+			}
+		}
+
+		if( _indexSize > 0 )
+		{
+			bufferCreateInfo.bufferSize = static_cast<GCI::gpu_memory_size_t>( pIndexCapacity ) * _indexSize;
+			bufferCreateInfo.resourceFlags =
+					GCI::eGPUResourceContentFlagStaticBit |
+					GCI::eGPUBufferBindFlagIndexBufferBit |
+					GCI::eGPUResourceUsageFlagTransferSourceBit |
+					GCI::eGPUResourceUsageFlagTransferTargetBit;
+
+			pStorageBuffers.indexBuffer = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+			if( !pStorageBuffers.indexBuffer )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	GCI::VertexSourceBindingDescriptorHandle GeometryBufferPool::CreateVertexSourceBinding( const StorageBuffers & pStorageBuffers ) const
+	{
+		GCI::VertexSourceBindingDescriptorCreateInfo descriptorCreateInfo;
+		auto & bindingDefinition = descriptorCreateInfo.bindingDefinition;
+
+		for( uint32 streamSlot = 0; streamSlot < GCM::kIAMaxDataStreamVertexBuffersNum; ++streamSlot )
+		{
+			if( _vertexStrideArray[streamSlot] > 0 )
+			{
+				auto & vertexBufferReference = bindingDefinition.vertexBufferReferences[streamSlot];
+				vertexBufferReference.sourceBuffer = GCI::GPUBufferReference( pStorageBuffers.vertexBufferArray[streamSlot] );
+				vertexBufferReference.refParams.vertexStride = _vertexStrideArray[streamSlot];
+				bindingDefinition.activeStreamsMask.set( GCI::CXU::IAMakeVertexBufferBindingFlag( streamSlot ) );
+			}
+		}
+
+		if( _indexSize > 0 )
+		{
+			bindingDefinition.indexBufferReference.sourceBuffer = GCI::GPUBufferReference( pStorageBuffers.indexBuffer );
+			bindingDefinition.indexBufferReference.refParams.indexFormat = mVertexFormat.mIndexDataFormat;
+			bindingDefinition.activeStreamsMask.set( GCI::eIAVertexSourceBindingFlagIndexBufferBit );
+		}
+
+		return mGPUDevice.CreateVertexSourceBindingDescriptor( descriptorCreateInfo );
+	}
+
+	bool GeometryBufferPool::IsAllocationValid( geometry_pool_allocation_id_t pAllocationID ) const noexcept
+	{
+		return ( pAllocationID < _allocationSlotArray.size() ) && _allocationSlotArray[pAllocationID].isActive;
+	}
+
+
+	GeometryBufferPoolManager::GeometryBufferPoolManager( GCI::GPUDevice & pGPUDevice, const GeometryBufferPoolCreateInfo & pDefaultCreateInfo )
+	: mGPUDevice( pGPUDevice )
+	, _defaultCreateInfo( pDefaultCreateInfo )
+	{}
+
+	GeometryBufferPoolManager::~GeometryBufferPoolManager() = default;
+
+	static std::string MakeGeometryBufferPoolKey( const VertexFormatSignature & pVertexFormat )
+	{
+		// The serial string describes attributes and streams only, so the index format is appended.
+		return pVertexFormat.GenerateSerialString() + "|I" + std::to_string( static_cast<uint32>( pVertexFormat.mIndexDataFormat ) );
+	}
+
+	GeometryBufferPool * GeometryBufferPoolManager::GetOrCreatePool( const VertexFormatSignature & pVertexFormat )
+	{
+		auto poolKey = MakeGeometryBufferPoolKey( pVertexFormat );
+
+		auto & geometryBufferPool = _poolMap[poolKey];
+		if( !geometryBufferPool )
+		{
+			auto newPool = std::make_unique<GeometryBufferPool>( mGPUDevice, pVertexFormat );
+			if( !newPool->Initialize( _defaultCreateInfo ) )
+			{
+				_poolMap.erase( poolKey );
+				return nullptr;
+			}
+
+			geometryBufferPool = std::move( newPool );
+		}
+
+		return geometryBufferPool.get();
+	}
+
+	GeometryBufferPool * GeometryBufferPoolManager::FindPool( const VertexFormatSignature & pVertexFormat ) const noexcept
+	{
+		const auto poolIter = _poolMap.find( MakeGeometryBufferPoolKey( pVertexFormat ) );
+		return ( poolIter != _poolMap.end() ) ? poolIter->second.get() : nullptr;
+	}
+
+	void GeometryBufferPoolManager::ReleaseAll()
+	{
+		for( auto & poolEntry : _poolMap )
+		{
+			poolEntry.second->Release();
+		}
+
+		_poolMap.clear();
+	}
+
+} // namespace Ic3
@@ -0,0 +1,208 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_GEOMETRY_BUFFER_POOL_H__
+#define __IC3_NXMAIN_GEOMETRY_BUFFER_POOL_H__
+
+#include "../GCI/VertexFormatSignature.h"
+#include <Ic3/CoreLib/Utility/RangeAllocator.h>
+#include <Ic3/Graphics/GCI/CommonCommandDefs.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBufferCommon.h>
+#include <Ic3/Graphics/GCI/State/PipelineStateCommon.h>
+#include <unordered_map>
+
+namespace Ic3
+{
+
+	using geometry_pool_allocation_id_t = uint32;
+
+	inline constexpr geometry_pool_allocation_id_t kGeometryPoolAllocationIDInvalid = cppx::meta::limits<uint32>::max_value;
+
+	struct GeometryBufferPoolCreateInfo
+	{
+		/// Initial capacity of the vertex buffers (in vertices, the same for all per-vertex streams).
+		uint32 vertexCapacity = 1024 * 1024;
+
+		/// Initial capacity of the index buffer (in indices). Ignored for non-indexed vertex formats.
+		uint32 indexCapacity = 4 * 1024 * 1024;
+
+		/// When the pool runs out of space, the capacity is multiplied by this factor (or increased to
+		/// the required size, whichever is larger).
+		float growthFactor = 1.5f;
+	};
+
+	/// @brief Location of a single geometry allocation within the pool buffers. Indexed geometry is drawn with
+	/// CmdDrawDirectIndexed( indicesNum, firstIndex, baseVertex ): indices are relative to the allocation, so
+	/// the same index data is valid wherever the vertices end up.
+	struct GeometryPoolAllocationInfo
+	{
+		uint32 baseVertex = 0;
+		uint32 verticesNum = 0;
+		uint32 firstIndex = 0;
+		uint32 indicesNum = 0;
+	};
+
+	struct GeometryBufferPoolStats
+	{
+		uint32 vertexCapacity = 0;
+		uint32 allocatedVerticesNum = 0;
+		uint32 freeVertexRangesNum = 0;
+		uint32 indexCapacity = 0;
+		uint32 allocatedIndicesNum = 0;
+		uint32 freeIndexRangesNum = 0;
+		uint32 allocationsNum = 0;
+
+		/// Number of times the buffers have been re-created (by growth or by an explicit compaction).
+		uint32 relocationsNum = 0;
+
+		/// Number of copy commands issued by the relocations (adjacent ranges are copied with a single command).
+		uint32 relocationCopiesNum = 0;
+	};
+
+	/// @brief Shared set of large vertex/index buffers for all geometry using the same VertexFormatSignature.
+	/// Instead of a dedicated buffer set per mesh, every mesh gets a range of vertices and a range of indices,
+	/// sub-allocated with a RangeAllocator (TLSF). All meshes in a pool share one VertexSourceBindingDescriptor,
+	/// so consecutive draws of unrelated meshes do not require any vertex source change.
+	/// If an allocation does not fit, the buffers are re-created with a larger capacity and all live ranges are
+	/// copied (packed, which also removes the fragmentation) on the GPU. Compact() does the same explicitly.
+	/// Allocation IDs stay valid after relocation, but their location (GetAllocationInfo()), the buffers and the
+	/// vertex source binding change - GetStorageVersion() can be used to detect it.
+	/// Only per-vertex streams are pooled; per-instance streams of the format are not created by the pool.
+	class IC3_NXMAIN_CLASS GeometryBufferPool
+	{
+	public:
+		GCI::GPUDevice & mGPUDevice;
+
+		VertexFormatSignature const mVertexFormat;
+
+	public:
+		GeometryBufferPool( GCI::GPUDevice & pGPUDevice, const VertexFormatSignature & pVertexFormat );
+		~GeometryBufferPool();
+
+		/// @brief Creates the buffers. Returns false if any of them could not be created.
+		bool Initialize( const GeometryBufferPoolCreateInfo & pCreateInfo );
+
+		void Release();
+
+		/// @brief Allocates space for a mesh. If there is no free range large enough, the pool is relocated
+		/// (grown and compacted) using the specified context. Returns kGeometryPoolAllocationIDInvalid on failure.
+		CPPX_ATTR_NO_DISCARD geometry_pool_allocation_id_t Allocate(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				uint32 pVerticesNum,
+				uint32 pIndicesNum );
+
+		void Free( geometry_pool_allocation_id_t pAllocationID );
+
+		/// @brief Packs all live allocations at the beginning of new buffers of the same capacity.
+		bool Compact( GCI::CommandContextDirectTransfer & pCommandContext );
+
+		/// @brief Re-creates the buffers with the specified capacities and copies all live allocations (packed).
+		bool Relocate(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				uint32 pVertexCapacity,
+				uint32 pIndexCapacity );
+
+		/// @brief Uploads vertex data of a single stream. pVertexOffset is relative to the allocation.
+		bool UpdateVertexData(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				geometry_pool_allocation_id_t pAllocationID,
+				uint32 pStreamSlot,
+				const void * pData,
+				uint32 pVerticesNum,
+				uint32 pVertexOffset = 0 );
+
+		/// @brief Uploads index data. Indices are relative to the allocation (the first vertex of the mesh is 0).
+		bool UpdateIndexData(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				geometry_pool_allocation_id_t pAllocationID,
+				const void * pData,
+				uint32 pIndicesNum,
+				uint32 pIndexOffset = 0 );
+
+		CPPX_ATTR_NO_DISCARD GeometryPoolAllocationInfo GetAllocationInfo( geometry_pool_allocation_id_t pAllocationID ) const noexcept;
+
+		/// @brief Returns the byte region of the specified vertex stream used by the allocation.
+		CPPX_ATTR_NO_DISCARD GCI::GPUMemoryRegion GetVertexDataRegion( geometry_pool_allocation_id_t pAllocationID, uint32 pStreamSlot ) const noexcept;
+
+		/// @brief Returns the byte region of the index buffer used by the allocation.
+		CPPX_ATTR_NO_DISCARD GCI::GPUMemoryRegion GetIndexDataRegion( geometry_pool_allocation_id_t pAllocationID ) const noexcept;
+
+		CPPX_ATTR_NO_DISCARD GCI::GPUBufferHandle GetVertexBuffer( uint32 pStreamSlot ) const noexcept;
+
+		CPPX_ATTR_NO_DISCARD GCI::GPUBufferHandle GetIndexBuffer() const noexcept;
+
+		CPPX_ATTR_NO_DISCARD const GCI::VertexSourceBindingDescriptorHandle & GetVertexSourceBinding() const noexcept
+		{
+			return _vertexSourceBinding;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetStorageVersion() const noexcept
+		{
+			return _storageVersion;
+		}
+
+		CPPX_ATTR_NO_DISCARD GeometryBufferPoolStats GetStats() const noexcept;
+
+	private:
+		struct AllocationSlot
+		{
+			range_allocation_id_t vertexRangeID;
+			range_allocation_id_t indexRangeID;
+			GeometryPoolAllocationInfo allocationInfo;
+			bool isActive;
+		};
+
+		struct StorageBuffers
+		{
+			GCI::GPUBufferHandle vertexBufferArray[GCM::kIAMaxDataStreamVertexBuffersNum];
+			GCI::GPUBufferHandle indexBuffer;
+		};
+
+		CPPX_ATTR_NO_DISCARD bool CreateStorageBuffers( uint32 pVertexCapacity, uint32 pIndexCapacity, StorageBuffers & pStorageBuffers ) const;
+
+		CPPX_ATTR_NO_DISCARD GCI::VertexSourceBindingDescriptorHandle CreateVertexSourceBinding( const StorageBuffers & pStorageBuffers ) const;
+
+		CPPX_ATTR_NO_DISCARD bool IsAllocationValid( geometry_pool_allocation_id_t pAllocationID ) const noexcept;
+
+	private:
+		StorageBuffers _storageBuffers;
+		GCI::VertexSourceBindingDescriptorHandle _vertexSourceBinding;
+		RangeAllocator _vertexRangeAllocator;
+		RangeAllocator _indexRangeAllocator;
+		std::vector<AllocationSlot> _allocationSlotArray;
+		std::vector<geometry_pool_allocation_id_t> _freeSlotList;
+		/// Stride of each per-vertex stream, zero for streams not managed by the pool.
+		uint32 _vertexStrideArray[GCM::kIAMaxDataStreamVertexBuffersNum];
+		uint32 _indexSize = 0;
+		float _growthFactor = 1.5f;
+		uint32 _storageVersion = 0;
+		uint32 _relocationsNum = 0;
+		uint32 _relocationCopiesNum = 0;
+	};
+
+	/// @brief Owns GeometryBufferPools, one per distinct VertexFormatSignature.
+	class IC3_NXMAIN_CLASS GeometryBufferPoolManager
+	{
+	public:
+		GCI::GPUDevice & mGPUDevice;
+
+	public:
+		GeometryBufferPoolManager( GCI::GPUDevice & pGPUDevice, const GeometryBufferPoolCreateInfo & pDefaultCreateInfo = {} );
+		~GeometryBufferPoolManager();
+
+		/// @brief Returns the pool for the specified format, creating it if needed. Returns null if the pool could not be created.
+		GeometryBufferPool * GetOrCreatePool( const VertexFormatSignature & pVertexFormat );
+
+		CPPX_ATTR_NO_DISCARD GeometryBufferPool * FindPool( const VertexFormatSignature & pVertexFormat ) const noexcept;
+
+		void ReleaseAll();
+
+	private:
+		GeometryBufferPoolCreateInfo _defaultCreateInfo;
+		/// Pools are keyed by the serial string of the format, which uniquely describes the layout.
+		std::unordered_map<std::string, std::unique_ptr<GeometryBufferPool>> _poolMap;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_GEOMETRY_BUFFER_POOL_H__
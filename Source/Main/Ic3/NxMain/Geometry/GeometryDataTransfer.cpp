@@ -1,65 +1,555 @@
 
 #include "GeometryDataTransfer.h"
-#include "CVertexPipelineConfig.h"
-#include "GeometryStorageGPU.h"
+#include <Ic3/Graphics/GCI/CommandContext.h>
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBuffer.h>
+#include <algorithm>
+#include <functional>
 
 namespace Ic3
 {
 
-	GeometryDataGPUTransfer::GeometryDataGPUTransfer(
-			CoreEngineState & pCES,
-			GpaTransferCommandContext & pTransferCmdContext )
-	: CoreEngineObject( pCES )
-	, mTransferCmdContext( pTransferCmdContext )
+	GeometryDataGPUTransfer::GeometryDataGPUTransfer( GCI::GPUDevice & pGPUDevice )
+	: mGPUDevice( pGPUDevice )
 	{}
 
 	GeometryDataGPUTransfer::~GeometryDataGPUTransfer() = default;
 
+	geometry_upload_ticket_t GeometryDataGPUTransfer::UploadBufferData(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			const GCI::GPUBufferHandle & pBuffer,
+			GCI::gpu_memory_size_t pBufferOffset,
+			const void * pData,
+			GCI::gpu_memory_size_t pDataSize )
+	{
+		if( !pBuffer || !pData || ( pDataSize == 0 ) || ( pBufferOffset + pDataSize > pBuffer->mBufferProperties.byteSize ) )
+		{
+			return kGeometryUploadTicketInvalid;
+		}
+
+		UploadTarget uploadTarget;
+		uploadTarget.buffer = pBuffer;
+		uploadTarget.offset = pBufferOffset;
+
+		const auto ticket = _lastTicket + 1;
+		if( !QueueUpload( pCommandContext, uploadTarget, pData, pDataSize, ticket ) )
+		{
+			return kGeometryUploadTicketInvalid;
+		}
+
+		_lastTicket = ticket;
+		_stats.requestsNum += 1;
+
+		return ticket;
+	}
+
+	geometry_upload_ticket_t GeometryDataGPUTransfer::UploadMeshData(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			GeometryBufferPool & pGeometryBufferPool,
+			geometry_pool_allocation_id_t pAllocationID,
+			const GeometryMeshUploadDesc & pUploadDesc )
+	{
+		if( pGeometryBufferPool.GetAllocationInfo( pAllocationID ).verticesNum == 0 )
+		{
+			return kGeometryUploadTicketInvalid;
+		}
+
+		UploadTarget uploadTarget;
+		uploadTarget.geometryBufferPool = &pGeometryBufferPool;
+		uploadTarget.allocationID = pAllocationID;
+
+		const auto ticket = _lastTicket + 1;
+		bool queueResult = true;
+
+		for( uint32 streamSlot = 0; streamSlot < GCM::kIAMaxDataStreamVertexBuffersNum; ++streamSlot )
+		{
+			const auto vertexDataRegion = pGeometryBufferPool.GetVertexDataRegion( pAllocationID, streamSlot );
+			if( pUploadDesc.vertexStreamDataArray[streamSlot] && ( vertexDataRegion.size > 0 ) )
+			{
+				uploadTarget.streamSlot = streamSlot;
+				queueResult = QueueUpload( pCommandContext, uploadTarget, pUploadDesc.vertexStreamDataArray[streamSlot], vertexDataRegion.size, ticket ) && queueResult;
+			}
+		}
+
+		const auto indexDataRegion = pGeometryBufferPool.GetIndexDataRegion( pAllocationID );
+		if( pUploadDesc.indexData && ( indexDataRegion.size > 0 ) )
+		{
+			uploadTarget.streamSlot = kUploadTargetIndexBufferSlot;
+			queueResult = QueueUpload( pCommandContext, uploadTarget, pUploadDesc.indexData, indexDataRegion.size, ticket ) && queueResult;
+		}
+
+		// The ticket is consumed even if some part has been rejected, as the remaining parts may have been queued.
+		_lastTicket = ticket;
+		_stats.requestsNum += 1;
+
+		return queueResult ? ticket : kGeometryUploadTicketInvalid;
+	}
+
+	void GeometryDataGPUTransfer::Flush( GCI::CommandContextDirectTransfer & /* pCommandContext */ )
+	{
+	}
+
+	void GeometryDataGPUTransfer::ResetStats()
+	{
+		const auto pendingBytesNum = _stats.pendingBytesNum;
+		_stats = GeometryDataTransferStats{};
+		_stats.pendingBytesNum = pendingBytesNum;
+	}
+
+	bool GeometryDataGPUTransfer::ResolveUploadTarget(
+			const UploadTarget & pTarget,
+			GCI::gpu_memory_size_t pDataSize,
+			GCI::GPUBuffer *& pOutBuffer,
+			GCI::gpu_memory_size_t & pOutBufferOffset )
+	{
+		if( !pTarget.geometryBufferPool )
+		{
+			pOutBuffer = pTarget.buffer.get();
+			pOutBufferOffset = pTarget.offset;
+			return true;
+		}
+
+		const auto & geometryBufferPool = *pTarget.geometryBufferPool;
+
+		GCI::GPUMemoryRegion allocationRegion;
+		if( pTarget.streamSlot == kUploadTargetIndexBufferSlot )
+		{
+			allocationRegion = geometryBufferPool.GetIndexDataRegion( pTarget.allocationID );
+			pOutBuffer = geometryBufferPool.GetIndexBuffer().get();
+		}
+		else
+		{
+			allocationRegion = geometryBufferPool.GetVertexDataRegion( pTarget.allocationID, pTarget.streamSlot );
+			pOutBuffer = geometryBufferPool.GetVertexBuffer( pTarget.streamSlot ).get();
+		}
+
+		// Empty region means the allocation has been freed (or the pool released) since the upload was queued.
+		if( !pOutBuffer || ( allocationRegion.size == 0 ) || ( pTarget.offset + pDataSize > allocationRegion.size ) )
+		{
+			return false;
+		}
+
+		pOutBufferOffset = allocationRegion.offset + pTarget.offset;
+
+		return true;
+	}
+
 
-	GeometryDataGPUTransferUpload::GeometryDataGPUTransferUpload(
-			CoreEngineState & pCES,
-			GpaTransferCommandContext & pTransferCmdContext )
-	: GeometryDataGPUTransfer( pCES, pTransferCmdContext )
+	GeometryDataGPUTransferDirect::GeometryDataGPUTransferDirect( GCI::GPUDevice & pGPUDevice )
+	: GeometryDataGPUTransfer( pGPUDevice )
 	{}
 
-	GeometryDataGPUTransferUpload::~GeometryDataGPUTransferUpload() = default;
+	GeometryDataGPUTransferDirect::~GeometryDataGPUTransferDirect()
+	{
+		// Buffers must be unmapped with Flush(), which needs a command context.
+		Ic3DebugAssert( _mappedBufferList.empty() );
+	}
 
-	void GeometryDataGPUTransferUpload::initializeMeshData(
-			const GeometryReference & pGeometryRef,
-			const GeometryDataReferenceBase & pInputDataRef )
+	void GeometryDataGPUTransferDirect::Flush( GCI::CommandContextDirectTransfer & pCommandContext )
 	{
-		for( auto iVertexStream : pGeometryRef.dataReference.dataFormat->activeVertexStreams() )
+		for( auto & mappedBuffer : _mappedBufferList )
 		{
-			const auto & vertexStreamFormat = pGeometryRef.dataReference.dataFormat->vertexStream( iVertexStream );
-			const auto & inputDataRegion = pInputDataRef.vertexStreamDataRegions[iVertexStream];
-			const auto & vertexBufferRegion = pGeometryRef.dataReference.vertexStreamDataRegions[iVertexStream];
+			pCommandContext.UnmapBuffer( *mappedBuffer );
+		}
 
-			const auto vertexBuffer = pGeometryRef.storage->getVertexBuffer( iVertexStream );
+		_mappedBufferList.clear();
+	}
 
-			GCI::GPUBufferSubDataUploadDesc gpaDataUploadDesc;
-			gpaDataUploadDesc.bufferRegion.offset = vertexBufferRegion.offsetInElementsNum * vertexStreamFormat.elementSizeInBytes;
-			gpaDataUploadDesc.bufferRegion.size = vertexBufferRegion.sizeInElementsNum * vertexStreamFormat.elementSizeInBytes;
-			gpaDataUploadDesc.inputDataDesc.mPointer = inputDataRegion.mDataPtr;
-			gpaDataUploadDesc.inputDataDesc.size = inputDataRegion.sizeInElementsNum * inputDataRegion.elementSize;
+	bool GeometryDataGPUTransferDirect::QueueUpload(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			const UploadTarget & pTarget,
+			const void * pData,
+			GCI::gpu_memory_size_t pDataSize,
+			geometry_upload_ticket_t pTicket )
+	{
+		GCI::GPUBuffer * targetBuffer = nullptr;
+		GCI::gpu_memory_size_t targetOffset = 0;
 
-			mTransferCmdContext.updateBufferSubDataUpload( *vertexBuffer, gpaDataUploadDesc );
+		if( !ResolveUploadTarget( pTarget, pDataSize, targetBuffer, targetOffset ) )
+		{
+			return false;
 		}
 
-		if( pGeometryRef.dataReference.dataFormat->isIndexedGeometry() )
+		if( auto * mappedMemoryPtr = GetMappedBufferMemory( pCommandContext, *targetBuffer ) )
 		{
-			const auto & inputDataRegion = pInputDataRef.indexDataRegion;
-			const auto & indexBufferRegion = pGeometryRef.dataReference.indexDataRegion;
+			std::memcpy( mappedMemoryPtr + targetOffset, pData, cppx::numeric_cast<size_t>( pDataSize ) );
+			targetBuffer->MarkMappedRegionDirty( GCI::GPUMemoryRegion{ targetOffset, pDataSize } );
+		}
+		else
+		{
+			GCI::GPUBufferSubDataUploadDesc uploadDesc;
+			uploadDesc.bufferRegion.offset = targetOffset;
+			uploadDesc.bufferRegion.size = pDataSize;
+			uploadDesc.inputDataDesc.pointer = pData;
+			uploadDesc.inputDataDesc.size = pDataSize;
+
+			if( !pCommandContext.UpdateBufferSubDataUpload( *targetBuffer, uploadDesc ) )
+			{
+				return false;
+			}
+
+			_stats.transferCommandsNum += 1;
+		}
+
+		_stats.uploadedBytesNum += pDataSize;
+		_flushedTicket = pTicket;
+
+		return true;
+	}
+
+	byte * GeometryDataGPUTransferDirect::GetMappedBufferMemory( GCI::CommandContextDirectTransfer & pCommandContext, GCI::GPUBuffer & pBuffer )
+	{
+		const auto mappedBufferIter = std::find_if(
+				_mappedBufferList.begin(),
+				_mappedBufferList.end(),
+				[&pBuffer]( const GCI::GPUBufferHandle & pMappedBuffer ) -> bool {
+					return pMappedBuffer.get() == &pBuffer;
+				} );
+
+		if( mappedBufferIter != _mappedBufferList.end() )
+		{
+			return static_cast<byte *>( pBuffer.GetMappedMemory().pointer );
+		}
+
+		// Buffers mapped by someone else are not touched - their mapping may not cover the target region.
+		if( pBuffer.IsMapped() || !GCI::GCU::MemCheckMapAccess( GCI::EGPUMemoryMapMode::WriteDefault, pBuffer.mResourceMemory.memoryFlags ) )
+		{
+			return nullptr;
+		}
+
+		// The whole buffer is mapped, so the pointer refers to its beginning for all backends (including
+		// persistently mapped GL buffers) and subsequent writes anywhere in the buffer need no re-mapping.
+		if( !pCommandContext.MapBuffer( pBuffer, GCI::EGPUMemoryMapMode::WriteDefault ) )
+		{
+			return nullptr;
+		}
+
+		_mappedBufferList.push_back( pBuffer.GetHandle<GCI::GPUBuffer>() );
+		_stats.transferCommandsNum += 1;
+
+		return static_cast<byte *>( pBuffer.GetMappedMemory().pointer );
+	}
+
+
+	GeometryDataGPUTransferStaging::GeometryDataGPUTransferStaging( GCI::GPUDevice & pGPUDevice )
+	: GeometryDataGPUTransfer( pGPUDevice )
+	{}
+
+	GeometryDataGPUTransferStaging::~GeometryDataGPUTransferStaging() = default;
+
+	bool GeometryDataGPUTransferStaging::Initialize(
+			GCI::CommandContext & pCommandContext,
+			const GeometryDataStagingTransferCreateInfo & pCreateInfo )
+	{
+		Ic3DebugAssert( !_stagingBuffer );
+
+		if( ( pCreateInfo.frameBudget == 0 ) || ( pCreateInfo.framesInFlightNum == 0 ) )
+		{
+			return false;
+		}
+
+		_frameBudget = pCreateInfo.frameBudget;
 
-			const auto indexBuffer = pGeometryRef.storage->getIndexBuffer();
+		GCI::GPUBufferCreateInfo bufferCreateInfo;
+		bufferCreateInfo.bufferSize = _frameBudget * pCreateInfo.framesInFlightNum;
+		bufferCreateInfo.resourceFlags = GCI::eGPUResourceContentFlagDynamicBit | GCI::eGPUBufferBindFlagTransferSourceBufferBit;
+		bufferCreateInfo.memoryFlags = GCI::eGPUResourceMemoryMaskTransferSourceBuffer | GCI::eGPUMemoryHeapPropertyFlagPersistentMapBit;
+
+		_stagingBuffer = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+		if( !_stagingBuffer )
+		{
+			// Persistent mapping may be rejected by the driver. The segment is then uploaded once per frame.
+			bufferCreateInfo.memoryFlags = GCI::eGPUResourceMemoryMaskTransferSourceBuffer;
+			_stagingBuffer = mGPUDevice.CreateGPUBuffer( bufferCreateInfo );
+		}
+
+		if( !_stagingBuffer )
+		{
+			return false;
+		}
+
+		const auto & bufferMemoryFlags = _stagingBuffer->mResourceMemory.memoryFlags;
+		if( bufferMemoryFlags.is_set( GCI::eGPUMemoryHeapPropertyFlagPersistentMapBit ) )
+		{
+			if( pCommandContext.MapBuffer( *_stagingBuffer, GCI::EGPUMemoryMapMode::WriteDefault ) )
+			{
+				_mappedMemoryPtr = static_cast<byte *>( _stagingBuffer->GetMappedMemory().pointer );
+			}
+		}
+
+		if( !_mappedMemoryPtr )
+		{
+			_stagingMemory.resize( cppx::numeric_cast<size_t>( bufferCreateInfo.bufferSize ) );
+			_mappedMemoryPtr = _stagingMemory.data();
+		}
+
+		_coherentMemory = bufferMemoryFlags.is_set( GCI::eGPUMemoryHeapPropertyFlagCPUCoherentBit );
+		_segmentSyncArray.resize( pCreateInfo.framesInFlightNum );
+		_currentSegmentIndex = 0;
+		_currentSegmentOffset = 0;
+		_currentSegmentUsedSize = 0;
+
+		return true;
+	}
+
+	void GeometryDataGPUTransferStaging::Release( GCI::CommandContext & pCommandContext )
+	{
+		for( auto & segmentSync : _segmentSyncArray )
+		{
+			mGPUDevice.WaitForCommandSync( segmentSync );
+		}
+
+		if( _stagingBuffer && _stagingMemory.empty() && _mappedMemoryPtr )
+		{
+			pCommandContext.UnmapBuffer( *_stagingBuffer );
+		}
+
+		_segmentSyncArray.clear();
+		_stagingMemory.clear();
+		_pendingRequestList.clear();
+		_pendingDataBuffer.clear();
+		_pendingRequestsHead = 0;
+		_stats.pendingBytesNum = 0;
+		_flushedTicket = _lastTicket;
+		_mappedMemoryPtr = nullptr;
+		_stagingBuffer.reset();
+	}
+
+	void GeometryDataGPUTransferStaging::BeginFrame()
+	{
+		const auto segmentsNum = static_cast<uint32>( _segmentSyncArray.size() );
+		_currentSegmentIndex = ( _currentSegmentIndex + 1 ) % segmentsNum;
+		_currentSegmentOffset = _currentSegmentIndex * _frameBudget;
+		_currentSegmentUsedSize = 0;
+
+		mGPUDevice.WaitForCommandSync( _segmentSyncArray[_currentSegmentIndex] );
+	}
+
+	void GeometryDataGPUTransferStaging::Flush( GCI::CommandContextDirectTransfer & pCommandContext )
+	{
+		Ic3DebugAssert( _stagingBuffer );
+
+		_resolvedRequestList.clear();
+
+		// Requests are taken strictly in the order of submission, so the later write to the same region always wins,
+		// even if the requests are split between frames. Sorting is done only within the batch taken in this call.
+		auto remainingBudget = _frameBudget - _currentSegmentUsedSize;
+		while( _pendingRequestsHead < _pendingRequestList.size() )
+		{
+			const auto & pendingRequest = _pendingRequestList[_pendingRequestsHead];
+
+			if( pendingRequest.dataSize > remainingBudget )
+			{
+				// A request which would never fit is uploaded directly, but only if it is the first one in the frame.
+				if( ( pendingRequest.dataSize > _frameBudget ) && ( _currentSegmentUsedSize == 0 ) && _resolvedRequestList.empty() )
+				{
+					UploadOversizedRequest( pCommandContext, pendingRequest );
+					_pendingRequestsHead += 1;
+				}
+				break;
+			}
+
+			GCI::GPUBuffer * targetBuffer = nullptr;
+			GCI::gpu_memory_size_t targetOffset = 0;
+
+			if( ResolveUploadTarget( pendingRequest.target, pendingRequest.dataSize, targetBuffer, targetOffset ) )
+			{
+				const auto submissionIndex = static_cast<uint32>( _resolvedRequestList.size() );
+				_resolvedRequestList.push_back( { targetBuffer, targetOffset, pendingRequest.dataSize, pendingRequest.dataOffset, submissionIndex } );
+				remainingBudget -= pendingRequest.dataSize;
+			}
+
+			_stats.pendingBytesNum -= pendingRequest.dataSize;
+			_pendingRequestsHead += 1;
+		}
+
+		if( !_resolvedRequestList.empty() )
+		{
+			std::stable_sort(
+					_resolvedRequestList.begin(),
+					_resolvedRequestList.end(),
+					[]( const ResolvedRequest & pFirst, const ResolvedRequest & pSecond ) -> bool {
+						return std::less<const GCI::GPUBuffer *>{}( pFirst.buffer, pSecond.buffer ) || ( ( pFirst.buffer == pSecond.buffer ) && ( pFirst.bufferOffset < pSecond.bufferOffset ) );
+					} );
+
+			// Sorting by the offset reorders overlapping writes which start at different offsets (e.g. [100,200)
+			// followed by [50,150) would be copied in the reverse order). If the batch has any, the submission order
+			// is restored - only writes adjacent in that order are merged then, which is rare enough not to matter.
+			bool overlappingWrites = false;
+			const GCI::GPUBuffer * currentBuffer = nullptr;
+			GCI::gpu_memory_size_t currentBufferWriteEnd = 0;
+			for( const auto & resolvedRequest : _resolvedRequestList )
+			{
+				if( resolvedRequest.buffer != currentBuffer )
+				{
+					currentBuffer = resolvedRequest.buffer;
+					currentBufferWriteEnd = 0;
+				}
+				else if( resolvedRequest.bufferOffset < currentBufferWriteEnd )
+				{
+					overlappingWrites = true;
+					break;
+				}
+
+				currentBufferWriteEnd = std::max( currentBufferWriteEnd, resolvedRequest.bufferOffset + resolvedRequest.dataSize );
+			}
+
+			if( overlappingWrites )
+			{
+				std::sort(
+						_resolvedRequestList.begin(),
+						_resolvedRequestList.end(),
+						[]( const ResolvedRequest & pFirst, const ResolvedRequest & pSecond ) -> bool {
+							return pFirst.submissionIndex < pSecond.submissionIndex;
+						} );
+			}
+
+			// Pack the data in the list order: requests adjacent in the target buffer become adjacent in the staging memory.
+			const auto batchBeginOffset = _currentSegmentOffset + _currentSegmentUsedSize;
+			auto stagingOffset = batchBeginOffset;
+
+			for( const auto & resolvedRequest : _resolvedRequestList )
+			{
+				std::memcpy(
+						_mappedMemoryPtr + stagingOffset,
+						_pendingDataBuffer.data() + resolvedRequest.dataOffset,
+						cppx::numeric_cast<size_t>( resolvedRequest.dataSize ) );
+
+				stagingOffset += resolvedRequest.dataSize;
+			}
+
+			const GCI::GPUMemoryRegion batchRegion{ batchBeginOffset, stagingOffset - batchBeginOffset };
+
+			if( !_stagingMemory.empty() )
+			{
+				GCI::GPUBufferSubDataUploadDesc uploadDesc;
+				uploadDesc.bufferRegion = batchRegion;
+				uploadDesc.inputDataDesc.pointer = _stagingMemory.data() + batchBeginOffset;
+				uploadDesc.inputDataDesc.size = batchRegion.size;
+
+				pCommandContext.UpdateBufferSubDataUpload( *_stagingBuffer, uploadDesc );
+				_stats.transferCommandsNum += 1;
+			}
+			else if( !_coherentMemory )
+			{
+				pCommandContext.FlushMappedBufferRegion( *_stagingBuffer, batchRegion );
+			}
+
+			// Copies are issued in the list order, so overlapping writes are executed in the order of submission.
+			// Only writes which are contiguous in the target buffer and consecutive in the list are merged.
+			stagingOffset = batchBeginOffset;
+			for( size_t requestIndex = 0; requestIndex < _resolvedRequestList.size(); )
+			{
+				const auto & firstRequest = _resolvedRequestList[requestIndex];
+
+				GCI::GPUBufferSubDataCopyDesc copyDesc;
+				copyDesc.sourceBufferRegion.offset = stagingOffset;
+				copyDesc.sourceBufferRegion.size = firstRequest.dataSize;
+				copyDesc.targetBufferOffset = firstRequest.bufferOffset;
+
+				for( ++requestIndex; requestIndex < _resolvedRequestList.size(); ++requestIndex )
+				{
+					const auto & nextRequest = _resolvedRequestList[requestIndex];
+					if( ( nextRequest.buffer != firstRequest.buffer ) || ( nextRequest.bufferOffset != copyDesc.targetBufferOffset + copyDesc.sourceBufferRegion.size ) )
+					{
+						break;
+					}
+					copyDesc.sourceBufferRegion.size += nextRequest.dataSize;
+				}
+
+				pCommandContext.UpdateBufferSubDataCopy( *firstRequest.buffer, *_stagingBuffer, copyDesc );
+
+				stagingOffset += copyDesc.sourceBufferRegion.size;
+				_stats.uploadedBytesNum += copyDesc.sourceBufferRegion.size;
+				_stats.transferCommandsNum += 1;
+			}
+
+			_currentSegmentUsedSize += batchRegion.size;
+		}
+
+		ReleaseProcessedRequests();
+	}
+
+	void GeometryDataGPUTransferStaging::EndFrame( GCI::CommandSync pFrameSync )
+	{
+		_segmentSyncArray[_currentSegmentIndex] = std::move( pFrameSync );
+	}
+
+	bool GeometryDataGPUTransferStaging::QueueUpload(
+			GCI::CommandContextDirectTransfer & /* pCommandContext */,
+			const UploadTarget & pTarget,
+			const void * pData,
+			GCI::gpu_memory_size_t pDataSize,
+			geometry_upload_ticket_t pTicket )
+	{
+		if( !_stagingBuffer )
+		{
+			return false;
+		}
+
+		const auto dataOffset = _pendingDataBuffer.size();
+		_pendingDataBuffer.resize( dataOffset + cppx::numeric_cast<size_t>( pDataSize ) );
+		std::memcpy( _pendingDataBuffer.data() + dataOffset, pData, cppx::numeric_cast<size_t>( pDataSize ) );
+
+		_pendingRequestList.push_back( PendingRequest{ pTarget, dataOffset, pDataSize, pTicket } );
+		_stats.pendingBytesNum += pDataSize;
+
+		return true;
+	}
+
+	void GeometryDataGPUTransferStaging::UploadOversizedRequest(
+			GCI::CommandContextDirectTransfer & pCommandContext,
+			const PendingRequest & pRequest )
+	{
+		GCI::GPUBuffer * targetBuffer = nullptr;
+		GCI::gpu_memory_size_t targetOffset = 0;
+
+		if( ResolveUploadTarget( pRequest.target, pRequest.dataSize, targetBuffer, targetOffset ) )
+		{
+			GCI::GPUBufferSubDataUploadDesc uploadDesc;
+			uploadDesc.bufferRegion.offset = targetOffset;
+			uploadDesc.bufferRegion.size = pRequest.dataSize;
+			uploadDesc.inputDataDesc.pointer = _pendingDataBuffer.data() + pRequest.dataOffset;
+			uploadDesc.inputDataDesc.size = pRequest.dataSize;
+
+			pCommandContext.UpdateBufferSubDataUpload( *targetBuffer, uploadDesc );
+
+			_stats.uploadedBytesNum += pRequest.dataSize;
+			_stats.transferCommandsNum += 1;
+		}
+
+		_stats.pendingBytesNum -= pRequest.dataSize;
+	}
+
+	void GeometryDataGPUTransferStaging::ReleaseProcessedRequests()
+	{
+		if( _pendingRequestsHead == _pendingRequestList.size() )
+		{
+			_pendingRequestList.clear();
+			_pendingDataBuffer.clear();
+			_pendingRequestsHead = 0;
+			_flushedTicket = _lastTicket;
+			return;
+		}
+
+		// Requests of the first remaining ticket may have been partially processed already.
+		_flushedTicket = _pendingRequestList[_pendingRequestsHead].ticket - 1;
+
+		// Processed entries are removed only when they make up the larger part of the queue, so the cost
+		// of moving the remaining ones is amortized over multiple frames.
+		if( _pendingRequestsHead * 2 >= _pendingRequestList.size() )
+		{
+			const auto dataOffsetBase = _pendingRequestList[_pendingRequestsHead].dataOffset;
 
-			GCI::GPUBufferSubDataUploadDesc gpaDataUploadDesc;
-			gpaDataUploadDesc.bufferRegion.offset = indexBufferRegion.offsetInElementsNum * pGeometryRef.dataReference.dataFormat->indexElementSizeInBytes();
-			gpaDataUploadDesc.bufferRegion.size = indexBufferRegion.sizeInElementsNum * pGeometryRef.dataReference.dataFormat->indexElementSizeInBytes();
-			gpaDataUploadDesc.inputDataDesc.mPointer = inputDataRegion.mDataPtr;
-			gpaDataUploadDesc.inputDataDesc.size = inputDataRegion.sizeInElementsNum * inputDataRegion.elementSize;
+			_pendingRequestList.erase( _pendingRequestList.begin(), _pendingRequestList.begin() + _pendingRequestsHead );
+			_pendingDataBuffer.erase( _pendingDataBuffer.begin(), _pendingDataBuffer.begin() + dataOffsetBase );
+			_pendingRequestsHead = 0;
 
-			mTransferCmdContext.updateBufferSubDataUpload( *indexBuffer, gpaDataUploadDesc );
+			for( auto & pendingRequest : _pendingRequestList )
+			{
+				pendingRequest.dataOffset -= dataOffsetBase;
+			}
 		}
 	}
 
-}
+} // namespace Ic3
@@ -4,71 +4,251 @@
 #ifndef __IC3_NXMAIN_GEOMETRY_DATA_GPU_TRANSFER_H__
 #define __IC3_NXMAIN_GEOMETRY_DATA_GPU_TRANSFER_H__
 
-#include "GeometryCommonDefs.h"
-#include <Ic3/Graphics/GCI/CommandContext.h>
+#include "GeometryBufferPool.h"
+#include <Ic3/Graphics/GCI/CommonCommandDefs.h>
 
 namespace Ic3
 {
 
-	using GpaTransferCommandContext = GCI::CommandContextDirectTransfer;
-	using GpaTransferCommandContextHandle = GCI::TGfxHandle<GCI::CommandContextDirectTransfer>;
+	/// @brief Identifies a single upload request (all parts of a mesh share one ticket). Tickets are increasing,
+	/// so the state of all requests can be checked with a single value. Zero is never a valid ticket.
+	using geometry_upload_ticket_t = uint64;
 
-	class GeometryDataGPUTransfer : public CoreEngineObject
+	inline constexpr geometry_upload_ticket_t kGeometryUploadTicketInvalid = 0;
+
+	inline constexpr GCI::gpu_memory_size_t kGeometryDataStagingDefaultFrameBudget = 8 * 1024 * 1024;
+
+	inline constexpr uint32 kGeometryDataStagingDefaultFramesInFlightNum = 3;
+
+	/// @brief Source data of a mesh allocated in a GeometryBufferPool. The sizes are taken from the allocation:
+	/// every non-null vertex pointer must point to verticesNum elements of the stream stride and the index data
+	/// must contain indicesNum indices of the index format of the pool.
+	struct GeometryMeshUploadDesc
 	{
-	public:
-		GpaTransferCommandContext & mTransferCmdContext;
+		const void * vertexStreamDataArray[GCM::kIAMaxDataStreamVertexBuffersNum] = {};
+		const void * indexData = nullptr;
+	};
 
-	public:
-		GeometryDataGPUTransfer(
-				CoreEngineState & pCES,
-				GpaTransferCommandContext & pTransferCmdContext );
+	struct GeometryDataTransferStats
+	{
+		/// Number of accepted upload requests (tickets).
+		uint64 requestsNum = 0;
 
-		virtual ~GeometryDataGPUTransfer();
+		/// Number of bytes written to the target buffers.
+		uint64 uploadedBytesNum = 0;
+
+		/// Number of transfer commands (copies, uploads and buffer mappings) issued to the command context.
+		uint64 transferCommandsNum = 0;
 
-		virtual void initializeMeshData(
-				const GeometryReference & pGeometryRef,
-			const GeometryDataReferenceBase & pInputDataRef ) = 0;
+		/// Number of bytes which have been queued, but not yet written.
+		uint64 pendingBytesNum = 0;
 	};
 
-	class GeometryDataGPUTransferDirectCopy : public GeometryDataGPUTransfer
+	/// @brief Base class for strategies of writing geometry data into GPU buffers.
+	/// Data passed to the Upload*() functions is always copied (or written) before the call returns, so the
+	/// source memory can be released immediately. The GPU-side update, however, may be deferred by a strategy:
+	/// geometry should not be drawn until IsUploadFlushed() returns true for its ticket.
+	/// Uploads into a GeometryBufferPool are recorded relative to the allocation, so they remain valid when
+	/// the pool is relocated between the upload and the flush. If the allocation is freed in the meantime,
+	/// its pending data is discarded.
+	class IC3_NXMAIN_CLASS GeometryDataGPUTransfer
 	{
 	public:
-		GeometryDataGPUTransferDirectCopy();
+		GCI::GPUDevice & mGPUDevice;
+
+	public:
+		explicit GeometryDataGPUTransfer( GCI::GPUDevice & pGPUDevice );
+		virtual ~GeometryDataGPUTransfer();
+
+		/// @brief Writes pDataSize bytes into the buffer, starting at pBufferOffset.
+		geometry_upload_ticket_t UploadBufferData(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				const GCI::GPUBufferHandle & pBuffer,
+				GCI::gpu_memory_size_t pBufferOffset,
+				const void * pData,
+				GCI::gpu_memory_size_t pDataSize );
 
-		virtual ~GeometryDataGPUTransferDirectCopy();
+		/// @brief Writes the vertex and index data of a mesh into its allocation in the pool.
+		geometry_upload_ticket_t UploadMeshData(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				GeometryBufferPool & pGeometryBufferPool,
+				geometry_pool_allocation_id_t pAllocationID,
+				const GeometryMeshUploadDesc & pUploadDesc );
 
-		virtual void initializeMeshData(
-				const GeometryReference & pGeometryRef,
-				const GeometryDataReferenceBase & pInputDataRef ) override final
+		/// @brief Issues the transfer commands for the queued data (within the limits of the strategy).
+		virtual void Flush( GCI::CommandContextDirectTransfer & pCommandContext );
+
+		/// @brief Returns true if the transfer commands for the request have been issued to the command context.
+		CPPX_ATTR_NO_DISCARD bool IsUploadFlushed( geometry_upload_ticket_t pTicket ) const noexcept
+		{
+			return pTicket <= _flushedTicket;
+		}
+
+		CPPX_ATTR_NO_DISCARD const GeometryDataTransferStats & GetStats() const noexcept
 		{
+			return _stats;
 		}
+
+		void ResetStats();
+
+	protected:
+		/// Marks the slot of the index buffer in an UploadTarget.
+		static constexpr uint32 kUploadTargetIndexBufferSlot = cppx::meta::limits<uint32>::max_value;
+
+		/// @brief Destination of a single, contiguous write: either an explicit buffer region or
+		/// a region of a pool allocation (resolved only when the data is actually written).
+		struct UploadTarget
+		{
+			GCI::GPUBufferHandle buffer;
+			GeometryBufferPool * geometryBufferPool = nullptr;
+			geometry_pool_allocation_id_t allocationID = kGeometryPoolAllocationIDInvalid;
+			uint32 streamSlot = 0;
+			GCI::gpu_memory_size_t offset = 0;
+		};
+
+		/// @brief Writes or queues the data. Returns false if the request has been rejected.
+		virtual bool QueueUpload(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				const UploadTarget & pTarget,
+				const void * pData,
+				GCI::gpu_memory_size_t pDataSize,
+				geometry_upload_ticket_t pTicket ) = 0;
+
+		/// @brief Computes the current location of the target. Returns false if the target is no longer valid.
+		static bool ResolveUploadTarget(
+				const UploadTarget & pTarget,
+				GCI::gpu_memory_size_t pDataSize,
+				GCI::GPUBuffer *& pOutBuffer,
+				GCI::gpu_memory_size_t & pOutBufferOffset );
+
+	protected:
+		GeometryDataTransferStats _stats;
+		geometry_upload_ticket_t _lastTicket = kGeometryUploadTicketInvalid;
+		geometry_upload_ticket_t _flushedTicket = kGeometryUploadTicketInvalid;
 	};
 
-	class GeometryDataGPUTransferIntermediateBuffer : public GeometryDataGPUTransfer
+	/// @brief Writes the data immediately. Host-writable buffers are mapped once and stay mapped until Flush(),
+	/// so consecutive writes into the same buffer cost a single memcpy each. Only the written regions are marked
+	/// as dirty, so unmapping flushes just them. Other buffers are updated with UpdateBufferSubDataUpload().
+	/// This is the right choice for dynamic (CPU-visible) geometry and for small amounts of static data.
+	class IC3_NXMAIN_CLASS GeometryDataGPUTransferDirect : public GeometryDataGPUTransfer
 	{
 	public:
-		GeometryDataGPUTransferIntermediateBuffer();
-		virtual ~GeometryDataGPUTransferIntermediateBuffer();
+		explicit GeometryDataGPUTransferDirect( GCI::GPUDevice & pGPUDevice );
+		virtual ~GeometryDataGPUTransferDirect();
 
-		virtual void initializeMeshData(
-				const GeometryReference & pGeometryRef,
-				const GeometryDataReferenceBase & pInputDataRef )  override final
-		{
-		}
+		/// @brief Unmaps all buffers mapped by the previous writes.
+		virtual void Flush( GCI::CommandContextDirectTransfer & pCommandContext ) override final;
+
+	protected:
+		virtual bool QueueUpload(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				const UploadTarget & pTarget,
+				const void * pData,
+				GCI::gpu_memory_size_t pDataSize,
+				geometry_upload_ticket_t pTicket ) override final;
+
+	private:
+		byte * GetMappedBufferMemory( GCI::CommandContextDirectTransfer & pCommandContext, GCI::GPUBuffer & pBuffer );
+
+	private:
+		/// Buffers mapped by this object. The handles keep them alive until they are unmapped.
+		std::vector<GCI::GPUBufferHandle> _mappedBufferList;
 	};
 
-	class GeometryDataGPUTransferUpload : public GeometryDataGPUTransfer
+	struct GeometryDataStagingTransferCreateInfo
+	{
+		/// Maximum number of bytes transferred in a single frame. Requests above the budget wait for the next frame.
+		/// This is also the size of a single segment of the staging buffer.
+		GCI::gpu_memory_size_t frameBudget = kGeometryDataStagingDefaultFrameBudget;
+
+		/// Number of frames the CPU can record ahead of the GPU. The staging buffer has one segment per frame.
+		uint32 framesInFlightNum = kGeometryDataStagingDefaultFramesInFlightNum;
+	};
+
+	/// @brief Queues the data and transfers it in Flush() through a ring of staging segments (one per frame in flight,
+	/// synchronized like ConstantBufferRingAllocator). Queued requests are sorted by their target location and packed
+	/// into the staging memory, so writes to adjacent regions (e.g. meshes allocated one after another in a pool)
+	/// become a single UpdateBufferSubDataCopy(). Each frame transfers at most frameBudget bytes, requests above that
+	/// are kept (in order) for the next frames - streaming a large batch of meshes is spread over multiple frames
+	/// instead of stalling one. A single request larger than the budget is uploaded directly when it is first in the queue.
+	/// Usage per frame: BeginFrame(), Upload*(), Flush() (before the submission), EndFrame( submissionSync ).
+	class IC3_NXMAIN_CLASS GeometryDataGPUTransferStaging : public GeometryDataGPUTransfer
 	{
 	public:
-		GeometryDataGPUTransferUpload(
-				CoreEngineState & pCES,
-				GpaTransferCommandContext & pTransferCmdContext);
+		explicit GeometryDataGPUTransferStaging( GCI::GPUDevice & pGPUDevice );
+		virtual ~GeometryDataGPUTransferStaging();
+
+		/// @brief Creates the staging buffer and maps it (if possible). Returns false if the buffer could not be created.
+		bool Initialize( GCI::CommandContext & pCommandContext, const GeometryDataStagingTransferCreateInfo & pCreateInfo );
+
+		/// @brief Waits for all pending frames and releases the staging buffer. Queued requests are discarded.
+		void Release( GCI::CommandContext & pCommandContext );
+
+		/// @brief Moves to the next staging segment. Blocks if the GPU is still using it.
+		void BeginFrame();
+
+		/// @brief Transfers queued requests, up to the remaining budget of the current frame.
+		virtual void Flush( GCI::CommandContextDirectTransfer & pCommandContext ) override final;
+
+		/// @brief Completes the current frame. pFrameSync should be the sync of the submission which executed its transfers.
+		void EndFrame( GCI::CommandSync pFrameSync );
+
+		CPPX_ATTR_NO_DISCARD bool HasPendingUploads() const noexcept
+		{
+			return _pendingRequestsHead < _pendingRequestList.size();
+		}
+
+		CPPX_ATTR_NO_DISCARD bool IsPersistentlyMapped() const noexcept
+		{
+			return _mappedMemoryPtr && _stagingMemory.empty();
+		}
+
+	protected:
+		virtual bool QueueUpload(
+				GCI::CommandContextDirectTransfer & pCommandContext,
+				const UploadTarget & pTarget,
+				const void * pData,
+				GCI::gpu_memory_size_t pDataSize,
+				geometry_upload_ticket_t pTicket ) override final;
+
+	private:
+		struct PendingRequest
+		{
+			UploadTarget target;
+			size_t dataOffset;
+			GCI::gpu_memory_size_t dataSize;
+			geometry_upload_ticket_t ticket;
+		};
+
+		struct ResolvedRequest
+		{
+			GCI::GPUBuffer * buffer;
+			GCI::gpu_memory_size_t bufferOffset;
+			GCI::gpu_memory_size_t dataSize;
+			size_t dataOffset;
+			// Position in the batch taken by Flush(), used to restore the submission order of overlapping writes.
+			uint32 submissionIndex;
+		};
+
+		void UploadOversizedRequest( GCI::CommandContextDirectTransfer & pCommandContext, const PendingRequest & pRequest );
 
-		virtual ~GeometryDataGPUTransferUpload();
+		void ReleaseProcessedRequests();
 
-		virtual void initializeMeshData(
-				const GeometryReference & pGeometryRef,
-				const GeometryDataReferenceBase & pInputDataRef )  override final;
+	private:
+		GCI::GPUBufferHandle _stagingBuffer;
+		byte * _mappedMemoryPtr = nullptr;
+		std::vector<byte> _stagingMemory;
+		std::vector<GCI::CommandSync> _segmentSyncArray;
+		std::vector<PendingRequest> _pendingRequestList;
+		std::vector<byte> _pendingDataBuffer;
+		std::vector<ResolvedRequest> _resolvedRequestList;
+		size_t _pendingRequestsHead = 0;
+		GCI::gpu_memory_size_t _frameBudget = 0;
+		GCI::gpu_memory_size_t _currentSegmentOffset = 0;
+		GCI::gpu_memory_size_t _currentSegmentUsedSize = 0;
+		uint32 _currentSegmentIndex = 0;
+		bool _coherentMemory = false;
 	};
 
 } // namespace Ic3
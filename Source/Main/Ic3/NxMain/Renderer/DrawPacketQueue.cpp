@@ -0,0 +1,257 @@
+
+#include "DrawPacketQueue.h"
+#include <algorithm>
+
+namespace Ic3
+{
+
+	// Below this number of packets, a comparison sort is faster than the 8 radix passes.
+	static constexpr size_t kDrawPacketQueueRadixSortMinEntriesNum = 256;
+
+	static constexpr uint32 kDrawSortKeyPassShift = 64 - kDrawSortKeyPassBitsNum;
+
+	static constexpr uint32 kDrawSortKeyDepthMaxValue = ( 1u << kDrawSortKeyDepthBitsNum ) - 1;
+
+	DrawPacketQueue::DrawPacketQueue()
+	{
+		std::fill( std::begin( _unsortedPassStateArray ), std::end( _unsortedPassStateArray ), UnsortedPassState{} );
+	}
+
+	DrawPacketQueue::~DrawPacketQueue() = default;
+
+	void DrawPacketQueue::SetDepthRange( float pDepthNear, float pDepthFar )
+	{
+		Ic3DebugAssert( pDepthFar > pDepthNear );
+
+		_depthNear = pDepthNear;
+		_depthRangeInv = 1.0f / ( pDepthFar - pDepthNear );
+	}
+
+	void DrawPacketQueue::SetDrawConstantBufferParamRefID( GCI::shader_input_ref_id_t pParamRefID )
+	{
+		_drawConstantBufferParamRefID = pParamRefID;
+	}
+
+	void DrawPacketQueue::AddPacket(
+			uint32 pPassIndex,
+			float pDepth,
+			EDrawPacketDepthOrder pDepthOrder,
+			const DrawPacket & pPacket )
+	{
+		AddPacketWithKey( MakeSortKey( pPassIndex, pDepth, pDepthOrder, pPacket ), pPacket );
+	}
+
+	void DrawPacketQueue::AddPacketWithKey( draw_sort_key_t pSortKey, const DrawPacket & pPacket )
+	{
+		Ic3DebugAssert( pPacket.pipelineStateObject && pPacket.vertexSourceBinding );
+
+		const auto packetIndex = static_cast<uint32>( _packetArray.size() );
+
+		CountUnsortedStateChanges( static_cast<uint32>( pSortKey >> kDrawSortKeyPassShift ), pPacket );
+
+		_packetArray.push_back( pPacket );
+		_sortEntryArray.push_back( SortEntry{ pSortKey, packetIndex } );
+		_sorted = false;
+	}
+
+	void DrawPacketQueue::Sort()
+	{
+		if( _sortEntryArray.size() < kDrawPacketQueueRadixSortMinEntriesNum )
+		{
+			std::stable_sort(
+					_sortEntryArray.begin(),
+					_sortEntryArray.end(),
+					[]( const SortEntry & pFirst, const SortEntry & pSecond ) -> bool {
+						return pFirst.sortKey < pSecond.sortKey;
+					} );
+		}
+		else
+		{
+			RadixSort( _sortEntryArray, _sortTempArray );
+		}
+
+		_sorted = true;
+	}
+
+	void DrawPacketQueue::Reset()
+	{
+		_packetArray.clear();
+		_sortEntryArray.clear();
+		std::fill( std::begin( _unsortedPassStateArray ), std::end( _unsortedPassStateArray ), UnsortedPassState{} );
+		_sorted = false;
+	}
+
+	void DrawPacketQueue::ResetAll()
+	{
+		Reset();
+		_pipelineStateObjectIDMap.clear();
+		_vertexSourceIDMap.clear();
+		_materialIDMap.clear();
+	}
+
+	draw_sort_key_t DrawPacketQueue::MakeSortKey(
+			uint32 pPassIndex,
+			float pDepth,
+			EDrawPacketDepthOrder pDepthOrder,
+			const DrawPacket & pPacket )
+	{
+		Ic3DebugAssert( pPassIndex < kDrawPacketQueuePassesMaxNum );
+
+		const auto pipelineStateObjectID = static_cast<draw_sort_key_t>( GetStateObjectID( _pipelineStateObjectIDMap, pPacket.pipelineStateObject ) );
+		const auto vertexSourceID = static_cast<draw_sort_key_t>( GetStateObjectID( _vertexSourceIDMap, pPacket.vertexSourceBinding ) );
+		const auto materialID = static_cast<draw_sort_key_t>( GetStateObjectID( _materialIDMap, pPacket.material ) );
+		const auto depthValue = static_cast<draw_sort_key_t>( QuantizeDepth( pDepth ) );
+
+		auto sortKey = static_cast<draw_sort_key_t>( pPassIndex ) << kDrawSortKeyPassShift;
+
+		if( pDepthOrder == EDrawPacketDepthOrder::FrontToBack )
+		{
+			// [ pass : 4 | PSO : 12 | vertex source : 12 | material : 12 | depth : 24 ]
+			sortKey |= pipelineStateObjectID << ( kDrawSortKeyVertexSourceBitsNum + kDrawSortKeyMaterialBitsNum + kDrawSortKeyDepthBitsNum );
+			sortKey |= vertexSourceID << ( kDrawSortKeyMaterialBitsNum + kDrawSortKeyDepthBitsNum );
+			sortKey |= materialID << kDrawSortKeyDepthBitsNum;
+			sortKey |= depthValue;
+		}
+		else
+		{
+			// [ pass : 4 | inverted depth : 24 | PSO : 12 | vertex source : 12 | material : 12 ]
+			sortKey |= ( kDrawSortKeyDepthMaxValue - depthValue ) << ( kDrawSortKeyPipelineStateObjectBitsNum + kDrawSortKeyVertexSourceBitsNum + kDrawSortKeyMaterialBitsNum );
+			sortKey |= pipelineStateObjectID << ( kDrawSortKeyVertexSourceBitsNum + kDrawSortKeyMaterialBitsNum );
+			sortKey |= vertexSourceID << kDrawSortKeyMaterialBitsNum;
+			sortKey |= materialID;
+		}
+
+		return sortKey;
+	}
+
+	uint32 DrawPacketQueue::GetStateObjectID( std::unordered_map<const void *, uint32> & pIDMap, const void * pObject )
+	{
+		// ID 0 is reserved for null objects (e.g. packets without a material).
+		if( !pObject )
+		{
+			return 0;
+		}
+
+		const auto objectIDIter = pIDMap.find( pObject );
+		if( objectIDIter != pIDMap.end() )
+		{
+			return objectIDIter->second;
+		}
+
+		const auto objectID = static_cast<uint32>( ( pIDMap.size() % ( kDrawPacketQueueStateObjectIDsMaxNum - 1 ) ) + 1 );
+		pIDMap.emplace( pObject, objectID );
+
+		return objectID;
+	}
+
+	uint32 DrawPacketQueue::QuantizeDepth( float pDepth ) const noexcept
+	{
+		const auto normalizedDepth = ( pDepth - _depthNear ) * _depthRangeInv;
+		if( !( normalizedDepth > 0.0f ) )
+		{
+			return 0;
+		}
+		if( normalizedDepth >= 1.0f )
+		{
+			return kDrawSortKeyDepthMaxValue;
+		}
+		return static_cast<uint32>( normalizedDepth * static_cast<float>( kDrawSortKeyDepthMaxValue ) );
+	}
+
+	DrawPacketQueue::SortedRange DrawPacketQueue::GetPassRange( uint32 pPassIndex ) const noexcept
+	{
+		const auto passKeyBegin = static_cast<draw_sort_key_t>( pPassIndex ) << kDrawSortKeyPassShift;
+
+		const auto compareEntryKey = []( const SortEntry & pEntry, draw_sort_key_t pKey ) -> bool {
+			return pEntry.sortKey < pKey;
+		};
+
+		const auto rangeBegin = std::lower_bound( _sortEntryArray.begin(), _sortEntryArray.end(), passKeyBegin, compareEntryKey );
+		auto rangeEnd = _sortEntryArray.end();
+
+		if( pPassIndex + 1 < kDrawPacketQueuePassesMaxNum )
+		{
+			const auto passKeyEnd = static_cast<draw_sort_key_t>( pPassIndex + 1 ) << kDrawSortKeyPassShift;
+			rangeEnd = std::lower_bound( rangeBegin, _sortEntryArray.end(), passKeyEnd, compareEntryKey );
+		}
+
+		return SortedRange{
+			static_cast<uint32>( rangeBegin - _sortEntryArray.begin() ),
+			static_cast<uint32>( rangeEnd - rangeBegin )
+		};
+	}
+
+	void DrawPacketQueue::CountUnsortedStateChanges( uint32 pPassIndex, const DrawPacket & pPacket )
+	{
+		auto & passState = _unsortedPassStateArray[pPassIndex];
+
+		if( pPacket.pipelineStateObject != passState.pipelineStateObject )
+		{
+			passState.pipelineStateObject = pPacket.pipelineStateObject;
+			++passState.stateChanges.pipelineStateObjectChangesNum;
+		}
+		if( pPacket.vertexSourceBinding != passState.vertexSourceBinding )
+		{
+			passState.vertexSourceBinding = pPacket.vertexSourceBinding;
+			++passState.stateChanges.vertexSourceChangesNum;
+		}
+		if( pPacket.material && ( pPacket.material != passState.material ) )
+		{
+			passState.material = pPacket.material;
+			++passState.stateChanges.materialChangesNum;
+		}
+	}
+
+	void DrawPacketQueue::RadixSort( std::vector<SortEntry> & pEntries, std::vector<SortEntry> & pTempEntries )
+	{
+		constexpr uint32 cxRadixBits = 8;
+		constexpr uint32 cxRadixBucketsNum = 1u << cxRadixBits;
+		constexpr uint32 cxRadixPassesNum = sizeof( draw_sort_key_t ) * 8 / cxRadixBits;
+
+		const auto entriesNum = pEntries.size();
+
+		// Histograms for all passes are computed in a single read of the keys.
+		std::vector<uint32> histogramArray( cxRadixPassesNum * cxRadixBucketsNum, 0 );
+		for( const auto & sortEntry : pEntries )
+		{
+			for( uint32 passIndex = 0; passIndex < cxRadixPassesNum; ++passIndex )
+			{
+				const auto digit = static_cast<uint32>( sortEntry.sortKey >> ( passIndex * cxRadixBits ) ) & ( cxRadixBucketsNum - 1 );
+				++histogramArray[passIndex * cxRadixBucketsNum + digit];
+			}
+		}
+
+		pTempEntries.resize( entriesNum );
+
+		for( uint32 passIndex = 0; passIndex < cxRadixPassesNum; ++passIndex )
+		{
+			auto * passHistogram = histogramArray.data() + passIndex * cxRadixBucketsNum;
+			const auto passShift = passIndex * cxRadixBits;
+
+			// If all keys have the same digit, this pass would not change the order. This is very common for
+			// the upper bytes (few passes, few PSOs), so usually only about half of the passes are executed.
+			const auto firstDigit = static_cast<uint32>( pEntries[0].sortKey >> passShift ) & ( cxRadixBucketsNum - 1 );
+			if( passHistogram[firstDigit] == entriesNum )
+			{
+				continue;
+			}
+
+			uint32 bucketOffset = 0;
+			for( uint32 bucketIndex = 0; bucketIndex < cxRadixBucketsNum; ++bucketIndex )
+			{
+				const auto bucketSize = passHistogram[bucketIndex];
+				passHistogram[bucketIndex] = bucketOffset;
+				bucketOffset += bucketSize;
+			}
+
+			for( const auto & sortEntry : pEntries )
+			{
+				const auto digit = static_cast<uint32>( sortEntry.sortKey >> passShift ) & ( cxRadixBucketsNum - 1 );
+				pTempEntries[passHistogram[digit]++] = sortEntry;
+			}
+
+			pEntries.swap( pTempEntries );
+		}
+	}
+
+} // namespace Ic3
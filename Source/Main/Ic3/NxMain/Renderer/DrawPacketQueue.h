@@ -0,0 +1,251 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_DRAW_PACKET_QUEUE_H__
+#define __IC3_NXMAIN_DRAW_PACKET_QUEUE_H__
+
+#include "CommonRendererDefs.h"
+#include <Ic3/Graphics/GCI/Memory/CommonGPUMemoryDefs.h>
+#include <unordered_map>
+
+namespace Ic3
+{
+
+	using draw_sort_key_t = uint64;
+
+	/// @brief Layout of the 64-bit sort key. Opaque packets are ordered by state (pass, PSO, vertex source, material)
+	/// and then front-to-back. Translucent packets are ordered back-to-front first and by state only within the same
+	/// depth, so the blending order stays correct. The pass is always the most significant part.
+	inline constexpr uint32 kDrawSortKeyPassBitsNum = 4;
+	inline constexpr uint32 kDrawSortKeyPipelineStateObjectBitsNum = 12;
+	inline constexpr uint32 kDrawSortKeyVertexSourceBitsNum = 12;
+	inline constexpr uint32 kDrawSortKeyMaterialBitsNum = 12;
+	inline constexpr uint32 kDrawSortKeyDepthBitsNum = 24;
+
+	/// @brief Max number of passes (render passes/layers) a single queue can hold.
+	inline constexpr uint32 kDrawPacketQueuePassesMaxNum = 1u << kDrawSortKeyPassBitsNum;
+
+	/// @brief Max number of distinct PSOs, vertex sources and materials with unique sort key IDs. Objects registered
+	/// beyond that limit share IDs, which only makes the grouping less efficient (binding is based on the pointers).
+	inline constexpr uint32 kDrawPacketQueueStateObjectIDsMaxNum = 1u << kDrawSortKeyPipelineStateObjectBitsNum;
+
+	inline constexpr uint32 kDrawPacketMaterialConstantBuffersMaxNum = 4;
+
+	inline constexpr uint32 kDrawPacketMaterialTexturesMaxNum = 8;
+
+	enum class EDrawPacketType : uint16
+	{
+		DirectIndexed,
+		DirectIndexedInstanced,
+		DirectNonIndexed,
+		DirectNonIndexedInstanced,
+	};
+
+	enum class EDrawPacketDepthOrder : uint16
+	{
+		/// State-first ordering, front-to-back within the same state. Used for opaque geometry.
+		FrontToBack,
+
+		/// Depth-first, back-to-front ordering. Used for geometry with blending enabled.
+		BackToFront,
+	};
+
+	/// @brief Set of shader inputs shared by multiple draws. Bound only when it differs from the previous packet's one.
+	struct DrawPacketMaterial
+	{
+		struct ConstantBufferBinding
+		{
+			GCI::shader_input_ref_id_t paramRefID;
+			GCI::GPUBuffer * buffer;
+
+			/// Region of the buffer to bind. An empty region binds the whole buffer.
+			GCI::GPUMemoryRegion bufferRegion;
+		};
+
+		struct TextureBinding
+		{
+			GCI::shader_input_ref_id_t textureRefID;
+			GCI::Texture * texture;
+			GCI::shader_input_ref_id_t samplerRefID;
+			GCI::Sampler * sampler;
+		};
+
+		ConstantBufferBinding constantBufferArray[kDrawPacketMaterialConstantBuffersMaxNum];
+		uint32 constantBuffersNum = 0;
+
+		TextureBinding textureArray[kDrawPacketMaterialTexturesMaxNum];
+		uint32 texturesNum = 0;
+	};
+
+	/// @brief A single draw with everything required to submit it. All referenced objects must stay alive until
+	/// the queue is submitted (the queue stores only pointers).
+	struct DrawPacket
+	{
+		const GCI::GraphicsPipelineStateObject * pipelineStateObject = nullptr;
+
+		const GCI::VertexSourceBindingDescriptor * vertexSourceBinding = nullptr;
+
+		/// Optional. Null means the draw does not use any material inputs.
+		const DrawPacketMaterial * material = nullptr;
+
+		/// Optional per-draw constants (e.g. a slice of a ConstantBufferRingAllocator), bound to the parameter
+		/// specified with DrawPacketQueue::SetDrawConstantBufferParamRefID().
+		GCI::GPUBuffer * drawConstantBuffer = nullptr;
+		GCI::GPUMemoryRegion drawConstantBufferRegion;
+
+		EDrawPacketType drawType = EDrawPacketType::DirectIndexed;
+
+		/// Number of indices (indexed draws) or vertices (non-indexed draws), per instance for instanced draws.
+		uint32 elementsNum = 0;
+		uint32 elementsOffset = 0;
+		uint32 baseVertexIndex = 0;
+		uint32 instancesNum = 1;
+	};
+
+	/// @brief Number of state bindings issued by the last submission. "Avoided" counts compare it with binding
+	/// everything for every draw, "unsorted" ones - with the number of changes the packets would cause if they
+	/// were submitted in the order they have been added.
+	struct DrawPacketQueueStats
+	{
+		uint32 drawsNum = 0;
+		uint32 pipelineStateObjectBindsNum = 0;
+		uint32 vertexSourceBindsNum = 0;
+		uint32 materialBindsNum = 0;
+		uint32 drawConstantBufferBindsNum = 0;
+		uint32 pipelineStateObjectBindsAvoidedNum = 0;
+		uint32 vertexSourceBindsAvoidedNum = 0;
+		uint32 materialBindsAvoidedNum = 0;
+		uint32 pipelineStateObjectChangesUnsortedNum = 0;
+		uint32 vertexSourceChangesUnsortedNum = 0;
+		uint32 materialChangesUnsortedNum = 0;
+	};
+
+	/// @brief Per-frame queue of draws, sorted by 64-bit keys and submitted with minimal state changes.
+	/// Packets are added in any order (e.g. straight from a VisibilityDrawList), then Sort() orders them with an
+	/// LSD radix sort (skipping the byte passes in which all keys are equal) and Submit() issues the draws, calling
+	/// SetGraphicsPipelineStateObject(), SetVertexSourceBindingDescriptor() and binding material inputs only
+	/// if the object differs from the one used by the previous draw.
+	/// Sort key IDs of PSOs, vertex sources and materials are assigned on first use and kept between frames,
+	/// so the order of draws using the same objects is stable from frame to frame.
+	class IC3_NXMAIN_CLASS DrawPacketQueue
+	{
+	public:
+		DrawPacketQueue();
+		~DrawPacketQueue();
+
+		/// @brief Sets the depth range used to quantize the depth part of the keys. Depths outside are clamped.
+		void SetDepthRange( float pDepthNear, float pDepthFar );
+
+		/// @brief Sets the shader parameter to which per-draw constant buffers are bound.
+		void SetDrawConstantBufferParamRefID( GCI::shader_input_ref_id_t pParamRefID );
+
+		/// @brief Adds a packet to the specified pass. pDepth is usually the view depth of the object
+		/// (e.g. VisibleObject::viewDepth).
+		void AddPacket( uint32 pPassIndex, float pDepth, EDrawPacketDepthOrder pDepthOrder, const DrawPacket & pPacket );
+
+		/// @brief Adds a packet with an explicit sort key (see MakeSortKey()).
+		void AddPacketWithKey( draw_sort_key_t pSortKey, const DrawPacket & pPacket );
+
+		/// @brief Sorts all added packets. Must be called after all packets have been added and before Submit().
+		void Sort();
+
+		/// @brief Submits all packets of the specified pass. The context can be any graphics context (direct or
+		/// deferred) with a render pass already begun. Returns stats of this submission.
+		template <typename TCommandContext>
+		DrawPacketQueueStats Submit( TCommandContext & pCommandContext, uint32 pPassIndex );
+
+		/// @brief Submits packets of all passes, in order. For cases when no render pass change is needed between passes.
+		template <typename TCommandContext>
+		DrawPacketQueueStats SubmitAll( TCommandContext & pCommandContext );
+
+		/// @brief Removes all packets. Sort key IDs are kept.
+		void Reset();
+
+		/// @brief Removes all packets and forgets sort key IDs. Should be called when state objects are destroyed.
+		void ResetAll();
+
+		CPPX_ATTR_NO_DISCARD draw_sort_key_t MakeSortKey(
+				uint32 pPassIndex,
+				float pDepth,
+				EDrawPacketDepthOrder pDepthOrder,
+				const DrawPacket & pPacket );
+
+		CPPX_ATTR_NO_DISCARD size_t GetPacketsNum() const noexcept
+		{
+			return _packetArray.size();
+		}
+
+		CPPX_ATTR_NO_DISCARD const DrawPacketQueueStats & GetLastSubmitStats() const noexcept
+		{
+			return _lastSubmitStats;
+		}
+
+	private:
+		struct SortEntry
+		{
+			draw_sort_key_t sortKey;
+			uint32 packetIndex;
+		};
+
+		struct SortedRange
+		{
+			uint32 firstEntryIndex;
+			uint32 entriesNum;
+		};
+
+		struct StateChangesCount
+		{
+			uint32 pipelineStateObjectChangesNum;
+			uint32 vertexSourceChangesNum;
+			uint32 materialChangesNum;
+		};
+
+		/// State changes of a pass if its packets were submitted in the order of addition. Updated by every
+		/// AddPacketWithKey(), so it does not depend on the (possibly already sorted) order of the sort entries.
+		struct UnsortedPassState
+		{
+			const GCI::GraphicsPipelineStateObject * pipelineStateObject;
+			const GCI::VertexSourceBindingDescriptor * vertexSourceBinding;
+			const DrawPacketMaterial * material;
+			StateChangesCount stateChanges;
+		};
+
+		CPPX_ATTR_NO_DISCARD uint32 GetStateObjectID( std::unordered_map<const void *, uint32> & pIDMap, const void * pObject );
+
+		CPPX_ATTR_NO_DISCARD uint32 QuantizeDepth( float pDepth ) const noexcept;
+
+		CPPX_ATTR_NO_DISCARD SortedRange GetPassRange( uint32 pPassIndex ) const noexcept;
+
+		void CountUnsortedStateChanges( uint32 pPassIndex, const DrawPacket & pPacket );
+
+		template <typename TCommandContext>
+		void SubmitRange( TCommandContext & pCommandContext, const SortedRange & pRange, DrawPacketQueueStats & pStats );
+
+		template <typename TCommandContext>
+		static void BindMaterial( TCommandContext & pCommandContext, const DrawPacketMaterial & pMaterial );
+
+		template <typename TCommandContext>
+		static void ExecuteDraw( TCommandContext & pCommandContext, const DrawPacket & pPacket );
+
+		static void RadixSort( std::vector<SortEntry> & pEntries, std::vector<SortEntry> & pTempEntries );
+
+	private:
+		std::vector<DrawPacket> _packetArray;
+		std::vector<SortEntry> _sortEntryArray;
+		std::vector<SortEntry> _sortTempArray;
+		std::unordered_map<const void *, uint32> _pipelineStateObjectIDMap;
+		std::unordered_map<const void *, uint32> _vertexSourceIDMap;
+		std::unordered_map<const void *, uint32> _materialIDMap;
+		GCI::shader_input_ref_id_t _drawConstantBufferParamRefID = 0;
+		UnsortedPassState _unsortedPassStateArray[kDrawPacketQueuePassesMaxNum];
+		float _depthNear = 0.0f;
+		float _depthRangeInv = 1.0f / 1024.0f;
+		bool _sorted = false;
+		DrawPacketQueueStats _lastSubmitStats;
+	};
+
+} // namespace Ic3
+
+#include "DrawPacketQueue.inl"
+
+#endif // __IC3_NXMAIN_DRAW_PACKET_QUEUE_H__
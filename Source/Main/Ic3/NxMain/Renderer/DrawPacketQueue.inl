@@ -0,0 +1,174 @@
+
+#if !defined( __IC3_NXMAIN_DRAW_PACKET_QUEUE_H__ )
+#  error ".inl files must be included only via their related headers!"
+#endif
+
+namespace Ic3
+{
+
+	template <typename TCommandContext>
+	inline DrawPacketQueueStats DrawPacketQueue::Submit( TCommandContext & pCommandContext, uint32 pPassIndex )
+	{
+		Ic3DebugAssert( _sorted || _packetArray.empty() );
+		Ic3DebugAssert( pPassIndex < kDrawPacketQueuePassesMaxNum );
+
+		DrawPacketQueueStats submitStats{};
+		const auto & unsortedStateChanges = _unsortedPassStateArray[pPassIndex].stateChanges;
+		submitStats.pipelineStateObjectChangesUnsortedNum = unsortedStateChanges.pipelineStateObjectChangesNum;
+		submitStats.vertexSourceChangesUnsortedNum = unsortedStateChanges.vertexSourceChangesNum;
+		submitStats.materialChangesUnsortedNum = unsortedStateChanges.materialChangesNum;
+
+		SubmitRange( pCommandContext, GetPassRange( pPassIndex ), submitStats );
+
+		_lastSubmitStats = submitStats;
+
+		return submitStats;
+	}
+
+	template <typename TCommandContext>
+	inline DrawPacketQueueStats DrawPacketQueue::SubmitAll( TCommandContext & pCommandContext )
+	{
+		Ic3DebugAssert( _sorted || _packetArray.empty() );
+
+		DrawPacketQueueStats submitStats{};
+		for( const auto & unsortedPassState : _unsortedPassStateArray )
+		{
+			submitStats.pipelineStateObjectChangesUnsortedNum += unsortedPassState.stateChanges.pipelineStateObjectChangesNum;
+			submitStats.vertexSourceChangesUnsortedNum += unsortedPassState.stateChanges.vertexSourceChangesNum;
+			submitStats.materialChangesUnsortedNum += unsortedPassState.stateChanges.materialChangesNum;
+		}
+
+		SubmitRange( pCommandContext, SortedRange{ 0, static_cast<uint32>( _sortEntryArray.size() ) }, submitStats );
+
+		_lastSubmitStats = submitStats;
+
+		return submitStats;
+	}
+
+	template <typename TCommandContext>
+	inline void DrawPacketQueue::SubmitRange(
+			TCommandContext & pCommandContext,
+			const SortedRange & pRange,
+			DrawPacketQueueStats & pStats )
+	{
+		// The state of the context before the submission is unknown, so the first packet always binds everything.
+		const GCI::GraphicsPipelineStateObject * currentPipelineStateObject = nullptr;
+		const GCI::VertexSourceBindingDescriptor * currentVertexSourceBinding = nullptr;
+		const DrawPacketMaterial * currentMaterial = nullptr;
+		const GCI::GPUBuffer * currentDrawConstantBuffer = nullptr;
+		GCI::GPUMemoryRegion currentDrawConstantBufferRegion{};
+
+		uint32 materialDrawsNum = 0;
+
+		for( uint32 entryIndex = pRange.firstEntryIndex; entryIndex < pRange.firstEntryIndex + pRange.entriesNum; ++entryIndex )
+		{
+			const auto & drawPacket = _packetArray[_sortEntryArray[entryIndex].packetIndex];
+
+			if( drawPacket.pipelineStateObject != currentPipelineStateObject )
+			{
+				pCommandContext.SetGraphicsPipelineStateObject( *drawPacket.pipelineStateObject );
+				currentPipelineStateObject = drawPacket.pipelineStateObject;
+				++pStats.pipelineStateObjectBindsNum;
+			}
+
+			if( drawPacket.vertexSourceBinding != currentVertexSourceBinding )
+			{
+				pCommandContext.SetVertexSourceBindingDescriptor( *drawPacket.vertexSourceBinding );
+				currentVertexSourceBinding = drawPacket.vertexSourceBinding;
+				++pStats.vertexSourceBindsNum;
+			}
+
+			if( drawPacket.material )
+			{
+				if( drawPacket.material != currentMaterial )
+				{
+					BindMaterial( pCommandContext, *drawPacket.material );
+					currentMaterial = drawPacket.material;
+					++pStats.materialBindsNum;
+				}
+
+				++materialDrawsNum;
+			}
+
+			if( drawPacket.drawConstantBuffer )
+			{
+				if( ( drawPacket.drawConstantBuffer != currentDrawConstantBuffer ) ||
+				    ( drawPacket.drawConstantBufferRegion.offset != currentDrawConstantBufferRegion.offset ) ||
+				    ( drawPacket.drawConstantBufferRegion.size != currentDrawConstantBufferRegion.size ) )
+				{
+					pCommandContext.CmdSetShaderConstantBufferRange(
+							_drawConstantBufferParamRefID,
+							*drawPacket.drawConstantBuffer,
+							drawPacket.drawConstantBufferRegion );
+
+					currentDrawConstantBuffer = drawPacket.drawConstantBuffer;
+					currentDrawConstantBufferRegion = drawPacket.drawConstantBufferRegion;
+					++pStats.drawConstantBufferBindsNum;
+				}
+			}
+
+			ExecuteDraw( pCommandContext, drawPacket );
+		}
+
+		pStats.drawsNum += pRange.entriesNum;
+		pStats.pipelineStateObjectBindsAvoidedNum = pStats.drawsNum - pStats.pipelineStateObjectBindsNum;
+		pStats.vertexSourceBindsAvoidedNum = pStats.drawsNum - pStats.vertexSourceBindsNum;
+		pStats.materialBindsAvoidedNum = materialDrawsNum - pStats.materialBindsNum;
+	}
+
+	template <typename TCommandContext>
+	inline void DrawPacketQueue::BindMaterial( TCommandContext & pCommandContext, const DrawPacketMaterial & pMaterial )
+	{
+		for( uint32 cbIndex = 0; cbIndex < pMaterial.constantBuffersNum; ++cbIndex )
+		{
+			const auto & cbBinding = pMaterial.constantBufferArray[cbIndex];
+			if( cbBinding.bufferRegion.size == 0 )
+			{
+				pCommandContext.CmdSetShaderConstantBuffer( cbBinding.paramRefID, *cbBinding.buffer );
+			}
+			else
+			{
+				pCommandContext.CmdSetShaderConstantBufferRange( cbBinding.paramRefID, *cbBinding.buffer, cbBinding.bufferRegion );
+			}
+		}
+
+		for( uint32 textureIndex = 0; textureIndex < pMaterial.texturesNum; ++textureIndex )
+		{
+			const auto & textureBinding = pMaterial.textureArray[textureIndex];
+			pCommandContext.CmdSetShaderTextureImage( textureBinding.textureRefID, *textureBinding.texture );
+			if( textureBinding.sampler )
+			{
+				pCommandContext.CmdSetShaderTextureSampler( textureBinding.samplerRefID, *textureBinding.sampler );
+			}
+		}
+	}
+
+	template <typename TCommandContext>
+	inline void DrawPacketQueue::ExecuteDraw( TCommandContext & pCommandContext, const DrawPacket & pPacket )
+	{
+		switch( pPacket.drawType )
+		{
+			case EDrawPacketType::DirectIndexed:
+			{
+				pCommandContext.CmdDrawDirectIndexed( pPacket.elementsNum, pPacket.elementsOffset, pPacket.baseVertexIndex );
+				break;
+			}
+			case EDrawPacketType::DirectIndexedInstanced:
+			{
+				pCommandContext.CmdDrawDirectIndexedInstanced( pPacket.elementsNum, pPacket.instancesNum, pPacket.elementsOffset );
+				break;
+			}
+			case EDrawPacketType::DirectNonIndexed:
+			{
+				pCommandContext.CmdDrawDirectNonIndexed( pPacket.elementsNum, pPacket.elementsOffset );
+				break;
+			}
+			case EDrawPacketType::DirectNonIndexedInstanced:
+			{
+				pCommandContext.CmdDrawDirectNonIndexedInstanced( pPacket.elementsNum, pPacket.instancesNum, pPacket.elementsOffset );
+				break;
+			}
+		}
+	}
+
+} // namespace Ic3
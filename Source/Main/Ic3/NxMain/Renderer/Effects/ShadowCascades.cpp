@@ -0,0 +1,200 @@
+
+#include "ShadowCascades.h"
+#include "../../Camera/CameraController.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+#include <cppx/bitUtils.h>
+#include <cmath>
+
+namespace Ic3
+{
+
+	// Number of casters tested by a single work item. Must be a multiple of 32, so each item owns whole mask words.
+	static constexpr size_t kShadowCasterCullingItemSize = 2048;
+
+	// Cascade radius is rounded up to this granularity. The radius computed for a given slice is constant
+	// in theory, but float errors make it fluctuate slightly, which would change the texel size every frame.
+	static constexpr float kShadowCascadeRadiusRoundingFactor = 16.0f;
+
+	ShadowCascadeViewDesc MakeShadowCascadeViewDesc(
+			const CameraController & pCameraController,
+			float pAspectRatio,
+			float pZNear,
+			float pZFar )
+	{
+		ShadowCascadeViewDesc viewDesc;
+		viewDesc.origin = pCameraController.mCameraState.orientation.origin;
+		viewDesc.vForward = pCameraController.mCameraState.orientation.vForward;
+		viewDesc.fovAngle = pCameraController.GetPerspectiveFOVAngle();
+		viewDesc.aspectRatio = pAspectRatio;
+		viewDesc.zNear = pZNear;
+		viewDesc.zFar = pZFar;
+		return viewDesc;
+	}
+
+	void ComputeShadowCascadeSplits(
+			const ShadowCascadeConfig & pConfig,
+			float pZNear,
+			float pZFar,
+			float * pSplitDepths )
+	{
+		Ic3DebugAssert( ( pConfig.cascadesNum > 0 ) && ( pConfig.cascadesNum <= kShadowCascadesMaxNum ) );
+		Ic3DebugAssert( ( pZNear > 0.0f ) && ( pZFar > pZNear ) );
+
+		const auto shadowFar = ( pConfig.shadowDistance > 0.0f ) ? std::min( pZFar, pConfig.shadowDistance ) : pZFar;
+		const auto depthRatio = shadowFar / pZNear;
+
+		pSplitDepths[0] = pZNear;
+
+		for( uint32 splitIndex = 1; splitIndex < pConfig.cascadesNum; ++splitIndex )
+		{
+			const auto splitFactor = static_cast<float>( splitIndex ) / static_cast<float>( pConfig.cascadesNum );
+			const auto uniformSplit = pZNear + ( shadowFar - pZNear ) * splitFactor;
+			const auto logarithmicSplit = pZNear * std::pow( depthRatio, splitFactor );
+			pSplitDepths[splitIndex] = uniformSplit + ( logarithmicSplit - uniformSplit ) * pConfig.splitLambda;
+		}
+
+		pSplitDepths[pConfig.cascadesNum] = shadowFar;
+	}
+
+	void ComputeShadowCascades(
+			const ShadowCascadeConfig & pConfig,
+			const ShadowCascadeViewDesc & pViewDesc,
+			const cxm::vec3f & pLightDirection,
+			ShadowCascadeSet & pCascadeSet )
+	{
+		float splitDepths[kShadowCascadesMaxNum + 1];
+		ComputeShadowCascadeSplits( pConfig, pViewDesc.zNear, pViewDesc.zFar, splitDepths );
+
+		// Squared distance of a slice corner from the view axis, per unit of view depth.
+		const auto tanHalfFovY = std::tan( pViewDesc.fovAngle * 0.5f );
+		const auto tanHalfFovX = tanHalfFovY * pViewDesc.aspectRatio;
+		const auto cornerOffsetFactorSq = tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY;
+
+		// The light view contains only the rotation. Its orientation must not depend on the camera - otherwise
+		// the texel grid would rotate with it and snapping would not prevent shimmering.
+		const auto lightDirection = cxm::normalize( pLightDirection );
+		const auto lightUpVector = ( std::abs( lightDirection.y ) > 0.99f ) ? cxm::vec3f{ 0.0f, 0.0f, 1.0f } : cxm::vec3f{ 0.0f, 1.0f, 0.0f };
+		const auto lightView = cxm::look_at_LH( cxm::vec3f{ 0.0f, 0.0f, 0.0f }, lightDirection, lightUpVector );
+
+		const auto shadowMapResolution = static_cast<float>( std::max<uint32>( pConfig.shadowMapResolution, 1 ) );
+
+		pCascadeSet.cascadesNum = pConfig.cascadesNum;
+
+		for( uint32 cascadeIndex = 0; cascadeIndex < pConfig.cascadesNum; ++cascadeIndex )
+		{
+			const auto sliceNear = splitDepths[cascadeIndex];
+			const auto sliceFar = splitDepths[cascadeIndex + 1];
+
+			// Smallest sphere enclosing the slice: its center lies on the view axis, at the depth where distances to
+			// the near and far corners are equal. For very wide slices that point is beyond the far plane, in which
+			// case the far corners alone define the sphere.
+			auto sphereCenterDepth = 0.5f * ( sliceNear + sliceFar ) * ( 1.0f + cornerOffsetFactorSq );
+			auto sphereRadius = 0.0f;
+			if( sphereCenterDepth < sliceFar )
+			{
+				const auto nearCenterDistance = sphereCenterDepth - sliceNear;
+				sphereRadius = std::sqrt( nearCenterDistance * nearCenterDistance + sliceNear * sliceNear * cornerOffsetFactorSq );
+			}
+			else
+			{
+				sphereCenterDepth = sliceFar;
+				sphereRadius = sliceFar * std::sqrt( cornerOffsetFactorSq );
+			}
+
+			sphereRadius = std::ceil( sphereRadius * kShadowCascadeRadiusRoundingFactor ) / kShadowCascadeRadiusRoundingFactor;
+
+			const auto sphereCenter = pViewDesc.origin + pViewDesc.vForward * sphereCenterDepth;
+			const auto texelWorldSize = ( 2.0f * sphereRadius ) / shadowMapResolution;
+
+			// Move the cascade in light space by whole texels only.
+			auto lightSpaceCenter = cxm::mul( lightView, cxm::vec4f{ sphereCenter.x, sphereCenter.y, sphereCenter.z, 1.0f } );
+			lightSpaceCenter.x = std::floor( lightSpaceCenter.x / texelWorldSize ) * texelWorldSize;
+			lightSpaceCenter.y = std::floor( lightSpaceCenter.y / texelWorldSize ) * texelWorldSize;
+
+			auto & cascade = pCascadeSet.cascadeArray[cascadeIndex];
+			cascade.mLightView = lightView;
+			cascade.mLightProjection = cxm::ortho_off_center_LH(
+					lightSpaceCenter.x - sphereRadius,
+					lightSpaceCenter.x + sphereRadius,
+					lightSpaceCenter.y - sphereRadius,
+					lightSpaceCenter.y + sphereRadius,
+					lightSpaceCenter.z - sphereRadius - pConfig.casterExtrusionDistance,
+					lightSpaceCenter.z + sphereRadius );
+			cascade.mLightSpace = cxm::mul( cascade.mLightProjection, cascade.mLightView );
+			cascade.cullingFrustum = cxm::frustum_from_matrix( cascade.mLightSpace, true );
+			cascade.splitNear = sliceNear;
+			cascade.splitFar = sliceFar;
+			cascade.texelWorldSize = texelWorldSize;
+		}
+	}
+
+	void CullShadowCasters(
+			const ShadowCascadeSet & pCascadeSet,
+			cxm::aabb_soa<const float> pCasters,
+			size_t pCastersNum,
+			ShadowCasterCullingResult & pResult,
+			WorkerThreadPool * pThreadPool )
+	{
+		const auto maskWordsNum = cxm::visibility_mask_words_num( pCastersNum );
+
+		for( uint32 cascadeIndex = 0; cascadeIndex < kShadowCascadesMaxNum; ++cascadeIndex )
+		{
+			// Masks of the active cascades are fully overwritten by the culling kernel.
+			auto & visibilityMask = pResult.visibilityMaskArray[cascadeIndex];
+			if( cascadeIndex < pCascadeSet.cascadesNum )
+			{
+				visibilityMask.resize( maskWordsNum );
+			}
+			else
+			{
+				visibilityMask.assign( maskWordsNum, 0u );
+			}
+			pResult.visibleCastersNum[cascadeIndex] = 0;
+		}
+
+		pResult.castersNum = static_cast<uint32>( pCastersNum );
+
+		if( pCastersNum == 0 )
+		{
+			return;
+		}
+
+		const auto itemsPerCascade = ( pCastersNum + kShadowCasterCullingItemSize - 1 ) / kShadowCasterCullingItemSize;
+		const auto itemsNum = itemsPerCascade * pCascadeSet.cascadesNum;
+
+		const auto cullItemRange = [&]( size_t pBeginItem, size_t pEndItem ) -> void {
+			for( auto itemIndex = pBeginItem; itemIndex < pEndItem; ++itemIndex )
+			{
+				const auto cascadeIndex = itemIndex / itemsPerCascade;
+				const auto casterOffset = ( itemIndex % itemsPerCascade ) * kShadowCasterCullingItemSize;
+				const auto castersNum = std::min( kShadowCasterCullingItemSize, pCastersNum - casterOffset );
+
+				cxm::frustum_cull_aabbs_soa(
+						pCascadeSet.cascadeArray[cascadeIndex].cullingFrustum,
+						pCasters.offset( casterOffset ),
+						castersNum,
+						pResult.visibilityMaskArray[cascadeIndex].data() + ( casterOffset / 32 ) );
+			}
+		};
+
+		if( pThreadPool )
+		{
+			pThreadPool->ParallelFor( itemsNum, 1, cullItemRange );
+		}
+		else
+		{
+			cullItemRange( 0, itemsNum );
+		}
+
+		for( uint32 cascadeIndex = 0; cascadeIndex < pCascadeSet.cascadesNum; ++cascadeIndex )
+		{
+			uint32 visibleCastersNum = 0;
+			for( const auto maskWord : pResult.visibilityMaskArray[cascadeIndex] )
+			{
+				visibleCastersNum += cppx::pop_count( maskWord );
+			}
+			pResult.visibleCastersNum[cascadeIndex] = visibleCastersNum;
+		}
+	}
+
+} // namespace Ic3
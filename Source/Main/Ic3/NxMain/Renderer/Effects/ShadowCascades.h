@@ -0,0 +1,111 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_SHADOW_CASCADES_H__
+#define __IC3_NXMAIN_SHADOW_CASCADES_H__
+
+#include "../../Prerequisites.h"
+#include <cxm/batchOps.h>
+
+namespace Ic3
+{
+
+	class CameraController;
+	class WorkerThreadPool;
+
+	/// @brief Max number of cascades supported. Matches the size of the cascade arrays in the shadow shaders.
+	inline constexpr uint32 kShadowCascadesMaxNum = 4;
+
+	struct ShadowCascadeConfig
+	{
+		uint32 cascadesNum = kShadowCascadesMaxNum;
+
+		/// Blend factor between the uniform (0.0) and the logarithmic (1.0) split schemes ("practical" splits).
+		float splitLambda = 0.75f;
+
+		/// Max view distance covered by the cascades. Zero means the whole view range ( zNear, zFar ).
+		float shadowDistance = 0.0f;
+
+		/// Resolution (in texels) of a single, square cascade. Used to snap cascades to the texel grid.
+		uint32 shadowMapResolution = 2048;
+
+		/// Distance by which the near plane of each cascade is moved towards the light, so casters located
+		/// outside the view slice (but between the slice and the light) still cast shadows into it.
+		float casterExtrusionDistance = 64.0f;
+	};
+
+	/// @brief Describes the view (camera) frustum, the cascades are fitted to. Assumes a LH perspective projection.
+	struct ShadowCascadeViewDesc
+	{
+		cxm::vec3f origin;
+		cxm::vec3f vForward;
+		/// Vertical field of view, in radians.
+		float fovAngle;
+		float aspectRatio;
+		float zNear;
+		float zFar;
+	};
+
+	struct ShadowCascade
+	{
+		cxm::mat4f mLightView;
+		cxm::mat4f mLightProjection;
+		cxm::mat4f mLightSpace;
+		cxm::frustumf cullingFrustum;
+		float splitNear;
+		float splitFar;
+		float texelWorldSize;
+	};
+
+	struct ShadowCascadeSet
+	{
+		ShadowCascade cascadeArray[kShadowCascadesMaxNum];
+		uint32 cascadesNum = 0;
+	};
+
+	/// @brief Per-cascade visibility of shadow casters. Each mask has the format used by cxm batch culling:
+	/// bit N of word (N / 32) is set if caster N has to be rendered into the given cascade.
+	struct ShadowCasterCullingResult
+	{
+		std::vector<uint32> visibilityMaskArray[kShadowCascadesMaxNum];
+		uint32 visibleCastersNum[kShadowCascadesMaxNum] = {};
+		uint32 castersNum = 0;
+	};
+
+	/// @brief Builds the view description from the current state of the camera.
+	IC3_NXMAIN_API_NO_DISCARD ShadowCascadeViewDesc MakeShadowCascadeViewDesc(
+			const CameraController & pCameraController,
+			float pAspectRatio,
+			float pZNear,
+			float pZFar );
+
+	/// @brief Computes view-space split depths: pSplitDepths[0] is the near plane, pSplitDepths[N] is the far
+	/// plane of cascade (N - 1). pSplitDepths must have room for ( pConfig.cascadesNum + 1 ) values.
+	IC3_NXMAIN_API void ComputeShadowCascadeSplits(
+			const ShadowCascadeConfig & pConfig,
+			float pZNear,
+			float pZFar,
+			float * pSplitDepths );
+
+	/// @brief Fits cascades of a directional light to the view frustum. Each cascade is bounded by a sphere,
+	/// so its size does not depend on the camera orientation, and its origin is snapped to the shadow map
+	/// texel grid. Together, this removes shimmering of shadow edges when the camera moves or rotates.
+	IC3_NXMAIN_API void ComputeShadowCascades(
+			const ShadowCascadeConfig & pConfig,
+			const ShadowCascadeViewDesc & pViewDesc,
+			const cxm::vec3f & pLightDirection,
+			ShadowCascadeSet & pCascadeSet );
+
+	/// @brief Culls casters (world-space AABBs) against all cascades. If a thread pool is specified, the work is split
+	/// into (cascade x range of casters) items, processed in parallel. Ranges are aligned to whole mask words, so
+	/// items never write to the same memory.
+	IC3_NXMAIN_API void CullShadowCasters(
+			const ShadowCascadeSet & pCascadeSet,
+			cxm::aabb_soa<const float> pCasters,
+			size_t pCastersNum,
+			ShadowCasterCullingResult & pResult,
+			WorkerThreadPool * pThreadPool = nullptr );
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_SHADOW_CASCADES_H__
@@ -1,6 +1,7 @@
 
 #include "ShadowRenderer.h"
 #include "../shaderLibrary.h"
+#include "../../Camera/CameraController.h"
 
 #include <Ic3/Graphics/GCI/CommandContext.h>
 #include <Ic3/Graphics/GCI/GPUDevice.h>
@@ -17,6 +18,10 @@ namespace Ic3
 	, _shaderLibrary( pShaderLibrary )
 	, _shadowConfig( pShadowConfig )
 	{
+		Ic3DebugAssert( _shadowConfig.shadowMapSize.width == _shadowConfig.shadowMapSize.height );
+		_shadowConfig.cascadeConfig.cascadesNum = cppx::get_min_of( _shadowConfig.cascadeConfig.cascadesNum, kShadowCascadesMaxNum );
+		_shadowConfig.cascadeConfig.shadowMapResolution = _shadowConfig.shadowMapSize.width;
+
 		setCSLightPosition( { -2.0f, 3.0f, -2.0f } );
 		setCSLightTarget( { 0.0f, 0.0f,  5.0f } );
 	}
@@ -40,32 +45,29 @@ namespace Ic3
 		_currentState.vLightTarget = pLightTarget;
 	}
 
-	void ShadowRenderer::setCSProjectionMatrixLightOrthoDefault()
+	void ShadowRenderer::updateCascades( const CameraController & pCameraController, float pAspectRatio, float pZNear, float pZFar )
 	{
-		_currentState.mLightProjection = cxm::orthoOffCenterLH( -32.0f, 32.0f, -32.0f, 32.0f, 1.0f, 64.0f );
+		const auto viewDesc = MakeShadowCascadeViewDesc( pCameraController, pAspectRatio, pZNear, pZFar );
+		const auto lightDirection = _currentState.vLightTarget - _currentState.vLightPosition;
+
+		ComputeShadowCascades( _shadowConfig.cascadeConfig, viewDesc, lightDirection, _currentState.cascadeSet );
 	}
 
-	void ShadowRenderer::setCSProjectionMatrixLightPerspectiveDefault()
+	void ShadowRenderer::cullShadowCasters( cxm::aabb_soa<const float> pCasters, size_t pCastersNum, WorkerThreadPool * pThreadPool )
 	{
-		_currentState.mLightProjection = cxm::perspectiveAspectLH( cxm::constants::FLT_RAD_90DEG, 1.0f, 1.0f, 24.0f );
+		CullShadowCasters( _currentState.cascadeSet, pCasters, pCastersNum, _currentState.casterCullingResult, pThreadPool );
 	}
 
-	void ShadowRenderer::updateMatricesForLightPass( GCI::CommandContext & pCommandContext )
+	void ShadowRenderer::updateMatricesForLightPass( GCI::CommandContext & pCommandContext, uint32 pCascadeIndex )
 	{
 		using namespace Ic3::Graphics::GCI;
 
 		Ic3DebugAssert( pCommandContext.CheckFeatureSupport( ECommandObjectPropertyMaskContextFamilyDirectGraphics ) );
 		auto * directGraphicsContext = pCommandContext.QueryInterface<CommandContextDirectGraphics>();
 
-		_currentState.mLightView = cxm::lookAtLH( _currentState.vLightPosition, _currentState.vLightTarget, { 0.0f, 1.0f, 0.0f } );
-		_currentState.mLightSpace = cxm::mul( _currentState.mLightProjection, _currentState.mLightView );
-
 		CBShadowData cbShadowData;
-		cbShadowData.m4fLightSpaceMatrix = _currentState.mLightSpace;
-		cbShadowData.v4fShadowProperties.x = _shadowConfig.shadowMapSize.width;
-		cbShadowData.v4fShadowProperties.y = _shadowConfig.shadowMapSize.height;
-		cbShadowData.v4fShadowProperties.z = _shadowConfig.screenSize.width;
-		cbShadowData.v4fShadowProperties.w = _shadowConfig.screenSize.height;
+		fillConstantBufferData( cbShadowData );
+		cbShadowData.m4fLightSpaceMatrix = getLightSpaceMatrix( pCascadeIndex );
 
 		directGraphicsContext->UpdateBufferDataUpload( *_resources.constantBuffer, cbShadowData );
 	}
@@ -78,16 +80,12 @@ namespace Ic3
 		auto * directGraphicsContext = pCommandContext.QueryInterface<CommandContextDirectGraphics>();
 
 		CBShadowData cbShadowData;
-		cbShadowData.m4fLightSpaceMatrix = _currentState.mLightSpace;
-		cbShadowData.v4fShadowProperties.x = _shadowConfig.shadowMapSize.width;
-		cbShadowData.v4fShadowProperties.y = _shadowConfig.shadowMapSize.height;
-		cbShadowData.v4fShadowProperties.z = _shadowConfig.screenSize.width;
-		cbShadowData.v4fShadowProperties.w = _shadowConfig.screenSize.height;
+		fillConstantBufferData( cbShadowData );
 
 		directGraphicsContext->UpdateBufferDataUpload( *_resources.constantBuffer, cbShadowData );
 	}
 
-	void ShadowRenderer::beginRenderPass1Light( GCI::CommandContext & pCommandContext )
+	void ShadowRenderer::beginRenderPass1Light( GCI::CommandContext & pCommandContext, uint32 pCascadeIndex )
 	{
 		using namespace Ic3::Graphics::GCI;
 
@@ -102,7 +100,7 @@ namespace Ic3
 		viewportDescLight.depthRange.zNear = 0.0f;
 		viewportDescLight.depthRange.zFar = 1.0f;
 
-		directGraphicsContext->SetRenderTargetBindingState( _gpuAPIState.rtBindingPass1Light );
+		directGraphicsContext->SetRenderTargetBindingState( _gpuAPIState.rtBindingPass1LightArray[pCascadeIndex] );
 		directGraphicsContext->SetGraphicsPipelineStateObject( *_gpuAPIState.psoPass1Light );
 
 		directGraphicsContext->BeginRenderPass( *_gpuAPIState.renderPass1Light );
@@ -145,6 +143,34 @@ namespace Ic3
 		directGraphicsContext->EndRenderPass();
 	}
 
+	void ShadowRenderer::fillConstantBufferData( CBShadowData & pCBShadowData ) const
+	{
+		const auto & cascadeSet = _currentState.cascadeSet;
+
+		pCBShadowData.m4fLightSpaceMatrix = ( cascadeSet.cascadesNum > 0 ) ? cascadeSet.cascadeArray[0].mLightSpace : cxm::mat4f{};
+		pCBShadowData.v4fShadowProperties.x = _shadowConfig.shadowMapSize.width;
+		pCBShadowData.v4fShadowProperties.y = _shadowConfig.shadowMapSize.height;
+		pCBShadowData.v4fShadowProperties.z = _shadowConfig.screenSize.width;
+		pCBShadowData.v4fShadowProperties.w = _shadowConfig.screenSize.height;
+
+		for( uint32 cascadeIndex = 0; cascadeIndex < kShadowCascadesMaxNum; ++cascadeIndex )
+		{
+			if( cascadeIndex < cascadeSet.cascadesNum )
+			{
+				const auto & cascade = cascadeSet.cascadeArray[cascadeIndex];
+				pCBShadowData.m4fCascadeLightSpaceMatrices[cascadeIndex] = cascade.mLightSpace;
+				pCBShadowData.v4fCascadeSplitDepths[cascadeIndex] = cascade.splitFar;
+			}
+			else
+			{
+				pCBShadowData.m4fCascadeLightSpaceMatrices[cascadeIndex] = cxm::mat4f{};
+				pCBShadowData.v4fCascadeSplitDepths[cascadeIndex] = 0.0f;
+			}
+		}
+
+		pCBShadowData.v4fCascadeProperties = { static_cast<float>( cascadeSet.cascadesNum ), 0.0f, 0.0f, 0.0f };
+	}
+
 	void ShadowRenderer::initializeResources()
 	{
 		using namespace Ic3::Graphics::GCI;
@@ -161,9 +187,10 @@ namespace Ic3
 
 		{
 			TextureCreateInfo shadowMapTextureCreateInfo;
-			shadowMapTextureCreateInfo.texClass = ETextureClass::T2D;
+			shadowMapTextureCreateInfo.texClass = ETextureClass::T2DArray;
 			shadowMapTextureCreateInfo.dimensions.width = _shadowConfig.shadowMapSize.width;
 			shadowMapTextureCreateInfo.dimensions.height = _shadowConfig.shadowMapSize.height;
+			shadowMapTextureCreateInfo.dimensions.arraySize = _shadowConfig.cascadeConfig.cascadesNum;
 			shadowMapTextureCreateInfo.memoryFlags = eGPUMemoryAccessFlagGPUReadBit;
 			shadowMapTextureCreateInfo.resourceFlags =
 					eGPUResourceUsageFlagRenderTargetDepthBit | eGPUResourceUsageFlagShaderInputBit;
@@ -171,15 +198,21 @@ namespace Ic3
 
 			_resources.shadowMapTexture = _gpuDevice.CreateTexture( shadowMapTextureCreateInfo );
 
-			Ic3::Graphics::GCI::RenderTargetTextureCreateInfo shadowMapRTTCreateInfo;
-			shadowMapRTTCreateInfo.targetTexture = _resources.shadowMapTexture;
-			shadowMapRTTCreateInfo.bindFlags =
-					eTextureBindFlagRenderTargetDepthAttachmentBit | eTextureBindFlagShaderInputSampledImageBit;
+			// Each cascade is rendered into its own layer of the array, through a separate RTT and RT binding.
+			for( uint32 cascadeIndex = 0; cascadeIndex < _shadowConfig.cascadeConfig.cascadesNum; ++cascadeIndex )
+			{
+				Ic3::Graphics::GCI::RenderTargetTextureCreateInfo shadowMapRTTCreateInfo;
+				shadowMapRTTCreateInfo.targetTexture = TextureReference{
+					_resources.shadowMapTexture,
+					TextureSubResource{ TextureSubResource2DArray{ { 0 }, cascadeIndex } } };
+				shadowMapRTTCreateInfo.bindFlags =
+						eTextureBindFlagRenderTargetDepthAttachmentBit | eTextureBindFlagShaderInputSampledImageBit;
 
-			_resources.shadowMapRTT = _gpuDevice.CreateRenderTargetTexture( shadowMapRTTCreateInfo );
+				_resources.shadowMapRTTArray[cascadeIndex] = _gpuDevice.CreateRenderTargetTexture( shadowMapRTTCreateInfo );
 
-			auto & depthStencilAttachment = _gpuAPIState.rtBindingPass1Light.SetDepthStencilAttachmentBinding();
-			depthStencilAttachment.attachmentTexture = _resources.shadowMapRTT;
+				auto & depthStencilAttachment = _gpuAPIState.rtBindingPass1LightArray[cascadeIndex].SetDepthStencilAttachmentBinding();
+				depthStencilAttachment.attachmentTexture = _resources.shadowMapRTTArray[cascadeIndex];
+			}
 		}
 
 		{
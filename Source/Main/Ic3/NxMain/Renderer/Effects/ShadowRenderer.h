@@ -5,6 +5,7 @@
 #define __IC3_NXMAIN_SHADOW_RENDERER_H__
 
 #include "../commonRendererDefs.h"
+#include "ShadowCascades.h"
 
 #include <Ic3/Graphics/GCI/State/GraphicsPipelineStateDescriptorRTO.h>
 
@@ -13,14 +14,21 @@ namespace Ic3
 
 	struct CBShadowData
 	{
+		/// Light-space matrix of the cascade currently rendered in the light pass.
 		cxm::mat4f m4fLightSpaceMatrix;
 		cxm::vec4f v4fShadowProperties;
+		cxm::mat4f m4fCascadeLightSpaceMatrices[kShadowCascadesMaxNum];
+		/// View-space far depth of each cascade.
+		cxm::vec4f v4fCascadeSplitDepths;
+		/// x: number of active cascades.
+		cxm::vec4f v4fCascadeProperties;
 	};
 
 	struct ShadowConfig
 	{
 		GCI::TextureSize2D screenSize;
 		GCI::TextureSize2D shadowMapSize;
+		ShadowCascadeConfig cascadeConfig;
 	};
 
 	class ShadowRenderer
@@ -30,14 +38,13 @@ namespace Ic3
 		{
 			cxm::vec3f vLightPosition;
 			cxm::vec3f vLightTarget;
-			cxm::mat4f mLightView;
-			cxm::mat4f mLightProjection;
-			cxm::mat4f mLightSpace;
+			ShadowCascadeSet cascadeSet;
+			ShadowCasterCullingResult casterCullingResult;
 		};
 
 		struct GPUAPIState
 		{
-			GCI::RenderTargetBindingDynamicState rtBindingPass1Light;
+			GCI::RenderTargetBindingDynamicState rtBindingPass1LightArray[kShadowCascadesMaxNum];
 			GCI::GraphicsPipelineStateObjectHandle psoPass1Light;
 			GCI::GraphicsPipelineStateObjectHandle psoPass2Shadow;
 			GCI::RenderPassConfigurationCompiledStateHandle renderPass1Light;
@@ -48,8 +55,9 @@ namespace Ic3
 		struct Resources
 		{
 			GCI::GPUBufferHandle constantBuffer;
+			/// 2D array texture with one layer per cascade.
 			GCI::TextureHandle shadowMapTexture;
-			GCI::RenderTargetTextureHandle shadowMapRTT;
+			GCI::RenderTargetTextureHandle shadowMapRTTArray[kShadowCascadesMaxNum];
 		};
 
 	public:
@@ -58,19 +66,36 @@ namespace Ic3
 
 		virtual void createRendererResources();
 
-		const cxm::mat4f & getLightProjectionMatrix() const
+		uint32 getCascadesNum() const
 		{
-			return _currentState.mLightProjection;
+			return _currentState.cascadeSet.cascadesNum;
 		}
 
-		const cxm::mat4f & getLightViewMatrix() const
+		const ShadowCascade & getCascade( uint32 pCascadeIndex ) const
 		{
-			return _currentState.mLightView;
+			Ic3DebugAssert( pCascadeIndex < _currentState.cascadeSet.cascadesNum );
+			return _currentState.cascadeSet.cascadeArray[pCascadeIndex];
 		}
 
-		const cxm::mat4f & getLightSpaceMatrix() const
+		const cxm::mat4f & getLightProjectionMatrix( uint32 pCascadeIndex ) const
 		{
-			return _currentState.mLightSpace;
+			return getCascade( pCascadeIndex ).mLightProjection;
+		}
+
+		const cxm::mat4f & getLightViewMatrix( uint32 pCascadeIndex ) const
+		{
+			return getCascade( pCascadeIndex ).mLightView;
+		}
+
+		const cxm::mat4f & getLightSpaceMatrix( uint32 pCascadeIndex ) const
+		{
+			return getCascade( pCascadeIndex ).mLightSpace;
+		}
+
+		/// @brief Returns the result of the last cullShadowCasters() call.
+		const ShadowCasterCullingResult & getCasterCullingResult() const
+		{
+			return _currentState.casterCullingResult;
 		}
 
 		const cxm::vec3f & getLightPosition() const
@@ -81,20 +106,26 @@ namespace Ic3
 		void setCSLightPosition( cxm::vec3f pLightPosition );
 		void setCSLightTarget( cxm::vec3f pLightTarget );
 
-		void setCSProjectionMatrixLightOrthoDefault();
-		void setCSProjectionMatrixLightPerspectiveDefault();
+		/// @brief Fits the cascades to the current view of the camera. Should be called once per frame, before the light pass.
+		void updateCascades( const CameraController & pCameraController, float pAspectRatio, float pZNear, float pZFar );
 
-		void updateMatricesForLightPass( GCI::CommandContext & pCommandContext );
+		/// @brief Computes which casters (world-space AABBs) have to be rendered into each cascade.
+		/// Masks are available via getCasterCullingResult() until the next call.
+		void cullShadowCasters( cxm::aabb_soa<const float> pCasters, size_t pCastersNum, WorkerThreadPool * pThreadPool = nullptr );
+
+		void updateMatricesForLightPass( GCI::CommandContext & pCommandContext, uint32 pCascadeIndex );
 
 		void updateMatricesForShadowPass( GCI::CommandContext & pCommandContext );
 
-		void beginRenderPass1Light( GCI::CommandContext & pCommandContext );
+		void beginRenderPass1Light( GCI::CommandContext & pCommandContext, uint32 pCascadeIndex );
 
 		void beginRenderPass2Shadow( GCI::CommandContext & pCommandContext );
 
 		void endRenderPass( GCI::CommandContext & pCommandContext );
 
 	private:
+		void fillConstantBufferData( CBShadowData & pCBShadowData ) const;
+
 		void initializeResources();
 
 		void initializeRenderPassStates();
@@ -0,0 +1,257 @@
+
+#include "ShaderCache.h"
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/Resources/Shader.h>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		// Header of a binary file in the cache directory, followed by the binary data.
+		struct ShaderCacheFileHeader
+		{
+			uint32 magic;
+			uint32 version;
+			uint64 cacheKey;
+			uint64 driverSpecificID;
+			uint64 driverSpecificFormatTag;
+			uint64 binarySize;
+		};
+
+		constexpr uint32 kShaderCacheFileMagic = 0x42534349; // "ICSB"
+		constexpr uint32 kShaderCacheFileVersion = 1;
+
+	}
+
+	ShaderCache::ShaderCache( ShaderCacheCreateInfo pCreateInfo )
+	: _cacheDirectory( std::move( pCreateInfo.cacheDirectory ) )
+	{}
+
+	ShaderCache::~ShaderCache() = default;
+
+	GCI::ShaderHandle ShaderCache::GetOrCreateShader(
+			GCI::GPUDevice & pGPUDevice,
+			GCI::EShaderType pShaderType,
+			const void * pSource,
+			size_t pSourceLength,
+			GfxObjectID pShaderID )
+	{
+		if( !pSource || ( pSourceLength == 0 ) )
+		{
+			return nullptr;
+		}
+
+		const auto cacheKey = ComputeCacheKey( pGPUDevice, pShaderType, pSource, pSourceLength );
+
+		std::promise<GCI::ShaderHandle> shaderCreatePromise;
+		std::shared_future<GCI::ShaderHandle> cachedShaderFuture;
+		{
+			const std::lock_guard<std::mutex> shaderMapLock{ _shaderMapLock };
+
+			const auto shaderIter = _shaderMap.find( cacheKey );
+			if( shaderIter != _shaderMap.end() )
+			{
+				cachedShaderFuture = shaderIter->second;
+			}
+			else
+			{
+				_shaderMap.emplace( cacheKey, shaderCreatePromise.get_future().share() );
+			}
+		}
+
+		if( cachedShaderFuture.valid() )
+		{
+			// Either created already or being created by another thread, in which case this waits for it.
+			_memoryHitsNum.fetch_add( 1, std::memory_order_relaxed );
+			return cachedShaderFuture.get();
+		}
+
+		GCI::ShaderCreateInfo shaderCreateInfo;
+		shaderCreateInfo.shaderType = pShaderType;
+		shaderCreateInfo.shaderSourceView = cppx::bind_memory_view( pSource, pSourceLength );
+		shaderCreateInfo.createFlags = pGPUDevice.IsDebugDevice() ? GCI::eShaderCreateFlagDebugBit : GCI::eShaderCreateFlagOptimizationL1Bit;
+		shaderCreateInfo.shaderBinary = LoadShaderBinary( cacheKey );
+
+		if( shaderCreateInfo.shaderBinary )
+		{
+			_diskHitsNum.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		GCI::ShaderHandle shader = nullptr;
+		try
+		{
+			shader = pGPUDevice.CreateShader( shaderCreateInfo );
+		}
+		catch( ... )
+		{
+			// Threads waiting for this shader must not be left blocked.
+			shaderCreatePromise.set_value( nullptr );
+			const std::lock_guard<std::mutex> shaderMapLock{ _shaderMapLock };
+			_shaderMap.erase( cacheKey );
+			throw;
+		}
+
+		if( shader && Graphics::IsGfxObjectIDValid( pShaderID ) )
+		{
+			// Set before the shader is published to other threads.
+			shader->SetObjectID( pShaderID );
+		}
+
+		shaderCreatePromise.set_value( shader );
+
+		if( !shader )
+		{
+			// Not cached, so the creation is retried with the next request.
+			const std::lock_guard<std::mutex> shaderMapLock{ _shaderMapLock };
+			_shaderMap.erase( cacheKey );
+			return nullptr;
+		}
+
+		_createdShadersNum.fetch_add( 1, std::memory_order_relaxed );
+
+		// The shader created from a cached binary has the same binary, so it is stored only once.
+		if( !shaderCreateInfo.shaderBinary && shader->HasShaderBinaryCached() )
+		{
+			if( StoreShaderBinary( cacheKey, *( shader->GetShaderBinary() ) ) )
+			{
+				_storedBinariesNum.fetch_add( 1, std::memory_order_relaxed );
+			}
+		}
+
+		return shader;
+	}
+
+	void ShaderCache::ClearMemoryCache()
+	{
+		const std::lock_guard<std::mutex> shaderMapLock{ _shaderMapLock };
+		_shaderMap.clear();
+	}
+
+	ShaderCacheStats ShaderCache::GetStats() const noexcept
+	{
+		ShaderCacheStats cacheStats{};
+		cacheStats.memoryHitsNum = _memoryHitsNum.load( std::memory_order_relaxed );
+		cacheStats.diskHitsNum = _diskHitsNum.load( std::memory_order_relaxed );
+		cacheStats.createdShadersNum = _createdShadersNum.load( std::memory_order_relaxed );
+		cacheStats.storedBinariesNum = _storedBinariesNum.load( std::memory_order_relaxed );
+		return cacheStats;
+	}
+
+	ShaderCache::CacheKey ShaderCache::ComputeCacheKey(
+			GCI::GPUDevice & pGPUDevice,
+			GCI::EShaderType pShaderType,
+			const void * pSource,
+			size_t pSourceLength )
+	{
+		const auto sourceHash = ShaderPreprocessor::ComputeSourceHash( pSource, pSourceLength );
+		return cppx::hash_compute_ex<CacheKey::hash_algo>(
+				CacheKey{ sourceHash.value },
+				static_cast<uint32>( pShaderType ),
+				static_cast<uint32>( pGPUDevice.mGPUDriverID ),
+				static_cast<uint32>( pGPUDevice.IsDebugDevice() ) );
+	}
+
+	std::string ShaderCache::GetBinaryFilePath( CacheKey pCacheKey ) const
+	{
+		char fileName[32];
+		std::snprintf( fileName, sizeof( fileName ), "%016llx.icsb", static_cast<unsigned long long>( pCacheKey.value ) );
+		return _cacheDirectory + "/" + fileName;
+	}
+
+	std::unique_ptr<GCI::ShaderBinary> ShaderCache::LoadShaderBinary( CacheKey pCacheKey ) const
+	{
+		if( _cacheDirectory.empty() )
+		{
+			return nullptr;
+		}
+
+		std::ifstream binaryFile{ GetBinaryFilePath( pCacheKey ), std::ios::in | std::ios::binary };
+		if( !binaryFile )
+		{
+			return nullptr;
+		}
+
+		ShaderCacheFileHeader fileHeader{};
+		binaryFile.read( reinterpret_cast<char *>( &fileHeader ), sizeof( fileHeader ) );
+
+		const auto headerValid =
+			binaryFile &&
+			( fileHeader.magic == kShaderCacheFileMagic ) &&
+			( fileHeader.version == kShaderCacheFileVersion ) &&
+			( fileHeader.cacheKey == pCacheKey.value ) &&
+			( fileHeader.binarySize > 0 ) &&
+			( fileHeader.binarySize <= std::numeric_limits<uint32>::max() );
+
+		if( !headerValid )
+		{
+			Ic3DebugOutputFmt( "[ShaderCache] Ignoring invalid binary file '%s'.", GetBinaryFilePath( pCacheKey ).c_str() );
+			return nullptr;
+		}
+
+		auto shaderBinary = GCI::ShaderBinary::Create( static_cast<size_t>( fileHeader.binarySize ) );
+		shaderBinary->driverSpecificID = fileHeader.driverSpecificID;
+		shaderBinary->driverSpecificFormatTag = fileHeader.driverSpecificFormatTag;
+		binaryFile.read( reinterpret_cast<char *>( shaderBinary->dataBuffer ), static_cast<std::streamsize>( fileHeader.binarySize ) );
+
+		if( !binaryFile )
+		{
+			// Truncated file (e.g. an interrupted write).
+			return nullptr;
+		}
+
+		return shaderBinary;
+	}
+
+	bool ShaderCache::StoreShaderBinary( CacheKey pCacheKey, const GCI::ShaderBinary & pShaderBinary ) const
+	{
+		if( _cacheDirectory.empty() || ( pShaderBinary.dataSizeInBytes == 0 ) )
+		{
+			return false;
+		}
+
+		const auto binaryFilePath = GetBinaryFilePath( pCacheKey );
+
+		// Written to a temporary file and renamed, so a concurrent reader never sees a partially written file.
+		const auto tmpFilePath = binaryFilePath + ".tmp" + std::to_string( std::hash<std::thread::id>{}( std::this_thread::get_id() ) );
+		{
+			std::ofstream binaryFile{ tmpFilePath, std::ios::out | std::ios::binary | std::ios::trunc };
+			if( !binaryFile )
+			{
+				Ic3DebugOutputFmt( "[ShaderCache] Cannot write binary file '%s'.", tmpFilePath.c_str() );
+				return false;
+			}
+
+			ShaderCacheFileHeader fileHeader{};
+			fileHeader.magic = kShaderCacheFileMagic;
+			fileHeader.version = kShaderCacheFileVersion;
+			fileHeader.cacheKey = pCacheKey.value;
+			fileHeader.driverSpecificID = pShaderBinary.driverSpecificID;
+			fileHeader.driverSpecificFormatTag = pShaderBinary.driverSpecificFormatTag;
+			fileHeader.binarySize = pShaderBinary.dataSizeInBytes;
+
+			binaryFile.write( reinterpret_cast<const char *>( &fileHeader ), sizeof( fileHeader ) );
+			binaryFile.write( reinterpret_cast<const char *>( pShaderBinary.dataBuffer ), pShaderBinary.dataSizeInBytes );
+
+			if( !binaryFile )
+			{
+				binaryFile.close();
+				std::remove( tmpFilePath.c_str() );
+				return false;
+			}
+		}
+
+		if( std::rename( tmpFilePath.c_str(), binaryFilePath.c_str() ) != 0 )
+		{
+			std::remove( tmpFilePath.c_str() );
+			return false;
+		}
+
+		return true;
+	}
+
+} // namespace Ic3
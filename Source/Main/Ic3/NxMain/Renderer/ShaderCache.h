@@ -0,0 +1,88 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_SHADER_CACHE_H__
+#define __IC3_NXMAIN_SHADER_CACHE_H__
+
+#include "ShaderPreprocessor.h"
+#include <Ic3/Graphics/GCI/Resources/ShaderCommon.h>
+#include <atomic>
+#include <future>
+
+namespace Ic3
+{
+
+	Ic3DeclareClassHandle( ShaderCache );
+
+	struct ShaderCacheCreateInfo
+	{
+		/// Directory for compiled shader binaries. If empty, only the memory cache is used.
+		std::string cacheDirectory;
+	};
+
+	struct ShaderCacheStats
+	{
+		uint32 memoryHitsNum = 0;
+		uint32 diskHitsNum = 0;
+		uint32 createdShadersNum = 0;
+		uint32 storedBinariesNum = 0;
+	};
+
+	/**
+	 * @brief Cache of shaders created from (preprocessed) sources, keyed by the content hash of the source.
+	 *
+	 * Identical sources (e.g. permutations which expand to the same code) result in a single shader object, created
+	 * once, even if requested concurrently. Binaries of created shaders (if the driver provides them) are stored in the
+	 * cache directory and passed to the driver (ShaderCreateInfo::shaderBinary) when the same source is requested in
+	 * a later run, so drivers which support it can skip the compilation. The key includes the shader type, the driver
+	 * and the debug mode of the device, so binaries are never used with a different configuration.
+	 */
+	class IC3_NXMAIN_CLASS ShaderCache : public IDynamicObject
+	{
+	public:
+		explicit ShaderCache( ShaderCacheCreateInfo pCreateInfo );
+		~ShaderCache();
+
+		/// @brief Returns the cached shader for the source or creates it. Returns null if the shader cannot be created.
+		/// pShaderID is set as the object ID of a newly created shader (a cached one keeps its ID).
+		GCI::ShaderHandle GetOrCreateShader(
+				GCI::GPUDevice & pGPUDevice,
+				GCI::EShaderType pShaderType,
+				const void * pSource,
+				size_t pSourceLength,
+				GfxObjectID pShaderID = Graphics::kGfxObjectIDEmpty );
+
+		/// @brief Releases all shaders kept by the memory cache. Binaries stored on disk are not affected.
+		void ClearMemoryCache();
+
+		CPPX_ATTR_NO_DISCARD ShaderCacheStats GetStats() const noexcept;
+
+	private:
+		using CacheKey = cppx::hash_object<cppx::hash_algo::wyhash64>;
+
+		CPPX_ATTR_NO_DISCARD static CacheKey ComputeCacheKey(
+				GCI::GPUDevice & pGPUDevice,
+				GCI::EShaderType pShaderType,
+				const void * pSource,
+				size_t pSourceLength );
+
+		CPPX_ATTR_NO_DISCARD std::string GetBinaryFilePath( CacheKey pCacheKey ) const;
+
+		std::unique_ptr<GCI::ShaderBinary> LoadShaderBinary( CacheKey pCacheKey ) const;
+
+		bool StoreShaderBinary( CacheKey pCacheKey, const GCI::ShaderBinary & pShaderBinary ) const;
+
+	private:
+		std::string _cacheDirectory;
+		std::mutex _shaderMapLock;
+		// Shaders (or their creation in progress) by the cache key. Failed creations are removed.
+		std::unordered_map<uint64, std::shared_future<GCI::ShaderHandle>> _shaderMap;
+		std::atomic<uint32> _memoryHitsNum{ 0 };
+		std::atomic<uint32> _diskHitsNum{ 0 };
+		std::atomic<uint32> _createdShadersNum{ 0 };
+		std::atomic<uint32> _storedBinariesNum{ 0 };
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_SHADER_CACHE_H__
@@ -0,0 +1,324 @@
+
+#include "ShaderHotReloader.h"
+#include "ShaderLibrary.h"
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/Resources/Shader.h>
+#include <Ic3/System/SysContext.h>
+
+namespace Ic3
+{
+
+	ShaderHotReloader::ShaderHotReloader( const CoreEngineState & pCES, const ShaderHotReloaderCreateInfo & pCreateInfo )
+	: CoreEngineObject( pCES )
+	, mShaderLibrary( pCreateInfo.shaderLibrary )
+	, mShaderLoader( pCreateInfo.shaderLoader )
+	, _fileWatcher( pCreateInfo.fileWatcher )
+	, _shaderSourceDirectory( pCreateInfo.shaderSourceDirectory )
+	, _backgroundCompilation( pCreateInfo.backgroundCompilation && mCES.mGPUDevice->IsMultiThreadAccessSupported() )
+	, _changeSettleTime( pCreateInfo.changeSettleTime )
+	{
+		if( !_fileWatcher && mCES.mSysContext )
+		{
+			try
+			{
+				_fileWatcher = mCES.mSysContext->CreateFileWatcher();
+			}
+			catch( const Exception & pException )
+			{
+				Ic3DebugOutputFmt( "[ShaderHotReloader] File watcher is not available, hot reload is disabled: %s", pException.what() );
+			}
+		}
+	}
+
+	ShaderHotReloader::~ShaderHotReloader()
+	{
+		StopWatching();
+	}
+
+	bool ShaderHotReloader::WatchShader( const ShaderLoadDescFile & pShaderLoadDesc )
+	{
+		if( !_fileWatcher || pShaderLoadDesc.shaderSourceFileName.empty() )
+		{
+			return false;
+		}
+
+		auto shaderFilePath = pShaderLoadDesc.shaderSourceFileName;
+		if( !_shaderSourceDirectory.empty() )
+		{
+			shaderFilePath = _shaderSourceDirectory + "/" + shaderFilePath;
+		}
+
+		const auto watchID = _fileWatcher->AddFileWatch( shaderFilePath );
+		if( watchID == System::kFileWatchIDInvalid )
+		{
+			Ic3DebugOutputFmt( "[ShaderHotReloader] Cannot watch shader source file '%s'.", shaderFilePath.c_str() );
+			return false;
+		}
+
+		const std::lock_guard<std::mutex> watchedShaderLock{ _watchedShaderLock };
+
+		const auto watchedShaderIndex = static_cast<uint32>( _watchedShaders.size() );
+		_watchedShaders.push_back( WatchedShader{ pShaderLoadDesc, watchID } );
+		_watchedShaderIndexMap[watchID].push_back( watchedShaderIndex );
+
+		return true;
+	}
+
+	uint32 ShaderHotReloader::WatchShaders( std::initializer_list<ShaderLoadDescFile> pShaderLoadDescList )
+	{
+		uint32 watchedShadersNum = 0;
+		for( const auto & shaderLoadDesc : pShaderLoadDescList )
+		{
+			if( WatchShader( shaderLoadDesc ) )
+			{
+				++watchedShadersNum;
+			}
+		}
+
+		return watchedShadersNum;
+	}
+
+	shader_dependency_id_t ShaderHotReloader::AddShaderDependency(
+			std::vector<GfxObjectName> pShaderNames,
+			ShaderDependencyRebuildCallback pRebuildCallback )
+	{
+		if( pShaderNames.empty() || !pRebuildCallback )
+		{
+			return kShaderDependencyIDInvalid;
+		}
+
+		const auto dependencyID = _nextDependencyID++;
+		_shaderDependencyMap[dependencyID] = ShaderDependency{ std::move( pShaderNames ), std::move( pRebuildCallback ) };
+
+		return dependencyID;
+	}
+
+	void ShaderHotReloader::RemoveShaderDependency( shader_dependency_id_t pDependencyID )
+	{
+		_shaderDependencyMap.erase( pDependencyID );
+	}
+
+	bool ShaderHotReloader::StartWatching()
+	{
+		if( !_fileWatcher )
+		{
+			return false;
+		}
+
+		if( !_watchThread.joinable() )
+		{
+			_watchThreadStopRequest.store( false, std::memory_order_relaxed );
+			_watchThread = std::thread( [this]() { WatchThreadProc(); } );
+		}
+
+		return true;
+	}
+
+	void ShaderHotReloader::StopWatching()
+	{
+		if( _watchThread.joinable() )
+		{
+			_watchThreadStopRequest.store( true, std::memory_order_relaxed );
+			_fileWatcher->InterruptWait();
+			_watchThread.join();
+		}
+	}
+
+	uint32 ShaderHotReloader::ApplyPendingUpdates()
+	{
+		std::vector<PendingShaderUpdate> pendingUpdates;
+		{
+			const std::lock_guard<std::mutex> pendingUpdateLock{ _pendingUpdateLock };
+			pendingUpdates.swap( _pendingUpdates );
+		}
+
+		if( pendingUpdates.empty() )
+		{
+			return 0;
+		}
+
+		std::vector<ShaderLibraryEntry> replacedShaderEntries;
+		std::vector<GfxObjectName> replacedShaderNames;
+		replacedShaderEntries.reserve( pendingUpdates.size() );
+
+		for( auto & pendingUpdate : pendingUpdates )
+		{
+			ShaderLoadDescFile shaderLoadDesc;
+			{
+				const std::lock_guard<std::mutex> watchedShaderLock{ _watchedShaderLock };
+				shaderLoadDesc = _watchedShaders[pendingUpdate.watchedShaderIndex].loadDesc;
+			}
+
+			if( !_backgroundCompilation )
+			{
+				pendingUpdate.shaderObject = mShaderLoader->LoadShader( shaderLoadDesc );
+			}
+
+			if( !pendingUpdate.shaderObject )
+			{
+				Ic3DebugOutputFmt(
+						"[ShaderHotReloader] Failed to compile '%s' (%s), the previous version is kept.",
+						shaderLoadDesc.shaderName.str().c_str(),
+						shaderLoadDesc.shaderSourceFileName.c_str() );
+				++_stats.failedShadersNum;
+				continue;
+			}
+
+			ShaderLibraryEntry shaderEntry{};
+			shaderEntry.shaderObject = pendingUpdate.shaderObject;
+			shaderEntry.shaderID = ShaderLoader::ResolveShaderID( shaderLoadDesc );
+			shaderEntry.shaderName = GfxObjectName{ shaderLoadDesc.shaderName };
+			replacedShaderEntries.push_back( std::move( shaderEntry ) );
+			replacedShaderNames.push_back( GfxObjectName{ shaderLoadDesc.shaderName } );
+		}
+
+		const auto replacedShadersNum = mShaderLibrary->ReplaceShaders( replacedShaderEntries );
+		_stats.reloadedShadersNum += replacedShadersNum;
+
+		if( replacedShadersNum > 0 )
+		{
+			RebuildDependencies( replacedShaderNames );
+		}
+
+		return replacedShadersNum;
+	}
+
+	void ShaderHotReloader::WatchThreadProc()
+	{
+		System::FileWatchEventList fileWatchEvents;
+
+		while( !_watchThreadStopRequest.load( std::memory_order_relaxed ) )
+		{
+			fileWatchEvents.clear();
+
+			if( _fileWatcher->WaitForEvents( fileWatchEvents, cppx::timeout_infinite_ms ) == 0 )
+			{
+				continue;
+			}
+
+			// Collect further changes until the files settle. Duplicates are removed by QueueModifiedShaders().
+			while( !_watchThreadStopRequest.load( std::memory_order_relaxed ) )
+			{
+				if( _fileWatcher->WaitForEvents( fileWatchEvents, _changeSettleTime ) == 0 )
+				{
+					break;
+				}
+			}
+
+			if( !_watchThreadStopRequest.load( std::memory_order_relaxed ) )
+			{
+				QueueModifiedShaders( fileWatchEvents );
+			}
+		}
+	}
+
+	void ShaderHotReloader::QueueModifiedShaders( const System::FileWatchEventList & pFileWatchEvents )
+	{
+		// Final state of each file. A file removed and then re-created (or the other way round) counts as its last event.
+		std::unordered_map<System::file_watch_id_t, System::EFileWatchEventType> fileStateMap;
+		for( const auto & fileWatchEvent : pFileWatchEvents )
+		{
+			fileStateMap[fileWatchEvent.watchID] = fileWatchEvent.eventType;
+		}
+
+		std::vector<std::pair<uint32, ShaderLoadDescFile>> modifiedShaders;
+		{
+			const std::lock_guard<std::mutex> watchedShaderLock{ _watchedShaderLock };
+			for( const auto & [watchID, fileState] : fileStateMap )
+			{
+				const auto watchedShaderIndexIter = _watchedShaderIndexMap.find( watchID );
+				if( ( fileState != System::EFileWatchEventType::Modified ) || ( watchedShaderIndexIter == _watchedShaderIndexMap.end() ) )
+				{
+					// A removed file keeps the current version of its shaders.
+					continue;
+				}
+				for( const auto watchedShaderIndex : watchedShaderIndexIter->second )
+				{
+					modifiedShaders.emplace_back( watchedShaderIndex, _watchedShaders[watchedShaderIndex].loadDesc );
+				}
+			}
+		}
+
+		std::vector<PendingShaderUpdate> shaderUpdates;
+		shaderUpdates.reserve( modifiedShaders.size() );
+
+		for( const auto & [watchedShaderIndex, shaderLoadDesc] : modifiedShaders )
+		{
+			PendingShaderUpdate shaderUpdate{ watchedShaderIndex, nullptr };
+			if( _backgroundCompilation )
+			{
+				shaderUpdate.shaderObject = mShaderLoader->LoadShader( shaderLoadDesc );
+			}
+			shaderUpdates.push_back( std::move( shaderUpdate ) );
+		}
+
+		// All shaders from a single batch of changes are queued together, so ApplyPendingUpdates() never
+		// picks up only a part of them (e.g. a new VS without the matching PS saved at the same time).
+		const std::lock_guard<std::mutex> pendingUpdateLock{ _pendingUpdateLock };
+
+		for( auto & shaderUpdate : shaderUpdates )
+		{
+			// An update not yet applied is superseded by the newer one.
+			const auto existingUpdateIter = std::find_if(
+					_pendingUpdates.begin(),
+					_pendingUpdates.end(),
+					[&shaderUpdate]( const auto & pUpdate ) { return pUpdate.watchedShaderIndex == shaderUpdate.watchedShaderIndex; } );
+
+			if( existingUpdateIter != _pendingUpdates.end() )
+			{
+				*existingUpdateIter = std::move( shaderUpdate );
+			}
+			else
+			{
+				_pendingUpdates.push_back( std::move( shaderUpdate ) );
+			}
+		}
+	}
+
+	uint32 ShaderHotReloader::RebuildDependencies( const std::vector<GfxObjectName> & pReplacedShaderNames )
+	{
+		// Callbacks may add or remove dependencies, so the IDs are collected first.
+		std::vector<shader_dependency_id_t> affectedDependencyIDs;
+		for( const auto & [dependencyID, shaderDependency] : _shaderDependencyMap )
+		{
+			const auto dependencyAffected = std::any_of(
+					shaderDependency.shaderNames.begin(),
+					shaderDependency.shaderNames.end(),
+					[&pReplacedShaderNames]( const auto & pShaderName ) {
+						return std::find( pReplacedShaderNames.begin(), pReplacedShaderNames.end(), pShaderName ) != pReplacedShaderNames.end();
+					} );
+
+			if( dependencyAffected )
+			{
+				affectedDependencyIDs.push_back( dependencyID );
+			}
+		}
+
+		uint32 rebuiltDependenciesNum = 0;
+		for( const auto dependencyID : affectedDependencyIDs )
+		{
+			const auto shaderDependencyIter = _shaderDependencyMap.find( dependencyID );
+			if( shaderDependencyIter == _shaderDependencyMap.end() )
+			{
+				continue;
+			}
+
+			// Copy, in case the callback removes its own dependency.
+			const auto rebuildCallback = shaderDependencyIter->second.rebuildCallback;
+			if( rebuildCallback() )
+			{
+				++rebuiltDependenciesNum;
+			}
+			else
+			{
+				Ic3DebugOutputFmt( "[ShaderHotReloader] Failed to rebuild dependency %u after shader reload.", dependencyID );
+				++_stats.failedDependenciesNum;
+			}
+		}
+
+		_stats.rebuiltDependenciesNum += rebuiltDependenciesNum;
+
+		return rebuiltDependenciesNum;
+	}
+
+} // namespace Ic3
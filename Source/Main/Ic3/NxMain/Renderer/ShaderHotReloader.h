@@ -0,0 +1,162 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_SHADER_HOT_RELOADER_H__
+#define __IC3_NXMAIN_SHADER_HOT_RELOADER_H__
+
+#include "ShaderLoader.h"
+#include <Ic3/System/IO/FileWatcher.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace Ic3
+{
+
+	Ic3DeclareClassHandle( ShaderHotReloader );
+
+	using shader_dependency_id_t = uint32;
+
+	inline constexpr shader_dependency_id_t kShaderDependencyIDInvalid = 0;
+
+	/// Re-creates objects built from shaders (usually pipeline state objects) after some of the shaders have been
+	/// replaced in the ShaderLibrary. Should return false if the objects could not be created.
+	using ShaderDependencyRebuildCallback = std::function<bool()>;
+
+	struct ShaderHotReloaderCreateInfo
+	{
+		/// Library in which the reloaded shaders are replaced.
+		ShaderLibraryHandle shaderLibrary;
+
+		/// Loader used to compile modified shaders. It has to read the files from shaderSourceDirectory - usually it
+		/// is the loader which has loaded the shaders in the first place.
+		ShaderLoaderHandle shaderLoader;
+
+		/// Directory with shader source files. Paths of watched files are created by appending shaderSourceFileName
+		/// of the load descs to this directory.
+		std::string shaderSourceDirectory;
+
+		/// File watcher to use. If empty, a new one is created with the SysContext of the engine.
+		System::FileWatcherHandle fileWatcher;
+
+		/// If true, modified shaders are compiled on the watch thread, provided that the device supports concurrent
+		/// resource creation (GPUDevice::IsMultiThreadAccessSupported()). Otherwise (e.g. on OpenGL) the watch thread
+		/// only detects the changes and shaders are compiled in ApplyPendingUpdates().
+		bool backgroundCompilation = true;
+
+		/// Time to wait for further changes after a change has been detected. Editors often save a file in a few
+		/// steps and a shader should not be compiled from a half-written source.
+		cppx::milliseconds changeSettleTime{ 50 };
+	};
+
+	struct ShaderHotReloaderStats
+	{
+		uint32 reloadedShadersNum = 0;
+		uint32 failedShadersNum = 0;
+		uint32 rebuiltDependenciesNum = 0;
+		uint32 failedDependenciesNum = 0;
+	};
+
+	/// @brief Recompiles shaders when their source files change and replaces them in a ShaderLibrary.
+	///
+	/// Source files are watched by a background thread (see StartWatching()). Modified shaders are compiled (on that
+	/// thread, unless backgroundCompilation is disabled) and queued. The owner calls ApplyPendingUpdates() once per
+	/// frame, which replaces all queued shaders in the library as a single operation and invokes the rebuild callbacks
+	/// of objects depending on them (see AddShaderDependency()), so pipeline state objects are re-created from the new
+	/// shaders. Shaders which fail to compile are reported and the previous version is kept.
+	class IC3_NXMAIN_CLASS ShaderHotReloader : public CoreEngineObject
+	{
+	public:
+		ShaderLibraryHandle const mShaderLibrary;
+
+		ShaderLoaderHandle const mShaderLoader;
+
+	public:
+		ShaderHotReloader( const CoreEngineState & pCES, const ShaderHotReloaderCreateInfo & pCreateInfo );
+		~ShaderHotReloader();
+
+		/// @brief Starts watching the source file of a shader. Multiple shaders can be built from the same file.
+		bool WatchShader( const ShaderLoadDescFile & pShaderLoadDesc );
+
+		uint32 WatchShaders( std::initializer_list<ShaderLoadDescFile> pShaderLoadDescList );
+
+		/// @brief Registers a callback invoked by ApplyPendingUpdates() when any of the specified shaders is replaced.
+		/// The callback is invoked once per update, even if more of its shaders have changed.
+		shader_dependency_id_t AddShaderDependency(
+				std::vector<GfxObjectName> pShaderNames,
+				ShaderDependencyRebuildCallback pRebuildCallback );
+
+		void RemoveShaderDependency( shader_dependency_id_t pDependencyID );
+
+		/// @brief Starts the watch thread. Returns false if file watching is not available on the current platform.
+		bool StartWatching();
+
+		void StopWatching();
+
+		/// @brief Replaces all recompiled shaders in the library and rebuilds their dependencies. Has to be called from
+		/// the thread which owns the dependencies (usually the render thread). Returns the number of replaced shaders.
+		uint32 ApplyPendingUpdates();
+
+		CPPX_ATTR_NO_DISCARD bool IsWatching() const noexcept
+		{
+			return _watchThread.joinable();
+		}
+
+		CPPX_ATTR_NO_DISCARD const ShaderHotReloaderStats & GetStats() const noexcept
+		{
+			return _stats;
+		}
+
+	private:
+		struct WatchedShader
+		{
+			ShaderLoadDescFile loadDesc;
+			System::file_watch_id_t watchID;
+		};
+
+		struct PendingShaderUpdate
+		{
+			uint32 watchedShaderIndex;
+			// Compiled shader. Empty if the compilation has failed or is deferred to ApplyPendingUpdates().
+			GCI::ShaderHandle shaderObject;
+		};
+
+		struct ShaderDependency
+		{
+			std::vector<GfxObjectName> shaderNames;
+			ShaderDependencyRebuildCallback rebuildCallback;
+		};
+
+		void WatchThreadProc();
+
+		void QueueModifiedShaders( const System::FileWatchEventList & pFileWatchEvents );
+
+		uint32 RebuildDependencies( const std::vector<GfxObjectName> & pReplacedShaderNames );
+
+	private:
+		System::FileWatcherHandle _fileWatcher;
+		std::string _shaderSourceDirectory;
+		bool _backgroundCompilation;
+		cppx::milliseconds _changeSettleTime;
+
+		std::mutex _watchedShaderLock;
+		std::vector<WatchedShader> _watchedShaders;
+		std::unordered_map<System::file_watch_id_t, std::vector<uint32>> _watchedShaderIndexMap;
+
+		std::mutex _pendingUpdateLock;
+		std::vector<PendingShaderUpdate> _pendingUpdates;
+
+		std::map<shader_dependency_id_t, ShaderDependency> _shaderDependencyMap;
+		shader_dependency_id_t _nextDependencyID = kShaderDependencyIDInvalid + 1;
+
+		std::thread _watchThread;
+		std::atomic<bool> _watchThreadStopRequest{ false };
+
+		ShaderHotReloaderStats _stats;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_SHADER_HOT_RELOADER_H__
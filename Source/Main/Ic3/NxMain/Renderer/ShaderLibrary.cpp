@@ -14,29 +14,39 @@ namespace Ic3
 
 	GCI::ShaderHandle ShaderLibrary::GetShader( GfxObjectID pShaderID ) const noexcept
 	{
+		const std::shared_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
 		const auto shaderIter = _shaderMapByID.find( pShaderID );
 		return ( shaderIter != _shaderMapByID.end() ) ? shaderIter->second : nullptr;
 	}
 
 	GCI::ShaderHandle ShaderLibrary::GetShader( const GfxObjectName & pShaderName ) const noexcept
 	{
+		const std::shared_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
 		const auto shaderIter = _shaderMapByName.find( pShaderName );
 		return ( shaderIter != _shaderMapByName.end() ) ? shaderIter->second : nullptr;
 	}
 
 	uint32 ShaderLibrary::Append( const ShaderLibrary & pOtherLibrary, bool pOverwriteExisting )
 	{
+		if( &pOtherLibrary == this )
+		{
+			return 0;
+		}
+
+		const std::shared_lock<std::shared_mutex> otherShaderMapLock{ pOtherLibrary._shaderMapLock };
+		const std::unique_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
+
 		uint32 addedShadersNum = 0;
 		for( const auto &[shaderID, shaderHandle] : pOtherLibrary._shaderMapByID )
 		{
-			if( RegisterShader( shaderHandle, shaderID, pOverwriteExisting ) )
+			if( _RegisterShaderByID( shaderHandle, shaderID, pOverwriteExisting ) )
 			{
 				++addedShadersNum;
 			}
 		}
 		for( const auto & [shaderName, shaderHandle] : pOtherLibrary._shaderMapByName )
 		{
-			if( RegisterShader( shaderHandle, shaderName, pOverwriteExisting ) )
+			if( _RegisterShaderByName( shaderHandle, shaderName, pOverwriteExisting ) )
 			{
 				++addedShadersNum;
 			}
@@ -49,6 +59,73 @@ namespace Ic3
 			GCI::ShaderHandle pShaderObject,
 			GfxObjectID pShaderID,
 			bool pOverwriteExisting )
+	{
+		const std::unique_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
+		return _RegisterShaderByID( std::move( pShaderObject ), pShaderID, pOverwriteExisting );
+	}
+
+	bool ShaderLibrary::RegisterShader(
+			GCI::ShaderHandle pShaderObject,
+			const GfxObjectName & pShaderName,
+			bool pOverwriteExisting )
+	{
+		const std::unique_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
+		return _RegisterShaderByName( std::move( pShaderObject ), pShaderName, pOverwriteExisting );
+	}
+
+	bool ShaderLibrary::RegisterShader(
+			GCI::ShaderHandle pShaderObject,
+			GfxObjectID pShaderID,
+			const GfxObjectName & pShaderName,
+			bool pOverwriteExisting )
+	{
+		const std::unique_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
+
+		const auto regByIDResult = _RegisterShaderByID( pShaderObject, pShaderID, pOverwriteExisting );
+		const auto regByNameResult = _RegisterShaderByName( pShaderObject, pShaderName, pOverwriteExisting );
+
+		return regByIDResult && regByNameResult;
+	}
+
+	uint32 ShaderLibrary::ReplaceShaders( const std::vector<ShaderLibraryEntry> & pShaderEntries )
+	{
+		const std::unique_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
+
+		uint32 replacedShadersNum = 0;
+		for( const auto & shaderEntry : pShaderEntries )
+		{
+			if( !shaderEntry.shaderObject )
+			{
+				continue;
+			}
+
+			bool shaderRegistered = false;
+			if( Graphics::IsGfxObjectIDValid( shaderEntry.shaderID ) )
+			{
+				shaderRegistered = _RegisterShaderByID( shaderEntry.shaderObject, shaderEntry.shaderID, true );
+			}
+			if( !shaderEntry.shaderName.empty() )
+			{
+				shaderRegistered = _RegisterShaderByName( shaderEntry.shaderObject, shaderEntry.shaderName, true ) || shaderRegistered;
+			}
+			if( shaderRegistered )
+			{
+				++replacedShadersNum;
+			}
+		}
+
+		if( replacedShadersNum > 0 )
+		{
+			_replaceCounter.fetch_add( 1, std::memory_order_acq_rel );
+		}
+
+		return replacedShadersNum;
+	}
+
+	bool ShaderLibrary::_RegisterShaderByID(
+			GCI::ShaderHandle pShaderObject,
+			GfxObjectID pShaderID,
+			bool pOverwriteExisting )
 	{
 		if( !Graphics::IsGfxObjectIDValid( pShaderID ) || !pShaderObject )
 		{
@@ -74,7 +151,7 @@ namespace Ic3
 		return true;
 	}
 
-	bool ShaderLibrary::RegisterShader(
+	bool ShaderLibrary::_RegisterShaderByName(
 			GCI::ShaderHandle pShaderObject,
 			const GfxObjectName & pShaderName,
 			bool pOverwriteExisting )
@@ -103,16 +180,4 @@ namespace Ic3
 		return true;
 	}
 
-	bool ShaderLibrary::RegisterShader(
-			GCI::ShaderHandle pShaderObject,
-			GfxObjectID pShaderID,
-			const GfxObjectName & pShaderName,
-			bool pOverwriteExisting )
-	{
-		const auto regByIDResult = RegisterShader( pShaderObject, pShaderID, pOverwriteExisting );
-		const auto regByNameResult = RegisterShader( pShaderObject, pShaderName, pOverwriteExisting );
-
-		return regByIDResult && regByNameResult;
-	}
-
 }
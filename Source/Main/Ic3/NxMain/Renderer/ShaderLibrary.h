@@ -6,11 +6,25 @@
 
 #include "CommonRendererDefs.h"
 #include <Ic3/Graphics/GCI/Resources/ShaderCommon.h>
-#include <unordered_map>
+#include <cppx/flatHashMap.h>
+#include <atomic>
+#include <shared_mutex>
 
 namespace Ic3
 {
 
+	/// @brief Shader registered (or to be registered) in a ShaderLibrary under its ID, its name or both.
+	struct ShaderLibraryEntry
+	{
+		GCI::ShaderHandle shaderObject;
+		GfxObjectID shaderID = Graphics::kGfxObjectIDEmpty;
+		GfxObjectName shaderName;
+	};
+
+	/// @brief Collection of shaders accessible by their IDs and names.
+	///
+	/// The library is thread-safe: lookups may be performed while shaders are being replaced from another thread
+	/// (e.g. by ShaderHotReloader). A handle returned by GetShader() stays valid after its shader has been replaced.
 	class IC3_NXMAIN_CLASS ShaderLibrary : public CoreEngineObject
 	{
 	public:
@@ -31,16 +45,38 @@ namespace Ic3
 
 		bool RegisterShader( GCI::ShaderHandle pShaderObject, GfxObjectID pShaderID, const GfxObjectName & pShaderName, bool pOverwriteExisting = false );
 
+		/// @brief Registers all specified shaders, overwriting existing ones, as a single operation: concurrent lookups
+		/// observe either none or all of the new shaders (so e.g. a VS/PS pair is never mixed). Entries with invalid
+		/// shader handles are skipped. Returns the number of registered shaders.
+		uint32 ReplaceShaders( const std::vector<ShaderLibraryEntry> & pShaderEntries );
+
+		/// @brief Returns the number of ReplaceShaders() calls which have replaced any shaders. Can be used to
+		/// cheaply check if shaders fetched from the library earlier may be outdated.
+		CPPX_ATTR_NO_DISCARD uint64 GetReplaceCounter() const noexcept;
+
 	private:
-		std::unordered_map<GfxObjectID, GCI::ShaderHandle> _shaderMapByID;
-		std::unordered_map<GfxObjectName, GCI::ShaderHandle> _shaderMapByName;
+		bool _RegisterShaderByID( GCI::ShaderHandle pShaderObject, GfxObjectID pShaderID, bool pOverwriteExisting );
+
+		bool _RegisterShaderByName( GCI::ShaderHandle pShaderObject, const GfxObjectName & pShaderName, bool pOverwriteExisting );
+
+	private:
+		mutable std::shared_mutex _shaderMapLock;
+		std::atomic<uint64> _replaceCounter{ 0 };
+		cppx::flat_hash_map<GfxObjectID, GCI::ShaderHandle> _shaderMapByID;
+		cppx::flat_hash_map<GfxObjectName, GCI::ShaderHandle> _shaderMapByName;
 	};
 
 	inline bool ShaderLibrary::IsEmpty() const noexcept
 	{
+		const std::shared_lock<std::shared_mutex> shaderMapLock{ _shaderMapLock };
 		return _shaderMapByID.empty() && _shaderMapByName.empty();
 	}
 
+	inline uint64 ShaderLibrary::GetReplaceCounter() const noexcept
+	{
+		return _replaceCounter.load( std::memory_order_acquire );
+	}
+
 } // namespace Ic3
 
 #endif // __IC3_NXMAIN_SHADER_LIBRARY_H__
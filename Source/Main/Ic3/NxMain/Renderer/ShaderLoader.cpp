@@ -1,47 +1,284 @@
 
 #include "ShaderLoader.h"
 #include "ShaderLibrary.h"
+#include <Ic3/Graphics/GCI/GPUDevice.h>
 #include <Ic3/Graphics/GCI/GPUUtils.h>
 #include <Ic3/System/IO/AssetSystem.h>
 
 #include <Ic3/Graphics/GCI/Resources/Shader.h>
 #include <Ic3/NxMain/GCI/ShaderUtils.h>
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
 
 namespace Ic3
 {
 
+	ShaderLoadBatch::ShaderLoadBatch(
+			ShaderLoaderHandle pShaderLoader,
+			std::shared_ptr<void> pShaderLoadDescStorage,
+			std::vector<const ShaderLoadDescBase *> pShaderLoadDescList,
+			WorkerThreadPool * pThreadPool,
+			bool pConcurrentCompilation )
+	: _shaderLoader( std::move( pShaderLoader ) )
+	, _shaderLoadDescStorage( std::move( pShaderLoadDescStorage ) )
+	, _shaderLoadDescList( std::move( pShaderLoadDescList ) )
+	, _shaderSources( _shaderLoadDescList.size() )
+	, _shaders( _shaderLoadDescList.size() )
+	, _threadPool( pThreadPool )
+	, _concurrentCompilation( pConcurrentCompilation )
+	, _startTimeStamp( System::PerfCounter::QueryCounter() )
+	{}
+
+	ShaderLoadBatch::~ShaderLoadBatch()
+	{
+		// Shaders of a batch dropped without Wait() are not compiled, but the background task has to finish.
+		if( _asyncTaskFuture.valid() )
+		{
+			_asyncTaskFuture.wait();
+		}
+	}
+
+	bool ShaderLoadBatch::IsFinished() const noexcept
+	{
+		return _finished.load( std::memory_order_acquire );
+	}
+
+	void ShaderLoadBatch::Wait()
+	{
+		if( IsFinished() )
+		{
+			return;
+		}
+
+		const std::lock_guard<std::mutex> waitLock{ _waitLock };
+
+		if( _asyncTaskFuture.valid() )
+		{
+			_asyncTaskFuture.wait();
+		}
+
+		if( !IsFinished() )
+		{
+			// Serialized compilation: the device can only be used by the thread which owns it.
+			CreateShaders( nullptr );
+			_finished.store( true, std::memory_order_release );
+		}
+	}
+
+	const std::vector<GCI::ShaderHandle> & ShaderLoadBatch::GetShaders()
+	{
+		Wait();
+		return _shaders;
+	}
+
+	uint32 ShaderLoadBatch::AddShadersToLibrary( ShaderLibrary & pShaderLibrary )
+	{
+		Wait();
+
+		uint32 addedShadersNum = 0;
+		for( size_t shaderIndex = 0; shaderIndex < _shaders.size(); ++shaderIndex )
+		{
+			if( _shaders[shaderIndex] )
+			{
+				ShaderLoader::AddShaderToLibrary( pShaderLibrary, _shaders[shaderIndex], *( _shaderLoadDescList[shaderIndex] ) );
+				++addedShadersNum;
+			}
+		}
+
+		return addedShadersNum;
+	}
+
+	const ShaderLoadBatchStats & ShaderLoadBatch::GetStats()
+	{
+		Wait();
+		return _stats;
+	}
+
+	void ShaderLoadBatch::ExecuteAsync()
+	{
+		ReadShaderSources();
+
+		if( _concurrentCompilation )
+		{
+			CreateShaders( _threadPool );
+			_finished.store( true, std::memory_order_release );
+		}
+	}
+
+	void ShaderLoadBatch::ReadShaderSources()
+	{
+		const auto readSourceRange = [this]( size_t pBeginIndex, size_t pEndIndex ) {
+			for( auto shaderIndex = pBeginIndex; shaderIndex < pEndIndex; ++shaderIndex )
+			{
+				try
+				{
+					_shaderSources[shaderIndex] = _shaderLoader->ReadShaderSource( *( _shaderLoadDescList[shaderIndex] ) );
+				}
+				catch( const Exception & pException )
+				{
+					// Worker ranges must not throw. The shader is reported as failed, like any other unreadable source.
+					Ic3DebugOutputFmt( "[ShaderLoadBatch] Failed to read shader source: %s", pException.what() );
+				}
+			}
+		};
+
+		if( _threadPool )
+		{
+			_threadPool->ParallelFor( _shaderLoadDescList.size(), 1, readSourceRange );
+		}
+		else
+		{
+			readSourceRange( 0, _shaderLoadDescList.size() );
+		}
+
+		_stats.sourceReadTimeMs = System::PerfCounter::ConvertToMilliseconds( System::PerfCounter::QueryCounter() - _startTimeStamp ).get_count();
+	}
+
+	void ShaderLoadBatch::CreateShaders( WorkerThreadPool * pThreadPool )
+	{
+		const auto compileStartTimeStamp = System::PerfCounter::QueryCounter();
+
+		const auto createShaderRange = [this]( size_t pBeginIndex, size_t pEndIndex ) {
+			for( auto shaderIndex = pBeginIndex; shaderIndex < pEndIndex; ++shaderIndex )
+			{
+				const auto & shaderLoadDesc = *( _shaderLoadDescList[shaderIndex] );
+				if( !_shaderSources[shaderIndex].empty() )
+				{
+					_shaders[shaderIndex] = _shaderLoader->CreateShaderImpl(
+							shaderLoadDesc.shaderType,
+							shaderLoadDesc.shaderID,
+							shaderLoadDesc.shaderName,
+							_shaderSources[shaderIndex] );
+				}
+
+				// Sources are no longer needed, release the memory as early as possible.
+				_shaderSources[shaderIndex] = cppx::dynamic_memory_buffer{};
+			}
+		};
+
+		if( pThreadPool )
+		{
+			pThreadPool->ParallelFor( _shaderLoadDescList.size(), 1, createShaderRange );
+		}
+		else
+		{
+			createShaderRange( 0, _shaderLoadDescList.size() );
+		}
+
+		const auto endTimeStamp = System::PerfCounter::QueryCounter();
+
+		_stats.loadedShadersNum = static_cast<uint32>( std::count_if(
+				_shaders.begin(),
+				_shaders.end(),
+				[]( const auto & pShader ) { return pShader != nullptr; } ) );
+		_stats.failedShadersNum = static_cast<uint32>( _shaders.size() ) - _stats.loadedShadersNum;
+		_stats.compileTimeMs = System::PerfCounter::ConvertToMilliseconds( endTimeStamp - compileStartTimeStamp ).get_count();
+		_stats.totalTimeMs = System::PerfCounter::ConvertToMilliseconds( endTimeStamp - _startTimeStamp ).get_count();
+	}
+
+
 	ShaderLoader::ShaderLoader( const CoreEngineState & pCES )
 	: CoreEngineObject( pCES )
 	{}
 
 	ShaderLoader::~ShaderLoader() = default;
 
+	GCI::ShaderHandle ShaderLoader::LoadShader( const ShaderLoadDescBase & pShaderLoadDesc )
+	{
+		const auto shaderSource = ReadShaderSource( pShaderLoadDesc );
+		if( !shaderSource.empty() )
+		{
+			return CreateShaderImpl(
+					pShaderLoadDesc.shaderType,
+					pShaderLoadDesc.shaderID,
+					pShaderLoadDesc.shaderName,
+					shaderSource );
+		}
+
+		return nullptr;
+	}
+
+	void ShaderLoader::SetShaderPreprocessor( ShaderPreprocessorHandle pShaderPreprocessor )
+	{
+		_shaderPreprocessor = std::move( pShaderPreprocessor );
+	}
+
+	void ShaderLoader::SetShaderCache( ShaderCacheHandle pShaderCache )
+	{
+		_shaderCache = std::move( pShaderCache );
+	}
+
+	GfxObjectID ShaderLoader::ResolveShaderID( const ShaderLoadDescBase & pShaderLoadDesc )
+	{
+		if( pShaderLoadDesc.shaderID == Graphics::kGfxObjectIDAuto )
+		{
+			Ic3DebugAssert( !pShaderLoadDesc.shaderName.empty() );
+			return Graphics::GenerateGfxObjectID( pShaderLoadDesc.shaderName );
+		}
+
+		return pShaderLoadDesc.shaderID;
+	}
+
+	cppx::dynamic_memory_buffer ShaderLoader::PreprocessShaderSource(
+			const ShaderLoadDescBase & pShaderLoadDesc,
+			const std::string & pSourceName,
+			cppx::dynamic_memory_buffer pShaderSource )
+	{
+		if( !_shaderPreprocessor || pShaderSource.empty() )
+		{
+			return pShaderSource;
+		}
+
+		ShaderPreprocessedSource preprocessedSource;
+		if( !_shaderPreprocessor->PreprocessSource(
+				pSourceName,
+				pShaderSource.data(),
+				pShaderSource.size(),
+				pShaderLoadDesc.permutationKey,
+				preprocessedSource ) )
+		{
+			Ic3DebugOutputFmt(
+					"[ShaderLoader] Failed to preprocess '%s': %s",
+					pSourceName.c_str(),
+					preprocessedSource.errorMessage.c_str() );
+			return {};
+		}
+
+		return std::move( preprocessedSource.source );
+	}
+
 	GCI::ShaderHandle ShaderLoader::CreateShaderImpl(
 			GCI::EShaderType pShaderType,
 			GfxObjectID pShaderID,
 			const GfxObjectName & pShaderName,
 			const cppx::dynamic_memory_buffer & pShaderSource )
 	{
+		if( pShaderID == Graphics::kGfxObjectIDAuto )
+		{
+			Ic3DebugAssert( !pShaderName.empty() );
+			pShaderID = Graphics::GenerateGfxObjectID( pShaderName );
+		}
+
 		GCI::ShaderHandle shaderObject = nullptr;
 
-		if( !pShaderSource.empty() )
+		if( !pShaderSource.empty() && _shaderCache )
 		{
-			shaderObject = GCIUtils::CreateShaderFromSource(
+			// A shader shared by the cache gets the ID of its first load (see ResolveShaderID()).
+			shaderObject = _shaderCache->GetOrCreateShader(
 					*( mCES.mGPUDevice ),
 					pShaderType,
 					pShaderSource.data(),
-					pShaderSource.size() );
+					pShaderSource.size(),
+					pShaderID );
 		}
-
-		if( shaderObject )
+		else if( !pShaderSource.empty() )
 		{
-			if( pShaderID == Graphics::kGfxObjectIDAuto )
-			{
-				Ic3DebugAssert( !pShaderName.empty() );
-				pShaderID = Graphics::GenerateGfxObjectID( pShaderName );
-			}
+			shaderObject = GCIUtils::CreateShaderFromSource(
+					*( mCES.mGPUDevice ),
+					pShaderType,
+					pShaderSource.data(),
+					pShaderSource.size() );
 
-			if( Graphics::IsGfxObjectIDValid( pShaderID ) )
+			if( shaderObject && Graphics::IsGfxObjectIDValid( pShaderID ) )
 			{
 				shaderObject->SetObjectID( pShaderID );
 			}
@@ -57,6 +294,36 @@ namespace Ic3
 			( !pLoadDescBase.shaderName.empty() || Graphics::IsGfxObjectIDValid( pLoadDescBase.shaderID ) );
 	}
 
+	ShaderLoadBatchHandle ShaderLoader::LoadShadersAsyncImpl(
+			std::shared_ptr<void> pShaderLoadDescStorage,
+			std::vector<const ShaderLoadDescBase *> pShaderLoadDescList,
+			WorkerThreadPool * pThreadPool )
+	{
+		const auto concurrentCompilation = mCES.mGPUDevice->IsMultiThreadAccessSupported();
+
+		auto shaderLoadBatch = CreateDynamicObject<ShaderLoadBatch>(
+				GetHandle<ShaderLoader>(),
+				std::move( pShaderLoadDescStorage ),
+				std::move( pShaderLoadDescList ),
+				pThreadPool,
+				concurrentCompilation );
+
+		if( shaderLoadBatch->GetShadersNum() == 0 )
+		{
+			shaderLoadBatch->_finished.store( true, std::memory_order_release );
+		}
+		else
+		{
+			// The batch waits for the task in its destructor, so it can be passed as a raw pointer.
+			shaderLoadBatch->_asyncTaskFuture = std::async(
+					std::launch::async,
+					&ShaderLoadBatch::ExecuteAsync,
+					shaderLoadBatch.get() );
+		}
+
+		return shaderLoadBatch;
+	}
+
 	ShaderLibraryHandle ShaderLoader::CreateNewShaderLibrary() const
 	{
 		return CreateDynamicObject<ShaderLibrary>( mCES );
@@ -65,16 +332,21 @@ namespace Ic3
 	void ShaderLoader::AddShaderToLibrary(
 			ShaderLibrary & pShaderLibrary,
 			GCI::ShaderHandle pShader,
-			const cppx::immutable_string & pShaderName )
+			const ShaderLoadDescBase & pShaderLoadDesc )
 	{
-		if( Graphics::IsGfxObjectIDValid( pShader->GetObjectID() ) )
+		const auto shaderID = ResolveShaderID( pShaderLoadDesc );
+		if( Graphics::IsGfxObjectIDValid( shaderID ) )
+		{
+			pShaderLibrary.RegisterShader( pShader, shaderID );
+		}
+		else if( Graphics::IsGfxObjectIDValid( pShader->GetObjectID() ) )
 		{
 			pShaderLibrary.RegisterShader( pShader, pShader->GetObjectID() );
 		}
 
-		if( !pShaderName.empty() )
+		if( !pShaderLoadDesc.shaderName.empty() )
 		{
-			pShaderLibrary.RegisterShader( pShader, pShaderName );
+			pShaderLibrary.RegisterShader( pShader, pShaderLoadDesc.shaderName );
 		}
 	}
 
@@ -85,23 +357,14 @@ namespace Ic3
 
 	ShaderLoaderMemoryBased::~ShaderLoaderMemoryBased() = default;
 
-	GCI::ShaderHandle ShaderLoaderMemoryBased::LoadShader( const ShaderLoadDescBase & pShaderLoadDesc )
+	cppx::dynamic_memory_buffer ShaderLoaderMemoryBased::ReadShaderSource( const ShaderLoadDescBase & pShaderLoadDesc )
 	{
 		if( const auto * loadDescMemory = ValidateShaderLoadDescMemory( pShaderLoadDesc ) )
 		{
-			auto shaderSource = loadDescMemory->shaderSourceReadCallback();
-			if( !shaderSource.empty() )
-			{
-				return CreateShaderImpl(
-						loadDescMemory->shaderType,
-						loadDescMemory->shaderID,
-						loadDescMemory->shaderName,
-						shaderSource );
-			}
-
+			return PreprocessShaderSource( pShaderLoadDesc, loadDescMemory->shaderName.str(), loadDescMemory->shaderSourceReadCallback() );
 		}
 
-		return nullptr;
+		return {};
 	}
 
 	TSharedHandle<ShaderLoaderMemoryBased> ShaderLoaderMemoryBased::CreateLoader( const CoreEngineState & pCES )
@@ -141,22 +404,17 @@ namespace Ic3
 
 	ShaderLoaderFileBased::~ShaderLoaderFileBased() = default;
 
-	GCI::ShaderHandle ShaderLoaderFileBased::LoadShader( const ShaderLoadDescBase & pShaderLoadDesc )
+	cppx::dynamic_memory_buffer ShaderLoaderFileBased::ReadShaderSource( const ShaderLoadDescBase & pShaderLoadDesc )
 	{
 		if( const auto * loadDescFile = ValidateShaderLoadDescFile( pShaderLoadDesc ) )
 		{
-			auto shaderSource = _fileLoadCallback( loadDescFile->shaderSourceFileName );
-			if( !shaderSource.empty() )
-			{
-				return CreateShaderImpl(
-						loadDescFile->shaderType,
-						loadDescFile->shaderID,
-						loadDescFile->shaderName,
-						shaderSource );
-			}
+			return PreprocessShaderSource(
+					pShaderLoadDesc,
+					loadDescFile->shaderSourceFileName,
+					_fileLoadCallback( loadDescFile->shaderSourceFileName ) );
 		}
 
-		return nullptr;
+		return {};
 	}
 
 	TSharedHandle<ShaderLoaderFileBased> ShaderLoaderFileBased::CreateLoader(
@@ -178,9 +436,7 @@ namespace Ic3
 			System::AssetLoaderHandle pAssetLoader,
 			std::string pShaderBaseSubDirectory )
 	{
-		return [pAssetLoader, shaderSubDir = std::move( pShaderBaseSubDirectory )]( const auto & pShaderFileName ) {
-				return System::AssetLoader::LoadAsset( *pAssetLoader, shaderSubDir + "/" + pShaderFileName, true );
-			};
+		return ShaderPreprocessor::BindAssetFileLoadCallback( pAssetLoader, std::move( pShaderBaseSubDirectory ) );
 	}
 
 	const ShaderLoadDescFile * ShaderLoaderFileBased::ValidateShaderLoadDescFile( const ShaderLoadDescBase & pLoadDescBase )
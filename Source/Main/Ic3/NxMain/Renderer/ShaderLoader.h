@@ -4,18 +4,24 @@
 #ifndef __IC3_NXMAIN_SHADER_LOADER_H__
 #define __IC3_NXMAIN_SHADER_LOADER_H__
 
-#include "CommonRendererDefs.h"
+#include "ShaderCache.h"
 #include <Ic3/Graphics/GCI/Resources/ShaderCommon.h>
+#include <Ic3/System/PerfCounter.h>
 #include <Ic3/System/IO/AssetCommon.h>
+#include <atomic>
+#include <future>
+#include <mutex>
 
 namespace Ic3
 {
 
+	class WorkerThreadPool;
+
+	Ic3DeclareClassHandle( ShaderLoadBatch );
 	Ic3DeclareClassHandle( ShaderLoader );
 	Ic3DeclareClassHandle( ShaderLoaderMemoryBased );
 	Ic3DeclareClassHandle( ShaderLoaderFileBased );
 
-	using ShaderFileLoadCallback = std::function<cppx::dynamic_memory_buffer( const std::string & )>;
 	using ShaderSourceReadCallback = std::function<cppx::dynamic_memory_buffer()>;
 
 	enum class EShaderLoadDescType : enum_default_value_t
@@ -38,6 +44,9 @@ namespace Ic3
 
 	    GfxObjectID shaderID = Graphics::kGfxObjectIDEmpty;
 
+		/// Permutation of the shader, used only if the loader has a ShaderPreprocessor (see ShaderLoader::SetShaderPreprocessor()).
+		shader_permutation_key_t permutationKey = 0;
+
 		explicit ShaderLoadDescBase( EShaderLoadDescType pDescType )
 		: descType( pDescType )
 		{}
@@ -104,17 +113,94 @@ namespace Ic3
 		ShaderSourceReadCallback shaderSourceReadCallback;
 
 		ShaderLoadDescMemory()
-		: ShaderLoadDescBase( EShaderLoadDescType::LDFile )
+		: ShaderLoadDescBase( EShaderLoadDescType::LDMemory )
 		{}
 
 		ShaderLoadDescMemory(
 				GCI::EShaderType pShaderType,
 				cppx::immutable_string pShaderName,
 				GfxObjectID pShaderID = Graphics::kGfxObjectIDEmpty )
-		: ShaderLoadDescBase( EShaderLoadDescType::LDFile, pShaderType, pShaderName, pShaderID )
+		: ShaderLoadDescBase( EShaderLoadDescType::LDMemory, pShaderType, pShaderName, pShaderID )
 		{}
 	};
 
+	struct ShaderLoadBatchStats
+	{
+		uint32 loadedShadersNum = 0;
+		uint32 failedShadersNum = 0;
+		/// Time of reading all shader sources, measured from the start of the batch.
+		double sourceReadTimeMs = 0;
+		/// Time of creating all shaders. With serialized compilation it does not include the time before Wait().
+		double compileTimeMs = 0;
+		/// Wall-clock time from the start of the batch until the last shader has been created.
+		double totalTimeMs = 0;
+	};
+
+	/**
+	 * @brief Handle to a batch of shaders loaded asynchronously with ShaderLoader::LoadShadersAsync().
+	 *
+	 * Shader sources are read by a background task (in parallel, if a WorkerThreadPool has been specified). If the GPU
+	 * device supports concurrent resource creation (GPUDevice::IsMultiThreadAccessSupported()), shaders are compiled
+	 * by the same task and the batch finishes on its own. Otherwise (e.g. OpenGL or the Null device), compilation is
+	 * serialized and done by Wait() on the calling thread, which has to be the thread owning the device.
+	 */
+	class IC3_NXMAIN_CLASS ShaderLoadBatch : public IDynamicObject
+	{
+		friend class ShaderLoader;
+
+	public:
+		ShaderLoadBatch(
+				ShaderLoaderHandle pShaderLoader,
+				std::shared_ptr<void> pShaderLoadDescStorage,
+				std::vector<const ShaderLoadDescBase *> pShaderLoadDescList,
+				WorkerThreadPool * pThreadPool,
+				bool pConcurrentCompilation );
+
+		~ShaderLoadBatch();
+
+		/// @brief Returns true if all shaders have been created. With serialized compilation, only after Wait().
+		CPPX_ATTR_NO_DISCARD bool IsFinished() const noexcept;
+
+		/// @brief Blocks until all shaders have been created.
+		void Wait();
+
+		/// @brief Waits for the batch and returns the shaders in the order of the load descs. Failed ones are null.
+		const std::vector<GCI::ShaderHandle> & GetShaders();
+
+		/// @brief Waits for the batch and registers all loaded shaders in the library. Returns the number of them.
+		uint32 AddShadersToLibrary( ShaderLibrary & pShaderLibrary );
+
+		/// @brief Waits for the batch and returns its statistics.
+		const ShaderLoadBatchStats & GetStats();
+
+		CPPX_ATTR_NO_DISCARD size_t GetShadersNum() const noexcept
+		{
+			return _shaderLoadDescList.size();
+		}
+
+	private:
+		void ExecuteAsync();
+
+		void ReadShaderSources();
+
+		void CreateShaders( WorkerThreadPool * pThreadPool );
+
+	private:
+		ShaderLoaderHandle _shaderLoader;
+		std::shared_ptr<void> _shaderLoadDescStorage;
+		std::vector<const ShaderLoadDescBase *> _shaderLoadDescList;
+		std::vector<cppx::dynamic_memory_buffer> _shaderSources;
+		std::vector<GCI::ShaderHandle> _shaders;
+		WorkerThreadPool * _threadPool;
+		bool _concurrentCompilation;
+		System::perf_counter_value_t _startTimeStamp;
+		ShaderLoadBatchStats _stats;
+		std::mutex _waitLock;
+		std::atomic<bool> _finished{ false };
+		// Declared last: destroyed first, which waits for the task still using the members above.
+		std::future<void> _asyncTaskFuture;
+	};
+
 	/**
 	 *
 	 */
@@ -124,7 +210,43 @@ namespace Ic3
 		explicit ShaderLoader( const CoreEngineState & pCES );
 		virtual ~ShaderLoader();
 
-		virtual GCI::ShaderHandle LoadShader( const ShaderLoadDescBase & pShaderLoadDesc ) = 0;
+		virtual GCI::ShaderHandle LoadShader( const ShaderLoadDescBase & pShaderLoadDesc );
+
+		/// @brief Sets the preprocessor used to expand includes and permutation defines of all loaded sources.
+		/// Should be set before any loading starts (it is not synchronized with batch loads in progress).
+		void SetShaderPreprocessor( ShaderPreprocessorHandle pShaderPreprocessor );
+
+		/// @brief Sets the cache used to create shaders. Loads resulting in the same (preprocessed) source share a single
+		/// shader object, which keeps the ID of the first load - use ResolveShaderID() to get the ID of a specific desc.
+		/// Should be set before any loading starts.
+		void SetShaderCache( ShaderCacheHandle pShaderCache );
+
+		/// @brief Returns the ID under which a shader loaded with the specified desc is registered in a ShaderLibrary.
+		CPPX_ATTR_NO_DISCARD static GfxObjectID ResolveShaderID( const ShaderLoadDescBase & pShaderLoadDesc );
+
+		/// @brief Starts loading the shaders in the background and returns immediately. See ShaderLoadBatch for details.
+		/// The thread pool (optional) is used to read sources (and compile shaders) in parallel. It has to remain valid
+		/// until the batch is finished.
+		template <typename TPLoadDesc>
+		CPPX_ATTR_NO_DISCARD ShaderLoadBatchHandle LoadShadersAsync(
+				std::vector<TPLoadDesc> pShaderLoadDescList,
+				WorkerThreadPool * pThreadPool = nullptr )
+		{
+			static_assert( std::is_base_of_v<ShaderLoadDescBase, TPLoadDesc> );
+
+			// Descs are accessed through the base type (validation checks descType), so they are kept in their
+			// original type for the lifetime of the batch.
+			auto shaderLoadDescStorage = std::make_shared<std::vector<TPLoadDesc>>( std::move( pShaderLoadDescList ) );
+
+			std::vector<const ShaderLoadDescBase *> shaderLoadDescPtrList;
+			shaderLoadDescPtrList.reserve( shaderLoadDescStorage->size() );
+			for( const auto & shaderLoadDesc : *shaderLoadDescStorage )
+			{
+				shaderLoadDescPtrList.push_back( &shaderLoadDesc );
+			}
+
+			return LoadShadersAsyncImpl( std::move( shaderLoadDescStorage ), std::move( shaderLoadDescPtrList ), pThreadPool );
+		}
 
 		template <typename TPLoadDesc>
 		std::vector<GCI::ShaderHandle> LoadShaders( std::initializer_list<TPLoadDesc> pShaderLoadDescList )
@@ -150,7 +272,7 @@ namespace Ic3
 		{
 			if( const auto shaderObjectHandle = LoadShader( pShaderLoadDesc ) )
 			{
-				AddShaderToLibrary( pShaderLibrary, shaderObjectHandle, pShaderLoadDesc.shaderName );
+				AddShaderToLibrary( pShaderLibrary, shaderObjectHandle, pShaderLoadDesc );
 				return true;
 			}
 
@@ -182,7 +304,7 @@ namespace Ic3
 			if( const auto shaderObjectHandle = LoadShader( pShaderLoadDesc ) )
 			{
 				shaderLibrary = CreateNewShaderLibrary();
-				AddShaderToLibrary( *shaderLibrary, shaderObjectHandle, pShaderLoadDesc.shaderName );
+				AddShaderToLibrary( *shaderLibrary, shaderObjectHandle, pShaderLoadDesc );
 			}
 
 			return shaderLibrary;
@@ -199,7 +321,7 @@ namespace Ic3
 				{
 					if( const auto shaderObjectHandle = LoadShader( shaderLoadDesc ) )
 					{
-						AddShaderToLibrary( *shaderLibrary, shaderObjectHandle, shaderLoadDesc.shaderName );
+						AddShaderToLibrary( *shaderLibrary, shaderObjectHandle, shaderLoadDesc );
 					}
 				}
 			}
@@ -208,6 +330,17 @@ namespace Ic3
 		}
 
 	protected:
+		/// @brief Reads the source of a shader. Returns an empty buffer if the desc is not valid for this loader or the
+		/// source could not be read. Called concurrently for batch loads, so it must be thread-safe.
+		virtual cppx::dynamic_memory_buffer ReadShaderSource( const ShaderLoadDescBase & pShaderLoadDesc ) = 0;
+
+		/// @brief Runs the preprocessor (if set) on a source read by ReadShaderSource(). pSourceName is used to resolve
+		/// relative includes. Returns an empty buffer if preprocessing fails.
+		cppx::dynamic_memory_buffer PreprocessShaderSource(
+			const ShaderLoadDescBase & pShaderLoadDesc,
+			const std::string & pSourceName,
+			cppx::dynamic_memory_buffer pShaderSource );
+
 		GCI::ShaderHandle CreateShaderImpl(
 			GCI::EShaderType pShaderType,
 			GfxObjectID pShaderID,
@@ -217,12 +350,23 @@ namespace Ic3
 		static bool ValidateShaderLoadDescBase( const ShaderLoadDescBase & pLoadDescBase );
 
 	private:
+		friend class ShaderLoadBatch;
+
+		CPPX_ATTR_NO_DISCARD ShaderLoadBatchHandle LoadShadersAsyncImpl(
+				std::shared_ptr<void> pShaderLoadDescStorage,
+				std::vector<const ShaderLoadDescBase *> pShaderLoadDescList,
+				WorkerThreadPool * pThreadPool );
+
 		CPPX_ATTR_NO_DISCARD ShaderLibraryHandle CreateNewShaderLibrary() const;
 
 		static void AddShaderToLibrary(
 				ShaderLibrary & pShaderLibrary,
 				GCI::ShaderHandle pShader,
-				const cppx::immutable_string & pShaderName );
+				const ShaderLoadDescBase & pShaderLoadDesc );
+
+	private:
+		ShaderPreprocessorHandle _shaderPreprocessor;
+		ShaderCacheHandle _shaderCache;
 	};
 
 	/**
@@ -234,11 +378,11 @@ namespace Ic3
 		explicit ShaderLoaderMemoryBased( const CoreEngineState & pCES );
 		virtual ~ShaderLoaderMemoryBased();
 
-		virtual GCI::ShaderHandle LoadShader( const ShaderLoadDescBase & pShaderLoadDesc ) override final;
-
 		CPPX_ATTR_NO_DISCARD static TSharedHandle<ShaderLoaderMemoryBased> CreateLoader( const CoreEngineState & pCES );
 
 	protected:
+		virtual cppx::dynamic_memory_buffer ReadShaderSource( const ShaderLoadDescBase & pShaderLoadDesc ) override final;
+
 		static const ShaderLoadDescMemory * ValidateShaderLoadDescMemory( const ShaderLoadDescBase & pLoadDescBase );
 	};
 
@@ -259,8 +403,6 @@ namespace Ic3
 
 		virtual ~ShaderLoaderFileBased();
 
-		virtual GCI::ShaderHandle LoadShader( const ShaderLoadDescBase & pShaderLoadDesc ) override final;
-
 		CPPX_ATTR_NO_DISCARD static TSharedHandle<ShaderLoaderFileBased> CreateLoader(
 				const CoreEngineState & pCES,
 				ShaderFileLoadCallback pFileLoadCallback );
@@ -270,6 +412,9 @@ namespace Ic3
 				System::AssetLoaderHandle pAssetLoader,
 				std::string pShaderBaseSubDirectory );
 
+	protected:
+		virtual cppx::dynamic_memory_buffer ReadShaderSource( const ShaderLoadDescBase & pShaderLoadDesc ) override final;
+
 	private:
 		static ShaderFileLoadCallback BindShaderFileLoadCallback(
 				System::AssetLoaderHandle pAssetLoader,
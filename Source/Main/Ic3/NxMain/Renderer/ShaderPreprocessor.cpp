@@ -0,0 +1,489 @@
+
+#include "ShaderPreprocessor.h"
+#include <Ic3/System/IO/AssetSystem.h>
+#include <cppx/fsUtils.h>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		size_t SkipHorizontalSpaces( std::string_view pLine, size_t pPosition )
+		{
+			while( ( pPosition < pLine.size() ) && ( ( pLine[pPosition] == ' ' ) || ( pLine[pPosition] == '\t' ) ) )
+			{
+				++pPosition;
+			}
+			return pPosition;
+		}
+
+		// Returns the name of a preprocessor directive in the line (e.g. "include") and sets pOutArgsPosition to the
+		// first character after it. Returns an empty view if the line is not a directive.
+		std::string_view ParseDirectiveName( std::string_view pLine, size_t & pOutArgsPosition )
+		{
+			auto position = SkipHorizontalSpaces( pLine, 0 );
+			if( ( position >= pLine.size() ) || ( pLine[position] != '#' ) )
+			{
+				return {};
+			}
+
+			position = SkipHorizontalSpaces( pLine, position + 1 );
+
+			const auto nameBegin = position;
+			while( ( position < pLine.size() ) && ( std::isalpha( static_cast<unsigned char>( pLine[position] ) ) || ( pLine[position] == '_' ) ) )
+			{
+				++position;
+			}
+
+			pOutArgsPosition = position;
+			return pLine.substr( nameBegin, position - nameBegin );
+		}
+
+		// Updates the block comment state with the content of a line. String literals and line comments are skipped,
+		// so neither "/*" in a string nor in a // comment starts a block comment.
+		void UpdateBlockCommentState( std::string_view pLine, bool & pInBlockComment )
+		{
+			for( size_t position = 0; position < pLine.size(); ++position )
+			{
+				if( pInBlockComment )
+				{
+					if( ( pLine[position] == '*' ) && ( position + 1 < pLine.size() ) && ( pLine[position + 1] == '/' ) )
+					{
+						pInBlockComment = false;
+						++position;
+					}
+				}
+				else if( pLine[position] == '"' )
+				{
+					for( ++position; ( position < pLine.size() ) && ( pLine[position] != '"' ); ++position )
+					{
+						if( pLine[position] == '\\' )
+						{
+							++position;
+						}
+					}
+				}
+				else if( ( pLine[position] == '/' ) && ( position + 1 < pLine.size() ) )
+				{
+					if( pLine[position + 1] == '/' )
+					{
+						return;
+					}
+					if( pLine[position + 1] == '*' )
+					{
+						pInBlockComment = true;
+						++position;
+					}
+				}
+			}
+		}
+
+		// Returns the offset and the number of the line following the #version directive, if it is the first directive
+		// in the source (GLSL requires it to precede everything else). Otherwise, returns the beginning of the source.
+		size_t FindPermutationDefinesPosition( std::string_view pSource, size_t & pOutLineNumber )
+		{
+			pOutLineNumber = 1;
+
+			size_t lineBegin = 0;
+			size_t lineNumber = 1;
+			bool inBlockComment = false;
+
+			while( lineBegin < pSource.size() )
+			{
+				const auto lineEnd = std::min( pSource.find( '\n', lineBegin ), pSource.size() );
+				const auto line = pSource.substr( lineBegin, lineEnd - lineBegin );
+
+				if( !inBlockComment )
+				{
+					size_t argsPosition = 0;
+					const auto directiveName = ParseDirectiveName( line, argsPosition );
+					if( directiveName == "version" )
+					{
+						pOutLineNumber = lineNumber + 1;
+						return std::min( lineEnd + 1, pSource.size() );
+					}
+
+					const auto firstCharPosition = SkipHorizontalSpaces( line, 0 );
+					const auto isCodeLine =
+						( firstCharPosition < line.size() ) &&
+						( line[firstCharPosition] != '\r' ) &&
+						( line.substr( firstCharPosition, 2 ) != "//" ) &&
+						( line.substr( firstCharPosition, 2 ) != "/*" );
+
+					if( isCodeLine )
+					{
+						break;
+					}
+				}
+
+				UpdateBlockCommentState( line, inBlockComment );
+
+				lineBegin = lineEnd + 1;
+				++lineNumber;
+			}
+
+			return 0;
+		}
+
+		// Returns the directory part of a file name (with the trailing separator) or an empty string.
+		std::string GetFileDirectory( const std::string & pFileName )
+		{
+			const auto lastSeparatorPos = pFileName.find_last_of( "/\\" );
+			return ( lastSeparatorPos != std::string::npos ) ? pFileName.substr( 0, lastSeparatorPos + 1 ) : std::string{};
+		}
+
+		std::string_view GetSourceText( const void * pSource, size_t pSourceLength )
+		{
+			const auto * sourceChars = static_cast<const char *>( pSource );
+			const auto * nullTermPtr = static_cast<const char *>( std::memchr( sourceChars, 0, pSourceLength ) );
+			return std::string_view{ sourceChars, nullTermPtr ? static_cast<size_t>( nullTermPtr - sourceChars ) : pSourceLength };
+		}
+
+		void AppendLineDirective( std::string & pOutput, size_t pLineNumber )
+		{
+			pOutput.append( "#line " );
+			pOutput.append( std::to_string( pLineNumber ) );
+			pOutput.push_back( '\n' );
+		}
+
+	}
+
+	struct ShaderPreprocessor::PreprocessState
+	{
+		std::string output;
+		// Files currently being expanded, used to detect recursive includes.
+		std::vector<std::string> includeStack;
+		std::unordered_set<std::string> pragmaOnceFiles;
+		std::vector<std::string> includedFiles;
+		std::string errorMessage;
+	};
+
+	ShaderPreprocessor::ShaderPreprocessor( ShaderPreprocessorCreateInfo pCreateInfo )
+	: _fileLoadCallback( std::move( pCreateInfo.fileLoadCallback ) )
+	, _permutationDefineNames( std::move( pCreateInfo.permutationDefineNames ) )
+	, _emitLineDirectives( pCreateInfo.emitLineDirectives )
+	, _cacheIncludedFiles( pCreateInfo.cacheIncludedFiles )
+	, _includeDepthLimit( pCreateInfo.includeDepthLimit )
+	{
+		Ic3DebugAssert( _permutationDefineNames.size() <= kShaderPermutationDefinesMaxNum );
+
+		if( _permutationDefineNames.size() > kShaderPermutationDefinesMaxNum )
+		{
+			_permutationDefineNames.resize( kShaderPermutationDefinesMaxNum );
+		}
+
+		for( const auto & [defineName, defineValue] : pCreateInfo.commonDefines )
+		{
+			_commonDefines.append( "#define " + defineName + " " + defineValue + "\n" );
+		}
+	}
+
+	ShaderPreprocessor::~ShaderPreprocessor() = default;
+
+	bool ShaderPreprocessor::PreprocessFile(
+			const std::string & pFileName,
+			shader_permutation_key_t pPermutationKey,
+			ShaderPreprocessedSource & pOutResult )
+	{
+		const auto fileName = cppx::fs_normalize_path( pFileName );
+
+		// Not cached: the main file of a shader is read once per permutation anyway and may be reloaded when modified.
+		const auto fileData = ( !fileName.empty() && _fileLoadCallback ) ? _fileLoadCallback( fileName ) : cppx::dynamic_memory_buffer{};
+		if( fileData.empty() )
+		{
+			pOutResult = ShaderPreprocessedSource{};
+			pOutResult.errorMessage = "Cannot load shader file '" + pFileName + "'.";
+			Ic3DebugOutputFmt( "[ShaderPreprocessor] %s", pOutResult.errorMessage.c_str() );
+			return false;
+		}
+
+		return PreprocessSource( fileName, fileData.data(), fileData.size(), pPermutationKey, pOutResult );
+	}
+
+	bool ShaderPreprocessor::PreprocessSource(
+			const std::string & pSourceName,
+			const void * pSource,
+			size_t pSourceLength,
+			shader_permutation_key_t pPermutationKey,
+			ShaderPreprocessedSource & pOutResult )
+	{
+		pOutResult = ShaderPreprocessedSource{};
+
+
+		if( ( _permutationDefineNames.size() < kShaderPermutationDefinesMaxNum ) && ( ( pPermutationKey >> _permutationDefineNames.size() ) != 0 ) )
+		{
+			pOutResult.errorMessage = "Permutation key of '" + pSourceName + "' has bits without a define name.";
+			Ic3DebugOutputFmt( "[ShaderPreprocessor] %s", pOutResult.errorMessage.c_str() );
+			return false;
+		}
+
+		// Buffers loaded as text end with a null terminator, possibly followed by the alignment padding.
+		const auto source = pSource ? GetSourceText( pSource, pSourceLength ) : std::string_view{};
+		if( source.empty() )
+		{
+			pOutResult.errorMessage = "Empty shader source '" + pSourceName + "'.";
+			return false;
+		}
+
+		PreprocessState preprocessState{};
+		preprocessState.output.reserve( pSourceLength + _commonDefines.size() + 256 );
+
+		// Defines go after the #version directive (if present), the rest of the source is expanded as usual.
+		size_t sourceBodyLineNumber = 1;
+		const auto sourceBodyOffset = FindPermutationDefinesPosition( source, sourceBodyLineNumber );
+
+		preprocessState.output.append( source.substr( 0, sourceBodyOffset ) );
+		if( ( sourceBodyOffset > 0 ) && ( preprocessState.output.back() != '\n' ) )
+		{
+			preprocessState.output.push_back( '\n' );
+		}
+		preprocessState.output.append( GeneratePermutationDefines( pPermutationKey ) );
+
+		if( _emitLineDirectives )
+		{
+			AppendLineDirective( preprocessState.output, sourceBodyLineNumber );
+		}
+
+		const auto sourceName = cppx::fs_normalize_path( pSourceName );
+		preprocessState.includeStack.push_back( sourceName );
+
+		if( !ExpandSource( preprocessState, sourceName, source.substr( sourceBodyOffset ), sourceBodyLineNumber, 0 ) )
+		{
+			pOutResult.errorMessage = std::move( preprocessState.errorMessage );
+			Ic3DebugOutputFmt( "[ShaderPreprocessor] %s", pOutResult.errorMessage.c_str() );
+			return false;
+		}
+
+		// Null-terminated (padding of the buffer is zeroed as well), so the result can be used as a C string.
+		pOutResult.source.resize( preprocessState.output.size() + 1 );
+		std::memset( pOutResult.source.data(), 0, pOutResult.source.size() );
+		std::memcpy( pOutResult.source.data(), preprocessState.output.data(), preprocessState.output.size() );
+		pOutResult.sourceHash = ComputeSourceHash( preprocessState.output.data(), preprocessState.output.size() );
+		pOutResult.includedFiles = std::move( preprocessState.includedFiles );
+
+		return true;
+	}
+
+	shader_permutation_key_t ShaderPreprocessor::GetPermutationKey( std::initializer_list<std::string_view> pDefineNames ) const
+	{
+		shader_permutation_key_t permutationKey = 0;
+		for( const auto & defineName : pDefineNames )
+		{
+			const auto defineNameIter = std::find( _permutationDefineNames.begin(), _permutationDefineNames.end(), defineName );
+			if( defineNameIter != _permutationDefineNames.end() )
+			{
+				permutationKey |= ( static_cast<shader_permutation_key_t>( 1 ) << ( defineNameIter - _permutationDefineNames.begin() ) );
+			}
+		}
+
+		return permutationKey;
+	}
+
+	std::string ShaderPreprocessor::GeneratePermutationDefines( shader_permutation_key_t pPermutationKey ) const
+	{
+		std::string permutationDefines = _commonDefines;
+		for( size_t defineIndex = 0; defineIndex < _permutationDefineNames.size(); ++defineIndex )
+		{
+			if( pPermutationKey & ( static_cast<shader_permutation_key_t>( 1 ) << defineIndex ) )
+			{
+				permutationDefines.append( "#define " + _permutationDefineNames[defineIndex] + " 1\n" );
+			}
+		}
+
+		return permutationDefines;
+	}
+
+	void ShaderPreprocessor::ClearIncludeCache()
+	{
+		const std::lock_guard<std::mutex> includeCacheLock{ _includeCacheLock };
+		_includeCache.clear();
+	}
+
+	shader_source_hash_t ShaderPreprocessor::ComputeSourceHash( const void * pSource, size_t pSourceLength )
+	{
+		const auto source = GetSourceText( pSource, pSourceLength );
+		return cppx::hash_compute<shader_source_hash_t::hash_algo>( static_cast<const void *>( source.data() ), source.size() );
+	}
+
+	ShaderFileLoadCallback ShaderPreprocessor::BindAssetFileLoadCallback(
+			System::AssetLoaderHandle pAssetLoader,
+			std::string pShaderBaseSubDirectory )
+	{
+		return [pAssetLoader, shaderSubDir = std::move( pShaderBaseSubDirectory )]( const auto & pShaderFileName ) {
+				return System::AssetLoader::LoadAsset( *pAssetLoader, shaderSubDir + "/" + pShaderFileName, true );
+			};
+	}
+
+	bool ShaderPreprocessor::ExpandSource(
+			PreprocessState & pState,
+			const std::string & pFileName,
+			std::string_view pSource,
+			size_t pFirstLineNumber,
+			uint32 pIncludeDepth )
+	{
+		size_t lineBegin = 0;
+		size_t lineNumber = pFirstLineNumber - 1;
+		bool inBlockComment = false;
+
+		while( lineBegin < pSource.size() )
+		{
+			const auto lineEnd = std::min( pSource.find( '\n', lineBegin ), pSource.size() );
+			const auto line = pSource.substr( lineBegin, lineEnd - lineBegin );
+			lineBegin = lineEnd + 1;
+			++lineNumber;
+
+			size_t argsPosition = 0;
+			const auto directiveName = inBlockComment ? std::string_view{} : ParseDirectiveName( line, argsPosition );
+
+			if( directiveName == "include" )
+			{
+				const auto nameBegin = SkipHorizontalSpaces( line, argsPosition );
+				const auto openingChar = ( nameBegin < line.size() ) ? line[nameBegin] : '\0';
+				const auto closingChar = ( openingChar == '<' ) ? '>' : '"';
+				const auto nameEnd = ( ( openingChar == '"' ) || ( openingChar == '<' ) ) ? line.find( closingChar, nameBegin + 1 ) : std::string_view::npos;
+
+				if( nameEnd == std::string_view::npos )
+				{
+					pState.errorMessage = pFileName + ":" + std::to_string( lineNumber ) + ": malformed #include directive.";
+					return false;
+				}
+
+				const auto includeName = line.substr( nameBegin + 1, nameEnd - nameBegin - 1 );
+				if( !ExpandInclude( pState, pFileName, lineNumber, includeName, openingChar == '"', pIncludeDepth ) )
+				{
+					return false;
+				}
+
+				if( _emitLineDirectives )
+				{
+					AppendLineDirective( pState.output, lineNumber + 1 );
+				}
+				else
+				{
+					pState.output.push_back( '\n' );
+				}
+
+				continue;
+			}
+
+			if( directiveName == "pragma" )
+			{
+				const auto pragmaArgsPosition = SkipHorizontalSpaces( line, argsPosition );
+				if( line.substr( pragmaArgsPosition, 4 ) == "once" )
+				{
+					pState.pragmaOnceFiles.insert( pFileName );
+					// An empty line keeps the line numbering.
+					pState.output.push_back( '\n' );
+					continue;
+				}
+			}
+
+			UpdateBlockCommentState( line, inBlockComment );
+
+			pState.output.append( line );
+			pState.output.push_back( '\n' );
+		}
+
+		return true;
+	}
+
+	bool ShaderPreprocessor::ExpandInclude(
+			PreprocessState & pState,
+			const std::string & pIncludingFileName,
+			size_t pLineNumber,
+			std::string_view pIncludeName,
+			bool pRelativeInclude,
+			uint32 pIncludeDepth )
+	{
+		const auto errorLocation = pIncludingFileName + ":" + std::to_string( pLineNumber ) + ": ";
+
+		if( pIncludeDepth >= _includeDepthLimit )
+		{
+			pState.errorMessage = errorLocation + "include depth limit exceeded.";
+			return false;
+		}
+
+		std::string candidateFileNames[2];
+		if( pRelativeInclude )
+		{
+			candidateFileNames[0] = cppx::fs_normalize_path( GetFileDirectory( pIncludingFileName ) + std::string( pIncludeName ) );
+		}
+		candidateFileNames[1] = cppx::fs_normalize_path( std::string( pIncludeName ) );
+
+		for( const auto & includeFileName : candidateFileNames )
+		{
+			if( includeFileName.empty() )
+			{
+				continue;
+			}
+
+			if( pState.pragmaOnceFiles.count( includeFileName ) > 0 )
+			{
+				return true;
+			}
+
+			const auto includeContent = LoadIncludeFile( includeFileName );
+			if( !includeContent )
+			{
+				continue;
+			}
+
+			if( std::find( pState.includeStack.begin(), pState.includeStack.end(), includeFileName ) != pState.includeStack.end() )
+			{
+				pState.errorMessage = errorLocation + "recursive inclusion of '" + includeFileName + "'.";
+				return false;
+			}
+
+			if( std::find( pState.includedFiles.begin(), pState.includedFiles.end(), includeFileName ) == pState.includedFiles.end() )
+			{
+				pState.includedFiles.push_back( includeFileName );
+			}
+
+			if( _emitLineDirectives )
+			{
+				AppendLineDirective( pState.output, 1 );
+			}
+
+			pState.includeStack.push_back( includeFileName );
+			const auto expandResult = ExpandSource( pState, includeFileName, *includeContent, 1, pIncludeDepth + 1 );
+			pState.includeStack.pop_back();
+
+			return expandResult;
+		}
+
+		pState.errorMessage = errorLocation + "cannot open include file '" + std::string( pIncludeName ) + "'.";
+		return false;
+	}
+
+	std::shared_ptr<const std::string> ShaderPreprocessor::LoadIncludeFile( const std::string & pFileName )
+	{
+		if( _cacheIncludedFiles )
+		{
+			const std::lock_guard<std::mutex> includeCacheLock{ _includeCacheLock };
+			const auto includeCacheIter = _includeCache.find( pFileName );
+			if( includeCacheIter != _includeCache.end() )
+			{
+				return includeCacheIter->second;
+			}
+		}
+
+		// Loaded without the lock. If two threads load the same file at once, both results are identical anyway.
+		const auto fileData = _fileLoadCallback ? _fileLoadCallback( pFileName ) : cppx::dynamic_memory_buffer{};
+		if( fileData.empty() )
+		{
+			return nullptr;
+		}
+
+		auto fileContent = std::make_shared<const std::string>( GetSourceText( fileData.data(), fileData.size() ) );
+
+		if( _cacheIncludedFiles )
+		{
+			const std::lock_guard<std::mutex> includeCacheLock{ _includeCacheLock };
+			_includeCache.emplace( pFileName, fileContent );
+		}
+
+		return fileContent;
+	}
+
+} // namespace Ic3
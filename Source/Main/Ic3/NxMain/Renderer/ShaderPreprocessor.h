@@ -0,0 +1,151 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_SHADER_PREPROCESSOR_H__
+#define __IC3_NXMAIN_SHADER_PREPROCESSOR_H__
+
+#include "CommonRendererDefs.h"
+#include <Ic3/System/IO/AssetCommon.h>
+#include <cppx/hash.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Ic3
+{
+
+	Ic3DeclareClassHandle( ShaderPreprocessor );
+
+	/// Bit mask selecting the permutation defines (see ShaderPreprocessorCreateInfo::permutationDefineNames).
+	using shader_permutation_key_t = uint64;
+
+	/// Content hash of a preprocessed shader source.
+	using shader_source_hash_t = cppx::hash_object<cppx::hash_algo::wyhash64>;
+
+	inline constexpr uint32 kShaderPermutationDefinesMaxNum = 64;
+
+	/// Loads a shader file by its name (path relative to the shader root directory). Returns an empty buffer on failure.
+	using ShaderFileLoadCallback = std::function<cppx::dynamic_memory_buffer( const std::string & )>;
+
+	struct ShaderPreprocessorCreateInfo
+	{
+		/// Callback used to load included files. See BindAssetFileLoadCallback() for loading through the asset system.
+		ShaderFileLoadCallback fileLoadCallback;
+
+		/// Names of the permutation defines. Bit N of a permutation key adds '#define permutationDefineNames[N] 1'.
+		std::vector<std::string> permutationDefineNames;
+
+		/// Defines (name and value) added to all permutations.
+		std::vector<std::pair<std::string, std::string>> commonDefines;
+
+		/// Emits #line directives, so compiler errors point to the correct line of the original file.
+		bool emitLineDirectives = true;
+
+		/// Keeps the content of included files in memory. Use ClearIncludeCache() after they have changed.
+		bool cacheIncludedFiles = true;
+
+		uint32 includeDepthLimit = 32;
+	};
+
+	struct ShaderPreprocessedSource
+	{
+		/// Expanded source, with all includes resolved and permutation defines inserted.
+		cppx::dynamic_memory_buffer source;
+
+		/// Hash of the expanded source. Permutations with the same hash are identical.
+		shader_source_hash_t sourceHash;
+
+		/// Files included by the source (directly or not), in the order of their first inclusion.
+		std::vector<std::string> includedFiles;
+
+		/// Description of the error if the preprocessing has failed.
+		std::string errorMessage;
+
+		explicit operator bool() const noexcept
+		{
+			return !source.empty();
+		}
+	};
+
+	/**
+	 * @brief CPU-side preprocessing of shader sources: #include resolution and permutation defines.
+	 *
+	 * Quoted includes ( #include "file" ) are looked up relative to the including file first, then relative to the
+	 * root directory of the file load callback. Angle-bracket includes are looked up only in the root directory.
+	 * '#pragma once' is supported. Includes are expanded regardless of surrounding conditional blocks (conditions are
+	 * evaluated later by the compiler), so headers should use include guards or '#pragma once'. Includes in block
+	 * comments are ignored. All other directives are passed to the compiler unchanged.
+	 *
+	 * Preprocess*() functions can be called concurrently (e.g. by the parallel batch loading in ShaderLoader).
+	 */
+	class IC3_NXMAIN_CLASS ShaderPreprocessor : public IDynamicObject
+	{
+	public:
+		explicit ShaderPreprocessor( ShaderPreprocessorCreateInfo pCreateInfo );
+		~ShaderPreprocessor();
+
+		/// @brief Loads a file with the file load callback and preprocesses it.
+		bool PreprocessFile(
+				const std::string & pFileName,
+				shader_permutation_key_t pPermutationKey,
+				ShaderPreprocessedSource & pOutResult );
+
+		/// @brief Preprocesses a source. pSourceName is used to resolve relative includes and in error messages.
+		bool PreprocessSource(
+				const std::string & pSourceName,
+				const void * pSource,
+				size_t pSourceLength,
+				shader_permutation_key_t pPermutationKey,
+				ShaderPreprocessedSource & pOutResult );
+
+		/// @brief Returns the permutation key with bits set for the specified define names. Unknown names are ignored.
+		CPPX_ATTR_NO_DISCARD shader_permutation_key_t GetPermutationKey( std::initializer_list<std::string_view> pDefineNames ) const;
+
+		/// @brief Returns the block of #define directives inserted into the source for the specified permutation.
+		CPPX_ATTR_NO_DISCARD std::string GeneratePermutationDefines( shader_permutation_key_t pPermutationKey ) const;
+
+		void ClearIncludeCache();
+
+		/// @brief Returns the hash of a source. The source ends at the first null character (if any), so the padding of
+		/// a text buffer does not change the hash.
+		CPPX_ATTR_NO_DISCARD static shader_source_hash_t ComputeSourceHash( const void * pSource, size_t pSourceLength );
+
+		/// @brief Returns a callback loading files from the specified sub-directory of an asset loader.
+		CPPX_ATTR_NO_DISCARD static ShaderFileLoadCallback BindAssetFileLoadCallback(
+				System::AssetLoaderHandle pAssetLoader,
+				std::string pShaderBaseSubDirectory );
+
+	private:
+		struct PreprocessState;
+
+		bool ExpandSource(
+				PreprocessState & pState,
+				const std::string & pFileName,
+				std::string_view pSource,
+				size_t pFirstLineNumber,
+				uint32 pIncludeDepth );
+
+		bool ExpandInclude(
+				PreprocessState & pState,
+				const std::string & pIncludingFileName,
+				size_t pLineNumber,
+				std::string_view pIncludeName,
+				bool pRelativeInclude,
+				uint32 pIncludeDepth );
+
+		std::shared_ptr<const std::string> LoadIncludeFile( const std::string & pFileName );
+
+	private:
+		ShaderFileLoadCallback _fileLoadCallback;
+		std::vector<std::string> _permutationDefineNames;
+		std::string _commonDefines;
+		bool _emitLineDirectives;
+		bool _cacheIncludedFiles;
+		uint32 _includeDepthLimit;
+		std::mutex _includeCacheLock;
+		std::unordered_map<std::string, std::shared_ptr<const std::string>> _includeCache;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_SHADER_PREPROCESSOR_H__
@@ -0,0 +1,285 @@
+
+#include "OcclusionDepthBuffer.h"
+#include <cmath>
+
+namespace Ic3
+{
+
+	static constexpr float kOcclusionDepthBufferClearValue = cppx::meta::limits<float>::max_value;
+
+	// Vertices with clip-space w below this value are treated as located at (or behind) the eye.
+	static constexpr float kOcclusionDepthBufferMinClipW = 1.0e-5f;
+
+	static constexpr uint32 kOcclusionBoxTriangleIndices[36] =
+	{
+		0, 1, 3, 0, 3, 2, // -X
+		4, 6, 7, 4, 7, 5, // +X
+		0, 4, 5, 0, 5, 1, // -Y
+		2, 3, 7, 2, 7, 6, // +Y
+		0, 2, 6, 0, 6, 4, // -Z
+		1, 5, 7, 1, 7, 3, // +Z
+	};
+
+	OcclusionDepthBuffer::OcclusionDepthBuffer() = default;
+
+	OcclusionDepthBuffer::~OcclusionDepthBuffer() = default;
+
+	void OcclusionDepthBuffer::Resize( uint32 pWidth, uint32 pHeight )
+	{
+		_tilesNumX = ( std::max<uint32>( pWidth, 1 ) + kOcclusionDepthBufferTileSize - 1 ) / kOcclusionDepthBufferTileSize;
+		_tilesNumY = ( std::max<uint32>( pHeight, 1 ) + kOcclusionDepthBufferTileSize - 1 ) / kOcclusionDepthBufferTileSize;
+		_width = _tilesNumX * kOcclusionDepthBufferTileSize;
+		_height = _tilesNumY * kOcclusionDepthBufferTileSize;
+
+		_depthBuffer.assign( static_cast<size_t>( _width ) * _height, kOcclusionDepthBufferClearValue );
+		_tileMaxDepthBuffer.assign( static_cast<size_t>( _tilesNumX ) * _tilesNumY, kOcclusionDepthBufferClearValue );
+	}
+
+	void OcclusionDepthBuffer::BeginFrame( const cxm::mat4f & pViewProjectionMatrix, bool pZeroToOneDepth )
+	{
+		Ic3DebugAssert( !_depthBuffer.empty() );
+
+		std::fill( _depthBuffer.begin(), _depthBuffer.end(), kOcclusionDepthBufferClearValue );
+		std::fill( _tileMaxDepthBuffer.begin(), _tileMaxDepthBuffer.end(), kOcclusionDepthBufferClearValue );
+
+		_viewProjectionMatrix = pViewProjectionMatrix;
+		_zeroToOneDepth = pZeroToOneDepth;
+	}
+
+	void OcclusionDepthBuffer::RasterizeTriangles( const cxm::vec3f * pVertices, const uint32 * pIndices, size_t pTrianglesNum )
+	{
+		for( size_t triangleIndex = 0; triangleIndex < pTrianglesNum; ++triangleIndex )
+		{
+			const auto * triangleIndices = pIndices + triangleIndex * 3;
+
+			ScreenVertex screenVertices[3];
+			if( !ProjectVertex( pVertices[triangleIndices[0]], screenVertices[0] ) ||
+			    !ProjectVertex( pVertices[triangleIndices[1]], screenVertices[1] ) ||
+			    !ProjectVertex( pVertices[triangleIndices[2]], screenVertices[2] ) )
+			{
+				continue;
+			}
+
+			RasterizeTriangle( screenVertices[0], screenVertices[1], screenVertices[2] );
+		}
+	}
+
+	void OcclusionDepthBuffer::RasterizeBox( const cxm::aabbf & pBox )
+	{
+		const auto & boxMin = pBox.min_corner;
+		const auto & boxMax = pBox.max_corner;
+
+		// Corner N has: x from bit 2, y from bit 1, z from bit 0.
+		const cxm::vec3f boxCorners[8] =
+		{
+			{ boxMin.x, boxMin.y, boxMin.z }, { boxMin.x, boxMin.y, boxMax.z },
+			{ boxMin.x, boxMax.y, boxMin.z }, { boxMin.x, boxMax.y, boxMax.z },
+			{ boxMax.x, boxMin.y, boxMin.z }, { boxMax.x, boxMin.y, boxMax.z },
+			{ boxMax.x, boxMax.y, boxMin.z }, { boxMax.x, boxMax.y, boxMax.z },
+		};
+
+		RasterizeTriangles( boxCorners, kOcclusionBoxTriangleIndices, 12 );
+	}
+
+	void OcclusionDepthBuffer::EndFrame()
+	{
+		for( uint32 tileY = 0; tileY < _tilesNumY; ++tileY )
+		{
+			for( uint32 tileX = 0; tileX < _tilesNumX; ++tileX )
+			{
+				auto tileMaxDepth = -cppx::meta::limits<float>::max_value;
+
+				for( uint32 pixelY = tileY * kOcclusionDepthBufferTileSize; pixelY < ( tileY + 1 ) * kOcclusionDepthBufferTileSize; ++pixelY )
+				{
+					const auto * depthRow = _depthBuffer.data() + static_cast<size_t>( pixelY ) * _width + tileX * kOcclusionDepthBufferTileSize;
+					for( uint32 pixelX = 0; pixelX < kOcclusionDepthBufferTileSize; ++pixelX )
+					{
+						tileMaxDepth = std::max( tileMaxDepth, depthRow[pixelX] );
+					}
+				}
+
+				_tileMaxDepthBuffer[tileY * _tilesNumX + tileX] = tileMaxDepth;
+			}
+		}
+	}
+
+	bool OcclusionDepthBuffer::IsBoxVisible( const cxm::aabbf & pBox ) const
+	{
+		const auto & boxMin = pBox.min_corner;
+		const auto & boxMax = pBox.max_corner;
+
+		auto rectMinX = cppx::meta::limits<float>::max_value;
+		auto rectMinY = cppx::meta::limits<float>::max_value;
+		auto rectMaxX = -cppx::meta::limits<float>::max_value;
+		auto rectMaxY = -cppx::meta::limits<float>::max_value;
+		auto boxMinDepth = cppx::meta::limits<float>::max_value;
+
+		for( uint32 cornerIndex = 0; cornerIndex < 8; ++cornerIndex )
+		{
+			const cxm::vec3f corner{
+				( cornerIndex & 4 ) ? boxMax.x : boxMin.x,
+				( cornerIndex & 2 ) ? boxMax.y : boxMin.y,
+				( cornerIndex & 1 ) ? boxMax.z : boxMin.z };
+
+			ScreenVertex screenCorner;
+			if( !ProjectVertex( corner, screenCorner ) )
+			{
+				// Box crosses the near plane - treat it as visible.
+				return true;
+			}
+
+			rectMinX = std::min( rectMinX, screenCorner.x );
+			rectMinY = std::min( rectMinY, screenCorner.y );
+			rectMaxX = std::max( rectMaxX, screenCorner.x );
+			rectMaxY = std::max( rectMaxY, screenCorner.y );
+
+			// Depth is monotonic with the view distance, so the nearest point of the box is one of its corners.
+			boxMinDepth = std::min( boxMinDepth, screenCorner.depth );
+		}
+
+		const auto pixelMinX = static_cast<int32>( std::max( std::floor( rectMinX ), 0.0f ) );
+		const auto pixelMinY = static_cast<int32>( std::max( std::floor( rectMinY ), 0.0f ) );
+		const auto pixelMaxX = static_cast<int32>( std::min( std::ceil( rectMaxX ), static_cast<float>( _width ) ) ) - 1;
+		const auto pixelMaxY = static_cast<int32>( std::min( std::ceil( rectMaxY ), static_cast<float>( _height ) ) ) - 1;
+
+		if( ( pixelMinX > pixelMaxX ) || ( pixelMinY > pixelMaxY ) )
+		{
+			// Entirely outside the viewport.
+			return false;
+		}
+
+		const auto tileSize = static_cast<int32>( kOcclusionDepthBufferTileSize );
+
+		for( auto tileY = pixelMinY / tileSize; tileY <= pixelMaxY / tileSize; ++tileY )
+		{
+			for( auto tileX = pixelMinX / tileSize; tileX <= pixelMaxX / tileSize; ++tileX )
+			{
+				if( _tileMaxDepthBuffer[tileY * _tilesNumX + tileX] < boxMinDepth )
+				{
+					// Every pixel of the tile is in front of the box.
+					continue;
+				}
+
+				const auto tilePixelMinX = std::max( pixelMinX, tileX * tileSize );
+				const auto tilePixelMaxX = std::min( pixelMaxX, tileX * tileSize + tileSize - 1 );
+				const auto tilePixelMinY = std::max( pixelMinY, tileY * tileSize );
+				const auto tilePixelMaxY = std::min( pixelMaxY, tileY * tileSize + tileSize - 1 );
+
+				for( auto pixelY = tilePixelMinY; pixelY <= tilePixelMaxY; ++pixelY )
+				{
+					const auto * depthRow = _depthBuffer.data() + static_cast<size_t>( pixelY ) * _width;
+					for( auto pixelX = tilePixelMinX; pixelX <= tilePixelMaxX; ++pixelX )
+					{
+						if( depthRow[pixelX] >= boxMinDepth )
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool OcclusionDepthBuffer::ProjectVertex( const cxm::vec3f & pVertex, ScreenVertex & pScreenVertex ) const
+	{
+		const auto & row0 = _viewProjectionMatrix[0];
+		const auto & row1 = _viewProjectionMatrix[1];
+		const auto & row2 = _viewProjectionMatrix[2];
+		const auto & row3 = _viewProjectionMatrix[3];
+
+		const auto clipX = row0.x * pVertex.x + row0.y * pVertex.y + row0.z * pVertex.z + row0.w;
+		const auto clipY = row1.x * pVertex.x + row1.y * pVertex.y + row1.z * pVertex.z + row1.w;
+		const auto clipZ = row2.x * pVertex.x + row2.y * pVertex.y + row2.z * pVertex.z + row2.w;
+		const auto clipW = row3.x * pVertex.x + row3.y * pVertex.y + row3.z * pVertex.z + row3.w;
+
+		if( ( clipW < kOcclusionDepthBufferMinClipW ) || ( clipZ < ( _zeroToOneDepth ? 0.0f : -clipW ) ) )
+		{
+			return false;
+		}
+
+		const auto oneOverW = 1.0f / clipW;
+		pScreenVertex.x = ( clipX * oneOverW * 0.5f + 0.5f ) * static_cast<float>( _width );
+		pScreenVertex.y = ( 0.5f - clipY * oneOverW * 0.5f ) * static_cast<float>( _height );
+		pScreenVertex.depth = clipZ * oneOverW;
+
+		return true;
+	}
+
+	void OcclusionDepthBuffer::RasterizeTriangle( const ScreenVertex & pVertex0, const ScreenVertex & pVertex1, const ScreenVertex & pVertex2 )
+	{
+		const auto * vertex0 = &pVertex0;
+		const auto * vertex1 = &pVertex1;
+		const auto * vertex2 = &pVertex2;
+
+		auto doubleArea = ( vertex1->x - vertex0->x ) * ( vertex2->y - vertex0->y ) - ( vertex1->y - vertex0->y ) * ( vertex2->x - vertex0->x );
+		if( std::abs( doubleArea ) < 1.0e-6f )
+		{
+			return;
+		}
+
+		// Both windings are accepted - occluders are closed volumes, so back faces are as good as front ones.
+		if( doubleArea < 0.0f )
+		{
+			std::swap( vertex1, vertex2 );
+			doubleArea = -doubleArea;
+		}
+
+		// Pixel N covers the range [N, N+1) and is sampled at its center.
+		const auto pixelMinX = std::max( static_cast<int32>( std::ceil( std::min( { vertex0->x, vertex1->x, vertex2->x } ) - 0.5f ) ), 0 );
+		const auto pixelMinY = std::max( static_cast<int32>( std::ceil( std::min( { vertex0->y, vertex1->y, vertex2->y } ) - 0.5f ) ), 0 );
+		const auto pixelMaxX = std::min( static_cast<int32>( std::floor( std::max( { vertex0->x, vertex1->x, vertex2->x } ) - 0.5f ) ), static_cast<int32>( _width ) - 1 );
+		const auto pixelMaxY = std::min( static_cast<int32>( std::floor( std::max( { vertex0->y, vertex1->y, vertex2->y } ) - 0.5f ) ), static_cast<int32>( _height ) - 1 );
+
+		if( ( pixelMinX > pixelMaxX ) || ( pixelMinY > pixelMaxY ) )
+		{
+			return;
+		}
+
+		// Edge functions: E(x, y) = A * x + B * y + C, positive inside the triangle. Edge N is opposite to vertex N.
+		const float edgeA[3] = { vertex1->y - vertex2->y, vertex2->y - vertex0->y, vertex0->y - vertex1->y };
+		const float edgeB[3] = { vertex2->x - vertex1->x, vertex0->x - vertex2->x, vertex1->x - vertex0->x };
+		const float edgeC[3] =
+		{
+			vertex1->x * vertex2->y - vertex1->y * vertex2->x,
+			vertex2->x * vertex0->y - vertex2->y * vertex0->x,
+			vertex0->x * vertex1->y - vertex0->y * vertex1->x
+		};
+
+		// Depth is affine in screen space, so it can be stepped in the same way as the edge functions.
+		const auto oneOverArea = 1.0f / doubleArea;
+		const auto depthStepX = ( edgeA[0] * vertex0->depth + edgeA[1] * vertex1->depth + edgeA[2] * vertex2->depth ) * oneOverArea;
+
+		const auto startX = static_cast<float>( pixelMinX ) + 0.5f;
+
+		for( auto pixelY = pixelMinY; pixelY <= pixelMaxY; ++pixelY )
+		{
+			const auto sampleY = static_cast<float>( pixelY ) + 0.5f;
+
+			float edgeValues[3];
+			for( uint32 edgeIndex = 0; edgeIndex < 3; ++edgeIndex )
+			{
+				edgeValues[edgeIndex] = edgeA[edgeIndex] * startX + edgeB[edgeIndex] * sampleY + edgeC[edgeIndex];
+			}
+
+			auto depthValue = ( edgeValues[0] * vertex0->depth + edgeValues[1] * vertex1->depth + edgeValues[2] * vertex2->depth ) * oneOverArea;
+
+			auto * depthRow = _depthBuffer.data() + static_cast<size_t>( pixelY ) * _width;
+
+			for( auto pixelX = pixelMinX; pixelX <= pixelMaxX; ++pixelX )
+			{
+				if( ( edgeValues[0] >= 0.0f ) && ( edgeValues[1] >= 0.0f ) && ( edgeValues[2] >= 0.0f ) )
+				{
+					depthRow[pixelX] = std::min( depthRow[pixelX], depthValue );
+				}
+
+				edgeValues[0] += edgeA[0];
+				edgeValues[1] += edgeA[1];
+				edgeValues[2] += edgeA[2];
+				depthValue += depthStepX;
+			}
+		}
+	}
+
+} // namespace Ic3
@@ -0,0 +1,90 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_OCCLUSION_DEPTH_BUFFER_H__
+#define __IC3_NXMAIN_OCCLUSION_DEPTH_BUFFER_H__
+
+#include "../../Prerequisites.h"
+#include <cxm/bounds.h>
+
+namespace Ic3
+{
+
+	/// @brief Size (in pixels) of the square tiles for which the max depth is stored. Tests of occludees check
+	/// tiles first and look at individual pixels only in tiles which are not entirely in front of the occludee.
+	inline constexpr uint32 kOcclusionDepthBufferTileSize = 8;
+
+	/// @brief Low-resolution depth buffer, rasterized on the CPU, used to reject objects hidden behind occluders.
+	/// Depth is the post-projection z/w, so any projection with depth increasing with the distance can be used
+	/// (both [-1,1] and [0,1] depth ranges are fine). Pixels with no occluder store the max float value.
+	/// Occluders are rasterized at pixel centers, so (as in most CPU occlusion culling schemes) the result
+	/// is not strictly conservative at the sub-pixel level. Occluder geometry, however, must be conservative:
+	/// it has to be fully contained within the rendered object it represents.
+	class IC3_NXMAIN_CLASS OcclusionDepthBuffer
+	{
+	public:
+		OcclusionDepthBuffer();
+		~OcclusionDepthBuffer();
+
+		/// @brief Sets the buffer resolution. Dimensions are rounded up to multiples of the tile size.
+		void Resize( uint32 pWidth, uint32 pHeight );
+
+		/// @brief Clears the buffer and sets the view-projection matrix used by subsequent rasterization and tests.
+		/// pZeroToOneDepth specifies the clip-space depth range (see cxm::frustum_from_matrix()).
+		void BeginFrame( const cxm::mat4f & pViewProjectionMatrix, bool pZeroToOneDepth = false );
+
+		/// @brief Rasterizes world-space triangles. Triangles crossing the near plane are skipped (which only
+		/// reduces the amount of occlusion, so it is always safe).
+		void RasterizeTriangles( const cxm::vec3f * pVertices, const uint32 * pIndices, size_t pTrianglesNum );
+
+		void RasterizeBox( const cxm::aabbf & pBox );
+
+		/// @brief Computes per-tile max depth. Must be called after all occluders have been rasterized and
+		/// before any IsBoxVisible() call.
+		void EndFrame();
+
+		/// @brief Returns true if any part of the box may be visible. Does not modify the buffer, so
+		/// it can be called from multiple threads at the same time.
+		CPPX_ATTR_NO_DISCARD bool IsBoxVisible( const cxm::aabbf & pBox ) const;
+
+		CPPX_ATTR_NO_DISCARD uint32 GetWidth() const noexcept
+		{
+			return _width;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetHeight() const noexcept
+		{
+			return _height;
+		}
+
+		CPPX_ATTR_NO_DISCARD const float * GetDepthData() const noexcept
+		{
+			return _depthBuffer.data();
+		}
+
+	private:
+		struct ScreenVertex
+		{
+			float x;
+			float y;
+			float depth;
+		};
+
+		bool ProjectVertex( const cxm::vec3f & pVertex, ScreenVertex & pScreenVertex ) const;
+
+		void RasterizeTriangle( const ScreenVertex & pVertex0, const ScreenVertex & pVertex1, const ScreenVertex & pVertex2 );
+
+	private:
+		uint32 _width = 0;
+		uint32 _height = 0;
+		uint32 _tilesNumX = 0;
+		uint32 _tilesNumY = 0;
+		std::vector<float> _depthBuffer;
+		std::vector<float> _tileMaxDepthBuffer;
+		cxm::mat4f _viewProjectionMatrix;
+		bool _zeroToOneDepth = false;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_OCCLUSION_DEPTH_BUFFER_H__
@@ -0,0 +1,355 @@
+
+#include "VisibilityBVH.h"
+#include <algorithm>
+
+namespace Ic3
+{
+
+	// Number of bins used to evaluate SAH split candidates.
+	static constexpr uint32 kVisibilityBVHBinsNum = 12;
+
+	// Beyond this depth, nodes are split at the median, which bounds the depth of degenerate (heavily
+	// unbalanced) SAH trees and, therefore, the size of the traversal stack.
+	static constexpr uint32 kVisibilityBVHSAHDepthMax = 32;
+
+	static constexpr uint32 kVisibilityBVHTraversalStackSize = 96;
+
+	static constexpr uint32 kVisibilityFrustumPlaneMaskAll = ( 1u << cxm::frustumf::planes_num ) - 1;
+
+	struct VisibilityBVH::BuildContext
+	{
+		std::vector<cxm::vec3f> itemMinArray;
+		std::vector<cxm::vec3f> itemMaxArray;
+		std::vector<cxm::vec3f> itemCentroidArray;
+		uint32 leafItemsMaxNum;
+	};
+
+	namespace
+	{
+
+		struct BVHBounds
+		{
+			cxm::vec3f minCorner{ cppx::meta::limits<float>::max_value, cppx::meta::limits<float>::max_value, cppx::meta::limits<float>::max_value };
+			cxm::vec3f maxCorner{ -cppx::meta::limits<float>::max_value, -cppx::meta::limits<float>::max_value, -cppx::meta::limits<float>::max_value };
+
+			void Extend( const cxm::vec3f & pMin, const cxm::vec3f & pMax )
+			{
+				minCorner = cxm::vec3f{ std::min( minCorner.x, pMin.x ), std::min( minCorner.y, pMin.y ), std::min( minCorner.z, pMin.z ) };
+				maxCorner = cxm::vec3f{ std::max( maxCorner.x, pMax.x ), std::max( maxCorner.y, pMax.y ), std::max( maxCorner.z, pMax.z ) };
+			}
+
+			CPPX_ATTR_NO_DISCARD float HalfSurfaceArea() const
+			{
+				const auto size = maxCorner - minCorner;
+				return ( size.x * size.y ) + ( size.y * size.z ) + ( size.z * size.x );
+			}
+		};
+
+	}
+
+	VisibilityBVH::VisibilityBVH() = default;
+
+	VisibilityBVH::~VisibilityBVH() = default;
+
+	void VisibilityBVH::Build( cxm::aabb_soa<const float> pItems, size_t pItemsNum, uint32 pLeafItemsMaxNum )
+	{
+		Clear();
+
+		if( pItemsNum == 0 )
+		{
+			return;
+		}
+
+		BuildContext buildContext;
+		buildContext.itemMinArray.resize( pItemsNum );
+		buildContext.itemMaxArray.resize( pItemsNum );
+		buildContext.itemCentroidArray.resize( pItemsNum );
+		buildContext.leafItemsMaxNum = std::max<uint32>( pLeafItemsMaxNum, 1 );
+
+		for( size_t itemIndex = 0; itemIndex < pItemsNum; ++itemIndex )
+		{
+			const cxm::vec3f center{ pItems.center.x[itemIndex], pItems.center.y[itemIndex], pItems.center.z[itemIndex] };
+			const cxm::vec3f extents{ pItems.extents.x[itemIndex], pItems.extents.y[itemIndex], pItems.extents.z[itemIndex] };
+			buildContext.itemMinArray[itemIndex] = center - extents;
+			buildContext.itemMaxArray[itemIndex] = center + extents;
+			buildContext.itemCentroidArray[itemIndex] = center;
+		}
+
+		_itemOrder.resize( pItemsNum );
+		for( uint32 itemIndex = 0; itemIndex < pItemsNum; ++itemIndex )
+		{
+			_itemOrder[itemIndex] = itemIndex;
+		}
+
+		// Only a hint: SAH splits usually produce leaves which are at least half full.
+		_nodeArray.reserve( 4 * ( pItemsNum / buildContext.leafItemsMaxNum ) + 1 );
+		_nodeArray.emplace_back();
+
+		BuildNode( buildContext, 0, 0, static_cast<uint32>( pItemsNum ), 0 );
+	}
+
+	void VisibilityBVH::Refit( cxm::aabb_soa<const float> pOrderedItems )
+	{
+		// Children are always allocated after their parent, so a reverse pass visits them first.
+		for( auto nodeIndex = _nodeArray.size(); nodeIndex-- > 0; )
+		{
+			auto & node = _nodeArray[nodeIndex];
+
+			BVHBounds nodeBounds;
+
+			if( node.leftChildIndex == 0 )
+			{
+				for( auto itemIndex = node.firstItemIndex; itemIndex < node.firstItemIndex + node.itemsNum; ++itemIndex )
+				{
+					const cxm::vec3f center{ pOrderedItems.center.x[itemIndex], pOrderedItems.center.y[itemIndex], pOrderedItems.center.z[itemIndex] };
+					const cxm::vec3f extents{ pOrderedItems.extents.x[itemIndex], pOrderedItems.extents.y[itemIndex], pOrderedItems.extents.z[itemIndex] };
+					nodeBounds.Extend( center - extents, center + extents );
+				}
+			}
+			else
+			{
+				const auto & leftChild = _nodeArray[node.leftChildIndex];
+				const auto & rightChild = _nodeArray[node.leftChildIndex + 1];
+				nodeBounds.Extend( leftChild.boundsMin, leftChild.boundsMax );
+				nodeBounds.Extend( rightChild.boundsMin, rightChild.boundsMax );
+			}
+
+			node.boundsMin = nodeBounds.minCorner;
+			node.boundsMax = nodeBounds.maxCorner;
+		}
+	}
+
+	void VisibilityBVH::CullFrustum( const cxm::frustumf & pFrustum, std::vector<VisibilityBVHItemRange> & pRanges ) const
+	{
+		if( _nodeArray.empty() )
+		{
+			return;
+		}
+
+		struct StackEntry
+		{
+			uint32 nodeIndex;
+			uint32 planeMask;
+		};
+
+		StackEntry traversalStack[kVisibilityBVHTraversalStackSize];
+		uint32 stackSize = 0;
+
+		traversalStack[stackSize++] = { 0, kVisibilityFrustumPlaneMaskAll };
+
+		const auto appendRange = [&pRanges]( uint32 pFirstItemIndex, uint32 pItemsNum, bool pFullyInside ) -> void {
+			if( !pRanges.empty() )
+			{
+				auto & lastRange = pRanges.back();
+				if( ( lastRange.fullyInside == pFullyInside ) && ( lastRange.firstItemIndex + lastRange.itemsNum == pFirstItemIndex ) )
+				{
+					lastRange.itemsNum += pItemsNum;
+					return;
+				}
+			}
+			pRanges.push_back( { pFirstItemIndex, pItemsNum, pFullyInside } );
+		};
+
+		while( stackSize > 0 )
+		{
+			const auto stackEntry = traversalStack[--stackSize];
+			const auto & node = _nodeArray[stackEntry.nodeIndex];
+
+			const auto nodeCenter = ( node.boundsMin + node.boundsMax ) * 0.5f;
+			const auto nodeExtents = ( node.boundsMax - node.boundsMin ) * 0.5f;
+
+			// Planes which fully contain the parent also contain its children, so they are not tested again.
+			auto planeMask = stackEntry.planeMask;
+			bool nodeOutside = false;
+
+			for( uint32 planeIndex = 0; planeIndex < cxm::frustumf::planes_num; ++planeIndex )
+			{
+				const auto planeBit = 1u << planeIndex;
+				if( ( planeMask & planeBit ) == 0 )
+				{
+					continue;
+				}
+
+				const auto & frustumPlane = pFrustum.planes[planeIndex];
+				const auto projectedRadius =
+					nodeExtents.x * std::abs( frustumPlane.normal.x ) +
+					nodeExtents.y * std::abs( frustumPlane.normal.y ) +
+					nodeExtents.z * std::abs( frustumPlane.normal.z );
+				const auto centerDistance = frustumPlane.signed_distance( nodeCenter );
+
+				if( centerDistance + projectedRadius < 0.0f )
+				{
+					nodeOutside = true;
+					break;
+				}
+
+				if( centerDistance - projectedRadius >= 0.0f )
+				{
+					planeMask &= ~planeBit;
+				}
+			}
+
+			if( nodeOutside )
+			{
+				continue;
+			}
+
+			if( planeMask == 0 )
+			{
+				appendRange( node.firstItemIndex, node.itemsNum, true );
+			}
+			else if( node.leftChildIndex == 0 )
+			{
+				appendRange( node.firstItemIndex, node.itemsNum, false );
+			}
+			else
+			{
+				Ic3DebugAssert( stackSize + 2 <= kVisibilityBVHTraversalStackSize );
+
+				// Right child is pushed first, so items are visited (and ranges appended) in their storage order.
+				traversalStack[stackSize++] = { node.leftChildIndex + 1, planeMask };
+				traversalStack[stackSize++] = { node.leftChildIndex, planeMask };
+			}
+		}
+	}
+
+	void VisibilityBVH::Clear()
+	{
+		_nodeArray.clear();
+		_itemOrder.clear();
+	}
+
+	void VisibilityBVH::BuildNode( BuildContext & pContext, uint32 pNodeIndex, uint32 pFirstItemIndex, uint32 pItemsNum, uint32 pDepth )
+	{
+		BVHBounds nodeBounds;
+		BVHBounds centroidBounds;
+
+		for( auto itemIndex = pFirstItemIndex; itemIndex < pFirstItemIndex + pItemsNum; ++itemIndex )
+		{
+			const auto sourceIndex = _itemOrder[itemIndex];
+			nodeBounds.Extend( pContext.itemMinArray[sourceIndex], pContext.itemMaxArray[sourceIndex] );
+			centroidBounds.Extend( pContext.itemCentroidArray[sourceIndex], pContext.itemCentroidArray[sourceIndex] );
+		}
+
+		{
+			auto & node = _nodeArray[pNodeIndex];
+			node.boundsMin = nodeBounds.minCorner;
+			node.boundsMax = nodeBounds.maxCorner;
+			node.firstItemIndex = pFirstItemIndex;
+			node.itemsNum = pItemsNum;
+			node.leftChildIndex = 0;
+		}
+
+		if( pItemsNum <= pContext.leafItemsMaxNum )
+		{
+			return;
+		}
+
+		const auto centroidExtents = centroidBounds.maxCorner - centroidBounds.minCorner;
+
+		uint32 splitAxis = 0;
+		if( centroidExtents.y > centroidExtents[splitAxis] )
+		{
+			splitAxis = 1;
+		}
+		if( centroidExtents.z > centroidExtents[splitAxis] )
+		{
+			splitAxis = 2;
+		}
+
+		const auto axisMin = centroidBounds.minCorner[splitAxis];
+		const auto axisExtent = centroidExtents[splitAxis];
+
+		auto * const itemRangeBegin = _itemOrder.data() + pFirstItemIndex;
+		auto * const itemRangeEnd = itemRangeBegin + pItemsNum;
+
+		uint32 leftItemsNum = 0;
+
+		if( ( axisExtent > 0.0f ) && ( pDepth < kVisibilityBVHSAHDepthMax ) )
+		{
+			const auto binScale = static_cast<float>( kVisibilityBVHBinsNum ) / axisExtent;
+			const auto getItemBin = [&]( uint32 pSourceIndex ) -> uint32 {
+				const auto binIndex = static_cast<uint32>( ( pContext.itemCentroidArray[pSourceIndex][splitAxis] - axisMin ) * binScale );
+				return std::min( binIndex, kVisibilityBVHBinsNum - 1 );
+			};
+
+			BVHBounds binBoundsArray[kVisibilityBVHBinsNum];
+			uint32 binItemsNumArray[kVisibilityBVHBinsNum] = {};
+
+			for( auto * itemPtr = itemRangeBegin; itemPtr != itemRangeEnd; ++itemPtr )
+			{
+				const auto binIndex = getItemBin( *itemPtr );
+				binBoundsArray[binIndex].Extend( pContext.itemMinArray[*itemPtr], pContext.itemMaxArray[*itemPtr] );
+				binItemsNumArray[binIndex] += 1;
+			}
+
+			// Cost of the right side of each split plane, accumulated from the last bin.
+			float rightCostArray[kVisibilityBVHBinsNum];
+			{
+				BVHBounds rightBounds;
+				uint32 rightItemsNum = 0;
+				for( auto binIndex = kVisibilityBVHBinsNum - 1; binIndex > 0; --binIndex )
+				{
+					rightBounds.Extend( binBoundsArray[binIndex].minCorner, binBoundsArray[binIndex].maxCorner );
+					rightItemsNum += binItemsNumArray[binIndex];
+					rightCostArray[binIndex] = ( rightItemsNum > 0 ) ? ( rightBounds.HalfSurfaceArea() * rightItemsNum ) : 0.0f;
+				}
+			}
+
+			uint32 bestSplitBin = kVisibilityBVHBinsNum;
+			auto bestSplitCost = cppx::meta::limits<float>::max_value;
+
+			BVHBounds leftBounds;
+			uint32 leftBinItemsNum = 0;
+			for( uint32 binIndex = 0; binIndex + 1 < kVisibilityBVHBinsNum; ++binIndex )
+			{
+				leftBounds.Extend( binBoundsArray[binIndex].minCorner, binBoundsArray[binIndex].maxCorner );
+				leftBinItemsNum += binItemsNumArray[binIndex];
+
+				if( ( leftBinItemsNum == 0 ) || ( leftBinItemsNum == pItemsNum ) )
+				{
+					continue;
+				}
+
+				const auto splitCost = leftBounds.HalfSurfaceArea() * leftBinItemsNum + rightCostArray[binIndex + 1];
+				if( splitCost < bestSplitCost )
+				{
+					bestSplitCost = splitCost;
+					bestSplitBin = binIndex;
+				}
+			}
+
+			if( bestSplitBin < kVisibilityBVHBinsNum )
+			{
+				auto * const splitPtr = std::partition(
+						itemRangeBegin,
+						itemRangeEnd,
+						[&]( uint32 pSourceIndex ) -> bool { return getItemBin( pSourceIndex ) <= bestSplitBin; } );
+
+				leftItemsNum = static_cast<uint32>( splitPtr - itemRangeBegin );
+			}
+		}
+
+		if( ( leftItemsNum == 0 ) || ( leftItemsNum == pItemsNum ) )
+		{
+			// All centroids in one bin (or too deep in the tree) - split at the median.
+			leftItemsNum = pItemsNum / 2;
+			std::nth_element(
+					itemRangeBegin,
+					itemRangeBegin + leftItemsNum,
+					itemRangeEnd,
+					[&]( uint32 pFirst, uint32 pSecond ) -> bool {
+						return pContext.itemCentroidArray[pFirst][splitAxis] < pContext.itemCentroidArray[pSecond][splitAxis];
+					} );
+		}
+
+		const auto leftChildIndex = static_cast<uint32>( _nodeArray.size() );
+		_nodeArray.emplace_back();
+		_nodeArray.emplace_back();
+		_nodeArray[pNodeIndex].leftChildIndex = leftChildIndex;
+
+		BuildNode( pContext, leftChildIndex, pFirstItemIndex, leftItemsNum, pDepth + 1 );
+		BuildNode( pContext, leftChildIndex + 1, pFirstItemIndex + leftItemsNum, pItemsNum - leftItemsNum, pDepth + 1 );
+	}
+
+} // namespace Ic3
@@ -0,0 +1,92 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_VISIBILITY_BVH_H__
+#define __IC3_NXMAIN_VISIBILITY_BVH_H__
+
+#include "../../Prerequisites.h"
+#include <cxm/batchOps.h>
+
+namespace Ic3
+{
+
+	/// @brief Default max number of items stored in a single leaf. Partially visible leaves are tested with the
+	/// batch (SoA) culling kernels, so leaves are kept relatively large.
+	inline constexpr uint32 kVisibilityBVHLeafItemsMaxNum = 16;
+
+	struct VisibilityBVHNode
+	{
+		cxm::vec3f boundsMin;
+
+		/// Index of the first item covered by the node. Items of every subtree form a contiguous range.
+		uint32 firstItemIndex;
+
+		cxm::vec3f boundsMax;
+
+		/// Number of items covered by the node. For inner nodes, this is the number of items in the whole subtree.
+		uint32 itemsNum;
+
+		/// Index of the left child. The right one is always located right after it. Zero for leaf nodes.
+		uint32 leftChildIndex;
+	};
+
+	/// @brief A contiguous range of items produced by a hierarchy query.
+	struct VisibilityBVHItemRange
+	{
+		uint32 firstItemIndex;
+		uint32 itemsNum;
+
+		/// True if the whole range is inside the query volume, false if items have to be tested individually.
+		bool fullyInside;
+	};
+
+	/// @brief Bounding volume hierarchy built over AABBs using a binned SAH. The build reorders items, so
+	/// each subtree covers a contiguous range of them: a fully visible subtree yields a single range and
+	/// per-item data stored in that order can be processed with batch kernels.
+	class IC3_NXMAIN_CLASS VisibilityBVH
+	{
+	public:
+		VisibilityBVH();
+		~VisibilityBVH();
+
+		/// @brief Builds the hierarchy. After that, GetItemOrder()[N] is the index (in pItems) of the N-th item.
+		void Build( cxm::aabb_soa<const float> pItems, size_t pItemsNum, uint32 pLeafItemsMaxNum = kVisibilityBVHLeafItemsMaxNum );
+
+		/// @brief Recomputes bounds of all nodes, keeping the topology. Items must be stored in the hierarchy order.
+		/// Much cheaper than Build(), but the quality of the tree degrades if items move far from their original location.
+		void Refit( cxm::aabb_soa<const float> pOrderedItems );
+
+		/// @brief Appends ranges of items (in the hierarchy order) which intersect the frustum. Adjacent ranges
+		/// with the same classification are merged.
+		void CullFrustum( const cxm::frustumf & pFrustum, std::vector<VisibilityBVHItemRange> & pRanges ) const;
+
+		void Clear();
+
+		CPPX_ATTR_NO_DISCARD const std::vector<uint32> & GetItemOrder() const noexcept
+		{
+			return _itemOrder;
+		}
+
+		CPPX_ATTR_NO_DISCARD const std::vector<VisibilityBVHNode> & GetNodeArray() const noexcept
+		{
+			return _nodeArray;
+		}
+
+		CPPX_ATTR_NO_DISCARD bool IsEmpty() const noexcept
+		{
+			return _nodeArray.empty();
+		}
+
+	private:
+		struct BuildContext;
+
+		void BuildNode( BuildContext & pContext, uint32 pNodeIndex, uint32 pFirstItemIndex, uint32 pItemsNum, uint32 pDepth );
+
+	private:
+		std::vector<VisibilityBVHNode> _nodeArray;
+		std::vector<uint32> _itemOrder;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_VISIBILITY_BVH_H__
@@ -0,0 +1,395 @@
+
+#include "VisibilitySystem.h"
+#include "../../Camera/CameraController.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+#include <cppx/bitUtils.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Ic3
+{
+
+	// Number of objects tested against the occlusion buffer by a single work item.
+	static constexpr size_t kVisibilityOcclusionTestGrainSize = 512;
+
+	VisibilityViewDesc MakeVisibilityViewDesc(
+			const CameraController & pCameraController,
+			float pAspectRatio,
+			float pZNear,
+			float pZFar )
+	{
+		const auto & cameraOrientation = pCameraController.mCameraState.orientation;
+
+		const auto viewMatrix = cxm::look_at_LH( cameraOrientation.origin, cameraOrientation.target, cameraOrientation.vUp );
+		const auto projectionMatrix = cxm::perspective_aspect_LH( pCameraController.GetPerspectiveFOVAngle(), pAspectRatio, pZNear, pZFar );
+
+		return MakeVisibilityViewDesc( viewMatrix, projectionMatrix, false );
+	}
+
+	VisibilityViewDesc MakeVisibilityViewDesc(
+			const cxm::mat4f & pViewMatrix,
+			const cxm::mat4f & pProjectionMatrix,
+			bool pZeroToOneDepth )
+	{
+		const auto & row0 = pViewMatrix[0];
+		const auto & row1 = pViewMatrix[1];
+		const auto & row2 = pViewMatrix[2];
+
+		VisibilityViewDesc viewDesc;
+		viewDesc.mViewProjection = cxm::mul( pProjectionMatrix, pViewMatrix );
+		viewDesc.frustum = cxm::frustum_from_matrix( viewDesc.mViewProjection, pZeroToOneDepth );
+		// Rows of the rotation part are the view axes, so the origin is: -transpose( R ) * t.
+		viewDesc.origin = cxm::vec3f{
+			-( row0.x * row0.w + row1.x * row1.w + row2.x * row2.w ),
+			-( row0.y * row0.w + row1.y * row1.w + row2.y * row2.w ),
+			-( row0.z * row0.w + row1.z * row1.w + row2.z * row2.w ) };
+		viewDesc.vForward = cxm::vec3f{ row2.x, row2.y, row2.z };
+		viewDesc.zeroToOneDepth = pZeroToOneDepth;
+
+		return viewDesc;
+	}
+
+	VisibilitySystem::VisibilitySystem( uint32 pOcclusionBufferWidth, uint32 pOcclusionBufferHeight )
+	{
+		_occlusionBuffer.Resize( pOcclusionBufferWidth, pOcclusionBufferHeight );
+	}
+
+	VisibilitySystem::~VisibilitySystem() = default;
+
+	visibility_object_handle_t VisibilitySystem::AddObject( const VisibilityObjectDesc & pObjectDesc )
+	{
+		visibility_object_handle_t objectHandle = kVisibilityObjectHandleInvalid;
+
+		if( !_freeSlotList.empty() )
+		{
+			objectHandle = _freeSlotList.back();
+			_freeSlotList.pop_back();
+		}
+		else
+		{
+			objectHandle = static_cast<visibility_object_handle_t>( _objectSlotArray.size() );
+			_objectSlotArray.emplace_back();
+		}
+
+		auto & objectSlot = _objectSlotArray[objectHandle];
+		objectSlot.bounds = pObjectDesc.bounds;
+		objectSlot.occluderVolume = pObjectDesc.occluderVolume;
+		objectSlot.userTag = pObjectDesc.userTag;
+		objectSlot.itemIndex = 0;
+		objectSlot.isOccluder = pObjectDesc.isOccluder;
+		objectSlot.isActive = true;
+
+		++_activeObjectsNum;
+		_hierarchyRebuildRequired = true;
+
+		return objectHandle;
+	}
+
+	void VisibilitySystem::RemoveObject( visibility_object_handle_t pObjectHandle )
+	{
+		Ic3DebugAssert( ( pObjectHandle < _objectSlotArray.size() ) && _objectSlotArray[pObjectHandle].isActive );
+
+		_objectSlotArray[pObjectHandle].isActive = false;
+		_freeSlotList.push_back( pObjectHandle );
+
+		--_activeObjectsNum;
+		_hierarchyRebuildRequired = true;
+	}
+
+	void VisibilitySystem::UpdateObjectBounds( visibility_object_handle_t pObjectHandle, const cxm::aabbf & pBounds )
+	{
+		Ic3DebugAssert( ( pObjectHandle < _objectSlotArray.size() ) && _objectSlotArray[pObjectHandle].isActive );
+
+		auto & objectSlot = _objectSlotArray[pObjectHandle];
+
+		if( objectSlot.isOccluder )
+		{
+			const auto centerOffset = pBounds.center() - objectSlot.bounds.center();
+			objectSlot.occluderVolume.min_corner += centerOffset;
+			objectSlot.occluderVolume.max_corner += centerOffset;
+		}
+
+		objectSlot.bounds = pBounds;
+
+		if( !_hierarchyRebuildRequired )
+		{
+			SetItemBounds( objectSlot.itemIndex, pBounds );
+			_hierarchyRefitRequired = true;
+		}
+	}
+
+	void VisibilitySystem::InvalidateHierarchy()
+	{
+		_hierarchyRebuildRequired = true;
+	}
+
+	void VisibilitySystem::Cull(
+			const VisibilityViewDesc & pViewDesc,
+			const VisibilityCullingConfig & pCullingConfig,
+			VisibilityDrawList & pDrawList,
+			WorkerThreadPool * pThreadPool )
+	{
+		if( _hierarchyRebuildRequired )
+		{
+			RebuildHierarchy();
+		}
+		else if( _hierarchyRefitRequired )
+		{
+			RefitHierarchy();
+		}
+
+		pDrawList.objectArray.clear();
+		pDrawList.stats = {};
+		pDrawList.stats.objectsNum = _activeObjectsNum;
+
+		CollectFrustumCandidates( pViewDesc );
+
+		pDrawList.stats.frustumVisibleObjectsNum = static_cast<uint32>( _candidateItemArray.size() );
+
+		if( pCullingConfig.enableOcclusionCulling && !_candidateItemArray.empty() )
+		{
+			ApplyOcclusionCulling( pViewDesc, pCullingConfig, pDrawList.stats, pThreadPool );
+		}
+
+		const auto itemBounds = GetItemBoundsSoA();
+
+		pDrawList.objectArray.reserve( _candidateItemArray.size() );
+
+		for( const auto itemIndex : _candidateItemArray )
+		{
+			const auto objectHandle = _itemObjectHandleArray[itemIndex];
+			const cxm::vec3f itemCenter{ itemBounds.center.x[itemIndex], itemBounds.center.y[itemIndex], itemBounds.center.z[itemIndex] };
+
+			VisibleObject visibleObject;
+			visibleObject.objectHandle = objectHandle;
+			visibleObject.userTag = _objectSlotArray[objectHandle].userTag;
+			visibleObject.viewDepth = cxm::dot( itemCenter - pViewDesc.origin, pViewDesc.vForward );
+			pDrawList.objectArray.push_back( visibleObject );
+		}
+
+		pDrawList.stats.visibleObjectsNum = static_cast<uint32>( pDrawList.objectArray.size() );
+	}
+
+	void VisibilitySystem::RebuildHierarchy()
+	{
+		_itemObjectHandleArray.clear();
+		_itemObjectHandleArray.reserve( _activeObjectsNum );
+
+		for( visibility_object_handle_t objectHandle = 0; objectHandle < _objectSlotArray.size(); ++objectHandle )
+		{
+			if( _objectSlotArray[objectHandle].isActive )
+			{
+				_itemObjectHandleArray.push_back( objectHandle );
+			}
+		}
+
+		// Build from the bounds in the slot order, then store them (and the handles) in the hierarchy order.
+		_itemBoundsData.resize( _itemObjectHandleArray.size() * 6 );
+		for( uint32 itemIndex = 0; itemIndex < _itemObjectHandleArray.size(); ++itemIndex )
+		{
+			SetItemBounds( itemIndex, _objectSlotArray[_itemObjectHandleArray[itemIndex]].bounds );
+		}
+
+		_bvh.Build( GetItemBoundsSoA(), _itemObjectHandleArray.size() );
+
+		const auto & itemOrder = _bvh.GetItemOrder();
+		std::vector<visibility_object_handle_t> unorderedHandleArray;
+		unorderedHandleArray.swap( _itemObjectHandleArray );
+
+		_itemObjectHandleArray.resize( unorderedHandleArray.size() );
+		for( uint32 itemIndex = 0; itemIndex < unorderedHandleArray.size(); ++itemIndex )
+		{
+			const auto objectHandle = unorderedHandleArray[itemOrder[itemIndex]];
+			_itemObjectHandleArray[itemIndex] = objectHandle;
+			_objectSlotArray[objectHandle].itemIndex = itemIndex;
+			SetItemBounds( itemIndex, _objectSlotArray[objectHandle].bounds );
+		}
+
+		_hierarchyRebuildRequired = false;
+		_hierarchyRefitRequired = false;
+	}
+
+	void VisibilitySystem::RefitHierarchy()
+	{
+		_bvh.Refit( GetItemBoundsSoA() );
+		_hierarchyRefitRequired = false;
+	}
+
+	void VisibilitySystem::CollectFrustumCandidates( const VisibilityViewDesc & pViewDesc )
+	{
+		_itemRangeBuffer.clear();
+		_candidateItemArray.clear();
+
+		_bvh.CullFrustum( pViewDesc.frustum, _itemRangeBuffer );
+
+		const auto itemBounds = GetItemBoundsSoA();
+
+		for( const auto & itemRange : _itemRangeBuffer )
+		{
+			if( itemRange.fullyInside )
+			{
+				for( auto itemIndex = itemRange.firstItemIndex; itemIndex < itemRange.firstItemIndex + itemRange.itemsNum; ++itemIndex )
+				{
+					_candidateItemArray.push_back( itemIndex );
+				}
+				continue;
+			}
+
+			const auto maskWordsNum = cxm::visibility_mask_words_num( itemRange.itemsNum );
+			if( _visibilityMaskBuffer.size() < maskWordsNum )
+			{
+				_visibilityMaskBuffer.resize( maskWordsNum );
+			}
+
+			cxm::frustum_cull_aabbs_soa( pViewDesc.frustum, itemBounds.offset( itemRange.firstItemIndex ), itemRange.itemsNum, _visibilityMaskBuffer.data() );
+
+			for( uint32 wordIndex = 0; wordIndex < maskWordsNum; ++wordIndex )
+			{
+				auto maskWord = _visibilityMaskBuffer[wordIndex];
+				while( maskWord != 0 )
+				{
+					const auto bitIndex = cppx::bit_scan_lsb( maskWord );
+					_candidateItemArray.push_back( itemRange.firstItemIndex + wordIndex * 32 + bitIndex );
+					maskWord &= maskWord - 1;
+				}
+			}
+		}
+	}
+
+	void VisibilitySystem::ApplyOcclusionCulling(
+			const VisibilityViewDesc & pViewDesc,
+			const VisibilityCullingConfig & pCullingConfig,
+			VisibilityStats & pStats,
+			WorkerThreadPool * pThreadPool )
+	{
+		struct OccluderCandidate
+		{
+			float angularSize;
+			visibility_object_handle_t objectHandle;
+		};
+
+		std::vector<OccluderCandidate> occluderCandidateArray;
+
+		for( const auto itemIndex : _candidateItemArray )
+		{
+			const auto objectHandle = _itemObjectHandleArray[itemIndex];
+			const auto & objectSlot = _objectSlotArray[objectHandle];
+			if( !objectSlot.isOccluder )
+			{
+				continue;
+			}
+
+			const auto occluderExtents = objectSlot.occluderVolume.extents();
+			const auto occluderRadius = cxm::length( occluderExtents );
+			const auto occluderDistance = cxm::dot( objectSlot.occluderVolume.center() - pViewDesc.origin, pViewDesc.vForward );
+			const auto occluderProjectedExtent =
+					occluderExtents.x * std::fabs( pViewDesc.vForward.x ) +
+					occluderExtents.y * std::fabs( pViewDesc.vForward.y ) +
+					occluderExtents.z * std::fabs( pViewDesc.vForward.z );
+
+			// Occluders reaching behind the view origin would have most of their faces skipped by the rasterizer.
+			if( occluderDistance <= occluderProjectedExtent )
+			{
+				continue;
+			}
+
+			const auto angularSize = occluderRadius / occluderDistance;
+			if( angularSize >= pCullingConfig.occluderMinAngularSize )
+			{
+				occluderCandidateArray.push_back( { angularSize, objectHandle } );
+			}
+		}
+
+		if( occluderCandidateArray.empty() )
+		{
+			return;
+		}
+
+		if( occluderCandidateArray.size() > pCullingConfig.occludersMaxNum )
+		{
+			std::nth_element(
+					occluderCandidateArray.begin(),
+					occluderCandidateArray.begin() + pCullingConfig.occludersMaxNum,
+					occluderCandidateArray.end(),
+					[]( const OccluderCandidate & pFirst, const OccluderCandidate & pSecond ) -> bool {
+						return pFirst.angularSize > pSecond.angularSize;
+					} );
+			occluderCandidateArray.resize( pCullingConfig.occludersMaxNum );
+		}
+
+		_occlusionBuffer.BeginFrame( pViewDesc.mViewProjection, pViewDesc.zeroToOneDepth );
+
+		for( const auto & occluderCandidate : occluderCandidateArray )
+		{
+			_occlusionBuffer.RasterizeBox( _objectSlotArray[occluderCandidate.objectHandle].occluderVolume );
+		}
+
+		_occlusionBuffer.EndFrame();
+
+		pStats.occludersRasterizedNum = static_cast<uint32>( occluderCandidateArray.size() );
+
+		const auto itemBounds = GetItemBoundsSoA();
+		const auto candidatesNum = _candidateItemArray.size();
+
+		_occlusionResultBuffer.resize( candidatesNum );
+
+		const auto testCandidateRange = [&]( size_t pBeginIndex, size_t pEndIndex ) -> void {
+			for( auto candidateIndex = pBeginIndex; candidateIndex < pEndIndex; ++candidateIndex )
+			{
+				const auto itemIndex = _candidateItemArray[candidateIndex];
+				const cxm::vec3f center{ itemBounds.center.x[itemIndex], itemBounds.center.y[itemIndex], itemBounds.center.z[itemIndex] };
+				const cxm::vec3f extents{ itemBounds.extents.x[itemIndex], itemBounds.extents.y[itemIndex], itemBounds.extents.z[itemIndex] };
+
+				_occlusionResultBuffer[candidateIndex] = _occlusionBuffer.IsBoxVisible( cxm::aabbf{ center - extents, center + extents } ) ? 1 : 0;
+			}
+		};
+
+		if( pThreadPool )
+		{
+			pThreadPool->ParallelFor( candidatesNum, kVisibilityOcclusionTestGrainSize, testCandidateRange );
+		}
+		else
+		{
+			testCandidateRange( 0, candidatesNum );
+		}
+
+		size_t visibleCandidatesNum = 0;
+		for( size_t candidateIndex = 0; candidateIndex < candidatesNum; ++candidateIndex )
+		{
+			if( _occlusionResultBuffer[candidateIndex] != 0 )
+			{
+				_candidateItemArray[visibleCandidatesNum++] = _candidateItemArray[candidateIndex];
+			}
+		}
+
+		pStats.occlusionCulledObjectsNum = static_cast<uint32>( candidatesNum - visibleCandidatesNum );
+
+		_candidateItemArray.resize( visibleCandidatesNum );
+	}
+
+	void VisibilitySystem::SetItemBounds( uint32 pItemIndex, const cxm::aabbf & pBounds )
+	{
+		const auto itemsNum = _itemObjectHandleArray.size();
+		const auto center = pBounds.center();
+		const auto extents = pBounds.extents();
+
+		auto * const boundsData = _itemBoundsData.data();
+		boundsData[0 * itemsNum + pItemIndex] = center.x;
+		boundsData[1 * itemsNum + pItemIndex] = center.y;
+		boundsData[2 * itemsNum + pItemIndex] = center.z;
+		boundsData[3 * itemsNum + pItemIndex] = extents.x;
+		boundsData[4 * itemsNum + pItemIndex] = extents.y;
+		boundsData[5 * itemsNum + pItemIndex] = extents.z;
+	}
+
+	cxm::aabb_soa<const float> VisibilitySystem::GetItemBoundsSoA() const noexcept
+	{
+		const auto itemsNum = _itemObjectHandleArray.size();
+		const auto * const boundsData = _itemBoundsData.data();
+
+		return cxm::aabb_soa<const float>{
+			{ boundsData + 0 * itemsNum, boundsData + 1 * itemsNum, boundsData + 2 * itemsNum },
+			{ boundsData + 3 * itemsNum, boundsData + 4 * itemsNum, boundsData + 5 * itemsNum } };
+	}
+
+} // namespace Ic3
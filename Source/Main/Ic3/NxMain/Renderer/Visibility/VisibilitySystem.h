@@ -0,0 +1,177 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_VISIBILITY_SYSTEM_H__
+#define __IC3_NXMAIN_VISIBILITY_SYSTEM_H__
+
+#include "VisibilityBVH.h"
+#include "OcclusionDepthBuffer.h"
+
+namespace Ic3
+{
+
+	class CameraController;
+	class WorkerThreadPool;
+
+	using visibility_object_handle_t = uint32;
+
+	inline constexpr visibility_object_handle_t kVisibilityObjectHandleInvalid = cppx::meta::limits<uint32>::max_value;
+
+	struct VisibilityObjectDesc
+	{
+		/// World-space bounds of the object.
+		cxm::aabbf bounds;
+
+		/// Value copied to the draw list, used by the renderer to identify what to draw (e.g. a draw packet index).
+		uint32 userTag = 0;
+
+		/// If true, occluderVolume is rasterized into the occlusion buffer when the object is selected as an occluder.
+		bool isOccluder = false;
+
+		/// Conservative occluder geometry: it must be fully contained within the rendered object.
+		cxm::aabbf occluderVolume;
+	};
+
+	struct VisibilityViewDesc
+	{
+		cxm::mat4f mViewProjection;
+		cxm::frustumf frustum;
+		cxm::vec3f origin;
+		cxm::vec3f vForward;
+		bool zeroToOneDepth;
+	};
+
+	struct VisibilityCullingConfig
+	{
+		bool enableOcclusionCulling = false;
+
+		/// Max number of occluders rasterized per frame. The ones covering the largest part of the view are used.
+		uint32 occludersMaxNum = 64;
+
+		/// Occluders with a smaller angular size (bounding radius divided by the view distance) are ignored.
+		float occluderMinAngularSize = 0.05f;
+	};
+
+	struct VisibleObject
+	{
+		visibility_object_handle_t objectHandle;
+		uint32 userTag;
+
+		/// Distance from the view origin to the object center, along the view direction. Can be used for sorting.
+		float viewDepth;
+	};
+
+	struct VisibilityStats
+	{
+		uint32 objectsNum = 0;
+		uint32 frustumVisibleObjectsNum = 0;
+		uint32 occludersRasterizedNum = 0;
+		uint32 occlusionCulledObjectsNum = 0;
+		uint32 visibleObjectsNum = 0;
+	};
+
+	/// @brief Compact list of visible objects, produced by VisibilitySystem::Cull().
+	struct VisibilityDrawList
+	{
+		std::vector<VisibleObject> objectArray;
+		VisibilityStats stats;
+	};
+
+	/// @brief Builds the view description for the camera, using the same LH matrices the camera produces for rendering.
+	IC3_NXMAIN_API_NO_DISCARD VisibilityViewDesc MakeVisibilityViewDesc(
+			const CameraController & pCameraController,
+			float pAspectRatio,
+			float pZNear,
+			float pZFar );
+
+	/// @brief Builds the view description from explicit matrices. The view matrix must be a LH one (e.g. cxm::look_at_LH()).
+	IC3_NXMAIN_API_NO_DISCARD VisibilityViewDesc MakeVisibilityViewDesc(
+			const cxm::mat4f & pViewMatrix,
+			const cxm::mat4f & pProjectionMatrix,
+			bool pZeroToOneDepth );
+
+	/// @brief Determines which scene objects are visible from a given view. Objects are stored in a BVH, with their
+	/// bounds kept in the hierarchy order, as SoA arrays: fully visible subtrees are accepted as whole ranges and
+	/// partially visible leaves are tested with batch frustum culling. Optionally, remaining objects are tested against
+	/// a CPU-rasterized depth buffer of the largest occluders in view.
+	/// Adding/removing objects triggers a rebuild of the hierarchy on the next Cull(), moving them - only a refit.
+	class IC3_NXMAIN_CLASS VisibilitySystem
+	{
+	public:
+		explicit VisibilitySystem( uint32 pOcclusionBufferWidth = 256, uint32 pOcclusionBufferHeight = 128 );
+		~VisibilitySystem();
+
+		visibility_object_handle_t AddObject( const VisibilityObjectDesc & pObjectDesc );
+
+		void RemoveObject( visibility_object_handle_t pObjectHandle );
+
+		/// @brief Updates bounds of a moving object. If the object is an occluder, its occluder volume is moved by the same offset.
+		void UpdateObjectBounds( visibility_object_handle_t pObjectHandle, const cxm::aabbf & pBounds );
+
+		/// @brief Forces a full rebuild of the hierarchy on the next Cull(). Useful after many objects have moved
+		/// far from their original location (refitting keeps the topology, so the tree quality degrades over time).
+		void InvalidateHierarchy();
+
+		void Cull(
+				const VisibilityViewDesc & pViewDesc,
+				const VisibilityCullingConfig & pCullingConfig,
+				VisibilityDrawList & pDrawList,
+				WorkerThreadPool * pThreadPool = nullptr );
+
+		CPPX_ATTR_NO_DISCARD uint32 GetObjectsNum() const noexcept
+		{
+			return _activeObjectsNum;
+		}
+
+		CPPX_ATTR_NO_DISCARD const OcclusionDepthBuffer & GetOcclusionBuffer() const noexcept
+		{
+			return _occlusionBuffer;
+		}
+
+	private:
+		struct ObjectSlot
+		{
+			cxm::aabbf bounds;
+			cxm::aabbf occluderVolume;
+			uint32 userTag;
+			uint32 itemIndex;
+			bool isOccluder;
+			bool isActive;
+		};
+
+		void RebuildHierarchy();
+
+		void RefitHierarchy();
+
+		void CollectFrustumCandidates( const VisibilityViewDesc & pViewDesc );
+
+		void ApplyOcclusionCulling(
+				const VisibilityViewDesc & pViewDesc,
+				const VisibilityCullingConfig & pCullingConfig,
+				VisibilityStats & pStats,
+				WorkerThreadPool * pThreadPool );
+
+		void SetItemBounds( uint32 pItemIndex, const cxm::aabbf & pBounds );
+
+		CPPX_ATTR_NO_DISCARD cxm::aabb_soa<const float> GetItemBoundsSoA() const noexcept;
+
+	private:
+		std::vector<ObjectSlot> _objectSlotArray;
+		std::vector<visibility_object_handle_t> _freeSlotList;
+		uint32 _activeObjectsNum = 0;
+		bool _hierarchyRebuildRequired = false;
+		bool _hierarchyRefitRequired = false;
+		VisibilityBVH _bvh;
+		/// Bounds of all objects in the hierarchy order: six arrays (center xyz, extents xyz), one after another.
+		std::vector<float> _itemBoundsData;
+		std::vector<visibility_object_handle_t> _itemObjectHandleArray;
+		OcclusionDepthBuffer _occlusionBuffer;
+		std::vector<VisibilityBVHItemRange> _itemRangeBuffer;
+		std::vector<uint32> _visibilityMaskBuffer;
+		std::vector<uint32> _candidateItemArray;
+		std::vector<uint8> _occlusionResultBuffer;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_VISIBILITY_SYSTEM_H__
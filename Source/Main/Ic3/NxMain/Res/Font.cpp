@@ -28,6 +28,14 @@ namespace Ic3
 		return getCharacterKerning( pCharCPPair );
 	}
 
+	void Font::touchCharacterGlyphs( const char_code_point_t *, size_t )
+	{}
+
+	uint64 Font::getGlyphAtlasGeneration() const
+	{
+		return 0;
+	}
+
 	const FontGlyph * Font::getCharacterGlyph( char_code_point_t pCharCP ) const
 	{
 		auto glyphIter = _glyphMap.find( pCharCP );
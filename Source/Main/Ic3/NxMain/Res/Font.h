@@ -38,6 +38,14 @@ namespace Ic3
 
 		virtual char_kerning_value_t loadCharacterKerning( const CharCodePointPair & pCharCPPair );
 
+		// Marks already loaded glyphs as used, so a dynamic font does not evict them in the current frame (like it would
+		// not evict glyphs just returned by loadCharacterGlyph()). Called for glyphs of cached text layouts. No-op for static fonts.
+		virtual void touchCharacterGlyphs( const char_code_point_t * pCharCPs, size_t pCharCPsNum );
+
+		// Returns a value which changes whenever image references of already loaded glyphs may become invalid
+		// (e.g. glyphs evicted from a dynamic atlas). Used to invalidate cached text layouts. 0 for static fonts.
+		virtual uint64 getGlyphAtlasGeneration() const;
+
 		const FontGlyph * getCharacterGlyph( char_code_point_t pCharCP ) const;
 
 		char_kerning_value_t getCharacterKerning( const CharCodePointPair & pCharCPPair ) const;
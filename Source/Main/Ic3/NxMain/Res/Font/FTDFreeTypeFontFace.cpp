@@ -159,6 +159,78 @@ namespace Ic3
 		return true;
 	}
 
+	bool FreeTypeFontFace::loadGlyphDistanceField( char_code_point_t pCodePoint, FontImageData * pOutGlyphImage )
+	{
+		auto glyphDistanceFieldIter = _glyphDistanceFieldCache.find( pCodePoint );
+		if( glyphDistanceFieldIter == _glyphDistanceFieldCache.end() )
+		{
+			auto * ftGlyph = getGlyph( pCodePoint );
+			if( !ftGlyph || ( ftGlyph->format != FT_GLYPH_FORMAT_OUTLINE ) )
+			{
+				return false;
+			}
+
+			// The cached glyph stays an outline: it is copied, scaled by the oversampling factor and rendered
+			// as a plain 8-bit coverage bitmap, which is the input for the distance transform.
+			FT_Glyph ftScaledGlyph = nullptr;
+			if( FT_Glyph_Copy( ftGlyph, &ftScaledGlyph ) != FT_Err_Ok )
+			{
+				return false;
+			}
+
+			const auto oversampling = static_cast<FT_Fixed>( cppx::get_max_of( _distanceFieldDesc.oversampling, 1u ) );
+			FT_Matrix ftScaleMatrix{ oversampling * 0x10000, 0, 0, oversampling * 0x10000 };
+			FT_Glyph_Transform( ftScaledGlyph, &ftScaleMatrix, nullptr );
+
+			auto ftResult = FT_Glyph_To_Bitmap( &ftScaledGlyph, FT_RENDER_MODE_NORMAL, nullptr, 1 );
+			if( ftResult != FT_Err_Ok )
+			{
+				FT_Done_Glyph( ftScaledGlyph );
+				return false;
+			}
+
+			const auto & ftBitmap = reinterpret_cast<FT_BitmapGlyph>( ftScaledGlyph )->bitmap;
+
+			FontImageData coverageImage;
+			coverageImage.data = ftBitmap.buffer;
+			coverageImage.dataRowPitch = static_cast<size_t>( ftBitmap.pitch );
+			coverageImage.dataSize = static_cast<size_t>( ftBitmap.pitch ) * ftBitmap.rows;
+			coverageImage.width = ftBitmap.width;
+			coverageImage.height = ftBitmap.rows;
+
+			CachedGlyphDistanceField glyphDistanceField;
+			const auto generateResult = ( ftBitmap.pixel_mode == FT_PIXEL_MODE_GRAY ) && ( ftBitmap.pitch > 0 ) &&
+			                            _distanceFieldGenerator.Generate(
+			                                    coverageImage,
+			                                    _distanceFieldDesc.spread,
+			                                    _distanceFieldDesc.oversampling,
+			                                    glyphDistanceField.imageData,
+			                                    glyphDistanceField.imageDimensions );
+
+			FT_Done_Glyph( ftScaledGlyph );
+
+			if( !generateResult )
+			{
+				return false;
+			}
+
+			auto insertIter = _glyphDistanceFieldCache.insert( { pCodePoint, std::move( glyphDistanceField ) } );
+			glyphDistanceFieldIter = insertIter.first;
+		}
+
+		if( pOutGlyphImage )
+		{
+			const auto & glyphDistanceField = glyphDistanceFieldIter->second;
+			pOutGlyphImage->data = glyphDistanceField.imageData.data();
+			pOutGlyphImage->dataRowPitch = glyphDistanceField.imageDimensions.x;
+			pOutGlyphImage->dataSize = glyphDistanceField.imageData.size();
+			pOutGlyphImage->width = glyphDistanceField.imageDimensions.x;
+			pOutGlyphImage->height = glyphDistanceField.imageDimensions.y;
+		}
+
+		return true;
+	}
+
 	bool FreeTypeFontFace::loadKerning( const CharCodePointPair & pCharCPPair, FT_Pos * pOutKerning )
 	{
 		FT_UInt ftFirstGlyphIndex = FT_Get_Char_Index( _ftFace, pCharCPPair.first );
@@ -206,6 +278,27 @@ namespace Ic3
 		return true;
 	}
 
+	void FreeTypeFontFace::setGlyphImageType( EFontGlyphImageType pGlyphImageType, const FontDistanceFieldDesc & pDistanceFieldDesc )
+	{
+		_glyphImageType = pGlyphImageType;
+		_distanceFieldDesc = pDistanceFieldDesc;
+		_glyphDistanceFieldCache.clear();
+	}
+
+	void FreeTypeFontFace::releaseGlyph( char_code_point_t pCodePoint )
+	{
+		auto glyphDataIter = _glyphDataCache.find( pCodePoint );
+		if( glyphDataIter != _glyphDataCache.end() )
+		{
+			// Bitmap cache points to the same object (converted in-place in loadGlyphImage()).
+			FT_Done_Glyph( glyphDataIter->second.ftGlyph );
+			_glyphDataCache.erase( glyphDataIter );
+			_glyph_BITmapCache.erase( pCodePoint );
+		}
+
+		_glyphDistanceFieldCache.erase( pCodePoint );
+	}
+
 	void FreeTypeFontFace::resetGlyphCache()
 	{
 		for( auto & ftGlyph : _glyphDataCache )
@@ -215,6 +308,7 @@ namespace Ic3
 
 		_glyphDataCache.clear();
 		_glyph_BITmapCache.clear();
+		_glyphDistanceFieldCache.clear();
 	}
 
 	FT_Glyph FreeTypeFontFace::getGlyph( char_code_point_t pCodePoint ) const
@@ -258,9 +352,17 @@ namespace Ic3
 		// set to 0 (for any reason), it is useless for the purpose of glyph rendering.
 		if( ( ftResult != FT_Err_Ok ) || !ftFontFace || ( ftFontFace->num_faces == 0 ) )
 		{
+			if( ftFontFace )
+			{
+				FT_Done_Face( ftFontFace );
+			}
 			return nullptr;
 		}
 
+		// The face opened with index -1 is only used for the validation above - it has to be released as well.
+		FT_Done_Face( ftFontFace );
+		ftFontFace = nullptr;
+
 		ftResult = FT_New_Memory_Face( pFTFontObject->mFTLibrary,
 									   pFTFaceCreateInfo.inputData,
 									   pFTFaceCreateInfo.inputDataSize,
@@ -5,6 +5,7 @@
 #define __IC3_NXMAIN_RES_FTD_FREETYPE_FONT_FACE_H__
 
 #include "FTDFreeTypeCommon.h"
+#include "FontDistanceField.h"
 #include <unordered_map>
 
 #include <ft2build.h>
@@ -45,12 +46,25 @@ namespace Ic3
 
 		bool loadGlyphImage( char_code_point_t pCodePoint, FT_BitmapGlyph * pOutGlyphBitmap );
 
+		// Loads the signed distance field image of the glyph (see setGlyphImageType()). The image data is owned by the face.
+		bool loadGlyphDistanceField( char_code_point_t pCodePoint, FontImageData * pOutGlyphImage );
+
 		bool loadKerning( const CharCodePointPair & pCharCPPair, FT_Pos * pOutKerning );
 
 		bool setFontResolution( const cxm::vec2u32 & pFontResolution );
 
+		void setGlyphImageType( EFontGlyphImageType pGlyphImageType, const FontDistanceFieldDesc & pDistanceFieldDesc );
+
+		// Releases the FT data of a single glyph. Used when its image has already been copied somewhere else.
+		void releaseGlyph( char_code_point_t pCodePoint );
+
 		void resetGlyphCache();
 
+		bool hasKerning() const
+		{
+			return FT_HAS_KERNING( _ftFace );
+		}
+
 		FT_Glyph getGlyph( char_code_point_t pCodePoint ) const;
 
 		FT_BitmapGlyph getGlyphBitmap( char_code_point_t pCodePoint ) const;
@@ -62,6 +76,21 @@ namespace Ic3
 			return _fontSize;
 		}
 
+		const cxm::vec2u32 & getFontResolution() const
+		{
+			return _fontResolution;
+		}
+
+		EFontGlyphImageType getGlyphImageType() const
+		{
+			return _glyphImageType;
+		}
+
+		const FontDistanceFieldDesc & getDistanceFieldDesc() const
+		{
+			return _distanceFieldDesc;
+		}
+
 		uint32 getLineHeight() const
 		{
 			return _ftFace->size->metrics.height / 64;
@@ -81,8 +110,15 @@ namespace Ic3
 			FT_BitmapGlyph ftBitmapGlyph;
 		};
 
+		struct CachedGlyphDistanceField
+		{
+			std::vector<byte> imageData;
+			cxm::vec2u32 imageDimensions;
+		};
+
 		using FTGlyphDataCache = std::unordered_map<char_code_point_t, CachedGlyphData>;
 		using FTGlyphBitmapCache = std::unordered_map<char_code_point_t, CachedGlyphBitmap>;
+		using GlyphDistanceFieldCache = std::unordered_map<char_code_point_t, CachedGlyphDistanceField>;
 
 		FreeTypeFontObject * _fontObject;
 		FT_Face _ftFace;
@@ -91,6 +127,10 @@ namespace Ic3
 		cxm::vec2u32 _fontResolution;
 		FTGlyphDataCache _glyphDataCache;
 		FTGlyphBitmapCache _glyph_BITmapCache;
+		GlyphDistanceFieldCache _glyphDistanceFieldCache;
+		EFontGlyphImageType _glyphImageType = EFontGlyphImageType::Coverage;
+		FontDistanceFieldDesc _distanceFieldDesc;
+		FontDistanceFieldGenerator _distanceFieldGenerator;
 	};
 
 } // namespace Ic3
@@ -11,6 +11,10 @@ namespace Ic3
 	{}
 
 	FreeTypeFontObject::FreeTypeFontObject( FT_Library pFTLibrary, cppx::dynamic_byte_array pFontData )
+	: FreeTypeFontObject( pFTLibrary, std::make_shared<const cppx::dynamic_byte_array>( std::move( pFontData ) ) )
+	{}
+
+	FreeTypeFontObject::FreeTypeFontObject( FT_Library pFTLibrary, std::shared_ptr<const cppx::dynamic_byte_array> pFontData )
 	: mFTLibrary( pFTLibrary )
 	, _activeFace( nullptr )
 	, _ftLibraryInstance( pFTLibrary )
@@ -48,8 +52,8 @@ namespace Ic3
 			ftFaceCreateInfo.faceDesc.faceIndex = 0;
 			ftFaceCreateInfo.faceDesc.fontSize = pFontSize;
 			ftFaceCreateInfo.faceDesc.fontResolutionHint = { 0, 0 };
-			ftFaceCreateInfo.inputData = reinterpret_cast<const FT_Byte *>( _ftFontData.data() );
-			ftFaceCreateInfo.inputDataSize = cppx::numeric_cast<FT_Long>( _ftFontData.size() );
+			ftFaceCreateInfo.inputData = reinterpret_cast<const FT_Byte *>( _ftFontData->data() );
+			ftFaceCreateInfo.inputDataSize = cppx::numeric_cast<FT_Long>( _ftFontData->size() );
 
 			auto newFontFace = FreeTypeFontFace::create( this, ftFaceCreateInfo );
 			if( newFontFace )
@@ -76,6 +80,17 @@ namespace Ic3
 		return false;
 	}
 
+	bool FreeTypeFontObject::setGlyphImageType( EFontGlyphImageType pGlyphImageType, const FontDistanceFieldDesc & pDistanceFieldDesc )
+	{
+		if( _activeFace )
+		{
+			_activeFace->setGlyphImageType( pGlyphImageType, pDistanceFieldDesc );
+			return true;
+		}
+
+		return false;
+	}
+
 	bool FreeTypeFontObject::loadGlyph( char_code_point_t pCodePoint, FontGlyph * pOutGlyph, FontImageData * pOutGlyphImage )
 	{
 		if( _activeFace )
@@ -88,14 +103,18 @@ namespace Ic3
 				pOutGlyph->codePoint = pCodePoint;
 				pOutGlyph->metrics.advance.x = ftGlyphMetrics.horiAdvance / 64;
 				pOutGlyph->metrics.advance.y = ftGlyphMetrics.vertAdvance / 64;
-				pOutGlyph->metrics.bearing.x = ftGlyphMetrics.horiBearingX / 64;
-				pOutGlyph->metrics.bearing.y = ftGlyphMetrics.vertBearingX / 64;
+				pOutGlyph->metrics.bearing.x = static_cast<int32>( ftGlyphMetrics.horiBearingX / 64 );
+				pOutGlyph->metrics.bearing.y = static_cast<int32>( ftGlyphMetrics.horiBearingY / 64 );
 				pOutGlyph->metrics.dimensions.x = ftGlyphMetrics.width / 64;
 				pOutGlyph->metrics.dimensions.y = ftGlyphMetrics.height / 64;
 
 				FT_BitmapGlyph ftBitmapGlyph = nullptr;
 
-				if( _activeFace->loadGlyphImage( pCodePoint, &ftBitmapGlyph ) )
+				if( _activeFace->getGlyphImageType() == EFontGlyphImageType::SignedDistanceField )
+				{
+					_activeFace->loadGlyphDistanceField( pCodePoint, pOutGlyphImage );
+				}
+				else if( _activeFace->loadGlyphImage( pCodePoint, &ftBitmapGlyph ) )
 				{
 					pOutGlyphImage->data = ftBitmapGlyph->bitmap.buffer;
 					pOutGlyphImage->dataRowPitch = ftBitmapGlyph->bitmap.pitch;
@@ -113,7 +132,7 @@ namespace Ic3
 
 	bool FreeTypeFontObject::loadKerning( const CharCodePointPair & pCharCPPair, char_kerning_value_t * pOutKerning )
 	{
-		if( !_activeFace )
+		if( _activeFace )
 		{
 			FT_Pos kerningValue = 0;
 
@@ -127,6 +146,14 @@ namespace Ic3
 		return false;
 	}
 
+	void FreeTypeFontObject::releaseGlyph( char_code_point_t pCodePoint )
+	{
+		if( _activeFace )
+		{
+			_activeFace->releaseGlyph( pCodePoint );
+		}
+	}
+
 	void FreeTypeFontObject::ResetActiveGlyphCache()
 	{
 		if( _activeFace )
@@ -135,6 +162,11 @@ namespace Ic3
 		}
 	}
 
+	bool FreeTypeFontObject::hasKerning() const
+	{
+		return _activeFace && _activeFace->hasKerning();
+	}
+
 	FreeTypeFontFace * FreeTypeFontObject::getFace( uint32 pFontSize ) const
 	{
 		auto faceIter = _ftFontFaceMap.find( pFontSize );
@@ -155,6 +187,32 @@ namespace Ic3
 		return 0;
 	}
 
+	FreeTypeFontObjectPtr FreeTypeFontObject::createWorkerInstance() const
+	{
+		if( !_activeFace )
+		{
+			return nullptr;
+		}
+
+		FT_Library ftLibrary = nullptr;
+		if( FT_Init_FreeType( &ftLibrary ) != FT_Err_Ok )
+		{
+			return nullptr;
+		}
+
+		auto workerFontObject = std::make_unique<FreeTypeFontObject>( ftLibrary, _ftFontData );
+
+		const auto fontSize = _activeFace->getFontSize();
+		if( !workerFontObject->loadFace( fontSize ) || !workerFontObject->SetActiveFace( fontSize, _activeFace->getFontResolution() ) )
+		{
+			return nullptr;
+		}
+
+		workerFontObject->setGlyphImageType( _activeFace->getGlyphImageType(), _activeFace->getDistanceFieldDesc() );
+
+		return workerFontObject;
+	}
+
 	FreeTypeFontObjectPtr FreeTypeFontObject::createFromMemory( const void * pFontData, size_t pFontDataSize )
 	{
 		if( !pFontData || ( pFontDataSize == 0 ) )
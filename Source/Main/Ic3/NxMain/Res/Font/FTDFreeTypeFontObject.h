@@ -5,6 +5,7 @@
 #define __IC3_NXMAIN_RES_FTD_FREETYPE_FONT_OBJECT_H__
 
 #include "FTDFreeTypeCommon.h"
+#include "FontDistanceField.h"
 #include <cppx/byteArray.h>
 #include <unordered_map>
 
@@ -23,6 +24,7 @@ namespace Ic3
 
 		FreeTypeFontObject( std::nullptr_t );
 		FreeTypeFontObject( FT_Library pFTLibrary, cppx::dynamic_byte_array pFontData );
+		FreeTypeFontObject( FT_Library pFTLibrary, std::shared_ptr<const cppx::dynamic_byte_array> pFontData );
 		~FreeTypeFontObject();
 
 		explicit operator bool() const
@@ -34,16 +36,28 @@ namespace Ic3
 
 		bool SetActiveFace( uint32 pFontSize, const cxm::vec2u32 & pFontResolution );
 
+		// Selects the type of images produced by loadGlyph() for the active face.
+		bool setGlyphImageType( EFontGlyphImageType pGlyphImageType, const FontDistanceFieldDesc & pDistanceFieldDesc );
+
 		bool loadGlyph( char_code_point_t pCodePoint, FontGlyph * pOutGlyph, FontImageData * pOutGlyphImage );
 
 		bool loadKerning( const CharCodePointPair & pCharCPPair, char_kerning_value_t * pOutKerning );
 
+		void releaseGlyph( char_code_point_t pCodePoint );
+
 		void ResetActiveGlyphCache();
 
+		bool hasKerning() const;
+
 		FreeTypeFontFace * getFace( uint32 pFontSize ) const;
 
 		uint32 getLineHeight() const;
 
+		// Creates an independent copy of this object (with its own FT_Library and a face configured like the active
+		// one), which can be used to load glyphs in another thread. FT objects are not thread-safe, but the font
+		// data is only read, so it is shared with the copy instead of being duplicated.
+		FreeTypeFontObjectPtr createWorkerInstance() const;
+
 		static FreeTypeFontObjectPtr createFromMemory( const void * pFontData, size_t pFontDataSize );
 
 	private:
@@ -56,7 +70,8 @@ namespace Ic3
 		FT_Library _ftLibraryInstance;
 
 		// Loaded font data (from its font file). Used by FT_New_Memory_Face() when a new face is created.
-		cppx::dynamic_byte_array _ftFontData;
+		// Shared with worker instances (see createWorkerInstance()).
+		std::shared_ptr<const cppx::dynamic_byte_array> _ftFontData;
 
 		// All faces created by this font, mapped by their size.
 		FreeTypeFontFaceMap _ftFontFaceMap;
@@ -0,0 +1,575 @@
+
+#include "FTDGlyphCache.h"
+#include "FTDFreeTypeFontObject.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		// Below this number of new glyphs, creating worker font objects costs more than it saves.
+		constexpr size_t kGlyphCacheParallelRasterizationMinGlyphsNum = 64;
+
+		constexpr size_t kGlyphCacheParallelRasterizationGrainSize = 16;
+
+	}
+
+	DynamicFontGlyphCache::DynamicFontGlyphCache( FreeTypeFontObject & pFTFontObject, const DynamicFontGlyphCacheCreateInfo & pCreateInfo )
+	: _ftFontObject( &pFTFontObject )
+	, _createInfo( pCreateInfo )
+	, _kerningAvailable( pFTFontObject.hasKerning() )
+	{
+		RectAllocatorConfig layerAllocatorConfig;
+		layerAllocatorConfig.horizontalLayout.hSpacing = _createInfo.glyphSpacing;
+		layerAllocatorConfig.verticalLayout.vSpacing = _createInfo.glyphSpacing;
+		layerAllocatorConfig.verticalLayout.baseLineHeight = _createInfo.layerDimensions.y;
+		// Skyline keeps insertions cheap and (unlike the shelf packing) reuses the space of evicted glyphs.
+		layerAllocatorConfig.packingMethod = ERectPackingMethod::SkylineBottomLeft;
+
+		const auto layerImageSize = _createInfo.layerDimensions.x * _createInfo.layerDimensions.y * _createInfo.pixelByteSize;
+
+		_atlasLayerArray.resize( _createInfo.layersNum );
+		for( auto & atlasLayer : _atlasLayerArray )
+		{
+			atlasLayer.allocator = std::make_unique<RectAllocator>( _createInfo.layerDimensions, layerAllocatorConfig );
+			atlasLayer.imageData.resize( layerImageSize );
+			atlasLayer.imageData.fill( 0 );
+		}
+	}
+
+	DynamicFontGlyphCache::~DynamicFontGlyphCache() = default;
+
+	void DynamicFontGlyphCache::BeginFrame()
+	{
+		++_currentFrameIndex;
+	}
+
+	const FontGlyph * DynamicFontGlyphCache::GetGlyph( char_code_point_t pCodePoint )
+	{
+		auto glyphEntryIter = _glyphEntryMap.find( pCodePoint );
+		if( glyphEntryIter != _glyphEntryMap.end() )
+		{
+			MarkGlyphEntryUsed( glyphEntryIter->second );
+
+			++_stats.glyphHitsNum;
+
+			return &( _glyphEntryArray[glyphEntryIter->second].glyph );
+		}
+
+		return LoadGlyph( pCodePoint, false );
+	}
+
+	void DynamicFontGlyphCache::TouchGlyphs( const char_code_point_t * pCodePoints, size_t pCodePointsNum )
+	{
+		for( size_t codePointIndex = 0; codePointIndex < pCodePointsNum; ++codePointIndex )
+		{
+			auto glyphEntryIter = _glyphEntryMap.find( pCodePoints[codePointIndex] );
+			if( glyphEntryIter != _glyphEntryMap.end() )
+			{
+				MarkGlyphEntryUsed( glyphEntryIter->second );
+			}
+		}
+	}
+
+	char_kerning_value_t DynamicFontGlyphCache::GetKerning( const CharCodePointPair & pCharCPPair )
+	{
+		if( !_kerningAvailable )
+		{
+			return 0;
+		}
+
+		const auto kerningKey = ( static_cast<uint64>( pCharCPPair.first ) << 32 ) | pCharCPPair.second;
+
+		auto kerningIter = _kerningCache.find( kerningKey );
+		if( kerningIter != _kerningCache.end() )
+		{
+			++_stats.kerningHitsNum;
+			return kerningIter->second;
+		}
+
+		char_kerning_value_t kerningValue = 0;
+		if( !_ftFontObject->loadKerning( pCharCPPair, &kerningValue ) )
+		{
+			// Pairs without kerning are cached as well - in a typical text they are the vast majority.
+			kerningValue = 0;
+		}
+
+		_kerningCache.insert( { kerningKey, kerningValue } );
+		++_stats.kerningMissesNum;
+
+		return kerningValue;
+	}
+
+	uint32 DynamicFontGlyphCache::PreloadGlyphs(
+			const std::vector<char_code_point_t> & pCodePoints,
+			bool pPinned,
+			WorkerThreadPool * pThreadPool )
+	{
+		std::vector<RasterizedGlyph> rasterizedGlyphs;
+		std::unordered_map<char_code_point_t, uint32> rasterizedGlyphIndexMap;
+
+		if( pThreadPool && ( pThreadPool->GetWorkerThreadsNum() > 0 ) )
+		{
+			RasterizeGlyphsParallel( pCodePoints, *pThreadPool, rasterizedGlyphs, rasterizedGlyphIndexMap );
+		}
+
+		uint32 loadedGlyphsNum = 0;
+
+		for( auto codePoint : pCodePoints )
+		{
+			auto glyphEntryIter = _glyphEntryMap.find( codePoint );
+			if( glyphEntryIter != _glyphEntryMap.end() )
+			{
+				auto & glyphEntry = _glyphEntryArray[glyphEntryIter->second];
+				if( pPinned && !glyphEntry.pinned )
+				{
+					UnlinkLRU( glyphEntryIter->second );
+					glyphEntry.pinned = true;
+					++_stats.pinnedGlyphsNum;
+				}
+				++loadedGlyphsNum;
+				continue;
+			}
+
+			const FontGlyph * glyph = nullptr;
+
+			auto rasterizedGlyphIter = rasterizedGlyphIndexMap.find( codePoint );
+			if( ( rasterizedGlyphIter != rasterizedGlyphIndexMap.end() ) && rasterizedGlyphs[rasterizedGlyphIter->second].rasterized )
+			{
+				glyph = InsertRasterizedGlyph( rasterizedGlyphs[rasterizedGlyphIter->second], pPinned );
+			}
+			else
+			{
+				glyph = LoadGlyph( codePoint, pPinned );
+			}
+
+			if( glyph )
+			{
+				++loadedGlyphsNum;
+			}
+		}
+
+		return loadedGlyphsNum;
+	}
+
+	void DynamicFontGlyphCache::Reset()
+	{
+		for( auto & atlasLayer : _atlasLayerArray )
+		{
+			atlasLayer.allocator->Reset();
+			atlasLayer.imageData.fill( 0 );
+
+			_dirtyRegionList.push_back( FontGlyphCacheDirtyRegion{
+				static_cast<uint32>( &atlasLayer - _atlasLayerArray.data() ),
+				cxm::vec2u32{ 0, 0 },
+				_createInfo.layerDimensions } );
+		}
+
+		_glyphEntryArray.clear();
+		_freeGlyphEntryList.clear();
+		_glyphEntryMap.clear();
+		_missingGlyphSet.clear();
+		_lruHead = kGlyphEntryIndexInvalid;
+		_lruTail = kGlyphEntryIndexInvalid;
+		_stats.cachedGlyphsNum = 0;
+		_stats.pinnedGlyphsNum = 0;
+		++_atlasGeneration;
+	}
+
+	void DynamicFontGlyphCache::ClearDirtyRegions()
+	{
+		_dirtyRegionList.clear();
+	}
+
+	const FontGlyph * DynamicFontGlyphCache::LoadGlyph( char_code_point_t pCodePoint, bool pPinned )
+	{
+		if( _missingGlyphSet.count( pCodePoint ) != 0 )
+		{
+			return nullptr;
+		}
+
+		++_stats.glyphMissesNum;
+
+		// Value-initialized: glyphs without an image (e.g. spaces) keep an empty image reference.
+		FontGlyph glyph{};
+		FontImageData glyphImage;
+
+		if( !_ftFontObject->loadGlyph( pCodePoint, &glyph, &glyphImage ) )
+		{
+			// Remember code points not present in the font, so the (costly) lookup is done only once.
+			_missingGlyphSet.insert( pCodePoint );
+			return nullptr;
+		}
+
+		const auto * cachedGlyph = InsertGlyph( glyph, glyphImage, pPinned );
+
+		// The image is in the atlas now (or could not be placed there), FT data is no longer needed.
+		_ftFontObject->releaseGlyph( pCodePoint );
+
+		return cachedGlyph;
+	}
+
+	const FontGlyph * DynamicFontGlyphCache::InsertGlyph( const FontGlyph & pGlyph, const FontImageData & pGlyphImage, bool pPinned )
+	{
+		auto glyph = pGlyph;
+
+		uint32 layerIndex = 0;
+		cxm::vec2u32 imageSize{ 0, 0 };
+		rect_allocation_id_t allocationID = kRectAllocationIDInvalid;
+
+		if( pGlyphImage )
+		{
+			if( !AllocateGlyphImage( pGlyphImage.dimensions, layerIndex, allocationID ) )
+			{
+				++_stats.glyphAllocationFailuresNum;
+				return nullptr;
+			}
+
+			const auto imageOffset = _atlasLayerArray[layerIndex].allocator->GetRectPosition( allocationID );
+			imageSize = pGlyphImage.dimensions;
+
+			CopyGlyphImage( layerIndex, imageOffset, pGlyphImage );
+
+			auto & glyphImageRef = glyph.imageRef;
+			glyphImageRef.imageIndex = layerIndex;
+			glyphImageRef.rect.offset.x = static_cast<float>( imageOffset.x ) / _createInfo.layerDimensions.x;
+			glyphImageRef.rect.offset.y = static_cast<float>( imageOffset.y ) / _createInfo.layerDimensions.y;
+			glyphImageRef.rect.size.x = static_cast<float>( pGlyphImage.width ) / _createInfo.layerDimensions.x;
+			glyphImageRef.rect.size.y = static_cast<float>( pGlyphImage.height ) / _createInfo.layerDimensions.y;
+		}
+
+		uint32 entryIndex = 0;
+		if( !_freeGlyphEntryList.empty() )
+		{
+			entryIndex = _freeGlyphEntryList.back();
+			_freeGlyphEntryList.pop_back();
+		}
+		else
+		{
+			entryIndex = static_cast<uint32>( _glyphEntryArray.size() );
+			_glyphEntryArray.emplace_back();
+		}
+
+		auto & glyphEntry = _glyphEntryArray[entryIndex];
+		glyphEntry.glyph = glyph;
+		glyphEntry.imageSize = imageSize;
+		glyphEntry.allocationID = allocationID;
+		glyphEntry.layerIndex = layerIndex;
+		glyphEntry.lruPrev = kGlyphEntryIndexInvalid;
+		glyphEntry.lruNext = kGlyphEntryIndexInvalid;
+		glyphEntry.lastUseFrameIndex = _currentFrameIndex;
+		glyphEntry.pinned = pPinned;
+
+		if( pPinned )
+		{
+			++_stats.pinnedGlyphsNum;
+		}
+		else
+		{
+			LinkLRUFront( entryIndex );
+		}
+
+		_glyphEntryMap[glyph.codePoint] = entryIndex;
+		++_stats.cachedGlyphsNum;
+
+		return &( glyphEntry.glyph );
+	}
+
+	const FontGlyph * DynamicFontGlyphCache::InsertRasterizedGlyph( const RasterizedGlyph & pRasterizedGlyph, bool pPinned )
+	{
+		if( _missingGlyphSet.count( pRasterizedGlyph.glyph.codePoint ) != 0 )
+		{
+			return nullptr;
+		}
+
+		++_stats.glyphMissesNum;
+
+		if( !pRasterizedGlyph.found )
+		{
+			_missingGlyphSet.insert( pRasterizedGlyph.glyph.codePoint );
+			return nullptr;
+		}
+
+		FontImageData glyphImage;
+		if( !pRasterizedGlyph.imageData.empty() )
+		{
+			glyphImage.data = pRasterizedGlyph.imageData.data();
+			glyphImage.dataSize = pRasterizedGlyph.imageData.size();
+			glyphImage.dataRowPitch = pRasterizedGlyph.imageRowPitch;
+			glyphImage.dimensions = pRasterizedGlyph.imageDimensions;
+		}
+
+		return InsertGlyph( pRasterizedGlyph.glyph, glyphImage, pPinned );
+	}
+
+	void DynamicFontGlyphCache::RasterizeGlyphsParallel(
+			const std::vector<char_code_point_t> & pCodePoints,
+			WorkerThreadPool & pThreadPool,
+			std::vector<RasterizedGlyph> & pOutRasterizedGlyphs,
+			std::unordered_map<char_code_point_t, uint32> & pOutRasterizedGlyphIndexMap )
+	{
+		std::vector<char_code_point_t> newCodePoints;
+		newCodePoints.reserve( pCodePoints.size() );
+
+		for( auto codePoint : pCodePoints )
+		{
+			if( ( _glyphEntryMap.count( codePoint ) == 0 ) && ( _missingGlyphSet.count( codePoint ) == 0 ) )
+			{
+				const auto insertResult = pOutRasterizedGlyphIndexMap.insert( { codePoint, static_cast<uint32>( newCodePoints.size() ) } );
+				if( insertResult.second )
+				{
+					newCodePoints.push_back( codePoint );
+				}
+			}
+		}
+
+		if( newCodePoints.size() < kGlyphCacheParallelRasterizationMinGlyphsNum )
+		{
+			pOutRasterizedGlyphIndexMap.clear();
+			return;
+		}
+
+		pOutRasterizedGlyphs.resize( newCodePoints.size() );
+
+		// FT objects cannot be shared between threads, so each range uses a worker copy of the font object.
+		// Copies are created on demand and returned to the idle list after a range is done, so there are
+		// never more of them than threads actually processing the ranges.
+		std::mutex workerFontObjectLock;
+		std::vector<FreeTypeFontObjectPtr> workerFontObjectArray;
+		std::vector<FreeTypeFontObject *> idleWorkerFontObjectList;
+
+		pThreadPool.ParallelFor( newCodePoints.size(), kGlyphCacheParallelRasterizationGrainSize, [&]( size_t pBeginIndex, size_t pEndIndex ) {
+			FreeTypeFontObject * workerFontObject = nullptr;
+			{
+				std::lock_guard<std::mutex> workerFontObjectLockGuard{ workerFontObjectLock };
+				if( !idleWorkerFontObjectList.empty() )
+				{
+					workerFontObject = idleWorkerFontObjectList.back();
+					idleWorkerFontObjectList.pop_back();
+				}
+			}
+
+			if( !workerFontObject )
+			{
+				// Created outside of the lock - initializing FT and the face is the most expensive part of this.
+				auto newWorkerFontObject = _ftFontObject->createWorkerInstance();
+				if( !newWorkerFontObject )
+				{
+					// Glyphs of this range stay marked as not rasterized and are loaded serially instead.
+					return;
+				}
+
+				workerFontObject = newWorkerFontObject.get();
+
+				std::lock_guard<std::mutex> workerFontObjectLockGuard{ workerFontObjectLock };
+				workerFontObjectArray.push_back( std::move( newWorkerFontObject ) );
+			}
+
+			for( auto glyphIndex = pBeginIndex; glyphIndex < pEndIndex; ++glyphIndex )
+			{
+				const auto codePoint = newCodePoints[glyphIndex];
+				auto & rasterizedGlyph = pOutRasterizedGlyphs[glyphIndex];
+
+				FontImageData glyphImage;
+				rasterizedGlyph.found = workerFontObject->loadGlyph( codePoint, &( rasterizedGlyph.glyph ), &glyphImage );
+				rasterizedGlyph.glyph.codePoint = codePoint;
+				rasterizedGlyph.rasterized = true;
+
+				if( rasterizedGlyph.found && glyphImage )
+				{
+					rasterizedGlyph.imageData.assign( glyphImage.data, glyphImage.data + glyphImage.dataSize );
+					rasterizedGlyph.imageRowPitch = glyphImage.dataRowPitch;
+					rasterizedGlyph.imageDimensions = glyphImage.dimensions;
+				}
+
+				workerFontObject->releaseGlyph( codePoint );
+			}
+
+			std::lock_guard<std::mutex> workerFontObjectLockGuard{ workerFontObjectLock };
+			idleWorkerFontObjectList.push_back( workerFontObject );
+		} );
+	}
+
+	void DynamicFontGlyphCache::MarkGlyphEntryUsed( uint32 pEntryIndex )
+	{
+		auto & glyphEntry = _glyphEntryArray[pEntryIndex];
+		glyphEntry.lastUseFrameIndex = _currentFrameIndex;
+
+		if( !glyphEntry.pinned && ( _lruHead != pEntryIndex ) )
+		{
+			UnlinkLRU( pEntryIndex );
+			LinkLRUFront( pEntryIndex );
+		}
+	}
+
+	bool DynamicFontGlyphCache::AllocateGlyphImage( const cxm::vec2u32 & pImageSize, uint32 & pOutLayerIndex, rect_allocation_id_t & pOutAllocationID )
+	{
+		for( uint32 layerIndex = 0; layerIndex < _atlasLayerArray.size(); ++layerIndex )
+		{
+			const auto allocationID = _atlasLayerArray[layerIndex].allocator->AllocateRect( pImageSize );
+			if( allocationID != kRectAllocationIDInvalid )
+			{
+				pOutLayerIndex = layerIndex;
+				pOutAllocationID = allocationID;
+				return true;
+			}
+		}
+
+		// All layers are full. Evict glyphs (starting from the least recently used one) and retry in the layer
+		// which got some space back. This stops at the first glyph used in the current frame.
+		uint32 evictedLayerIndex = 0;
+		while( EvictLeastRecentlyUsedGlyph( evictedLayerIndex ) )
+		{
+			const auto allocationID = _atlasLayerArray[evictedLayerIndex].allocator->AllocateRect( pImageSize );
+			if( allocationID != kRectAllocationIDInvalid )
+			{
+				pOutLayerIndex = evictedLayerIndex;
+				pOutAllocationID = allocationID;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool DynamicFontGlyphCache::EvictLeastRecentlyUsedGlyph( uint32 & pOutLayerIndex )
+	{
+		// Glyphs without an image do not use the atlas, so evicting them gives nothing.
+		auto entryIndex = _lruTail;
+		while( ( entryIndex != kGlyphEntryIndexInvalid ) && ( _glyphEntryArray[entryIndex].allocationID == kRectAllocationIDInvalid ) )
+		{
+			entryIndex = _glyphEntryArray[entryIndex].lruPrev;
+		}
+
+		if( ( entryIndex == kGlyphEntryIndexInvalid ) || ( _glyphEntryArray[entryIndex].lastUseFrameIndex == _currentFrameIndex ) )
+		{
+			return false;
+		}
+
+		pOutLayerIndex = _glyphEntryArray[entryIndex].layerIndex;
+
+		ReleaseGlyphEntry( entryIndex );
+		++_stats.glyphEvictionsNum;
+		++_atlasGeneration;
+
+		return true;
+	}
+
+	void DynamicFontGlyphCache::ReleaseGlyphEntry( uint32 pEntryIndex )
+	{
+		auto & glyphEntry = _glyphEntryArray[pEntryIndex];
+
+		if( glyphEntry.allocationID != kRectAllocationIDInvalid )
+		{
+			auto & layerAllocator = *( _atlasLayerArray[glyphEntry.layerIndex].allocator );
+			const auto imageOffset = layerAllocator.GetRectPosition( glyphEntry.allocationID );
+
+			// Cleared on the CPU side only. The region is uploaded (together with its spacing) when it gets reused.
+			ClearLayerRegion( glyphEntry.layerIndex, imageOffset, glyphEntry.imageSize );
+
+			layerAllocator.FreeRect( glyphEntry.allocationID );
+		}
+
+		UnlinkLRU( pEntryIndex );
+
+		_glyphEntryMap.erase( glyphEntry.glyph.codePoint );
+		_freeGlyphEntryList.push_back( pEntryIndex );
+		--_stats.cachedGlyphsNum;
+	}
+
+	void DynamicFontGlyphCache::CopyGlyphImage( uint32 pLayerIndex, const cxm::vec2u32 & pOffset, const FontImageData & pGlyphImage )
+	{
+		auto & layerImageData = _atlasLayerArray[pLayerIndex].imageData;
+
+		const auto layerWidth = _createInfo.layerDimensions.x;
+		const auto pixelByteSize = _createInfo.pixelByteSize;
+		const auto srcDataRowSize = pGlyphImage.width * pixelByteSize;
+
+		for( uint32 imageRowIndex = 0; imageRowIndex < pGlyphImage.height; ++imageRowIndex )
+		{
+			const auto srcByteOffset = imageRowIndex * pGlyphImage.dataRowPitch;
+			const auto targetByteOffset = ( ( pOffset.y + imageRowIndex ) * layerWidth + pOffset.x ) * pixelByteSize;
+			cppx::mem_copy( layerImageData.data_offset( targetByteOffset ), srcDataRowSize, pGlyphImage.data + srcByteOffset, srcDataRowSize );
+		}
+
+		// The spacing around the image is included: it may still contain an evicted glyph on the GPU side.
+		const auto spacing = _createInfo.glyphSpacing;
+		const auto regionOffset = cxm::vec2u32{
+			( pOffset.x > spacing ) ? ( pOffset.x - spacing ) : 0u,
+			( pOffset.y > spacing ) ? ( pOffset.y - spacing ) : 0u };
+		const auto regionEnd = cxm::vec2u32{
+			cppx::get_min_of( pOffset.x + pGlyphImage.width + spacing, _createInfo.layerDimensions.x ),
+			cppx::get_min_of( pOffset.y + pGlyphImage.height + spacing, _createInfo.layerDimensions.y ) };
+
+		_dirtyRegionList.push_back( FontGlyphCacheDirtyRegion{
+			pLayerIndex,
+			regionOffset,
+			cxm::vec2u32{ regionEnd.x - regionOffset.x, regionEnd.y - regionOffset.y } } );
+	}
+
+	void DynamicFontGlyphCache::ClearLayerRegion( uint32 pLayerIndex, const cxm::vec2u32 & pOffset, const cxm::vec2u32 & pSize )
+	{
+		auto & layerImageData = _atlasLayerArray[pLayerIndex].imageData;
+
+		const auto layerWidth = _createInfo.layerDimensions.x;
+		const auto pixelByteSize = _createInfo.pixelByteSize;
+
+		for( uint32 rowIndex = 0; rowIndex < pSize.y; ++rowIndex )
+		{
+			const auto targetByteOffset = ( ( pOffset.y + rowIndex ) * layerWidth + pOffset.x ) * pixelByteSize;
+			// Note: not byte_array::fill(), it changes the size of the array to the number of filled bytes.
+			cppx::mem_set_fill( layerImageData.data_offset( targetByteOffset ), pSize.x * pixelByteSize, 0, pSize.x * pixelByteSize );
+		}
+	}
+
+	void DynamicFontGlyphCache::LinkLRUFront( uint32 pEntryIndex )
+	{
+		auto & glyphEntry = _glyphEntryArray[pEntryIndex];
+		glyphEntry.lruPrev = kGlyphEntryIndexInvalid;
+		glyphEntry.lruNext = _lruHead;
+
+		if( _lruHead != kGlyphEntryIndexInvalid )
+		{
+			_glyphEntryArray[_lruHead].lruPrev = pEntryIndex;
+		}
+		else
+		{
+			_lruTail = pEntryIndex;
+		}
+
+		_lruHead = pEntryIndex;
+	}
+
+	void DynamicFontGlyphCache::UnlinkLRU( uint32 pEntryIndex )
+	{
+		auto & glyphEntry = _glyphEntryArray[pEntryIndex];
+		if( glyphEntry.pinned )
+		{
+			return;
+		}
+
+		if( glyphEntry.lruPrev != kGlyphEntryIndexInvalid )
+		{
+			_glyphEntryArray[glyphEntry.lruPrev].lruNext = glyphEntry.lruNext;
+		}
+		else
+		{
+			_lruHead = glyphEntry.lruNext;
+		}
+
+		if( glyphEntry.lruNext != kGlyphEntryIndexInvalid )
+		{
+			_glyphEntryArray[glyphEntry.lruNext].lruPrev = glyphEntry.lruPrev;
+		}
+		else
+		{
+			_lruTail = glyphEntry.lruPrev;
+		}
+
+		glyphEntry.lruPrev = kGlyphEntryIndexInvalid;
+		glyphEntry.lruNext = kGlyphEntryIndexInvalid;
+	}
+
+} // namespace Ic3
@@ -0,0 +1,211 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_RES_FTD_GLYPH_CACHE_H__
+#define __IC3_NXMAIN_RES_FTD_GLYPH_CACHE_H__
+
+#include "FTDFreeTypeCommon.h"
+#include <Ic3/CoreLib/Utility/RectAllocator.h>
+#include <cppx/byteArray.h>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Ic3
+{
+
+	class WorkerThreadPool;
+
+	inline constexpr uint32 kFontGlyphCacheDefaultGlyphSpacing = 2;
+
+	struct DynamicFontGlyphCacheCreateInfo
+	{
+		/// Dimensions of a single atlas layer, in pixels.
+		cxm::vec2u32 layerDimensions = { 0, 0 };
+
+		/// Number of atlas layers. Together with layerDimensions this is the texture budget of the cache:
+		/// when all layers are full, least recently used glyphs are evicted.
+		uint32 layersNum = 1;
+
+		/// Size, in bytes, of a single pixel of the atlas.
+		uint32 pixelByteSize = 1;
+
+		/// Empty space kept around each glyph image (prevents bleeding when the atlas is sampled with filtering).
+		uint32 glyphSpacing = kFontGlyphCacheDefaultGlyphSpacing;
+	};
+
+	/// @brief A region of an atlas layer modified by the cache. It has to be uploaded to the font texture.
+	struct FontGlyphCacheDirtyRegion
+	{
+		uint32 layerIndex;
+		cxm::vec2u32 offset;
+		cxm::vec2u32 size;
+	};
+
+	struct DynamicFontGlyphCacheStats
+	{
+		uint64 glyphHitsNum = 0;
+		uint64 glyphMissesNum = 0;
+		uint64 glyphEvictionsNum = 0;
+		/// Glyphs which could not be placed in the atlas, even after evicting all glyphs not used in the current frame.
+		uint64 glyphAllocationFailuresNum = 0;
+		uint64 kerningHitsNum = 0;
+		uint64 kerningMissesNum = 0;
+		uint32 cachedGlyphsNum = 0;
+		uint32 pinnedGlyphsNum = 0;
+	};
+
+	/// @brief Runtime glyph cache of a dynamic font. Glyphs are rasterized on their first use and copied into
+	/// the CPU-side images of the atlas layers (the FreeType data is released immediately after that). When there
+	/// is no space left, least recently used glyphs are evicted. Glyphs used in the current frame (see BeginFrame())
+	/// and pinned glyphs (see PreloadGlyphs()) are never evicted, so glyph pointers returned in a frame stay valid
+	/// until the next one. Kerning is loaded lazily, per pair, and memoized.
+	/// Changes of the atlas are reported as dirty regions, which have to be uploaded to the texture before drawing.
+	class DynamicFontGlyphCache
+	{
+	public:
+		DynamicFontGlyphCache( FreeTypeFontObject & pFTFontObject, const DynamicFontGlyphCacheCreateInfo & pCreateInfo );
+		~DynamicFontGlyphCache();
+
+		/// @brief Starts a new frame. Glyphs used before this call become candidates for eviction.
+		void BeginFrame();
+
+		/// @brief Returns the glyph for the code point, loading it if needed. Returns nullptr if the font does not
+		/// contain the glyph or there is no space for its image in the atlas.
+		const FontGlyph * GetGlyph( char_code_point_t pCodePoint );
+
+		/// @brief Marks glyphs already in the cache as used in the current frame, like GetGlyph() does, but without
+		/// loading missing ones. Used for glyphs referenced by data kept between frames (e.g. cached text layouts),
+		/// so they are not evicted while that data is still drawn.
+		void TouchGlyphs( const char_code_point_t * pCodePoints, size_t pCodePointsNum );
+
+		/// @brief Returns the kerning for the pair of code points (0 if there is none).
+		char_kerning_value_t GetKerning( const CharCodePointPair & pCharCPPair );
+
+		/// @brief Loads the glyphs (as far as there is space for them). If pPinned is true, they are never evicted.
+		/// If a thread pool is specified, glyphs not yet in the cache are rasterized in parallel, each thread using its
+		/// own copy of the FT font object. Images are then placed in the atlas serially, in the order of pCodePoints,
+		/// so the resulting atlas is exactly the same as the one built without the thread pool.
+		uint32 PreloadGlyphs(
+				const std::vector<char_code_point_t> & pCodePoints,
+				bool pPinned,
+				WorkerThreadPool * pThreadPool = nullptr );
+
+		/// @brief Removes all glyphs (including pinned ones) and clears the atlas.
+		void Reset();
+
+		void ClearDirtyRegions();
+
+		CPPX_ATTR_NO_DISCARD const std::vector<FontGlyphCacheDirtyRegion> & GetDirtyRegions() const noexcept
+		{
+			return _dirtyRegionList;
+		}
+
+		CPPX_ATTR_NO_DISCARD const cppx::dynamic_byte_array & GetLayerImageData( uint32 pLayerIndex ) const noexcept
+		{
+			return _atlasLayerArray[pLayerIndex].imageData;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetLayersNum() const noexcept
+		{
+			return static_cast<uint32>( _atlasLayerArray.size() );
+		}
+
+		/// @brief Returns a counter incremented whenever glyphs are evicted or the cache is reset (i.e. whenever
+		/// previously returned image references may no longer be valid).
+		CPPX_ATTR_NO_DISCARD uint64 GetAtlasGeneration() const noexcept
+		{
+			return _atlasGeneration;
+		}
+
+		CPPX_ATTR_NO_DISCARD const DynamicFontGlyphCacheStats & GetStats() const noexcept
+		{
+			return _stats;
+		}
+
+	private:
+		static constexpr uint32 kGlyphEntryIndexInvalid = cppx::meta::limits<uint32>::max_value;
+
+		struct GlyphEntry
+		{
+			FontGlyph glyph;
+			cxm::vec2u32 imageSize;
+			rect_allocation_id_t allocationID;
+			uint32 layerIndex;
+			// Links of the LRU list (indices of entries). Pinned glyphs are not in the list.
+			uint32 lruPrev;
+			uint32 lruNext;
+			uint64 lastUseFrameIndex;
+			bool pinned;
+		};
+
+		struct AtlasLayer
+		{
+			std::unique_ptr<RectAllocator> allocator;
+			cppx::dynamic_byte_array imageData;
+		};
+
+		// Glyph loaded by a worker thread, waiting to be placed in the atlas. The image is copied from the FT data
+		// of the worker's font object (which is released right after that).
+		struct RasterizedGlyph
+		{
+			FontGlyph glyph;
+			std::vector<byte> imageData;
+			size_t imageRowPitch = 0;
+			cxm::vec2u32 imageDimensions = { 0, 0 };
+			// False if the glyph has not been processed (e.g. creating the worker font object failed).
+			bool rasterized = false;
+			// False if the font does not contain the glyph.
+			bool found = false;
+		};
+
+		const FontGlyph * LoadGlyph( char_code_point_t pCodePoint, bool pPinned );
+
+		const FontGlyph * InsertGlyph( const FontGlyph & pGlyph, const FontImageData & pGlyphImage, bool pPinned );
+
+		const FontGlyph * InsertRasterizedGlyph( const RasterizedGlyph & pRasterizedGlyph, bool pPinned );
+
+		void RasterizeGlyphsParallel(
+				const std::vector<char_code_point_t> & pCodePoints,
+				WorkerThreadPool & pThreadPool,
+				std::vector<RasterizedGlyph> & pOutRasterizedGlyphs,
+				std::unordered_map<char_code_point_t, uint32> & pOutRasterizedGlyphIndexMap );
+
+		void MarkGlyphEntryUsed( uint32 pEntryIndex );
+
+		bool AllocateGlyphImage( const cxm::vec2u32 & pImageSize, uint32 & pOutLayerIndex, rect_allocation_id_t & pOutAllocationID );
+
+		bool EvictLeastRecentlyUsedGlyph( uint32 & pOutLayerIndex );
+
+		void ReleaseGlyphEntry( uint32 pEntryIndex );
+
+		void CopyGlyphImage( uint32 pLayerIndex, const cxm::vec2u32 & pOffset, const FontImageData & pGlyphImage );
+
+		void ClearLayerRegion( uint32 pLayerIndex, const cxm::vec2u32 & pOffset, const cxm::vec2u32 & pSize );
+
+		void LinkLRUFront( uint32 pEntryIndex );
+
+		void UnlinkLRU( uint32 pEntryIndex );
+
+	private:
+		FreeTypeFontObject * _ftFontObject;
+		DynamicFontGlyphCacheCreateInfo _createInfo;
+		std::vector<AtlasLayer> _atlasLayerArray;
+		// Deque keeps the addresses of the entries (and their FontGlyph objects) stable when new ones are added.
+		std::deque<GlyphEntry> _glyphEntryArray;
+		std::vector<uint32> _freeGlyphEntryList;
+		std::unordered_map<char_code_point_t, uint32> _glyphEntryMap;
+		std::unordered_set<char_code_point_t> _missingGlyphSet;
+		std::unordered_map<uint64, char_kerning_value_t> _kerningCache;
+		std::vector<FontGlyphCacheDirtyRegion> _dirtyRegionList;
+		DynamicFontGlyphCacheStats _stats;
+		uint64 _currentFrameIndex = 0;
+		uint64 _atlasGeneration = 0;
+		uint32 _lruHead = kGlyphEntryIndexInvalid;
+		uint32 _lruTail = kGlyphEntryIndexInvalid;
+		bool _kerningAvailable = false;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_RES_FTD_GLYPH_CACHE_H__
@@ -0,0 +1,251 @@
+
+#include "FontDistanceField.h"
+#include <cmath>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		// Offset used for cells without a known seed. Large enough to lose against any real offset, small enough
+		// to keep the squared length (x*x + y*y, computed in 32 bits) from overflowing after adding a neighbour offset.
+		constexpr int32 kSDFCellInfinity = 16000;
+
+		// Inputs are limited so that real offsets stay well below kSDFCellInfinity (and below infinite offsets
+		// decreased by propagation through a whole row).
+		constexpr uint32 kSDFMaxInputDimension = 4096;
+
+		constexpr uint8 kSDFInsideThreshold = 128;
+
+		inline uint32 MakeSDFCell( int32 pOffsetX, int32 pOffsetY )
+		{
+			return static_cast<uint32>( static_cast<uint16>( pOffsetX ) ) | ( static_cast<uint32>( static_cast<uint16>( pOffsetY ) ) << 16 );
+		}
+
+		inline int32 GetSDFCellDistanceSq( uint32 pCell )
+		{
+			const int32 offsetX = static_cast<int16>( pCell & 0xFFFF );
+			const int32 offsetY = static_cast<int16>( pCell >> 16 );
+			return offsetX * offsetX + offsetY * offsetY;
+		}
+
+		inline void CompareSDFCell( uint32 & pCell, uint32 pNeighbourCell, int32 pNeighbourX, int32 pNeighbourY )
+		{
+			const int32 offsetX = static_cast<int16>( pNeighbourCell & 0xFFFF ) + pNeighbourX;
+			const int32 offsetY = static_cast<int16>( pNeighbourCell >> 16 ) + pNeighbourY;
+
+			if( offsetX * offsetX + offsetY * offsetY < GetSDFCellDistanceSq( pCell ) )
+			{
+				pCell = MakeSDFCell( offsetX, offsetY );
+			}
+		}
+
+		/// Compares each cell of the row with the three cells of the neighbouring row (above or below).
+		/// Both pointers point to the first cell of the row, cells at [-1] and [pWidth] must be valid (grid border).
+		void CompareSDFRowWithNeighbourRow( uint32 * pRow, const uint32 * pNeighbourRow, int32 pNeighbourY, uint32 pWidth )
+		{
+			uint32 cellIndex = 0;
+
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			// Cells are pairs of int16 values, so offsets are added with _mm_add_epi16() and the squared
+			// length of each (x, y) pair is computed with a single _mm_madd_epi16().
+			const __m128i neighbourOffsetLeft = _mm_set1_epi32( static_cast<int32>( MakeSDFCell( -1, pNeighbourY ) ) );
+			const __m128i neighbourOffsetCenter = _mm_set1_epi32( static_cast<int32>( MakeSDFCell( 0, pNeighbourY ) ) );
+			const __m128i neighbourOffsetRight = _mm_set1_epi32( static_cast<int32>( MakeSDFCell( 1, pNeighbourY ) ) );
+
+			const auto selectNearer = []( __m128i & pCells, __m128i & pCellsDistSq, __m128i pCandidates ) {
+				const __m128i candidatesDistSq = _mm_madd_epi16( pCandidates, pCandidates );
+				const __m128i selectMask = _mm_cmplt_epi32( candidatesDistSq, pCellsDistSq );
+				pCells = _mm_or_si128( _mm_and_si128( selectMask, pCandidates ), _mm_andnot_si128( selectMask, pCells ) );
+				pCellsDistSq = _mm_or_si128( _mm_and_si128( selectMask, candidatesDistSq ), _mm_andnot_si128( selectMask, pCellsDistSq ) );
+			};
+
+			for( ; cellIndex + 4 <= pWidth; cellIndex += 4 )
+			{
+				__m128i cells = _mm_loadu_si128( reinterpret_cast<const __m128i *>( pRow + cellIndex ) );
+				__m128i cellsDistSq = _mm_madd_epi16( cells, cells );
+
+				const auto * neighbourCells = pNeighbourRow + cellIndex;
+				selectNearer( cells, cellsDistSq, _mm_add_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i *>( neighbourCells - 1 ) ), neighbourOffsetLeft ) );
+				selectNearer( cells, cellsDistSq, _mm_add_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i *>( neighbourCells ) ), neighbourOffsetCenter ) );
+				selectNearer( cells, cellsDistSq, _mm_add_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i *>( neighbourCells + 1 ) ), neighbourOffsetRight ) );
+
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( pRow + cellIndex ), cells );
+			}
+		#endif
+
+			for( ; cellIndex < pWidth; ++cellIndex )
+			{
+				// Indexed through a pointer, so that [-1] is not computed as an unsigned index for the first cell.
+				const auto * neighbourCells = pNeighbourRow + cellIndex;
+				CompareSDFCell( pRow[cellIndex], neighbourCells[-1], -1, pNeighbourY );
+				CompareSDFCell( pRow[cellIndex], neighbourCells[0], 0, pNeighbourY );
+				CompareSDFCell( pRow[cellIndex], neighbourCells[1], 1, pNeighbourY );
+			}
+		}
+
+		void SweepSDFRowLeftToRight( uint32 * pRow, uint32 pWidth )
+		{
+			for( uint32 cellIndex = 1; cellIndex < pWidth; ++cellIndex )
+			{
+				CompareSDFCell( pRow[cellIndex], pRow[cellIndex - 1], -1, 0 );
+			}
+		}
+
+		void SweepSDFRowRightToLeft( uint32 * pRow, uint32 pWidth )
+		{
+			for( uint32 cellIndex = pWidth - 1; cellIndex > 0; --cellIndex )
+			{
+				CompareSDFCell( pRow[cellIndex - 1], pRow[cellIndex], 1, 0 );
+			}
+		}
+
+	}
+
+	FontDistanceFieldGenerator::FontDistanceFieldGenerator() = default;
+
+	FontDistanceFieldGenerator::~FontDistanceFieldGenerator() = default;
+
+	bool FontDistanceFieldGenerator::Generate(
+			const FontImageData & pCoverageImage,
+			uint32 pSpread,
+			uint32 pOversampling,
+			std::vector<byte> & pOutImageData,
+			cxm::vec2u32 & pOutImageDimensions )
+	{
+		if( !pCoverageImage || ( pCoverageImage.width == 0 ) || ( pCoverageImage.height == 0 ) )
+		{
+			return false;
+		}
+
+		const auto oversampling = cppx::get_max_of( pOversampling, 1u );
+		const auto spread = cppx::get_max_of( pSpread, 1u );
+
+		// Padding (in input pixels) required to encode the whole spread outside the glyph. The padded size is
+		// rounded up to a multiple of the oversampling factor, so each output pixel covers a full input block.
+		const auto inputPadding = spread * oversampling;
+		const auto outputWidth = ( pCoverageImage.width + 2 * inputPadding + oversampling - 1 ) / oversampling;
+		const auto outputHeight = ( pCoverageImage.height + 2 * inputPadding + oversampling - 1 ) / oversampling;
+		const auto inputWidth = outputWidth * oversampling;
+		const auto inputHeight = outputHeight * oversampling;
+
+		if( ( inputWidth > kSDFMaxInputDimension ) || ( inputHeight > kSDFMaxInputDimension ) )
+		{
+			return false;
+		}
+
+		// The grid has a 1-cell border of "infinite" cells, so the transform needs no bounds checks.
+		_gridWidth = inputWidth + 2;
+		_gridHeight = inputHeight + 2;
+
+		const auto infiniteCell = MakeSDFCell( kSDFCellInfinity, kSDFCellInfinity );
+		_insideSeedGrid.assign( _gridWidth * _gridHeight, infiniteCell );
+		_outsideSeedGrid.assign( _gridWidth * _gridHeight, infiniteCell );
+
+		bool hasInsidePixels = false;
+
+		for( uint32 inputY = 0; inputY < inputHeight; ++inputY )
+		{
+			auto * insideSeedRow = _insideSeedGrid.data() + ( inputY + 1 ) * _gridWidth + 1;
+			auto * outsideSeedRow = _outsideSeedGrid.data() + ( inputY + 1 ) * _gridWidth + 1;
+
+			const auto imageY = static_cast<int32>( inputY ) - static_cast<int32>( inputPadding );
+			const bool imageRowValid = ( imageY >= 0 ) && ( imageY < static_cast<int32>( pCoverageImage.height ) );
+			const auto * imageRow = imageRowValid ? ( pCoverageImage.data + imageY * pCoverageImage.dataRowPitch ) : nullptr;
+
+			for( uint32 inputX = 0; inputX < inputWidth; ++inputX )
+			{
+				const auto imageX = static_cast<int32>( inputX ) - static_cast<int32>( inputPadding );
+				const bool inside =
+						imageRow && ( imageX >= 0 ) && ( imageX < static_cast<int32>( pCoverageImage.width ) ) &&
+						( imageRow[imageX] >= kSDFInsideThreshold );
+
+				if( inside )
+				{
+					insideSeedRow[inputX] = 0;
+					hasInsidePixels = true;
+				}
+				else
+				{
+					outsideSeedRow[inputX] = 0;
+				}
+			}
+		}
+
+		if( !hasInsidePixels )
+		{
+			return false;
+		}
+
+		RunDistanceTransform( _insideSeedGrid );
+		RunDistanceTransform( _outsideSeedGrid );
+
+		pOutImageDimensions = cxm::vec2u32{ outputWidth, outputHeight };
+		pOutImageData.resize( outputWidth * outputHeight );
+
+		// Signed distance (in input pixels) is measured from the pixel center to the boundary between inside and
+		// outside pixels, hence the 0.5 correction. Blocks of oversampled pixels are averaged into a single value.
+		const float distanceScale = 127.0f / ( static_cast<float>( spread ) * static_cast<float>( oversampling ) * static_cast<float>( oversampling * oversampling ) );
+
+		_rowDistanceSum.resize( outputWidth );
+
+		for( uint32 outputY = 0; outputY < outputHeight; ++outputY )
+		{
+			std::fill( _rowDistanceSum.begin(), _rowDistanceSum.end(), 0.0f );
+
+			for( uint32 blockY = 0; blockY < oversampling; ++blockY )
+			{
+				const auto gridRowOffset = ( outputY * oversampling + blockY + 1 ) * _gridWidth + 1;
+				const auto * insideSeedRow = _insideSeedGrid.data() + gridRowOffset;
+				const auto * outsideSeedRow = _outsideSeedGrid.data() + gridRowOffset;
+
+				for( uint32 inputX = 0; inputX < inputWidth; ++inputX )
+				{
+					// Exactly one of the cells is a seed (distance 0).
+					const auto distanceToOutsideSq = GetSDFCellDistanceSq( outsideSeedRow[inputX] );
+					const auto distanceToInsideSq = GetSDFCellDistanceSq( insideSeedRow[inputX] );
+
+					const float signedDistance = ( distanceToOutsideSq > 0 )
+							? ( std::sqrt( static_cast<float>( distanceToOutsideSq ) ) - 0.5f )
+							: ( 0.5f - std::sqrt( static_cast<float>( distanceToInsideSq ) ) );
+
+					_rowDistanceSum[inputX / oversampling] += signedDistance;
+				}
+			}
+
+			auto * outputRow = pOutImageData.data() + outputY * outputWidth;
+			for( uint32 outputX = 0; outputX < outputWidth; ++outputX )
+			{
+				const auto encodedValue = 128.0f + _rowDistanceSum[outputX] * distanceScale;
+				outputRow[outputX] = static_cast<byte>( cppx::get_min_of( cppx::get_max_of( encodedValue + 0.5f, 0.0f ), 255.0f ) );
+			}
+		}
+
+		return true;
+	}
+
+	void FontDistanceFieldGenerator::RunDistanceTransform( std::vector<uint32> & pGrid )
+	{
+		const auto rowWidth = _gridWidth - 2;
+
+		// Forward pass: top-down, each row compared with the one above and swept in both directions.
+		for( uint32 gridY = 1; gridY < _gridHeight - 1; ++gridY )
+		{
+			auto * row = pGrid.data() + gridY * _gridWidth + 1;
+			CompareSDFRowWithNeighbourRow( row, row - _gridWidth, -1, rowWidth );
+			SweepSDFRowLeftToRight( row, rowWidth );
+			SweepSDFRowRightToLeft( row, rowWidth );
+		}
+
+		// Backward pass: bottom-up, with the row below.
+		for( uint32 gridY = _gridHeight - 2; gridY > 0; --gridY )
+		{
+			auto * row = pGrid.data() + gridY * _gridWidth + 1;
+			CompareSDFRowWithNeighbourRow( row, row + _gridWidth, 1, rowWidth );
+			SweepSDFRowRightToLeft( row, rowWidth );
+			SweepSDFRowLeftToRight( row, rowWidth );
+		}
+	}
+
+} // namespace Ic3
@@ -0,0 +1,74 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_RES_FONT_DISTANCE_FIELD_H__
+#define __IC3_NXMAIN_RES_FONT_DISTANCE_FIELD_H__
+
+#include "../FontMetrics.h"
+
+namespace Ic3
+{
+
+	enum class EFontGlyphImageType : uint32
+	{
+		/// Anti-aliased coverage bitmaps. Sharp, but valid only for the font size they were rendered at.
+		Coverage,
+
+		/// Signed distance fields. A single atlas can be used to draw the text at any size (see FontDistanceFieldDesc).
+		SignedDistanceField,
+	};
+
+	inline constexpr uint32 kFontDistanceFieldDefaultSpread = 4;
+
+	inline constexpr uint32 kFontDistanceFieldDefaultOversampling = 4;
+
+	/// @brief Parameters of the signed distance field glyph images.
+	/// Distance is stored in 8 bits: 128 is the outline, values above it are inside the glyph, 0 and 255 correspond
+	/// to the distance of 'spread' pixels (of the base font size) outside/inside. Each glyph image is padded with
+	/// 'spread' pixels on every side, so its quad has to be expanded by spread * ( targetSize / fontSize ) when drawn.
+	/// Larger spread allows effects like outlines and glows (and more extreme scaling), but needs more atlas space.
+	struct FontDistanceFieldDesc
+	{
+		/// Maximum encoded distance, in pixels of the base font size.
+		uint32 spread = kFontDistanceFieldDefaultSpread;
+
+		/// Glyphs are rasterized at fontSize * oversampling and the field is downsampled afterwards.
+		/// Improves the accuracy of the distance near the outline (1 disables oversampling).
+		uint32 oversampling = kFontDistanceFieldDefaultOversampling;
+	};
+
+	/// @brief Generates signed distance fields from 8-bit coverage bitmaps, using the 8-point sequential signed
+	/// Euclidean distance transform (8SSEDT). Pixels with coverage >= 50% are treated as inside. Comparisons with
+	/// the previous/next row are independent per pixel and use SSE2 when available, only the horizontal sweeps
+	/// are sequential. Scratch buffers are kept between calls - use one generator per thread.
+	class FontDistanceFieldGenerator
+	{
+	public:
+		FontDistanceFieldGenerator();
+		~FontDistanceFieldGenerator();
+
+		/// @brief Computes the distance field of the coverage image (rendered with pOversampling times the target
+		/// resolution). The result is downsampled by pOversampling and padded with pSpread pixels on each side.
+		/// Returns false if the input is empty.
+		bool Generate(
+				const FontImageData & pCoverageImage,
+				uint32 pSpread,
+				uint32 pOversampling,
+				std::vector<byte> & pOutImageData,
+				cxm::vec2u32 & pOutImageDimensions );
+
+	private:
+		void RunDistanceTransform( std::vector<uint32> & pGrid );
+
+	private:
+		uint32 _gridWidth = 0;
+		uint32 _gridHeight = 0;
+		// Each cell stores the offset (int16 x in the low half, int16 y in the high half) to the nearest seed.
+		std::vector<uint32> _insideSeedGrid;
+		std::vector<uint32> _outsideSeedGrid;
+		std::vector<float> _rowDistanceSum;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_RES_FONT_DISTANCE_FIELD_H__
@@ -2,32 +2,38 @@
 #include "FontTypeDynamic.h"
 #include "FTDFreeTypeFontFace.h"
 #include "FTDFreeTypeFontObject.h"
-#include <Ic3/CoreLib/Utility/RectAllocator.h>
 #include <unordered_map>
 
 namespace Ic3
 {
 
-	struct DynamicFontLoader::FTInternalFontData
+	DynamicFont::DynamicFont( const DynamicFontDesc & pFontDesc, FreeTypeFontObject & pFTFontObject, const DynamicFontGlyphCacheCreateInfo & pGlyphCacheCreateInfo )
+	: Font( mFontDesc )
+	, mFontDesc( pFontDesc )
+	, _glyphCache( pFTFontObject, pGlyphCacheCreateInfo )
+	{}
+
+	DynamicFont::~DynamicFont() = default;
+
+	const FontGlyph * DynamicFont::loadCharacterGlyph( char_code_point_t pCharCP )
 	{
-		struct LoadedGlyphData
-		{
-			FontGlyph glyph;
-			FontImageData glyphImage;
-		};
+		return _glyphCache.GetGlyph( pCharCP );
+	}
 
-		using TextureLayerInitData = FontTextureCreateInfo::TextureLayerInitData;
+	char_kerning_value_t DynamicFont::loadCharacterKerning( const CharCodePointPair & pCharCPPair )
+	{
+		return _glyphCache.GetKerning( pCharCPPair );
+	}
 
-		std::vector<LoadedGlyphData> glyphArray;
-		std::vector<CharKerningInfo> charKerningArray;
-		std::vector<TextureLayerInitData> textureLayerInitDataArray;
-		std::unordered_map<char_code_point_t, FontGlyph> glyphMap;
+	void DynamicFont::touchCharacterGlyphs( const char_code_point_t * pCharCPs, size_t pCharCPsNum )
+	{
+		_glyphCache.TouchGlyphs( pCharCPs, pCharCPsNum );
+	}
 
-		explicit operator bool() const
-		{
-			return !glyphArray.empty();
-		}
-	};
+	uint64 DynamicFont::getGlyphAtlasGeneration() const
+	{
+		return _glyphCache.GetAtlasGeneration();
+	}
 
 	struct DynamicFontLoader::FTFontLoaderPrivateData
 	{
@@ -38,26 +44,31 @@ namespace Ic3
 	FontHandle DynamicFontLoader::createFont( const DynamicFontCreateInfo & pFontCreateInfo )
 	{
 		auto * ftFontObject = createFreeTypeFontObject( pFontCreateInfo );
-		if( !ftFontObject || !ftFontObject->SetActiveFace( pFontCreateInfo.fontDesc.fontSize, pFontCreateInfo.fontResolutionHint ) )
+		if( !ftFontObject || !ftFontObject->loadFace( pFontCreateInfo.fontDesc.fontSize ) )
 		{
 			return nullptr;
 		}
 
-		FTInternalFontData internalFontData;
-
-		if( !loadInternalFontData( ftFontObject, pFontCreateInfo, internalFontData ) )
+		if( !ftFontObject->SetActiveFace( pFontCreateInfo.fontDesc.fontSize, pFontCreateInfo.fontResolutionHint ) )
 		{
 			return nullptr;
 		}
 
-		if( !processFontInitData( ftFontObject, pFontCreateInfo, internalFontData ) )
-		{
-			return nullptr;
-		}
+		ftFontObject->setGlyphImageType( pFontCreateInfo.fontDesc.glyphImageType, pFontCreateInfo.fontDesc.distanceFieldDesc );
 
-		ftFontObject->ResetActiveGlyphCache();
+		DynamicFontGlyphCacheCreateInfo glyphCacheCreateInfo;
+		glyphCacheCreateInfo.layerDimensions = pFontCreateInfo.fontDesc.textureDimensions;
+		glyphCacheCreateInfo.layersNum = cppx::get_max_of( pFontCreateInfo.fontDesc.fixedLayersNum + pFontCreateInfo.fontDesc.dynamicLayersNum, 1u );
+		glyphCacheCreateInfo.pixelByteSize = GCI::CXU::GetTextureFormatByteSize( pFontCreateInfo.fontDesc.textureFormat );
 
-		return nullptr;
+		// Elaborated name: DynamicFont alone refers to the EFontBaseType enumerator here.
+		auto dynamicFont = std::make_shared<class DynamicFont>( pFontCreateInfo.fontDesc, *ftFontObject, glyphCacheCreateInfo );
+
+		// Only the explicitly requested glyphs are rasterized here. Kerning is not pre-computed at all
+		// (it used to be queried for every pair of the preload set) - it is loaded per pair on first use.
+		dynamicFont->getGlyphCache().PreloadGlyphs( pFontCreateInfo.preloadGlyphSet, true, pFontCreateInfo.threadPool );
+
+		return dynamicFont;
 	}
 
 	FreeTypeFontObject * DynamicFontLoader::createFreeTypeFontObject( const DynamicFontCreateInfo & pFontCreateInfo )
@@ -83,135 +94,23 @@ namespace Ic3
 		return nullptr;
 	}
 
-	bool DynamicFontLoader::loadInternalFontData( FreeTypeFontObject * pFTFontObject, const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData )
+	FontTextureCreateInfo DynamicFontLoader::setupTextureCreateInfo( const DynamicFontCreateInfo & pFontCreateInfo, const DynamicFontGlyphCache & pGlyphCache )
 	{
-		FTInternalFontData fontData;
-		fontData.glyphArray.reserve( pFontCreateInfo.preloadGlyphSet.size() );
-		fontData.charKerningArray.reserve( pFontCreateInfo.preloadGlyphSet.size() );
-
-		for( auto codePoint : pFontCreateInfo.preloadGlyphSet )
-		{
-			FTInternalFontData::LoadedGlyphData glyphData;
-			if( pFTFontObject->loadGlyph( codePoint, &( glyphData.glyph ), &( glyphData.glyphImage ) ) )
-			{
-				pFontData.glyphArray.push_back( glyphData );
-			}
-		}
-
-		if( !fontData.glyphArray.empty() )
-		{
-			return false;
-		}
+		// Layers with glyphs already in the cache (preloaded ones) are initialized with the content of the cache.
+		// The remaining ones are filled at runtime, using the dirty regions reported by the cache.
+		const auto cxStaticSubTexturesNum = pGlyphCache.GetStats().cachedGlyphsNum > 0 ? pGlyphCache.GetLayersNum() : 0u;
+		const auto cxDynamicSubTexturesNum = pGlyphCache.GetLayersNum() - cxStaticSubTexturesNum;
+		const auto cxTotalSubTexturesNum = pGlyphCache.GetLayersNum();
 
-		for( auto codePoint1 : pFontCreateInfo.preloadGlyphSet )
-		{
-			for( auto codePoint2 : pFontCreateInfo.preloadGlyphSet )
-			{
-				CharKerningInfo kerningInfo{ { codePoint1, codePoint2 }, 0 };
-				if( pFTFontObject->loadKerning( kerningInfo.codePointPair, &( kerningInfo.kerningValue ) ) )
-				{
-					pFontData.charKerningArray.push_back( kerningInfo );
-				}
-			}
-		}
-
-		if( !fontData.charKerningArray.empty() )
-		{
-			fontData.charKerningArray.shrink_to_fit();
-		}
-
-		pFontData = std::move( fontData );
-
-		return true;
-	}
-
-	bool DynamicFontLoader::processFontInitData( FreeTypeFontObject * pFTFontObject, const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData )
-	{
-		// Size, in bytes, of a single pixel of a texture/glyph image.
-		const uint32 cxPixelByteSize = GCI::CXU::GetTextureFormatByteSize( pFontCreateInfo.fontDesc.textureFormat );
-
-		const auto cxTextureWidth = pFontCreateInfo.fontDesc.textureDimensions.x;  // Width of a single font texture, in pixels.
-		const auto cxTextureHeight = pFontCreateInfo.fontDesc.textureDimensions.y; // Height of a single font texture, in pixels.
-		const auto cxTextureRowPitch = cxTextureWidth * cxPixelByteSize;  // Size, in bytes, of a single pixel row of a texture.
-		const auto cxTextureSize = cxTextureHeight * cxTextureRowPitch;   // Size, in bytes, of a whole font texture.
-
-		RectAllocatorConfig textureLayerAllocatorConfig;
-		textureLayerAllocatorConfig.horizontalLayout.hSpacing = 2;
-		textureLayerAllocatorConfig.verticalLayout.vSpacing = 2;
-		textureLayerAllocatorConfig.verticalLayout.baseLineHeight = pFTFontObject->getLineHeight();
-
-		// Allocator for texture space. Allocates rectangular subregions of a bounding rectangle.
-		RectAllocator textureLayerAllocator{ pFontCreateInfo.fontDesc.textureDimensions, textureLayerAllocatorConfig };
-
-		// Pointer to the current layer we are inserting glyphs into. When a layer is full (i.e. the allocator
-		// fails to insert a new rect), we create a new one and reset the allocator to keep the process going.
-		auto * currentTextureLayer = static_cast<FTInternalFontData::TextureLayerInitData *>( nullptr );
-
-		for( auto & ftGlyphData : pFontData.glyphArray )
+		FontTextureCreateInfo textureCreateInfo;
+		textureCreateInfo.textureLayerInitDataArray.resize( cxStaticSubTexturesNum );
+		for( uint32 staticSubTextureIndex = 0; staticSubTextureIndex < cxStaticSubTexturesNum; ++staticSubTextureIndex )
 		{
-			if( ftGlyphData.glyphImage )
-			{
-				// ImageRef - describes where the glyph's image is located within its texture font.
-				auto & glyphImageRef = ftGlyphData.glyph.imageRef;
-
-				// Glyph image - the image itself (pointer to the data, information about size, row pitch, etc).
-				auto & glyphSourceImage = ftGlyphData.glyphImage;
-
-				if( !currentTextureLayer || !textureLayerAllocator.CheckFreeSpace( glyphSourceImage.dimensions ) )
-				{
-					// No space left in the current layer or no layer at all. Append a new layer...
-					pFontData.textureLayerInitDataArray.emplace_back();
-					// ...and reset the allocator.
-					textureLayerAllocator.Reset();
-
-					currentTextureLayer = &( pFontData.textureLayerInitDataArray.back() );
-					currentTextureLayer->layerIndex = cppx::numeric_cast<uint32>( pFontData.textureLayerInitDataArray.size() ) - 1;
-					currentTextureLayer->initDataBuffer.resize( cxTextureSize );
-					currentTextureLayer->initDataBuffer.fill( 0 );
-				}
-
-				cxm::vec2u32 glyphImageTextureOffset;
-				// This should never fail, because we already checked the available space (checkFreeSpace() above).
-				// If this assertion triggers, it means, that the current glyph is bigger than the texture rect itself.
-				if( !textureLayerAllocator.AddRect( glyphSourceImage.dimensions, &glyphImageTextureOffset ) )
-				{
-					return false;
-				}
-
-				// The offset of a top-left corner of a target rectangle allocated for the current glyph in the target texture.
-				const auto baseTargetPixelOffset = glyphImageTextureOffset.y * cxTextureWidth + glyphImageTextureOffset.x;
-				// Size, in bytes, of single row of a glyph's image.
-				const auto srcDataRowSize = glyphSourceImage.width * cxPixelByteSize;
-
-				for( uint32 imageRowIndex = 0; imageRowIndex < glyphSourceImage.height; ++imageRowIndex )
-				{
-					const auto srcByteOffset = imageRowIndex * glyphSourceImage.dataRowPitch;
-					const auto targetByteOffset = ( baseTargetPixelOffset + ( imageRowIndex * cxTextureWidth ) ) * cxPixelByteSize;
-					auto * targetBufferBtr = currentTextureLayer->initDataBuffer.data_offset( targetByteOffset );
-					cppx::mem_copy( targetBufferBtr, cxTextureSize, glyphSourceImage.data + srcByteOffset, srcDataRowSize );
-				}
-
-				glyphImageRef.imageIndex = currentTextureLayer->layerIndex;
-				glyphImageRef.rect.offset.x = static_cast<float>( glyphImageTextureOffset.x ) / cxTextureWidth;
-				glyphImageRef.rect.offset.y = static_cast<float>( glyphImageTextureOffset.y ) / cxTextureHeight;
-				glyphImageRef.rect.size.x = static_cast<float>( glyphSourceImage.dimensions.x ) / cxTextureWidth;
-				glyphImageRef.rect.size.y = static_cast<float>( glyphSourceImage.dimensions.y ) / cxTextureHeight;
-			}
-
-			pFontData.glyphMap[ftGlyphData.glyph.codePoint] = ftGlyphData.glyph;
+			auto & textureLayerInitData = textureCreateInfo.textureLayerInitDataArray[staticSubTextureIndex];
+			textureLayerInitData.layerIndex = staticSubTextureIndex;
+			textureLayerInitData.initDataBuffer.assign( pGlyphCache.GetLayerImageData( staticSubTextureIndex ) );
 		}
 
-		return true;
-	}
-
-	FontTextureCreateInfo DynamicFontLoader::setupTextureCreateInfo( const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData )
-	{
-		const auto cxStaticSubTexturesNum = cppx::numeric_cast<uint32>( pFontData.textureLayerInitDataArray.size() );
-		const auto cxDynamicSubTexturesNum = pFontCreateInfo.fontDesc.dynamicLayersNum;
-		const auto cxTotalSubTexturesNum = cxStaticSubTexturesNum + cxDynamicSubTexturesNum;
-
-		FontTextureCreateInfo textureCreateInfo;
-		textureCreateInfo.textureLayerInitDataArray = std::move( pFontData.textureLayerInitDataArray );
 		textureCreateInfo.gpuTextureCreateInfo.dimensions.depth = 1;
 		textureCreateInfo.gpuTextureCreateInfo.dimensions.mipLevelsNum = 1;
 		textureCreateInfo.gpuTextureCreateInfo.dimensions.width = pFontCreateInfo.fontDesc.textureDimensions.x;
@@ -220,7 +119,7 @@ namespace Ic3
 		textureCreateInfo.gpuTextureCreateInfo.msaaLevel = 0;
 		textureCreateInfo.gpuTextureCreateInfo.internalFormat = pFontCreateInfo.fontDesc.textureFormat;
 
-		if( cxDynamicSubTexturesNum == 0 )
+		if( pFontCreateInfo.fontDesc.dynamicLayersNum == 0 )
 		{
 			textureCreateInfo.gpuTextureCreateInfo.memoryFlags = GCI::eGPUMemoryAccessFlagGPUReadBit;
 			textureCreateInfo.gpuTextureCreateInfo.resourceFlags = GCI::eGPUResourceContentFlagStaticBit;
@@ -7,6 +7,8 @@
 #include "../Font.h"
 #include "../ResourceLoader.h"
 #include "FTDFreeTypeCommon.h"
+#include "FontDistanceField.h"
+#include "FTDGlyphCache.h"
 #include <cppx/byteArray.h>
 #include <cppx/platform/gds.h>
 
@@ -17,6 +19,13 @@ namespace Ic3
 	{
 		uint32 fixedLayersNum = 0;
 		uint32 dynamicLayersNum = 0;
+
+		/// Type of glyph images. With SignedDistanceField, fontSize is only the base size of the atlas:
+		/// the same font can be drawn at any size (textureFormat should then be a single-channel 8-bit one).
+		EFontGlyphImageType glyphImageType = EFontGlyphImageType::Coverage;
+
+		/// Parameters of distance field images, used only if glyphImageType is SignedDistanceField.
+		FontDistanceFieldDesc distanceFieldDesc;
 	};
 
 	struct DynamicFontCreateInfo
@@ -24,13 +33,39 @@ namespace Ic3
 		DynamicFontDesc fontDesc;
 		cppx::dynamic_byte_array binaryFontData;
 		cxm::vec2u32 fontResolutionHint;
+		/// Glyphs rasterized when the font is created. They are pinned in the glyph cache (never evicted).
+		/// All other glyphs are loaded on their first use.
 		std::vector<char_code_point_t> preloadGlyphSet;
+		/// Optional pool used to rasterize the preload set in parallel (the atlas is the same as without it).
+		WorkerThreadPool * threadPool = nullptr;
 	};
 
+	/// @brief Font rendered at runtime with FreeType. Glyphs and kerning are loaded on demand through
+	/// the DynamicFontGlyphCache. The texture budget is fixedLayersNum + dynamicLayersNum atlas layers.
 	class DynamicFont : public Font
 	{
 	public:
 		DynamicFontDesc const mFontDesc;
+
+	public:
+		DynamicFont( const DynamicFontDesc & pFontDesc, FreeTypeFontObject & pFTFontObject, const DynamicFontGlyphCacheCreateInfo & pGlyphCacheCreateInfo );
+		virtual ~DynamicFont();
+
+		virtual const FontGlyph * loadCharacterGlyph( char_code_point_t pCharCP ) override;
+
+		virtual char_kerning_value_t loadCharacterKerning( const CharCodePointPair & pCharCPPair ) override;
+
+		virtual void touchCharacterGlyphs( const char_code_point_t * pCharCPs, size_t pCharCPsNum ) override;
+
+		virtual uint64 getGlyphAtlasGeneration() const override;
+
+		DynamicFontGlyphCache & getGlyphCache()
+		{
+			return _glyphCache;
+		}
+
+	private:
+		DynamicFontGlyphCache _glyphCache;
 	};
 
 	class DynamicFontLoader : public ResourceLoader
@@ -38,17 +73,11 @@ namespace Ic3
 	public:
 		FontHandle createFont( const DynamicFontCreateInfo & pCreateInfo );
 
-	private:
-		struct FTInternalFontData;
+		FontTextureCreateInfo setupTextureCreateInfo( const DynamicFontCreateInfo & pFontCreateInfo, const DynamicFontGlyphCache & pGlyphCache );
 
+	private:
 		FreeTypeFontObject * createFreeTypeFontObject( const DynamicFontCreateInfo & pFontCreateInfo );
 
-		bool loadInternalFontData( FreeTypeFontObject * pFTFontObject, const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData );
-
-		bool processFontInitData( FreeTypeFontObject * pFTFontObject, const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData );
-
-		FontTextureCreateInfo setupTextureCreateInfo( const DynamicFontCreateInfo & pFontCreateInfo, FTInternalFontData & pFontData );
-
 	private:
 		struct FTFontLoaderPrivateData;
 		std::unique_ptr<FTFontLoaderPrivateData> _privateData;
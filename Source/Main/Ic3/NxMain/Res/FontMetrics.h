@@ -74,7 +74,9 @@ namespace Ic3
 		struct Metrics
 		{
 			cxm::vec2u32 advance;
-			cxm::vec2u32 bearing;
+			// Offset of the glyph's image from the pen position: x to its left edge, y from the baseline up to
+			// its top edge. Signed - glyphs may extend to the left of the pen (x < 0) or below the baseline (y < 0).
+			cxm::vec2i32 bearing;
 			cxm::vec2u32 dimensions;
 		};
 
@@ -0,0 +1,635 @@
+
+#include "FontTextLayout.h"
+#include <cppx/hash.h>
+#include <algorithm>
+#include <cstring>
+
+namespace Ic3
+{
+
+	namespace
+	{
+
+		constexpr char_code_point_t kTextReplacementCodePoint = 0xFFFD;
+
+		inline bool IsUTF8ContinuationByte( uint8 pByte )
+		{
+			return ( pByte & 0xC0 ) == 0x80;
+		}
+
+		inline bool IsTextLineBreakCodePoint( char_code_point_t pCodePoint )
+		{
+			return pCodePoint == '\n';
+		}
+
+		/// Code points after which a line can be broken. The spaces themselves are not drawn at the end of a line.
+		inline bool IsTextSpaceCodePoint( char_code_point_t pCodePoint )
+		{
+			return ( pCodePoint == ' ' ) || ( pCodePoint == '\t' ) || ( pCodePoint == 0x3000 );
+		}
+
+	}
+
+	TextLayoutEngine::TextLayoutEngine() = default;
+
+	TextLayoutEngine::~TextLayoutEngine() = default;
+
+	void TextLayoutEngine::LayoutText( Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc, TextLayoutRun & pOutRun )
+	{
+		pOutRun.glyphQuads.clear();
+		pOutRun.layerRanges.clear();
+		pOutRun.glyphCodePoints.clear();
+		pOutRun.boundsMin = { 0.0f, 0.0f };
+		pOutRun.boundsMax = { 0.0f, 0.0f };
+		pOutRun.linesNum = 0;
+
+		// Read before the glyphs are loaded: if loading evicts other glyphs, the run still gets the older value
+		// and will be laid out again next time, which is the safe direction.
+		pOutRun.atlasGeneration = pFont.getGlyphAtlasGeneration();
+
+		_codePointBuffer.clear();
+		DecodeUTF8( pText, pTextLength, _codePointBuffer );
+
+		const auto lineHeight = ( pLayoutDesc.lineHeight > 0.0f ) ? pLayoutDesc.lineHeight : static_cast<float>( pFont.mFontCommonDesc->fontSize );
+
+		ShapeGlyphs( pFont, pLayoutDesc );
+		BreakLines( pLayoutDesc );
+		EmitQuads( pLayoutDesc, lineHeight * pLayoutDesc.fontScale, pOutRun );
+
+		for( const auto & shapedGlyph : _shapedGlyphBuffer )
+		{
+			if( shapedGlyph.hasImage )
+			{
+				pOutRun.glyphCodePoints.push_back( shapedGlyph.codePoint );
+			}
+		}
+
+		std::sort( pOutRun.glyphCodePoints.begin(), pOutRun.glyphCodePoints.end() );
+		pOutRun.glyphCodePoints.erase( std::unique( pOutRun.glyphCodePoints.begin(), pOutRun.glyphCodePoints.end() ), pOutRun.glyphCodePoints.end() );
+	}
+
+	size_t TextLayoutEngine::DecodeUTF8( const char * pText, size_t pTextLength, std::vector<char_code_point_t> & pOutCodePoints )
+	{
+		const auto * inputBytes = reinterpret_cast<const uint8 *>( pText );
+		const auto outputBaseOffset = pOutCodePoints.size();
+
+		// Each byte produces at most one code point. The array is trimmed to the actual size at the end.
+		pOutCodePoints.resize( outputBaseOffset + pTextLength );
+		auto * outputCodePoints = pOutCodePoints.data() + outputBaseOffset;
+
+		size_t inputOffset = 0;
+		size_t outputOffset = 0;
+
+		while( inputOffset < pTextLength )
+		{
+		#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+			// ASCII fast path: 16 bytes without the high bit set are widened directly to 16 code points.
+			if( ( inputOffset + 16 <= pTextLength ) && ( inputBytes[inputOffset] < 0x80 ) )
+			{
+				const __m128i inputChunk = _mm_loadu_si128( reinterpret_cast<const __m128i *>( inputBytes + inputOffset ) );
+				if( _mm_movemask_epi8( inputChunk ) == 0 )
+				{
+					const __m128i zero = _mm_setzero_si128();
+					const __m128i chunkLow16 = _mm_unpacklo_epi8( inputChunk, zero );
+					const __m128i chunkHigh16 = _mm_unpackhi_epi8( inputChunk, zero );
+
+					auto * outputChunk = reinterpret_cast<__m128i *>( outputCodePoints + outputOffset );
+					_mm_storeu_si128( outputChunk + 0, _mm_unpacklo_epi16( chunkLow16, zero ) );
+					_mm_storeu_si128( outputChunk + 1, _mm_unpackhi_epi16( chunkLow16, zero ) );
+					_mm_storeu_si128( outputChunk + 2, _mm_unpacklo_epi16( chunkHigh16, zero ) );
+					_mm_storeu_si128( outputChunk + 3, _mm_unpackhi_epi16( chunkHigh16, zero ) );
+
+					inputOffset += 16;
+					outputOffset += 16;
+					continue;
+				}
+			}
+		#endif
+
+			const auto leadByte = inputBytes[inputOffset];
+
+			if( leadByte < 0x80 )
+			{
+				outputCodePoints[outputOffset++] = leadByte;
+				inputOffset += 1;
+				continue;
+			}
+
+			// Length of the sequence and the valid range of the second byte (which excludes overlong forms,
+			// surrogates and values above U+10FFFF). Invalid lead bytes have length 0.
+			uint32 sequenceLength = 0;
+			uint8 secondByteMin = 0x80;
+			uint8 secondByteMax = 0xBF;
+
+			if( ( leadByte >= 0xC2 ) && ( leadByte <= 0xDF ) )
+			{
+				sequenceLength = 2;
+			}
+			else if( ( leadByte >= 0xE0 ) && ( leadByte <= 0xEF ) )
+			{
+				sequenceLength = 3;
+				secondByteMin = ( leadByte == 0xE0 ) ? 0xA0 : 0x80;
+				secondByteMax = ( leadByte == 0xED ) ? 0x9F : 0xBF;
+			}
+			else if( ( leadByte >= 0xF0 ) && ( leadByte <= 0xF4 ) )
+			{
+				sequenceLength = 4;
+				secondByteMin = ( leadByte == 0xF0 ) ? 0x90 : 0x80;
+				secondByteMax = ( leadByte == 0xF4 ) ? 0x8F : 0xBF;
+			}
+
+			bool sequenceValid = ( sequenceLength > 0 ) && ( inputOffset + sequenceLength <= pTextLength );
+			if( sequenceValid )
+			{
+				const auto secondByte = inputBytes[inputOffset + 1];
+				sequenceValid = ( secondByte >= secondByteMin ) && ( secondByte <= secondByteMax );
+
+				for( uint32 byteIndex = 2; sequenceValid && ( byteIndex < sequenceLength ); ++byteIndex )
+				{
+					sequenceValid = IsUTF8ContinuationByte( inputBytes[inputOffset + byteIndex] );
+				}
+			}
+
+			if( !sequenceValid )
+			{
+				// Only the lead byte is skipped, so a valid sequence following a truncated one is not lost.
+				outputCodePoints[outputOffset++] = kTextReplacementCodePoint;
+				inputOffset += 1;
+				continue;
+			}
+
+			char_code_point_t codePoint = leadByte & ( 0x7F >> sequenceLength );
+			for( uint32 byteIndex = 1; byteIndex < sequenceLength; ++byteIndex )
+			{
+				codePoint = ( codePoint << 6 ) | ( inputBytes[inputOffset + byteIndex] & 0x3F );
+			}
+
+			outputCodePoints[outputOffset++] = codePoint;
+			inputOffset += sequenceLength;
+		}
+
+		pOutCodePoints.resize( outputBaseOffset + outputOffset );
+
+		return outputOffset;
+	}
+
+	void TextLayoutEngine::GenerateGlyphVertices( const TextGlyphQuad * pQuads, size_t pQuadsNum, const cxm::vec2f & pOffset, TextGlyphVertex * pOutVertices )
+	{
+		static_assert( sizeof( TextGlyphVertex ) == 4 * sizeof( float ), "TextGlyphVertex is expected to be a packed float4." );
+
+		auto * outputVertexData = reinterpret_cast<float *>( pOutVertices );
+
+	#if( PCL_EIS_SUPPORT_LEVEL & PCL_EIS_FEATURE_SSE2 )
+		// Each vertex is exactly one float4 (position, texCoord). For a quad (x, y, w, h) + (u0, v0, u1, v1):
+		// TL = (x, y, u0, v0), TR = (x+w, y, u1, v0), BL = (x, y+h, u0, v1), BR = (x+w, y+h, u1, v1).
+		const __m128 offset = _mm_set_ps( 0.0f, 0.0f, pOffset.y, pOffset.x );
+
+		for( size_t quadIndex = 0; quadIndex < pQuadsNum; ++quadIndex )
+		{
+			const auto & quad = pQuads[quadIndex];
+
+			const __m128 rectMin = _mm_add_ps( _mm_loadu_ps( quad.rect.values ), offset );
+			const __m128 rectMax = _mm_add_ps( rectMin, _mm_movehl_ps( rectMin, rectMin ) );
+			const __m128 texRect = _mm_loadu_ps( quad.texRect.values );
+
+			const __m128 maxXMinX = _mm_unpacklo_ps( rectMax, rectMin );
+			const __m128 minXMaxX = _mm_unpacklo_ps( rectMin, rectMax );
+
+			auto * quadVertexData = outputVertexData + quadIndex * 16;
+			_mm_storeu_ps( quadVertexData + 0, _mm_movelh_ps( rectMin, texRect ) );
+			_mm_storeu_ps( quadVertexData + 4, _mm_shuffle_ps( maxXMinX, texRect, _MM_SHUFFLE( 1, 2, 3, 0 ) ) );
+			_mm_storeu_ps( quadVertexData + 8, _mm_shuffle_ps( minXMaxX, texRect, _MM_SHUFFLE( 3, 0, 3, 0 ) ) );
+			_mm_storeu_ps( quadVertexData + 12, _mm_movelh_ps( rectMax, _mm_movehl_ps( texRect, texRect ) ) );
+		}
+	#else
+		for( size_t quadIndex = 0; quadIndex < pQuadsNum; ++quadIndex )
+		{
+			const auto & quad = pQuads[quadIndex];
+
+			const float minX = quad.rect.x + pOffset.x;
+			const float minY = quad.rect.y + pOffset.y;
+			const float maxX = minX + quad.rect.z;
+			const float maxY = minY + quad.rect.w;
+
+			const float quadVertexValues[16] = {
+				minX, minY, quad.texRect.x, quad.texRect.y,
+				maxX, minY, quad.texRect.z, quad.texRect.y,
+				minX, maxY, quad.texRect.x, quad.texRect.w,
+				maxX, maxY, quad.texRect.z, quad.texRect.w };
+
+			cppx::mem_copy( outputVertexData + quadIndex * 16, 16, quadVertexValues, 16 );
+		}
+	#endif
+	}
+
+	void TextLayoutEngine::ShapeGlyphs( Font & pFont, const TextLayoutDesc & pLayoutDesc )
+	{
+		const auto fontScale = pLayoutDesc.fontScale;
+		const auto imagePadding = pLayoutDesc.glyphImagePadding;
+
+		_shapedGlyphBuffer.clear();
+		_shapedGlyphBuffer.reserve( _codePointBuffer.size() );
+
+		char_code_point_t previousCodePoint = 0;
+
+		for( const auto codePoint : _codePointBuffer )
+		{
+			if( codePoint == '\r' )
+			{
+				continue;
+			}
+
+			ShapedGlyph shapedGlyph{};
+			shapedGlyph.codePoint = codePoint;
+
+			if( IsTextLineBreakCodePoint( codePoint ) )
+			{
+				// No kerning across lines.
+				_shapedGlyphBuffer.push_back( shapedGlyph );
+				previousCodePoint = 0;
+				continue;
+			}
+
+			// The glyph is copied right away: pointers returned by dynamic fonts are valid only for the current frame.
+			const auto * fontGlyph = pFont.loadCharacterGlyph( codePoint );
+			if( !fontGlyph )
+			{
+				// Glyphs missing from the font are skipped (and break the kerning chain).
+				previousCodePoint = 0;
+				continue;
+			}
+
+			if( previousCodePoint != 0 )
+			{
+				shapedGlyph.kerning = static_cast<float>( pFont.loadCharacterKerning( { previousCodePoint, codePoint } ) ) * fontScale;
+			}
+
+			const auto & glyphMetrics = fontGlyph->metrics;
+			const auto & glyphImageRect = fontGlyph->imageRef.rect;
+
+			shapedGlyph.advance = static_cast<float>( glyphMetrics.advance.x ) * fontScale;
+			shapedGlyph.hasImage = ( glyphImageRect.size.x > 0.0f ) && ( glyphImageRect.size.y > 0.0f );
+
+			if( shapedGlyph.hasImage )
+			{
+				shapedGlyph.rect = cxm::vec4f{
+					( static_cast<float>( glyphMetrics.bearing.x ) - imagePadding ) * fontScale,
+					( -static_cast<float>( glyphMetrics.bearing.y ) - imagePadding ) * fontScale,
+					( static_cast<float>( glyphMetrics.dimensions.x ) + 2.0f * imagePadding ) * fontScale,
+					( static_cast<float>( glyphMetrics.dimensions.y ) + 2.0f * imagePadding ) * fontScale };
+				shapedGlyph.texRect = cxm::vec4f{
+					glyphImageRect.offset.x,
+					glyphImageRect.offset.y,
+					glyphImageRect.offset.x + glyphImageRect.size.x,
+					glyphImageRect.offset.y + glyphImageRect.size.y };
+				shapedGlyph.layerIndex = fontGlyph->imageRef.imageIndex;
+			}
+
+			_shapedGlyphBuffer.push_back( shapedGlyph );
+			previousCodePoint = codePoint;
+		}
+	}
+
+	void TextLayoutEngine::BreakLines( const TextLayoutDesc & pLayoutDesc )
+	{
+		_lineBuffer.clear();
+
+		const auto shapedGlyphsNum = static_cast<uint32>( _shapedGlyphBuffer.size() );
+		const auto wrappingEnabled = pLayoutDesc.maxLineWidth > 0.0f;
+
+		uint32 lineBeginIndex = 0;
+		// Index of the first glyph after the last run of spaces in the current line (where the line can be broken).
+		uint32 lineBreakIndex = 0;
+		float penPositionX = 0.0f;
+
+		const auto appendLine = [this]( uint32 pBeginIndex, uint32 pEndIndex ) {
+			_lineBuffer.push_back( LineRange{ pBeginIndex, pEndIndex - pBeginIndex, MeasureGlyphs( pBeginIndex, pEndIndex - pBeginIndex, true ) } );
+		};
+
+		for( uint32 glyphIndex = 0; glyphIndex < shapedGlyphsNum; ++glyphIndex )
+		{
+			const auto & shapedGlyph = _shapedGlyphBuffer[glyphIndex];
+
+			if( IsTextLineBreakCodePoint( shapedGlyph.codePoint ) )
+			{
+				appendLine( lineBeginIndex, glyphIndex );
+				lineBeginIndex = glyphIndex + 1;
+				lineBreakIndex = lineBeginIndex;
+				penPositionX = 0.0f;
+				continue;
+			}
+
+			const auto isSpace = IsTextSpaceCodePoint( shapedGlyph.codePoint );
+			auto glyphPositionX = penPositionX + ( ( glyphIndex > lineBeginIndex ) ? shapedGlyph.kerning : 0.0f );
+
+			if( wrappingEnabled && !isSpace && ( glyphIndex > lineBeginIndex ) && ( glyphPositionX + shapedGlyph.advance > pLayoutDesc.maxLineWidth ) )
+			{
+				if( lineBreakIndex > lineBeginIndex )
+				{
+					// Break after the last spaces. The part of the current word already processed moves to the new line.
+					appendLine( lineBeginIndex, lineBreakIndex );
+					lineBeginIndex = lineBreakIndex;
+					penPositionX = MeasureGlyphs( lineBeginIndex, glyphIndex - lineBeginIndex, false );
+				}
+				else
+				{
+					// A single word longer than the line: break between characters.
+					appendLine( lineBeginIndex, glyphIndex );
+					lineBeginIndex = glyphIndex;
+					penPositionX = 0.0f;
+				}
+
+				lineBreakIndex = lineBeginIndex;
+				glyphPositionX = penPositionX + ( ( glyphIndex > lineBeginIndex ) ? shapedGlyph.kerning : 0.0f );
+			}
+
+			penPositionX = glyphPositionX + shapedGlyph.advance;
+
+			if( isSpace )
+			{
+				lineBreakIndex = glyphIndex + 1;
+			}
+		}
+
+		appendLine( lineBeginIndex, shapedGlyphsNum );
+	}
+
+	void TextLayoutEngine::EmitQuads( const TextLayoutDesc & pLayoutDesc, float pLineHeight, TextLayoutRun & pOutRun )
+	{
+		float alignmentWidth = pLayoutDesc.maxLineWidth;
+		if( alignmentWidth <= 0.0f )
+		{
+			for( const auto & lineRange : _lineBuffer )
+			{
+				alignmentWidth = cppx::get_max_of( alignmentWidth, lineRange.width );
+			}
+		}
+
+		// Quads are counted per layer first, so they can be written directly into their groups.
+		_layerQuadCountBuffer.clear();
+		uint32 quadsNum = 0;
+
+		for( const auto & shapedGlyph : _shapedGlyphBuffer )
+		{
+			if( shapedGlyph.hasImage )
+			{
+				if( shapedGlyph.layerIndex >= _layerQuadCountBuffer.size() )
+				{
+					_layerQuadCountBuffer.resize( shapedGlyph.layerIndex + 1, 0 );
+				}
+				++_layerQuadCountBuffer[shapedGlyph.layerIndex];
+				++quadsNum;
+			}
+		}
+
+		uint32 quadsOffset = 0;
+		for( uint32 layerIndex = 0; layerIndex < _layerQuadCountBuffer.size(); ++layerIndex )
+		{
+			const auto layerQuadsNum = _layerQuadCountBuffer[layerIndex];
+			if( layerQuadsNum > 0 )
+			{
+				pOutRun.layerRanges.push_back( TextLayoutLayerRange{ layerIndex, quadsOffset, layerQuadsNum } );
+				// From now on, the buffer holds the write position of each layer.
+				_layerQuadCountBuffer[layerIndex] = quadsOffset;
+				quadsOffset += layerQuadsNum;
+			}
+		}
+
+		pOutRun.glyphQuads.resize( quadsNum );
+		pOutRun.linesNum = static_cast<uint32>( _lineBuffer.size() );
+
+		cxm::vec2f boundsMin{ cppx::meta::limits<float>::max_value, cppx::meta::limits<float>::max_value };
+		cxm::vec2f boundsMax{ -cppx::meta::limits<float>::max_value, -cppx::meta::limits<float>::max_value };
+
+		for( uint32 lineIndex = 0; lineIndex < _lineBuffer.size(); ++lineIndex )
+		{
+			const auto & lineRange = _lineBuffer[lineIndex];
+
+			float penPositionX = 0.0f;
+			if( pLayoutDesc.alignment == ETextAlignment::Center )
+			{
+				penPositionX = ( alignmentWidth - lineRange.width ) * 0.5f;
+			}
+			else if( pLayoutDesc.alignment == ETextAlignment::Right )
+			{
+				penPositionX = alignmentWidth - lineRange.width;
+			}
+
+			const auto baselinePositionY = static_cast<float>( lineIndex ) * pLineHeight;
+
+			for( uint32 glyphIndex = 0; glyphIndex < lineRange.glyphsNum; ++glyphIndex )
+			{
+				const auto & shapedGlyph = _shapedGlyphBuffer[lineRange.glyphsOffset + glyphIndex];
+
+				if( glyphIndex > 0 )
+				{
+					penPositionX += shapedGlyph.kerning;
+				}
+
+				if( shapedGlyph.hasImage )
+				{
+					auto & glyphQuad = pOutRun.glyphQuads[_layerQuadCountBuffer[shapedGlyph.layerIndex]++];
+					glyphQuad.rect = cxm::vec4f{
+						penPositionX + shapedGlyph.rect.x,
+						baselinePositionY + shapedGlyph.rect.y,
+						shapedGlyph.rect.z,
+						shapedGlyph.rect.w };
+					glyphQuad.texRect = shapedGlyph.texRect;
+
+					boundsMin.x = cppx::get_min_of( boundsMin.x, glyphQuad.rect.x );
+					boundsMin.y = cppx::get_min_of( boundsMin.y, glyphQuad.rect.y );
+					boundsMax.x = cppx::get_max_of( boundsMax.x, glyphQuad.rect.x + glyphQuad.rect.z );
+					boundsMax.y = cppx::get_max_of( boundsMax.y, glyphQuad.rect.y + glyphQuad.rect.w );
+				}
+
+				penPositionX += shapedGlyph.advance;
+			}
+		}
+
+		if( quadsNum > 0 )
+		{
+			pOutRun.boundsMin = boundsMin;
+			pOutRun.boundsMax = boundsMax;
+		}
+	}
+
+	float TextLayoutEngine::MeasureGlyphs( uint32 pGlyphsOffset, uint32 pGlyphsNum, bool pSkipTrailingSpaces ) const
+	{
+		if( pSkipTrailingSpaces )
+		{
+			while( ( pGlyphsNum > 0 ) && IsTextSpaceCodePoint( _shapedGlyphBuffer[pGlyphsOffset + pGlyphsNum - 1].codePoint ) )
+			{
+				--pGlyphsNum;
+			}
+		}
+
+		float width = 0.0f;
+		for( uint32 glyphIndex = 0; glyphIndex < pGlyphsNum; ++glyphIndex )
+		{
+			const auto & shapedGlyph = _shapedGlyphBuffer[pGlyphsOffset + glyphIndex];
+			width += ( glyphIndex > 0 ) ? ( shapedGlyph.kerning + shapedGlyph.advance ) : shapedGlyph.advance;
+		}
+
+		return width;
+	}
+
+
+	TextGlyphBatch::TextGlyphBatch() = default;
+
+	TextGlyphBatch::~TextGlyphBatch() = default;
+
+	void TextGlyphBatch::AddRun( const TextLayoutRun & pRun, const cxm::vec2f & pPosition )
+	{
+		for( const auto & layerRange : pRun.layerRanges )
+		{
+			if( layerRange.layerIndex >= _layerArray.size() )
+			{
+				_layerArray.resize( layerRange.layerIndex + 1 );
+			}
+
+			auto & batchLayer = _layerArray[layerRange.layerIndex];
+
+			const auto requiredVerticesNum = batchLayer.verticesNum + layerRange.quadsNum * 4;
+			if( requiredVerticesNum > batchLayer.vertexData.size() )
+			{
+				// Geometric growth: batches are refilled every frame, so they should reach their final size quickly.
+				batchLayer.vertexData.resize( cppx::get_max_of<size_t>( requiredVerticesNum, batchLayer.vertexData.size() * 2 ) );
+			}
+
+			TextLayoutEngine::GenerateGlyphVertices(
+				pRun.glyphQuads.data() + layerRange.quadsOffset,
+				layerRange.quadsNum,
+				pPosition,
+				batchLayer.vertexData.data() + batchLayer.verticesNum );
+
+			batchLayer.verticesNum = requiredVerticesNum;
+			_quadsNum += layerRange.quadsNum;
+		}
+	}
+
+	void TextGlyphBatch::Reset()
+	{
+		for( auto & batchLayer : _layerArray )
+		{
+			batchLayer.verticesNum = 0;
+		}
+
+		_quadsNum = 0;
+	}
+
+	uint32 TextGlyphBatch::GetDrawsNum() const noexcept
+	{
+		uint32 drawsNum = 0;
+		for( const auto & batchLayer : _layerArray )
+		{
+			if( batchLayer.verticesNum > 0 )
+			{
+				++drawsNum;
+			}
+		}
+		return drawsNum;
+	}
+
+	void TextGlyphBatch::GenerateQuadIndices( uint32 pQuadsNum, std::vector<uint32> & pOutIndices )
+	{
+		pOutIndices.resize( static_cast<size_t>( pQuadsNum ) * 6 );
+
+		for( uint32 quadIndex = 0; quadIndex < pQuadsNum; ++quadIndex )
+		{
+			const auto baseVertexIndex = quadIndex * 4;
+			auto * quadIndices = pOutIndices.data() + quadIndex * 6;
+			quadIndices[0] = baseVertexIndex + 0;
+			quadIndices[1] = baseVertexIndex + 1;
+			quadIndices[2] = baseVertexIndex + 2;
+			quadIndices[3] = baseVertexIndex + 2;
+			quadIndices[4] = baseVertexIndex + 1;
+			quadIndices[5] = baseVertexIndex + 3;
+		}
+	}
+
+
+	TextLayoutCache::TextLayoutCache() = default;
+
+	TextLayoutCache::~TextLayoutCache() = default;
+
+	const TextLayoutRun & TextLayoutCache::GetRun( Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc )
+	{
+		const auto runKey = ComputeRunKey( pFont, pText, pTextLength, pLayoutDesc );
+
+		auto & cachedRun = _runMap[runKey];
+		cachedRun.used = true;
+
+		const auto keyMatches =
+			( cachedRun.font == &pFont ) &&
+			( cachedRun.text.length() == pTextLength ) &&
+			( cachedRun.text.compare( 0, pTextLength, pText, pTextLength ) == 0 ) &&
+			( std::memcmp( &( cachedRun.layoutDesc ), &pLayoutDesc, sizeof( TextLayoutDesc ) ) == 0 );
+
+		if( keyMatches )
+		{
+			if( cachedRun.run.atlasGeneration == pFont.getGlyphAtlasGeneration() )
+			{
+				// The quads are drawn this frame, so their glyphs must not be evicted (and their atlas area overwritten)
+				// by glyphs loaded for other runs later in the frame.
+				pFont.touchCharacterGlyphs( cachedRun.run.glyphCodePoints.data(), cachedRun.run.glyphCodePoints.size() );
+
+				++_stats.runHitsNum;
+				return cachedRun.run;
+			}
+
+			++_stats.runInvalidationsNum;
+		}
+		else
+		{
+			// Either a new entry or (very unlikely) a hash collision - in both cases the entry is overwritten.
+			if( !cachedRun.font )
+			{
+				++_stats.cachedRunsNum;
+			}
+
+			cachedRun.font = &pFont;
+			cachedRun.text.assign( pText, pTextLength );
+			cachedRun.layoutDesc = pLayoutDesc;
+			++_stats.runMissesNum;
+		}
+
+		_layoutEngine.LayoutText( pFont, pText, pTextLength, pLayoutDesc, cachedRun.run );
+
+		return cachedRun.run;
+	}
+
+	void TextLayoutCache::RemoveUnusedRuns()
+	{
+		for( auto runIter = _runMap.begin(); runIter != _runMap.end(); )
+		{
+			if( !runIter->second.used )
+			{
+				runIter = _runMap.erase( runIter );
+				--_stats.cachedRunsNum;
+			}
+			else
+			{
+				runIter->second.used = false;
+				++runIter;
+			}
+		}
+	}
+
+	void TextLayoutCache::Clear()
+	{
+		_runMap.clear();
+		_stats.cachedRunsNum = 0;
+	}
+
+	uint64 TextLayoutCache::ComputeRunKey( const Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc )
+	{
+		// Fonts are identified by their address. TextLayoutDesc has no padding, so it is hashed (and compared) as raw bytes.
+		// Pointers are passed as const void *, otherwise they would be hashed as values (or as C-strings).
+		auto runKeyHash = cppx::hash_compute<cppx::hash_algo::fnv1a64>( static_cast<const void *>( pText ), pTextLength );
+		runKeyHash = cppx::hash_compute_ex<cppx::hash_algo::fnv1a64>( runKeyHash, reinterpret_cast<uintptr_t>( &pFont ) );
+		runKeyHash = cppx::hash_compute_ex<cppx::hash_algo::fnv1a64>( runKeyHash, static_cast<const void *>( &pLayoutDesc ), sizeof( TextLayoutDesc ) );
+
+		return runKeyHash;
+	}
+
+} // namespace Ic3
@@ -0,0 +1,254 @@
+
+#pragma once
+
+#ifndef __IC3_NXMAIN_RES_FONT_TEXT_LAYOUT_H__
+#define __IC3_NXMAIN_RES_FONT_TEXT_LAYOUT_H__
+
+#include "Font.h"
+#include <unordered_map>
+
+namespace Ic3
+{
+
+	enum class ETextAlignment : uint32
+	{
+		Left,
+		Center,
+		Right,
+	};
+
+	struct TextLayoutDesc
+	{
+		/// Scale applied to all font metrics (target size / font size). Values other than 1.0 give good results only
+		/// with distance field fonts (see EFontGlyphImageType).
+		float fontScale = 1.0f;
+
+		/// Distance between baselines of consecutive lines, in font pixels. 0 uses the size of the font.
+		float lineHeight = 0.0f;
+
+		/// Maximum width of a line, in target pixels. Longer lines are broken after the last space which fits
+		/// (or between characters, if a single word is longer than the whole line). 0 disables wrapping.
+		float maxLineWidth = 0.0f;
+
+		/// Empty space around each glyph image, in font pixels: the spread of distance field fonts, 0 otherwise.
+		float glyphImagePadding = 0.0f;
+
+		/// Alignment of lines within maxLineWidth (or within the widest line, if wrapping is disabled).
+		ETextAlignment alignment = ETextAlignment::Left;
+	};
+
+	/// @brief A glyph placed by the layout: a rectangle relative to the origin of the text and its atlas sub-rectangle.
+	struct TextGlyphQuad
+	{
+		/// Position of the top-left corner (x, y) and size (z, w). Y axis points down.
+		cxm::vec4f rect;
+
+		/// Texture coordinates of the top-left (x, y) and bottom-right (z, w) corners.
+		cxm::vec4f texRect;
+	};
+
+	/// @brief Vertex of a glyph quad. Four vertices per quad: top-left, top-right, bottom-left, bottom-right.
+	struct TextGlyphVertex
+	{
+		cxm::vec2f position;
+		cxm::vec2f texCoord;
+	};
+
+	struct TextLayoutLayerRange
+	{
+		uint32 layerIndex;
+		uint32 quadsOffset;
+		uint32 quadsNum;
+	};
+
+	/// @brief Result of a text layout (a "shaped run"). The origin is on the baseline of the first line, at the left
+	/// edge of the layout box. Quads are grouped by the atlas layer of their glyphs (see layerRanges), so a run can be
+	/// appended to a TextGlyphBatch with a single contiguous pass per layer.
+	struct TextLayoutRun
+	{
+		std::vector<TextGlyphQuad> glyphQuads;
+
+		std::vector<TextLayoutLayerRange> layerRanges;
+
+		/// Bounding box of all quads, relative to the origin.
+		cxm::vec2f boundsMin = { 0.0f, 0.0f };
+		cxm::vec2f boundsMax = { 0.0f, 0.0f };
+
+		uint32 linesNum = 0;
+
+		/// Code points of all glyphs with an image in the run (each one once). Marked as used whenever a cached run
+		/// is reused (see Font::touchCharacterGlyphs()), so a dynamic font does not evict them while they are drawn.
+		std::vector<char_code_point_t> glyphCodePoints;
+
+		/// Value of Font::getGlyphAtlasGeneration() at the time of the layout. If it no longer matches, texture
+		/// coordinates of the quads may be invalid and the text has to be laid out again.
+		uint64 atlasGeneration = 0;
+	};
+
+	/// @brief Turns UTF-8 text into positioned glyph quads: decodes the text, applies kerning, breaks lines and
+	/// aligns them. Glyphs are requested with Font::loadCharacterGlyph(), so a dynamic font loads missing glyphs
+	/// on the way. Scratch buffers are reused between calls - use one engine per thread.
+	class TextLayoutEngine
+	{
+	public:
+		TextLayoutEngine();
+		~TextLayoutEngine();
+
+		void LayoutText( Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc, TextLayoutRun & pOutRun );
+
+		void LayoutText( Font & pFont, const std::string & pText, const TextLayoutDesc & pLayoutDesc, TextLayoutRun & pOutRun )
+		{
+			LayoutText( pFont, pText.data(), pText.length(), pLayoutDesc, pOutRun );
+		}
+
+		/// @brief Decodes UTF-8 text, appending code points to pOutCodePoints. Invalid sequences (including overlong
+		/// encodings and surrogates) are replaced with U+FFFD. Returns the number of decoded code points.
+		static size_t DecodeUTF8( const char * pText, size_t pTextLength, std::vector<char_code_point_t> & pOutCodePoints );
+
+		/// @brief Writes four vertices for each quad, translated by pOffset. pOutVertices must have space for 4 * pQuadsNum vertices.
+		static void GenerateGlyphVertices( const TextGlyphQuad * pQuads, size_t pQuadsNum, const cxm::vec2f & pOffset, TextGlyphVertex * pOutVertices );
+
+	private:
+		struct ShapedGlyph
+		{
+			char_code_point_t codePoint;
+			// Kerning with the previous glyph and the advance, both in target pixels.
+			float kerning;
+			float advance;
+			// Quad rect relative to the pen position on the baseline.
+			cxm::vec4f rect;
+			cxm::vec4f texRect;
+			uint32 layerIndex;
+			bool hasImage;
+		};
+
+		struct LineRange
+		{
+			uint32 glyphsOffset;
+			uint32 glyphsNum;
+			float width;
+		};
+
+		void ShapeGlyphs( Font & pFont, const TextLayoutDesc & pLayoutDesc );
+
+		void BreakLines( const TextLayoutDesc & pLayoutDesc );
+
+		void EmitQuads( const TextLayoutDesc & pLayoutDesc, float pLineHeight, TextLayoutRun & pOutRun );
+
+		float MeasureGlyphs( uint32 pGlyphsOffset, uint32 pGlyphsNum, bool pSkipTrailingSpaces ) const;
+
+	private:
+		std::vector<char_code_point_t> _codePointBuffer;
+		std::vector<ShapedGlyph> _shapedGlyphBuffer;
+		std::vector<LineRange> _lineBuffer;
+		std::vector<uint32> _layerQuadCountBuffer;
+	};
+
+	struct TextGlyphBatchLayer
+	{
+		/// Vertex data of the layer. Only the first verticesNum elements are valid (the array is never shrunk).
+		std::vector<TextGlyphVertex> vertexData;
+		uint32 verticesNum = 0;
+	};
+
+	/// @brief Reusable vertex storage for glyph quads, with a separate vertex array per atlas layer. Any number of
+	/// runs (e.g. all labels of a HUD) added to a batch is drawn with one draw call per non-empty layer, using the
+	/// quad index pattern from GenerateQuadIndices().
+	class TextGlyphBatch
+	{
+	public:
+		TextGlyphBatch();
+		~TextGlyphBatch();
+
+		/// @brief Appends all quads of the run, translated by pPosition.
+		void AddRun( const TextLayoutRun & pRun, const cxm::vec2f & pPosition );
+
+		/// @brief Removes all vertices. Allocated memory is kept for the next frame.
+		void Reset();
+
+		CPPX_ATTR_NO_DISCARD const TextGlyphBatchLayer & GetLayer( uint32 pLayerIndex ) const noexcept
+		{
+			return _layerArray[pLayerIndex];
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetLayersNum() const noexcept
+		{
+			return static_cast<uint32>( _layerArray.size() );
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetQuadsNum() const noexcept
+		{
+			return _quadsNum;
+		}
+
+		/// @brief Returns the number of draw calls needed for the batch (number of layers with any quads).
+		CPPX_ATTR_NO_DISCARD uint32 GetDrawsNum() const noexcept;
+
+		/// @brief Generates indices (two triangles: 0-1-2, 2-1-3) for pQuadsNum quads. Can be stored once in an index
+		/// buffer large enough for the biggest layer and shared by all batches.
+		static void GenerateQuadIndices( uint32 pQuadsNum, std::vector<uint32> & pOutIndices );
+
+	private:
+		std::vector<TextGlyphBatchLayer> _layerArray;
+		uint32 _quadsNum = 0;
+	};
+
+	struct TextLayoutCacheStats
+	{
+		uint64 runHitsNum = 0;
+		uint64 runMissesNum = 0;
+		/// Runs laid out again because the atlas of their font has changed.
+		uint64 runInvalidationsNum = 0;
+		uint32 cachedRunsNum = 0;
+	};
+
+	/// @brief Cache of laid out static text. Requesting a run which has not changed since the previous frame costs
+	/// a hash of the text and a lookup, so the per-frame work for thousands of static labels is reduced to copying
+	/// their quads into a TextGlyphBatch. Glyphs of a reused run are marked as used in the font, exactly like during
+	/// the layout. Runs are laid out again when the glyph atlas of their font changes.
+	class TextLayoutCache
+	{
+	public:
+		TextLayoutCache();
+		~TextLayoutCache();
+
+		/// @brief Returns the layout of the text, laying it out first if it is not in the cache or is no longer valid.
+		/// The reference stays valid until the run is removed from the cache (see RemoveUnusedRuns() and Clear()).
+		const TextLayoutRun & GetRun( Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc );
+
+		const TextLayoutRun & GetRun( Font & pFont, const std::string & pText, const TextLayoutDesc & pLayoutDesc )
+		{
+			return GetRun( pFont, pText.data(), pText.length(), pLayoutDesc );
+		}
+
+		/// @brief Removes runs which have not been requested since the previous call of this method.
+		void RemoveUnusedRuns();
+
+		void Clear();
+
+		CPPX_ATTR_NO_DISCARD const TextLayoutCacheStats & GetStats() const noexcept
+		{
+			return _stats;
+		}
+
+	private:
+		struct CachedRun
+		{
+			const Font * font = nullptr;
+			std::string text;
+			TextLayoutDesc layoutDesc;
+			TextLayoutRun run;
+			bool used = false;
+		};
+
+		static uint64 ComputeRunKey( const Font & pFont, const char * pText, size_t pTextLength, const TextLayoutDesc & pLayoutDesc );
+
+	private:
+		TextLayoutEngine _layoutEngine;
+		std::unordered_map<uint64, CachedRun> _runMap;
+		TextLayoutCacheStats _stats;
+	};
+
+} // namespace Ic3
+
+#endif // __IC3_NXMAIN_RES_FONT_TEXT_LAYOUT_H__
@@ -5,7 +5,7 @@
 #define __IC3_NXMAIN_SCF_INDEX_H__
 
 #include "scfEntry.h"
-#include <unordered_map>
+#include <cppx/flatHashMap.h>
 
 namespace Ic3
 {
@@ -53,7 +53,7 @@ namespace Ic3
 	private:
 		ResourceDataReadCallback _rdReadCallback;
 		std::unique_ptr<SCFVirtualFolder> _rootFolder;
-		std::unordered_map<std::string, SCFEntry *> _entryByUIDMap;
+		cppx::flat_hash_str_map<std::string, SCFEntry *> _entryByUIDMap;
 	};
 
 } // namespace Ic3
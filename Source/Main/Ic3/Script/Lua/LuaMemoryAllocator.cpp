@@ -0,0 +1,244 @@
+
+#include "LuaMemoryAllocator.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace Ic3::Script
+{
+
+	LuaMemoryAllocator::~LuaMemoryAllocator()
+	{
+		releaseMemory();
+	}
+
+	void * LuaMemoryAllocator::luaAlloc( void * pUserData, void * pPtr, size_t pOldSize, size_t pNewSize )
+	{
+		return reinterpret_cast<LuaMemoryAllocator *>( pUserData )->reallocate( pPtr, pOldSize, pNewSize );
+	}
+
+	void * LuaMemoryAllocator::reallocate( void * pPtr, size_t pOldSize, size_t pNewSize )
+	{
+		if( !pPtr )
+		{
+			// For new blocks Lua passes the type of the object in pOldSize, not a size.
+			pOldSize = 0;
+		}
+
+		if( pNewSize == 0 )
+		{
+			if( pPtr )
+			{
+				if( isPooledSize( pOldSize ) )
+				{
+					freePooledBlock( pPtr, getSizeClassIndex( pOldSize ) );
+				}
+				else
+				{
+					std::free( pPtr );
+					_largeBlocksBytes -= pOldSize;
+				}
+				_allocatedBytes -= pOldSize;
+			}
+			return nullptr;
+		}
+
+		if( ( pNewSize > pOldSize ) && ( _memoryLimit != 0 ) && ( _allocatedBytes - pOldSize + pNewSize > _memoryLimit ) )
+		{
+			// Lua raises LUA_ERRMEM (after an emergency collection and a retry).
+			++_failedAllocationsNum;
+			return nullptr;
+		}
+
+		void * newBlock = nullptr;
+
+		if( isPooledSize( pOldSize ) && isPooledSize( pNewSize ) && ( getSizeClassIndex( pOldSize ) == getSizeClassIndex( pNewSize ) ) )
+		{
+			// Same size class, the block is large enough.
+			newBlock = pPtr;
+		}
+		else if( !isPooledSize( pOldSize ) && !isPooledSize( pNewSize ) )
+		{
+			// Large to large (or a new large block): realloc may be able to resize in place.
+			newBlock = std::realloc( pPtr, pNewSize );
+			if( !newBlock )
+			{
+				if( pNewSize > pOldSize )
+				{
+					++_failedAllocationsNum;
+					return nullptr;
+				}
+				// realloc() is allowed to fail even when shrinking, Lua is not: the block simply stays as it is.
+				newBlock = pPtr;
+			}
+			_largeBlocksBytes = _largeBlocksBytes - pOldSize + pNewSize;
+		}
+		else
+		{
+			// Transition between a pooled and a large block (or between size classes).
+			if( isPooledSize( pNewSize ) )
+			{
+				newBlock = allocatePooledBlock( getSizeClassIndex( pNewSize ) );
+			}
+			else
+			{
+				newBlock = std::malloc( pNewSize );
+				if( newBlock )
+				{
+					_largeBlocksBytes += pNewSize;
+				}
+			}
+
+			if( !newBlock )
+			{
+				if( pNewSize > pOldSize )
+				{
+					// Only if the system is out of memory. The old block is left intact, Lua raises an error.
+					++_failedAllocationsNum;
+					return nullptr;
+				}
+
+				// No pool page for a smaller block. Lua assumes that shrinking never fails, so the old block (which is
+				// large enough) is returned as it is. Lua frees it later with the new size, which puts it on the free
+				// list of the new size class - a large block is adopted as a pool page, so that releaseMemory() frees it.
+				if( !isPooledSize( pOldSize ) )
+				{
+					adoptLargeBlock( pPtr, pOldSize );
+				}
+				newBlock = pPtr;
+			}
+			else if( pPtr )
+			{
+				std::memcpy( newBlock, pPtr, std::min( pOldSize, pNewSize ) );
+
+				if( isPooledSize( pOldSize ) )
+				{
+					freePooledBlock( pPtr, getSizeClassIndex( pOldSize ) );
+				}
+				else
+				{
+					std::free( pPtr );
+					_largeBlocksBytes -= pOldSize;
+				}
+			}
+		}
+
+		if( !pPtr )
+		{
+			++_allocationsNum;
+			_pooledAllocationsNum += isPooledSize( pNewSize ) ? 1 : 0;
+		}
+
+		_allocatedBytes = _allocatedBytes - pOldSize + pNewSize;
+		_peakAllocatedBytes = std::max( _peakAllocatedBytes, _allocatedBytes );
+
+		return newBlock;
+	}
+
+	void LuaMemoryAllocator::setMemoryLimit( size_t pMemoryLimit ) noexcept
+	{
+		_memoryLimit = pMemoryLimit;
+	}
+
+	void LuaMemoryAllocator::releaseMemory()
+	{
+		for( auto * poolPage : _poolPages )
+		{
+			std::free( poolPage );
+		}
+
+		_poolPages.clear();
+		std::fill( std::begin( _freeLists ), std::end( _freeLists ), nullptr );
+		_poolPagesBytes = 0;
+		_allocatedBytes = 0;
+		_largeBlocksBytes = 0;
+	}
+
+	ScriptMemoryStats LuaMemoryAllocator::getStats() const noexcept
+	{
+		ScriptMemoryStats memoryStats{};
+		memoryStats.allocatedBytes = _allocatedBytes;
+		memoryStats.peakAllocatedBytes = _peakAllocatedBytes;
+		memoryStats.reservedBytes = _poolPagesBytes + _largeBlocksBytes;
+		memoryStats.allocationsNum = _allocationsNum;
+		memoryStats.pooledAllocationsNum = _pooledAllocationsNum;
+		memoryStats.failedAllocationsNum = _failedAllocationsNum;
+		memoryStats.memoryLimit = _memoryLimit;
+		return memoryStats;
+	}
+
+	void * LuaMemoryAllocator::allocatePooledBlock( size_t pSizeClassIndex )
+	{
+		if( !_freeLists[pSizeClassIndex] && !allocatePoolPage( pSizeClassIndex ) )
+		{
+			return nullptr;
+		}
+
+		auto * block = _freeLists[pSizeClassIndex];
+		_freeLists[pSizeClassIndex] = block->nextBlock;
+
+		return block;
+	}
+
+	void LuaMemoryAllocator::freePooledBlock( void * pBlock, size_t pSizeClassIndex ) noexcept
+	{
+		auto * block = reinterpret_cast<FreeBlock *>( pBlock );
+		block->nextBlock = _freeLists[pSizeClassIndex];
+		_freeLists[pSizeClassIndex] = block;
+	}
+
+	bool LuaMemoryAllocator::allocatePoolPage( size_t pSizeClassIndex )
+	{
+		// malloc() returns memory aligned for any fundamental type, blocks are multiples of kPoolBlockAlignment.
+		auto * poolPage = reinterpret_cast<byte *>( std::malloc( kPoolPageSize ) );
+		if( !poolPage )
+		{
+			return false;
+		}
+
+		try
+		{
+			_poolPages.push_back( poolPage );
+		}
+		catch( ... )
+		{
+			// Called from the Lua (C) code, exceptions must not propagate.
+			std::free( poolPage );
+			return false;
+		}
+
+		_poolPagesBytes += kPoolPageSize;
+
+		const auto blockSize = ( pSizeClassIndex + 1 ) * kPoolBlockAlignment;
+		const auto blocksNum = kPoolPageSize / blockSize;
+
+		// Blocks are linked in the address order, so consecutive allocations are adjacent in memory.
+		FreeBlock * nextBlock = _freeLists[pSizeClassIndex];
+		for( size_t blockIndex = blocksNum; blockIndex > 0; --blockIndex )
+		{
+			auto * block = reinterpret_cast<FreeBlock *>( poolPage + ( blockIndex - 1 ) * blockSize );
+			block->nextBlock = nextBlock;
+			nextBlock = block;
+		}
+
+		_freeLists[pSizeClassIndex] = nextBlock;
+
+		return true;
+	}
+
+	void LuaMemoryAllocator::adoptLargeBlock( void * pBlock, size_t pBlockSize ) noexcept
+	{
+		try
+		{
+			_poolPages.push_back( pBlock );
+		}
+		catch( ... )
+		{
+			// Out of memory as well: the block is not freed by releaseMemory(), but it is still reused by the pool.
+			return;
+		}
+
+		_largeBlocksBytes -= pBlockSize;
+		_poolPagesBytes += pBlockSize;
+	}
+
+} // namespace Ic3::Script
@@ -0,0 +1,94 @@
+
+#pragma once
+
+#ifndef __IC3_SCRIPT_LUA_MEMORY_ALLOCATOR_H__
+#define __IC3_SCRIPT_LUA_MEMORY_ALLOCATOR_H__
+
+#include "LuaPrerequisites.h"
+#include "../ScriptSystem.h"
+
+namespace Ic3::Script
+{
+
+	/**
+	 * @brief Memory allocator of a lua_State (lua_Alloc), with pools for small blocks, accounting and a memory limit.
+	 *
+	 * Most of the VM allocations are small (strings, tables, closures, upvalues) and short-lived. Blocks up to
+	 * kMaxPooledBlockSize are taken from per-size-class free lists, refilled from 64 KB pages, so they never go through
+	 * the system allocator. Larger blocks (array parts of tables, stacks, long strings) use malloc/realloc.
+	 *
+	 * If the memory limit is set, allocations which would exceed it fail and Lua raises an out-of-memory error in the
+	 * script which has caused it. The limit is never applied to freeing or shrinking a block, and shrinking never fails
+	 * (if the smaller block cannot be obtained, the old one is kept). Pool pages are released only by releaseMemory(),
+	 * after the state has been closed.
+	 *
+	 * Not thread-safe: an allocator serves a single lua_State (and all of its coroutines).
+	 */
+	class LuaMemoryAllocator
+	{
+	public:
+		static constexpr size_t kPoolBlockAlignment = 16;
+		static constexpr size_t kMaxPooledBlockSize = 256;
+		static constexpr size_t kSizeClassesNum = kMaxPooledBlockSize / kPoolBlockAlignment;
+		static constexpr size_t kPoolPageSize = 64 * 1024;
+
+		LuaMemoryAllocator() = default;
+		~LuaMemoryAllocator();
+
+		LuaMemoryAllocator( const LuaMemoryAllocator & ) = delete;
+		LuaMemoryAllocator & operator=( const LuaMemoryAllocator & ) = delete;
+
+		/// lua_Alloc-compatible function, pUserData is the LuaMemoryAllocator.
+		static void * luaAlloc( void * pUserData, void * pPtr, size_t pOldSize, size_t pNewSize );
+
+		void * reallocate( void * pPtr, size_t pOldSize, size_t pNewSize );
+
+		/// Sets the memory limit, 0 disables it.
+		void setMemoryLimit( size_t pMemoryLimit ) noexcept;
+
+		/// Releases all pool pages. Must not be called while any block is still in use (i.e. before lua_close()).
+		void releaseMemory();
+
+		[[nodiscard]] ScriptMemoryStats getStats() const noexcept;
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock * nextBlock;
+		};
+
+		static size_t getSizeClassIndex( size_t pSize ) noexcept
+		{
+			return ( pSize + kPoolBlockAlignment - 1 ) / kPoolBlockAlignment - 1;
+		}
+
+		static bool isPooledSize( size_t pSize ) noexcept
+		{
+			return ( pSize > 0 ) && ( pSize <= kMaxPooledBlockSize );
+		}
+
+		void * allocatePooledBlock( size_t pSizeClassIndex );
+
+		void freePooledBlock( void * pBlock, size_t pSizeClassIndex ) noexcept;
+
+		bool allocatePoolPage( size_t pSizeClassIndex );
+
+		/// Makes a large block part of the pool memory (released with the pool pages).
+		void adoptLargeBlock( void * pBlock, size_t pBlockSize ) noexcept;
+
+	private:
+		FreeBlock * _freeLists[kSizeClassesNum] = {};
+		std::vector<void *> _poolPages;
+		size_t _poolPagesBytes = 0;
+		size_t _allocatedBytes = 0;
+		size_t _peakAllocatedBytes = 0;
+		size_t _largeBlocksBytes = 0;
+		size_t _memoryLimit = 0;
+		uint64 _allocationsNum = 0;
+		uint64 _pooledAllocationsNum = 0;
+		uint64 _failedAllocationsNum = 0;
+	};
+
+} // namespace Ic3::Script
+
+#endif // __IC3_SCRIPT_LUA_MEMORY_ALLOCATOR_H__
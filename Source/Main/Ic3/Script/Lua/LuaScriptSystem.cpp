@@ -1,15 +1,31 @@
 
 #include "LuaScriptSystem.h"
 #include "LuaCoreAPI.h"
+#include <cppx/hash.h>
 
 namespace Ic3::Script
 {
 
+	int luaPanicHandler( lua_State * pLuaState )
+	{
+		// Error outside of a protected call, Lua aborts the application after this returns.
+		const auto * errorMessage = lua_tostring( pLuaState, -1 );
+		Ic3DebugOutputFmt( "[ScriptSystem] Unprotected Lua error: %s", errorMessage ? errorMessage : "(no message)" );
+		return 0;
+	}
+
 	void LuaScriptSystem::initialize()
 	{
 		if( !_context.luaState )
 		{
-			auto * luaState = luaL_newstate();
+			auto * luaState = lua_newstate( LuaMemoryAllocator::luaAlloc, &_memoryAllocator );
+			if( !luaState )
+			{
+				Ic3ThrowDesc( eExcCodeDebugPlaceholder, "Cannot create the Lua state (out of memory or the memory limit is too low)." );
+			}
+
+			lua_atpanic( luaState, luaPanicHandler );
+
 			LuaCore::openLibrary( luaState, luaopen_base );
 			LuaCore::openLibrary( luaState, luaopen_debug);
 			LuaCore::openLibrary( luaState, luaopen_io);
@@ -21,6 +37,8 @@ namespace Ic3::Script
 			LuaCore::openLibrary( luaState, luaopen_utf8);
 
 			_context.luaState = luaState;
+
+			applyGCParameters();
 		}
 	}
 
@@ -30,6 +48,8 @@ namespace Ic3::Script
 		{
 			lua_close( _context.luaState );
 			_context.luaState = nullptr;
+
+			_memoryAllocator.releaseMemory();
 		}
 	}
 
@@ -40,9 +60,17 @@ namespace Ic3::Script
 
 	int luaDumpCodeWriter( lua_State * pLuaState, const void * pData, size_t pLength, void * pArg )
 	{
+		// lua_dump() emits the binary in many small chunks, each of them is appended to the output.
+		// The storage grows geometrically, so large scripts do not reallocate on every chunk.
 		auto * targetBuffer = reinterpret_cast<cppx::dynamic_byte_array *>( pArg );
-		targetBuffer->resize( pLength );
-		targetBuffer->setData( pData, pLength, 0 );
+		const auto currentSize = targetBuffer->size();
+		const auto requiredSize = currentSize + pLength;
+		if( requiredSize > targetBuffer->capacity() )
+		{
+			targetBuffer->resize( std::max( requiredSize, targetBuffer->capacity() * 2 ) );
+		}
+		targetBuffer->set_size( requiredSize );
+		cppx::mem_copy( targetBuffer->data_offset( currentSize ), pLength, pData, pLength );
 
 		return 0;
 	}
@@ -55,15 +83,26 @@ namespace Ic3::Script
 			return false;
 		}
 
-		lua_dump( _context.luaState, luaDumpCodeWriter, &pOutput, 0 );
+		pOutput.clear();
+
+		const auto dumpResult = lua_dump( _context.luaState, luaDumpCodeWriter, &pOutput, 0 );
 		lua_pop( _context.luaState, 1 );
 
+		if( ( dumpResult != 0 ) || pOutput.empty() )
+		{
+			pOutput.clear();
+			return false;
+		}
+
+		pOutput.shrink_to_fit();
+
 		return true;
 	}
 
 	bool LuaScriptSystem::executeCompiledScript( const char * pName, const void * pBinary, size_t pLength ) noexcept
 	{
-		const auto loadResult = luaL_loadbufferx( _context.luaState, reinterpret_cast<const char*>( pBinary ), pLength, pName, "t" );
+		// Binary chunks only: compiled scripts come from compileSource() (or the binary cache).
+		const auto loadResult = luaL_loadbufferx( _context.luaState, reinterpret_cast<const char*>( pBinary ), pLength, pName, "b" );
 		if( !LuaCore::checkResult( _context.luaState, loadResult ) )
 		{
 			return false;
@@ -95,6 +134,62 @@ namespace Ic3::Script
 		return true;
 	}
 
+	uint64 LuaScriptSystem::getBinaryFormatID() const noexcept
+	{
+		// The bytecode depends on the exact VM release and the sizes of its basic types.
+		const auto formatHash = cppx::hash_compute<cppx::hash_algo::fnv1a64>(
+				std::string_view{ LUA_RELEASE },
+				static_cast<uint32>( sizeof( lua_Integer ) ),
+				static_cast<uint32>( sizeof( lua_Number ) ),
+				static_cast<uint32>( sizeof( size_t ) ) );
+
+		return formatHash.value;
+	}
+
+	void LuaScriptSystem::setMemoryLimit( size_t pMemoryLimit )
+	{
+		_memoryAllocator.setMemoryLimit( pMemoryLimit );
+	}
+
+	void LuaScriptSystem::setGCParameters( const ScriptGCParameters & pGCParameters )
+	{
+		_gcParameters = pGCParameters;
+		applyGCParameters();
+	}
+
+	void LuaScriptSystem::collectGarbage()
+	{
+		if( _context.luaState )
+		{
+			lua_gc( _context.luaState, LUA_GCCOLLECT, 0 );
+		}
+	}
+
+	bool LuaScriptSystem::stepGarbageCollector( uint32 pStepSizeKB )
+	{
+		if( _context.luaState )
+		{
+			return lua_gc( _context.luaState, LUA_GCSTEP, static_cast<int>( pStepSizeKB ) ) != 0;
+		}
+
+		return false;
+	}
+
+	ScriptMemoryStats LuaScriptSystem::getMemoryStats() const noexcept
+	{
+		return _memoryAllocator.getStats();
+	}
+
+	void LuaScriptSystem::applyGCParameters()
+	{
+		if( _context.luaState )
+		{
+			// The VM (5.3) has only the incremental collector, so there are no generational parameters.
+			lua_gc( _context.luaState, LUA_GCSETPAUSE, static_cast<int>( _gcParameters.pause ) );
+			lua_gc( _context.luaState, LUA_GCSETSTEPMUL, static_cast<int>( _gcParameters.stepMultiplier ) );
+		}
+	}
+
 	void LuaScriptSystem::registerLib( const char * pName, const luaL_Reg * pReg )
 	{
 		luaL_newlib( _context.luaState, pReg );
@@ -2,8 +2,7 @@
 #ifndef __IC3_SCRIPT_LUA_SCRIPT_SYSTEM_H__
 #define __IC3_SCRIPT_LUA_SCRIPT_SYSTEM_H__
 
-#include "LuaPrerequisites.h"
-#include "../ScriptSystem.h"
+#include "LuaMemoryAllocator.h"
 
 namespace Ic3::Script
 {
@@ -30,10 +29,24 @@ namespace Ic3::Script
 
 		virtual bool compileSource( const char * pName, const void * pSource, size_t pLength, cppx::dynamic_byte_array & pOutput ) noexcept override;
 
+		using ScriptSystem::executeCompiledScript;
+
 		virtual bool executeCompiledScript( const char * pName, const void * pBinary, size_t pLength ) noexcept override;
 
 		virtual bool executeTextScript( const char * pName, const char * pSource, size_t pLength ) noexcept override;
 
+		[[nodiscard]] virtual uint64 getBinaryFormatID() const noexcept override;
+
+		virtual void setMemoryLimit( size_t pMemoryLimit ) override;
+
+		virtual void setGCParameters( const ScriptGCParameters & pGCParameters ) override;
+
+		virtual void collectGarbage() override;
+
+		virtual bool stepGarbageCollector( uint32 pStepSizeKB ) override;
+
+		[[nodiscard]] virtual ScriptMemoryStats getMemoryStats() const noexcept override;
+
 		[[nodiscard]] const LuaContext * getLuaContext() const noexcept
 		{
 			return &_context;
@@ -43,8 +56,13 @@ namespace Ic3::Script
 
 		void registerType( const char * pLIbName, const char * pMetaName, const luaL_Reg * pLib, const luaL_Reg * pMeta);
 
+	private:
+		void applyGCParameters();
+
 	private:
 		LuaContext _context;
+		LuaMemoryAllocator _memoryAllocator;
+		ScriptGCParameters _gcParameters;
 	};
 
 } // namespace Ic3::Script
@@ -2,10 +2,36 @@
 #include "ScriptSystem.h"
 #include <Ic3/System/IO/FileSystem.h>
 #include <Ic3/System/SysContext.h>
+#include <cppx/hash.h>
 
 namespace Ic3::Script
 {
 
+	namespace
+	{
+
+		// Header of a binary file in the cache directory, followed by the binary itself.
+		struct ScriptBinaryCacheFileHeader
+		{
+			uint32 magic;
+			uint32 version;
+			uint64 cacheKey;
+			uint64 binaryFormatID;
+			uint64 binarySize;
+		};
+
+		constexpr uint32 kScriptBinaryCacheFileMagic = 0x42435349; // "ISCB"
+		constexpr uint32 kScriptBinaryCacheFileVersion = 1;
+
+		uint64 computeBinaryCacheKey( const cppx::dynamic_byte_array & pScriptSource, uint64 pBinaryFormatID )
+		{
+			using CacheKeyHash = cppx::hash_object<cppx::hash_algo::wyhash64>;
+			const auto sourceHash = cppx::hash_compute<CacheKeyHash::hash_algo>( static_cast<const void *>( pScriptSource.data() ), pScriptSource.size() );
+			return cppx::hash_compute_ex<CacheKeyHash::hash_algo>( sourceHash, pBinaryFormatID ).value;
+		}
+
+	}
+
 	ScriptSystem::ScriptSystem( System::SysContextHandle pSysContext )
 	: mSysContext( std::move( pSysContext ) )
 	, _sysFileManager( mSysContext->CreateFileManager() )
@@ -37,12 +63,33 @@ namespace Ic3::Script
 
 		if( !pScriptSource.empty() )
 		{
-			cppx::dynamic_byte_array luaBinary;
-			if( compileSource( pName, pScriptSource.data(), pScriptSource.size(), luaBinary ) )
+			const auto binaryCacheEnabled = !_binaryCacheDirectory.empty();
+			const auto cacheKey = binaryCacheEnabled ? computeBinaryCacheKey( pScriptSource, getBinaryFormatID() ) : 0u;
+
+			cppx::dynamic_byte_array scriptBinary;
+
+			if( binaryCacheEnabled && loadCachedBinary( cacheKey, scriptBinary ) )
+			{
+				++_binaryCacheStats.hitsNum;
+			}
+			else if( compileSource( pName, pScriptSource.data(), pScriptSource.size(), scriptBinary ) )
+			{
+				if( binaryCacheEnabled )
+				{
+					++_binaryCacheStats.missesNum;
+					if( storeCachedBinary( cacheKey, scriptBinary ) )
+					{
+						++_binaryCacheStats.storedBinariesNum;
+					}
+				}
+			}
+			else
 			{
-				compiledScript.name = pName;
-				compiledScript.binary = std::move( luaBinary );
+				return compiledScript;
 			}
+
+			compiledScript.name = pName;
+			compiledScript.binary = std::move( scriptBinary );
 		}
 
 		return compiledScript;
@@ -58,4 +105,99 @@ namespace Ic3::Script
 		return false;
 	}
 
+	bool ScriptSystem::executeFile( const char * pName, const char * pFileName )
+	{
+		return executeCompiledScript( compileFile( pName, pFileName ) );
+	}
+
+	void ScriptSystem::setBinaryCacheDirectory( std::string pCacheDirectory )
+	{
+		_binaryCacheDirectory = std::move( pCacheDirectory );
+	}
+
+	const ScriptBinaryCacheStats & ScriptSystem::getBinaryCacheStats() const noexcept
+	{
+		return _binaryCacheStats;
+	}
+
+	bool ScriptSystem::loadCachedBinary( uint64 pCacheKey, cppx::dynamic_byte_array & pOutput )
+	{
+		const auto binaryFilePath = getCachedBinaryFilePath( pCacheKey );
+
+		try
+		{
+			if( !_sysFileManager->CheckFileExists( binaryFilePath ) )
+			{
+				return false;
+			}
+
+			auto binaryFile = _sysFileManager->OpenFile( binaryFilePath, System::EIOAccessMode::ReadOnly );
+
+			ScriptBinaryCacheFileHeader fileHeader{};
+			if( binaryFile->Read( &fileHeader, sizeof( fileHeader ) ) != sizeof( fileHeader ) )
+			{
+				return false;
+			}
+
+			// A binary of a different VM (or an interrupted write, which leaves the file truncated) is ignored
+			// and replaced with a new one.
+			const auto headerValid =
+				( fileHeader.magic == kScriptBinaryCacheFileMagic ) &&
+				( fileHeader.version == kScriptBinaryCacheFileVersion ) &&
+				( fileHeader.cacheKey == pCacheKey ) &&
+				( fileHeader.binaryFormatID == getBinaryFormatID() ) &&
+				( fileHeader.binarySize > 0 ) &&
+				( fileHeader.binarySize == binaryFile->GetAvailableDataSize() );
+
+			if( !headerValid )
+			{
+				return false;
+			}
+
+			pOutput.resize( static_cast<size_t>( fileHeader.binarySize ) );
+
+			return binaryFile->Read( pOutput.data(), pOutput.size() ) == fileHeader.binarySize;
+		}
+		catch( const Exception & pException )
+		{
+			Ic3DebugOutputFmt( "[ScriptSystem] Cannot read cached binary '%s': %s", binaryFilePath.c_str(), pException.what() );
+		}
+
+		return false;
+	}
+
+	bool ScriptSystem::storeCachedBinary( uint64 pCacheKey, const cppx::dynamic_byte_array & pBinary )
+	{
+		const auto binaryFilePath = getCachedBinaryFilePath( pCacheKey );
+
+		try
+		{
+			auto binaryFile = _sysFileManager->CreateFile( binaryFilePath );
+
+			ScriptBinaryCacheFileHeader fileHeader{};
+			fileHeader.magic = kScriptBinaryCacheFileMagic;
+			fileHeader.version = kScriptBinaryCacheFileVersion;
+			fileHeader.cacheKey = pCacheKey;
+			fileHeader.binaryFormatID = getBinaryFormatID();
+			fileHeader.binarySize = pBinary.size();
+
+			return
+				( binaryFile->Write( &fileHeader, sizeof( fileHeader ) ) == sizeof( fileHeader ) ) &&
+				( binaryFile->Write( pBinary.data(), pBinary.size() ) == pBinary.size() );
+		}
+		catch( const Exception & pException )
+		{
+			Ic3DebugOutputFmt( "[ScriptSystem] Cannot write cached binary '%s': %s", binaryFilePath.c_str(), pException.what() );
+		}
+
+		return false;
+	}
+
+	std::string ScriptSystem::getCachedBinaryFilePath( uint64 pCacheKey ) const
+	{
+		char fileName[32];
+		std::snprintf( fileName, sizeof( fileName ), "%016llx.iscb", static_cast<unsigned long long>( pCacheKey ) );
+		return _binaryCacheDirectory + "/" + fileName;
+	}
+
 }
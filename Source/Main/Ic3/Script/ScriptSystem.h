@@ -4,7 +4,7 @@
 
 #include "Prerequisites.h"
 #include <cppx/byteArray.h>
-#include <Ic3/System/IO/FileCommon.h>
+#include <Ic3/System/IO/IOCommonDefs.h>
 
 namespace Ic3::Script
 {
@@ -20,6 +20,37 @@ namespace Ic3::Script
 		}
 	};
 
+	struct ScriptBinaryCacheStats
+	{
+		uint32 hitsNum = 0;
+		uint32 missesNum = 0;
+		uint32 storedBinariesNum = 0;
+	};
+
+	struct ScriptMemoryStats
+	{
+		/// Memory currently used by the VM (sum of the requested sizes).
+		uint64 allocatedBytes = 0;
+		uint64 peakAllocatedBytes = 0;
+		/// Memory reserved from the system, including unused blocks kept by the pools.
+		uint64 reservedBytes = 0;
+		uint64 allocationsNum = 0;
+		uint64 pooledAllocationsNum = 0;
+		/// Allocations refused because of the memory limit (or a failure of the system allocator).
+		uint64 failedAllocationsNum = 0;
+		/// 0 if there is no limit.
+		uint64 memoryLimit = 0;
+	};
+
+	struct ScriptGCParameters
+	{
+		/// How long the collector waits before a new cycle: percentage of the memory in use after the previous
+		/// collection (200 - a cycle starts when the memory use doubles).
+		uint32 pause = 200;
+		/// Speed of the incremental collector relative to the allocation speed, in percent.
+		uint32 stepMultiplier = 200;
+	};
+
 	class ScriptSystem : public IDynamicObject
 	{
 	public:
@@ -40,12 +71,44 @@ namespace Ic3::Script
 
 		virtual bool executeTextScript( const char * pName, const char * pSource, size_t pLength ) noexcept = 0;
 
+		/// Returns the ID of the binary format produced by compileSource() (e.g. the VM version and its ABI).
+		/// Cached binaries are only used by a system with the same format ID.
+		[[nodiscard]] virtual uint64 getBinaryFormatID() const noexcept = 0;
+
+		/// Enables the on-disk cache of compiled scripts, used by compileScript() and compileFile(). Binaries are
+		/// stored under the hash of the source and the binary format ID, so modified scripts and VM updates result
+		/// in a recompilation. The directory must exist and is trusted: binaries are loaded without verification.
+		/// An empty path disables the cache.
+		void setBinaryCacheDirectory( std::string pCacheDirectory );
+
+		/// Sets the hard limit of the memory used by the VM, 0 disables it. Allocations above the limit fail with
+		/// a script (out of memory) error. Can be changed at any time; lowering it does not release any memory.
+		virtual void setMemoryLimit( size_t pMemoryLimit ) = 0;
+
+		/// Sets the parameters of the incremental garbage collector. Applied immediately if the VM is initialized,
+		/// otherwise when it is.
+		virtual void setGCParameters( const ScriptGCParameters & pGCParameters ) = 0;
+
+		/// Runs a full garbage collection cycle.
+		virtual void collectGarbage() = 0;
+
+		/// Performs an incremental GC step (e.g. once per frame), pStepSizeKB controls the amount of work.
+		/// Returns true if the step has finished a cycle.
+		virtual bool stepGarbageCollector( uint32 pStepSizeKB ) = 0;
+
+		[[nodiscard]] virtual ScriptMemoryStats getMemoryStats() const noexcept = 0;
+
+		[[nodiscard]] const ScriptBinaryCacheStats & getBinaryCacheStats() const noexcept;
+
 		CompiledScript compileFile( const char * pName, const char * pFileName );
 
 		CompiledScript compileScript( const char * pName, const cppx::dynamic_byte_array & pScriptSource );
 
 		bool executeCompiledScript( const CompiledScript & pCompiledScript );
 
+		/// Compiles (or loads from the binary cache) and executes a script file.
+		bool executeFile( const char * pName, const char * pFileName );
+
 		template <typename TContext>
 		[[nodiscard]] const TContext * getContextAs() const noexcept
 		{
@@ -54,6 +117,17 @@ namespace Ic3::Script
 
 	protected:
 		System::FileManagerHandle const _sysFileManager;
+
+	private:
+		bool loadCachedBinary( uint64 pCacheKey, cppx::dynamic_byte_array & pOutput );
+
+		bool storeCachedBinary( uint64 pCacheKey, const cppx::dynamic_byte_array & pBinary );
+
+		[[nodiscard]] std::string getCachedBinaryFilePath( uint64 pCacheKey ) const;
+
+	private:
+		std::string _binaryCacheDirectory;
+		ScriptBinaryCacheStats _binaryCacheStats;
 	};
 
 } // namespace Ic3::Script
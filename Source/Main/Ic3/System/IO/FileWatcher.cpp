@@ -0,0 +1,43 @@
+
+#include "FileWatcher.h"
+
+namespace Ic3::System
+{
+
+	FileWatcher::FileWatcher( SysContextHandle pSysContext )
+	: SysObject( std::move( pSysContext ) )
+	{}
+
+	FileWatcher::~FileWatcher() noexcept = default;
+
+	file_watch_id_t FileWatcher::AddFileWatch( const std::string & pFilePath )
+	{
+		if( pFilePath.empty() )
+		{
+			return kFileWatchIDInvalid;
+		}
+
+		return _NativeAddFileWatch( pFilePath );
+	}
+
+	bool FileWatcher::RemoveFileWatch( file_watch_id_t pWatchID )
+	{
+		if( pWatchID == kFileWatchIDInvalid )
+		{
+			return false;
+		}
+
+		return _NativeRemoveFileWatch( pWatchID );
+	}
+
+	uint32 FileWatcher::WaitForEvents( FileWatchEventList & pOutEvents, const cppx::milliseconds & pTimeout )
+	{
+		return _NativeWaitForEvents( pOutEvents, pTimeout );
+	}
+
+	void FileWatcher::InterruptWait()
+	{
+		_NativeInterruptWait();
+	}
+
+} // namespace Ic3::System
@@ -0,0 +1,70 @@
+
+#ifndef __IC3_SYSTEM_FILE_WATCHER_H__
+#define __IC3_SYSTEM_FILE_WATCHER_H__
+
+#include "IOCommonDefs.h"
+#include "../SysObject.h"
+
+namespace Ic3::System
+{
+
+	Ic3SysDeclareHandle( FileWatcher );
+
+	using file_watch_id_t = uint32;
+
+	inline constexpr file_watch_id_t kFileWatchIDInvalid = 0;
+
+	enum class EFileWatchEventType : enum_default_value_t
+	{
+		/// The file has been written to and closed, or another file has been moved/renamed to its path.
+		/// Editors which save by writing a temporary file and renaming it are reported as a single modification.
+		Modified,
+
+		/// The file has been deleted or moved away. The watch stays active and reports the file again if it reappears.
+		Removed,
+	};
+
+	struct FileWatchEvent
+	{
+		file_watch_id_t watchID;
+		EFileWatchEventType eventType;
+		std::string filePath;
+	};
+
+	using FileWatchEventList = std::vector<FileWatchEvent>;
+
+	/// @brief Reports changes of individual files. Watches are registered for file paths (the files do not have
+	/// to exist yet) and changes are fetched with WaitForEvents(), usually from a dedicated background thread.
+	///
+	/// All methods are thread-safe: watches can be added and removed while another thread is blocked inside
+	/// WaitForEvents(), which can also be woken up early with InterruptWait().
+	class IC3_SYSTEM_CLASS FileWatcher : public SysObject
+	{
+	public:
+		explicit FileWatcher( SysContextHandle pSysContext );
+		virtual ~FileWatcher() noexcept;
+
+		/// @brief Starts watching the specified file. Returns the ID of the new watch or kFileWatchIDInvalid on error.
+		/// Adding a path which is already watched returns the ID of the existing watch.
+		CPPX_ATTR_NO_DISCARD file_watch_id_t AddFileWatch( const std::string & pFilePath );
+
+		bool RemoveFileWatch( file_watch_id_t pWatchID );
+
+		/// @brief Waits until at least one watched file has changed or the timeout expires, then appends all pending
+		/// events to pOutEvents. Multiple changes of the same file are merged into a single event (the last one).
+		/// Returns the number of appended events (0 if the timeout has expired or the wait has been interrupted).
+		uint32 WaitForEvents( FileWatchEventList & pOutEvents, const cppx::milliseconds & pTimeout );
+
+		/// @brief Wakes up a thread blocked inside WaitForEvents(), e.g. to stop it.
+		void InterruptWait();
+
+	private:
+		virtual file_watch_id_t _NativeAddFileWatch( const std::string & pFilePath ) = 0;
+		virtual bool _NativeRemoveFileWatch( file_watch_id_t pWatchID ) = 0;
+		virtual uint32 _NativeWaitForEvents( FileWatchEventList & pOutEvents, const cppx::milliseconds & pTimeout ) = 0;
+		virtual void _NativeInterruptWait() = 0;
+	};
+
+} // namespace Ic3::System
+
+#endif // __IC3_SYSTEM_FILE_WATCHER_H__
@@ -6,6 +6,7 @@
 #include "X11FileSystem.h"
 #include "X11OpenGLDriver.h"
 #include "X11WindowSystem.h"
+#include "../../Shared/Linux/LinuxFileWatcher.h"
 #include <Ic3/System/SysContextNative.h>
 #include <Ic3/System/IO/AssetSystemNative.h>
 
@@ -54,6 +55,11 @@ namespace Ic3::System
 		return CreateSysObject<PosixFileManager>( GetHandle<X11SysContext>() );
 	}
 
+	FileWatcherHandle X11SysContext::CreateFileWatcher()
+	{
+		return CreateSysObject<LinuxFileWatcher>( GetHandle<X11SysContext>() );
+	}
+
 	OpenGLSystemDriverHandle X11SysContext::CreateOpenGLSystemDriver( DisplayManagerHandle pDisplayManager )
 	{
 		if( !pDisplayManager )
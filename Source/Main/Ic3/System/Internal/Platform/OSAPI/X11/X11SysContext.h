@@ -40,6 +40,9 @@ namespace Ic3::System
 		/// @copybrief SysContext::CreateFileManager
 		virtual FileManagerHandle CreateFileManager() override final;
 
+		/// @copybrief SysContext::CreateFileWatcher
+		virtual FileWatcherHandle CreateFileWatcher() override final;
+
 		/// @copybrief SysContext::CreateOpenGLSystemDriver
 		virtual OpenGLSystemDriverHandle CreateOpenGLSystemDriver( DisplayManagerHandle pDisplayManager ) override final;
 
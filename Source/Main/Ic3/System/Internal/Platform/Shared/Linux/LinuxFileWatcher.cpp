@@ -0,0 +1,331 @@
+
+#include "LinuxFileWatcher.h"
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <chrono>
+#include <climits>
+
+namespace Ic3::System
+{
+
+	namespace Platform
+	{
+
+		// Changes which are reported for files in watched directories.
+		static constexpr uint32_t kLinuxFileWatchDirEventMask =
+				IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR;
+
+		static void _LinuxSplitFilePath( const std::string & pFilePath, std::string & pOutDirPath, std::string & pOutFileName );
+
+		static void _LinuxAppendFileWatchEvent(
+				FileWatchEventList & pOutEvents,
+				std::unordered_map<file_watch_id_t, size_t> & pEventIndexMap,
+				file_watch_id_t pWatchID,
+				EFileWatchEventType pEventType,
+				const std::string & pFilePath );
+
+	}
+
+	LinuxFileWatcher::LinuxFileWatcher( SysContextHandle pSysContext )
+	: NativeObject( std::move( pSysContext ) )
+	{
+		_InitializeLinuxWatcherState();
+	}
+
+	LinuxFileWatcher::~LinuxFileWatcher() noexcept
+	{
+		_ReleaseLinuxWatcherState();
+	}
+
+	file_watch_id_t LinuxFileWatcher::_NativeAddFileWatch( const std::string & pFilePath )
+	{
+		std::string dirPath;
+		std::string fileName;
+		Platform::_LinuxSplitFilePath( pFilePath, dirPath, fileName );
+
+		if( fileName.empty() )
+		{
+			Ic3DebugOutputFmt( "[LinuxFileWatcher] '%s' is not a file path.", pFilePath.c_str() );
+			return kFileWatchIDInvalid;
+		}
+
+		const std::lock_guard<std::mutex> watchMapLock{ _watchMapLock };
+
+		// Adding a watch for an already watched directory (inode) returns the existing descriptor.
+		const auto dirWatchDescriptor = ::inotify_add_watch(
+				mNativeData.mInotifyFD,
+				dirPath.c_str(),
+				Platform::kLinuxFileWatchDirEventMask );
+
+		if( dirWatchDescriptor < 0 )
+		{
+			Ic3DebugOutputFmt(
+					"[LinuxFileWatcher] Cannot watch directory '%s': %s",
+					dirPath.c_str(),
+					Platform::PXAQueryErrnoStringByCode( errno ) );
+			return kFileWatchIDInvalid;
+		}
+
+		auto & watchedDirectory = _dirWatchMap[dirWatchDescriptor];
+
+		const auto existingWatchIter = watchedDirectory.fileWatchMap.find( fileName );
+		if( existingWatchIter != watchedDirectory.fileWatchMap.end() )
+		{
+			return existingWatchIter->second;
+		}
+
+		const auto watchID = _nextWatchID++;
+		watchedDirectory.fileWatchMap[fileName] = watchID;
+		_fileWatchMap[watchID] = WatchedFile{ pFilePath, std::move( fileName ), dirWatchDescriptor };
+
+		return watchID;
+	}
+
+	bool LinuxFileWatcher::_NativeRemoveFileWatch( file_watch_id_t pWatchID )
+	{
+		const std::lock_guard<std::mutex> watchMapLock{ _watchMapLock };
+
+		const auto fileWatchIter = _fileWatchMap.find( pWatchID );
+		if( fileWatchIter == _fileWatchMap.end() )
+		{
+			return false;
+		}
+
+		const auto dirWatchDescriptor = fileWatchIter->second.dirWatchDescriptor;
+		const auto dirWatchIter = _dirWatchMap.find( dirWatchDescriptor );
+		if( dirWatchIter != _dirWatchMap.end() )
+		{
+			dirWatchIter->second.fileWatchMap.erase( fileWatchIter->second.fileName );
+			if( dirWatchIter->second.fileWatchMap.empty() )
+			{
+				// The IN_IGNORED event generated for the descriptor is skipped, as it is no longer in the map.
+				::inotify_rm_watch( mNativeData.mInotifyFD, dirWatchDescriptor );
+				_dirWatchMap.erase( dirWatchIter );
+			}
+		}
+
+		_fileWatchMap.erase( fileWatchIter );
+
+		return true;
+	}
+
+	uint32 LinuxFileWatcher::_NativeWaitForEvents( FileWatchEventList & pOutEvents, const cppx::milliseconds & pTimeout )
+	{
+		const auto infiniteTimeout = ( pTimeout >= cppx::timeout_infinite_ms );
+		const auto waitDeadline = std::chrono::steady_clock::now() +
+				std::chrono::milliseconds( infiniteTimeout ? 0 : std::min<int64>( pTimeout.get_count(), INT_MAX ) );
+
+		pollfd pollDescriptors[2];
+		pollDescriptors[0] = { mNativeData.mInotifyFD, POLLIN, 0 };
+		pollDescriptors[1] = { mNativeData.mInterruptEventFD, POLLIN, 0 };
+
+		while( true )
+		{
+			int timeoutMs = -1;
+			if( !infiniteTimeout )
+			{
+				const auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>( waitDeadline - std::chrono::steady_clock::now() );
+				timeoutMs = static_cast<int>( std::max<int64>( remainingTime.count(), 0 ) );
+			}
+
+			const auto pollResult = ::poll( pollDescriptors, 2, timeoutMs );
+			if( pollResult <= 0 )
+			{
+				if( ( pollResult < 0 ) && ( errno != EINTR ) )
+				{
+					Ic3DebugOutputFmt( "[LinuxFileWatcher] poll() has failed: %s", Platform::PXAQueryErrnoStringByCode( errno ) );
+				}
+				return 0;
+			}
+
+			if( pollDescriptors[1].revents & POLLIN )
+			{
+				uint64_t interruptCounter = 0;
+				( void )::read( mNativeData.mInterruptEventFD, &interruptCounter, sizeof( interruptCounter ) );
+				return 0;
+			}
+
+			if( pollDescriptors[0].revents & POLLIN )
+			{
+				// Changes of other files in watched directories (e.g. temporary files written by editors) wake up
+				// the poll as well. Only return if any of them concerned watched files, otherwise keep waiting.
+				if( const auto eventsNum = _ReadInotifyEvents( pOutEvents ); eventsNum > 0 )
+				{
+					return eventsNum;
+				}
+			}
+
+			if( !infiniteTimeout && ( timeoutMs == 0 ) )
+			{
+				return 0;
+			}
+		}
+	}
+
+	void LinuxFileWatcher::_NativeInterruptWait()
+	{
+		const uint64_t interruptCounter = 1;
+		( void )::write( mNativeData.mInterruptEventFD, &interruptCounter, sizeof( interruptCounter ) );
+	}
+
+	void LinuxFileWatcher::_InitializeLinuxWatcherState()
+	{
+		mNativeData.mInotifyFD = ::inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+		if( mNativeData.mInotifyFD < 0 )
+		{
+			Ic3ThrowDesc( eExcCodeSystemIOError, Platform::PXAQueryErrnoStringByCode( errno ) );
+		}
+
+		mNativeData.mInterruptEventFD = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+		if( mNativeData.mInterruptEventFD < 0 )
+		{
+			const auto errnoString = Platform::PXAQueryErrnoStringByCode( errno );
+			_ReleaseLinuxWatcherState();
+			Ic3ThrowDesc( eExcCodeSystemIOError, errnoString );
+		}
+	}
+
+	void LinuxFileWatcher::_ReleaseLinuxWatcherState()
+	{
+		// Closing the inotify descriptor removes all its watches.
+		if( mNativeData.mInotifyFD >= 0 )
+		{
+			::close( mNativeData.mInotifyFD );
+			mNativeData.mInotifyFD = -1;
+		}
+
+		if( mNativeData.mInterruptEventFD >= 0 )
+		{
+			::close( mNativeData.mInterruptEventFD );
+			mNativeData.mInterruptEventFD = -1;
+		}
+	}
+
+	uint32 LinuxFileWatcher::_ReadInotifyEvents( FileWatchEventList & pOutEvents )
+	{
+		const auto initialEventsNum = pOutEvents.size();
+
+		// Index of the event of each watch in pOutEvents, used to merge multiple changes of the same file.
+		std::unordered_map<file_watch_id_t, size_t> eventIndexMap;
+
+		alignas( inotify_event ) char eventBuffer[4096];
+
+		const std::lock_guard<std::mutex> watchMapLock{ _watchMapLock };
+
+		while( true )
+		{
+			const auto readBytesNum = ::read( mNativeData.mInotifyFD, eventBuffer, sizeof( eventBuffer ) );
+			if( readBytesNum <= 0 )
+			{
+				// EAGAIN: the queue has been drained.
+				break;
+			}
+
+			for( ssize_t eventOffset = 0; eventOffset < readBytesNum; )
+			{
+				const auto * inotifyEvent = reinterpret_cast<const inotify_event *>( eventBuffer + eventOffset );
+				eventOffset += static_cast<ssize_t>( sizeof( inotify_event ) + inotifyEvent->len );
+
+				if( inotifyEvent->mask & IN_Q_OVERFLOW )
+				{
+					// Some events have been lost. Report all files as modified, so no change is missed.
+					for( const auto & [watchID, watchedFile] : _fileWatchMap )
+					{
+						Platform::_LinuxAppendFileWatchEvent(
+								pOutEvents, eventIndexMap, watchID, EFileWatchEventType::Modified, watchedFile.filePath );
+					}
+					continue;
+				}
+
+				const auto dirWatchIter = _dirWatchMap.find( inotifyEvent->wd );
+				if( dirWatchIter == _dirWatchMap.end() )
+				{
+					continue;
+				}
+
+				if( inotifyEvent->mask & IN_IGNORED )
+				{
+					// The directory has been removed (or unmounted). Its files are reported as removed and their
+					// watches are kept, but will not receive any further events.
+					for( const auto & [fileName, watchID] : dirWatchIter->second.fileWatchMap )
+					{
+						auto & watchedFile = _fileWatchMap.at( watchID );
+						watchedFile.dirWatchDescriptor = -1;
+						Platform::_LinuxAppendFileWatchEvent(
+								pOutEvents, eventIndexMap, watchID, EFileWatchEventType::Removed, watchedFile.filePath );
+					}
+					_dirWatchMap.erase( dirWatchIter );
+					continue;
+				}
+
+				if( inotifyEvent->len == 0 )
+				{
+					continue;
+				}
+
+				const auto fileWatchIter = dirWatchIter->second.fileWatchMap.find( inotifyEvent->name );
+				if( fileWatchIter == dirWatchIter->second.fileWatchMap.end() )
+				{
+					continue;
+				}
+
+				const auto eventType = ( inotifyEvent->mask & ( IN_DELETE | IN_MOVED_FROM ) ) ?
+						EFileWatchEventType::Removed :
+						EFileWatchEventType::Modified;
+
+				Platform::_LinuxAppendFileWatchEvent(
+						pOutEvents,
+						eventIndexMap,
+						fileWatchIter->second,
+						eventType,
+						_fileWatchMap.at( fileWatchIter->second ).filePath );
+			}
+		}
+
+		return static_cast<uint32>( pOutEvents.size() - initialEventsNum );
+	}
+
+
+	namespace Platform
+	{
+
+		void _LinuxSplitFilePath( const std::string & pFilePath, std::string & pOutDirPath, std::string & pOutFileName )
+		{
+			const auto lastSeparatorPos = pFilePath.find_last_of( '/' );
+			if( lastSeparatorPos == std::string::npos )
+			{
+				pOutDirPath = ".";
+				pOutFileName = pFilePath;
+			}
+			else
+			{
+				pOutDirPath = ( lastSeparatorPos > 0 ) ? pFilePath.substr( 0, lastSeparatorPos ) : std::string( "/" );
+				pOutFileName = pFilePath.substr( lastSeparatorPos + 1 );
+			}
+		}
+
+		void _LinuxAppendFileWatchEvent(
+				FileWatchEventList & pOutEvents,
+				std::unordered_map<file_watch_id_t, size_t> & pEventIndexMap,
+				file_watch_id_t pWatchID,
+				EFileWatchEventType pEventType,
+				const std::string & pFilePath )
+		{
+			const auto eventIndexIter = pEventIndexMap.find( pWatchID );
+			if( eventIndexIter != pEventIndexMap.end() )
+			{
+				// Only the final state matters (e.g. delete + create of the same file is a modification).
+				pOutEvents[eventIndexIter->second].eventType = pEventType;
+			}
+			else
+			{
+				pEventIndexMap[pWatchID] = pOutEvents.size();
+				pOutEvents.push_back( FileWatchEvent{ pWatchID, pEventType, pFilePath } );
+			}
+		}
+
+	}
+
+} // namespace Ic3::System
@@ -0,0 +1,72 @@
+
+#ifndef __IC3_SYSTEM_PLATFORM_SHARED_LINUX_FILE_WATCHER_H__
+#define __IC3_SYSTEM_PLATFORM_SHARED_LINUX_FILE_WATCHER_H__
+
+#include "../POSIX/POSIXCommon.h"
+#include <Ic3/System/IO/FileWatcher.h>
+#include <mutex>
+#include <unordered_map>
+
+namespace Ic3::System
+{
+
+	namespace Platform
+	{
+
+		struct LinuxFileWatcherNativeData
+		{
+			// inotify instance, opened in non-blocking mode.
+			int mInotifyFD = -1;
+
+			// eventfd used to wake up a thread blocked in poll() on the inotify descriptor.
+			int mInterruptEventFD = -1;
+		};
+
+	}
+
+	/// @brief FileWatcher implemented with inotify.
+	///
+	/// Watches are placed on parent directories, not on the files themselves: editors often save a file by writing
+	/// a new one and renaming it over the original, which replaces the inode and silently kills a per-file watch.
+	/// A directory watch is shared by all watched files in that directory.
+	class IC3_SYSTEM_CLASS LinuxFileWatcher : public NativeObject<FileWatcher, Platform::LinuxFileWatcherNativeData>
+	{
+	public:
+		explicit LinuxFileWatcher( SysContextHandle pSysContext );
+		virtual ~LinuxFileWatcher() noexcept;
+
+	private:
+		virtual file_watch_id_t _NativeAddFileWatch( const std::string & pFilePath ) override final;
+		virtual bool _NativeRemoveFileWatch( file_watch_id_t pWatchID ) override final;
+		virtual uint32 _NativeWaitForEvents( FileWatchEventList & pOutEvents, const cppx::milliseconds & pTimeout ) override final;
+		virtual void _NativeInterruptWait() override final;
+
+		void _InitializeLinuxWatcherState();
+		void _ReleaseLinuxWatcherState();
+
+		uint32 _ReadInotifyEvents( FileWatchEventList & pOutEvents );
+
+	private:
+		struct WatchedFile
+		{
+			std::string filePath;
+			std::string fileName;
+			// inotify watch descriptor of the parent directory, -1 if the directory has been removed.
+			int dirWatchDescriptor;
+		};
+
+		struct WatchedDirectory
+		{
+			// Watched files in the directory, by their name.
+			std::unordered_map<std::string, file_watch_id_t> fileWatchMap;
+		};
+
+		std::mutex _watchMapLock;
+		std::unordered_map<file_watch_id_t, WatchedFile> _fileWatchMap;
+		std::unordered_map<int, WatchedDirectory> _dirWatchMap;
+		file_watch_id_t _nextWatchID = kFileWatchIDInvalid + 1;
+	};
+
+} // namespace Ic3::System
+
+#endif // __IC3_SYSTEM_PLATFORM_SHARED_LINUX_FILE_WATCHER_H__
@@ -8,6 +8,11 @@ namespace Ic3::System
 
 	SysContext::~SysContext() noexcept = default;
 
+	FileWatcherHandle SysContext::CreateFileWatcher()
+	{
+		Ic3ThrowDesc( eExcSystemInterfaceNotSupported, "File watching is not supported on the current operating system." );
+	}
+
 	MetalSystemDriverHandle SysContext::CreateMetalSystemDriver(
 			DisplayManagerHandle /* pDisplayManager */,
 			const MetalSystemDriverCreateInfo & /* pCreateInfo */ )
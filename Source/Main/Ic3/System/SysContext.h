@@ -22,6 +22,7 @@ namespace Ic3::System
 	Ic3SysDeclareHandle( DisplayManager );
 	Ic3SysDeclareHandle( EventController );
 	Ic3SysDeclareHandle( FileManager );
+	Ic3SysDeclareHandle( FileWatcher );
 	Ic3SysDeclareHandle( MetalSystemDriver );
 	Ic3SysDeclareHandle( OpenGLSystemDriver );
 	Ic3SysDeclareHandle( PipeFactory );
@@ -52,6 +53,10 @@ namespace Ic3::System
 
 		virtual FileManagerHandle CreateFileManager() = 0;
 
+		/// @brief Creates a FileWatcher for the current OS. Throws eExcSystemInterfaceNotSupported if file change
+		/// notifications are not implemented for the platform.
+		virtual FileWatcherHandle CreateFileWatcher();
+
 		virtual MetalSystemDriverHandle CreateMetalSystemDriver(
 				DisplayManagerHandle pDisplayManager,
 				const MetalSystemDriverCreateInfo & pCreateInfo );
@@ -0,0 +1,349 @@
+
+#include "TestCommon.h"
+#include <Ic3/NxMain/Renderer/DrawPacketQueue.h>
+
+#include <algorithm>
+#include <random>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		constexpr uint32 kTestPipelineStateObjectsNum = 32;
+		constexpr uint32 kTestVertexSourcesNum = 64;
+		constexpr uint32 kTestMaterialsNum = 512;
+
+		/// Records the commands issued by DrawPacketQueue::Submit(). Draws are identified by baseVertexIndex,
+		/// which the tests set to the index of the packet.
+		struct MockCommandContext
+		{
+			const GCI::GraphicsPipelineStateObject * pipelineStateObject = nullptr;
+			const GCI::VertexSourceBindingDescriptor * vertexSourceBinding = nullptr;
+			uint32 pipelineStateObjectBindsNum = 0;
+			uint32 vertexSourceBindsNum = 0;
+			uint32 constantBufferBindsNum = 0;
+			uint32 textureBindsNum = 0;
+			std::vector<uint32> drawnPacketArray;
+			std::vector<const GCI::GraphicsPipelineStateObject *> drawPipelineStateObjectArray;
+
+			bool SetGraphicsPipelineStateObject( const GCI::GraphicsPipelineStateObject & pPipelineStateObject )
+			{
+				pipelineStateObject = &pPipelineStateObject;
+				++pipelineStateObjectBindsNum;
+				return true;
+			}
+
+			bool SetVertexSourceBindingDescriptor( const GCI::VertexSourceBindingDescriptor & pVertexSourceBinding )
+			{
+				vertexSourceBinding = &pVertexSourceBinding;
+				++vertexSourceBindsNum;
+				return true;
+			}
+
+			bool CmdSetShaderConstantBuffer( GCI::shader_input_ref_id_t, GCI::GPUBuffer & )
+			{
+				++constantBufferBindsNum;
+				return true;
+			}
+
+			bool CmdSetShaderConstantBufferRange( GCI::shader_input_ref_id_t, GCI::GPUBuffer &, const GCI::GPUMemoryRegion & )
+			{
+				++constantBufferBindsNum;
+				return true;
+			}
+
+			bool CmdSetShaderTextureImage( GCI::shader_input_ref_id_t, GCI::Texture & )
+			{
+				++textureBindsNum;
+				return true;
+			}
+
+			bool CmdSetShaderTextureSampler( GCI::shader_input_ref_id_t, GCI::Sampler & )
+			{
+				return true;
+			}
+
+			void CmdDrawDirectIndexed( native_uint, native_uint, native_uint pBaseVertexIndex )
+			{
+				drawnPacketArray.push_back( static_cast<uint32>( pBaseVertexIndex ) );
+				drawPipelineStateObjectArray.push_back( pipelineStateObject );
+			}
+
+			void CmdDrawDirectIndexedInstanced( native_uint, native_uint, native_uint ) {}
+			void CmdDrawDirectNonIndexed( native_uint, native_uint ) {}
+			void CmdDrawDirectNonIndexedInstanced( native_uint, native_uint, native_uint ) {}
+		};
+
+		/// State objects are never dereferenced by the queue, so addresses of dummy bytes are enough.
+		struct TestStateObjects
+		{
+			char pipelineStateObjectArray[kTestPipelineStateObjectsNum];
+			char vertexSourceArray[kTestVertexSourcesNum];
+			DrawPacketMaterial materialArray[kTestMaterialsNum];
+
+			TestStateObjects()
+			{
+				for( auto & material : materialArray )
+				{
+					material.texturesNum = 1;
+					material.textureArray[0].texture = reinterpret_cast<GCI::Texture *>( &material );
+					material.textureArray[0].sampler = nullptr;
+				}
+			}
+		};
+
+		struct TestPacketInfo
+		{
+			DrawPacket packet;
+			uint32 passIndex;
+			float depth;
+		};
+
+		/// Every 10th packet goes to the translucent pass 1 (back-to-front), the rest to the opaque pass 0.
+		std::vector<TestPacketInfo> GenerateTestPackets( TestStateObjects & pStateObjects, size_t pPacketsNum, uint32 pSeed )
+		{
+			std::mt19937 randomGenerator{ pSeed };
+			std::vector<TestPacketInfo> packetInfoArray( pPacketsNum );
+
+			for( size_t packetIndex = 0; packetIndex < pPacketsNum; ++packetIndex )
+			{
+				const auto materialIndex = randomGenerator() % kTestMaterialsNum;
+
+				auto & packetInfo = packetInfoArray[packetIndex];
+				packetInfo.packet.material = &( pStateObjects.materialArray[materialIndex] );
+				packetInfo.packet.pipelineStateObject = reinterpret_cast<const GCI::GraphicsPipelineStateObject *>(
+						&( pStateObjects.pipelineStateObjectArray[materialIndex % kTestPipelineStateObjectsNum] ) );
+				packetInfo.packet.vertexSourceBinding = reinterpret_cast<const GCI::VertexSourceBindingDescriptor *>(
+						&( pStateObjects.vertexSourceArray[randomGenerator() % kTestVertexSourcesNum] ) );
+				packetInfo.packet.elementsNum = 36;
+				packetInfo.packet.baseVertexIndex = static_cast<uint32>( packetIndex );
+				packetInfo.passIndex = ( packetIndex % 10 == 0 ) ? 1 : 0;
+				packetInfo.depth = static_cast<float>( randomGenerator() % 100000 ) * 0.01f;
+			}
+
+			return packetInfoArray;
+		}
+
+		void AddTestPackets( DrawPacketQueue & pQueue, const std::vector<TestPacketInfo> & pPacketInfoArray )
+		{
+			for( const auto & packetInfo : pPacketInfoArray )
+			{
+				const auto depthOrder = ( packetInfo.passIndex == 1 ) ? EDrawPacketDepthOrder::BackToFront : EDrawPacketDepthOrder::FrontToBack;
+				pQueue.AddPacket( packetInfo.passIndex, packetInfo.depth, depthOrder, packetInfo.packet );
+			}
+		}
+
+		/// Reference: state changes of a pass if the packets were drawn in the order of addition.
+		DrawPacketQueueStats CountUnsortedChanges( const std::vector<TestPacketInfo> & pPacketInfoArray, uint32 pPassIndex )
+		{
+			DrawPacketQueueStats unsortedStats{};
+			const void * pipelineStateObject = nullptr;
+			const void * vertexSourceBinding = nullptr;
+			const void * material = nullptr;
+
+			for( const auto & packetInfo : pPacketInfoArray )
+			{
+				if( packetInfo.passIndex != pPassIndex )
+				{
+					continue;
+				}
+				unsortedStats.pipelineStateObjectChangesUnsortedNum += ( packetInfo.packet.pipelineStateObject != pipelineStateObject ) ? 1 : 0;
+				unsortedStats.vertexSourceChangesUnsortedNum += ( packetInfo.packet.vertexSourceBinding != vertexSourceBinding ) ? 1 : 0;
+				unsortedStats.materialChangesUnsortedNum += ( packetInfo.packet.material != material ) ? 1 : 0;
+				pipelineStateObject = packetInfo.packet.pipelineStateObject;
+				vertexSourceBinding = packetInfo.packet.vertexSourceBinding;
+				material = packetInfo.packet.material;
+			}
+
+			return unsortedStats;
+		}
+
+		/// Submits both passes and checks the draw order, the number of binds and the stats.
+		void CheckSubmission( TestContext & pTestContext, DrawPacketQueue & pQueue, const std::vector<TestPacketInfo> & pPacketInfoArray )
+		{
+			MockCommandContext opaqueContext;
+			MockCommandContext translucentContext;
+			const auto opaqueStats = pQueue.Submit( opaqueContext, 0 );
+			const auto translucentStats = pQueue.Submit( translucentContext, 1 );
+
+			// Every packet is drawn exactly once, in its own pass.
+			std::vector<uint32> drawCounts( pPacketInfoArray.size(), 0 );
+			bool passesValid = true;
+			for( const auto packetIndex : opaqueContext.drawnPacketArray )
+			{
+				++drawCounts[packetIndex];
+				passesValid = passesValid && ( pPacketInfoArray[packetIndex].passIndex == 0 );
+			}
+			for( const auto packetIndex : translucentContext.drawnPacketArray )
+			{
+				++drawCounts[packetIndex];
+				passesValid = passesValid && ( pPacketInfoArray[packetIndex].passIndex == 1 );
+			}
+			Ic3TestCheck( passesValid );
+			Ic3TestCheck( std::all_of( drawCounts.begin(), drawCounts.end(), []( uint32 pCount ) { return pCount == 1; } ) );
+
+			// Each draw is executed with its own PSO bound.
+			bool pipelineStateObjectsValid = true;
+			for( size_t drawIndex = 0; drawIndex < opaqueContext.drawnPacketArray.size(); ++drawIndex )
+			{
+				const auto & packet = pPacketInfoArray[opaqueContext.drawnPacketArray[drawIndex]].packet;
+				pipelineStateObjectsValid = pipelineStateObjectsValid && ( opaqueContext.drawPipelineStateObjectArray[drawIndex] == packet.pipelineStateObject );
+			}
+			Ic3TestCheck( pipelineStateObjectsValid );
+
+			// Opaque packets are grouped by state: each PSO used by the pass is bound exactly once.
+			std::vector<const GCI::GraphicsPipelineStateObject *> opaquePipelineStateObjects;
+			for( const auto & packetInfo : pPacketInfoArray )
+			{
+				if( packetInfo.passIndex == 0 )
+				{
+					opaquePipelineStateObjects.push_back( packetInfo.packet.pipelineStateObject );
+				}
+			}
+			std::sort( opaquePipelineStateObjects.begin(), opaquePipelineStateObjects.end() );
+			const auto opaquePipelineStateObjectsNum = std::unique( opaquePipelineStateObjects.begin(), opaquePipelineStateObjects.end() ) - opaquePipelineStateObjects.begin();
+			Ic3TestCheck( opaqueContext.pipelineStateObjectBindsNum == static_cast<uint32>( opaquePipelineStateObjectsNum ) );
+			Ic3TestCheck( opaqueStats.pipelineStateObjectBindsNum == opaqueContext.pipelineStateObjectBindsNum );
+			Ic3TestCheck( opaqueStats.vertexSourceBindsNum == opaqueContext.vertexSourceBindsNum );
+			Ic3TestCheck( opaqueStats.drawsNum == opaqueContext.drawnPacketArray.size() );
+
+			// Translucent packets are drawn back-to-front.
+			bool backToFrontOrderValid = true;
+			for( size_t drawIndex = 1; drawIndex < translucentContext.drawnPacketArray.size(); ++drawIndex )
+			{
+				const auto previousDepth = pPacketInfoArray[translucentContext.drawnPacketArray[drawIndex - 1]].depth;
+				const auto currentDepth = pPacketInfoArray[translucentContext.drawnPacketArray[drawIndex]].depth;
+				backToFrontOrderValid = backToFrontOrderValid && ( currentDepth <= previousDepth + 1e-4f );
+			}
+			Ic3TestCheck( backToFrontOrderValid );
+			Ic3TestCheck( translucentStats.drawsNum == translucentContext.drawnPacketArray.size() );
+
+			// The "unsorted" numbers describe the order of addition.
+			for( const uint32 passIndex : { 0u, 1u } )
+			{
+				const auto expectedStats = CountUnsortedChanges( pPacketInfoArray, passIndex );
+				const auto & submitStats = ( passIndex == 0 ) ? opaqueStats : translucentStats;
+				Ic3TestCheck( submitStats.pipelineStateObjectChangesUnsortedNum == expectedStats.pipelineStateObjectChangesUnsortedNum );
+				Ic3TestCheck( submitStats.vertexSourceChangesUnsortedNum == expectedStats.vertexSourceChangesUnsortedNum );
+				Ic3TestCheck( submitStats.materialChangesUnsortedNum == expectedStats.materialChangesUnsortedNum );
+			}
+		}
+
+	}
+
+	Ic3TestCase( DrawPacketQueue, SubmitOrderAndStats )
+	{
+		TestStateObjects stateObjects;
+
+		// Below and above the threshold of the radix sort.
+		for( const size_t packetsNum : { 200u, 20000u } )
+		{
+			const auto packetInfoArray = GenerateTestPackets( stateObjects, packetsNum, 3 );
+
+			DrawPacketQueue queue;
+			queue.SetDepthRange( 0.1f, 1000.0f );
+
+			// Two frames: sort key IDs are kept between them, the result must be the same.
+			for( uint32 frameIndex = 0; frameIndex < 2; ++frameIndex )
+			{
+				queue.Reset();
+				AddTestPackets( queue, packetInfoArray );
+				queue.Sort();
+				CheckSubmission( pTestContext, queue, packetInfoArray );
+			}
+		}
+	}
+
+	Ic3TestCase( DrawPacketQueue, RepeatedSort )
+	{
+		// Regression: unsorted state changes were counted from the sort entries at the beginning of Sort(),
+		// so a second Sort() counted the already sorted order.
+		TestStateObjects stateObjects;
+		const auto packetInfoArray = GenerateTestPackets( stateObjects, 5000, 5 );
+
+		DrawPacketQueue queue;
+		queue.SetDepthRange( 0.1f, 1000.0f );
+		AddTestPackets( queue, packetInfoArray );
+
+		queue.Sort();
+		CheckSubmission( pTestContext, queue, packetInfoArray );
+
+		queue.Sort();
+		CheckSubmission( pTestContext, queue, packetInfoArray );
+
+		// Packets added after a sort: the stats cover all packets, in the order of addition.
+		const auto morePacketInfoArray = GenerateTestPackets( stateObjects, 1000, 6 );
+		auto allPacketInfoArray = packetInfoArray;
+		for( auto packetInfo : morePacketInfoArray )
+		{
+			packetInfo.packet.baseVertexIndex += static_cast<uint32>( packetInfoArray.size() );
+			allPacketInfoArray.push_back( packetInfo );
+		}
+		AddTestPackets( queue, std::vector<TestPacketInfo>( allPacketInfoArray.begin() + packetInfoArray.size(), allPacketInfoArray.end() ) );
+
+		queue.Sort();
+		CheckSubmission( pTestContext, queue, allPacketInfoArray );
+	}
+
+	Ic3TestBenchmark( DrawPacketQueue, SortAndSubmit )
+	{
+		TestStateObjects stateObjects;
+
+		std::vector<size_t> packetsNumArray{ 1000, 10000 };
+		if( !pTestContext.IsQuickMode() )
+		{
+			packetsNumArray.push_back( 100000 );
+		}
+
+		for( const auto packetsNum : packetsNumArray )
+		{
+			const auto packetInfoArray = GenerateTestPackets( stateObjects, packetsNum, 3 );
+
+			DrawPacketQueue queue;
+			queue.SetDepthRange( 0.1f, 1000.0f );
+
+			double sortMs = 0.0;
+			double submitMs = 0.0;
+			DrawPacketQueueStats opaqueStats{};
+
+			// The first frame assigns the sort key IDs, the last one is measured.
+			for( uint32 frameIndex = 0; frameIndex < 3; ++frameIndex )
+			{
+				queue.Reset();
+				AddTestPackets( queue, packetInfoArray );
+
+				Stopwatch stopwatch;
+				queue.Sort();
+				sortMs = stopwatch.GetElapsedMilliseconds();
+
+				MockCommandContext opaqueContext;
+				MockCommandContext translucentContext;
+				stopwatch.Restart();
+				opaqueStats = queue.Submit( opaqueContext, 0 );
+				queue.Submit( translucentContext, 1 );
+				submitMs = stopwatch.GetElapsedMilliseconds();
+			}
+
+			// Comparison sort of the same number of random 64-bit keys.
+			std::mt19937_64 randomGenerator{ 1 };
+			std::vector<uint64> randomKeys( packetsNum );
+			for( auto & randomKey : randomKeys )
+			{
+				randomKey = randomGenerator();
+			}
+			Stopwatch stopwatch;
+			std::sort( randomKeys.begin(), randomKeys.end() );
+			const auto stdSortMs = stopwatch.GetElapsedMilliseconds();
+
+			TestOutput( "  %6zu packets: sort %7.3f ms (std::sort %7.3f ms), submit %7.3f ms", packetsNum, sortMs, stdSortMs, submitMs );
+			TestOutput( "  %6s opaque:  PSO binds %5u (unsorted %6u), VS binds %5u (unsorted %6u), material binds %5u (unsorted %6u)",
+			            "",
+			            opaqueStats.pipelineStateObjectBindsNum, opaqueStats.pipelineStateObjectChangesUnsortedNum,
+			            opaqueStats.vertexSourceBindsNum, opaqueStats.vertexSourceChangesUnsortedNum,
+			            opaqueStats.materialBindsNum, opaqueStats.materialChangesUnsortedNum );
+		}
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,354 @@
+
+#include "TestCommon.h"
+#include <Ic3/NxMain/Res/Font/FontDistanceField.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		/// Returns true if the point (in pixels of the coverage image) is inside the shape.
+		using TestShapeFunction = std::function<bool( float, float )>;
+
+		struct TestShape
+		{
+			const char * name;
+			uint32 width;
+			uint32 height;
+			TestShapeFunction insideFunction;
+		};
+
+		struct TestCoverageImage
+		{
+			std::vector<byte> data;
+			FontImageData imageData;
+		};
+
+		/// Renders the anti-aliased coverage image of the shape (4x4 samples per pixel), like a glyph rasterizer does.
+		TestCoverageImage RenderCoverageImage( const TestShape & pShape )
+		{
+			TestCoverageImage coverageImage;
+			coverageImage.data.resize( pShape.width * pShape.height );
+
+			for( uint32 pixelY = 0; pixelY < pShape.height; ++pixelY )
+			{
+				for( uint32 pixelX = 0; pixelX < pShape.width; ++pixelX )
+				{
+					uint32 coveredSamplesNum = 0;
+					for( uint32 sampleIndex = 0; sampleIndex < 16; ++sampleIndex )
+					{
+						const auto sampleX = static_cast<float>( pixelX ) + ( static_cast<float>( sampleIndex % 4 ) + 0.5f ) * 0.25f;
+						const auto sampleY = static_cast<float>( pixelY ) + ( static_cast<float>( sampleIndex / 4 ) + 0.5f ) * 0.25f;
+						coveredSamplesNum += pShape.insideFunction( sampleX, sampleY ) ? 1 : 0;
+					}
+					coverageImage.data[pixelY * pShape.width + pixelX] = static_cast<byte>( std::min( coveredSamplesNum * 16u, 255u ) );
+				}
+			}
+
+			coverageImage.imageData.data = coverageImage.data.data();
+			coverageImage.imageData.dataSize = coverageImage.data.size();
+			coverageImage.imageData.dataRowPitch = pShape.width;
+			coverageImage.imageData.width = pShape.width;
+			coverageImage.imageData.height = pShape.height;
+
+			return coverageImage;
+		}
+
+		bool IsInsideRoundedRect( float pX, float pY, float pLeft, float pTop, float pRight, float pBottom, float pRadius )
+		{
+			const auto nearestX = std::clamp( pX, pLeft + pRadius, pRight - pRadius );
+			const auto nearestY = std::clamp( pY, pTop + pRadius, pBottom - pRadius );
+			return std::hypot( pX - nearestX, pY - nearestY ) <= pRadius;
+		}
+
+		bool IsInsideStroke( float pX, float pY, float pX0, float pY0, float pX1, float pY1, float pHalfWidth )
+		{
+			const auto segmentX = pX1 - pX0;
+			const auto segmentY = pY1 - pY0;
+			const auto segmentPos = std::clamp( ( ( pX - pX0 ) * segmentX + ( pY - pY0 ) * segmentY ) / ( segmentX * segmentX + segmentY * segmentY ), 0.0f, 1.0f );
+			return std::hypot( pX - ( pX0 + segmentPos * segmentX ), pY - ( pY0 + segmentPos * segmentY ) ) <= pHalfWidth;
+		}
+
+		/// Glyph-like shapes (scaled by pScale): counters, thin diagonal stems, serifs, separate components.
+		std::vector<TestShape> CreateTestShapes( float pScale )
+		{
+			const auto size = []( float pSize, float pScale ) { return static_cast<uint32>( pSize * pScale ); };
+
+			std::vector<TestShape> shapes;
+
+			shapes.push_back( TestShape{ "o", size( 24, pScale ), size( 24, pScale ), [pScale]( float pX, float pY ) {
+				const auto distance = std::hypot( pX - 12.0f * pScale, pY - 12.0f * pScale );
+				return ( distance <= 11.0f * pScale ) && ( distance >= 7.0f * pScale );
+			} } );
+
+			shapes.push_back( TestShape{ "A", size( 26, pScale ), size( 30, pScale ), [pScale]( float pX, float pY ) {
+				return IsInsideStroke( pX, pY, 2.5f * pScale, 28.0f * pScale, 13.0f * pScale, 2.0f * pScale, 1.6f * pScale ) ||
+				       IsInsideStroke( pX, pY, 23.5f * pScale, 28.0f * pScale, 13.0f * pScale, 2.0f * pScale, 1.6f * pScale ) ||
+				       IsInsideStroke( pX, pY, 7.0f * pScale, 19.0f * pScale, 19.0f * pScale, 19.0f * pScale, 1.2f * pScale );
+			} } );
+
+			shapes.push_back( TestShape{ "i", size( 10, pScale ), size( 30, pScale ), [pScale]( float pX, float pY ) {
+				return IsInsideRoundedRect( pX, pY, 3.0f * pScale, 10.0f * pScale, 7.0f * pScale, 28.0f * pScale, 0.5f * pScale ) ||
+				       ( std::hypot( pX - 5.0f * pScale, pY - 4.0f * pScale ) <= 2.5f * pScale );
+			} } );
+
+			shapes.push_back( TestShape{ "B", size( 22, pScale ), size( 30, pScale ), [pScale]( float pX, float pY ) {
+				const bool outer = IsInsideRoundedRect( pX, pY, 2.0f * pScale, 2.0f * pScale, 20.0f * pScale, 28.0f * pScale, 5.0f * pScale );
+				const bool upperCounter = IsInsideRoundedRect( pX, pY, 6.0f * pScale, 6.0f * pScale, 16.0f * pScale, 13.0f * pScale, 2.5f * pScale );
+				const bool lowerCounter = IsInsideRoundedRect( pX, pY, 6.0f * pScale, 17.0f * pScale, 16.0f * pScale, 24.0f * pScale, 2.5f * pScale );
+				return outer && !upperCounter && !lowerCounter;
+			} } );
+
+			shapes.push_back( TestShape{ "comma", size( 8, pScale ), size( 10, pScale ), [pScale]( float pX, float pY ) {
+				return ( std::hypot( pX - 4.0f * pScale, pY - 3.5f * pScale ) <= 2.5f * pScale ) ||
+				       IsInsideStroke( pX, pY, 5.5f * pScale, 4.0f * pScale, 2.5f * pScale, 9.0f * pScale, 1.0f * pScale );
+			} } );
+
+			return shapes;
+		}
+
+		/// Reference distance field, computed with the same conventions as the generator (coverage >= 128 is inside,
+		/// distance between pixel centers minus 0.5, averaged over oversampling blocks), but with the exact Euclidean
+		/// distance found by a brute-force search instead of the 8SSEDT propagation.
+		void GenerateReferenceDistanceField(
+				const FontImageData & pCoverageImage,
+				uint32 pSpread,
+				uint32 pOversampling,
+				std::vector<byte> & pOutImageData,
+				cxm::vec2u32 & pOutImageDimensions )
+		{
+			const auto inputPadding = static_cast<int32>( pSpread * pOversampling );
+			const auto outputWidth = ( pCoverageImage.width + 2 * inputPadding + pOversampling - 1 ) / pOversampling;
+			const auto outputHeight = ( pCoverageImage.height + 2 * inputPadding + pOversampling - 1 ) / pOversampling;
+			const auto inputWidth = static_cast<int32>( outputWidth * pOversampling );
+			const auto inputHeight = static_cast<int32>( outputHeight * pOversampling );
+
+			std::vector<uint8> insideMask( inputWidth * inputHeight, 0 );
+			for( int32 inputY = 0; inputY < inputHeight; ++inputY )
+			{
+				for( int32 inputX = 0; inputX < inputWidth; ++inputX )
+				{
+					const auto imageX = inputX - inputPadding;
+					const auto imageY = inputY - inputPadding;
+					if( ( imageX >= 0 ) && ( imageY >= 0 ) && ( imageX < static_cast<int32>( pCoverageImage.width ) ) && ( imageY < static_cast<int32>( pCoverageImage.height ) ) )
+					{
+						insideMask[inputY * inputWidth + inputX] = ( pCoverageImage.data[imageY * pCoverageImage.dataRowPitch + imageX] >= 128 ) ? 1 : 0;
+					}
+				}
+			}
+
+			// The nearest pixel of the opposite kind always lies on the boundary of its region, so only boundary
+			// pixels (with a neighbour of the other kind) are searched.
+			std::vector<cxm::vec2i32> insideBoundary;
+			std::vector<cxm::vec2i32> outsideBoundary;
+			for( int32 inputY = 0; inputY < inputHeight; ++inputY )
+			{
+				for( int32 inputX = 0; inputX < inputWidth; ++inputX )
+				{
+					const bool inside = insideMask[inputY * inputWidth + inputX] != 0;
+					bool boundary = false;
+					for( int32 neighbourY = std::max( inputY - 1, 0 ); neighbourY <= std::min( inputY + 1, inputHeight - 1 ); ++neighbourY )
+					{
+						for( int32 neighbourX = std::max( inputX - 1, 0 ); neighbourX <= std::min( inputX + 1, inputWidth - 1 ); ++neighbourX )
+						{
+							boundary = boundary || ( ( insideMask[neighbourY * inputWidth + neighbourX] != 0 ) != inside );
+						}
+					}
+					if( boundary )
+					{
+						( inside ? insideBoundary : outsideBoundary ).push_back( cxm::vec2i32{ inputX, inputY } );
+					}
+				}
+			}
+
+			pOutImageDimensions = cxm::vec2u32{ outputWidth, outputHeight };
+			pOutImageData.resize( outputWidth * outputHeight );
+
+			std::vector<float> rowDistanceSum( outputWidth );
+			for( uint32 outputY = 0; outputY < outputHeight; ++outputY )
+			{
+				std::fill( rowDistanceSum.begin(), rowDistanceSum.end(), 0.0f );
+
+				for( uint32 blockY = 0; blockY < pOversampling; ++blockY )
+				{
+					const auto inputY = static_cast<int32>( outputY * pOversampling + blockY );
+					for( int32 inputX = 0; inputX < inputWidth; ++inputX )
+					{
+						const bool inside = insideMask[inputY * inputWidth + inputX] != 0;
+
+						int64 nearestDistanceSq = std::numeric_limits<int64>::max();
+						for( const auto & boundaryPixel : ( inside ? outsideBoundary : insideBoundary ) )
+						{
+							const int64 offsetX = boundaryPixel.x - inputX;
+							const int64 offsetY = boundaryPixel.y - inputY;
+							nearestDistanceSq = std::min( nearestDistanceSq, offsetX * offsetX + offsetY * offsetY );
+						}
+
+						const auto distance = std::sqrt( static_cast<float>( nearestDistanceSq ) );
+						rowDistanceSum[inputX / pOversampling] += inside ? ( distance - 0.5f ) : ( 0.5f - distance );
+					}
+				}
+
+				for( uint32 outputX = 0; outputX < outputWidth; ++outputX )
+				{
+					const auto blockSize = static_cast<float>( pOversampling * pOversampling );
+					const auto encodedValue = 128.0f + rowDistanceSum[outputX] * 127.0f / ( static_cast<float>( pSpread * pOversampling ) * blockSize );
+					pOutImageData[outputY * outputWidth + outputX] = static_cast<byte>( std::clamp( encodedValue + 0.5f, 0.0f, 255.0f ) );
+				}
+			}
+		}
+
+	}
+
+	Ic3TestCase( FontDistanceField, MatchesBruteForceReference )
+	{
+		// 8SSEDT is not exact (some configurations propagate a slightly farther seed), so a few pixels may differ
+		// from the exact field by a small fraction of a pixel.
+		FontDistanceFieldGenerator generator;
+
+		for( const uint32 oversampling : { 1u, 4u } )
+		{
+			for( const auto & shape : CreateTestShapes( static_cast<float>( oversampling ) ) )
+			{
+				const auto coverageImage = RenderCoverageImage( shape );
+
+				std::vector<byte> fieldImage;
+				cxm::vec2u32 fieldDimensions;
+				const bool generated = generator.Generate( coverageImage.imageData, 4, oversampling, fieldImage, fieldDimensions );
+				Ic3TestCheck( generated );
+
+				std::vector<byte> referenceImage;
+				cxm::vec2u32 referenceDimensions;
+				GenerateReferenceDistanceField( coverageImage.imageData, 4, oversampling, referenceImage, referenceDimensions );
+
+				Ic3TestCheck( ( fieldDimensions.x == referenceDimensions.x ) && ( fieldDimensions.y == referenceDimensions.y ) );
+				if( !generated || ( fieldImage.size() != referenceImage.size() ) )
+				{
+					continue;
+				}
+
+				int32 maxDifference = 0;
+				size_t differentPixelsNum = 0;
+				for( size_t pixelIndex = 0; pixelIndex < fieldImage.size(); ++pixelIndex )
+				{
+					const auto difference = std::abs( static_cast<int32>( fieldImage[pixelIndex] ) - static_cast<int32>( referenceImage[pixelIndex] ) );
+					maxDifference = std::max( maxDifference, difference );
+					differentPixelsNum += ( difference > 1 ) ? 1 : 0;
+				}
+
+				// With spread 4, one unit is 1/32 of a pixel of the output.
+				Ic3TestCheck( maxDifference <= 2 );
+				Ic3TestCheck( differentPixelsNum * 100 <= fieldImage.size() );
+
+				if( !pTestContext.IsQuickMode() )
+				{
+					TestOutput( "  %-6s oversampling %u: %3ux%-3u max difference %d, pixels off by more than 1: %zu",
+					            shape.name, oversampling, fieldDimensions.x, fieldDimensions.y, maxDifference, differentPixelsNum );
+				}
+			}
+		}
+	}
+
+	Ic3TestCase( FontDistanceField, DiscMatchesAnalyticDistance )
+	{
+		// The encoded distance of a disc (which the threshold turns into a pixelated circle) stays within
+		// a pixel of the analytic distance to the circle everywhere inside the spread.
+		const uint32 imageSize = 64;
+		const uint32 spread = 8;
+		const float radius = 20.0f;
+		const float center = 32.0f;
+
+		const TestShape disc{ "disc", imageSize, imageSize, [&]( float pX, float pY ) {
+			return std::hypot( pX - center, pY - center ) <= radius;
+		} };
+		const auto coverageImage = RenderCoverageImage( disc );
+
+		FontDistanceFieldGenerator generator;
+		std::vector<byte> fieldImage;
+		cxm::vec2u32 fieldDimensions;
+		Ic3TestCheck( generator.Generate( coverageImage.imageData, spread, 1, fieldImage, fieldDimensions ) );
+		Ic3TestCheck( ( fieldDimensions.x == imageSize + 2 * spread ) && ( fieldDimensions.y == imageSize + 2 * spread ) );
+
+		float maxError = 0.0f;
+		for( uint32 pixelY = 0; pixelY < fieldDimensions.y; ++pixelY )
+		{
+			for( uint32 pixelX = 0; pixelX < fieldDimensions.x; ++pixelX )
+			{
+				const auto centerX = static_cast<float>( pixelX ) - static_cast<float>( spread ) + 0.5f;
+				const auto centerY = static_cast<float>( pixelY ) - static_cast<float>( spread ) + 0.5f;
+				const auto analyticDistance = radius - std::hypot( centerX - center, centerY - center );
+				if( std::fabs( analyticDistance ) < static_cast<float>( spread - 1 ) )
+				{
+					const auto encodedValue = static_cast<float>( fieldImage.empty() ? 128 : fieldImage[pixelY * fieldDimensions.x + pixelX] );
+					const auto decodedDistance = ( encodedValue - 128.0f ) * static_cast<float>( spread ) / 127.0f;
+					maxError = std::max( maxError, std::fabs( decodedDistance - analyticDistance ) );
+				}
+			}
+		}
+
+		Ic3TestCheck( maxError < 1.0f );
+	}
+
+	Ic3TestCase( FontDistanceField, RejectsInvalidInput )
+	{
+		FontDistanceFieldGenerator generator;
+		std::vector<byte> fieldImage;
+		cxm::vec2u32 fieldDimensions;
+
+		// Empty image and an image without any inside pixels.
+		std::vector<byte> emptyCoverage( 16 * 16, 0 );
+		FontImageData coverageImage;
+		coverageImage.data = emptyCoverage.data();
+		coverageImage.dataSize = emptyCoverage.size();
+		coverageImage.dataRowPitch = 16;
+		coverageImage.width = 16;
+		coverageImage.height = 16;
+		Ic3TestCheck( !generator.Generate( coverageImage, 4, 1, fieldImage, fieldDimensions ) );
+
+		coverageImage.width = 0;
+		Ic3TestCheck( !generator.Generate( coverageImage, 4, 1, fieldImage, fieldDimensions ) );
+	}
+
+	Ic3TestBenchmark( FontDistanceField, GenerationThroughput )
+	{
+		// Glyph-like shapes at a ~32 px font size, spread 4, without and with the 4x oversampling.
+		FontDistanceFieldGenerator generator;
+		std::vector<byte> fieldImage;
+		cxm::vec2u32 fieldDimensions;
+
+		for( const uint32 oversampling : { 1u, 4u } )
+		{
+			std::vector<TestCoverageImage> coverageImages;
+			size_t inputPixelsNum = 0;
+			for( const auto & shape : CreateTestShapes( static_cast<float>( oversampling ) ) )
+			{
+				coverageImages.push_back( RenderCoverageImage( shape ) );
+				generator.Generate( coverageImages.back().imageData, 4, oversampling, fieldImage, fieldDimensions );
+				inputPixelsNum += static_cast<size_t>( fieldDimensions.x * fieldDimensions.y ) * oversampling * oversampling;
+			}
+
+			const uint32 roundsNum = pTestContext.SelectSize( 20u, oversampling == 1 ? 20000u : 1000u );
+
+			Stopwatch stopwatch;
+			for( uint32 roundIndex = 0; roundIndex < roundsNum; ++roundIndex )
+			{
+				for( const auto & coverageImage : coverageImages )
+				{
+					generator.Generate( coverageImage.imageData, 4, oversampling, fieldImage, fieldDimensions );
+				}
+			}
+			const auto elapsedMs = stopwatch.GetElapsedMilliseconds();
+
+			const auto glyphsNum = static_cast<double>( coverageImages.size() * roundsNum );
+			TestOutput( "  oversampling %u: %8.0f glyphs/s, %.1f us/glyph, %.1f M input pixels/s",
+			            oversampling, glyphsNum / ( elapsedMs * 1e-3 ), elapsedMs * 1e3 / glyphsNum,
+			            static_cast<double>( inputPixelsNum * roundsNum ) / ( elapsedMs * 1e3 ) );
+		}
+	}
+
+} // namespace Ic3::Samples
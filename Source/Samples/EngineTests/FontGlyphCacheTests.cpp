@@ -0,0 +1,289 @@
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+#include <Ic3/NxMain/Res/Font/FTDFreeTypeFontObject.h>
+#include <Ic3/NxMain/Res/Font/FTDGlyphCache.h>
+#include <Ic3/NxMain/Res/Font/FontTypeDynamic.h>
+#include <Ic3/NxMain/Res/FontTextLayout.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		constexpr const char * kTestFontAssetPath = "fonts/ftf-calibri.ttf";
+
+		constexpr uint32 kTestFontSize = 32;
+
+		FreeTypeFontObjectPtr LoadTestFont( const std::vector<byte> & pFontData, EFontGlyphImageType pGlyphImageType )
+		{
+			auto fontObject = FreeTypeFontObject::createFromMemory( pFontData.data(), pFontData.size() );
+			if( !fontObject || !fontObject->loadFace( kTestFontSize ) || !fontObject->SetActiveFace( kTestFontSize, { 0, 0 } ) )
+			{
+				return nullptr;
+			}
+
+			if( pGlyphImageType != EFontGlyphImageType::Coverage )
+			{
+				fontObject->setGlyphImageType( pGlyphImageType, FontDistanceFieldDesc{} );
+			}
+
+			return fontObject;
+		}
+
+		const char * GetGlyphImageTypeName( EFontGlyphImageType pGlyphImageType )
+		{
+			return ( pGlyphImageType == EFontGlyphImageType::Coverage ) ? "coverage" : "sdf";
+		}
+
+		std::vector<char_code_point_t> MakeCodePointRange( char_code_point_t pFirst, char_code_point_t pLast )
+		{
+			std::vector<char_code_point_t> codePoints;
+			for( auto codePoint = pFirst; codePoint <= pLast; ++codePoint )
+			{
+				codePoints.push_back( codePoint );
+			}
+			return codePoints;
+		}
+
+		/// Large enough for all glyphs of the test font (coverage images are LCD ones, three samples per pixel,
+		/// so they need ~4 layers), so nothing is evicted during the preload.
+		DynamicFontGlyphCacheCreateInfo MakeTestCacheCreateInfo()
+		{
+			DynamicFontGlyphCacheCreateInfo createInfo;
+			createInfo.layerDimensions = { 1024, 1024 };
+			createInfo.layersNum = 6;
+			return createInfo;
+		}
+
+		/// Checks that both caches hold the same glyphs at the same places, with the same atlas contents and dirty regions.
+		bool CompareGlyphCaches(
+				DynamicFontGlyphCache & pFirstCache,
+				DynamicFontGlyphCache & pSecondCache,
+				const std::vector<char_code_point_t> & pCodePoints )
+		{
+			if( ( pFirstCache.GetStats().cachedGlyphsNum != pSecondCache.GetStats().cachedGlyphsNum ) ||
+			    ( pFirstCache.GetDirtyRegions().size() != pSecondCache.GetDirtyRegions().size() ) )
+			{
+				return false;
+			}
+
+			for( uint32 layerIndex = 0; layerIndex < pFirstCache.GetLayersNum(); ++layerIndex )
+			{
+				const auto & firstImage = pFirstCache.GetLayerImageData( layerIndex );
+				const auto & secondImage = pSecondCache.GetLayerImageData( layerIndex );
+				if( ( firstImage.size() != secondImage.size() ) || ( std::memcmp( firstImage.data(), secondImage.data(), firstImage.size() ) != 0 ) )
+				{
+					return false;
+				}
+			}
+
+			for( size_t regionIndex = 0; regionIndex < pFirstCache.GetDirtyRegions().size(); ++regionIndex )
+			{
+				const auto & firstRegion = pFirstCache.GetDirtyRegions()[regionIndex];
+				const auto & secondRegion = pSecondCache.GetDirtyRegions()[regionIndex];
+				if( ( firstRegion.layerIndex != secondRegion.layerIndex ) ||
+				    ( firstRegion.offset.x != secondRegion.offset.x ) || ( firstRegion.offset.y != secondRegion.offset.y ) ||
+				    ( firstRegion.size.x != secondRegion.size.x ) || ( firstRegion.size.y != secondRegion.size.y ) )
+				{
+					return false;
+				}
+			}
+
+			// Both caches already contain all glyphs, so GetGlyph() only looks them up.
+			for( const auto codePoint : pCodePoints )
+			{
+				const auto * firstGlyph = pFirstCache.GetGlyph( codePoint );
+				const auto * secondGlyph = pSecondCache.GetGlyph( codePoint );
+				if( !firstGlyph || !secondGlyph )
+				{
+					if( firstGlyph != secondGlyph )
+					{
+						return false;
+					}
+					continue;
+				}
+
+				const auto & firstRect = firstGlyph->imageRef.rect;
+				const auto & secondRect = secondGlyph->imageRef.rect;
+				if( ( firstGlyph->imageRef.imageIndex != secondGlyph->imageRef.imageIndex ) ||
+				    ( firstRect.offset.x != secondRect.offset.x ) || ( firstRect.offset.y != secondRect.offset.y ) ||
+				    ( firstRect.size.x != secondRect.size.x ) || ( firstRect.size.y != secondRect.size.y ) ||
+				    ( firstGlyph->metrics.advance.x != secondGlyph->metrics.advance.x ) ||
+				    ( firstGlyph->metrics.bearing.x != secondGlyph->metrics.bearing.x ) ||
+				    ( firstGlyph->metrics.bearing.y != secondGlyph->metrics.bearing.y ) )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	}
+
+	Ic3TestCase( FontGlyphCache, ParallelPreloadMatchesSerial )
+	{
+		// Glyphs rasterized by the worker threads are placed in the order of the code points, so the atlas built
+		// with a thread pool must be identical to the one built serially (including the dirty regions).
+		std::vector<byte> fontData;
+		if( !Ic3TestCheck( ReadTestAssetFile( kTestFontAssetPath, fontData ) ) )
+		{
+			return;
+		}
+
+		const auto codePoints = MakeCodePointRange( 32, pTestContext.SelectSize( 0x17Fu, 0x52Fu ) );
+
+		for( const auto glyphImageType : { EFontGlyphImageType::Coverage, EFontGlyphImageType::SignedDistanceField } )
+		{
+			auto fontObject = LoadTestFont( fontData, glyphImageType );
+			if( !Ic3TestCheck( fontObject ) )
+			{
+				return;
+			}
+
+			DynamicFontGlyphCache serialCache{ *fontObject, MakeTestCacheCreateInfo() };
+			const auto serialGlyphsNum = serialCache.PreloadGlyphs( codePoints, true );
+			Ic3TestCheck( serialGlyphsNum > 0 );
+
+			for( const uint32 workerThreadsNum : { 0u, 1u, 3u } )
+			{
+				WorkerThreadPool workerThreadPool{ workerThreadsNum };
+
+				DynamicFontGlyphCache parallelCache{ *fontObject, MakeTestCacheCreateInfo() };
+				const auto parallelGlyphsNum = parallelCache.PreloadGlyphs( codePoints, true, &workerThreadPool );
+
+				Ic3TestCheck( parallelGlyphsNum == serialGlyphsNum );
+				Ic3TestCheck( CompareGlyphCaches( serialCache, parallelCache, codePoints ) );
+			}
+		}
+	}
+
+	Ic3TestCase( FontGlyphCache, CachedTextRunKeepsGlyphs )
+	{
+		// A run reused from the TextLayoutCache is drawn in the current frame, so laying out other text later in the
+		// same frame must not evict its glyphs and overwrite their atlas area. The atlas (one small layer) has space
+		// for much fewer glyphs than the second text needs.
+		std::vector<byte> fontData;
+		if( !Ic3TestCheck( ReadTestAssetFile( kTestFontAssetPath, fontData ) ) )
+		{
+			return;
+		}
+
+		auto fontObject = LoadTestFont( fontData, EFontGlyphImageType::SignedDistanceField );
+		if( !Ic3TestCheck( fontObject ) )
+		{
+			return;
+		}
+
+		DynamicFontDesc fontDesc;
+		fontDesc.fontSize = kTestFontSize;
+		fontDesc.glyphImageType = EFontGlyphImageType::SignedDistanceField;
+
+		DynamicFontGlyphCacheCreateInfo glyphCacheCreateInfo;
+		glyphCacheCreateInfo.layerDimensions = { 160, 160 };
+		glyphCacheCreateInfo.layersNum = 1;
+
+		// "class" is needed, DynamicFont alone names the EFontBaseType enumerator.
+		class DynamicFont font{ fontDesc, *fontObject, glyphCacheCreateInfo };
+		auto & glyphCache = font.getGlyphCache();
+
+		TextLayoutCache layoutCache;
+		const TextLayoutDesc layoutDesc{};
+
+		// Frame 1: the label is laid out.
+		glyphCache.BeginFrame();
+		const auto & labelRun = layoutCache.GetRun( font, "Wg", layoutDesc );
+		Ic3TestCheck( labelRun.glyphQuads.size() == 2 );
+		Ic3TestCheck( labelRun.glyphCodePoints.size() == 2 );
+
+		// Atlas pixels of the label's quads (what is sampled when the run is drawn).
+		const auto readLabelPixels = [&]( const TextLayoutRun & pRun ) -> std::vector<byte> {
+			std::vector<byte> pixels;
+			const auto & layerImage = glyphCache.GetLayerImageData( 0 );
+			for( const auto & glyphQuad : pRun.glyphQuads )
+			{
+				const auto left = static_cast<uint32>( glyphQuad.texRect.x * 160.0f + 0.5f );
+				const auto top = static_cast<uint32>( glyphQuad.texRect.y * 160.0f + 0.5f );
+				const auto right = static_cast<uint32>( glyphQuad.texRect.z * 160.0f + 0.5f );
+				const auto bottom = static_cast<uint32>( glyphQuad.texRect.w * 160.0f + 0.5f );
+				for( uint32 pixelY = top; pixelY < bottom; ++pixelY )
+				{
+					pixels.insert( pixels.end(), layerImage.data() + pixelY * 160 + left, layerImage.data() + pixelY * 160 + right );
+				}
+			}
+			return pixels;
+		};
+		const auto labelPixels = readLabelPixels( labelRun );
+
+		// Frame 2: the label comes from the cache, then a long text not seen before is laid out.
+		glyphCache.BeginFrame();
+		const auto & cachedLabelRun = layoutCache.GetRun( font, "Wg", layoutDesc );
+		Ic3TestCheck( layoutCache.GetStats().runHitsNum == 1 );
+
+		( void )layoutCache.GetRun( font, "ABCDEFHIJKLMNOPQRSTUVXYZabcdefhijklmnopqrstuvxyz0123456789", layoutDesc );
+		Ic3TestCheck( glyphCache.GetStats().glyphAllocationFailuresNum > 0 );
+
+		Ic3TestCheck( glyphCache.GetGlyph( 'W' ) && glyphCache.GetGlyph( 'g' ) );
+		Ic3TestCheck( readLabelPixels( cachedLabelRun ) == labelPixels );
+	}
+
+	Ic3TestBenchmark( FontGlyphCache, ParallelPreload )
+	{
+		// Preload of a large set (the Basic Multilingual Plane, i.e. every glyph of the font) at 32 px,
+		// serially and with thread pools of different sizes.
+		std::vector<byte> fontData;
+		if( !Ic3TestCheck( ReadTestAssetFile( kTestFontAssetPath, fontData ) ) )
+		{
+			return;
+		}
+
+		const auto codePoints = MakeCodePointRange( 32, pTestContext.SelectSize( 0x52Fu, 0xFFFFu ) );
+		const auto hardwareThreadsNum = std::max( std::thread::hardware_concurrency(), 1u );
+
+		TestOutput( "  %zu code points, %u hardware threads", codePoints.size(), hardwareThreadsNum );
+
+		for( const auto glyphImageType : { EFontGlyphImageType::Coverage, EFontGlyphImageType::SignedDistanceField } )
+		{
+			auto fontObject = LoadTestFont( fontData, glyphImageType );
+			if( !Ic3TestCheck( fontObject ) )
+			{
+				return;
+			}
+
+			Stopwatch stopwatch;
+			DynamicFontGlyphCache serialCache{ *fontObject, MakeTestCacheCreateInfo() };
+			const auto glyphsNum = serialCache.PreloadGlyphs( codePoints, true );
+			const auto serialMs = stopwatch.GetElapsedMilliseconds();
+
+			TestOutput( "  %-8s: %u glyphs, serial %8.1f ms", GetGlyphImageTypeName( glyphImageType ), glyphsNum, serialMs );
+
+			std::vector<uint32> workerThreadsNumList{ 1u, 3u, 7u };
+			if( ( hardwareThreadsNum > 1 ) && ( std::find( workerThreadsNumList.begin(), workerThreadsNumList.end(), hardwareThreadsNum - 1 ) == workerThreadsNumList.end() ) )
+			{
+				workerThreadsNumList.push_back( hardwareThreadsNum - 1 );
+			}
+
+			// The calling thread takes part in the work, so a pool with N workers runs on N + 1 threads.
+			for( const auto workerThreadsNum : workerThreadsNumList )
+			{
+				WorkerThreadPool workerThreadPool{ workerThreadsNum };
+
+				stopwatch.Restart();
+				DynamicFontGlyphCache parallelCache{ *fontObject, MakeTestCacheCreateInfo() };
+				parallelCache.PreloadGlyphs( codePoints, true, &workerThreadPool );
+				const auto parallelMs = stopwatch.GetElapsedMilliseconds();
+
+				TestOutput( "  %-8s: %2u threads %8.1f ms, speedup %.2fx, identical atlas: %s",
+				            GetGlyphImageTypeName( glyphImageType ), workerThreadsNum + 1, parallelMs, serialMs / parallelMs,
+				            CompareGlyphCaches( serialCache, parallelCache, codePoints ) ? "yes" : "NO" );
+			}
+		}
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,441 @@
+
+// Some of the tests below expect GDS errors (exceptions). In debug builds, ThrowException() breaks into the debugger
+// before throwing, which kills the process when no debugger is attached.
+#define CPPX_CONFIG_CORE_ENABLE_DEBUG 0
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Utility/GDSStream.h>
+
+#include <map>
+#include <unordered_map>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		enum class ETestEnum : uint16
+		{
+			First = 1,
+			Second = 0x1234
+		};
+
+		struct TestPod
+		{
+			uint32 id;
+			uint16 flags;
+			uint8 bytes[6];
+		};
+
+		/// User type serialized through the GdsSerializable member functions.
+		struct TestRecord : public GdsSerializable
+		{
+			std::string name;
+			std::vector<uint32> values;
+			std::pair<int32, ETestEnum> tag{ 0, ETestEnum::First };
+
+			gds_size_t evalByteSize() const
+			{
+				return GDSCore::evalByteSizeAll( name, values, tag );
+			}
+
+			gds_size_t serialize( byte * pOutputBuffer ) const
+			{
+				return GDSCore::serializeAll( pOutputBuffer, name, values, tag );
+			}
+
+			gds_size_t deserialize( const byte * pInputData )
+			{
+				return GDSCore::deserializeAll( pInputData, name, values, tag );
+			}
+
+			bool operator==( const TestRecord & pOther ) const
+			{
+				return ( name == pOther.name ) && ( values == pOther.values ) && ( tag == pOther.tag );
+			}
+		};
+
+		/// Serializes the value into a std::vector, checks the reported sizes and reads it back.
+		template <typename TPValue>
+		bool CheckRoundTrip( TestContext & pTestContext, const TPValue & pValue )
+		{
+			std::vector<byte> buffer;
+			const auto byteSize = GDSCore::serializeAuto( buffer, pValue );
+
+			Ic3TestCheck( byteSize == GDSCore::evalByteSize( pValue ) );
+			Ic3TestCheck( byteSize == buffer.size() );
+
+			TPValue result{};
+			Ic3TestCheck( GDSCore::deserialize( buffer.data(), result ) == byteSize );
+			return Ic3TestCheck( result == pValue );
+		}
+
+		template <typename TPMap>
+		bool CheckMapRoundTrip( TestContext & pTestContext, const TPMap & pMap )
+		{
+			std::vector<byte> buffer( GDSCore::evalMapByteSize( pMap ) );
+			Ic3TestCheck( GDSCore::serializeMap( buffer.data(), pMap ) == buffer.size() );
+
+			TPMap result{};
+			Ic3TestCheck( GDSCore::deserializeMap( buffer.data(), result ) == buffer.size() );
+			return Ic3TestCheck( result == pMap );
+		}
+
+		/// Stream sink appending to a byte vector. Records the size of the largest single write.
+		struct TestStreamSink
+		{
+			std::vector<byte> * outputData;
+			uint64 * maxWriteSize;
+
+			uint64 operator()( const void * pData, uint64 pDataSize ) const
+			{
+				const auto * dataBytePtr = reinterpret_cast<const byte *>( pData );
+				outputData->insert( outputData->end(), dataBytePtr, dataBytePtr + pDataSize );
+				*maxWriteSize = std::max( *maxWriteSize, pDataSize );
+				return pDataSize;
+			}
+		};
+
+		/// Stream source reading from a byte vector.
+		struct TestStreamSource
+		{
+			const std::vector<byte> * inputData;
+			size_t * readOffset;
+
+			uint64 operator()( void * pTargetBuffer, uint64 pReadSize ) const
+			{
+				const auto readSize = std::min<uint64>( pReadSize, inputData->size() - *readOffset );
+				std::memcpy( pTargetBuffer, inputData->data() + *readOffset, readSize );
+				*readOffset += readSize;
+				return readSize;
+			}
+		};
+
+		/// Writes the value with serializeStream(), checks the output against serializeWithMetaData() and reads it
+		/// back with deserializeStream(). Returns the size of the largest block passed to the sink.
+		template <typename TPValue>
+		uint64 CheckStreamRoundTrip( TestContext & pTestContext, const TPValue & pValue, size_t pBufferSize )
+		{
+			std::vector<byte> streamData;
+			uint64 maxWriteSize = 0;
+			const auto writtenSize = GDSCore::serializeStream( pValue, TestStreamSink{ &streamData, &maxWriteSize }, pBufferSize );
+			Ic3TestCheck( writtenSize == GDSCore::evalByteSizeWithMetaData( pValue ) );
+			Ic3TestCheck( writtenSize == streamData.size() );
+
+			std::vector<byte> blockData( GDSCore::evalByteSizeWithMetaData( pValue ) );
+			GDSCore::serializeWithMetaData( blockData.data(), pValue );
+			Ic3TestCheck( blockData == streamData );
+
+			size_t readOffset = 0;
+			TPValue result{};
+			Ic3TestCheck( GDSCore::deserializeStream( result, TestStreamSource{ &streamData, &readOffset }, pBufferSize ) == writtenSize );
+			Ic3TestCheck( readOffset == streamData.size() );
+			Ic3TestCheck( result == pValue );
+
+			return maxWriteSize;
+		}
+
+		/// Stream sink which only counts the bytes, so the benchmark measures the memory used by the serialization.
+		struct CountingStreamSink
+		{
+			uint64 * writtenBytesNum;
+
+			uint64 operator()( const void * /* pData */, uint64 pDataSize ) const
+			{
+				*writtenBytesNum += pDataSize;
+				return pDataSize;
+			}
+		};
+
+		template <typename TPValue>
+		void BenchmarkSerialization( const char * pName, const TPValue & pValue, uint32 pIterationsNum )
+		{
+			std::vector<byte> buffer;
+			gds_size_t byteSize = 0;
+
+			Stopwatch stopwatch;
+			for( uint32 iteration = 0; iteration < pIterationsNum; ++iteration )
+			{
+				byteSize = GDSCore::evalByteSize( pValue );
+			}
+			const auto evalMs = stopwatch.GetElapsedMilliseconds() / pIterationsNum;
+
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < pIterationsNum; ++iteration )
+			{
+				GDSCore::serializeAuto( buffer, pValue );
+			}
+			const auto serializeMs = stopwatch.GetElapsedMilliseconds() / pIterationsNum;
+
+			TPValue result{};
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < pIterationsNum; ++iteration )
+			{
+				result.clear();
+				GDSCore::deserialize( buffer.data(), result );
+			}
+			const auto deserializeMs = stopwatch.GetElapsedMilliseconds() / pIterationsNum;
+
+			TestOutput( "  %-16s %10llu bytes: eval %8.3f ms, serialize %8.3f ms, deserialize %8.3f ms",
+			            pName, static_cast<unsigned long long>( byteSize ), evalMs, serializeMs, deserializeMs );
+		}
+
+	}
+
+	Ic3TestCase( GDS, StaticSizes )
+	{
+		static_assert( GDSCore::GdsStaticByteSize<uint32>::sValue == 4 );
+		static_assert( GDSCore::GdsStaticByteSize<std::array<int32, 3>>::sValue == GDSCore::kGdsSizeTypeByteSize + 12 );
+		static_assert( GDSCore::GdsStaticByteSize<std::pair<uint32, uint16>>::sValue == 6 );
+		static_assert( GDSCore::GdsStaticByteSize<std::string>::sValue == 0 );
+		static_assert( GDSCore::IsGdsBitwiseSerializable<char>::sValue );
+
+		using TestArray = std::array<int32, 3>;
+		Ic3TestCheck( GDSCore::evalByteSize( TestArray{} ) == GDSCore::GdsStaticByteSize<TestArray>::sValue );
+	}
+
+	Ic3TestCase( GDS, RoundTrip )
+	{
+		CheckRoundTrip( pTestContext, static_cast<int8>( -7 ) );
+		CheckRoundTrip( pTestContext, static_cast<uint16>( 0xBEEF ) );
+		CheckRoundTrip( pTestContext, static_cast<int32>( -123456789 ) );
+		CheckRoundTrip( pTestContext, static_cast<uint64>( 0x0123456789ABCDEFull ) );
+		CheckRoundTrip( pTestContext, std::string( "GDS round trip" ) );
+		CheckRoundTrip( pTestContext, std::wstring( L"wide string" ) );
+		CheckRoundTrip( pTestContext, std::vector<bool>{ true, false, true, true } );
+		CheckRoundTrip( pTestContext, std::vector<uint32>{ 1, 2, 3, 0xDEADBEEF } );
+		CheckRoundTrip( pTestContext, std::vector<int16>{ -1, 0, 32767, -32768 } );
+		CheckRoundTrip( pTestContext, std::vector<ETestEnum>{ ETestEnum::First, ETestEnum::Second } );
+		CheckRoundTrip( pTestContext, std::vector<std::string>{ "a", "", "xyz" } );
+		CheckRoundTrip( pTestContext, std::array<uint32, 4>{ 1, 2, 3, 4 } );
+		CheckRoundTrip( pTestContext, std::vector<std::array<int32, 3>>{ { 1, -2, 3 }, { 4, 5, -6 } } );
+		CheckRoundTrip( pTestContext, std::pair<uint32, uint16>{ 7, 9 } );
+		CheckRoundTrip( pTestContext, std::vector<std::pair<uint32, std::string>>{ { 1, "one" }, { 2, "two" } } );
+
+		{
+			// Trivially serializable (POD) values are copied byte-wise.
+			std::vector<TestPod> pods( 100 );
+			for( uint32 podIndex = 0; podIndex < pods.size(); ++podIndex )
+			{
+				pods[podIndex] = TestPod{ podIndex, static_cast<uint16>( podIndex * 3 ), { 1, 2, 3, 4, 5, 6 } };
+			}
+
+			std::vector<byte> buffer;
+			GDSCore::serializeAuto( buffer, pods );
+			std::vector<TestPod> result;
+			GDSCore::deserialize( buffer.data(), result );
+			const auto podsEqual = ( result.size() == pods.size() ) && ( std::memcmp( result.data(), pods.data(), pods.size() * sizeof( TestPod ) ) == 0 );
+			Ic3TestCheck( podsEqual );
+		}
+
+		{
+			// Floating-point values are stored as a fixed-precision mantissa (4 decimal digits for float) and an exponent.
+			std::vector<float> values{ 0.0f, 1.5f, -2.25f, 1000.125f, -0.0078125f, 3.0e-20f };
+			std::vector<byte> buffer;
+			GDSCore::serializeAuto( buffer, values );
+			std::vector<float> result;
+			GDSCore::deserialize( buffer.data(), result );
+			Ic3TestCheck( result.size() == values.size() );
+			for( size_t valueIndex = 0; ( valueIndex < values.size() ) && ( valueIndex < result.size() ); ++valueIndex )
+			{
+				Ic3TestCheck( std::fabs( result[valueIndex] - values[valueIndex] ) <= std::fabs( values[valueIndex] ) * 2e-4f );
+			}
+		}
+
+		{
+			std::map<uint32, std::string> orderedMap{ { 3, "c" }, { 1, "a" }, { 2, "" } };
+			std::unordered_map<uint32, uint64> hashMap{ { 10, 100 }, { 20, 200 }, { 30, 300 } };
+			CheckMapRoundTrip( pTestContext, orderedMap );
+			CheckMapRoundTrip( pTestContext, hashMap );
+		}
+
+		{
+			cppx::bitmask<uint32> bitmask{ 0x80000011u };
+			std::vector<byte> buffer;
+			GDSCore::serializeAuto( buffer, bitmask );
+			cppx::bitmask<uint32> result{};
+			GDSCore::deserialize( buffer.data(), result );
+			Ic3TestCheck( result.get() == bitmask.get() );
+		}
+
+		{
+			TestRecord record{};
+			record.name = "record";
+			record.values = { 5, 6, 7 };
+			record.tag = { -3, ETestEnum::Second };
+			CheckRoundTrip( pTestContext, record );
+
+			// Metadata + an external sink/source (e.g. a file) with a user-provided cache.
+			std::vector<byte> sink;
+			std::vector<byte> gdsCache;
+			const auto writtenSize = GDSCore::serializeExternal( record, [&sink]( const void * pData, uint64 pSize ) -> uint64 {
+				sink.insert( sink.end(), reinterpret_cast<const byte *>( pData ), reinterpret_cast<const byte *>( pData ) + pSize );
+				return pSize;
+			}, gdsCache );
+			Ic3TestCheck( writtenSize == GDSCore::evalByteSizeWithMetaData( record ) );
+			Ic3TestCheck( writtenSize == sink.size() );
+
+			size_t readOffset = 0;
+			TestRecord result{};
+			const auto readSize = GDSCore::deserializeExternal( result, [&sink, &readOffset]( void * pBuffer, uint64 pSize ) -> uint64 {
+				const auto readSize = std::min<uint64>( pSize, sink.size() - readOffset );
+				std::memcpy( pBuffer, sink.data() + readOffset, readSize );
+				readOffset += readSize;
+				return readSize;
+			}, gdsCache );
+			Ic3TestCheck( readSize == writtenSize );
+			Ic3TestCheck( result == record );
+		}
+
+		{
+			// Fixed-size output buffers.
+			std::array<byte, 64> fixedBuffer{};
+			const std::vector<uint16> smallVector{ 1, 2, 3 };
+			Ic3TestCheck( GDSCore::serializeAuto( fixedBuffer, smallVector ) == GDSCore::evalByteSize( smallVector ) );
+
+			bool exceptionThrown = false;
+			try
+			{
+				GDSCore::serializeAuto( fixedBuffer, std::vector<uint32>( 64 ) );
+			}
+			catch( const Exception & )
+			{
+				exceptionThrown = true;
+			}
+			Ic3TestCheck( exceptionThrown );
+		}
+	}
+
+	Ic3TestCase( GDS, ArraySizeMismatch )
+	{
+		// Data of a larger std::array must not be read into a smaller one.
+		std::vector<byte> buffer;
+		GDSCore::serializeAuto( buffer, std::array<uint32, 8>{ 1, 2, 3, 4, 5, 6, 7, 8 } );
+
+		std::array<uint32, 4> smallArray{};
+		bool exceptionThrown = false;
+		try
+		{
+			GDSCore::deserialize( buffer.data(), smallArray );
+		}
+		catch( const CoreGdsException & )
+		{
+			exceptionThrown = true;
+		}
+		Ic3TestCheck( exceptionThrown );
+
+		// A smaller array can be read into a larger one.
+		GDSCore::serializeAuto( buffer, std::array<uint32, 2>{ 9, 10 } );
+		std::array<uint32, 4> largeArray{};
+		GDSCore::deserialize( buffer.data(), largeArray );
+		Ic3TestCheck( ( largeArray[0] == 9 ) && ( largeArray[1] == 10 ) && ( largeArray[2] == 0 ) );
+	}
+
+	Ic3TestCase( GDS, StreamRoundTrip )
+	{
+		constexpr size_t cxBufferSize = GDSCore::kGdsStreamMinBufferSize;
+
+		std::vector<std::string> strings;
+		for( uint32 stringIndex = 0; stringIndex < 200; ++stringIndex )
+		{
+			strings.push_back( std::string( stringIndex % 37, static_cast<char>( 'a' + stringIndex % 26 ) ) );
+		}
+
+		// Values which can be split: no single write may exceed the buffer.
+		Ic3TestCheck( CheckStreamRoundTrip( pTestContext, strings, cxBufferSize ) <= cxBufferSize );
+		Ic3TestCheck( CheckStreamRoundTrip( pTestContext, std::vector<bool>( 3000, true ), cxBufferSize ) <= cxBufferSize );
+
+		std::vector<std::pair<uint16, std::string>> pairs;
+		for( uint16 pairIndex = 0; pairIndex < 100; ++pairIndex )
+		{
+			pairs.emplace_back( pairIndex, strings[pairIndex] );
+		}
+		Ic3TestCheck( CheckStreamRoundTrip( pTestContext, pairs, cxBufferSize ) <= cxBufferSize );
+
+		// Large bitwise ranges bypass the buffer, but are still read back correctly.
+		std::vector<uint32> values( 10000 );
+		for( uint32 valueIndex = 0; valueIndex < values.size(); ++valueIndex )
+		{
+			values[valueIndex] = valueIndex * 2654435761u;
+		}
+		CheckStreamRoundTrip( pTestContext, values, cxBufferSize );
+
+		// A GdsSerializable type is written as a whole (the documented limitation) and read from a single block.
+		TestRecord record{};
+		record.name = "streamed record";
+		record.values = values;
+		record.tag = { 11, ETestEnum::Second };
+		const auto recordMaxWriteSize = CheckStreamRoundTrip( pTestContext, record, cxBufferSize );
+		Ic3TestCheck( recordMaxWriteSize == GDSCore::evalByteSize( record ) );
+	}
+
+	Ic3TestBenchmark( GDS, StreamPeakMemory )
+	{
+		// Peak RSS only grows, so the stream variant (expected to use no extra memory) is measured first.
+		const auto stringsNum = pTestContext.SelectSize<size_t>( 200000, 2000000 );
+
+		std::vector<std::string> strings;
+		strings.reserve( stringsNum );
+		for( size_t stringIndex = 0; stringIndex < stringsNum; ++stringIndex )
+		{
+			strings.push_back( std::string( 40, static_cast<char>( 'a' + stringIndex % 26 ) ) );
+		}
+
+		const auto serializedSize = GDSCore::evalByteSizeWithMetaData( strings );
+		const auto baselinePeakRSS = QueryPeakResidentSetSize();
+
+		Stopwatch stopwatch;
+		uint64 streamWrittenBytesNum = 0;
+		GDSCore::serializeStream( strings, CountingStreamSink{ &streamWrittenBytesNum } );
+		const auto streamMs = stopwatch.GetElapsedMilliseconds();
+		const auto streamPeakRSS = QueryPeakResidentSetSize();
+
+		stopwatch.Restart();
+		uint64 bufferWrittenBytesNum = 0;
+		{
+			std::vector<byte> serializedData;
+			GDSCore::serializeAutoWithMetaData( serializedData, strings );
+			CountingStreamSink{ &bufferWrittenBytesNum }( serializedData.data(), serializedData.size() );
+		}
+		const auto bufferMs = stopwatch.GetElapsedMilliseconds();
+		const auto bufferPeakRSS = QueryPeakResidentSetSize();
+
+		Ic3TestCheck( streamWrittenBytesNum == serializedSize );
+		Ic3TestCheck( bufferWrittenBytesNum == serializedSize );
+
+		constexpr double cxMegabyte = 1024.0 * 1024.0;
+		TestOutput( "  vector<string>, %zu strings, %.1f MB serialized", stringsNum, serializedSize / cxMegabyte );
+		TestOutput( "  serializeStream (64 KB buffer): %8.2f ms, peak RSS growth %8.1f MB",
+		            streamMs, ( streamPeakRSS - baselinePeakRSS ) / cxMegabyte );
+		TestOutput( "  serializeAutoWithMetaData:      %8.2f ms, peak RSS growth %8.1f MB",
+		            bufferMs, ( bufferPeakRSS - streamPeakRSS ) / cxMegabyte );
+	}
+
+	Ic3TestBenchmark( GDS, Throughput )
+	{
+		const auto elementsNum = pTestContext.SelectSize<size_t>( 100000, 1000000 );
+		const auto iterationsNum = pTestContext.SelectSize<uint32>( 2, 10 );
+
+		std::vector<uint32> uintVector( elementsNum );
+		std::vector<int16> shortVector( elementsNum );
+		std::vector<TestPod> podVector( elementsNum );
+		std::string string( elementsNum, 'x' );
+		for( size_t elementIndex = 0; elementIndex < elementsNum; ++elementIndex )
+		{
+			uintVector[elementIndex] = static_cast<uint32>( elementIndex * 2654435761u );
+			shortVector[elementIndex] = static_cast<int16>( elementIndex * 7 );
+			podVector[elementIndex] = TestPod{ static_cast<uint32>( elementIndex ), static_cast<uint16>( elementIndex ), { 1, 2, 3, 4, 5, 6 } };
+			string[elementIndex] = static_cast<char>( 'a' + ( elementIndex % 26 ) );
+		}
+
+		std::vector<std::string> stringVector( elementsNum / 10, std::string( "GDS string value" ) );
+
+		BenchmarkSerialization( "vector<uint32>", uintVector, iterationsNum );
+		BenchmarkSerialization( "vector<int16>", shortVector, iterationsNum );
+		BenchmarkSerialization( "vector<pod>", podVector, iterationsNum );
+		BenchmarkSerialization( "string", string, iterationsNum );
+		BenchmarkSerialization( "vector<string>", stringVector, iterationsNum );
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,289 @@
+
+#include "TestCommon.h"
+#include "TestGPUDevice.h"
+#include <Ic3/NxMain/Geometry/GeometryDataTransfer.h>
+
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		enum class ETestTransferMode : uint32
+		{
+			// GeometryDataGPUTransferDirect into static buffers (one upload per request).
+			DirectUpload,
+			// GeometryDataGPUTransferDirect into dynamic buffers (mapped once, memcpy per request).
+			DirectMapped,
+			// GeometryDataGPUTransferStaging with a persistently mapped staging buffer.
+			StagingMapped,
+			// GeometryDataGPUTransferStaging without persistent mapping (the segment is uploaded once per frame).
+			StagingUpload,
+		};
+
+		const char * GetTransferModeName( ETestTransferMode pMode )
+		{
+			switch( pMode )
+			{
+				case ETestTransferMode::DirectUpload: return "direct (upload)";
+				case ETestTransferMode::DirectMapped: return "direct (mapped)";
+				case ETestTransferMode::StagingMapped: return "staging (mapped)";
+				case ETestTransferMode::StagingUpload: return "staging (upload)";
+			}
+			return "";
+		}
+
+		GCI::GPUBufferHandle CreateTestGeometryBuffer( TestGPUDevice & pDevice, GCI::gpu_memory_size_t pSize, bool pDynamic )
+		{
+			GCI::GPUBufferCreateInfo bufferCreateInfo;
+			bufferCreateInfo.bufferSize = pSize;
+			bufferCreateInfo.memoryFlags = pDynamic ? GCI::eGPUResourceMemoryMaskVertexStreamBufferDynamic : GCI::eGPUResourceMemoryMaskVertexStreamBufferStatic;
+			bufferCreateInfo.resourceFlags =
+					( pDynamic ? GCI::eGPUResourceContentFlagDynamicBit : GCI::eGPUResourceContentFlagStaticBit ) |
+					GCI::eGPUBufferBindFlagVertexBufferBit |
+					GCI::eGPUResourceUsageFlagTransferTargetBit;
+			return pDevice.CreateGPUBuffer( bufferCreateInfo );
+		}
+
+		/// Creates the transfer object for the mode. Staging transfers are initialized with the given frame budget.
+		std::unique_ptr<GeometryDataGPUTransfer> CreateTestTransfer( TestGPUDevice & pDevice, ETestTransferMode pMode, GCI::gpu_memory_size_t pFrameBudget )
+		{
+			if( ( pMode == ETestTransferMode::DirectUpload ) || ( pMode == ETestTransferMode::DirectMapped ) )
+			{
+				return std::make_unique<GeometryDataGPUTransferDirect>( pDevice );
+			}
+
+			pDevice.SetPersistentMappingSupported( pMode == ETestTransferMode::StagingMapped );
+
+			auto stagingTransfer = std::make_unique<GeometryDataGPUTransferStaging>( pDevice );
+
+			GeometryDataStagingTransferCreateInfo stagingCreateInfo;
+			stagingCreateInfo.frameBudget = pFrameBudget;
+			if( !stagingTransfer->Initialize( pDevice.GetTransferContext(), stagingCreateInfo ) )
+			{
+				return nullptr;
+			}
+
+			return stagingTransfer;
+		}
+
+		/// Flushes the transfer until all requests are written. A staging transfer must be inside a frame (after
+		/// BeginFrame()), which is completed, and further frames are run while requests are pending.
+		/// Returns the number of frames it took.
+		uint32 FlushAll( TestGPUDevice & pDevice, GeometryDataGPUTransfer & pTransfer )
+		{
+			auto * stagingTransfer = dynamic_cast<GeometryDataGPUTransferStaging *>( &pTransfer );
+			if( !stagingTransfer )
+			{
+				pTransfer.Flush( pDevice.GetTransferContext() );
+				return 1;
+			}
+
+			uint32 framesNum = 0;
+			do
+			{
+				if( framesNum > 0 )
+				{
+					stagingTransfer->BeginFrame();
+				}
+				stagingTransfer->Flush( pDevice.GetTransferContext() );
+				stagingTransfer->EndFrame( GCI::CommandSync{} );
+				++framesNum;
+			}
+			while( stagingTransfer->HasPendingUploads() );
+
+			return framesNum;
+		}
+
+		void FillTestData( std::vector<byte> & pData, size_t pSize, uint32 pSeed )
+		{
+			pData.resize( pSize );
+			for( size_t byteIndex = 0; byteIndex < pSize; ++byteIndex )
+			{
+				pData[byteIndex] = static_cast<byte>( ( pSeed * 2654435761u + byteIndex * 31 ) >> 7 );
+			}
+		}
+
+		void ReleaseTestTransfer( TestGPUDevice & pDevice, GeometryDataGPUTransfer & pTransfer )
+		{
+			if( auto * stagingTransfer = dynamic_cast<GeometryDataGPUTransferStaging *>( &pTransfer ) )
+			{
+				stagingTransfer->Release( pDevice.GetTransferContext() );
+			}
+		}
+
+	}
+
+	Ic3TestCase( GeometryDataTransfer, WritesMatchReference )
+	{
+		// Random small writes into two buffers (including overwrites of the same region and partially
+		// overlapping writes) must leave the buffers in the same state as applying them in order on the CPU.
+		const GCI::gpu_memory_size_t bufferSize = 256 * 1024;
+
+		for( const auto mode : { ETestTransferMode::DirectUpload, ETestTransferMode::DirectMapped, ETestTransferMode::StagingMapped, ETestTransferMode::StagingUpload } )
+		{
+			TestGPUEnvironment gpuEnvironment;
+			auto & device = gpuEnvironment.GetDevice();
+
+			const bool dynamicBuffers = ( mode == ETestTransferMode::DirectMapped );
+			GCI::GPUBufferHandle bufferArray[2] = {
+				CreateTestGeometryBuffer( device, bufferSize, dynamicBuffers ),
+				CreateTestGeometryBuffer( device, bufferSize, dynamicBuffers )
+			};
+			std::vector<byte> referenceArray[2] = {
+				std::vector<byte>( bufferSize, 0 ),
+				std::vector<byte>( bufferSize, 0 )
+			};
+
+			// A small budget, so the staging transfer spreads the batches over multiple frames.
+			auto transfer = CreateTestTransfer( device, mode, 64 * 1024 );
+			if( !Ic3TestCheck( transfer && bufferArray[0] && bufferArray[1] ) )
+			{
+				continue;
+			}
+
+			std::mt19937 randomGenerator{ 11 };
+			std::vector<byte> writeData;
+			geometry_upload_ticket_t lastTicket = kGeometryUploadTicketInvalid;
+			uint32 rejectedRequestsNum = 0;
+
+			for( uint32 frameIndex = 0; frameIndex < 40; ++frameIndex )
+			{
+				auto * stagingTransfer = dynamic_cast<GeometryDataGPUTransferStaging *>( transfer.get() );
+				if( stagingTransfer )
+				{
+					stagingTransfer->BeginFrame();
+				}
+
+				for( uint32 writeIndex = 0; writeIndex < 200; ++writeIndex )
+				{
+					const auto bufferIndex = randomGenerator() % 2;
+					const auto writeSize = static_cast<GCI::gpu_memory_size_t>( 1 + randomGenerator() % 2048 );
+					const auto writeOffset = static_cast<GCI::gpu_memory_size_t>( randomGenerator() % ( bufferSize - writeSize ) );
+					FillTestData( writeData, static_cast<size_t>( writeSize ), frameIndex * 1000 + writeIndex );
+
+					const auto ticket = transfer->UploadBufferData( device.GetTransferContext(), bufferArray[bufferIndex], writeOffset, writeData.data(), writeSize );
+					if( ticket == kGeometryUploadTicketInvalid )
+					{
+						++rejectedRequestsNum;
+						continue;
+					}
+					lastTicket = ticket;
+					std::memcpy( referenceArray[bufferIndex].data() + writeOffset, writeData.data(), static_cast<size_t>( writeSize ) );
+				}
+
+				transfer->Flush( device.GetTransferContext() );
+				if( stagingTransfer )
+				{
+					stagingTransfer->EndFrame( GCI::CommandSync{} );
+				}
+			}
+
+			if( auto * stagingTransfer = dynamic_cast<GeometryDataGPUTransferStaging *>( transfer.get() ) )
+			{
+				stagingTransfer->BeginFrame();
+			}
+			FlushAll( device, *transfer );
+
+			Ic3TestCheck( rejectedRequestsNum == 0 );
+			Ic3TestCheck( transfer->IsUploadFlushed( lastTicket ) );
+			Ic3TestCheck( device.GetStats().invalidRequestsNum == 0 );
+			for( uint32 bufferIndex = 0; bufferIndex < 2; ++bufferIndex )
+			{
+				const auto * testBuffer = static_cast<const TestGPUBuffer *>( bufferArray[bufferIndex].get() );
+				Ic3TestCheck( !testBuffer->IsMapped() );
+				Ic3TestCheck( std::memcmp( testBuffer->GetData(), referenceArray[bufferIndex].data(), bufferSize ) == 0 );
+			}
+
+			ReleaseTestTransfer( device, *transfer );
+		}
+	}
+
+	Ic3TestBenchmark( GeometryDataTransfer, SmallMeshUpload )
+	{
+		// Thousands of small meshes (100 vertices, 20 bytes each, 150 16-bit indices) allocated one after another
+		// in a vertex and an index buffer, uploaded in a single batch: the staging transfer merges adjacent writes.
+		const uint32 meshVerticesNum = 100;
+		const uint32 meshVertexSize = 20;
+		const uint32 meshIndicesNum = 150;
+		const uint32 meshIndexSize = 2;
+
+		std::vector<byte> vertexData;
+		std::vector<byte> indexData;
+		FillTestData( vertexData, meshVerticesNum * meshVertexSize, 1 );
+		FillTestData( indexData, meshIndicesNum * meshIndexSize, 2 );
+
+		std::vector<uint32> meshesNumArray{ 1000, 10000 };
+		if( !pTestContext.IsQuickMode() )
+		{
+			meshesNumArray.push_back( 50000 );
+		}
+
+		for( const auto meshesNum : meshesNumArray )
+		{
+			for( const auto mode : { ETestTransferMode::DirectUpload, ETestTransferMode::DirectMapped, ETestTransferMode::StagingMapped, ETestTransferMode::StagingUpload } )
+			{
+				TestGPUEnvironment gpuEnvironment;
+				auto & device = gpuEnvironment.GetDevice();
+
+				const bool dynamicBuffers = ( mode == ETestTransferMode::DirectMapped );
+				auto vertexBuffer = CreateTestGeometryBuffer( device, meshesNum * meshVerticesNum * meshVertexSize, dynamicBuffers );
+				auto indexBuffer = CreateTestGeometryBuffer( device, meshesNum * meshIndicesNum * meshIndexSize, dynamicBuffers );
+
+				auto transfer = CreateTestTransfer( device, mode, 4 * 1024 * 1024 );
+				if( !transfer || !vertexBuffer || !indexBuffer )
+				{
+					TestOutput( "  %-17s: initialization failed", GetTransferModeName( mode ) );
+					continue;
+				}
+
+				auto * stagingTransfer = dynamic_cast<GeometryDataGPUTransferStaging *>( transfer.get() );
+
+				const auto uploadMeshes = [&]() {
+					if( stagingTransfer )
+					{
+						stagingTransfer->BeginFrame();
+					}
+					for( uint32 meshIndex = 0; meshIndex < meshesNum; ++meshIndex )
+					{
+						transfer->UploadBufferData(
+								device.GetTransferContext(), vertexBuffer,
+								meshIndex * meshVerticesNum * meshVertexSize, vertexData.data(), vertexData.size() );
+						transfer->UploadBufferData(
+								device.GetTransferContext(), indexBuffer,
+								meshIndex * meshIndicesNum * meshIndexSize, indexData.data(), indexData.size() );
+					}
+				};
+
+				// Warm-up (allocates the internal queues).
+				uploadMeshes();
+				FlushAll( device, *transfer );
+
+				transfer->ResetStats();
+				device.ResetStats();
+
+				Stopwatch stopwatch;
+				uploadMeshes();
+				const auto queueMs = stopwatch.GetElapsedMilliseconds();
+				const auto framesNum = FlushAll( device, *transfer );
+				const auto totalMs = stopwatch.GetElapsedMilliseconds();
+
+				const auto & transferStats = transfer->GetStats();
+				const auto & deviceStats = device.GetStats();
+				TestOutput( "  %5u meshes, %-17s: %8.2f ms (queue %7.2f ms), frames %3u, transfer commands %6llu (copies %6llu, uploads %6llu), %.1f MB",
+				            meshesNum, GetTransferModeName( mode ), totalMs, queueMs, framesNum,
+				            static_cast<unsigned long long>( transferStats.transferCommandsNum ),
+				            static_cast<unsigned long long>( deviceStats.copiesNum ),
+				            static_cast<unsigned long long>( deviceStats.uploadsNum ),
+				            static_cast<double>( transferStats.uploadedBytesNum ) / ( 1024.0 * 1024.0 ) );
+
+				ReleaseTestTransfer( device, *transfer );
+			}
+		}
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,580 @@
+
+#include "TestCommon.h"
+#include <Ic3/Script/Lua/LuaScriptSystem.h>
+#include <Ic3/System/SysContext.h>
+#include <Ic3/System/IO/FileSystem.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		/// Contents of all files of the test file system, by path.
+		using TestFileStorage = std::map<std::string, std::shared_ptr<std::vector<byte>>>;
+
+		class TestMemoryFile : public System::File
+		{
+		public:
+			TestMemoryFile( System::FileManagerHandle pFileManager, System::EIOAccessMode pAccessMode, std::shared_ptr<std::vector<byte>> pContent )
+			: File( std::move( pFileManager ), pAccessMode )
+			, _content( std::move( pContent ) )
+			{}
+
+		private:
+			virtual bool _NativeIsValid() const noexcept override final
+			{
+				return _content != nullptr;
+			}
+
+			virtual System::io_size_t _NativeGetAvailableDataSize() const override final
+			{
+				return _content->size() - _filePointer;
+			}
+
+			virtual System::io_offset_t _NativeGetFilePointer() const override final
+			{
+				return static_cast<System::io_offset_t>( _filePointer );
+			}
+
+			virtual System::io_size_t _NativeGetSize() const override final
+			{
+				return _content->size();
+			}
+
+			virtual bool _NativeCheckEOF() const override final
+			{
+				return _filePointer == _content->size();
+			}
+
+			virtual bool _NativeIsGood() const override final
+			{
+				return true;
+			}
+
+			virtual System::io_size_t _NativeReadData( void * pTargetBuffer, System::io_size_t pReadSize ) override final
+			{
+				const auto readSize = std::min<size_t>( cppx::numeric_cast<size_t>( pReadSize ), _content->size() - _filePointer );
+				std::memcpy( pTargetBuffer, _content->data() + _filePointer, readSize );
+				_filePointer += readSize;
+				return readSize;
+			}
+
+			virtual System::io_size_t _NativeWriteData( const void * pData, System::io_size_t pWriteSize ) override final
+			{
+				const auto writeSize = cppx::numeric_cast<size_t>( pWriteSize );
+				_content->resize( std::max( _content->size(), _filePointer + writeSize ) );
+				std::memcpy( _content->data() + _filePointer, pData, writeSize );
+				_filePointer += writeSize;
+				return writeSize;
+			}
+
+			virtual System::io_offset_t _NativeSetFilePointer( System::io_offset_t pOffset, System::EIOPointerRefPos pRefPos ) override final
+			{
+				const auto basePosition =
+					( pRefPos == System::EIOPointerRefPos::StreamBase ) ? 0 :
+					( pRefPos == System::EIOPointerRefPos::StreamEnd ) ? _content->size() : _filePointer;
+				_filePointer = std::min<size_t>( static_cast<size_t>( static_cast<System::io_offset_t>( basePosition ) + pOffset ), _content->size() );
+				return static_cast<System::io_offset_t>( _filePointer );
+			}
+
+		private:
+			std::shared_ptr<std::vector<byte>> _content;
+			size_t _filePointer = 0;
+		};
+
+		/// File system kept in memory, so the script tests do not depend on a writable directory and the benchmarks
+		/// measure the script loading itself, not the disk.
+		class TestMemoryFileManager : public System::FileManager
+		{
+		public:
+			TestMemoryFileManager( System::SysContextHandle pSysContext, TestFileStorage & pFileStorage )
+			: FileManager( std::move( pSysContext ) )
+			, _fileStorage( pFileStorage )
+			{}
+
+		private:
+			virtual System::FileHandle _NativeOpenFile( std::string pFilePath, System::EIOAccessMode pAccessMode ) override final
+			{
+				const auto fileIter = _fileStorage.find( pFilePath );
+				if( fileIter == _fileStorage.end() )
+				{
+					return nullptr;
+				}
+				return CreateDynamicObject<TestMemoryFile>( GetHandle<TestMemoryFileManager>(), pAccessMode, fileIter->second );
+			}
+
+			virtual System::FileHandle _NativeCreateFile( std::string pFilePath ) override final
+			{
+				auto & fileContent = _fileStorage[pFilePath];
+				fileContent = std::make_shared<std::vector<byte>>();
+				return CreateDynamicObject<TestMemoryFile>( GetHandle<TestMemoryFileManager>(), System::EIOAccessMode::WriteOverwrite, fileContent );
+			}
+
+			virtual System::FileHandle _NativeCreateTemporaryFile() override final
+			{
+				return nullptr;
+			}
+
+			virtual System::FileNameList _NativeEnumDirectoryFileNameList( const std::string & ) override final
+			{
+				return {};
+			}
+
+			virtual std::string _NativeGenerateTemporaryFileName() override final
+			{
+				return {};
+			}
+
+			virtual bool _NativeCheckDirectoryExists( const std::string & ) override final
+			{
+				return true;
+			}
+
+			virtual bool _NativeCheckFileExists( const std::string & pFilePath ) override final
+			{
+				return _fileStorage.count( pFilePath ) != 0;
+			}
+
+		private:
+			TestFileStorage & _fileStorage;
+		};
+
+		/// System context providing only the file manager (the script system does not need anything else).
+		class TestScriptSysContext : public System::SysContext
+		{
+		public:
+			void AddFile( const std::string & pFilePath, const std::string & pContent )
+			{
+				_fileStorage[pFilePath] = std::make_shared<std::vector<byte>>( pContent.begin(), pContent.end() );
+			}
+
+			/// Returns the files whose path starts with the specified prefix.
+			std::vector<std::shared_ptr<std::vector<byte>>> FindFiles( const std::string & pPathPrefix ) const
+			{
+				std::vector<std::shared_ptr<std::vector<byte>>> files;
+				for( const auto & [filePath, fileContent] : _fileStorage )
+				{
+					if( filePath.compare( 0, pPathPrefix.size(), pPathPrefix ) == 0 )
+					{
+						files.push_back( fileContent );
+					}
+				}
+				return files;
+			}
+
+			virtual System::AssetLoaderHandle CreateAssetLoader( const System::AssetLoaderCreateInfo & ) override final
+			{
+				return nullptr;
+			}
+
+			virtual System::DisplayManagerHandle CreateDisplayManager() override final
+			{
+				return nullptr;
+			}
+
+			virtual System::EventControllerHandle CreateEventController() override final
+			{
+				return nullptr;
+			}
+
+			virtual System::FileManagerHandle CreateFileManager() override final
+			{
+				return System::CreateSysObject<TestMemoryFileManager>( GetHandle<TestScriptSysContext>(), _fileStorage );
+			}
+
+			virtual System::PipeFactoryHandle CreatePipeFactory() override final
+			{
+				return nullptr;
+			}
+
+			virtual System::WindowManagerHandle CreateWindowManager( System::DisplayManagerHandle ) override final
+			{
+				return nullptr;
+			}
+
+			virtual std::string QueryCurrentProcessWorkingDirectory() const override final
+			{
+				return {};
+			}
+
+			virtual std::string QueryCurrentProcessExecutableFilePath() const override final
+			{
+				return {};
+			}
+
+		private:
+			TestFileStorage _fileStorage;
+		};
+
+		/// Module-like script: a table with pFunctionsNum functions, stored in the global "G<index>". The global
+		/// "G<index>_check" is set to M.f3(10, 1), which is 54.
+		std::string GenerateTestScript( size_t pScriptIndex, size_t pFunctionsNum )
+		{
+			std::ostringstream scriptStream;
+			scriptStream << "local M = {}\n";
+			for( size_t functionIndex = 0; functionIndex < pFunctionsNum; ++functionIndex )
+			{
+				scriptStream
+					<< "function M.f" << functionIndex << "(a, b)\n"
+					<< "  local t = { x = a, y = b, name = \"fn" << functionIndex << "\", list = { 1, 2, 3, 4, 5 } }\n"
+					<< "  for i = 1, #t.list do t.x = t.x + t.list[i] * " << functionIndex << " end\n"
+					<< "  if t.x > b then return t.x - b else return t.y .. 's' end\n"
+					<< "end\n";
+			}
+			scriptStream << "G" << pScriptIndex << " = M\nG" << pScriptIndex << "_check = M.f3(10, 1)\n";
+			return scriptStream.str();
+		}
+
+		std::string GetTestScriptFilePath( size_t pScriptIndex )
+		{
+			return "scripts/s" + std::to_string( pScriptIndex ) + ".lua";
+		}
+
+		lua_Integer GetGlobalInteger( const Script::LuaScriptSystem & pScriptSystem, const std::string & pName )
+		{
+			auto * luaState = pScriptSystem.getLuaContext()->luaState;
+			lua_getglobal( luaState, pName.c_str() );
+			const auto value = lua_tointeger( luaState, -1 );
+			lua_pop( luaState, 1 );
+			return value;
+		}
+
+		const char * const kTestBinaryCacheDirectory = "cache";
+
+		/// Allocation-heavy script: tables, closures and strings, most of them dead after each round.
+		const char * const kAllocationBenchmarkScript = R"(
+			local roundsNum = ...
+			local result = 0
+			for round = 1, roundsNum do
+				local objects = {}
+				for i = 1, 2000 do
+					local v = { x = i, y = i * 2, z = { i, i + 1 } }
+					local f = function() return v.x + v.y end
+					objects[i] = { v = v, f = f, s = "k" .. i }
+				end
+				for i = 1, #objects do result = result + objects[i].f() + #objects[i].s end
+			end
+			RESULT = result
+		)";
+
+		bool RunAllocationBenchmarkScript( lua_State * pLuaState, lua_Integer pRoundsNum )
+		{
+			if( luaL_loadstring( pLuaState, kAllocationBenchmarkScript ) != LUA_OK )
+			{
+				return false;
+			}
+			lua_pushinteger( pLuaState, pRoundsNum );
+			if( lua_pcall( pLuaState, 1, 0, 0 ) != LUA_OK )
+			{
+				lua_pop( pLuaState, 1 );
+				return false;
+			}
+			return true;
+		}
+
+		/// Baseline: the allocator used by luaL_newstate() (realloc/free), with the same accounting of the requested sizes.
+		struct SystemAllocatorStats
+		{
+			size_t allocatedBytes = 0;
+			size_t peakAllocatedBytes = 0;
+		};
+
+		void * SystemLuaAlloc( void * pUserData, void * pPtr, size_t pOldSize, size_t pNewSize )
+		{
+			auto * allocatorStats = reinterpret_cast<SystemAllocatorStats *>( pUserData );
+			const auto oldSize = pPtr ? pOldSize : 0;
+			if( pNewSize == 0 )
+			{
+				std::free( pPtr );
+				allocatorStats->allocatedBytes -= oldSize;
+				return nullptr;
+			}
+			auto * newBlock = std::realloc( pPtr, pNewSize );
+			if( newBlock )
+			{
+				allocatorStats->allocatedBytes = allocatorStats->allocatedBytes - oldSize + pNewSize;
+				allocatorStats->peakAllocatedBytes = std::max( allocatorStats->peakAllocatedBytes, allocatorStats->allocatedBytes );
+			}
+			return newBlock;
+		}
+
+	}
+
+	Ic3TestCase( LuaScript, BytecodeRoundTrip )
+	{
+		// A large script is dumped in many chunks: the binary must contain all of them.
+		auto sysContext = CreateDynamicObject<TestScriptSysContext>();
+		Script::LuaScriptSystem scriptSystem{ sysContext };
+		scriptSystem.initialize();
+
+		const auto scriptSource = GenerateTestScript( 0, 500 );
+		cppx::dynamic_byte_array scriptBinary;
+		Ic3TestCheck( scriptSystem.compileSource( "s0", scriptSource.data(), scriptSource.size(), scriptBinary ) );
+		Ic3TestCheck( scriptSystem.executeCompiledScript( "s0", scriptBinary.data(), scriptBinary.size() ) );
+		Ic3TestCheck( GetGlobalInteger( scriptSystem, "G0_check" ) == 54 );
+
+		// Compiled scripts are loaded in the binary mode only.
+		const std::string textScript = "X = 1";
+		Ic3TestCheck( !scriptSystem.executeCompiledScript( "text", textScript.data(), textScript.size() ) );
+
+		scriptSystem.release();
+	}
+
+	Ic3TestCase( LuaScript, BinaryCache )
+	{
+		auto sysContext = CreateDynamicObject<TestScriptSysContext>();
+		sysContext->AddFile( GetTestScriptFilePath( 1 ), GenerateTestScript( 1, 50 ) );
+
+		Script::LuaScriptSystem scriptSystem{ sysContext };
+		scriptSystem.initialize();
+		scriptSystem.setBinaryCacheDirectory( kTestBinaryCacheDirectory );
+
+		// First compilation stores the binary, the second one loads it.
+		for( uint32 compileIndex = 0; compileIndex < 2; ++compileIndex )
+		{
+			const auto compiledScript = scriptSystem.compileFile( "s1", GetTestScriptFilePath( 1 ).c_str() );
+			Ic3TestCheck( compiledScript && scriptSystem.executeCompiledScript( compiledScript ) );
+		}
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().missesNum == 1 );
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().hitsNum == 1 );
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().storedBinariesNum == 1 );
+		Ic3TestCheck( GetGlobalInteger( scriptSystem, "G1_check" ) == 54 );
+
+		// A modified source is recompiled.
+		sysContext->AddFile( GetTestScriptFilePath( 1 ), GenerateTestScript( 1, 50 ) + "G1_extra = 5\n" );
+		Ic3TestCheck( scriptSystem.executeFile( "s1", GetTestScriptFilePath( 1 ).c_str() ) );
+		Ic3TestCheck( GetGlobalInteger( scriptSystem, "G1_extra" ) == 5 );
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().missesNum == 2 );
+
+		// Truncated binaries (e.g. an interrupted write) are ignored and replaced.
+		const auto cachedBinaries = sysContext->FindFiles( kTestBinaryCacheDirectory );
+		Ic3TestCheck( cachedBinaries.size() == 2 );
+		for( const auto & cachedBinary : cachedBinaries )
+		{
+			cachedBinary->resize( std::min<size_t>( cachedBinary->size(), 100 ) );
+		}
+		Ic3TestCheck( scriptSystem.executeFile( "s1", GetTestScriptFilePath( 1 ).c_str() ) );
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().missesNum == 3 );
+		Ic3TestCheck( scriptSystem.getBinaryCacheStats().hitsNum == 1 );
+
+		scriptSystem.release();
+	}
+
+	Ic3TestBenchmark( LuaScript, TextVsBytecodeLoad )
+	{
+		// Startup-like load of a large script set (200 scripts, 150 functions each): parsing the sources vs loading
+		// precompiled bytecode, from memory and through executeFile() with a cold and a warm binary cache.
+		const size_t scriptsNum = pTestContext.SelectSize<size_t>( 20, 200 );
+		const size_t functionsNum = 150;
+
+		auto sysContext = CreateDynamicObject<TestScriptSysContext>();
+
+		std::vector<std::string> scriptSources( scriptsNum );
+		size_t sourceSize = 0;
+		for( size_t scriptIndex = 0; scriptIndex < scriptsNum; ++scriptIndex )
+		{
+			scriptSources[scriptIndex] = GenerateTestScript( scriptIndex, functionsNum );
+			sysContext->AddFile( GetTestScriptFilePath( scriptIndex ), scriptSources[scriptIndex] );
+			sourceSize += scriptSources[scriptIndex].size();
+		}
+
+		std::vector<cppx::dynamic_byte_array> scriptBinaries( scriptsNum );
+		size_t binarySize = 0;
+		{
+			Script::LuaScriptSystem scriptSystem{ sysContext };
+			scriptSystem.initialize();
+			for( size_t scriptIndex = 0; scriptIndex < scriptsNum; ++scriptIndex )
+			{
+				const auto & scriptSource = scriptSources[scriptIndex];
+				Ic3TestCheck( scriptSystem.compileSource( "s", scriptSource.data(), scriptSource.size(), scriptBinaries[scriptIndex] ) );
+				binarySize += scriptBinaries[scriptIndex].size();
+			}
+			scriptSystem.release();
+		}
+
+		TestOutput( "  %zu scripts, %.2f MB of source, %.2f MB of bytecode", scriptsNum, sourceSize / 1048576.0, binarySize / 1048576.0 );
+
+		const char * const loadModeNames[] =
+		{
+			"text (executeTextScript)",
+			"bytecode (executeCompiledScript)",
+			"executeFile, cold binary cache",
+			"executeFile, warm binary cache"
+		};
+
+		for( uint32 loadMode = 0; loadMode < 4; ++loadMode )
+		{
+			Script::LuaScriptSystem scriptSystem{ sysContext };
+			scriptSystem.initialize();
+			if( loadMode >= 2 )
+			{
+				scriptSystem.setBinaryCacheDirectory( kTestBinaryCacheDirectory );
+			}
+
+			uint32 executedScriptsNum = 0;
+
+			Stopwatch stopwatch;
+			for( size_t scriptIndex = 0; scriptIndex < scriptsNum; ++scriptIndex )
+			{
+				const auto scriptName = "s" + std::to_string( scriptIndex );
+				bool executed = false;
+				if( loadMode == 0 )
+				{
+					executed = scriptSystem.executeTextScript( scriptName.c_str(), scriptSources[scriptIndex].data(), scriptSources[scriptIndex].size() );
+				}
+				else if( loadMode == 1 )
+				{
+					executed = scriptSystem.executeCompiledScript( scriptName.c_str(), scriptBinaries[scriptIndex].data(), scriptBinaries[scriptIndex].size() );
+				}
+				else
+				{
+					executed = scriptSystem.executeFile( scriptName.c_str(), GetTestScriptFilePath( scriptIndex ).c_str() );
+				}
+				executedScriptsNum += executed ? 1 : 0;
+			}
+			const auto loadTimeMs = stopwatch.GetElapsedMilliseconds();
+
+			Ic3TestCheck( executedScriptsNum == scriptsNum );
+			Ic3TestCheck( GetGlobalInteger( scriptSystem, "G0_check" ) == 54 );
+
+			TestOutput( "  %-33s: %8.2f ms (cache hits %u, misses %u)", loadModeNames[loadMode], loadTimeMs,
+			            scriptSystem.getBinaryCacheStats().hitsNum, scriptSystem.getBinaryCacheStats().missesNum );
+
+			scriptSystem.release();
+		}
+	}
+
+	Ic3TestCase( LuaScript, AllocatorBlockTransitions )
+	{
+		// Blocks moving between size classes, and between the pools and the system allocator, keep their content
+		// and the accounting returns to zero once everything has been freed.
+		Script::LuaMemoryAllocator memoryAllocator;
+
+		const size_t blockSizes[] = { 8, 24, 16, 200, 256, 257, 1000, 300, 100, 7, 4000, 40 };
+
+		auto * block = reinterpret_cast<byte *>( memoryAllocator.reallocate( nullptr, LUA_TTABLE, blockSizes[0] ) );
+		std::memset( block, 0x5A, blockSizes[0] );
+
+		bool contentValid = true;
+		for( size_t sizeIndex = 1; sizeIndex < std::size( blockSizes ); ++sizeIndex )
+		{
+			const auto oldSize = blockSizes[sizeIndex - 1];
+			const auto newSize = blockSizes[sizeIndex];
+
+			block = reinterpret_cast<byte *>( memoryAllocator.reallocate( block, oldSize, newSize ) );
+			if( !Ic3TestCheck( block != nullptr ) )
+			{
+				return;
+			}
+
+			for( size_t byteIndex = 0; byteIndex < std::min( oldSize, newSize ); ++byteIndex )
+			{
+				contentValid = contentValid && ( block[byteIndex] == 0x5A );
+			}
+			std::memset( block, 0x5A, newSize );
+
+			Ic3TestCheck( memoryAllocator.getStats().allocatedBytes == newSize );
+		}
+		Ic3TestCheck( contentValid );
+
+		memoryAllocator.reallocate( block, blockSizes[std::size( blockSizes ) - 1], 0 );
+
+		const auto memoryStats = memoryAllocator.getStats();
+		Ic3TestCheck( memoryStats.allocatedBytes == 0 );
+		Ic3TestCheck( memoryStats.peakAllocatedBytes == 4000 );
+		Ic3TestCheck( memoryStats.allocationsNum == 1 );
+		Ic3TestCheck( memoryStats.failedAllocationsNum == 0 );
+	}
+
+	Ic3TestCase( LuaScript, MemoryLimit )
+	{
+		// A script exceeding the limit fails with an out-of-memory error, the state remains usable.
+		auto sysContext = CreateDynamicObject<TestScriptSysContext>();
+		Script::LuaScriptSystem scriptSystem{ sysContext };
+		scriptSystem.initialize();
+
+		const size_t memoryLimit = scriptSystem.getMemoryStats().allocatedBytes + 512 * 1024;
+		scriptSystem.setMemoryLimit( memoryLimit );
+
+		const std::string largeScript = "local t = {} for i = 1, 1e7 do t[i] = { i } end";
+		Ic3TestCheck( !scriptSystem.executeTextScript( "large", largeScript.data(), largeScript.size() ) );
+		Ic3TestCheck( scriptSystem.getMemoryStats().failedAllocationsNum > 0 );
+		Ic3TestCheck( scriptSystem.getMemoryStats().peakAllocatedBytes <= memoryLimit );
+
+		scriptSystem.collectGarbage();
+
+		const std::string smallScript = "X = 42";
+		Ic3TestCheck( scriptSystem.executeTextScript( "small", smallScript.data(), smallScript.size() ) );
+		Ic3TestCheck( GetGlobalInteger( scriptSystem, "X" ) == 42 );
+
+		scriptSystem.release();
+	}
+
+	Ic3TestBenchmark( LuaScript, AllocatorThroughput )
+	{
+		// The allocation-heavy script run with the engine allocator (LuaScriptSystem) and with the system allocator of
+		// luaL_newstate(). Peak RSS only grows, so the second run reports only its growth above the peak of the first
+		// one - the peak in use (sum of the requested sizes) is comparable for both.
+		const auto roundsNum = pTestContext.SelectSize<lua_Integer>( 50, 500 );
+
+		constexpr double cxMegabyte = 1024.0 * 1024.0;
+
+		const auto baselinePeakRSS = QueryPeakResidentSetSize();
+
+		double engineAllocatorMs = 0;
+		lua_Integer engineAllocatorResult = 0;
+		Script::ScriptMemoryStats engineAllocatorStats{};
+		{
+			auto sysContext = CreateDynamicObject<TestScriptSysContext>();
+			Script::LuaScriptSystem scriptSystem{ sysContext };
+			scriptSystem.initialize();
+
+			Stopwatch stopwatch;
+			Ic3TestCheck( RunAllocationBenchmarkScript( scriptSystem.getLuaContext()->luaState, roundsNum ) );
+			engineAllocatorMs = stopwatch.GetElapsedMilliseconds();
+
+			engineAllocatorResult = GetGlobalInteger( scriptSystem, "RESULT" );
+			engineAllocatorStats = scriptSystem.getMemoryStats();
+
+			scriptSystem.release();
+		}
+		const auto engineAllocatorPeakRSS = QueryPeakResidentSetSize();
+
+		double systemAllocatorMs = 0;
+		lua_Integer systemAllocatorResult = 0;
+		SystemAllocatorStats systemAllocatorStats{};
+		{
+			auto * luaState = lua_newstate( SystemLuaAlloc, &systemAllocatorStats );
+			luaL_openlibs( luaState );
+
+			Stopwatch stopwatch;
+			Ic3TestCheck( RunAllocationBenchmarkScript( luaState, roundsNum ) );
+			systemAllocatorMs = stopwatch.GetElapsedMilliseconds();
+
+			lua_getglobal( luaState, "RESULT" );
+			systemAllocatorResult = lua_tointeger( luaState, -1 );
+
+			lua_close( luaState );
+		}
+		const auto systemAllocatorPeakRSS = QueryPeakResidentSetSize();
+
+		Ic3TestCheck( engineAllocatorResult == systemAllocatorResult );
+
+		TestOutput( "  %lld rounds of 2000 objects", static_cast<long long>( roundsNum ) );
+		TestOutput( "  engine allocator: %8.2f ms, peak in use %6.2f MB, reserved %6.2f MB, %llu allocations (%.1f%% pooled), peak RSS growth %6.2f MB",
+		            engineAllocatorMs, engineAllocatorStats.peakAllocatedBytes / cxMegabyte, engineAllocatorStats.reservedBytes / cxMegabyte,
+		            static_cast<unsigned long long>( engineAllocatorStats.allocationsNum ),
+		            100.0 * engineAllocatorStats.pooledAllocationsNum / std::max<uint64>( engineAllocatorStats.allocationsNum, 1 ),
+		            ( engineAllocatorPeakRSS - baselinePeakRSS ) / cxMegabyte );
+		TestOutput( "  system allocator: %8.2f ms, peak in use %6.2f MB, peak RSS growth %6.2f MB",
+		            systemAllocatorMs, systemAllocatorStats.peakAllocatedBytes / cxMegabyte,
+		            ( systemAllocatorPeakRSS - engineAllocatorPeakRSS ) / cxMegabyte );
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,96 @@
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+using namespace Ic3;
+using namespace Ic3::Samples;
+
+// Usage: Sample.EngineTests [--bench | --all] [--quick] [--assets <dir>] [name-filter...]
+//  (default)  runs the tests
+//  --bench    runs the benchmarks
+//  --all      runs both
+//  --quick    uses smaller data sets (CTest runs)
+//  --assets   directory with the test assets (fonts), the Assets directory of the repository by default
+// A test case is selected if its name contains any of the filters (all test cases are selected if there are none).
+int main( int pArgc, char ** pArgv )
+{
+	bool runTests = true;
+	bool runBenchmarks = false;
+	bool quickMode = false;
+	std::vector<std::string_view> nameFilters;
+
+	for( int argIndex = 1; argIndex < pArgc; ++argIndex )
+	{
+		const std::string_view arg = pArgv[argIndex];
+		if( arg == "--bench" )
+		{
+			runTests = false;
+			runBenchmarks = true;
+		}
+		else if( arg == "--all" )
+		{
+			runTests = true;
+			runBenchmarks = true;
+		}
+		else if( arg == "--quick" )
+		{
+			quickMode = true;
+		}
+		else if( ( arg == "--assets" ) && ( argIndex + 1 < pArgc ) )
+		{
+			SetTestAssetsDirectory( pArgv[++argIndex] );
+		}
+		else
+		{
+			nameFilters.push_back( arg );
+		}
+	}
+
+	auto testCases = GetTestCaseRegistry();
+	std::stable_sort( testCases.begin(), testCases.end(), []( const TestCaseInfo & pFirst, const TestCaseInfo & pSecond ) -> bool {
+		return std::strcmp( pFirst.name, pSecond.name ) < 0;
+	} );
+
+	uint32 executedNum = 0;
+	uint32 failedNum = 0;
+
+	for( const auto & testCase : testCases )
+	{
+		const bool kindSelected = ( testCase.kind == ETestCaseKind::Test ) ? runTests : runBenchmarks;
+		const bool nameSelected = nameFilters.empty() || std::any_of( nameFilters.begin(), nameFilters.end(), [&testCase]( std::string_view pFilter ) -> bool {
+			return std::string_view{ testCase.name }.find( pFilter ) != std::string_view::npos;
+		} );
+
+		if( !kindSelected || !nameSelected )
+		{
+			continue;
+		}
+
+		TestOutput( "[ RUN  ] %s", testCase.name );
+
+		TestContext testContext{ quickMode };
+		Stopwatch stopwatch;
+
+		try
+		{
+			testCase.function( testContext );
+		}
+		catch( const std::exception & pException )
+		{
+			testContext.ReportFailure( pException.what(), testCase.name, 0 );
+		}
+
+		const auto failuresNum = testContext.GetFailuresNum();
+		TestOutput( "[ %s ] %s (%.1f ms, %u failed checks)", ( failuresNum == 0 ) ? " OK " : "FAIL", testCase.name, stopwatch.GetElapsedMilliseconds(), failuresNum );
+
+		++executedNum;
+		failedNum += ( failuresNum != 0 ) ? 1 : 0;
+	}
+
+	TestOutput( "%u test case(s) executed, %u failed.", executedNum, failedNum );
+
+	// Nothing selected is an error as well (most likely a typo in a filter).
+	return ( ( executedNum > 0 ) && ( failedNum == 0 ) ) ? 0 : 1;
+}
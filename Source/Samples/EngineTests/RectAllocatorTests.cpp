@@ -0,0 +1,294 @@
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Utility/RectAllocator.h>
+
+#include <algorithm>
+#include <random>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		const ERectPackingMethod kTestPackingMethods[] =
+		{
+			ERectPackingMethod::Shelf,
+			ERectPackingMethod::SkylineBottomLeft,
+			ERectPackingMethod::MaxRectsBestShortSideFit
+		};
+
+		const char * GetPackingMethodName( ERectPackingMethod pMethod )
+		{
+			switch( pMethod )
+			{
+				case ERectPackingMethod::Shelf: return "Shelf";
+				case ERectPackingMethod::SkylineBottomLeft: return "Skyline";
+				case ERectPackingMethod::MaxRectsBestShortSideFit: return "MaxRects";
+			}
+			return "";
+		}
+
+		struct TestRectAllocation
+		{
+			rect_allocation_id_t allocationID;
+			cxm::vec2u32 size;
+		};
+
+		/// Sizes of glyph bitmaps, as rasterized from a proportional font at 12-48 px: mostly lowercase-sized glyphs,
+		/// some caps/ascenders, a few wide ones and small punctuation. Deterministic for the given seed.
+		std::vector<cxm::vec2u32> GenerateGlyphSizes( size_t pSizesNum, uint32 pSeed )
+		{
+			const uint32 pixelSizes[] = { 12, 16, 24, 32, 48 };
+
+			std::mt19937 randomGenerator{ pSeed };
+			std::uniform_real_distribution<float> widthDistribution{ 0.25f, 0.75f };
+			std::uniform_real_distribution<float> heightDistribution{ 0.45f, 1.0f };
+
+			std::vector<cxm::vec2u32> sizes( pSizesNum );
+			for( auto & size : sizes )
+			{
+				const auto pixelSize = static_cast<float>( pixelSizes[randomGenerator() % 5] );
+				const auto glyphClass = randomGenerator() % 10;
+
+				float width = widthDistribution( randomGenerator ) * pixelSize;
+				float height = heightDistribution( randomGenerator ) * pixelSize;
+				if( glyphClass == 0 )
+				{
+					// Punctuation.
+					width *= 0.4f;
+					height *= 0.3f;
+				}
+				else if( glyphClass == 1 )
+				{
+					// Wide glyphs (M, W, ligatures).
+					width *= 1.5f;
+				}
+
+				size.x = std::max( 1u, static_cast<uint32>( width ) );
+				size.y = std::max( 1u, static_cast<uint32>( height ) );
+			}
+
+			return sizes;
+		}
+
+		RectAllocatorConfig MakeTestConfig( ERectPackingMethod pMethod, uint32 pBaseLineHeight )
+		{
+			RectAllocatorConfig allocatorConfig;
+			allocatorConfig.horizontalLayout.hSpacing = 1;
+			allocatorConfig.verticalLayout.vSpacing = 1;
+			allocatorConfig.verticalLayout.baseLineHeight = pBaseLineHeight;
+			allocatorConfig.packingMethod = pMethod;
+			return allocatorConfig;
+		}
+
+		uint32 GetMaxHeight( const std::vector<cxm::vec2u32> & pSizes )
+		{
+			uint32 maxHeight = 0;
+			for( const auto & size : pSizes )
+			{
+				maxHeight = std::max( maxHeight, size.y );
+			}
+			return maxHeight;
+		}
+
+		/// Checks that all rects are inside the bounding rect (with the spacing) and no two of them overlap.
+		bool ValidateRectLayout(
+				const RectAllocator & pAllocator,
+				const std::vector<TestRectAllocation> & pAllocations,
+				const cxm::vec2u32 & pBoundingRectDimensions )
+		{
+			for( size_t firstIndex = 0; firstIndex < pAllocations.size(); ++firstIndex )
+			{
+				const auto firstPosition = pAllocator.GetRectPosition( pAllocations[firstIndex].allocationID );
+				const auto & firstSize = pAllocations[firstIndex].size;
+
+				if( ( firstPosition.x < 1 ) || ( firstPosition.y < 1 ) ||
+				    ( firstPosition.x + firstSize.x + 1 > pBoundingRectDimensions.x ) ||
+				    ( firstPosition.y + firstSize.y + 1 > pBoundingRectDimensions.y ) )
+				{
+					return false;
+				}
+
+				for( size_t secondIndex = firstIndex + 1; secondIndex < pAllocations.size(); ++secondIndex )
+				{
+					const auto secondPosition = pAllocator.GetRectPosition( pAllocations[secondIndex].allocationID );
+					const auto & secondSize = pAllocations[secondIndex].size;
+
+					if( ( firstPosition.x < secondPosition.x + secondSize.x + 1 ) && ( secondPosition.x < firstPosition.x + firstSize.x + 1 ) &&
+					    ( firstPosition.y < secondPosition.y + secondSize.y + 1 ) && ( secondPosition.y < firstPosition.y + firstSize.y + 1 ) )
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+	}
+
+	Ic3TestCase( RectAllocator, NoOverlapsWithChurn )
+	{
+		// Random allocations and frees, followed by a defragmentation: rects never overlap (including
+		// the spacing) and never leave the bounding rect.
+		const cxm::vec2u32 boundingRectDimensions{ 512, 512 };
+		const auto glyphSizes = GenerateGlyphSizes( 2000, 3 );
+		const auto maxHeight = GetMaxHeight( glyphSizes );
+
+		for( const auto packingMethod : kTestPackingMethods )
+		{
+			RectAllocator rectAllocator{ boundingRectDimensions, MakeTestConfig( packingMethod, maxHeight ) };
+
+			std::mt19937 randomGenerator{ 5 };
+			std::vector<TestRectAllocation> allocations;
+			uint32 allocatedRectsNum = 0;
+			bool layoutValid = true;
+			bool freeSucceeded = true;
+
+			const uint32 iterationsNum = pTestContext.SelectSize( 3000u, 20000u );
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				if( !allocations.empty() && ( randomGenerator() % 100 < 45 ) )
+				{
+					const auto allocationIndex = randomGenerator() % allocations.size();
+					freeSucceeded = freeSucceeded && rectAllocator.FreeRect( allocations[allocationIndex].allocationID );
+					allocations[allocationIndex] = allocations.back();
+					allocations.pop_back();
+				}
+				else
+				{
+					const auto & size = glyphSizes[randomGenerator() % glyphSizes.size()];
+					const auto allocationID = rectAllocator.AllocateRect( size );
+					if( allocationID != kRectAllocationIDInvalid )
+					{
+						allocations.push_back( TestRectAllocation{ allocationID, size } );
+						++allocatedRectsNum;
+					}
+				}
+
+				if( iteration % 1000 == 0 )
+				{
+					layoutValid = layoutValid && ValidateRectLayout( rectAllocator, allocations, boundingRectDimensions );
+				}
+			}
+
+			Ic3TestCheck( freeSucceeded );
+			Ic3TestCheck( layoutValid );
+			Ic3TestCheck( allocatedRectsNum > 0 );
+			Ic3TestCheck( rectAllocator.GetStats().allocationsNum == allocations.size() );
+
+			std::vector<RectRelocation> relocations;
+			if( rectAllocator.Defragment( relocations ) )
+			{
+				Ic3TestCheck( ValidateRectLayout( rectAllocator, allocations, boundingRectDimensions ) );
+			}
+		}
+	}
+
+	Ic3TestBenchmark( RectAllocator, PackingEfficiency )
+	{
+		// Glyph-like rects (shuffled) are inserted into an empty atlas until the first failure. Efficiency is the
+		// allocated area divided by the atlas area at that point. Throughput is measured by repeating the fill.
+		const auto glyphSizes = GenerateGlyphSizes( 40000, 7 );
+		const auto maxHeight = GetMaxHeight( glyphSizes );
+
+		for( const uint32 atlasSize : { 512u, 1024u, 2048u } )
+		{
+			const cxm::vec2u32 boundingRectDimensions{ atlasSize, atlasSize };
+
+			for( const auto packingMethod : kTestPackingMethods )
+			{
+				RectAllocator rectAllocator{ boundingRectDimensions, MakeTestConfig( packingMethod, maxHeight ) };
+
+				size_t insertedRectsNum = 0;
+				for( const auto & size : glyphSizes )
+				{
+					if( rectAllocator.AllocateRect( size ) == kRectAllocationIDInvalid )
+					{
+						break;
+					}
+					++insertedRectsNum;
+				}
+
+				const auto allocatorStats = rectAllocator.GetStats();
+
+				const uint32 repeatsNum = pTestContext.SelectSize( 2u, 10u );
+				Stopwatch stopwatch;
+				for( uint32 repeatIndex = 0; repeatIndex < repeatsNum; ++repeatIndex )
+				{
+					RectAllocator repeatAllocator{ boundingRectDimensions, MakeTestConfig( packingMethod, maxHeight ) };
+					for( size_t rectIndex = 0; rectIndex < insertedRectsNum; ++rectIndex )
+					{
+						( void )repeatAllocator.AllocateRect( glyphSizes[rectIndex] );
+					}
+				}
+				const auto elapsedMs = stopwatch.GetElapsedMilliseconds();
+				const auto insertsPerSecond = static_cast<double>( insertedRectsNum * repeatsNum ) / ( elapsedMs * 1e-3 );
+
+				TestOutput( "  %4ux%-4u %-8s: %6zu rects before the first failure, efficiency %5.1f%%, free rects %5u, %7.3f M inserts/s (%.3f us/insert)",
+				            atlasSize, atlasSize, GetPackingMethodName( packingMethod ), insertedRectsNum,
+				            100.0 * static_cast<double>( allocatorStats.allocatedArea ) / static_cast<double>( allocatorStats.boundingArea ),
+				            allocatorStats.freeRectsNum, insertsPerSecond * 1e-6, 1e6 / insertsPerSecond );
+			}
+		}
+	}
+
+	Ic3TestBenchmark( RectAllocator, ChurnAndDefragment )
+	{
+		// Steady state of a glyph cache: 45% frees, 55% allocations of random glyph sizes.
+		const cxm::vec2u32 boundingRectDimensions{ 1024, 1024 };
+		const auto glyphSizes = GenerateGlyphSizes( 4000, 9 );
+		const auto maxHeight = GetMaxHeight( glyphSizes );
+
+		for( const auto packingMethod : kTestPackingMethods )
+		{
+			RectAllocator rectAllocator{ boundingRectDimensions, MakeTestConfig( packingMethod, maxHeight ) };
+
+			std::mt19937 randomGenerator{ 13 };
+			std::vector<TestRectAllocation> allocations;
+			uint32 failedAllocationsNum = 0;
+
+			const uint32 iterationsNum = pTestContext.SelectSize( 20000u, 200000u );
+
+			Stopwatch stopwatch;
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				if( !allocations.empty() && ( randomGenerator() % 100 < 45 ) )
+				{
+					const auto allocationIndex = randomGenerator() % allocations.size();
+					rectAllocator.FreeRect( allocations[allocationIndex].allocationID );
+					allocations[allocationIndex] = allocations.back();
+					allocations.pop_back();
+				}
+				else
+				{
+					const auto & size = glyphSizes[randomGenerator() % glyphSizes.size()];
+					const auto allocationID = rectAllocator.AllocateRect( size );
+					if( allocationID == kRectAllocationIDInvalid )
+					{
+						++failedAllocationsNum;
+					}
+					else
+					{
+						allocations.push_back( TestRectAllocation{ allocationID, size } );
+					}
+				}
+			}
+			const auto churnMs = stopwatch.GetElapsedMilliseconds();
+
+			const auto churnStats = rectAllocator.GetStats();
+
+			std::vector<RectRelocation> relocations;
+			stopwatch.Restart();
+			const bool defragmented = rectAllocator.Defragment( relocations );
+			const auto defragmentMs = stopwatch.GetElapsedMilliseconds();
+
+			TestOutput( "  %-8s: %7.2f ms for %u operations, live %5zu, failed %5u (fragmented %5u), free rects %5u; defragment %s in %.2f ms, moved %zu, free rects %u",
+			            GetPackingMethodName( packingMethod ), churnMs, iterationsNum, allocations.size(),
+			            failedAllocationsNum, churnStats.fragmentedFailuresNum, churnStats.freeRectsNum,
+			            defragmented ? "ok" : "failed", defragmentMs, relocations.size(), rectAllocator.GetStats().freeRectsNum );
+		}
+	}
+
+} // namespace Ic3::Samples
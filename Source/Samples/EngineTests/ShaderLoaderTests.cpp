@@ -0,0 +1,234 @@
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+#include <Ic3/Graphics/GCI/GPUDeviceNull.h>
+#include <Ic3/Graphics/GCI/GPUDriverNull.h>
+#include <Ic3/Graphics/GCI/Resources/Shader.h>
+#include <Ic3/NxMain/Renderer/ShaderLibrary.h>
+#include <Ic3/NxMain/Renderer/ShaderLoader.h>
+
+#include <cstring>
+#include <thread>
+
+namespace Ic3::Samples
+{
+
+	namespace GCI = Ic3::Graphics::GCI;
+
+	namespace
+	{
+
+		/// Null device which "compiles" shaders by sleeping for the configured latency. Sources containing "#error"
+		/// fail to compile. Counts creations made outside of the thread which created the device.
+		class ShaderTestGPUDevice : public GCI::GPUDeviceNull
+		{
+		public:
+			ShaderTestGPUDevice( GCI::GPUDriver & pDriver, bool pMultiThreadAccess, std::chrono::microseconds pCompileLatency )
+			: GPUDeviceNull( pDriver )
+			, _compileLatency( pCompileLatency )
+			, _ownerThreadID( std::this_thread::get_id() )
+			{
+				SetMultiThreadAccessSupported( pMultiThreadAccess );
+			}
+
+			CPPX_ATTR_NO_DISCARD uint32 GetShadersCreatedOnOtherThreadsNum() const noexcept
+			{
+				return _shadersCreatedOnOtherThreadsNum.load();
+			}
+
+		private:
+			virtual GCI::ShaderHandle _DrvCreateShader( const GCI::ShaderCreateInfo & pCreateInfo ) override final
+			{
+				if( std::this_thread::get_id() != _ownerThreadID )
+				{
+					_shadersCreatedOnOtherThreadsNum += 1;
+				}
+
+				const std::string_view shaderSource{
+					reinterpret_cast<const char *>( pCreateInfo.shaderSourceView.data() ), pCreateInfo.shaderSourceView.size() };
+				if( shaderSource.find( "#error" ) != std::string_view::npos )
+				{
+					return nullptr;
+				}
+
+				std::this_thread::sleep_for( _compileLatency );
+
+				return GCI::CreateGfxObject<GCI::Shader>( *this, pCreateInfo.shaderType );
+			}
+
+		private:
+			std::chrono::microseconds _compileLatency;
+			std::thread::id _ownerThreadID;
+			std::atomic<uint32> _shadersCreatedOnOtherThreadsNum{ 0 };
+		};
+
+		std::string GetTestShaderName( size_t pShaderIndex )
+		{
+			return "SH_" + std::to_string( pShaderIndex );
+		}
+
+		/// Shader files are kept in memory: "<index>.hlsl", 2 kB each. The one at pFailedShaderIndex does not compile.
+		struct TestShaderFileSet
+		{
+			std::vector<ShaderLoadDescFile> loadDescs;
+			std::vector<std::string> sources;
+
+			TestShaderFileSet( size_t pShadersNum, size_t pFailedShaderIndex )
+			{
+				loadDescs.reserve( pShadersNum );
+				sources.reserve( pShadersNum );
+				for( size_t shaderIndex = 0; shaderIndex < pShadersNum; ++shaderIndex )
+				{
+					loadDescs.emplace_back(
+						Ic3ShaderLoadDescVSAutoID( cppx::immutable_string( GetTestShaderName( shaderIndex ) ) ),
+						std::to_string( shaderIndex ) + ".hlsl" );
+					sources.push_back( ( shaderIndex == pFailedShaderIndex ) ? std::string( "#error test" ) : std::string( 2048, 'a' ) );
+				}
+			}
+
+			ShaderFileLoadCallback MakeFileLoadCallback( std::chrono::microseconds pReadLatency ) const
+			{
+				return [this, pReadLatency]( const std::string & pFileName ) -> cppx::dynamic_memory_buffer {
+					std::this_thread::sleep_for( pReadLatency );
+
+					cppx::dynamic_memory_buffer fileContent{};
+					const auto shaderIndex = std::stoul( pFileName );
+					if( shaderIndex < sources.size() )
+					{
+						const auto & source = sources[shaderIndex];
+						fileContent.resize( source.size() );
+						std::memcpy( fileContent.data(), source.data(), source.size() );
+					}
+					return fileContent;
+				};
+			}
+		};
+
+		struct ShaderBatchLoadResult
+		{
+			double loadTimeMs = 0;
+			uint32 addedShadersNum = 0;
+			ShaderLoadBatchStats stats;
+			bool orderValid = false;
+			bool lookupValid = false;
+		};
+
+		ShaderBatchLoadResult LoadTestShaderBatch(
+				const CoreEngineState & pCES,
+				ShaderLoader & pShaderLoader,
+				const TestShaderFileSet & pShaderFileSet,
+				size_t pFailedShaderIndex,
+				WorkerThreadPool * pThreadPool )
+		{
+			ShaderBatchLoadResult result{};
+
+			Stopwatch stopwatch;
+			auto shaderLoadBatch = pShaderLoader.LoadShadersAsync( pShaderFileSet.loadDescs, pThreadPool );
+			auto shaderLibrary = CreateDynamicObject<ShaderLibrary>( pCES );
+			result.addedShadersNum = shaderLoadBatch->AddShadersToLibrary( *shaderLibrary );
+			result.loadTimeMs = stopwatch.GetElapsedMilliseconds();
+			result.stats = shaderLoadBatch->GetStats();
+
+			const auto & shaders = shaderLoadBatch->GetShaders();
+			result.orderValid = ( shaders.size() == pShaderFileSet.loadDescs.size() );
+			result.lookupValid = true;
+			for( size_t shaderIndex = 0; result.orderValid && ( shaderIndex < shaders.size() ); ++shaderIndex )
+			{
+				const bool shaderExpected = ( shaderIndex != pFailedShaderIndex );
+				result.orderValid = ( shaders[shaderIndex] != nullptr ) == shaderExpected;
+
+				const auto libraryShader = shaderLibrary->GetShader( GetTestShaderName( shaderIndex ) );
+				result.lookupValid = result.lookupValid && ( libraryShader == ( shaderExpected ? shaders[shaderIndex] : nullptr ) );
+			}
+
+			return result;
+		}
+
+	}
+
+	Ic3TestCase( ShaderLoader, AsyncBatchMatchesRequestOrder )
+	{
+		// Results are returned in the order of the load descs, failed shaders are null and are not added to the library.
+		// Without multi-thread access, shaders are created only on the thread which waits for the batch.
+		const size_t shadersNum = 64;
+		const size_t failedShaderIndex = 7;
+		const TestShaderFileSet shaderFileSet{ shadersNum, failedShaderIndex };
+
+		GCI::GPUDriverNull gpuDriver{};
+		WorkerThreadPool workerThreadPool{ 3 };
+
+		for( const bool multiThreadAccess : { false, true } )
+		{
+			auto gpuDevice = GCI::CreateGfxObject<ShaderTestGPUDevice>( gpuDriver, multiThreadAccess, std::chrono::microseconds{ 0 } );
+			const CoreEngineState coreEngineState{ nullptr, gpuDevice };
+			auto shaderLoader = ShaderLoaderFileBased::CreateLoader( coreEngineState, shaderFileSet.MakeFileLoadCallback( {} ) );
+
+			for( auto * threadPool : { static_cast<WorkerThreadPool *>( nullptr ), &workerThreadPool } )
+			{
+				const auto result = LoadTestShaderBatch( coreEngineState, *shaderLoader, shaderFileSet, failedShaderIndex, threadPool );
+
+				Ic3TestCheck( result.stats.loadedShadersNum == shadersNum - 1 );
+				Ic3TestCheck( result.stats.failedShadersNum == 1 );
+				Ic3TestCheck( result.addedShadersNum == shadersNum - 1 );
+				Ic3TestCheck( result.orderValid );
+				Ic3TestCheck( result.lookupValid );
+			}
+
+			if( !multiThreadAccess )
+			{
+				Ic3TestCheck( gpuDevice->GetShadersCreatedOnOtherThreadsNum() == 0 );
+			}
+		}
+	}
+
+	Ic3TestBenchmark( ShaderLoader, BatchLoad500 )
+	{
+		// 500 shaders with simulated file read (0.4 ms) and driver compile (1.5 ms) latencies. Compares a loop of
+		// LoadShader() calls with LoadShadersAsync(), with and without a thread pool and multi-thread device access.
+		// Load time is the wall-clock time until all shaders have been added to a library.
+		const size_t shadersNum = pTestContext.SelectSize<size_t>( 100, 500 );
+		const size_t failedShaderIndex = 7;
+		const TestShaderFileSet shaderFileSet{ shadersNum, failedShaderIndex };
+
+		// There is no driver compiler and no disk here, so both are simulated by sleeping.
+		const std::chrono::microseconds sourceReadLatency{ 400 };
+		const std::chrono::microseconds compileLatency{ 1500 };
+
+		// Fixed number of workers: the latencies are sleeps, so the results do not depend on the number of CPUs.
+		GCI::GPUDriverNull gpuDriver{};
+		WorkerThreadPool workerThreadPool{ 7 };
+
+		TestOutput( "  %zu shaders, %u worker threads", shadersNum, workerThreadPool.GetWorkerThreadsNum() );
+
+		for( const bool multiThreadAccess : { false, true } )
+		{
+			auto gpuDevice = GCI::CreateGfxObject<ShaderTestGPUDevice>( gpuDriver, multiThreadAccess, compileLatency );
+			const CoreEngineState coreEngineState{ nullptr, gpuDevice };
+			auto shaderLoader = ShaderLoaderFileBased::CreateLoader(
+				coreEngineState, shaderFileSet.MakeFileLoadCallback( sourceReadLatency ) );
+
+			if( !multiThreadAccess )
+			{
+				Stopwatch stopwatch;
+				uint32 loadedShadersNum = 0;
+				for( const auto & shaderLoadDesc : shaderFileSet.loadDescs )
+				{
+					loadedShadersNum += shaderLoader->LoadShader( shaderLoadDesc ) ? 1 : 0;
+				}
+				TestOutput( "  LoadShader() loop                         : %8.1f ms (%u loaded)", stopwatch.GetElapsedMilliseconds(), loadedShadersNum );
+			}
+
+			for( auto * threadPool : { static_cast<WorkerThreadPool *>( nullptr ), &workerThreadPool } )
+			{
+				const auto result = LoadTestShaderBatch( coreEngineState, *shaderLoader, shaderFileSet, failedShaderIndex, threadPool );
+				Ic3TestCheck( result.orderValid && result.lookupValid );
+
+				TestOutput( "  LoadShadersAsync(), %-6s, %-14s: %8.1f ms (%u loaded, %u failed; read %.1f ms, compile %.1f ms)",
+				            threadPool ? "pool" : "single", multiThreadAccess ? "mt compile" : "serial compile",
+				            result.loadTimeMs, result.stats.loadedShadersNum, result.stats.failedShadersNum,
+				            result.stats.sourceReadTimeMs, result.stats.compileTimeMs );
+			}
+		}
+	}
+
+} // namespace Ic3::Samples
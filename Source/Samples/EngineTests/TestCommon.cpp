@@ -0,0 +1,108 @@
+
+#include "TestCommon.h"
+#include <cstdarg>
+#include <fstream>
+
+#if( PCL_TARGET_SYSAPI == PCL_TARGET_SYSAPI_WIN32 )
+#  include <Windows.h>
+#  include <Psapi.h>
+#else
+#  include <sys/resource.h>
+#endif
+
+#if !defined( IC3_SAMPLES_ENGINE_TESTS_ASSETS_DIR )
+#  define IC3_SAMPLES_ENGINE_TESTS_ASSETS_DIR "Assets"
+#endif
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		std::string & GetTestAssetsDirectory()
+		{
+			static std::string sTestAssetsDirectory = IC3_SAMPLES_ENGINE_TESTS_ASSETS_DIR;
+			return sTestAssetsDirectory;
+		}
+
+	}
+
+	void TestContext::ReportFailure( const char * pExpression, const char * pFile, int pLine )
+	{
+		// Keep the output readable if a check fails in a loop.
+		if( _failuresNum < 32 )
+		{
+			TestOutput( "  FAILED: %s (%s:%d)", pExpression, pFile, pLine );
+		}
+		++_failuresNum;
+	}
+
+	std::vector<TestCaseInfo> & GetTestCaseRegistry()
+	{
+		static std::vector<TestCaseInfo> sTestCaseRegistry;
+		return sTestCaseRegistry;
+	}
+
+	TestCaseRegistrar::TestCaseRegistrar( const char * pName, ETestCaseKind pKind, TestCaseFunction pFunction )
+	{
+		GetTestCaseRegistry().push_back( TestCaseInfo{ pName, pKind, pFunction } );
+	}
+
+	uint64 QueryPeakResidentSetSize()
+	{
+	#if( PCL_TARGET_SYSAPI == PCL_TARGET_SYSAPI_WIN32 )
+		PROCESS_MEMORY_COUNTERS memoryCounters{};
+		if( ::GetProcessMemoryInfo( ::GetCurrentProcess(), &memoryCounters, sizeof( memoryCounters ) ) )
+		{
+			return memoryCounters.PeakWorkingSetSize;
+		}
+		return 0;
+	#else
+		struct rusage resourceUsage{};
+		if( ::getrusage( RUSAGE_SELF, &resourceUsage ) != 0 )
+		{
+			return 0;
+		}
+	#  if( PCL_TARGET_SYSAPI == PCL_TARGET_SYSAPI_OSX )
+		// Reported in bytes on macOS...
+		return static_cast<uint64>( resourceUsage.ru_maxrss );
+	#  else
+		// ...and in kilobytes on Linux/Android.
+		return static_cast<uint64>( resourceUsage.ru_maxrss ) * 1024;
+	#  endif
+	#endif
+	}
+
+	void SetTestAssetsDirectory( std::string pDirectory )
+	{
+		GetTestAssetsDirectory() = std::move( pDirectory );
+	}
+
+	bool ReadTestAssetFile( const char * pRelativePath, std::vector<byte> & pOutData )
+	{
+		const auto filePath = GetTestAssetsDirectory() + "/" + pRelativePath;
+
+		std::ifstream fileStream{ filePath, std::ios::binary | std::ios::ate };
+		if( !fileStream )
+		{
+			TestOutput( "  cannot open the asset file %s", filePath.c_str() );
+			return false;
+		}
+
+		pOutData.resize( static_cast<size_t>( fileStream.tellg() ) );
+		fileStream.seekg( 0 );
+		return static_cast<bool>( fileStream.read( reinterpret_cast<char *>( pOutData.data() ), static_cast<std::streamsize>( pOutData.size() ) ) );
+	}
+
+	void TestOutput( const char * pFormat, ... )
+	{
+		va_list argsList;
+		va_start( argsList, pFormat );
+		std::vprintf( pFormat, argsList );
+		va_end( argsList );
+		std::putchar( '\n' );
+		std::fflush( stdout );
+	}
+
+} // namespace Ic3::Samples
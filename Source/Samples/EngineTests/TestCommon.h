@@ -0,0 +1,125 @@
+
+#pragma once
+
+#ifndef __IC3_SAMPLES_ENGINE_TESTS_TEST_COMMON_H__
+#define __IC3_SAMPLES_ENGINE_TESTS_TEST_COMMON_H__
+
+#include <Ic3/CoreLib/Prerequisites.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Ic3::Samples
+{
+
+	enum class ETestCaseKind : uint32
+	{
+		// Correctness test, registered in CTest (run in the quick mode).
+		Test,
+		// Benchmark, prints the measured numbers, run only with --bench.
+		Benchmark
+	};
+
+	/**
+	 * State of a single test case run. Failed checks are counted, the test case continues after a failure.
+	 */
+	class TestContext
+	{
+	public:
+		explicit TestContext( bool pQuickMode ) noexcept
+		: _quickMode( pQuickMode )
+		{}
+
+		void ReportFailure( const char * pExpression, const char * pFile, int pLine );
+
+		/// Returns the quick value in the quick mode (CTest runs), the full value otherwise.
+		template <typename TPValue>
+		CPPX_ATTR_NO_DISCARD TPValue SelectSize( TPValue pQuickValue, TPValue pFullValue ) const noexcept
+		{
+			return _quickMode ? pQuickValue : pFullValue;
+		}
+
+		CPPX_ATTR_NO_DISCARD bool IsQuickMode() const noexcept
+		{
+			return _quickMode;
+		}
+
+		CPPX_ATTR_NO_DISCARD uint32 GetFailuresNum() const noexcept
+		{
+			return _failuresNum;
+		}
+
+	private:
+		bool _quickMode;
+		uint32 _failuresNum = 0;
+	};
+
+	using TestCaseFunction = void ( * )( TestContext & );
+
+	struct TestCaseInfo
+	{
+		const char * name;
+		ETestCaseKind kind;
+		TestCaseFunction function;
+	};
+
+	CPPX_ATTR_NO_DISCARD std::vector<TestCaseInfo> & GetTestCaseRegistry();
+
+	struct TestCaseRegistrar
+	{
+		TestCaseRegistrar( const char * pName, ETestCaseKind pKind, TestCaseFunction pFunction );
+	};
+
+	class Stopwatch
+	{
+	public:
+		Stopwatch() noexcept
+		: _startTime( std::chrono::steady_clock::now() )
+		{}
+
+		void Restart() noexcept
+		{
+			_startTime = std::chrono::steady_clock::now();
+		}
+
+		CPPX_ATTR_NO_DISCARD double GetElapsedMilliseconds() const noexcept
+		{
+			return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - _startTime ).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point _startTime;
+	};
+
+	/// Returns the peak resident set size of the process in bytes, or 0 if it cannot be queried on the current platform.
+	CPPX_ATTR_NO_DISCARD uint64 QueryPeakResidentSetSize();
+
+	/// Sets the directory with the test assets (the Assets directory of the repository by default, see --assets).
+	void SetTestAssetsDirectory( std::string pDirectory );
+
+	/// Reads a whole file from the assets directory. Returns false if the file cannot be read.
+	bool ReadTestAssetFile( const char * pRelativePath, std::vector<byte> & pOutData );
+
+	/// Prints a line of test/benchmark output (printf-style).
+	void TestOutput( const char * pFormat, ... );
+
+} // namespace Ic3::Samples
+
+#define Ic3TestCaseImpl( pGroup, pName, pKind ) \
+	static void _ic3TestCase_##pGroup##_##pName( Ic3::Samples::TestContext & pTestContext ); \
+	static const Ic3::Samples::TestCaseRegistrar sTestCaseRegistrar_##pGroup##_##pName{ \
+		#pGroup "." #pName, pKind, _ic3TestCase_##pGroup##_##pName }; \
+	static void _ic3TestCase_##pGroup##_##pName( [[maybe_unused]] Ic3::Samples::TestContext & pTestContext )
+
+/// Defines a test case "pGroup.pName". Inside, checks are made with Ic3TestCheck().
+#define Ic3TestCase( pGroup, pName ) Ic3TestCaseImpl( pGroup, pName, Ic3::Samples::ETestCaseKind::Test )
+
+/// Defines a benchmark "pGroup.pName".
+#define Ic3TestBenchmark( pGroup, pName ) Ic3TestCaseImpl( pGroup, pName, Ic3::Samples::ETestCaseKind::Benchmark )
+
+/// Checks a condition inside a test case. Evaluates to the result of the condition.
+#define Ic3TestCheck( pExpression ) \
+	( ( pExpression ) ? true : ( pTestContext.ReportFailure( #pExpression, __FILE__, __LINE__ ), false ) )
+
+#endif // __IC3_SAMPLES_ENGINE_TESTS_TEST_COMMON_H__
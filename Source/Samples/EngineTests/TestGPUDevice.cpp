@@ -0,0 +1,182 @@
+
+#include "TestGPUDevice.h"
+#include <cstring>
+
+namespace Ic3::Samples
+{
+
+	class TestGPUDevice::CommandSystem : public GCI::CommandSystem
+	{
+	public:
+		explicit CommandSystem( TestGPUDevice & pGPUDevice )
+		: GCI::CommandSystem( pGPUDevice )
+		{}
+
+		virtual std::unique_ptr<GCI::CommandContext> AcquireCommandContext( GCI::ECommandContextType ) override final
+		{
+			return nullptr;
+		}
+
+		virtual GCI::CommandSync SubmitContext( GCI::CommandContextDirect &, const GCI::CommandContextSubmitInfo & ) override final
+		{
+			return {};
+		}
+	};
+
+	class TestGPUDevice::CommandList : public GCI::CommandList
+	{
+	public:
+		CommandList( GCI::CommandSystem & pCommandSystem, GCI::GraphicsPipelineStateController & pPipelineStateController )
+		: GCI::CommandList( pCommandSystem, GCI::ECommandListType::DirectTransfer, pPipelineStateController )
+		{}
+
+		virtual void CmdDrawDirectIndexed( native_uint, native_uint, native_uint ) override final
+		{}
+
+		virtual void CmdDrawDirectIndexedInstanced( native_uint, native_uint, native_uint ) override final
+		{}
+
+		virtual void CmdDrawDirectNonIndexed( native_uint, native_uint ) override final
+		{}
+
+		virtual void CmdDrawDirectNonIndexedInstanced( native_uint, native_uint, native_uint ) override final
+		{}
+
+		virtual void CmdExecuteDeferredContext( GCI::CommandContextDeferred & ) override final
+		{}
+	};
+
+	class TestGPUDevice::PipelineStateController : public GCI::GraphicsPipelineStateController
+	{
+	public:
+		virtual bool ApplyStateChanges() override final
+		{
+			return true;
+		}
+	};
+
+
+	TestGPUBuffer::TestGPUBuffer(
+			TestGPUDevice & pGPUDevice,
+			const GCI::ResourceMemoryInfo & pResourceMemory,
+			const GCI::GPUBufferProperties & pBufferProperties )
+	: GPUBuffer( pGPUDevice, pResourceMemory, pBufferProperties )
+	, _deviceStats( pGPUDevice._stats )
+	, _storage( cppx::numeric_cast<size_t>( pBufferProperties.byteSize ), 0 )
+	{}
+
+	TestGPUBuffer::~TestGPUBuffer() = default;
+
+	bool TestGPUBuffer::MapRegion( void *, const GCI::GPUMemoryRegion & pRegion, GCI::EGPUMemoryMapMode pMapMode )
+	{
+		GCI::ResourceMappedMemory mappedMemoryInfo;
+		mappedMemoryInfo.sourceMemory = &mResourceMemory;
+		mappedMemoryInfo.mappedRegion = pRegion;
+		mappedMemoryInfo.pointer = _storage.data() + pRegion.offset;
+		mappedMemoryInfo.memoryMapFlags = static_cast<GCI::EGPUMemoryMapFlags>( pMapMode );
+
+		SetMappedMemory( mappedMemoryInfo );
+
+		_deviceStats.mapsNum += 1;
+
+		return true;
+	}
+
+	void TestGPUBuffer::Unmap( void * )
+	{
+		ResetMappedMemory();
+	}
+
+	void TestGPUBuffer::FlushMappedRegion( void *, const GCI::GPUMemoryRegion & )
+	{}
+
+	void TestGPUBuffer::InvalidateRegion( void *, const GCI::GPUMemoryRegion & )
+	{}
+
+	void TestGPUBuffer::UpdateSubDataCopy( void *, GCI::GPUBuffer & pSourceBuffer, const GCI::GPUBufferSubDataCopyDesc & pCopyDesc )
+	{
+		auto * sourceBuffer = dynamic_cast<TestGPUBuffer *>( &pSourceBuffer );
+		const auto & sourceRegion = pCopyDesc.sourceBufferRegion;
+
+		if( !sourceBuffer ||
+		    ( sourceRegion.offset + sourceRegion.size > sourceBuffer->_storage.size() ) ||
+		    ( pCopyDesc.targetBufferOffset + sourceRegion.size > _storage.size() ) )
+		{
+			_deviceStats.invalidRequestsNum += 1;
+			return;
+		}
+
+		std::memmove( _storage.data() + pCopyDesc.targetBufferOffset, sourceBuffer->_storage.data() + sourceRegion.offset, sourceRegion.size );
+
+		_deviceStats.copiesNum += 1;
+		_deviceStats.copiedBytesNum += sourceRegion.size;
+	}
+
+	void TestGPUBuffer::UpdateSubDataUpload( void *, const GCI::GPUBufferSubDataUploadDesc & pUploadDesc )
+	{
+		const auto & bufferRegion = pUploadDesc.bufferRegion;
+
+		if( !pUploadDesc.inputDataDesc.pointer || ( bufferRegion.offset + bufferRegion.size > _storage.size() ) )
+		{
+			_deviceStats.invalidRequestsNum += 1;
+			return;
+		}
+
+		std::memcpy( _storage.data() + bufferRegion.offset, pUploadDesc.inputDataDesc.pointer, bufferRegion.size );
+
+		_deviceStats.uploadsNum += 1;
+		_deviceStats.uploadedBytesNum += bufferRegion.size;
+	}
+
+
+	TestGPUDevice::TestGPUDevice( GCI::GPUDriver & pDriver )
+	: GPUDevice( pDriver, nullptr, nullptr )
+	{
+		InitializeCommandSystem();
+	}
+
+	TestGPUDevice::~TestGPUDevice() = default;
+
+	void TestGPUDevice::WaitForCommandSync( GCI::CommandSync & )
+	{}
+
+	void TestGPUDevice::InitializeCommandSystem()
+	{
+		auto commandSystem = CreateDynamicObject<CommandSystem>( *this );
+		_pipelineStateController = std::make_unique<PipelineStateController>();
+		_commandList = std::make_unique<CommandList>( *commandSystem, *_pipelineStateController );
+		_transferContext = std::make_unique<GCI::CommandContextDirectTransfer>( *_commandList );
+		_commandSystem = std::move( commandSystem );
+	}
+
+	GCI::GPUBufferHandle TestGPUDevice::_DrvCreateGPUBuffer( const GCI::GPUBufferCreateInfo & pCreateInfo )
+	{
+		if( ( pCreateInfo.bufferSize == 0 ) ||
+		    ( !_persistentMappingSupported && pCreateInfo.memoryFlags.is_set( GCI::eGPUMemoryHeapPropertyFlagPersistentMapBit ) ) )
+		{
+			return nullptr;
+		}
+
+		GCI::ResourceMemoryInfo bufferMemoryInfo{};
+		bufferMemoryInfo.baseAlignment = 16;
+		bufferMemoryInfo.memoryFlags = pCreateInfo.memoryFlags;
+
+		GCI::GPUBufferProperties bufferProperties{};
+		bufferProperties.resourceFlags = pCreateInfo.resourceFlags;
+		bufferProperties.byteSize = pCreateInfo.bufferSize;
+
+		auto buffer = CreateDynamicObject<TestGPUBuffer>( *this, bufferMemoryInfo, bufferProperties );
+
+		_stats.buffersNum += 1;
+
+		return buffer;
+	}
+
+
+	TestGPUEnvironment::TestGPUEnvironment()
+	: _device( std::make_unique<TestGPUDevice>( _driver ) )
+	{}
+
+	TestGPUEnvironment::~TestGPUEnvironment() = default;
+
+} // namespace Ic3::Samples
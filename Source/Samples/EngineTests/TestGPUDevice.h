@@ -0,0 +1,140 @@
+
+#pragma once
+
+#ifndef __IC3_SAMPLES_ENGINE_TESTS_TEST_GPU_DEVICE_H__
+#define __IC3_SAMPLES_ENGINE_TESTS_TEST_GPU_DEVICE_H__
+
+#include <Ic3/Graphics/GCI/CommandContext.h>
+#include <Ic3/Graphics/GCI/CommandList.h>
+#include <Ic3/Graphics/GCI/CommandSystem.h>
+#include <Ic3/Graphics/GCI/GPUDevice.h>
+#include <Ic3/Graphics/GCI/GPUDriverNull.h>
+#include <Ic3/Graphics/GCI/Resources/GPUBuffer.h>
+#include <Ic3/Graphics/GCI/State/GraphicsPipelineStateController.h>
+
+namespace Ic3::Samples
+{
+
+	namespace GCI = Ic3::Graphics::GCI;
+
+	/// Counters of the operations executed by the test device.
+	struct TestGPUDeviceStats
+	{
+		uint64 buffersNum = 0;
+		uint64 mapsNum = 0;
+		uint64 copiesNum = 0;
+		uint64 copiedBytesNum = 0;
+		uint64 uploadsNum = 0;
+		uint64 uploadedBytesNum = 0;
+		uint64 invalidRequestsNum = 0;
+	};
+
+	class TestGPUDevice;
+
+	/// Buffer stored in the system memory. Copies and uploads are executed immediately.
+	class TestGPUBuffer : public GCI::GPUBuffer
+	{
+	public:
+		TestGPUBuffer(
+			TestGPUDevice & pGPUDevice,
+			const GCI::ResourceMemoryInfo & pResourceMemory,
+			const GCI::GPUBufferProperties & pBufferProperties );
+
+		virtual ~TestGPUBuffer();
+
+		CPPX_ATTR_NO_DISCARD const byte * GetData() const noexcept
+		{
+			return _storage.data();
+		}
+
+	protected:
+		virtual bool MapRegion( void * pCommandObject, const GCI::GPUMemoryRegion & pRegion, GCI::EGPUMemoryMapMode pMapMode ) override final;
+
+		virtual void Unmap( void * pCommandObject ) override final;
+
+		virtual void FlushMappedRegion( void * pCommandObject, const GCI::GPUMemoryRegion & pRegion ) override final;
+
+		virtual void InvalidateRegion( void * pCommandObject, const GCI::GPUMemoryRegion & pRegion ) override final;
+
+		virtual void UpdateSubDataCopy( void * pCommandObject, GCI::GPUBuffer & pSourceBuffer, const GCI::GPUBufferSubDataCopyDesc & pCopyDesc ) override final;
+
+		virtual void UpdateSubDataUpload( void * pCommandObject, const GCI::GPUBufferSubDataUploadDesc & pUploadDesc ) override final;
+
+	private:
+		TestGPUDeviceStats & _deviceStats;
+		std::vector<byte> _storage;
+	};
+
+	/**
+	 * GPU device without a GPU: buffers live in the system memory and the transfer commands are executed immediately
+	 * by a single DirectTransfer context. Enough to run the CPU side of the renderer's resource code (uploads, staging,
+	 * relocations) in tests and benchmarks. Other resources and state objects are not supported.
+	 */
+	class TestGPUDevice : public GCI::GPUDevice
+	{
+		friend class TestGPUBuffer;
+
+	public:
+		explicit TestGPUDevice( GCI::GPUDriver & pDriver );
+		virtual ~TestGPUDevice();
+
+		virtual void WaitForCommandSync( GCI::CommandSync & pCommandSync ) override final;
+
+		/// Makes CreateGPUBuffer() reject buffers requesting persistently mapped memory (like drivers without it do).
+		void SetPersistentMappingSupported( bool pSupported ) noexcept
+		{
+			_persistentMappingSupported = pSupported;
+		}
+
+		CPPX_ATTR_NO_DISCARD GCI::CommandContextDirectTransfer & GetTransferContext() noexcept
+		{
+			return *_transferContext;
+		}
+
+		CPPX_ATTR_NO_DISCARD const TestGPUDeviceStats & GetStats() const noexcept
+		{
+			return _stats;
+		}
+
+		void ResetStats() noexcept
+		{
+			_stats = {};
+		}
+
+	private:
+		virtual void InitializeCommandSystem() override final;
+
+		virtual GCI::GPUBufferHandle _DrvCreateGPUBuffer( const GCI::GPUBufferCreateInfo & pCreateInfo ) override final;
+
+	private:
+		class CommandSystem;
+		class CommandList;
+		class PipelineStateController;
+
+		std::unique_ptr<PipelineStateController> _pipelineStateController;
+		std::unique_ptr<CommandList> _commandList;
+		std::unique_ptr<GCI::CommandContextDirectTransfer> _transferContext;
+		TestGPUDeviceStats _stats;
+		bool _persistentMappingSupported = true;
+	};
+
+	/// Owns a null driver and a TestGPUDevice created for it.
+	class TestGPUEnvironment
+	{
+	public:
+		TestGPUEnvironment();
+		~TestGPUEnvironment();
+
+		CPPX_ATTR_NO_DISCARD TestGPUDevice & GetDevice() noexcept
+		{
+			return *_device;
+		}
+
+	private:
+		GCI::GPUDriverNull _driver;
+		std::unique_ptr<TestGPUDevice> _device;
+	};
+
+} // namespace Ic3::Samples
+
+#endif // __IC3_SAMPLES_ENGINE_TESTS_TEST_GPU_DEVICE_H__
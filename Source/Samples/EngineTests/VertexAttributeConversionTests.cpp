@@ -0,0 +1,645 @@
+
+#include "TestCommon.h"
+#include <Ic3/NxMain/GCI/VertexAttributeConversion.h>
+
+#include <random>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		constexpr GCI::EBaseDataType kSourceDataTypes[] =
+		{
+			GCI::EBaseDataType::Byte,
+			GCI::EBaseDataType::Ubyte,
+			GCI::EBaseDataType::Int16,
+			GCI::EBaseDataType::Uint16,
+			GCI::EBaseDataType::Int32,
+			GCI::EBaseDataType::Uint32,
+			GCI::EBaseDataType::Float16,
+			GCI::EBaseDataType::Float32,
+			GCI::EBaseDataType::Double,
+		};
+
+		constexpr GCI::EVertexAttribFormat kTargetFormats[] =
+		{
+			GCI::EVertexAttribFormat::F16,
+			GCI::EVertexAttribFormat::F32,
+			GCI::EVertexAttribFormat::I8,
+			GCI::EVertexAttribFormat::I16,
+			GCI::EVertexAttribFormat::I32,
+			GCI::EVertexAttribFormat::U8,
+			GCI::EVertexAttribFormat::U16,
+			GCI::EVertexAttribFormat::U32,
+			GCI::EVertexAttribFormat::I8N,
+			GCI::EVertexAttribFormat::I16N,
+			GCI::EVertexAttribFormat::U8N,
+			GCI::EVertexAttribFormat::U16N,
+			GCI::EVertexAttribFormat::Vec2F16,
+			GCI::EVertexAttribFormat::Vec2F32,
+			GCI::EVertexAttribFormat::Vec2I8,
+			GCI::EVertexAttribFormat::Vec2I16,
+			GCI::EVertexAttribFormat::Vec2I32,
+			GCI::EVertexAttribFormat::Vec2U8,
+			GCI::EVertexAttribFormat::Vec2U16,
+			GCI::EVertexAttribFormat::Vec2U32,
+			GCI::EVertexAttribFormat::Vec2I8N,
+			GCI::EVertexAttribFormat::Vec2I16N,
+			GCI::EVertexAttribFormat::Vec2U8N,
+			GCI::EVertexAttribFormat::Vec2U16N,
+			GCI::EVertexAttribFormat::Vec3F32,
+			GCI::EVertexAttribFormat::Vec3I32,
+			GCI::EVertexAttribFormat::Vec3U32,
+			GCI::EVertexAttribFormat::Vec4F16,
+			GCI::EVertexAttribFormat::Vec4F32,
+			GCI::EVertexAttribFormat::Vec4I8,
+			GCI::EVertexAttribFormat::Vec4I16,
+			GCI::EVertexAttribFormat::Vec4I32,
+			GCI::EVertexAttribFormat::Vec4U8,
+			GCI::EVertexAttribFormat::Vec4U16,
+			GCI::EVertexAttribFormat::Vec4U32,
+			GCI::EVertexAttribFormat::Vec4I8N,
+			GCI::EVertexAttribFormat::Vec4I16N,
+			GCI::EVertexAttribFormat::Vec4U8N,
+			GCI::EVertexAttribFormat::Vec4U16N,
+		};
+
+		// Element counts: below/above the SIMD widths and across the 256-element chunks of the interleaved path.
+		constexpr uint32 kElementCounts[] = { 1, 3, 7, 16, 33, 255, 257, 1001 };
+
+		/// Expected encoding, written down from the documented rules (not from the implementation).
+		EVertexAttributeEncoding GetExpectedEncoding( GCI::EBaseDataType pSourceType, uint32 pSourceComponentsNum, GCI::EVertexAttribFormat pTargetFormat, bool pUnitVector )
+		{
+			const auto targetType = GCI::CXU::GetVertexAttribFormatBaseDataType( pTargetFormat );
+			const auto targetNormalized = GCI::CXU::GetVertexAttribFormatFlags( pTargetFormat ).is_set( GCI::eGPUDataFormatFlagNormalizedBit );
+
+			if( pSourceType == GCI::EBaseDataType::Float32 )
+			{
+				if( pUnitVector && ( pSourceComponentsNum >= 3 ) && ( pTargetFormat == GCI::EVertexAttribFormat::Vec2I16N ) )
+				{
+					return EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16;
+				}
+				if( pUnitVector && ( pSourceComponentsNum >= 3 ) && ( pTargetFormat == GCI::EVertexAttribFormat::U32 ) )
+				{
+					return EVertexAttributeEncoding::UnitVectorToSNorm1010102;
+				}
+				if( targetNormalized )
+				{
+					switch( targetType )
+					{
+						case GCI::EBaseDataType::Byte   : return EVertexAttributeEncoding::Float32ToSNorm8;
+						case GCI::EBaseDataType::Ubyte  : return EVertexAttributeEncoding::Float32ToUNorm8;
+						case GCI::EBaseDataType::Int16  : return EVertexAttributeEncoding::Float32ToSNorm16;
+						case GCI::EBaseDataType::Uint16 : return EVertexAttributeEncoding::Float32ToUNorm16;
+						default: return EVertexAttributeEncoding::Undefined;
+					}
+				}
+				if( targetType == GCI::EBaseDataType::Float16 )
+				{
+					return EVertexAttributeEncoding::Float32ToFloat16;
+				}
+			}
+
+			if( ( pSourceType == GCI::EBaseDataType::Double ) && ( targetType == GCI::EBaseDataType::Float32 ) )
+			{
+				return EVertexAttributeEncoding::Float64ToFloat32;
+			}
+			if( pSourceType == targetType )
+			{
+				// Includes integers -> normalized integers of the same type (data is already normalized).
+				return EVertexAttributeEncoding::Copy;
+			}
+			if( targetNormalized || ( targetType == GCI::EBaseDataType::Float16 ) || ( pSourceType == GCI::EBaseDataType::Float16 ) )
+			{
+				return EVertexAttributeEncoding::Undefined;
+			}
+			return EVertexAttributeEncoding::NumericCast;
+		}
+
+		/// Reference float -> half conversion, computed in double precision.
+		uint16 ReferenceFloatToHalf( float pValue )
+		{
+			const uint16 signBits = std::signbit( pValue ) ? 0x8000u : 0u;
+			const double absValue = std::fabs( static_cast<double>( pValue ) );
+
+			if( std::isnan( pValue ) )
+			{
+				return signBits | 0x7E00u;
+			}
+			if( std::isinf( pValue ) )
+			{
+				return signBits | 0x7C00u;
+			}
+			if( absValue < std::ldexp( 1.0, -14 ) )
+			{
+				// Subnormal range: a multiple of 2^-24 (rounding up to 1024 gives the smallest normal, which is correct).
+				return signBits | static_cast<uint16>( std::nearbyint( absValue * std::ldexp( 1.0, 24 ) ) );
+			}
+
+			int exponent;
+			std::frexp( absValue, &exponent );
+			exponent -= 1;
+
+			auto mantissa = static_cast<uint32>( std::nearbyint( ( absValue / std::ldexp( 1.0, exponent ) - 1.0 ) * 1024.0 ) );
+			if( mantissa == 1024 )
+			{
+				mantissa = 0;
+				exponent += 1;
+			}
+			if( exponent + 15 >= 31 )
+			{
+				return signBits | 0x7C00u;
+			}
+			return signBits | static_cast<uint16>( ( static_cast<uint32>( exponent + 15 ) << 10 ) | mantissa );
+		}
+
+		/// Reference float -> normalized integer: NaN -> min, clamp, scale, round to nearest-even.
+		int32 ReferenceFloatToNormalized( float pValue, float pMin, float pScale )
+		{
+			if( std::isnan( pValue ) )
+			{
+				pValue = pMin;
+			}
+			pValue = std::min( std::max( pValue, pMin ), 1.0f );
+			return static_cast<int32>( std::nearbyint( pValue * pScale ) );
+		}
+
+		double ReadComponent( GCI::EBaseDataType pType, const byte * pData )
+		{
+			switch( pType )
+			{
+				case GCI::EBaseDataType::Byte    : { int8 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Ubyte   : { uint8 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Int16   : { int16 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Uint16  : { uint16 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Int32   : { int32 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Uint32  : { uint32 value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Float32 : { float value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				case GCI::EBaseDataType::Double  : { double value; std::memcpy( &value, pData, sizeof( value ) ); return value; }
+				default: return 0.0;
+			}
+		}
+
+		template <typename TPValue>
+		void StoreValue( byte * pTarget, TPValue pValue )
+		{
+			std::memcpy( pTarget, &pValue, sizeof( TPValue ) );
+		}
+
+		void WriteComponent( GCI::EBaseDataType pType, double pValue, byte * pTarget )
+		{
+			switch( pType )
+			{
+				case GCI::EBaseDataType::Byte    : StoreValue( pTarget, static_cast<int8>( pValue ) ); break;
+				case GCI::EBaseDataType::Ubyte   : StoreValue( pTarget, static_cast<uint8>( pValue ) ); break;
+				case GCI::EBaseDataType::Int16   : StoreValue( pTarget, static_cast<int16>( pValue ) ); break;
+				case GCI::EBaseDataType::Uint16  : StoreValue( pTarget, static_cast<uint16>( pValue ) ); break;
+				case GCI::EBaseDataType::Int32   : StoreValue( pTarget, static_cast<int32>( pValue ) ); break;
+				case GCI::EBaseDataType::Uint32  : StoreValue( pTarget, static_cast<uint32>( pValue ) ); break;
+				case GCI::EBaseDataType::Float32 : StoreValue( pTarget, static_cast<float>( pValue ) ); break;
+				case GCI::EBaseDataType::Double  : StoreValue( pTarget, pValue ); break;
+				default: break;
+			}
+		}
+
+		/// Fills the source with data valid for the encoding (small non-negative integers for numeric casts, which
+		/// must be representable in every type, unit vectors for the packed normal encodings, etc).
+		void GenerateSourceData( std::mt19937 & pGenerator, EVertexAttributeEncoding pEncoding, GCI::EBaseDataType pSourceType, uint32 pComponentsNum, uint32 pElementsNum, std::vector<byte> & pOutData )
+		{
+			const auto componentSize = GCI::CXU::GetBaseDataTypeByteSize( pSourceType );
+			pOutData.resize( pElementsNum * pComponentsNum * componentSize );
+
+			std::uniform_int_distribution<uint32> bitsDistribution;
+			std::uniform_real_distribution<float> normalizedDistribution( -1.3f, 1.3f );
+			std::uniform_int_distribution<int32> smallIntDistribution( 0, 100 );
+
+			for( uint32 elementIndex = 0; elementIndex < pElementsNum; ++elementIndex )
+			{
+				auto * elementPtr = pOutData.data() + elementIndex * pComponentsNum * componentSize;
+
+				if( ( pEncoding == EVertexAttributeEncoding::UnitVectorToSNorm1010102 ) || ( pEncoding == EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16 ) )
+				{
+					float vector[4] = { normalizedDistribution( pGenerator ), normalizedDistribution( pGenerator ), normalizedDistribution( pGenerator ), 0.0f };
+					const auto length = std::sqrt( vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2] );
+					for( auto & component : vector )
+					{
+						component = ( length > 1e-3f ) ? ( component / length ) : 0.0f;
+					}
+					// Tangent handedness.
+					vector[3] = ( elementIndex & 1 ) ? 1.0f : -1.0f;
+					std::memcpy( elementPtr, vector, pComponentsNum * sizeof( float ) );
+					continue;
+				}
+
+				for( uint32 componentIndex = 0; componentIndex < pComponentsNum; ++componentIndex )
+				{
+					auto * componentPtr = elementPtr + componentIndex * componentSize;
+					switch( pEncoding )
+					{
+						case EVertexAttributeEncoding::Float32ToSNorm8:
+						case EVertexAttributeEncoding::Float32ToUNorm8:
+						case EVertexAttributeEncoding::Float32ToSNorm16:
+						case EVertexAttributeEncoding::Float32ToUNorm16:
+						{
+							// Out-of-range values, NaNs and exact rounding ties.
+							float value = normalizedDistribution( pGenerator );
+							if( elementIndex % 5 == 1 )
+							{
+								value = std::numeric_limits<float>::quiet_NaN();
+							}
+							else if( elementIndex % 5 == 2 )
+							{
+								value = 0.5f / 127.0f;
+							}
+							StoreValue( componentPtr, value );
+							break;
+						}
+						case EVertexAttributeEncoding::Float32ToFloat16:
+						{
+							// Any bit pattern: normals, subnormals, overflows, infinities and NaNs.
+							StoreValue( componentPtr, bitsDistribution( pGenerator ) );
+							break;
+						}
+						case EVertexAttributeEncoding::Float64ToFloat32:
+						{
+							std::uniform_real_distribution<double> doubleDistribution( -1.0e6, 1.0e6 );
+							StoreValue( componentPtr, doubleDistribution( pGenerator ) );
+							break;
+						}
+						case EVertexAttributeEncoding::NumericCast:
+						{
+							WriteComponent( pSourceType, smallIntDistribution( pGenerator ), componentPtr );
+							break;
+						}
+						default:
+						{
+							// Copy: raw bytes.
+							for( uint32 byteIndex = 0; byteIndex < componentSize; ++byteIndex )
+							{
+								componentPtr[byteIndex] = static_cast<byte>( bitsDistribution( pGenerator ) );
+							}
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		/// Computes the expected target element (including zeroed trailing components).
+		void ComputeReferenceElement( const VertexAttributeConversionDesc & pDesc, const byte * pSourceElement, byte * pTargetElement, uint32 pTargetElementSize )
+		{
+			std::memset( pTargetElement, 0, pTargetElementSize );
+
+			const auto sourceComponentSize = GCI::CXU::GetBaseDataTypeByteSize( pDesc.sourceDataType );
+			const auto targetComponentSize = GCI::CXU::GetBaseDataTypeByteSize( pDesc.targetDataType );
+			const auto componentsNum = std::min( pDesc.sourceComponentsNum, pDesc.targetComponentsNum );
+
+			float vector[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			if( pDesc.sourceDataType == GCI::EBaseDataType::Float32 )
+			{
+				std::memcpy( vector, pSourceElement, std::min<uint32>( pDesc.sourceComponentsNum, 4 ) * sizeof( float ) );
+			}
+
+			switch( pDesc.encoding )
+			{
+				case EVertexAttributeEncoding::UnitVectorToSNorm1010102:
+				{
+					const auto w = ( pDesc.sourceComponentsNum >= 4 ) ? vector[3] : 0.0f;
+					const auto packed =
+						( static_cast<uint32>( ReferenceFloatToNormalized( vector[0], -1.0f, 511.0f ) ) & 0x3FFu ) |
+						( ( static_cast<uint32>( ReferenceFloatToNormalized( vector[1], -1.0f, 511.0f ) ) & 0x3FFu ) << 10 ) |
+						( ( static_cast<uint32>( ReferenceFloatToNormalized( vector[2], -1.0f, 511.0f ) ) & 0x3FFu ) << 20 ) |
+						( ( static_cast<uint32>( ReferenceFloatToNormalized( w, -1.0f, 1.0f ) ) & 0x3u ) << 30 );
+					StoreValue( pTargetElement, packed );
+					return;
+				}
+				case EVertexAttributeEncoding::UnitVectorToOctahedralSNorm16:
+				{
+					float octU, octV;
+					GCIUtils::EncodeUnitVectorOctahedral( vector[0], vector[1], vector[2], octU, octV );
+					StoreValue( pTargetElement, static_cast<int16>( ReferenceFloatToNormalized( octU, -1.0f, 32767.0f ) ) );
+					StoreValue( pTargetElement + 2, static_cast<int16>( ReferenceFloatToNormalized( octV, -1.0f, 32767.0f ) ) );
+					return;
+				}
+				default:
+				{
+					break;
+				}
+			}
+
+			for( uint32 componentIndex = 0; componentIndex < componentsNum; ++componentIndex )
+			{
+				const auto * sourcePtr = pSourceElement + componentIndex * sourceComponentSize;
+				auto * targetPtr = pTargetElement + componentIndex * targetComponentSize;
+
+				switch( pDesc.encoding )
+				{
+					case EVertexAttributeEncoding::Copy:
+						std::memcpy( targetPtr, sourcePtr, sourceComponentSize );
+						break;
+					case EVertexAttributeEncoding::NumericCast:
+					case EVertexAttributeEncoding::Float64ToFloat32:
+						WriteComponent( pDesc.targetDataType, ReadComponent( pDesc.sourceDataType, sourcePtr ), targetPtr );
+						break;
+					case EVertexAttributeEncoding::Float32ToFloat16:
+						StoreValue( targetPtr, ReferenceFloatToHalf( vector[componentIndex] ) );
+						break;
+					case EVertexAttributeEncoding::Float32ToSNorm8:
+						StoreValue( targetPtr, static_cast<int8>( ReferenceFloatToNormalized( vector[componentIndex], -1.0f, 127.0f ) ) );
+						break;
+					case EVertexAttributeEncoding::Float32ToUNorm8:
+						StoreValue( targetPtr, static_cast<uint8>( ReferenceFloatToNormalized( vector[componentIndex], 0.0f, 255.0f ) ) );
+						break;
+					case EVertexAttributeEncoding::Float32ToSNorm16:
+						StoreValue( targetPtr, static_cast<int16>( ReferenceFloatToNormalized( vector[componentIndex], -1.0f, 32767.0f ) ) );
+						break;
+					case EVertexAttributeEncoding::Float32ToUNorm16:
+						StoreValue( targetPtr, static_cast<uint16>( ReferenceFloatToNormalized( vector[componentIndex], 0.0f, 65535.0f ) ) );
+						break;
+					default:
+						break;
+				}
+			}
+		}
+
+		/// Float32 -> float16 compares NaNs by class only (any quiet NaN with the same sign is fine).
+		bool CompareElements( const VertexAttributeConversionDesc & pDesc, const byte * pResult, const byte * pReference, uint32 pElementSize )
+		{
+			if( pDesc.encoding != EVertexAttributeEncoding::Float32ToFloat16 )
+			{
+				return std::memcmp( pResult, pReference, pElementSize ) == 0;
+			}
+
+			for( uint32 byteOffset = 0; byteOffset < pElementSize; byteOffset += 2 )
+			{
+				uint16 result, reference;
+				std::memcpy( &result, pResult + byteOffset, 2 );
+				std::memcpy( &reference, pReference + byteOffset, 2 );
+
+				const auto isResultNaN = ( ( result & 0x7C00u ) == 0x7C00u ) && ( ( result & 0x3FFu ) != 0 );
+				const auto isReferenceNaN = ( ( reference & 0x7C00u ) == 0x7C00u ) && ( ( reference & 0x3FFu ) != 0 );
+				if( isResultNaN != isReferenceNaN )
+				{
+					return false;
+				}
+				if( isResultNaN ? ( ( result & 0x8000u ) != ( reference & 0x8000u ) ) : ( result != reference ) )
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		struct ConversionPairStats
+		{
+			uint32 resolvedPairsNum = 0;
+			uint32 supportedPairsNum = 0;
+			uint32 convertedStreamsNum = 0;
+		};
+
+		void TestConversionPair(
+				TestContext & pTestContext,
+				std::mt19937 & pGenerator,
+				GCI::EBaseDataType pSourceType,
+				uint32 pSourceComponentsNum,
+				GCI::EVertexAttribFormat pTargetFormat,
+				bool pUnitVector,
+				ConversionPairStats & pStats )
+		{
+			GenericVertexInputAttribute targetAttribute{};
+			targetAttribute.attributeSlot = 0;
+			targetAttribute.dataFormat = pTargetFormat;
+			targetAttribute.semanticFlags = pUnitVector ? eVertexAttributeSemanticFlagNormalBit : eVertexAttributeSemanticFlagTexCoord0Bit;
+
+			const auto conversionDesc = GCIUtils::ResolveVertexAttributeConversion( pSourceType, pSourceComponentsNum, targetAttribute );
+			const auto expectedEncoding = GetExpectedEncoding( pSourceType, pSourceComponentsNum, pTargetFormat, pUnitVector );
+
+			++pStats.resolvedPairsNum;
+
+			if( !Ic3TestCheck( conversionDesc.encoding == expectedEncoding ) )
+			{
+				TestOutput( "  resolve: source %u x%u, target format 0x%x, unit vector %u", ( uint32 )pSourceType, pSourceComponentsNum, ( uint32 )pTargetFormat, ( uint32 )pUnitVector );
+				return;
+			}
+
+			if( !conversionDesc )
+			{
+				// Unsupported pairs must be rejected by the conversion as well.
+				byte dummyData[64] = {};
+				Ic3TestCheck( !GCIUtils::ConvertVertexAttributeStream( conversionDesc, { dummyData, 16 }, { dummyData + 32, 16 }, 1 ) );
+				return;
+			}
+
+			++pStats.supportedPairsNum;
+
+			const auto sourceComponentSize = GCI::CXU::GetBaseDataTypeByteSize( pSourceType );
+			const uint32 sourceElementSize = sourceComponentSize * pSourceComponentsNum;
+			const uint32 targetElementSize = GCI::CXU::GetBaseDataTypeByteSize( conversionDesc.targetDataType ) * conversionDesc.targetComponentsNum;
+
+			std::vector<byte> sourceData;
+			std::vector<byte> sourceStream;
+			std::vector<byte> targetStream;
+			std::vector<byte> referenceElement( targetElementSize );
+
+			for( const auto elementsNum : kElementCounts )
+			{
+				GenerateSourceData( pGenerator, conversionDesc.encoding, pSourceType, pSourceComponentsNum, elementsNum, sourceData );
+
+				// Packed and interleaved (padded) layouts of both streams. Padding is checked for overwrites.
+				for( const uint32 sourcePadding : { 0u, 12u } )
+				{
+					for( const uint32 targetPadding : { 0u, 8u } )
+					{
+						const auto sourceStride = sourceElementSize + sourcePadding;
+						const auto targetStride = targetElementSize + targetPadding;
+
+						sourceStream.assign( elementsNum * sourceStride, 0xEE );
+						for( uint32 elementIndex = 0; elementIndex < elementsNum; ++elementIndex )
+						{
+							std::memcpy( sourceStream.data() + elementIndex * sourceStride, sourceData.data() + elementIndex * sourceElementSize, sourceElementSize );
+						}
+
+						targetStream.assign( elementsNum * targetStride, 0xCD );
+
+						const auto converted = GCIUtils::ConvertVertexAttributeStream(
+								conversionDesc,
+								{ sourceStream.data(), sourceStride },
+								{ targetStream.data(), targetStride },
+								elementsNum );
+
+						if( !Ic3TestCheck( converted ) )
+						{
+							return;
+						}
+
+						++pStats.convertedStreamsNum;
+
+						for( uint32 elementIndex = 0; elementIndex < elementsNum; ++elementIndex )
+						{
+							const auto * targetElement = targetStream.data() + elementIndex * targetStride;
+							ComputeReferenceElement( conversionDesc, sourceData.data() + elementIndex * sourceElementSize, referenceElement.data(), targetElementSize );
+
+							const auto elementValid = CompareElements( conversionDesc, targetElement, referenceElement.data(), targetElementSize );
+							const auto paddingIntact = std::all_of( targetElement + targetElementSize, targetElement + targetStride, []( byte pByte ) -> bool {
+								return pByte == 0xCD;
+							} );
+
+							if( !Ic3TestCheck( elementValid && paddingIntact ) )
+							{
+								TestOutput( "  convert: encoding %u, source %u x%u, target format 0x%x, %u elements, strides %u/%u, element %u",
+								            ( uint32 )conversionDesc.encoding, ( uint32 )pSourceType, pSourceComponentsNum, ( uint32 )pTargetFormat,
+								            elementsNum, sourceStride, targetStride, elementIndex );
+								return;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		void BenchmarkConversion(
+				const char * pName,
+				GCI::EBaseDataType pSourceType,
+				uint32 pSourceComponentsNum,
+				GCI::EVertexAttribFormat pTargetFormat,
+				bool pUnitVector,
+				uint32 pElementsNum,
+				uint32 pIterationsNum )
+		{
+			GenericVertexInputAttribute targetAttribute{};
+			targetAttribute.attributeSlot = 0;
+			targetAttribute.dataFormat = pTargetFormat;
+			targetAttribute.semanticFlags = pUnitVector ? eVertexAttributeSemanticFlagNormalBit : eVertexAttributeSemanticFlagPositionBit;
+
+			const auto conversionDesc = GCIUtils::ResolveVertexAttributeConversion( pSourceType, pSourceComponentsNum, targetAttribute );
+
+			std::mt19937 generator( 7 );
+			std::vector<byte> sourceData;
+			GenerateSourceData( generator, conversionDesc.encoding, pSourceType, pSourceComponentsNum, pElementsNum, sourceData );
+
+			const uint32 sourceStride = GCI::CXU::GetBaseDataTypeByteSize( pSourceType ) * pSourceComponentsNum;
+			const uint32 targetElementSize = GCI::CXU::GetBaseDataTypeByteSize( conversionDesc.targetDataType ) * conversionDesc.targetComponentsNum;
+
+			// De-interleaved target (a separate stream per attribute) and an interleaved one (32-byte vertices).
+			for( const uint32 targetStride : { targetElementSize, std::max<uint32>( 32u, targetElementSize ) } )
+			{
+				std::vector<byte> targetStream( pElementsNum * targetStride );
+
+				Stopwatch stopwatch;
+				for( uint32 iteration = 0; iteration < pIterationsNum; ++iteration )
+				{
+					GCIUtils::ConvertVertexAttributeStream( conversionDesc, { sourceData.data(), sourceStride }, { targetStream.data(), targetStride }, pElementsNum );
+				}
+				const auto elapsedMs = stopwatch.GetElapsedMilliseconds() / pIterationsNum;
+
+				TestOutput( "  %-32s stride %2u: %8.3f ms / %u elements, %6.2f GB/s (input)",
+				            pName, targetStride, elapsedMs, pElementsNum, ( double )sourceData.size() / ( elapsedMs * 1.0e6 ) );
+			}
+		}
+
+	}
+
+	Ic3TestCase( VertexAttributeConversion, EncodingHelpers )
+	{
+		// Known values of the scalar helpers, which are the reference for the SIMD kernels.
+		Ic3TestCheck( GCIUtils::EncodeFloat16( 1.0f ) == 0x3C00 );
+		Ic3TestCheck( GCIUtils::EncodeFloat16( -2.0f ) == 0xC000 );
+		Ic3TestCheck( GCIUtils::EncodeFloat16( 65504.0f ) == 0x7BFF );
+		Ic3TestCheck( GCIUtils::EncodeFloat16( 65520.0f ) == 0x7C00 );
+		Ic3TestCheck( GCIUtils::EncodeFloat16( 5.96046448e-8f ) == 0x0001 );
+		Ic3TestCheck( GCIUtils::EncodeNormalizedValue( 1.0f, -1.0f, 32767.0f ) == 32767 );
+		Ic3TestCheck( GCIUtils::EncodeNormalizedValue( -2.0f, -1.0f, 32767.0f ) == -32767 );
+		Ic3TestCheck( GCIUtils::EncodeNormalizedValue( 0.5f, 0.0f, 255.0f ) == 128 );
+		Ic3TestCheck( GCIUtils::EncodeNormalizedValue( std::numeric_limits<float>::quiet_NaN(), 0.0f, 255.0f ) == 0 );
+
+		// Scalar helpers vs the independent reference, over a sweep of float bit patterns.
+		const uint32 bitsStep = pTestContext.SelectSize<uint32>( 65537, 4099 );
+		for( uint64 valueBits = 0; valueBits < 0x100000000ull; valueBits += bitsStep )
+		{
+			float value;
+			const auto valueBits32 = static_cast<uint32>( valueBits );
+			std::memcpy( &value, &valueBits32, sizeof( float ) );
+
+			const auto encoded = GCIUtils::EncodeFloat16( value );
+			const auto reference = ReferenceFloatToHalf( value );
+			if( !Ic3TestCheck( std::isnan( value ) ? ( ( encoded & 0x7E00u ) == 0x7E00u ) : ( encoded == reference ) ) )
+			{
+				TestOutput( "  EncodeFloat16: 0x%08x -> 0x%04x, expected 0x%04x", valueBits32, encoded, reference );
+				break;
+			}
+		}
+
+		// Octahedral round trip.
+		std::mt19937 generator( 1 );
+		std::uniform_real_distribution<float> distribution( -1.0f, 1.0f );
+		for( uint32 vectorIndex = 0; vectorIndex < 10000; ++vectorIndex )
+		{
+			const auto vector = cxm::normalize( cxm::vec3f{ distribution( generator ), distribution( generator ), distribution( generator ) + 1e-3f } );
+
+			float octU, octV;
+			GCIUtils::EncodeUnitVectorOctahedral( vector.x, vector.y, vector.z, octU, octV );
+			const auto encodedU = static_cast<int16>( GCIUtils::EncodeNormalizedValue( octU, -1.0f, 32767.0f ) );
+			const auto encodedV = static_cast<int16>( GCIUtils::EncodeNormalizedValue( octV, -1.0f, 32767.0f ) );
+			const auto decoded = GCIUtils::DecodeUnitVectorOctahedral( encodedU / 32767.0f, encodedV / 32767.0f );
+
+			const auto error = std::fabs( decoded.x - vector.x ) + std::fabs( decoded.y - vector.y ) + std::fabs( decoded.z - vector.z );
+			if( !Ic3TestCheck( error < 1e-3f ) )
+			{
+				break;
+			}
+		}
+	}
+
+	Ic3TestCase( VertexAttributeConversion, FormatPairs )
+	{
+		// Every source type x source components x target format, for a regular attribute and a normal. Supported
+		// pairs are converted in packed and interleaved layouts and compared element-by-element with the reference.
+		std::mt19937 generator( 3 );
+		ConversionPairStats stats{};
+
+		for( const auto sourceType : kSourceDataTypes )
+		{
+			for( uint32 sourceComponentsNum = 1; sourceComponentsNum <= 4; ++sourceComponentsNum )
+			{
+				for( const auto targetFormat : kTargetFormats )
+				{
+					for( const bool unitVector : { false, true } )
+					{
+						TestConversionPair( pTestContext, generator, sourceType, sourceComponentsNum, targetFormat, unitVector, stats );
+					}
+				}
+			}
+		}
+
+		TestOutput( "  %u pairs resolved, %u supported, %u streams converted",
+		            stats.resolvedPairsNum, stats.supportedPairsNum, stats.convertedStreamsNum );
+
+		// Mismatched strides (smaller than the element) are rejected.
+		GenericVertexInputAttribute targetAttribute{};
+		targetAttribute.attributeSlot = 0;
+		targetAttribute.dataFormat = GCI::EVertexAttribFormat::Vec4F16;
+		const auto conversionDesc = GCIUtils::ResolveVertexAttributeConversion( GCI::EBaseDataType::Float32, 4, targetAttribute );
+		byte dummyData[64] = {};
+		Ic3TestCheck( !GCIUtils::ConvertVertexAttributeStream( conversionDesc, { dummyData, 8 }, { dummyData + 32, 8 }, 1 ) );
+		Ic3TestCheck( !GCIUtils::ConvertVertexAttributeStream( conversionDesc, { dummyData, 16 }, { dummyData + 32, 4 }, 1 ) );
+	}
+
+	Ic3TestBenchmark( VertexAttributeConversion, Throughput )
+	{
+		const auto elementsNum = pTestContext.SelectSize<uint32>( 1u << 16, 1u << 20 );
+		const auto iterationsNum = pTestContext.SelectSize<uint32>( 2, 10 );
+
+		BenchmarkConversion( "f32x3 -> f32x3 (copy)", GCI::EBaseDataType::Float32, 3, GCI::EVertexAttribFormat::Vec3F32, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "f32x4 -> f16x4", GCI::EBaseDataType::Float32, 4, GCI::EVertexAttribFormat::Vec4F16, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "f32x2 -> unorm16x2", GCI::EBaseDataType::Float32, 2, GCI::EVertexAttribFormat::Vec2U16N, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "f32x4 -> snorm16x4", GCI::EBaseDataType::Float32, 4, GCI::EVertexAttribFormat::Vec4I16N, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "f32x4 -> unorm8x4", GCI::EBaseDataType::Float32, 4, GCI::EVertexAttribFormat::Vec4U8N, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "normal f32x3 -> 10:10:10:2", GCI::EBaseDataType::Float32, 3, GCI::EVertexAttribFormat::U32, true, elementsNum, iterationsNum );
+		BenchmarkConversion( "normal f32x3 -> octahedral 16", GCI::EBaseDataType::Float32, 3, GCI::EVertexAttribFormat::Vec2I16N, true, elementsNum, iterationsNum );
+		BenchmarkConversion( "f64x3 -> f32x3", GCI::EBaseDataType::Double, 3, GCI::EVertexAttribFormat::Vec3F32, false, elementsNum, iterationsNum );
+		BenchmarkConversion( "u32 -> u16 (numeric cast)", GCI::EBaseDataType::Uint32, 1, GCI::EVertexAttribFormat::U16, false, elementsNum, iterationsNum );
+	}
+
+} // namespace Ic3::Samples
@@ -0,0 +1,350 @@
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+#include <Ic3/NxMain/Renderer/Visibility/VisibilitySystem.h>
+
+#include <algorithm>
+#include <random>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		/// Every n-th object of the generated scene is a large occluder ("building"), the rest are small props.
+		constexpr size_t kTestSceneOccluderInterval = 100;
+
+		VisibilityViewDesc MakeTestViewDesc()
+		{
+			const auto viewMatrix = cxm::look_at_LH( cxm::vec3f{ 0.0f, 2.0f, 0.0f }, cxm::vec3f{ 0.2f, 2.0f, 1.0f }, cxm::vec3f{ 0.0f, 1.0f, 0.0f } );
+			const auto projectionMatrix = cxm::perspective_aspect_LH( 1.0f, 16.0f / 9.0f, 0.5f, 1500.0f );
+			return MakeVisibilityViewDesc( viewMatrix, projectionMatrix, false );
+		}
+
+		/// Fills the system with pObjectsNum objects placed randomly on a 2x2 km ground plane. Object i has userTag i.
+		std::vector<cxm::aabbf> GenerateTestScene( VisibilitySystem & pVisibilitySystem, size_t pObjectsNum, uint32 pSeed )
+		{
+			std::mt19937 randomGenerator{ pSeed };
+			std::uniform_real_distribution<float> positionDistribution{ -1000.0f, 1000.0f };
+			std::uniform_real_distribution<float> sizeDistribution{ 0.5f, 3.0f };
+
+			std::vector<cxm::aabbf> objectBoundsArray( pObjectsNum );
+
+			for( size_t objectIndex = 0; objectIndex < pObjectsNum; ++objectIndex )
+			{
+				const auto posX = positionDistribution( randomGenerator );
+				const auto posZ = positionDistribution( randomGenerator );
+				const auto size = sizeDistribution( randomGenerator );
+
+				VisibilityObjectDesc objectDesc;
+				if( objectIndex % kTestSceneOccluderInterval == 0 )
+				{
+					const auto halfWidth = 10.0f + sizeDistribution( randomGenerator ) * 5.0f;
+					const auto height = 20.0f + sizeDistribution( randomGenerator ) * 10.0f;
+					objectDesc.bounds = { { posX - halfWidth, 0.0f, posZ - halfWidth }, { posX + halfWidth, height, posZ + halfWidth } };
+					objectDesc.isOccluder = true;
+					objectDesc.occluderVolume = objectDesc.bounds;
+				}
+				else
+				{
+					objectDesc.bounds = { { posX - size, 0.0f, posZ - size }, { posX + size, 2.0f * size, posZ + size } };
+				}
+				objectDesc.userTag = static_cast<uint32>( objectIndex );
+
+				objectBoundsArray[objectIndex] = objectDesc.bounds;
+				pVisibilitySystem.AddObject( objectDesc );
+			}
+
+			return objectBoundsArray;
+		}
+
+		std::vector<uint32> GetSortedVisibleTags( const VisibilityDrawList & pDrawList )
+		{
+			std::vector<uint32> visibleTags;
+			visibleTags.reserve( pDrawList.objectArray.size() );
+			for( const auto & visibleObject : pDrawList.objectArray )
+			{
+				visibleTags.push_back( visibleObject.userTag );
+			}
+			std::sort( visibleTags.begin(), visibleTags.end() );
+			return visibleTags;
+		}
+
+		/// Reference result: objects (with their index as the tag) whose bounds intersect the frustum, tested one by one.
+		std::vector<uint32> GetBruteForceVisibleTags( const VisibilityViewDesc & pViewDesc, const std::vector<cxm::aabbf> & pObjectBoundsArray, const std::vector<bool> & pObjectActiveFlags )
+		{
+			std::vector<uint32> visibleTags;
+			for( size_t objectIndex = 0; objectIndex < pObjectBoundsArray.size(); ++objectIndex )
+			{
+				if( pObjectActiveFlags[objectIndex] && cxm::intersects( pViewDesc.frustum, pObjectBoundsArray[objectIndex] ) )
+				{
+					visibleTags.push_back( static_cast<uint32>( objectIndex ) );
+				}
+			}
+			return visibleTags;
+		}
+
+		/// Returns true if the segment [pOrigin, pTarget) intersects the box (slab test).
+		bool SegmentIntersectsBox( const cxm::vec3f & pOrigin, const cxm::vec3f & pTarget, const cxm::aabbf & pBox )
+		{
+			const float origin[3] = { pOrigin.x, pOrigin.y, pOrigin.z };
+			const float direction[3] = { pTarget.x - pOrigin.x, pTarget.y - pOrigin.y, pTarget.z - pOrigin.z };
+			const float boxMin[3] = { pBox.min_corner.x, pBox.min_corner.y, pBox.min_corner.z };
+			const float boxMax[3] = { pBox.max_corner.x, pBox.max_corner.y, pBox.max_corner.z };
+
+			float segmentMin = 0.0f;
+			float segmentMax = 0.999f;
+
+			for( uint32 axisIndex = 0; axisIndex < 3; ++axisIndex )
+			{
+				if( std::fabs( direction[axisIndex] ) < 1e-9f )
+				{
+					if( ( origin[axisIndex] < boxMin[axisIndex] ) || ( origin[axisIndex] > boxMax[axisIndex] ) )
+					{
+						return false;
+					}
+				}
+				else
+				{
+					auto slabMin = ( boxMin[axisIndex] - origin[axisIndex] ) / direction[axisIndex];
+					auto slabMax = ( boxMax[axisIndex] - origin[axisIndex] ) / direction[axisIndex];
+					if( slabMin > slabMax )
+					{
+						std::swap( slabMin, slabMax );
+					}
+					segmentMin = std::max( segmentMin, slabMin );
+					segmentMax = std::min( segmentMax, slabMax );
+					if( segmentMin > segmentMax )
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+	}
+
+	Ic3TestCase( Visibility, FrustumMatchesBruteForce )
+	{
+		const auto objectsNum = pTestContext.SelectSize<size_t>( 20000, 200000 );
+		const auto viewDesc = MakeTestViewDesc();
+
+		VisibilitySystem visibilitySystem;
+		auto objectBoundsArray = GenerateTestScene( visibilitySystem, objectsNum, 7 );
+		std::vector<bool> objectActiveFlags( objectsNum, true );
+
+		VisibilityDrawList drawList;
+		VisibilityCullingConfig cullingConfig;
+
+		visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+		Ic3TestCheck( drawList.stats.objectsNum == objectsNum );
+		Ic3TestCheck( GetSortedVisibleTags( drawList ) == GetBruteForceVisibleTags( viewDesc, objectBoundsArray, objectActiveFlags ) );
+
+		// Moved objects (refit of the hierarchy).
+		for( size_t objectIndex = 1; objectIndex < objectsNum; objectIndex += 37 )
+		{
+			auto & objectBounds = objectBoundsArray[objectIndex];
+			objectBounds.min_corner.x += 25.0f;
+			objectBounds.max_corner.x += 25.0f;
+			objectBounds.min_corner.z -= 40.0f;
+			objectBounds.max_corner.z -= 40.0f;
+			visibilitySystem.UpdateObjectBounds( static_cast<visibility_object_handle_t>( objectIndex ), objectBounds );
+		}
+
+		visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+		Ic3TestCheck( GetSortedVisibleTags( drawList ) == GetBruteForceVisibleTags( viewDesc, objectBoundsArray, objectActiveFlags ) );
+
+		// Removed objects (rebuild of the hierarchy).
+		for( size_t objectIndex = 3; objectIndex < objectsNum; objectIndex += 11 )
+		{
+			visibilitySystem.RemoveObject( static_cast<visibility_object_handle_t>( objectIndex ) );
+			objectActiveFlags[objectIndex] = false;
+		}
+
+		visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+		Ic3TestCheck( drawList.stats.objectsNum == visibilitySystem.GetObjectsNum() );
+		Ic3TestCheck( GetSortedVisibleTags( drawList ) == GetBruteForceVisibleTags( viewDesc, objectBoundsArray, objectActiveFlags ) );
+	}
+
+	Ic3TestCase( Visibility, OcclusionWall )
+	{
+		const auto viewDesc = MakeTestViewDesc();
+
+		VisibilitySystem visibilitySystem;
+
+		VisibilityObjectDesc wallDesc;
+		wallDesc.bounds = { { -200.0f, -50.0f, 49.0f }, { 200.0f, 100.0f, 51.0f } };
+		wallDesc.userTag = 0;
+		wallDesc.isOccluder = true;
+		wallDesc.occluderVolume = wallDesc.bounds;
+		visibilitySystem.AddObject( wallDesc );
+
+		VisibilityObjectDesc hiddenObjectDesc;
+		hiddenObjectDesc.bounds = { { 0.0f, 1.0f, 80.0f }, { 1.0f, 3.0f, 81.0f } };
+		hiddenObjectDesc.userTag = 1;
+		visibilitySystem.AddObject( hiddenObjectDesc );
+
+		VisibilityObjectDesc frontObjectDesc;
+		frontObjectDesc.bounds = { { 0.0f, 1.0f, 20.0f }, { 1.0f, 3.0f, 21.0f } };
+		frontObjectDesc.userTag = 2;
+		visibilitySystem.AddObject( frontObjectDesc );
+
+		VisibilityDrawList drawList;
+		VisibilityCullingConfig cullingConfig;
+
+		visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+		Ic3TestCheck( ( GetSortedVisibleTags( drawList ) == std::vector<uint32>{ 0, 1, 2 } ) );
+
+		cullingConfig.enableOcclusionCulling = true;
+		visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+		Ic3TestCheck( ( GetSortedVisibleTags( drawList ) == std::vector<uint32>{ 0, 2 } ) );
+		Ic3TestCheck( drawList.stats.occludersRasterizedNum == 1 );
+		Ic3TestCheck( drawList.stats.occlusionCulledObjectsNum == 1 );
+	}
+
+	Ic3TestCase( Visibility, OcclusionConservative )
+	{
+		// Occlusion culling must never remove an object which can be seen: every culled object has to be hidden
+		// behind an occluder at least along the ray to its center.
+		const auto objectsNum = pTestContext.SelectSize<size_t>( 20000, 100000 );
+		const auto viewDesc = MakeTestViewDesc();
+
+		VisibilitySystem visibilitySystem;
+		const auto objectBoundsArray = GenerateTestScene( visibilitySystem, objectsNum, 11 );
+
+		std::vector<cxm::aabbf> occluderBoundsArray;
+		for( size_t objectIndex = 0; objectIndex < objectsNum; objectIndex += kTestSceneOccluderInterval )
+		{
+			occluderBoundsArray.push_back( objectBoundsArray[objectIndex] );
+		}
+
+		VisibilityDrawList drawList;
+		VisibilityCullingConfig cullingConfig;
+		cullingConfig.enableOcclusionCulling = true;
+
+		WorkerThreadPool workerThreadPool{ 3 };
+		for( auto * threadPool : { static_cast<WorkerThreadPool *>( nullptr ), &workerThreadPool } )
+		{
+			visibilitySystem.Cull( viewDesc, cullingConfig, drawList, threadPool );
+
+			const auto & cullStats = drawList.stats;
+			Ic3TestCheck( cullStats.occludersRasterizedNum > 0 );
+			Ic3TestCheck( cullStats.occlusionCulledObjectsNum > 0 );
+			Ic3TestCheck( cullStats.frustumVisibleObjectsNum == cullStats.occlusionCulledObjectsNum + cullStats.visibleObjectsNum );
+			Ic3TestCheck( cullStats.visibleObjectsNum == drawList.objectArray.size() );
+
+			std::vector<bool> objectVisibleFlags( objectsNum, false );
+			for( const auto & visibleObject : drawList.objectArray )
+			{
+				objectVisibleFlags[visibleObject.userTag] = true;
+			}
+
+			size_t falselyCulledObjectsNum = 0;
+			for( size_t objectIndex = 0; objectIndex < objectsNum; ++objectIndex )
+			{
+				if( objectVisibleFlags[objectIndex] || !cxm::intersects( viewDesc.frustum, objectBoundsArray[objectIndex] ) )
+				{
+					continue;
+				}
+
+				const auto objectCenter = objectBoundsArray[objectIndex].center();
+				const auto isHidden = std::any_of( occluderBoundsArray.begin(), occluderBoundsArray.end(), [&]( const cxm::aabbf & pOccluderBounds ) {
+					return SegmentIntersectsBox( viewDesc.origin, objectCenter, pOccluderBounds );
+				} );
+
+				falselyCulledObjectsNum += isHidden ? 0 : 1;
+			}
+
+			Ic3TestCheck( falselyCulledObjectsNum == 0 );
+		}
+	}
+
+	Ic3TestBenchmark( Visibility, Culling )
+	{
+		const auto viewDesc = MakeTestViewDesc();
+		const auto iterationsNum = pTestContext.SelectSize<uint32>( 3, 20 );
+
+		std::vector<size_t> objectsNumArray{ 10000 };
+		if( !pTestContext.IsQuickMode() )
+		{
+			objectsNumArray.push_back( 100000 );
+			objectsNumArray.push_back( 1000000 );
+		}
+
+		// One worker per additional hardware thread, so the parallel numbers are meaningful on the machine used.
+		WorkerThreadPool workerThreadPool{};
+
+		for( const auto objectsNum : objectsNumArray )
+		{
+			VisibilitySystem visibilitySystem;
+			auto objectBoundsArray = GenerateTestScene( visibilitySystem, objectsNum, 7 );
+
+			VisibilityDrawList drawList;
+			VisibilityCullingConfig cullingConfig;
+
+			// The first Cull() builds the hierarchy.
+			Stopwatch stopwatch;
+			visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+			const auto buildMs = stopwatch.GetElapsedMilliseconds();
+
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+			}
+			const auto frustumMs = stopwatch.GetElapsedMilliseconds() / iterationsNum;
+			const auto frustumVisibleNum = drawList.stats.visibleObjectsNum;
+
+			size_t bruteForceVisibleNum = 0;
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				bruteForceVisibleNum = 0;
+				for( const auto & objectBounds : objectBoundsArray )
+				{
+					bruteForceVisibleNum += cxm::intersects( viewDesc.frustum, objectBounds ) ? 1 : 0;
+				}
+			}
+			const auto bruteForceMs = stopwatch.GetElapsedMilliseconds() / iterationsNum;
+			Ic3TestCheck( bruteForceVisibleNum == frustumVisibleNum );
+
+			cullingConfig.enableOcclusionCulling = true;
+
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+			}
+			const auto occlusionMs = stopwatch.GetElapsedMilliseconds() / iterationsNum;
+
+			stopwatch.Restart();
+			for( uint32 iteration = 0; iteration < iterationsNum; ++iteration )
+			{
+				visibilitySystem.Cull( viewDesc, cullingConfig, drawList, &workerThreadPool );
+			}
+			const auto occlusionPoolMs = stopwatch.GetElapsedMilliseconds() / iterationsNum;
+
+			// Move 1% of the objects: refit + cull.
+			cullingConfig.enableOcclusionCulling = false;
+			stopwatch.Restart();
+			for( size_t objectIndex = 1; objectIndex < objectsNum; objectIndex += 100 )
+			{
+				auto & objectBounds = objectBoundsArray[objectIndex];
+				objectBounds.min_corner.x += 1.0f;
+				objectBounds.max_corner.x += 1.0f;
+				visibilitySystem.UpdateObjectBounds( static_cast<visibility_object_handle_t>( objectIndex ), objectBounds );
+			}
+			visibilitySystem.Cull( viewDesc, cullingConfig, drawList );
+			const auto refitMs = stopwatch.GetElapsedMilliseconds();
+
+			TestOutput( "  %7zu objects: build+cull %8.2f ms | frustum %7.3f ms (brute force %7.3f ms), %zu visible",
+			            objectsNum, buildMs, frustumMs, bruteForceMs, bruteForceVisibleNum );
+			TestOutput( "  %7s          occlusion %7.3f ms (%u workers %7.3f ms) | move 1%% + refit + cull %7.2f ms",
+			            "", occlusionMs, workerThreadPool.GetWorkerThreadsNum(), occlusionPoolMs, refitMs );
+		}
+	}
+
+} // namespace Ic3::Samples
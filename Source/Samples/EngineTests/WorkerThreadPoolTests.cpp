@@ -0,0 +1,132 @@
+
+#include "TestCommon.h"
+#include <Ic3/CoreLib/Threading/WorkerThreadPool.h>
+
+namespace Ic3::Samples
+{
+
+	namespace
+	{
+
+		/// Checks that every item in [0, pItemsNum) has been visited exactly once.
+		bool CheckVisitCounts( TestContext & pTestContext, const std::vector<std::atomic<uint32>> & pVisitCounts )
+		{
+			size_t invalidCountsNum = 0;
+			for( const auto & visitCount : pVisitCounts )
+			{
+				invalidCountsNum += ( visitCount.load() != 1 ) ? 1 : 0;
+			}
+			return Ic3TestCheck( invalidCountsNum == 0 );
+		}
+
+	}
+
+	Ic3TestCase( WorkerThreadPool, ParallelForRanges )
+	{
+		for( const uint32 workerThreadsNum : { 0u, 1u, 3u } )
+		{
+			WorkerThreadPool workerThreadPool{ workerThreadsNum };
+
+			for( const size_t grainSize : { 1u, 7u, 32u, 1000u } )
+			{
+				const size_t itemsNum = 5000;
+				std::vector<std::atomic<uint32>> visitCounts( itemsNum );
+				std::atomic<bool> rangeSizeValid{ true };
+
+				workerThreadPool.ParallelFor( itemsNum, grainSize, [&]( size_t pBeginIndex, size_t pEndIndex ) {
+					// Every range has exactly grainSize items, except the last one.
+					if( ( pBeginIndex % grainSize != 0 ) || ( ( pEndIndex - pBeginIndex != grainSize ) && ( pEndIndex != itemsNum ) ) )
+					{
+						rangeSizeValid = false;
+					}
+					for( size_t itemIndex = pBeginIndex; itemIndex < pEndIndex; ++itemIndex )
+					{
+						visitCounts[itemIndex].fetch_add( 1 );
+					}
+				} );
+
+				CheckVisitCounts( pTestContext, visitCounts );
+				Ic3TestCheck( rangeSizeValid.load() );
+			}
+		}
+	}
+
+	Ic3TestCase( WorkerThreadPool, NestedParallelFor )
+	{
+		// Regression: a ParallelFor() issued from a range executed by the submitting thread used to lock
+		// the (non-recursive) submit lock again and deadlock.
+		WorkerThreadPool workerThreadPool{ 3 };
+
+		const size_t outerItemsNum = 64;
+		const size_t innerItemsNum = 256;
+		std::vector<std::atomic<uint32>> visitCounts( outerItemsNum * innerItemsNum );
+
+		workerThreadPool.ParallelFor( outerItemsNum, 1, [&]( size_t pOuterBeginIndex, size_t pOuterEndIndex ) {
+			for( size_t outerIndex = pOuterBeginIndex; outerIndex < pOuterEndIndex; ++outerIndex )
+			{
+				workerThreadPool.ParallelFor( innerItemsNum, 16, [&]( size_t pInnerBeginIndex, size_t pInnerEndIndex ) {
+					for( size_t innerIndex = pInnerBeginIndex; innerIndex < pInnerEndIndex; ++innerIndex )
+					{
+						visitCounts[outerIndex * innerItemsNum + innerIndex].fetch_add( 1 );
+					}
+				} );
+			}
+		} );
+
+		CheckVisitCounts( pTestContext, visitCounts );
+
+		// The pool must still be usable for regular (non-nested) jobs afterwards.
+		std::vector<std::atomic<uint32>> secondVisitCounts( 1000 );
+		workerThreadPool.ParallelFor( secondVisitCounts.size(), 10, [&]( size_t pBeginIndex, size_t pEndIndex ) {
+			for( size_t itemIndex = pBeginIndex; itemIndex < pEndIndex; ++itemIndex )
+			{
+				secondVisitCounts[itemIndex].fetch_add( 1 );
+			}
+		} );
+
+		CheckVisitCounts( pTestContext, secondVisitCounts );
+	}
+
+	Ic3TestCase( WorkerThreadPool, ConcurrentSubmitters )
+	{
+		// Jobs submitted from multiple threads at once are serialized, each one still covers all of its items.
+		WorkerThreadPool workerThreadPool{ 2 };
+
+		const size_t submittersNum = 4;
+		const size_t itemsNum = 2000;
+		std::vector<std::vector<std::atomic<uint32>>> visitCounts( submittersNum );
+
+		std::vector<std::thread> submitterThreads;
+		for( size_t submitterIndex = 0; submitterIndex < submittersNum; ++submitterIndex )
+		{
+			visitCounts[submitterIndex] = std::vector<std::atomic<uint32>>( itemsNum );
+			submitterThreads.emplace_back( [&, submitterIndex]() {
+				for( uint32 iteration = 0; iteration < 20; ++iteration )
+				{
+					workerThreadPool.ParallelFor( itemsNum, 50, [&]( size_t pBeginIndex, size_t pEndIndex ) {
+						for( size_t itemIndex = pBeginIndex; itemIndex < pEndIndex; ++itemIndex )
+						{
+							visitCounts[submitterIndex][itemIndex].fetch_add( 1 );
+						}
+					} );
+				}
+			} );
+		}
+
+		for( auto & submitterThread : submitterThreads )
+		{
+			submitterThread.join();
+		}
+
+		size_t invalidCountsNum = 0;
+		for( const auto & submitterVisitCounts : visitCounts )
+		{
+			for( const auto & visitCount : submitterVisitCounts )
+			{
+				invalidCountsNum += ( visitCount.load() != 20 ) ? 1 : 0;
+			}
+		}
+		Ic3TestCheck( invalidCountsNum == 0 );
+	}
+
+} // namespace Ic3::Samples